@@ -12,37 +12,304 @@
 
 //== INCLUDES ==================================================================
 
+#include <map>
+#include <cstdlib>
 #include <sstream>
 #include <stdexcept>
 
+#include <pthread.h>
+
 #include "error.h"
 
 //== NAMESPACES ================================================================
 
 namespace gpufilter {
 
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct cuda_pool_stats alloc.h
+ *  @ingroup utils
+ *  @brief Statistics of the device memory pool (see cuda_pool)
+ */
+struct cuda_pool_stats {
+    size_t hits; ///< Allocations reusing a cached block
+    size_t misses; ///< Allocations calling cudaMalloc
+    size_t bytes_used; ///< Bytes in blocks allocated (in use)
+    size_t bytes_cached; ///< Bytes in blocks cached (free)
+    size_t peak_used; ///< Peak of bytes in use
+    size_t peak_reserved; ///< Peak of bytes in use plus cached
+};
+
+/**
+ *  @class cuda_pool alloc.h
+ *  @ingroup utils
+ *  @brief Caching device memory pool behind cuda_new() and cuda_delete()
+ *
+ *  Freed blocks are kept in bins (sizes rounded up to a quarter of
+ *  their power of two) per device and reused by later allocations of
+ *  the same bin, avoiding cudaMalloc and cudaFree (which synchronize
+ *  the device).  A freed block records an event in the stream that
+ *  used it last (the default stream if not given) and its reuse waits
+ *  on it, thus temporaries of asynchronous work may be freed as soon
+ *  as the work is launched (see dvector::set_stream()).  An
+ *  allocation for a given stream makes that stream wait on the event
+ *  (with no host wait), otherwise the event is synchronized out of
+ *  the pool lock, as the memory may be used by any stream.  The
+ *  pool is disabled with GPUFILTER_POOL=0 in the environment, or the
+ *  cache is limited to GPUFILTER_POOL megabytes.
+ */
+class cuda_pool
+{
+
+public:
+
+    /**
+     *  @brief The pool instance (one per process)
+     *
+     *  The instance is never destroyed, as device vectors may be freed
+     *  by static destructors, and its memory goes with the context.
+     *
+     *  @return Pool instance
+     */
+    static cuda_pool& instance() {
+        static cuda_pool *pool = new cuda_pool;
+        return *pool;
+    }
+
+    /**
+     *  @brief Bin size of an allocation
+     *  @param[in] bytes Allocation size in bytes
+     *  @return Allocation size rounded up to its bin
+     */
+    static size_t bin_size( size_t bytes ) {
+        size_t p = 512;
+        while (p < bytes && p*2 > p) p *= 2;
+        size_t step = p >= 2048 ? p/8 : p; // quarters of the power below
+        return (bytes + step - 1) / step * step;
+    }
+
+    /**
+     *  @brief Allocate device memory (reusing a cached block if any)
+     *  @param[in] bytes Allocation size in bytes
+     *  @param[in] stream Stream of the work using the memory (zero for any)
+     *  @return Pointer to the device memory allocated
+     */
+    void *allocate( size_t bytes,
+                    cudaStream_t stream=0 ) {
+        block b;
+        bool hit = false;
+        {
+            lock l(m_mutex);
+            int device = 0;
+            cudaGetDevice(&device);
+            if (!m_enabled)
+                return cuda_malloc(bytes);
+            b.bytes = bin_size(bytes);
+            b.device = device;
+            free_map::iterator it = m_free.find(key(device, b.bytes));
+            if (it != m_free.end()) {
+                b = it->second;
+                m_free.erase(it);
+                m_stats.bytes_cached -= b.bytes;
+                ++m_stats.hits;
+                hit = true;
+            } else {
+                b.ptr = cuda_malloc(b.bytes);
+                cudaEventCreateWithFlags(&b.ready, cudaEventDisableTiming);
+                ++m_stats.misses;
+            }
+            m_used[b.ptr] = b;
+            m_stats.bytes_used += b.bytes;
+            update_peaks();
+        }
+        // the block is in use, its event is only recorded again when freed
+        if (hit && stream)
+            cudaStreamWaitEvent(stream, b.ready, 0);
+        else if (hit)
+            cudaEventSynchronize(b.ready);
+        return b.ptr;
+    }
+
+    /**
+     *  @brief Deallocate device memory (caching its block)
+     *  @param[in] ptr Pointer to the device memory
+     *  @param[in] stream Stream of the last work using the memory
+     */
+    void deallocate( void *ptr,
+                     cudaStream_t stream=0 ) {
+        if (!ptr) return;
+        lock l(m_mutex);
+        used_map::iterator it = m_used.find(ptr);
+        if (it == m_used.end()) { // not from the pool
+            cudaFree(ptr);
+            return;
+        }
+        block b = it->second;
+        m_used.erase(it);
+        m_stats.bytes_used -= b.bytes;
+        if (!m_enabled || m_stats.bytes_cached + b.bytes > m_max_cached) {
+            free_block(b);
+            return;
+        }
+        cudaEventRecord(b.ready, stream); // reuse waits for the work
+        m_free.insert(std::make_pair(key(b.device, b.bytes), b));
+        m_stats.bytes_cached += b.bytes;
+    }
+
+    /// Free all cached blocks (of all devices)
+    void release() {
+        lock l(m_mutex);
+        release_cache();
+    }
+
+    /**
+     *  @brief Enable or disable caching (disabling releases the cache)
+     *  @param[in] e Flag to enable caching
+     */
+    void set_enabled( bool e ) {
+        lock l(m_mutex);
+        m_enabled = e;
+        if (!e) release_cache();
+    }
+
+    /**
+     *  @brief Limit the bytes cached (blocks freed beyond it are not cached)
+     *  @param[in] bytes Maximum bytes cached
+     */
+    void set_max_cached( size_t bytes ) {
+        lock l(m_mutex);
+        m_max_cached = bytes;
+    }
+
+    /**
+     *  @brief Pool statistics
+     *  @return Statistics since the last reset
+     */
+    cuda_pool_stats stats() const {
+        lock l(m_mutex);
+        return m_stats;
+    }
+
+    /// Reset counters and peaks (to the current bytes)
+    void reset_stats() {
+        lock l(m_mutex);
+        m_stats.hits = m_stats.misses = 0;
+        m_stats.peak_used = m_stats.bytes_used;
+        m_stats.peak_reserved = m_stats.bytes_used + m_stats.bytes_cached;
+    }
+
+private:
+
+    struct block {
+        void *ptr; ///< Device memory
+        size_t bytes; ///< Bin size in bytes
+        int device; ///< Device of the memory
+        cudaEvent_t ready; ///< Event recorded when the block is freed
+    };
+
+    typedef std::pair<int, size_t> key; ///< Device and bin size
+    typedef std::multimap<key, block> free_map;
+    typedef std::map<void *, block> used_map;
+
+    /// Scoped mutex lock
+    struct lock {
+        explicit lock( pthread_mutex_t& m ) : mutex(m) { pthread_mutex_lock(&mutex); }
+        ~lock() { pthread_mutex_unlock(&mutex); }
+        pthread_mutex_t& mutex;
+    };
+
+    /// Default constructor (reading the environment)
+    cuda_pool() : m_enabled(true), m_max_cached((size_t)-1) {
+        pthread_mutex_init(&m_mutex, 0);
+        m_stats.hits = m_stats.misses = 0;
+        m_stats.bytes_used = m_stats.bytes_cached = 0;
+        m_stats.peak_used = m_stats.peak_reserved = 0;
+        const char *env = std::getenv("GPUFILTER_POOL");
+        if (env) {
+            long mb = std::atol(env);
+            m_enabled = mb != 0;
+            if (mb > 0) m_max_cached = (size_t)mb << 20;
+        }
+    }
+
+    /// Allocate with cudaMalloc (releasing the cache and retrying on failure)
+    void *cuda_malloc( size_t bytes ) {
+        void *ptr = 0;
+        cudaError_t e = cudaMalloc(&ptr, bytes);
+        if (e != cudaSuccess && !m_free.empty()) {
+            cudaGetLastError();
+            release_cache();
+            e = cudaMalloc(&ptr, bytes);
+        }
+        if( (e != cudaSuccess) || (ptr == 0) )
+            throw std::runtime_error("Memory allocation error");
+        check_cuda_error("Memory allocation error");
+        return ptr;
+    }
+
+    /// Free a block (in its device)
+    void free_block( const block& b ) {
+        int device = 0;
+        cudaGetDevice(&device);
+        if (device != b.device) cudaSetDevice(b.device);
+        cudaEventDestroy(b.ready);
+        cudaFree(b.ptr);
+        if (device != b.device) cudaSetDevice(device);
+    }
+
+    /// Free all cached blocks (locked)
+    void release_cache() {
+        for (free_map::iterator it = m_free.begin(); it != m_free.end(); ++it)
+            free_block(it->second);
+        m_free.clear();
+        m_stats.bytes_cached = 0;
+    }
+
+    /// Update peak statistics
+    void update_peaks() {
+        if (m_stats.bytes_used > m_stats.peak_used)
+            m_stats.peak_used = m_stats.bytes_used;
+        if (m_stats.bytes_used + m_stats.bytes_cached > m_stats.peak_reserved)
+            m_stats.peak_reserved = m_stats.bytes_used + m_stats.bytes_cached;
+    }
+
+    mutable pthread_mutex_t m_mutex; ///< Mutex of all pool operations
+    bool m_enabled; ///< Flag for caching enabled
+    size_t m_max_cached; ///< Maximum bytes cached
+    free_map m_free; ///< Cached blocks
+    used_map m_used; ///< Blocks in use
+    cuda_pool_stats m_stats; ///< Pool statistics
+
+    /// Destructor (deleted)
+    ~cuda_pool();
+
+    /// Copy Constructor (deleted)
+    cuda_pool( const cuda_pool& );
+
+    /// Assign operator (deleted)
+    cuda_pool& operator = ( const cuda_pool& );
+
+};
+
 //== IMPLEMENTATION ============================================================
 
 /**
  *  @ingroup utils
  *  @brief Allocates a new memory space in the GPU
  *
- *  This function allocates device (GPU) memory space.
+ *  This function allocates device (GPU) memory space from the caching
+ *  pool (see cuda_pool).
  *
  *  @param[in] elements Number of elements to allocate
+ *  @param[in] stream Stream of the work using the memory (zero for any)
  *  @return Pointer to the device memory allocated
  *  @tparam T Memory values type
  */
 template< class T >
-T *cuda_new( const size_t& elements ) {
-    T *ptr = 0;
-
-    cudaError_t e = cudaMalloc((void **)&ptr, elements*sizeof(T));
-    if( (e != cudaSuccess) || (ptr == 0) )
-        throw std::runtime_error("Memory allocation error");
-    check_cuda_error("Memory allocation error");
-
-    return ptr;
+T *cuda_new( const size_t& elements,
+             cudaStream_t stream=0 ) {
+    return (T *)cuda_pool::instance().allocate(elements*sizeof(T), stream);
 }
 
 /**
@@ -73,14 +340,17 @@ T *cuda_new( size_t& pitch,
  *  @ingroup utils
  *  @brief Deallocates a memory space in the GPU
  *
- *  This function deletes device (GPU) memory space.
+ *  This function deletes device (GPU) memory space, caching it in
+ *  the pool when it came from it (see cuda_pool).
  *
  *  @param[in] d_ptr Device pointer (in the GPU memory)
+ *  @param[in] stream Stream of the last work using the memory
  *  @tparam T Memory values type
  */
 template< class T >
-void cuda_delete( T *d_ptr ) {
-    cudaFree((void *)d_ptr);
+void cuda_delete( T *d_ptr,
+                  cudaStream_t stream=0 ) {
+    cuda_pool::instance().deallocate((void *)d_ptr, stream);
     check_cuda_error("Error freeing memory");
 }
 
@@ -41,7 +41,7 @@ public:
      *  Constructor
      *  @param[in] that Host (STL) Vector data (non-converted) to be copied into this object
      */
-    explicit dvector(const std::vector<T> &that) : m_size(0), m_capacity(0), m_data(0)
+    explicit dvector(const std::vector<T> &that) : m_size(0), m_capacity(0), m_data(0), m_stream(0)
     {
         *this = that;
     }
@@ -51,7 +51,7 @@ public:
      *  @param[in] data Vector data to be copied into this object
      *  @param[in] size Vector data size
      */
-    dvector(const T *data, size_t size) : m_size(0), m_capacity(0), m_data(0)
+    dvector(const T *data, size_t size) : m_size(0), m_capacity(0), m_data(0), m_stream(0)
     {
         resize(size);
         cudaMemcpy(this->data(), const_cast<T *>(data), size*sizeof(T), cudaMemcpyHostToDevice);
@@ -62,13 +62,13 @@ public:
      *  Copy Constructor
      *  @param[in] that Copy that object to this object
      */
-    dvector(const dvector &that) : m_size(0), m_capacity(0), m_data(0)
+    dvector(const dvector &that) : m_size(0), m_capacity(0), m_data(0), m_stream(0)
     {
         *this = that;
     }
 
     /// Default constructor
-    dvector(size_t size=0) : m_size(0), m_capacity(0), m_data(0)
+    dvector(size_t size=0) : m_size(0), m_capacity(0), m_data(0), m_stream(0)
     {
         resize(size);
     }
@@ -76,7 +76,7 @@ public:
     /// Destructor
     ~dvector()
     {
-        cuda_delete(m_data);
+        cuda_delete(m_data, m_stream);
         m_data = 0;
         m_capacity = 0;
         m_size = 0;
@@ -90,12 +90,12 @@ public:
     {
         if(size > m_capacity)
         {
-            cuda_delete(m_data);
+            cuda_delete(m_data, m_stream);
             m_data = 0;
             m_capacity = 0;
             m_size = 0;
 
-            m_data = cuda_new<T>(size);
+            m_data = cuda_new<T>(size, m_stream);
             m_capacity = size;
             m_size = size;
         }
@@ -103,6 +103,22 @@ public:
             m_size = size;
     }
 
+    /**
+     *  @brief Set the stream using this vector
+     *
+     *  Work on other streams than the default one must be given, as
+     *  the memory freed (by resize or destruction) is reused only after
+     *  the last work on its stream, and the memory allocated (by
+     *  resize) is used by this stream once the work of its previous
+     *  owner is done, with no host wait (see cuda_pool).
+     *
+     *  @param[in] stream The stream of the work using this vector
+     */
+    void set_stream(cudaStream_t stream)
+    {
+        m_stream = stream;
+    }
+
     /**
      *  @brief Clear this vector
      */
@@ -223,12 +239,14 @@ public:
         std::swap(a.m_data, b.m_data);
         std::swap(a.m_size, b.m_size);
         std::swap(a.m_capacity, b.m_capacity);
+        std::swap(a.m_stream, b.m_stream);
     }
 
 private:
 
     T *m_data; ///< Vector data
     size_t m_size, m_capacity; ///< Vector size and capacity
+    cudaStream_t m_stream; ///< Stream of the work using the vector
 
 };
 
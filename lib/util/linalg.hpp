@@ -518,6 +518,33 @@ Vector<T,N> reverse(const Vector<T,N> &a)
 }
 
 
+// Type conversion -------------------------------------------------------------
+
+template <class U, class T, int N>
+HOSTDEV
+Vector<U,N> convert(const Vector<T,N> &a)
+{
+    Vector<U,N> r;
+#pragma unroll
+    for(int j=0; j<r.size(); ++j)
+        r[j] = (U)a[j];
+    return r;
+}
+
+template <class U, class T, int M, int N>
+HOSTDEV
+Matrix<U,M,N> convert(const Matrix<T,M,N> &m)
+{
+    Matrix<U,M,N> r;
+#pragma unroll
+    for(int i=0; i<m.rows(); ++i)
+#pragma unroll
+        for(int j=0; j<m.cols(); ++j)
+            r[i][j] = (U)m[i][j];
+    return r;
+}
+
+
 // Transposition ---------------------------------------------------------------
 
 template <class T, int M> 
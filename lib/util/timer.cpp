@@ -11,6 +11,7 @@
 
 #include <iostream>
 #include <cmath>
+#include <cstdlib>
 #include <stack>
 #include <iomanip>
 
@@ -21,6 +22,10 @@
 #include <sys/time.h>
 #endif
 
+#ifdef NVTX // external define it to tag the step timers with NVTX ranges
+#include <nvToolsExt.h>
+#endif
+
 #include "error.h"
 #include "timer.h"
 
@@ -34,6 +39,8 @@ timer_pool timers;
 
 size_t g_start_count = 0;
 
+int g_step_timing = -1; // not set yet, read from the environment
+
 base_timer::base_timer(const char *type_label, size_t data_size,
                        const std::string &unit)
     : m_type_label(type_label)
@@ -136,6 +143,80 @@ double gpu_timer::do_get_elapsed() const
     return elapsed/1000.f;
 }
 
+step_timer::step_timer(const std::string &label, size_t data_size,
+                       const std::string &unit)
+    : base_timer("[GPU]", data_size, unit)
+    , m_label(label), m_runs(0), m_total(0)
+{
+}
+
+step_timer::~step_timer()
+{
+    fold(true);
+    for(size_t i = 0; i < m_free.size(); ++i)
+    {
+        cudaEventDestroy(m_free[i].first);
+        cudaEventDestroy(m_free[i].second);
+    }
+}
+
+void step_timer::fold(bool wait) const
+{
+    while(!m_pending.empty())
+    {
+        event_pair p = m_pending.front();
+        if(wait)
+            cudaEventSynchronize(p.second);
+        else if(cudaEventQuery(p.second) != cudaSuccess)
+            break;
+        float elapsed;
+        cudaEventElapsedTime(&elapsed, p.first, p.second);
+        check_cuda_error("Event elapsed time");
+        m_total += elapsed/1000.f;
+        m_pending.pop_front();
+        m_free.push_back(p);
+    }
+}
+
+void step_timer::do_start()
+{
+    fold(false);
+    event_pair p;
+    if(m_free.empty())
+    {
+        cudaEventCreate(&p.first);
+        cudaEventCreate(&p.second);
+        check_cuda_error("Timer event creation");
+    }
+    else
+    {
+        p = m_free.back();
+        m_free.pop_back();
+    }
+    m_pending.push_back(p);
+#ifdef NVTX
+    nvtxRangePushA(m_label.c_str());
+#endif
+    cudaEventRecord(p.first, 0);
+    check_cuda_error("Event recording");
+}
+
+void step_timer::do_stop()
+{
+    cudaEventRecord(m_pending.back().second, 0);
+    check_cuda_error("Event recording");
+#ifdef NVTX
+    nvtxRangePop();
+#endif
+    ++m_runs;
+}
+
+double step_timer::do_get_elapsed() const
+{
+    fold(true);
+    return m_total;
+}
+
 cpu_timer::cpu_timer(size_t data_size, const std::string &unit, bool start)
     : base_timer("[CPU]", data_size, unit)
     , m_start_time(0), m_stop_time(0)
@@ -292,6 +373,30 @@ void timer_pool::flush()
     m_timers.clear();
 }
 
+double timer_pool::elapsed(const std::string &label)
+{
+    double total = 0;
+    for(timer_list::iterator it=m_timers.begin(); it!=m_timers.end(); ++it)
+        if(it->label == label)
+            total += it->timer->elapsed();
+    return total;
+}
+
+bool step_timing()
+{
+    if(g_step_timing < 0)
+    {
+        const char *env = std::getenv("GPUFILTER_STEP_TIMING");
+        g_step_timing = env && std::atoi(env) != 0;
+    }
+    return g_step_timing != 0;
+}
+
+void set_step_timing(bool on)
+{
+    g_step_timing = on;
+}
+
 //==============================================================================
 } // namespace gpufilter
 //==============================================================================
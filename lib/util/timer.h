@@ -14,6 +14,8 @@
 
 #include <string>
 #include <list>
+#include <deque>
+#include <vector>
 
 #include <cuda_runtime.h>
 
@@ -44,6 +46,11 @@ public:
                 size_t data_size = 0,
                 const std::string &unit = "" );
 
+    /**
+     *  Destructor (virtual, the timer pool deletes its timers by base)
+     */
+    virtual ~base_timer() { }
+
     /**
      *  @brief Start counting timing
      */
@@ -184,6 +191,87 @@ private:
 
 //== CLASS DEFINITION ==========================================================
 
+/**
+ *  @class step_timer timer.h
+ *  @ingroup utils
+ *  @brief GPU timer of one step accumulated over many runs
+ *
+ *  Step timer records a pair of CUDA events per run of a step
+ *  without synchronizing, unlike gpu_timer, thus timing each step of
+ *  an algorithm does not stall the pipeline of kernels between runs.
+ *  Pairs already done on the device are folded into the total on the
+ *  next start (without waiting) and the remaining ones when the time
+ *  elapsed is asked for, i.e. the total of all runs.  Each run is
+ *  also an NVTX range named by the step label, to show the steps in
+ *  Nsight, when compiled with NVTX defined.
+ */
+class step_timer : public base_timer {
+
+public:
+
+    /**
+     *  Constructor
+     *  @param[in] label The step label (NVTX range name)
+     *  @param[in] data_size Data size associated with this timer
+     *  @param[in] unit The unit of the associated data
+     */
+    step_timer( const std::string& label,
+                size_t data_size = 0,
+                const std::string& unit = "" );
+
+    /**
+     *  Destructor
+     */
+    ~step_timer();
+
+    /**
+     *  @brief Number of runs timed
+     *  @return Number of start and stop pairs so far
+     */
+    int runs() const { return m_runs; }
+
+    /**
+     *  @brief Step label
+     *  @return The label of this step
+     */
+    const std::string &label() const { return m_label; }
+
+private:
+
+    typedef std::pair<cudaEvent_t, cudaEvent_t> event_pair; ///< Start and stop events
+
+    /**
+     *  @brief Fold done (or all, waiting) event pairs into the total
+     *  @param[in] wait Flag to wait for the pairs not done yet
+     */
+    void fold( bool wait ) const;
+
+    /**
+     *  @brief Do start this timer
+     */
+    virtual void do_start();
+
+    /**
+     *  @brief Do stop this timer
+     */
+    virtual void do_stop();
+
+    /**
+     *  @brief Do get time elapsed by this timer
+     *  @return Time elapsed in seconds (of all runs)
+     */
+    virtual double do_get_elapsed() const;
+
+    std::string m_label; ///< Step label
+    int m_runs; ///< Number of runs timed
+    mutable double m_total; ///< Total time of the folded runs (in seconds)
+    mutable std::deque<event_pair> m_pending; ///< Event pairs recorded not folded yet
+    mutable std::vector<event_pair> m_free; ///< Event pairs already folded (to reuse)
+
+};
+
+//== CLASS DEFINITION ==========================================================
+
 /**
  *  @class cpu_timer timer.h
  *  @ingroup utils
@@ -337,6 +425,17 @@ public:
      */
     void flush();
 
+    /**
+     *  @brief Total time elapsed of all timers with a label in this pool
+     *
+     *  This reads the pool without flushing it, e.g. the step timers
+     *  added by the algorithms aggregated over all their calls.
+     *
+     *  @param[in] label The label string of the timers
+     *  @return Total time elapsed in seconds
+     */
+    double elapsed( const std::string& label );
+
 private:
 
     /**
@@ -365,6 +464,27 @@ private:
 extern
 timer_pool timers;
 
+//== PROTOTYPES ================================================================
+
+/**
+ *  @ingroup utils
+ *  @brief Check if the algorithms should time each of their steps
+ *
+ *  Step timing is switched at run time, by set_step_timing() or else
+ *  by the GPUFILTER_STEP_TIMING environment variable (non-zero to
+ *  switch it on), and it is off by default.
+ *
+ *  @return True if step timing is on
+ */
+bool step_timing();
+
+/**
+ *  @ingroup utils
+ *  @brief Switch step timing on or off (overriding the environment)
+ *  @param[in] on Flag to time each step of the algorithms
+ */
+void set_step_timing( bool on );
+
 //==============================================================================
 } // namespace gpufilter
 //==============================================================================
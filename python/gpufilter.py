@@ -0,0 +1,148 @@
+"""Recursive filtering of device tensors with the CUDA kernels of gpufilter.
+
+The tensors (PyTorch, CuPy, Numba or any object exposing
+``__cuda_array_interface__`` or DLPack) are filtered in place in device
+memory, on the caller's stream, with no host staging nor copies.  The
+filter is the algorithm 6 of the library with zero boundary, see
+``src/gpufilter_c.h``, loaded from the shared library ``libgpufilter_c``
+(built in ``src/`` of the build directory, or given by the
+``GPUFILTER_LIB`` environment variable).
+
+Example (PyTorch)::
+
+    import torch, gpufilter
+    x = torch.rand(8, 1080, 1920, device='cuda')
+    gpufilter.recfilter_(x, [0.4, -0.6])  # first-order weights
+
+"""
+
+import ctypes
+import os
+
+__all__ = ['recfilter_', 'RecursiveFilter']
+
+#== LIBRARY ====================================================================
+
+def _load_library():
+    names = [os.environ.get('GPUFILTER_LIB', '')]
+    here = os.path.dirname(os.path.abspath(__file__))
+    for d in (here, os.path.join(here, '..', 'build', 'src'), os.path.join(here, '..', 'src')):
+        names.append(os.path.join(d, 'libgpufilter_c.so'))
+    names.append('libgpufilter_c.so')
+    for name in names:
+        if not name:
+            continue
+        try:
+            return ctypes.CDLL(name)
+        except OSError:
+            pass
+    raise OSError('Shared library libgpufilter_c not found (set GPUFILTER_LIB)')
+
+_lib = _load_library()
+_lib.gpufilter_plan_create.restype = ctypes.c_void_p
+_lib.gpufilter_plan_create.argtypes = [ctypes.c_int, ctypes.c_int, ctypes.c_int, ctypes.c_int,
+                                       ctypes.POINTER(ctypes.c_float), ctypes.c_int]
+_lib.gpufilter_plan_run.restype = ctypes.c_int
+_lib.gpufilter_plan_run.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_int, ctypes.c_void_p]
+_lib.gpufilter_plan_destroy.restype = None
+_lib.gpufilter_plan_destroy.argtypes = [ctypes.c_void_p]
+_lib.gpufilter_error.restype = ctypes.c_char_p
+_lib.gpufilter_error.argtypes = []
+
+def _error():
+    return RuntimeError(_lib.gpufilter_error().decode())
+
+#== TENSORS ====================================================================
+
+def _interface(x):
+    """CUDA array interface of a tensor (through DLPack if needed)."""
+    if hasattr(x, '__cuda_array_interface__'):
+        return x.__cuda_array_interface__
+    if hasattr(x, '__dlpack__'):
+        import cupy  # zero-copy view of the DLPack capsule
+        return cupy.from_dlpack(x).__cuda_array_interface__
+    raise TypeError('Tensor in device memory expected (CUDA array interface or DLPack)')
+
+def _layout(cai):
+    """Batch, height, width, channels and row stride (in pixels) of a tensor.
+
+    Shapes are (height, width), (batch, height, width) or (batch,
+    height, width, channels), in float32 with contiguous pixels (and
+    channels) and one image after the other.
+    """
+    if cai['typestr'] != '<f4':
+        raise TypeError('Tensor of float32 expected')
+    shape, ndim = tuple(cai['shape']), len(cai['shape'])
+    if ndim < 2 or ndim > 4:
+        raise ValueError('Tensor of 2 to 4 dimensions expected')
+    if ndim == 4:
+        batch, height, width, channels = shape
+    elif ndim == 2:
+        batch, height, width, channels = 1, shape[0], shape[1], 1
+    elif ndim == 3:
+        batch, height, width, channels = shape[0], shape[1], shape[2], 1
+    if channels < 1 or channels > 4:
+        raise ValueError('Tensor of 1 to 4 channels expected')
+    strides = cai.get('strides')
+    if strides is None: # C-contiguous
+        return batch, height, width, channels, width
+    strides = tuple(strides) + (() if ndim == 4 else (4,))
+    if ndim == 2:
+        strides = (height*strides[0],) + strides
+    row, pixel = strides[-3], strides[-2]
+    if (strides[-1] != 4 or pixel != channels*4 or row % pixel != 0 or
+            (batch > 1 and strides[0] != height*row)):
+        raise ValueError('Tensor of contiguous pixels and images expected')
+    return batch, height, width, channels, row//pixel
+
+#== FILTER =====================================================================
+
+class RecursiveFilter(object):
+    """Recursive filter of given weights, caching one plan per tensor layout.
+
+    The weights are the order+1 feedforward and feedback coefficients
+    (e.g. from the Gaussian weights of the library), orders 1 to 5.
+    """
+
+    def __init__(self, weights):
+        self.weights = [float(v) for v in weights]
+        self.order = len(self.weights) - 1
+        self._plans = {}
+
+    def __del__(self):
+        for plan in getattr(self, '_plans', {}).values():
+            _lib.gpufilter_plan_destroy(plan)
+
+    def _plan(self, batch, height, width, channels):
+        key = (batch, height, width, channels)
+        if key not in self._plans:
+            w = (ctypes.c_float * len(self.weights))(*self.weights)
+            plan = _lib.gpufilter_plan_create(width, height, batch, channels, w, self.order)
+            if not plan:
+                raise _error()
+            self._plans[key] = plan
+        return self._plans[key]
+
+    def __call__(self, x, stream=None):
+        """Filter a tensor in place on a stream and return it.
+
+        The stream is a cudaStream_t handle (an integer, e.g.
+        ``torch.cuda.current_stream().cuda_stream`` or
+        ``cupy.cuda.get_current_stream().ptr``), by default the stream
+        given by the tensor interface or else the default stream.
+        """
+        cai = _interface(x)
+        batch, height, width, channels, stride = _layout(cai)
+        if stream is None:
+            stream = cai.get('stream') or 0
+        ptr = cai['data'][0]
+        if cai['data'][1]:
+            raise ValueError('Writable tensor expected')
+        if _lib.gpufilter_plan_run(self._plan(batch, height, width, channels),
+                                   ptr, stride, stream) != 0:
+            raise _error()
+        return x
+
+def recfilter_(x, weights, stream=None):
+    """Filter a tensor in place by a recursive filter of given weights."""
+    return RecursiveFilter(weights)(x, stream)
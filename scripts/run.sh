@@ -2,6 +2,10 @@
 
 set -x
 
+# CPU references computed once per size (see src/refcheck.cuh)
+export GPUFILTER_REF_CACHE=${GPUFILTER_REF_CACHE:-/tmp/gpufilter_ref}
+mkdir -p $GPUFILTER_REF_CACHE
+
 for i in $(seq 1 128);
 do
     for j in $(seq 1 8);
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# usage: run_compact.sh [width height btype border]
+# prints throughput, max error and max relative error (versus CPU
+# reference) of single and compact precision (half carries) for each
+# order, high orders show the carries traffic saved
+
+set -x
+
+w=${1:-4096}
+h=${2:-4096}
+b=${3:-0}
+bb=${4:-0}
+
+for a in 5 6; do
+    for r in $(seq 1 5); do
+        echo -n "alg${a}_${r} "
+        ../build/src/alg${a}_${r} $w $h 10 $b $bb
+        echo -n "alg${a}compact_${r} "
+        ../build/src/alg${a}compact_${r} $w $h 10 $b $bb
+    done
+done
@@ -0,0 +1,21 @@
+#!/bin/bash
+
+# usage: run_half.sh [width height btype border]
+# prints throughput, max error and max relative error (versus CPU
+# reference) of single and half precision storage for each order
+
+set -x
+
+w=${1:-1024}
+h=${2:-1024}
+b=${3:-0}
+bb=${4:-0}
+
+for a in 5 6; do
+    for r in $(seq 1 5); do
+        echo -n "alg${a}_${r} "
+        ../build/src/alg${a}_${r} $w $h 10 $b $bb
+        echo -n "alg${a}half_${r} "
+        ../build/src/alg${a}half_${r} $w $h 10 $b $bb
+    done
+done
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# usage: run_mixed.sh [width height btype border]
+# prints throughput, max error and max relative error (versus CPU
+# reference) of single and mixed precision (double carries) for each
+# order, large images (e.g. 8192x8192) show the carries error growth
+
+set -x
+
+w=${1:-4096}
+h=${2:-4096}
+b=${3:-0}
+bb=${4:-0}
+
+for a in 5 6; do
+    for r in $(seq 1 5); do
+        echo -n "alg${a}_${r} "
+        ../build/src/alg${a}_${r} $w $h 10 $b $bb
+        echo -n "alg${a}mixed_${r} "
+        ../build/src/alg${a}mixed_${r} $w $h 10 $b $bb
+    done
+done
@@ -0,0 +1,22 @@
+#!/bin/bash
+
+# usage: run_multi.sh [width height max_gpus]
+# prints throughput, max error and max relative error (versus CPU
+# reference) of the single-GPU alg6 (zero border) and of the
+# multi-GPU alg6 on 1 to max_gpus devices for each order, large
+# images (e.g. 16384x16384) are needed to hide the carries exchange
+
+set -x
+
+w=${1:-8192}
+h=${2:-8192}
+g=${3:-$(nvidia-smi -L | wc -l)}
+
+for r in $(seq 1 5); do
+    echo -n "alg6_${r} "
+    ../build/src/alg6_${r} $w $h 10 0 0
+    for d in $(seq 1 $g); do
+        echo -n "alg6_multi_${r} gpus=${d} "
+        CUDA_VISIBLE_DEVICES=$(seq -s, 0 $((d-1))) ../build/src/alg6_multi_${r} $w $h 10 0 0
+    done
+done
@@ -0,0 +1,17 @@
+#!/bin/bash
+
+# usage: run_tensor.sh [sizes orders]
+# prints throughput, max error and max relative error (versus CPU
+# reference) of algorithms 5 and 6 on the scans of one warp and on
+# tensor cores in TF32 (Ampere and newer) and FP16 (Volta and newer)
+# for each order, also saved as bench_tensor_<precision>.json
+
+set -x
+
+s=${1:-1024,4096}
+o=${2:-1,2,3,4,5}
+
+../build/src/bench -algs 5,6 -orders $o -sizes $s -check -json bench_tensor_off.json
+for p in tf32 fp16; do
+    ../build/src/bench -algs 5,6 -orders $o -sizes $s -check -tensor $p -json bench_tensor_${p}.json
+done
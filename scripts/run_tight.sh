@@ -0,0 +1,18 @@
+#!/bin/bash
+
+# usage: run_tight.sh [width height]
+# prints pitch, output memory and filter plus download time of the
+# padded and tight output pitch, and their max error and max relative
+# error (versus CPU reference) for each order (1 to 5, orders 4 and 5
+# with random weights), odd sizes (e.g. 1917x1081 crops) show the
+# memory saved
+
+set -x
+
+w=${1:-1917}
+h=${2:-1081}
+
+for r in $(seq 1 5); do
+    echo -n "alg6_tight_${r} "
+    ../build/src/alg6_tight_${r} $w $h 100
+done
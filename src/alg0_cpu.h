@@ -11,6 +11,8 @@
 
 //== INCLUDES ===================================================================
 
+#include <vector>
+
 #include <util/image.h>
 #include <util/linalg.h>
 #include <util/recfilter.h>
@@ -225,6 +227,129 @@ void alg0_cpu( float *inout,
 
 }
 
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute algorithm 0 in the CPU with a border type per axis
+ *
+ *  Same as alg0_cpu() but the rows are extended (left and right) by
+ *  the rows border type and filtered, then the columns are extended
+ *  (top and bottom) by the columns border type and filtered.  It
+ *  servers only for reference.
+ *
+ *  @param[in,out] inout The 2D image to compute recursive filtering
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] row_btype Border type of rows (left and right)
+ *  @param[in] col_btype Border type of columns (top and bottom)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg0_cpu_axes( float *inout,
+                    int width, int height,
+                    const Vector<float, R+1> &weights,
+                    int border,
+                    BorderType row_btype,
+                    BorderType col_btype ) {
+
+    int border_left, border_top, border_right, border_bottom;
+
+    calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
+                 width, height, border);
+
+    float *eimg = extend_image(inout, width, height, 
+                               0, border_left, 0, border_right,
+                               row_btype);
+
+    int nw = width+border_left+border_right;
+
+    recursive_rows_fwd<R>(eimg, nw, height, weights);
+    recursive_rows_rev<R>(eimg, nw, height, weights);
+
+    crop_image(inout, eimg, width, height, 0, border_left, 0, border_right);
+
+    delete [] eimg;
+
+    eimg = extend_image(inout, width, height, 
+                        border_top, 0, border_bottom, 0,
+                        col_btype);
+
+    int nh = height+border_top+border_bottom;
+
+    recursive_cols_fwd<R>(eimg, width, nh, weights);
+    recursive_cols_rev<R>(eimg, width, nh, weights);
+
+    crop_image(inout, eimg, width, height, border_top, 0, border_bottom, 0);
+
+    delete [] eimg;
+
+}
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute algorithm 0 for 3D volumes in the CPU
+ *
+ *  Each slice is filtered in rows and columns by alg0_cpu(), then
+ *  each pixel is filtered along the depth, naïvely, extending the
+ *  depth by border blocks (and aligning it to 32 slices) as alg0_cpu()
+ *  does for rows and columns.  It servers only for reference.
+ *
+ *  @param[in,out] inout The 3D volume (slice after slice) to compute recursive filtering
+ *  @param[in] width Volume width
+ *  @param[in] height Volume height
+ *  @param[in] depth Volume depth
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32x32) outside volume
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg0_cpu_3d( float *inout,
+                  int width, int height, int depth,
+                  const Vector<float, R+1> &weights,
+                  int border=0,
+                  BorderType btype=CLAMP_TO_ZERO ) {
+
+    const size_t slice_size = (size_t)width*height;
+
+    for (int z = 0; z < depth; ++z)
+        alg0_cpu<R>(inout + z*slice_size, width, height, weights, border, btype);
+
+    int front = border*BS, nd = front + (depth+BS-1)/BS*BS + border*BS;
+
+    std::vector<float> line(nd);
+
+    for (size_t i = 0; i < slice_size; ++i) {
+
+        for (int k = 0; k < nd; ++k) {
+            int z = k - front;
+            if (z < 0 || z >= depth) {
+                switch(btype) {
+                case CLAMP_TO_EDGE: z = z < 0 ? 0 : depth-1; break;
+                case REPEAT: z = (z%depth + depth)%depth; break;
+                case REFLECT:
+                    z = (z%(2*depth) + 2*depth)%(2*depth);
+                    if (z >= depth) {
+                        z = 2*depth-1-z;
+                    }
+                    break;
+                default: z = -1;
+                }
+            }
+            line[k] = z < 0 ? 0.f : inout[z*slice_size+i];
+        }
+
+        recursive_rows_fwd<R>(&line[0], nd, 1, weights);
+        recursive_rows_rev<R>(&line[0], nd, 1, weights);
+
+        for (int z = 0; z < depth; ++z)
+            inout[z*slice_size+i] = line[front+z];
+
+    }
+
+}
+
 /**
  *  @ingroup api_cpu
  *  @brief Compute reference for the algorithm 3 in the CPU
@@ -0,0 +1,112 @@
+/**
+ *  @file alg0_simd.cu
+ *  @brief Algorithm 0 in the CPU vectorized and multithreaded
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg0_simd_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "alg0_cpu.h"
+#include "refcheck.cuh"
+#include "alg0_simd_cpu.h"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute and time algorithm 0 vectorized and multithreaded
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam R Filter order
+ */
+template<int R>
+void alg0_simd( float *h_img,
+                const int& width, const int& height, const int& runtimes,
+                const gpufilter::Vector<float, R+1>& w,
+                const int& border,
+                const gpufilter::BorderType& btype ) {
+
+    std::vector<float> h_in(h_img, h_img + width*height);
+
+    gpufilter::base_timer &timer_total =
+        gpufilter::timers.cpu_add("alg0_simd_cpu", width*height, "iP");
+
+    for (int r = 0; r < runtimes; ++r) {
+        if (r > 0) // filtering is in-place, restart from the input
+            std::copy(h_in.begin(), h_in.end(), h_img);
+        gpufilter::alg0_simd_cpu<R>(h_img, width, height, w, border, btype);
+    }
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        gpufilter::timers.flush();
+
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, simd_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, simd_img, w, a0border, me, mre,
+                  argc, argv);
+
+    if (runtimes == 1) // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+
+    gpufilter::alg0_cached<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+
+    // same job as the reference, thus the same border
+    alg0_simd<ORDER>(&simd_img[0], width, height, runtimes, w, a0border, btype);
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &simd_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,279 @@
+/**
+ *  @file alg0_simd_cpu.h
+ *  @brief Algorithm 0 in the CPU vectorized and multithreaded
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG0_SIMD_CPU_H
+#define ALG0_SIMD_CPU_H
+
+//== INCLUDES ===================================================================
+
+#include <vector>
+#include <cassert>
+
+#include <util/image.h>
+#include <util/linalg.h>
+#include <util/recfilter.h>
+
+//== DEFINES ===================================================================
+
+#ifndef CPU_LANES // external define it to force the number of SIMD lanes
+#if defined(__AVX512F__)
+#define CPU_LANES 16 ///< Number of SIMD lanes (AVX-512: 16 floats)
+#elif defined(__AVX__)
+#define CPU_LANES 8 ///< Number of SIMD lanes (AVX and AVX2: 8 floats)
+#else
+#define CPU_LANES 4 ///< Number of SIMD lanes (SSE and NEON: 4 floats)
+#endif
+#endif
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//=== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute R-order causal recursive filtering on a panel of lanes
+ *
+ *  A panel is CPU_LANES independent sequences filtered side by side,
+ *  the lanes of each sequence element are adjacent in memory (e.g.
+ *  adjacent columns of an image), thus each step of the recursion is
+ *  one SIMD operation over all lanes.  The arithmetic is the same as
+ *  fwd(), in the same order, hence the results match the naïve
+ *  recursive_rows_fwd() and recursive_cols_fwd().
+ *
+ *  @param[in,out] inout The panel first element (of the first lane)
+ *  @param[in] n Number of elements of each sequence
+ *  @param[in] stride Distance between consecutive elements (in values)
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam T Image value type
+ */
+template <int R, class T>
+void simd_panel_fwd( T *inout,
+                     const int& n, const int& stride,
+                     const Vector<T,R+1> &weights ) {
+
+    T p[R][CPU_LANES], w[R+1];
+
+    for (int r = 0; r <= R; ++r)
+        w[r] = weights[r];
+
+    for (int r = 0; r < R; ++r)
+        for (int l = 0; l < CPU_LANES; ++l)
+            p[r][l] = (T)0;
+
+    for (int i = 0; i < n; ++i, inout += stride) {
+
+#pragma omp simd
+        for (int l = 0; l < CPU_LANES; ++l) {
+            T acc = inout[l]*w[0] - p[R-1][l]*w[1];
+            for (int k = R-1; k >= 1; --k) {
+                acc -= p[R-1-k][l]*w[k+1];
+                p[R-1-k][l] = p[R-k][l];
+            }
+            inout[l] = p[R-1][l] = acc;
+        }
+
+    }
+
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute R-order anticausal recursive filtering on a panel of lanes
+ *
+ *  Same as simd_panel_fwd() in the reverse direction, with the
+ *  arithmetic of rev().
+ *
+ *  @param[in,out] inout The panel first element (of the first lane)
+ *  @param[in] n Number of elements of each sequence
+ *  @param[in] stride Distance between consecutive elements (in values)
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam T Image value type
+ */
+template <int R, class T>
+void simd_panel_rev( T *inout,
+                     const int& n, const int& stride,
+                     const Vector<T,R+1> &weights ) {
+
+    T e[R][CPU_LANES], w[R+1];
+
+    for (int r = 0; r <= R; ++r)
+        w[r] = weights[r];
+
+    for (int r = 0; r < R; ++r)
+        for (int l = 0; l < CPU_LANES; ++l)
+            e[r][l] = (T)0;
+
+    inout += (n-1)*(long)stride;
+
+    for (int i = n-1; i >= 0; --i, inout -= stride) {
+
+#pragma omp simd
+        for (int l = 0; l < CPU_LANES; ++l) {
+            T acc = inout[l]*w[0] - e[0][l]*w[1];
+            for (int k = R-1; k >= 1; --k) {
+                acc -= e[k][l]*w[k+1];
+                e[k][l] = e[k-1][l];
+            }
+            inout[l] = e[0][l] = acc;
+        }
+
+    }
+
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute R-order recursive filtering on rows forward and reverse
+ *
+ *  The rows are taken CPU_LANES at a time: the tile of rows is
+ *  transposed to a per-thread buffer, in square sub-tiles of
+ *  CPU_LANES x CPU_LANES values to stay in cache, so the rows become
+ *  adjacent lanes filtered by simd_panel_fwd() and simd_panel_rev(),
+ *  and transposed back.  The tiles of rows are spread across the
+ *  cores (with OpenMP).
+ *
+ *  @param[in,out] inout The 2D image to compute recursive filtering
+ *  @param[in] w Width of the input image
+ *  @param[in] h Height of the input image (multiple of CPU_LANES)
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam T Image value type
+ */
+template <int R, class T>
+void simd_rows( T *inout,
+                const int& w, const int& h,
+                const Vector<T,R+1> &weights ) {
+
+    assert(h%CPU_LANES == 0);
+
+#pragma omp parallel
+    {
+
+        std::vector<T> buf(w*CPU_LANES);
+        T *t = &buf[0];
+
+#pragma omp for schedule(static)
+        for (int y0 = 0; y0 < h; y0 += CPU_LANES) {
+
+            T *rows = inout + (long)y0*w;
+
+            for (int x0 = 0; x0 < w; x0 += CPU_LANES) { // transpose rows to lanes
+                int xe = x0+CPU_LANES < w ? x0+CPU_LANES : w;
+                for (int l = 0; l < CPU_LANES; ++l)
+                    for (int x = x0; x < xe; ++x)
+                        t[x*CPU_LANES+l] = rows[l*w+x];
+            }
+
+            simd_panel_fwd<R>(t, w, CPU_LANES, weights);
+            simd_panel_rev<R>(t, w, CPU_LANES, weights);
+
+            for (int x0 = 0; x0 < w; x0 += CPU_LANES) { // transpose lanes back
+                int xe = x0+CPU_LANES < w ? x0+CPU_LANES : w;
+                for (int l = 0; l < CPU_LANES; ++l)
+                    for (int x = x0; x < xe; ++x)
+                        rows[l*w+x] = t[x*CPU_LANES+l];
+            }
+
+        }
+
+    }
+
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute R-order recursive filtering on columns forward and reverse
+ *
+ *  The columns are taken CPU_LANES adjacent ones at a time, filtered
+ *  in place by simd_panel_fwd() and simd_panel_rev(), and the panels
+ *  of columns are spread across the cores (with OpenMP).
+ *
+ *  @param[in,out] inout The 2D image to compute recursive filtering
+ *  @param[in] w Width of the input image (multiple of CPU_LANES)
+ *  @param[in] h Height of the input image
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam T Image value type
+ */
+template <int R, class T>
+void simd_cols( T *inout,
+                const int& w, const int& h,
+                const Vector<T,R+1> &weights ) {
+
+    assert(w%CPU_LANES == 0);
+
+#pragma omp parallel for schedule(static)
+    for (int x0 = 0; x0 < w; x0 += CPU_LANES) {
+        simd_panel_fwd<R>(inout + x0, h, w, weights);
+        simd_panel_rev<R>(inout + x0, h, w, weights);
+    }
+
+}
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute algorithm 0 in the CPU vectorized and multithreaded
+ *
+ *  This is the production CPU backend of alg0_cpu(), with the same
+ *  arguments and the same results (the same operations in the same
+ *  order, with no FMA contraction of the host code, see CPU_NATIVE
+ *  in the root CMakeLists.txt): the image is extended by the
+ *  border blocks and aligned to 32 pixels, filtered on rows (see
+ *  simd_rows()) and then on columns (see simd_cols()), and cropped
+ *  back.  The number of SIMD lanes is set by the instruction set
+ *  compiled to (see CPU_LANES) and the number of threads by OpenMP
+ *  (e.g. the OMP_NUM_THREADS environment variable).
+ *
+ *  @param[in,out] inout The 2D image to compute recursive filtering
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] weights Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] border_type Border type (either zero, clamp, repeat or reflect)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg0_simd_cpu( float *inout,
+                    int width, int height,
+                    const Vector<float, R+1> &weights,
+                    int border=0,
+                    BorderType border_type=CLAMP_TO_ZERO ) {
+
+    int border_left, border_top, border_right, border_bottom;
+
+    calc_borders(&border_left, &border_top, &border_right, &border_bottom,
+                 width, height, border);
+
+    float *eimg = extend_image(inout, width, height,
+                               border_top, border_left,
+                               border_bottom, border_right,
+                               border_type);
+
+    int nw = width+border_left+border_right,
+        nh = height+border_top+border_bottom;
+
+    simd_rows<R>(eimg, nw, nh, weights);
+    simd_cols<R>(eimg, nw, nh, weights);
+
+    crop_image(inout, eimg, width, height,
+               border_top, border_left,
+               border_bottom, border_right);
+
+    delete [] eimg;
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG0_SIMD_CPU_H
+//==============================================================================
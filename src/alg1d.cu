@@ -0,0 +1,92 @@
+/**
+ *  @file alg1d.cu
+ *  @brief Block-parallel 1D algorithm in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#ifndef CHUNK
+#define CHUNK 0 // samples of each streamed chunk (zero means the whole signal)
+#endif
+#define APPNAME "[alg1d_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg1d_gpu.cuh"
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, gpu_img, w, a0border, me, mre,
+                  argc, argv);
+
+    // the signal is the image seen as one long row (zero border only)
+    const int size = width*height, padded = (size+BS-1)/BS*BS;
+
+    if (runtimes == 1) { // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+        std::cout << APPNAME << " Signal size: " << size << "\n";
+    }
+
+    cpu_img.resize(padded, 0.f);
+    gpufilter::recursive_rows_fwd<ORDER>(&cpu_img[0], padded, 1, w);
+    gpufilter::recursive_rows_rev<ORDER>(&cpu_img[0], padded, 1, w);
+
+    if (CHUNK == 0) {
+        gpufilter::alg1d_gpu<ORDER>(&gpu_img[0], size, runtimes, w);
+    } else { // streaming chunks (the signal is padded to whole chunks)
+        gpufilter::alg1d_stream_plan<ORDER> plan;
+        gpufilter::prepare_alg1d_stream(plan, CHUNK, w);
+        const int chunk = plan.chunk, n_chunks = (size+chunk-1)/chunk;
+        std::vector<float> in(n_chunks*chunk, 0.f), out(n_chunks*chunk);
+        std::copy(gpu_img.begin(), gpu_img.end(), in.begin());
+        for (int c = 0; c < n_chunks; ++c)
+            gpufilter::push(plan, &in[c*chunk], c > 0 ? &out[(c-1)*chunk] : 0);
+        gpufilter::flush(plan, &out[(n_chunks-1)*chunk]);
+        std::copy(out.begin(), out.begin()+size, gpu_img.begin());
+    }
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &gpu_img[0], size, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,651 @@
+/**
+ *  @file alg1d_gpu.cuh
+ *  @brief Block-parallel recursive filtering of long 1D signals in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG1D_GPU_CUH
+#define ALG1D_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <climits>
+#include <stdexcept>
+
+#include "gpuplan.h"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Load one segment (32 blocks of 32 samples) of a signal in shared memory
+ *  @param[out] tile The segment, one block per row
+ *  @param[in] g_seg The segment in global memory
+ */
+__device__ inline
+void load_segment( float tile[WS][WS+1],
+                   const float *g_seg ) {
+    int tx = threadIdx.x;
+#pragma unroll
+    for (int i=0; i<WS; ++i)
+        tile[i][tx] = g_seg[i*WS+tx];
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 1D step 1
+ *
+ *  In parallel for all blocks \f$b\f$ of 32 samples, compute and
+ *  store the block perimeters \f$P_b(Y)\f$ and \f$E_b(Z)\f$ as
+ *  algorithm 5 does for each row of a block.  Each warp loads one
+ *  segment of 32 consecutive blocks (coalesced) and each thread
+ *  scans one block.
+ *
+ *  @param[in] g_in The input signal (padded to whole CUDA blocks)
+ *  @param[out] g_pybar All \f$P_b(Y)\f$
+ *  @param[out] g_ezhat All \f$E_b(Z)\f$
+ *  @param[in] params Filter parameters with the filter weights
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS*NW1)
+void alg1d_step1( const float *g_in,
+                  Vector<float,R> *g_pybar,
+                  Vector<float,R> *g_ezhat,
+                  const filter_params<R> params ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, seg = blockIdx.x*NW1+ty,
+        b = seg*WS+tx;
+
+    __shared__ float tile[NW1][WS][WS+1];
+    load_segment(tile[ty], g_in + (size_t)seg*WS*WS);
+    __syncthreads();
+
+    float x[WS];
+#pragma unroll
+    for (int j=0; j<WS; ++j)
+        x[j] = tile[ty][tx][j];
+
+    Vector<float,R> p = zeros<float,R>();
+
+#pragma unroll // calculate pybar, scan left -> right
+    for (int j=0; j<WS; ++j)
+        x[j] = fwdI(p, x[j], params.weights);
+
+    g_pybar[b] = p;
+
+    Vector<float,R> e = zeros<float,R>();
+
+#pragma unroll // calculate ezhat, scan right -> left
+    for (int j=WS-1; j>=0; --j)
+        revI(x[j], e, params.weights);
+
+    g_ezhat[b] = e;
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Reduce groups of 32 carries of a linear recurrence
+ *
+ *  The carries follow \f$v_i = a_i + v_{i-1} M\f$ (in traversal
+ *  order, backwards for the reverse carries).  Each thread computes
+ *  the aggregate of one group of 32 consecutive carries (from a zero
+ *  incoming carry), and the aggregates follow the same recurrence
+ *  with \f$M^{32}\f$, solved one level up.
+ *
+ *  @param[in] g_a All carries \f$a_i\f$
+ *  @param[out] g_agg Aggregate of each group (in traversal order)
+ *  @param[in] count Number of carries
+ *  @param[in] M The recurrence matrix of this level
+ *  @tparam R Filter order
+ *  @tparam REV Flag to traverse the carries backwards
+ */
+template <int R, bool REV>
+__global__
+void alg1d_scan_reduce( const Vector<float,R> *g_a,
+                        Vector<float,R> *g_agg,
+                        int count,
+                        const Matrix<float,R,R> M ) {
+
+    int g = blockIdx.x*blockDim.x+threadIdx.x;
+    if (g*WS >= count) return;
+
+    Vector<float,R> acc = zeros<float,R>();
+    for (int i = g*WS; i < (g+1)*WS && i < count; ++i)
+        acc = g_a[REV ? count-1-i : i] + acc * M;
+
+    g_agg[g] = acc;
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Solve groups of 32 carries of a linear recurrence
+ *
+ *  Each thread re-runs one group of 32 consecutive carries from its
+ *  incoming carry (the solved aggregate of the previous group, or the
+ *  initial carry for the first group), storing the solved carries.
+ *
+ *  @param[in,out] g_a All carries \f$a_i\f$ (solved \f$v_i\f$ on output)
+ *  @param[in] g_vend Solved aggregate of each group (in traversal order)
+ *  @param[in] count Number of carries
+ *  @param[in] M The recurrence matrix of this level
+ *  @param[in] g_init Initial incoming carry (zero if null)
+ *  @tparam R Filter order
+ *  @tparam REV Flag to traverse the carries backwards
+ */
+template <int R, bool REV>
+__global__
+void alg1d_scan_down( Vector<float,R> *g_a,
+                      const Vector<float,R> *g_vend,
+                      int count,
+                      const Matrix<float,R,R> M,
+                      const Vector<float,R> *g_init ) {
+
+    int g = blockIdx.x*blockDim.x+threadIdx.x;
+    if (g*WS >= count) return;
+
+    Vector<float,R> v = g > 0 ? g_vend[g-1] : (g_init ? *g_init : zeros<float,R>());
+    for (int i = g*WS; i < (g+1)*WS && i < count; ++i) {
+        int k = REV ? count-1-i : i;
+        v = g_a[k] + v * M;
+        g_a[k] = v;
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 1D reverse carries fix
+ *
+ *  Add the effect of the (solved) forward carry entering each block
+ *  to its reverse perimeter, as in equation (25).  Blocks past the
+ *  end of the signal stay zero.
+ *
+ *  @param[in,out] g_ezhat All \f$E_b(Z)\f$
+ *  @param[in] g_py All solved \f$P_b(y)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] n_blocks Number of blocks of the signal
+ *  @param[in] g_pinit Forward carry entering the first block (zero if null)
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__
+void alg1d_fix_ezhat( Vector<float,R> *g_ezhat,
+                      const Vector<float,R> *g_py,
+                      const filter_params<R> params,
+                      int n_blocks,
+                      const Vector<float,R> *g_pinit ) {
+
+    int b = blockIdx.x*blockDim.x+threadIdx.x;
+    if (b >= n_blocks) return;
+
+    Vector<float,R> py = b > 0 ? g_py[b-1] : (g_pinit ? *g_pinit : zeros<float,R>());
+    g_ezhat[b] = g_ezhat[b] + py * params.HARB_AFP_T;
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 1D step 3
+ *
+ *  In parallel for all blocks, filter each block forward and reverse
+ *  from its solved incoming carries and store the output (only
+ *  samples of the signal, thus the padding stays zero).  In-place
+ *  filtering is safe: each CUDA block reads and writes its own
+ *  segments only.
+ *
+ *  @param[in] g_in The input signal (padded to whole CUDA blocks)
+ *  @param[out] g_out The output signal (may be the input)
+ *  @param[in] g_py All solved \f$P_b(y)\f$
+ *  @param[in] g_ez All solved \f$E_b(z)\f$
+ *  @param[in] params Filter parameters with the filter weights
+ *  @param[in] size Number of samples of the signal
+ *  @param[in] n_blocks Number of blocks of the signal
+ *  @param[in] g_pinit Forward carry entering the first block (zero if null)
+ *  @param[in] g_einit Reverse carry entering the last block (zero if null)
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS*NW1)
+void alg1d_step3( const float *g_in,
+                  float *g_out,
+                  const Vector<float,R> *g_py,
+                  const Vector<float,R> *g_ez,
+                  const filter_params<R> params,
+                  size_t size, int n_blocks,
+                  const Vector<float,R> *g_pinit,
+                  const Vector<float,R> *g_einit ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, seg = blockIdx.x*NW1+ty,
+        b = seg*WS+tx;
+
+    __shared__ float tile[NW1][WS][WS+1];
+    load_segment(tile[ty], g_in + (size_t)seg*WS*WS);
+    __syncthreads();
+
+    float x[WS];
+#pragma unroll
+    for (int j=0; j<WS; ++j)
+        x[j] = tile[ty][tx][j];
+
+    Vector<float,R> p = b > 0 ? g_py[b-1] : (g_pinit ? *g_pinit : zeros<float,R>());
+
+#pragma unroll // calculate block, scan left -> right
+    for (int j=0; j<WS; ++j)
+        x[j] = fwdI(p, x[j], params.weights);
+
+    Vector<float,R> e = b+1 < n_blocks ? g_ez[b+1] : (g_einit ? *g_einit : zeros<float,R>());
+
+#pragma unroll // calculate block, scan right -> left
+    for (int j=WS-1; j>=0; --j)
+        x[j] = revI(x[j], e, params.weights);
+
+#pragma unroll
+    for (int j=0; j<WS; ++j)
+        tile[ty][tx][j] = x[j];
+    __syncthreads();
+
+    size_t i0 = (size_t)seg*WS*WS;
+#pragma unroll
+    for (int i=0; i<WS; ++i)
+        if (i0+i*WS+tx < size)
+            g_out[i0+i*WS+tx] = tile[ty][i][tx];
+
+}
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg1d_plan alg1d_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of the block-parallel 1D algorithm
+ *
+ *  A long 1D signal is split in blocks of 32 samples with the same
+ *  carries \f$P\f$ and \f$E\f$ and fixing matrices as the rows of the
+ *  2D algorithms.  Instead of one sequential pass over all blocks (as
+ *  alg3v4v5v6_step2v4() does per row), the carries are solved in a
+ *  hierarchy of groups of 32, each level with the recurrence matrix
+ *  raised to the 32nd power, so one long signal fills the whole GPU.
+ *  The signal is padded with zeros to a multiple of 32 samples (as
+ *  images are in the 2D algorithms).
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg1d_plan {
+
+    size_t size; ///< Number of samples of the signal
+    int n_blocks; ///< Number of blocks of 32 samples
+    int n_segments; ///< Number of segments (32 blocks) padded to whole CUDA blocks
+    Vector<float, R+1> w; ///< Filter weights
+    alg_matrices<R> mat; ///< Pre-computed matrices
+    filter_params<R> params; ///< Filter parameters given to the kernels
+    std::vector< Matrix<float,R,R> > fwd_pow, rev_pow; ///< AbF and AbR to the 32^k power
+    dvector<float> d_signal; ///< Signal in device memory (padded)
+    dvector< Vector<float,R> > d_py, d_ez; ///< Carries of all blocks
+    std::vector< dvector< Vector<float,R> > > d_agg; ///< Aggregates per level
+    dvector< Vector<float,R> > d_init; ///< Incoming forward and reverse carries
+    cudaStream_t stream; ///< Stream to launch kernels on (default stream)
+
+    /// Default constructor
+    alg1d_plan() : size(0), n_blocks(0), n_segments(0), stream(0) { }
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the 1D algorithm plan in the GPU
+ *  @param[out] plan Prepared plan
+ *  @param[in] size Number of samples of the signal
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg1d( alg1d_plan<R>& plan,
+                    size_t size,
+                    const Vector<float, R+1>& w ) {
+
+    size_t n_blocks = (size+WS-1)/WS;
+    if (n_blocks > (size_t)INT_MAX - WS*NW1)
+        throw std::runtime_error("Signal too long for a 1D plan");
+
+    plan.size = size;
+    plan.n_blocks = (int)n_blocks;
+    plan.n_segments = (plan.n_blocks+WS*NW1-1)/(WS*NW1)*NW1;
+    plan.w = w;
+
+    calc_matrices(plan.mat, w);
+    plan.params = make_params(w, plan.mat, 0);
+
+    // matrix powers 32^k in double to keep the upper levels accurate
+    Matrix<double,R,R> F = convert<double>(plan.mat.AbF_T),
+        B = convert<double>(plan.mat.AbR_T);
+    plan.fwd_pow.clear(); plan.rev_pow.clear(); plan.d_agg.clear();
+    for (long long count = plan.n_blocks; ; count = (count+WS-1)/WS) {
+        plan.fwd_pow.push_back(convert<float>(F));
+        plan.rev_pow.push_back(convert<float>(B));
+        if (count <= WS) break;
+        plan.d_agg.push_back(dvector< Vector<float,R> >((count+WS-1)/WS));
+        for (int s = 0; s < 5; ++s) { F = F*F; B = B*B; } // 2^5 = 32
+    }
+
+    plan.d_signal.resize((size_t)plan.n_segments*WS*WS);
+    plan.d_signal.fillzero();
+    plan.d_py.resize(plan.n_segments*WS);
+    plan.d_ez.resize(plan.n_segments*WS);
+    plan.d_init.resize(2);
+    plan.d_init.fillzero();
+
+    check_cuda_error("Error preparing 1D plan");
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Solve a linear recurrence of carries in the hierarchy of levels
+ *  @param[in,out] plan The plan (with the aggregates per level)
+ *  @param[in,out] d_a The carries to solve
+ *  @param[in] count Number of carries
+ *  @param[in] pow The recurrence matrix of each level
+ *  @param[in] level The level of the carries
+ *  @param[in] d_init Initial incoming carry (zero if null)
+ *  @tparam R Filter order
+ *  @tparam REV Flag to traverse the carries backwards
+ */
+template <bool REV, int R>
+void alg1d_scan( alg1d_plan<R>& plan,
+                 Vector<float,R> *d_a,
+                 int count,
+                 const std::vector< Matrix<float,R,R> >& pow,
+                 int level,
+                 const Vector<float,R> *d_init ) {
+
+    int groups = (count+WS-1)/WS, nt = 128;
+
+    if (count <= WS) {
+        alg1d_scan_down<R,REV><<< 1, 1, 0, plan.stream >>>
+            ( d_a, 0, count, pow[level], d_init );
+        return;
+    }
+
+    Vector<float,R> *d_agg = &plan.d_agg[level];
+
+    alg1d_scan_reduce<R,REV><<< (groups+nt-1)/nt, nt, 0, plan.stream >>>
+        ( d_a, d_agg, count, pow[level] );
+
+    alg1d_scan<false>(plan, d_agg, groups, pow, level+1, d_init);
+
+    alg1d_scan_down<R,REV><<< (groups+nt-1)/nt, nt, 0, plan.stream >>>
+        ( d_a, d_agg, count, pow[level], d_init );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run the 1D algorithm on a signal in device memory
+ *
+ *  The input must be padded with zeros to the plan segments (as the
+ *  plan signal is).  The incoming carries let a long signal be
+ *  filtered in parts.
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] d_in The input signal in device memory (padded)
+ *  @param[out] d_out The output signal in device memory (may be the input)
+ *  @param[in] d_pinit Forward carry entering the signal (zero if null)
+ *  @param[in] d_einit Reverse carry entering the signal end (zero if null)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg1d_gpu( alg1d_plan<R>& plan,
+                const float *d_in,
+                float *d_out,
+                const Vector<float,R> *d_pinit=0,
+                const Vector<float,R> *d_einit=0 ) {
+
+    const int nb = plan.n_blocks, nt = 128;
+
+    alg1d_step1<<< plan.n_segments/NW1, dim3(WS, NW1), 0, plan.stream >>>
+        ( d_in, &plan.d_py, &plan.d_ez, plan.params );
+
+    alg1d_scan<false>(plan, &plan.d_py, nb, plan.fwd_pow, 0, d_pinit);
+
+    alg1d_fix_ezhat<<< (nb+nt-1)/nt, nt, 0, plan.stream >>>
+        ( &plan.d_ez, &plan.d_py, plan.params, nb, d_pinit );
+
+    alg1d_scan<true>(plan, &plan.d_ez, nb, plan.rev_pow, 0, d_einit);
+
+    alg1d_step3<<< plan.n_segments/NW1, dim3(WS, NW1), 0, plan.stream >>>
+        ( d_in, d_out, &plan.d_py, &plan.d_ez, plan.params,
+          plan.size, nb, d_pinit, d_einit );
+
+    check_cuda_error("Error running 1D algorithm");
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run the 1D algorithm plan (in place on the plan signal)
+ *  @param[in,out] plan The plan to run (with its input uploaded)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg1d_gpu( alg1d_plan<R>& plan ) {
+    alg1d_gpu(plan, &plan.d_signal, &plan.d_signal);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a signal in host memory to the 1D plan
+ *  @param[in,out] plan The plan to receive the signal
+ *  @param[in] h_sig The input signal in host memory
+ */
+template <int R>
+void upload( alg1d_plan<R>& plan,
+             const float *h_sig ) {
+    cudaMemcpyAsync(&plan.d_signal, h_sig, plan.size*sizeof(float),
+                    cudaMemcpyHostToDevice, plan.stream);
+    check_cuda_error("Error uploading input signal");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the 1D plan signal to host memory
+ *  @param[in] plan The plan with the output signal
+ *  @param[out] h_sig The output signal in host memory
+ */
+template <int R>
+void download( const alg1d_plan<R>& plan,
+               float *h_sig ) {
+    cudaMemcpyAsync(h_sig, plan.d_signal, plan.size*sizeof(float),
+                    cudaMemcpyDeviceToHost, plan.stream);
+    cudaStreamSynchronize(plan.stream);
+    check_cuda_error("Error downloading output signal");
+}
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg1d_stream_plan alg1d_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of the 1D algorithm streaming chunks of an unbounded signal
+ *
+ *  The forward (causal) filter is carried exactly from chunk to
+ *  chunk.  The reverse (anticausal) filter of one chunk needs the
+ *  future of the signal, thus each chunk output is only given when
+ *  the next chunk arrives, the reverse filter starting from zero at
+ *  the end of the next chunk (one chunk of latency).  Its error
+ *  decays as the filter impulse response over one chunk, negligible
+ *  for chunks much longer than the filter support.  The last chunk
+ *  given by flush() has zero border, as the 1D algorithm.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg1d_stream_plan {
+
+    size_t chunk; ///< Number of samples of each chunk (multiple of 32)
+    bool pending; ///< Flag of a chunk waiting its output
+    alg1d_plan<R> tail; ///< Plan of the last chunk (without lookahead)
+    alg1d_plan<R> pair; ///< Plan of two chunks (the first with its lookahead)
+    dvector<float> d_out; ///< Output of the two chunks
+    dvector< Vector<float,R> > d_state; ///< Forward carry entering the pending chunk
+
+    /// Default constructor
+    alg1d_stream_plan() : chunk(0), pending(false) { }
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the 1D streaming plan
+ *  @param[out] plan Prepared plan
+ *  @param[in] chunk Number of samples of each chunk (rounded up to 32)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg1d_stream( alg1d_stream_plan<R>& plan,
+                           size_t chunk,
+                           const Vector<float, R+1>& w ) {
+    plan.chunk = (chunk+WS-1)/WS*WS;
+    plan.pending = false;
+    prepare_alg1d(plan.tail, plan.chunk, w);
+    prepare_alg1d(plan.pair, 2*plan.chunk, w);
+    plan.d_out.resize(plan.pair.d_signal.size());
+    plan.d_state.resize(1);
+    plan.d_state.fillzero();
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Push the next chunk of the signal to the 1D streaming plan
+ *  @param[in,out] plan The streaming plan
+ *  @param[in] h_chunk The next chunk of the signal in host memory (chunk samples)
+ *  @param[out] h_out The output of the previous chunk in host memory
+ *  @return True if the previous chunk output was given (false on the first push)
+ *  @tparam R Filter order
+ */
+template <int R>
+bool push( alg1d_stream_plan<R>& plan,
+           const float *h_chunk,
+           float *h_out ) {
+
+    float *d_pend = &plan.pair.d_signal, *d_next = d_pend + plan.chunk;
+    cudaStream_t stream = plan.pair.stream;
+
+    if (!plan.pending) {
+        cudaMemcpyAsync(d_pend, h_chunk, plan.chunk*sizeof(float),
+                        cudaMemcpyHostToDevice, stream);
+        plan.pending = true;
+        return false;
+    }
+
+    cudaMemcpyAsync(d_next, h_chunk, plan.chunk*sizeof(float),
+                    cudaMemcpyHostToDevice, stream);
+
+    alg1d_gpu(plan.pair, &plan.pair.d_signal, &plan.d_out, &plan.d_state);
+
+    // forward carry leaving the pending chunk enters the next one
+    cudaMemcpyAsync(&plan.d_state, &plan.pair.d_py + plan.chunk/WS-1,
+                    sizeof(Vector<float,R>), cudaMemcpyDeviceToDevice, stream);
+    cudaMemcpyAsync(h_out, &plan.d_out, plan.chunk*sizeof(float),
+                    cudaMemcpyDeviceToHost, stream);
+    cudaMemcpyAsync(d_pend, d_next, plan.chunk*sizeof(float),
+                    cudaMemcpyDeviceToDevice, stream);
+    cudaStreamSynchronize(stream);
+
+    check_cuda_error("Error pushing chunk to 1D stream");
+
+    return true;
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Flush the last chunk of the 1D streaming plan
+ *  @param[in,out] plan The streaming plan
+ *  @param[out] h_out The output of the last chunk in host memory
+ *  @return True if there was a chunk to flush
+ *  @tparam R Filter order
+ */
+template <int R>
+bool flush( alg1d_stream_plan<R>& plan,
+            float *h_out ) {
+
+    if (!plan.pending) return false;
+
+    cudaStream_t stream = plan.tail.stream;
+
+    cudaMemcpyAsync(&plan.tail.d_signal, &plan.pair.d_signal, plan.chunk*sizeof(float),
+                    cudaMemcpyDeviceToDevice, stream);
+    alg1d_gpu(plan.tail, &plan.tail.d_signal, &plan.tail.d_signal, &plan.d_state);
+    download(plan.tail, h_out);
+
+    plan.d_state.fillzero();
+    plan.pending = false;
+
+    return true;
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the 1D algorithm in the GPU
+ *
+ *  Given an input 1D signal compute the recursive filtering (causal
+ *  then anticausal) with zero border of the signal.
+ *
+ *  @param[in,out] h_sig The in(out)put 1D signal to filter in host memory
+ *  @param[in] size Number of samples of the signal
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg1d_gpu( float *h_sig,
+                size_t size,
+                const int& runtimes,
+                const Vector<float, R+1>& w ) {
+
+    alg1d_plan<R> plan;
+    prepare_alg1d(plan, size, w);
+
+    upload(plan, h_sig);
+
+    dvector<float> d_out(plan.d_signal.size());
+
+    base_timer &timer_total = timers.gpu_add("alg1d_gpu", size, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg1d_gpu(plan, &plan.d_signal, &d_out);
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+    cudaMemcpy(h_sig, d_out, size*sizeof(float), cudaMemcpyDeviceToHost);
+    check_cuda_error("Error downloading output signal");
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG1D_GPU_CUH
+//==============================================================================
@@ -35,6 +35,7 @@
 #include "gpudefs.h"
 #include "alg0_cpu.h"
 #include "alg3_gpu.cuh"
+#include "gpufilter_inst.cuh"
 
 //== IMPLEMENTATION ============================================================
 
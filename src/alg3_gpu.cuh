@@ -9,11 +9,8 @@
 #ifndef ALG3_GPU_CUH
 #define ALG3_GPU_CUH
 
-#define MST == // measure step time: no: == ; yes: >=
 #define LDG // uncomment to use __ldg
-#if ORDER==1 || ORDER==2 || ORDER==5
-#define REGS // uncomment to use registers
-#endif
+#define REGS // uncomment to use registers (in the common kernels)
 
 //== INCLUDES ==================================================================
 
@@ -41,6 +38,7 @@ namespace gpufilter {
  *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
@@ -54,7 +52,8 @@ namespace gpufilter {
  */
 template <bool BORDER, int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg3_step3( float *g_out,
+void alg3_step3( cudaTextureObject_t tex,
+                 float *g_out,
                  const Matrix<float,R,WS> *g_py,
                  const Matrix<float,R,WS> *g_ez,
                  float inv_width, float inv_height,
@@ -65,22 +64,23 @@ void alg3_step3( float *g_out,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWW>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
+        read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
-#ifdef REGS
+    // registers only pay off for these orders, chosen by the template
+    // (not by REGS) as the library instantiates all orders together
+    const bool regs = R == 1 || R == 2 || R == 5;
     float x[32];
-#endif
 
     if (ty==0) {
 
-#ifdef REGS
+        if (regs) {
 #pragma unroll
-        for (int i=0; i<32; ++i)
-            x[i] = block[tx][i];
-#endif
+            for (int i=0; i<32; ++i)
+                x[i] = block[tx][i];
+        }
 
         Vector<float,R> p, e;
 
@@ -94,11 +94,10 @@ void alg3_step3( float *g_out,
 
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
-#ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
-#else
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
-#endif
+            if (regs)
+                x[j] = fwdI(p, x[j], consts<R>().weights);
+            else
+                block[tx][j] = fwdI(p, block[tx][j], consts<R>().weights);
 
 #ifdef LDG
 #pragma unroll
@@ -110,42 +109,33 @@ void alg3_step3( float *g_out,
 
 #pragma unroll // calculate block, scan right -> left
         for (int j=WS-1; j>=0; --j)
-#ifdef REGS
-            x[j] = revI(x[j], e, c_weights);
-#else
-            block[tx][j] = revI(block[tx][j], e, c_weights);
-#endif
+            if (regs)
+                x[j] = revI(x[j], e, consts<R>().weights);
+            else
+                block[tx][j] = revI(block[tx][j], e, consts<R>().weights);
 
-#ifdef REGS
+        if (regs) {
 #pragma unroll // transpose regs part-1
-        for (int i=0; i<32; ++i)
-            block[tx][i] = x[i];
+            for (int i=0; i<32; ++i)
+                block[tx][i] = x[i];
 #pragma unroll // transpose regs part-2
-        for (int i=0; i<32; ++i)
-            x[i] = block[i][tx];
-#endif
+            for (int i=0; i<32; ++i)
+                x[i] = block[i][tx];
+        }
 
         if (BORDER) {
             if ((m >= c_border) && (m < m_size-c_border) && (n >= c_border) && (n < n_size-c_border)) {
                 g_out += ((n-c_border+1)*WS-1)*out_stride + (m-c_border)*WS+tx;
 #pragma unroll // write block inside valid image
                 for (int i=0; i<WS; ++i, g_out-=out_stride) {
-#ifdef REGS
-                    *g_out = x[WS-1-i];
-#else
-                    *g_out = block[WS-1-i][tx];
-#endif
+                    *g_out = regs ? x[WS-1-i] : block[WS-1-i][tx];
                 }
             }
         } else {
             g_out += ((n+1)*WS-1)*out_stride + m*WS+tx;
 #pragma unroll // write block
             for (int i=0; i<WS; ++i, g_out-=out_stride) {
-#ifdef REGS
-                *g_out = x[WS-1-i];
-#else
-                *g_out = block[WS-1-i][tx];
-#endif
+                *g_out = regs ? x[WS-1-i] : block[WS-1-i][tx];
             }
         }
 
@@ -154,14 +144,26 @@ void alg3_step3( float *g_out,
 }
 
 /**
+ *  @struct alg3_plan alg3_gpu.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm 3 in the GPU
+ *  @brief Filter plan of algorithm 3
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+struct alg3_plan : public alg_plan {
+    Vector<float,R+1> w; ///< Filter weights
+    alg_matrices<R> mat; ///< Pre-computed basic matrices
+    dvector< Matrix<float,R,WS> > d_pybar, d_ezhat; ///< Row carries
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 3 plan in the GPU
  *
- *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[out] plan The plan to prepare
  *  @param[in] width Image width
  *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
  *  @param[in] w Filter weights (feedforward and feedback coefficients)
  *  @param[in] border Number of border blocks (32x32) outside image
  *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
@@ -170,155 +172,145 @@ void alg3_step3( float *g_out,
  */
 template <bool BORDER, int R>
 __host__
-void alg3_gpu( float *h_img,
-               int width, int height, int runtimes,
-               const Vector<float, R+1> &w,
-               int border=0,
-               BorderType border_type=CLAMP_TO_ZERO ) {
+void prepare_alg3( alg3_plan<BORDER,R>& plan,
+                   int width, int height,
+                   const Vector<float, R+1> &w,
+                   int border=0,
+                   BorderType btype=CLAMP_TO_ZERO ) {
 
-    const int B = WS;
+    if (!BORDER) { border = 0; btype = CLAMP_TO_ZERO; }
 
-    // pre-compute basic alg3 matrices
-    Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
+    prepare_plan(plan, width, height, border, btype, BORDER);
 
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w),
-                      ARE_T = rev(Zrb, Ir, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w),
-                      ARB_T = rev(Ib, Zbr, w);
+    plan.w = w;
+    calc_matrices(plan.mat, w);
 
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T),
-                      AbR_T = head<R>(ARE_T),
-                      HARB_AFP_T = AFP_T*head<R>(ARB_T);
+    // +1 padding is important even in zero-border to avoid if's in kernels
+    plan.d_pybar.resize((plan.m_size+1)*plan.n_size);
+    plan.d_ezhat.resize((plan.m_size+1)*plan.n_size);
+    plan.d_pybar.fillzero();
+    plan.d_ezhat.fillzero();
 
-    int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
+    cudaFuncSetCacheConfig(alg3v4_step1<BORDER,R>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg3_step3<BORDER,R>, cudaFuncCachePreferShared);
 
-    if (BORDER) {
-        int border_left, border_top, border_right, border_bottom;
-        calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
-                     width, height, border);
-        int ewidth = width+border_left+border_right,
-            eheight = height+border_top+border_bottom;
+    if (R == 1)
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, cudaFuncCachePreferL1);
+    else if (R == 2)
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, cudaFuncCachePreferEqual);
+    else if (R >= 3)
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, cudaFuncCachePreferShared);
 
-        m_size = (ewidth+WS-1)/WS;
-        n_size = (eheight+WS-1)/WS;
+}
 
-        copy_to_symbol(c_border, border);
-    }
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 3 plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional three timers to measure each step
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+__host__
+void alg3_gpu( alg3_plan<BORDER,R>& plan,
+               base_timer **timer=0 ) {
 
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AbR_T, AbR_T);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-
-    if (BORDER) {
-        switch(border_type) {
-        case CLAMP_TO_ZERO:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-            break;
-        case CLAMP_TO_EDGE:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
-            break;
-        case REPEAT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
-            break;
-        case REFLECT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeMirror;
-            break;
-        }
+    if (make_current(plan)) {
+        copy_to_symbol(c_border, plan.border);
+        copy_to_constants(&filter_constants<R>::weights, plan.w);
+
+        copy_to_constants(&filter_constants<R>::AbF_T, plan.mat.AbF_T);
+        copy_to_constants(&filter_constants<R>::AbR_T, plan.mat.AbR_T);
+        copy_to_constants(&filter_constants<R>::HARB_AFP_T, plan.mat.HARB_AFP_T);
     }
 
-    int stride_img = width+WS;
-    if (BORDER) stride_img = width+WS*border+WS;
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    const filter_params<R> params = make_params(plan.w, plan.mat, plan.border);
 
-    dvector<float> d_img(height*stride_img);
+    if (timer) timer[0]->start();
 
-    // +1 padding is important even in zero-border to avoid if's in kernels
-    dvector< Matrix<float,R,B> >
-        d_pybar((m_size+1)*n_size), d_ezhat((m_size+1)*n_size);
-    d_pybar.fillzero();
-    d_ezhat.fillzero();
+    alg3v4_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, plan.inv_width, plan.inv_height, m_size );
 
-    cudaFuncSetCacheConfig(alg3v4_step1<BORDER,R>, cudaFuncCachePreferShared);
-    cudaFuncSetCacheConfig(alg3_step3<BORDER,R>, cudaFuncCachePreferShared);
-
-    if (R == 1)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferL1);
-    else if (R == 2)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferEqual);
-    else if (R >= 3)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferShared);
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-    double te[3] = {0, 0, 0}; // time elapsed for the three steps
-    base_timer *timer[3];
-    for (int i = 0; i < 3; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+    alg3v4v5v6_step2v4<<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pybar, &plan.d_ezhat, params, m_size );
 
-    base_timer &timer_total = timers.gpu_add("alg3_gpu", width*height, "iP");
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-    for(int r = 0; r < runtimes; ++r) {
+    alg3_step3<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ezhat, plan.inv_height, plan.inv_width,
+          m_size, n_size, plan.stride_img );
 
-        if (runtimes MST 1) { timer[0]->start(); }
+    if (timer) timer[2]->stop();
 
-        cudaBindTextureToArray(t_in, a_in);
+}
 
-        alg3v4_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar, &d_ezhat, inv_width, inv_height, m_size );
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 3 in the GPU
+ *
+ *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+__host__
+void alg3_gpu( float *h_img,
+               int width, int height, int runtimes,
+               const Vector<float, R+1> &w,
+               int border=0,
+               BorderType border_type=CLAMP_TO_ZERO ) {
 
-        if (runtimes MST 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    alg3_plan<BORDER,R> plan;
+    prepare_alg3(plan, width, height, w, border, border_type);
 
-        alg3v4v5v6_step2v4<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar, &d_ezhat, m_size );
+    upload(plan, h_img);
 
-        if (runtimes MST 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    const char *steps[3] = { "step 1", "step 2", "step 3" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[3];
+    for (int i = 0; i < 3; ++i)
+        timer[i] = new step_timer(std::string("alg3_gpu ") + steps[i]);
 
-        alg3_step3<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar, &d_ezhat, inv_height, inv_width,
-              m_size, n_size, stride_img );
+    base_timer &timer_total = timers.gpu_add("alg3_gpu", width*height, "iP");
 
-        cudaUnbindTexture(t_in);
+    for(int r = 0; r < runtimes; ++r)
+        alg3_gpu(plan, timed ? timer : 0);
 
-        if (runtimes MST 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); }
+    timer_total.stop();
 
+    for (int i = 0; i < 3; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
     }
 
-    timer_total.stop();
-
     if (runtimes > 1) {
 
-        if (runtimes MST 1) {
+        if (timed) {
             for (int i = 0; i < 3; ++i)
-                std::cout << std::fixed << " " << te[i]/(double)runtimes << std::flush;
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
         } else {
             std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
         }
 
     } else {
 
-        timers.gpu_add("step 1", timer[0]);
-        timers.gpu_add("step 2", timer[1]);
-        timers.gpu_add("step 3", timer[2]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
@@ -9,6 +9,12 @@
 #ifndef ALG3v4v5v6_GPU_CUH
 #define ALG3v4v5v6_GPU_CUH
 
+//== INCLUDES ==================================================================
+
+#include <algorithm>
+
+#include "gpuplan.h"
+
 //== NAMESPACES ================================================================
 
 namespace gpufilter {
@@ -30,6 +36,7 @@ namespace gpufilter {
  *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[in] inv_width Image width inversed (1/w)
@@ -40,7 +47,8 @@ namespace gpufilter {
  */
 template <bool BORDER, int R>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg3v4_step1( Matrix<float,R,WS> *g_pybar, 
+void alg3v4_step1( cudaTextureObject_t tex,
+                   Matrix<float,R,WS> *g_pybar, 
                    Matrix<float,R,WS> *g_ezhat,
                    float inv_width, float inv_height,
                    int m_size ) {
@@ -49,9 +57,9 @@ void alg3v4_step1( Matrix<float,R,WS> *g_pybar,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWC>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWC>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWC>(block, m, n, inv_width, inv_height);
+        read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
 #ifdef REGS
@@ -71,9 +79,9 @@ void alg3v4_step1( Matrix<float,R,WS> *g_pybar,
 #pragma unroll // calculate pybar, scan left -> right
         for (int j=0; j<WS; ++j)
 #ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], consts<R>().weights);
 #else
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
+            block[tx][j] = fwdI(p, block[tx][j], consts<R>().weights);
 #endif
 
         g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
@@ -83,9 +91,9 @@ void alg3v4_step1( Matrix<float,R,WS> *g_pybar,
 #pragma unroll // calculate ezhat, scan right -> left
         for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-            revI(x[j], e, c_weights);
+            revI(x[j], e, consts<R>().weights);
 #else
-            revI(block[tx][j], e, c_weights);
+            revI(block[tx][j], e, consts<R>().weights);
 #endif
 
         g_ezhat[n*(m_size+1)+m].set_col(tx, e);
@@ -96,49 +104,40 @@ void alg3v4_step1( Matrix<float,R,WS> *g_pybar,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 3 or 4 or 6 step 2 or 4 or algorithm 5 step 2
- *
- *  This function computes the algorithm step 3.2 or 4.2 or 4.4 or 6.2
- *  or 6.4 or 5.4 (corresponding to the steps 3.2 and 3.3 or 4.2 and
- *  4.3 or 4.5 and 4.6 or 5.2 and 5.3 in [NehabEtAl:2011]) following:
- *
- *  \li In parallel for all \f$n\f$, sequentially for each \f$m\f$,
- *  compute and store all feedbacks \f$P_{m-1,n}(Y)\f$ and
- *  \f$E_{m+1,n}(Z)\f$ according to equations (24) and (25).
- *
- *  \li In parallel for all \f$m\f$, sequentially for each \f$n\f$,
- *  compute and store all feedbacks \f$P^T_{m,n-1}(U)\f$ and
- *  \f$E^T_{m,n+1}(V)\f$ according to equations (32) and (33).
+ *  @brief Forward carries adjustment of algorithm step 2 or 4
  *
- *  @note The CUDA kernel functions (as this one) have many
- *  idiosyncrasies and should not be used lightly.
+ *  Sequentially for each \f$m\f$ of the row (or column) \f$n\f$ of
+ *  blocks, compute and store all feedbacks \f$P_{m-1,n}(Y)\f$ (or
+ *  \f$P^T_{m,n-1}(U)\f$) according to equation (24) (or (32)).  The
+ *  incoming carry of the first block is read from the (padding) slot
+ *  zero, which is zero unless filled by a previous image part (see
+ *  alg6_multi_gpu()).  All threads of the CUDA block must call it.
  *
- *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
- *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
- *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$ (of this image)
+ *  @param[in,out] spybar Shared memory cache with NWA carry matrices
+ *  @param[in] params Filter parameters with the carry adjusting matrices
  *  @param[in] m_size The big M or N (number of row or column blocks)
  *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
  */
-template <int R>
-__global__ __launch_bounds__(WS*NWA, NBA)
-void alg3v4v5v6_step2v4( Matrix<float,R,WS> *g_pybar,
-                         Matrix<float,R,WS> *g_ezhat,
-                         int m_size ) {
+template <int R, class T>
+__device__
+void alg3v4v5v6_fwd_carries( Matrix<T,R,WS> *g_pybar,
+                             Matrix<typename carry_traits<T>::compute,R,WS> *spybar,
+                             const filter_params<R,T>& params,
+                             int m_size ) {
 
-    int tx = threadIdx.x, ty = threadIdx.y, m, n = blockIdx.y;
-    Matrix<float,R,WS> *gpybar, *gezhat;
-    Vector<float,R> py, ez, pybar, ezhat;
-    __shared__ Matrix<float,R,WS> spybar[NWA], sezhat[NWA];
+    typedef typename carry_traits<T>::compute TF;
+    int tx = threadIdx.x, ty = threadIdx.y, m = 0, n = blockIdx.y;
+    Vector<TF,R> py, pybar;
 
     // P(ybar) -> P(y) processing ----------------------------------------------
-    m = 0;
-    gpybar = (Matrix<float,R,WS> *)&g_pybar[n*(m_size+1)+m+ty+1][0][tx];
-    py = zeros<float,R>();
+    Matrix<T,R,WS> *gpybar = (Matrix<T,R,WS> *)&g_pybar[n*(m_size+1)+m+ty+1][0][tx];
+    py = convert<TF>(((Matrix<T,R,WS> *)&g_pybar[n*(m_size+1)][0][tx])->col(0));
 
     for (; m < m_size; m += NWA) { // for all image blocks
 
-        if (m+ty < m_size) spybar[ty].set_col(tx, gpybar->col(0)); // using smem as cache
+        if (m+ty < m_size) spybar[ty].set_col(tx, convert<TF>(gpybar->col(0))); // using smem as cache
 
         __syncthreads(); // wait to load smem
 
@@ -148,7 +147,7 @@ void alg3v4v5v6_step2v4( Matrix<float,R,WS> *g_pybar,
 
                 pybar = spybar[w].col(tx);
 
-                py = pybar + py * c_AbF_T;
+                py = pybar + py * params.AbF_T;
 
                 spybar[w].set_col(tx, py);
 
@@ -157,23 +156,57 @@ void alg3v4v5v6_step2v4( Matrix<float,R,WS> *g_pybar,
 
         __syncthreads(); // wait to store result in gmem
 
-        if (m+ty < m_size) gpybar->set_col(0, spybar[ty].col(tx));
+        if (m+ty < m_size) gpybar->set_col(0, convert<T>(spybar[ty].col(tx)));
 
         gpybar += NWA;
 
     }
 
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Reverse carries adjustment of algorithm step 2 or 4
+ *
+ *  Sequentially for each \f$m\f$ (from last to first) of the row
+ *  (or column) \f$n\f$ of blocks, compute and store all feedbacks
+ *  \f$E_{m+1,n}(Z)\f$ (or \f$E^T_{m,n+1}(V)\f$) according to
+ *  equation (25) (or (33)), using the forward carries already
+ *  adjusted.  The incoming carry of the last block is read from the
+ *  (padding) slot m_size.  All threads of the CUDA block must call it.
+ *
+ *  @param[in] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$ (of this image, adjusted)
+ *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$ (of this image)
+ *  @param[in,out] spybar Shared memory cache with NWA carry matrices
+ *  @param[in,out] sezhat Shared memory cache with NWA carry matrices
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__device__
+void alg3v4v5v6_rev_carries( const Matrix<T,R,WS> *g_pybar,
+                             Matrix<T,R,WS> *g_ezhat,
+                             Matrix<typename carry_traits<T>::compute,R,WS> *spybar,
+                             Matrix<typename carry_traits<T>::compute,R,WS> *sezhat,
+                             const filter_params<R,T>& params,
+                             int m_size ) {
+
+    typedef typename carry_traits<T>::compute TF;
+    int tx = threadIdx.x, ty = threadIdx.y, m = m_size-1, n = blockIdx.y;
+    Vector<TF,R> py, ez, ezhat;
+
     // E(zhat) -> E(z) processing ----------------------------------------------
-    m = m_size-1;
-    gezhat = (Matrix<float,R,WS> *)&g_ezhat[n*(m_size+1)+m-ty][0][tx];
-    gpybar = (Matrix<float,R,WS> *)&g_pybar[n*(m_size+1)+m-ty][0][tx];
-    ez = zeros<float,R>();
+    Matrix<T,R,WS> *gezhat = (Matrix<T,R,WS> *)&g_ezhat[n*(m_size+1)+m-ty][0][tx];
+    const Matrix<T,R,WS> *gpybar = (const Matrix<T,R,WS> *)&g_pybar[n*(m_size+1)+m-ty][0][tx];
+    ez = convert<TF>(((Matrix<T,R,WS> *)&g_ezhat[n*(m_size+1)+m_size][0][tx])->col(0));
 
     for (; m >= 0; m -= NWA) { // for all image blocks
 
         if (m-ty >= 0) { // using smem as cache
-            sezhat[ty].set_col(tx, gezhat->col(0));
-            spybar[ty].set_col(tx, gpybar->col(0));
+            sezhat[ty].set_col(tx, convert<TF>(gezhat->col(0)));
+            spybar[ty].set_col(tx, convert<TF>(gpybar->col(0)));
         }
 
         __syncthreads(); // wait to load smem
@@ -185,7 +218,7 @@ void alg3v4v5v6_step2v4( Matrix<float,R,WS> *g_pybar,
                 ezhat = sezhat[w].col(tx);
                 py = spybar[w].col(tx);
 
-                ez = ezhat + py * c_HARB_AFP_T + ez * c_AbR_T;
+                ez = ezhat + py * params.HARB_AFP_T + ez * params.AbR_T;
 
                 sezhat[w].set_col(tx, ez);
 
@@ -194,7 +227,7 @@ void alg3v4v5v6_step2v4( Matrix<float,R,WS> *g_pybar,
 
         __syncthreads(); // wait to store result in gmem
 
-        if (m-ty >= 0) gezhat->set_col(0, sezhat[ty].col(tx));
+        if (m-ty >= 0) gezhat->set_col(0, convert<T>(sezhat[ty].col(tx)));
 
         gezhat -= NWA;
         gpybar -= NWA;
@@ -205,48 +238,404 @@ void alg3v4v5v6_step2v4( Matrix<float,R,WS> *g_pybar,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 5 step 1 or algorithm 6 step 1
+ *  @brief Algorithm 3 or 4 or 6 step 2 or 4 or algorithm 5 step 2
  *
- *  This function computes the algorithm step 5.1 or 6.1 following:
+ *  This function computes the algorithm step 3.2 or 4.2 or 4.4 or 6.2
+ *  or 6.4 or 5.4 (corresponding to the steps 3.2 and 3.3 or 4.2 and
+ *  4.3 or 4.5 and 4.6 or 5.2 and 5.3 in [NehabEtAl:2011]) following:
  *
- *  \li In parallel for all \f$m\f$ and \f$n\f$, load block
- *  \f$B_{m,n}(X)\f$ then compute and store block perimeters
- *  \f$P_{m,n}(Y)\f$, \f$E_{m,n}(Z)\f$, \f$P^T_{m,n}(U)\f$ and
- *  \f$E^T_{m,n}(V)\f$.
+ *  \li In parallel for all \f$n\f$, sequentially for each \f$m\f$,
+ *  compute and store all feedbacks \f$P_{m-1,n}(Y)\f$ and
+ *  \f$E_{m+1,n}(Z)\f$ according to equations (24) and (25).
+ *
+ *  \li In parallel for all \f$m\f$, sequentially for each \f$n\f$,
+ *  compute and store all feedbacks \f$P^T_{m,n-1}(U)\f$ and
+ *  \f$E^T_{m,n+1}(V)\f$ according to equations (32) and (33).
  *
  *  @note The CUDA kernel functions (as this one) have many
  *  idiosyncrasies and should not be used lightly.
  *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__global__ __launch_bounds__(WS*NWA, NBA)
+void alg3v4v5v6_step2v4( Matrix<T,R,WS> *g_pybar,
+                         Matrix<T,R,WS> *g_ezhat,
+                         const filter_params<R,T> params,
+                         int m_size ) {
+
+    __shared__ Matrix<typename carry_traits<T>::compute,R,WS> spybar[NWA], sezhat[NWA];
+
+    // offset carries to the image (in batch) of this block
+    g_pybar += blockIdx.z*(m_size+1)*gridDim.y;
+    g_ezhat += blockIdx.z*(m_size+1)*gridDim.y;
+
+    alg3v4v5v6_fwd_carries(g_pybar, spybar, params, m_size);
+
+    alg3v4v5v6_rev_carries(g_pybar, g_ezhat, spybar, sezhat, params, m_size);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Forward half of algorithm step 2 or 4
+ *
+ *  Same as alg3v4v5v6_step2v4() but only adjusting the forward
+ *  carries, used when the image is split in parts (one per GPU) and
+ *  the incoming carries are exchanged between the two halves.
+ *
+ *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__global__ __launch_bounds__(WS*NWA, NBA)
+void alg3v4v5v6_step2v4_fwd( Matrix<T,R,WS> *g_pybar,
+                             const filter_params<R,T> params,
+                             int m_size ) {
+
+    __shared__ Matrix<typename carry_traits<T>::compute,R,WS> spybar[NWA];
+
+    g_pybar += blockIdx.z*(m_size+1)*gridDim.y;
+
+    alg3v4v5v6_fwd_carries(g_pybar, spybar, params, m_size);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Reverse half of algorithm step 2 or 4
+ *
+ *  Same as alg3v4v5v6_step2v4() but only adjusting the reverse
+ *  carries, the forward carries must have been adjusted by
+ *  alg3v4v5v6_step2v4_fwd().
+ *
+ *  @param[in] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$ (adjusted)
+ *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__global__ __launch_bounds__(WS*NWA, NBA)
+void alg3v4v5v6_step2v4_rev( const Matrix<T,R,WS> *g_pybar,
+                             Matrix<T,R,WS> *g_ezhat,
+                             const filter_params<R,T> params,
+                             int m_size ) {
+
+    __shared__ Matrix<typename carry_traits<T>::compute,R,WS> spybar[NWA], sezhat[NWA];
+
+    g_pybar += blockIdx.z*(m_size+1)*gridDim.y;
+    g_ezhat += blockIdx.z*(m_size+1)*gridDim.y;
+
+    alg3v4v5v6_rev_carries(g_pybar, g_ezhat, spybar, sezhat, params, m_size);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Take the next tile of a look-back carries adjustment
+ *
+ *  Tiles are taken in the order the CUDA blocks start running (not
+ *  in the order of the block indices), thus a tile only ever waits
+ *  for tiles taken before it, already running, avoiding deadlocks.
+ *  The counter is the first look-back flag.  All threads of the CUDA
+ *  block (one warp) must call it.
+ *
+ *  @param[in,out] g_lbflags Look-back flags (the first is the tile counter)
+ *  @return The tile identifier (in taking order)
+ */
+__device__ __forceinline__
+int lookback_tile( int *g_lbflags ) {
+    __shared__ int sid;
+    if (threadIdx.x == 0) sid = atomicAdd(g_lbflags, 1);
+    __syncthreads();
+    return sid;
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Publish the outgoing carry of a look-back tile
+ *
+ *  The carry is stored before its flag, with a memory fence in
+ *  between, thus a tile seeing the flag reads the carry stored.  The
+ *  flag is one for the aggregate (computed from a zero incoming
+ *  carry) and two for the inclusive (the actual outgoing carry).  All
+ *  threads of the CUDA block (one warp, one column each) must call it.
+ *
+ *  @param[out] g_lbcarry The two carries (aggregate and inclusive) of this tile
+ *  @param[out] g_lbflag The flag of this tile
+ *  @param[in] c The outgoing carry column of this thread
+ *  @param[in] flag 1 for the aggregate or 2 for the inclusive
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__device__
+void lookback_publish( Matrix<T,R,WS> *g_lbcarry,
+                       int *g_lbflag,
+                       const Vector<T,R>& c,
+                       int flag ) {
+    int tx = threadIdx.x;
+#pragma unroll
+    for (int r = 0; r < R; ++r)
+        g_lbcarry[flag-1][r][tx] = c[r];
+    __threadfence(); // carry visible before flag
+    __syncthreads();
+    if (tx == 0) *(volatile int *)g_lbflag = flag;
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Look back the incoming carry of a tile
+ *
+ *  Walking from the previous tile (in the recursion direction) away,
+ *  wait for each tile to publish its carry and accumulate it through
+ *  the full tiles in between: the aggregate of a tile is multiplied
+ *  by the power of the carry adjusting matrix of all tiles after it,
+ *  and the walk stops on the first inclusive carry found.  Only the
+ *  tiles still running are waited for, thus carries flow along the
+ *  row (or column) of blocks without a sequential pass.  All threads
+ *  of the CUDA block (one warp, one column each) must call it.
+ *
+ *  @param[in] g_lbcarry The two carries of each tile (of this row or column)
+ *  @param[in] g_lbflags The flag of each tile (of this row or column)
+ *  @param[in] t This tile
+ *  @param[in] dt The tile step of the recursion (1 forward or -1 reverse)
+ *  @param[in] AbC_T The carry adjusting matrix to the power of LBC (full tile)
+ *  @return The incoming carry column of this thread
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__device__
+Vector<T,R> lookback_incoming( const Matrix<T,R,WS> *g_lbcarry,
+                               const int *g_lbflags,
+                               int t, int dt,
+                               const Matrix<T,R,R>& AbC_T ) {
+
+    __shared__ int sflag;
+    int tx = threadIdx.x, flag;
+    Vector<T,R> in, c;
+    Matrix<T,R,R> pw = AbC_T;
+
+    for (int j = t-dt; ; j -= dt) {
+
+        if (tx == 0) { // wait for the tile to publish
+            while ((flag = ((const volatile int *)g_lbflags)[j]) == 0);
+            __threadfence();
+            sflag = flag;
+        }
+
+        __syncthreads(); // wait for the flag
+
+        flag = sflag;
+
+#pragma unroll
+        for (int r = 0; r < R; ++r)
+            c[r] = ((const volatile T *)&g_lbcarry[2*j+flag-1][r][0])[tx];
+
+        if (j == t-dt) in = c;
+        else { in += c * pw; pw = pw * AbC_T; }
+
+        __syncthreads(); // wait before changing the flag
+
+        if (flag == 2) break;
+
+    }
+
+    return in;
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Forward carries adjustment of algorithm step 2 or 4 with look-back
+ *
+ *  Same as alg3v4v5v6_fwd_carries() but in parallel for all tiles of
+ *  LBC blocks of all rows (or columns) of blocks: each CUDA block
+ *  (one warp) adjusts one tile as in alg3v4v5v6_fwd_carries() from
+ *  the incoming carry found by lookback_incoming(), publishing its
+ *  aggregate before looking back.  The look-back flags (and tile
+ *  counter) must be zero at launch (see launch_alg3v4v5v6_step2v4()).
+ *
+ *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] g_lbcarry Look-back carries (two per tile)
+ *  @param[in,out] g_lbflags Look-back tile counter and flags (one per tile)
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] AbC_T Forward carry adjusting matrix to the power of LBC
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @param[in] seqs All rows (or columns) of blocks (of all images in batch)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__global__ __launch_bounds__(WS)
+void alg3v4v5v6_step2v4_lookback_fwd( Matrix<T,R,WS> *g_pybar,
+                                      Matrix<typename carry_traits<T>::compute,R,WS> *g_lbcarry,
+                                      int *g_lbflags,
+                                      const filter_params<R,T> params,
+                                      const Matrix<typename carry_traits<T>::compute,R,R> AbC_T,
+                                      int m_size, int seqs ) {
+
+    typedef typename carry_traits<T>::compute TF;
+    int tx = threadIdx.x, id = lookback_tile(g_lbflags),
+        tiles = (m_size+LBC-1)/LBC, n = id % seqs, t = id / seqs,
+        m0 = t*LBC, c = min(LBC, m_size-m0);
+    Vector<TF,R> pybar[LBC], py;
+
+    // offset carries to the row (of the image in batch) of this tile
+    g_pybar += n*(m_size+1);
+    g_lbcarry += 2*n*tiles;
+    g_lbflags += 1 + n*tiles;
+
+#pragma unroll
+    for (int k = 0; k < LBC; ++k)
+        if (k < c) pybar[k] = convert<TF>(((Matrix<T,R,WS> *)&g_pybar[m0+k+1][0][tx])->col(0));
+
+    if (t == 0) {
+        py = convert<TF>(((Matrix<T,R,WS> *)&g_pybar[0][0][tx])->col(0));
+    } else {
+        py = zeros<TF,R>();
+#pragma unroll // aggregate of this tile
+        for (int k = 0; k < LBC; ++k)
+            if (k < c) py = pybar[k] + py * params.AbF_T;
+        lookback_publish(&g_lbcarry[2*t], &g_lbflags[t], py, 1);
+        py = lookback_incoming(g_lbcarry, g_lbflags, t, 1, AbC_T);
+    }
+
+#pragma unroll // adjust pybar left -> right
+    for (int k = 0; k < LBC; ++k) {
+        if (k < c) {
+            py = pybar[k] + py * params.AbF_T;
+            ((Matrix<T,R,WS> *)&g_pybar[m0+k+1][0][tx])->set_col(0, convert<T>(py));
+        }
+    }
+
+    if (t < tiles-1) lookback_publish(&g_lbcarry[2*t], &g_lbflags[t], py, 2);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Reverse carries adjustment of algorithm step 2 or 4 with look-back
+ *
+ *  Same as alg3v4v5v6_step2v4_lookback_fwd() for the reverse
+ *  carries of alg3v4v5v6_rev_carries(), with the tiles taken from
+ *  last to first, using the forward carries already adjusted.
+ *
+ *  @param[in] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$ (adjusted)
+ *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in,out] g_lbcarry Look-back carries (two per tile)
+ *  @param[in,out] g_lbflags Look-back tile counter and flags (one per tile)
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] AbC_T Reverse carry adjusting matrix to the power of LBC
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @param[in] seqs All rows (or columns) of blocks (of all images in batch)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ */
+template <int R, class T>
+__global__ __launch_bounds__(WS)
+void alg3v4v5v6_step2v4_lookback_rev( const Matrix<T,R,WS> *g_pybar,
+                                      Matrix<T,R,WS> *g_ezhat,
+                                      Matrix<typename carry_traits<T>::compute,R,WS> *g_lbcarry,
+                                      int *g_lbflags,
+                                      const filter_params<R,T> params,
+                                      const Matrix<typename carry_traits<T>::compute,R,R> AbC_T,
+                                      int m_size, int seqs ) {
+
+    typedef typename carry_traits<T>::compute TF;
+    int tx = threadIdx.x, id = lookback_tile(g_lbflags),
+        tiles = (m_size+LBC-1)/LBC, n = id % seqs, t = tiles-1 - id / seqs,
+        m0 = t*LBC, c = min(LBC, m_size-m0);
+    Vector<TF,R> ezhat[LBC], ez;
+
+    // offset carries to the row (of the image in batch) of this tile
+    g_pybar += n*(m_size+1);
+    g_ezhat += n*(m_size+1);
+    g_lbcarry += 2*n*tiles;
+    g_lbflags += 1 + n*tiles;
+
+#pragma unroll
+    for (int k = 0; k < LBC; ++k)
+        if (k < c) ezhat[k] = convert<TF>(((Matrix<T,R,WS> *)&g_ezhat[m0+k][0][tx])->col(0))
+                       + convert<TF>(((const Matrix<T,R,WS> *)&g_pybar[m0+k][0][tx])->col(0)) * params.HARB_AFP_T;
+
+    if (t == tiles-1) {
+        ez = convert<TF>(((Matrix<T,R,WS> *)&g_ezhat[m_size][0][tx])->col(0));
+    } else {
+        ez = zeros<TF,R>();
+#pragma unroll // aggregate of this tile
+        for (int k = LBC-1; k >= 0; --k)
+            if (k < c) ez = ezhat[k] + ez * params.AbR_T;
+        lookback_publish(&g_lbcarry[2*t], &g_lbflags[t], ez, 1);
+        ez = lookback_incoming(g_lbcarry, g_lbflags, t, -1, AbC_T);
+    }
+
+#pragma unroll // adjust ezhat right -> left
+    for (int k = LBC-1; k >= 0; --k) {
+        if (k < c) {
+            ez = ezhat[k] + ez * params.AbR_T;
+            ((Matrix<T,R,WS> *)&g_ezhat[m0+k][0][tx])->set_col(0, convert<T>(ez));
+        }
+    }
+
+    if (t > 0) lookback_publish(&g_lbcarry[2*t], &g_lbflags[t], ez, 2);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Compute and store the perimeters of one block
+ *
+ *  This is the core of algorithm 5 step 1 or algorithm 6 step 1,
+ *  working on a block already loaded in shared memory (all threads
+ *  but the first warp are idle) and the carries of its image.  The
+ *  perimeters are computed in single precision and stored in the
+ *  carry type.  The rows and the columns may have their own weights,
+ *  and filtering only rows (or only columns) computes only the row
+ *  (or column) perimeters, the others are left untouched.
+ *
+ *  @param[in,out] block The loaded block \f$B_{m,n}(X)\f$ (destroyed)
+ *  @param[in] w Filter weights of rows (feedforward and feedback coefficients)
+ *  @param[in] w_cols Filter weights of columns
+ *  @param[in] axes Filtered axes (see FilterAxes)
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
  *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
- *  @param[in] inv_width Image width inversed (1/w)
- *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m The block column
+ *  @param[in] n The block row
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
- *  @tparam BORDER Flag to consider border input padding
  *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
  */
-template <bool BORDER, int R>
-__global__ __launch_bounds__(WS*NWC, NBCW)
-void alg5v6_step1( Matrix<float,R,WS> *g_pybar, 
-                   Matrix<float,R,WS> *g_ezhat,
-                   Matrix<float,R,WS> *g_ptucheck,
-                   Matrix<float,R,WS> *g_etvtilde,
-                   float inv_width, float inv_height,
-                   int m_size, int n_size ) {
-
-    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
-
-    __shared__ Matrix<float,WS,WS+1> block;
-    if (BORDER) // read considering borders
-        read_block<NWC>(block, m-c_border, n-c_border, inv_width, inv_height);
-    else
-        read_block<NWC>(block, m, n, inv_width, inv_height);
-    __syncthreads();
+template <int R, class TC>
+__device__
+void alg5v6_block_carries( Matrix<float,WS,WS+1>& block,
+                           const Vector<float,R+1>& w,
+                           const Vector<float,R+1>& w_cols,
+                           int axes,
+                           Matrix<TC,R,WS> *g_pybar,
+                           Matrix<TC,R,WS> *g_ezhat,
+                           Matrix<TC,R,WS> *g_ptucheck,
+                           Matrix<TC,R,WS> *g_etvtilde,
+                           int m, int n,
+                           int m_size, int n_size ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y;
 
 #ifdef REGS
     float x[32]; // 32 regs
@@ -260,29 +649,37 @@ void alg5v6_step1( Matrix<float,R,WS> *g_pybar,
             x[i] = block[tx][i];
 #endif
 
-        Vector<float,R> p = zeros<float,R>();
+        Vector<float,R> p, e;
+
+        if (axes != COLUMNS_ONLY) {
+
+            p = zeros<float,R>();
 
 #pragma unroll // calculate pybar, scan left -> right
-        for (int j=0; j<WS; ++j)
+            for (int j=0; j<WS; ++j)
 #ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
+                x[j] = fwdI(p, x[j], w);
 #else
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
+                block[tx][j] = fwdI(p, block[tx][j], w);
 #endif
 
-        g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
-        
-        Vector<float,R> e = zeros<float,R>();
+            g_pybar[n*(m_size+1)+m+1].set_col(tx, convert<TC>(p));
+
+            e = zeros<float,R>();
 
 #pragma unroll // calculate ezhat, scan right -> left
-        for (int j=WS-1; j>=0; --j)
+            for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-            x[j] = revI(x[j], e, c_weights);
+                x[j] = revI(x[j], e, w);
 #else
-            block[tx][j] = revI(block[tx][j], e, c_weights);
+                block[tx][j] = revI(block[tx][j], e, w);
 #endif
 
-        g_ezhat[n*(m_size+1)+m].set_col(tx, e);
+            g_ezhat[n*(m_size+1)+m].set_col(tx, convert<TC>(e));
+
+            if (axes == ROWS_ONLY) return; // no column perimeters
+
+        }
 
 #ifdef REGS
 #pragma unroll // transpose regs part-1
@@ -298,24 +695,24 @@ void alg5v6_step1( Matrix<float,R,WS> *g_pybar,
 #pragma unroll // calculate ptucheck, scan top -> bottom
         for (int j=0; j<WS; ++j)
 #ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], w_cols);
 #else
-            block[j][tx] = fwdI(p, block[j][tx], c_weights);
+            block[j][tx] = fwdI(p, block[j][tx], w_cols);
 #endif
 
-        g_ptucheck[m*(n_size+1)+n+1].set_col(tx, p);
+        g_ptucheck[m*(n_size+1)+n+1].set_col(tx, convert<TC>(p));
 
         e = zeros<float,R>();
 
 #pragma unroll // calculate etvtilde, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-            revI(x[j], e, c_weights);
+            revI(x[j], e, w_cols);
 #else
-            revI(block[j][tx], e, c_weights);
+            revI(block[j][tx], e, w_cols);
 #endif
 
-        g_etvtilde[m*(n_size+1)+n].set_col(tx, e);
+        g_etvtilde[m*(n_size+1)+n].set_col(tx, convert<TC>(e));
 
     }
 
@@ -323,100 +720,255 @@ void alg5v6_step1( Matrix<float,R,WS> *g_pybar,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 5 step 4 or algorithm 6 step 5
+ *  @brief Algorithm 5 step 1 or algorithm 6 step 1
  *
- *  This function computes the algorithm step 5.4 (corresponding to
- *  the step 5.6 in [NehabEtAl:2011]) or algorithm step 6.5 following:
+ *  This function computes the algorithm step 5.1 or 6.1 following:
  *
- *  \li In parallel for all \f$m\f$ and \f$n\f$, load input block
- *  \f$B_{m,n}(X)\f$ and all its block feedbacks \f$P_{m-1,n}(Y)\f$,
- *  \f$E_{m+1,n}(Z)\f$, \f$P^T_{m,n-1}(U)\f$, and
- *  \f$E^T_{m,n+1}(V)\f$.  Compute and store \f$B_{m,n}(V)\f$.
+ *  \li In parallel for all \f$m\f$ and \f$n\f$, load block
+ *  \f$B_{m,n}(X)\f$ then compute and store block perimeters
+ *  \f$P_{m,n}(Y)\f$, \f$E_{m,n}(Z)\f$, \f$P^T_{m,n}(U)\f$ and
+ *  \f$E^T_{m,n}(V)\f$.
  *
  *  @note The CUDA kernel functions (as this one) have many
  *  idiosyncrasies and should not be used lightly.
  *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
- *  @param[out] g_out The output 2D image
- *  @param[in] g_py All \f$P_{m,n}(Y)\f$
- *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
- *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
- *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] in The input in linear memory (in-place plans, see prepare_inplace())
+ *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
+ *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
+ *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights and border)
  *  @param[in] inv_width Image width inversed (1/w)
  *  @param[in] inv_height Image height inversed (1/h)
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
- *  @param[in] out_stride Image output stride for memory width alignment
  *  @tparam BORDER Flag to consider border input padding
  *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ *  @tparam W Number of warps (see tune_config)
  */
-template <bool BORDER, int R>
-__global__ __launch_bounds__(WS*NWW, NBCW)
-void alg5v6_step4v5( float *g_out,
-                     const Matrix<float,R,WS> *g_py,
-                     const Matrix<float,R,WS> *g_ez,
-                     const Matrix<float,R,WS> *g_ptu,
-                     const Matrix<float,R,WS> *g_etv,
-                     float inv_width, float inv_height,
-                     int m_size, int n_size,
-                     int out_stride ) {
+template <bool BORDER, int R, class TC, int W>
+__global__ __launch_bounds__(WS*W, NBW(W))
+void alg5v6_step1( cudaTextureObject_t tex,
+                   const linear_input in,
+                   Matrix<TC,R,WS> *g_pybar, 
+                   Matrix<TC,R,WS> *g_ezhat,
+                   Matrix<TC,R,WS> *g_ptucheck,
+                   Matrix<TC,R,WS> *g_etvtilde,
+                   const filter_params<R,TC> params,
+                   float inv_width, float inv_height,
+                   int m_size, int n_size ) {
 
-    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+    int m = blockIdx.x, n = blockIdx.y, l = blockIdx.z;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+    if (in.ptr) // read in place (no border blocks)
+        read_block<W>(block, in, m, n, l);
+    else if (BORDER) // read considering borders
+        read_block<W>(block, tex, m-params.border, n-params.border, l, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
-    __syncthreads();
-
-#ifdef REGS
-    float x[32]; // 32 regs
-#endif
+        read_block<W>(block, tex, m, n, l, inv_width, inv_height);
 
-    if (ty==0) {
-
-#ifdef REGS
-#pragma unroll
-        for (int i=0; i<32; ++i)
-            x[i] = block[tx][i];
-#endif
+    // offset carries to the image (in batch) of this block
+    g_pybar += l*(m_size+1)*n_size;
+    g_ezhat += l*(m_size+1)*n_size;
+    g_ptucheck += l*(n_size+1)*m_size;
+    g_etvtilde += l*(n_size+1)*m_size;
+    __syncthreads();
 
-        Vector<float,R> p, e;
+    alg5v6_block_carries(block, params.weights, params.weights_cols, params.axes,
+                         g_pybar, g_ezhat, g_ptucheck, g_etvtilde,
+                         m, n, m_size, n_size);
 
-#ifdef LDG
-#pragma unroll
-        for (int r=0; r<R; ++r)
-            p[r] = __ldg((const float *)&g_py[n*(m_size+1)+m][r][tx]);
-#else
-        p = ((Matrix<float,R,WS>*)&g_py[n*(m_size+1)+m][0][tx])->col(0);
-#endif
+}
 
-#pragma unroll // calculate block, scan left -> right
-        for (int j=0; j<WS; ++j)
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 5 step 1 or algorithm 6 step 1 of multi-channel images
+ *
+ *  Same as alg5v6_step1() for images of C interleaved channels.  Each
+ *  texel is read once for all channels and kept in registers, then
+ *  each channel goes through the shared-memory block in turn, storing
+ *  its perimeters as the carries of image l*C+c.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] in The input in linear memory (in-place plans, see prepare_inplace())
+ *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
+ *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
+ *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights and border)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam C Number of channels (2, 3 or 4)
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, int C, class TC>
+__global__ __launch_bounds__(WS*NWC, NBCW)
+void alg5v6_step1_channels( cudaTextureObject_t tex,
+                            const linear_input in,
+                            Matrix<TC,R,WS> *g_pybar, 
+                            Matrix<TC,R,WS> *g_ezhat,
+                            Matrix<TC,R,WS> *g_ptucheck,
+                            Matrix<TC,R,WS> *g_etvtilde,
+                            const filter_params<R,TC> params,
+                            float inv_width, float inv_height,
+                            int m_size, int n_size ) {
+
+    int m = blockIdx.x, n = blockIdx.y, l = blockIdx.z;
+
+    float texels[C*TPT(NWC)];
+    if (in.ptr) // read in place (no border blocks)
+        read_texels<NWC,C>(texels, in, m, n, l);
+    else if (BORDER) // read considering borders
+        read_texels<NWC,C>(texels, tex, m-params.border, n-params.border, l, inv_width, inv_height);
+    else
+        read_texels<NWC,C>(texels, tex, m, n, l, inv_width, inv_height);
+
+    __shared__ Matrix<float,WS,WS+1> block;
+
+#pragma unroll
+    for (int c=0; c<C; ++c) {
+
+        fill_block<NWC,C>(block, texels, c);
+        __syncthreads();
+
+        int k = l*C+c; // carries of this channel
+        alg5v6_block_carries(block, params.weights, params.weights_cols, params.axes,
+                             g_pybar + k*(m_size+1)*n_size,
+                             g_ezhat + k*(m_size+1)*n_size,
+                             g_ptucheck + k*(n_size+1)*m_size,
+                             g_etvtilde + k*(n_size+1)*m_size,
+                             m, n, m_size, n_size);
+        __syncthreads();
+
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Compute and store the output of one block
+ *
+ *  This is the core of algorithm 5 step 4 or algorithm 6 step 5,
+ *  working on a block already loaded in shared memory (all threads
+ *  but the first warp are idle) and the carries of its image.  The
+ *  output may have C interleaved channels, then the output pointer
+ *  is at the channel and strides are given in pixels.  The carries
+ *  are converted to single precision to run the block.  The output
+ *  block may be kept in shared memory to be filtered further.  Only
+ *  the pixels inside the output image are written, thus the output
+ *  may have a tight pitch (stride equal to width) even when the image
+ *  size is not a multiple of the block size.  The output may also be
+ *  a region of the image (from its origin), then only the pixels of
+ *  the block inside the region are written.  The rows and the columns
+ *  may have their own weights, and filtering only rows (or only
+ *  columns) skips the scans of the other axis.
+ *
+ *  @param[in,out] block The loaded block \f$B_{m,n}(X)\f$ (destroyed unless kept)
+ *  @param[out] g_out The output 2D image (at the channel)
+ *  @param[in] w Filter weights of rows (feedforward and feedback coefficients)
+ *  @param[in] w_cols Filter weights of columns
+ *  @param[in] axes Filtered axes (see FilterAxes)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] m The block column
+ *  @param[in] n The block row
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] out_width Output image width (edge blocks are cut to it)
+ *  @param[in] out_height Output image height (edge blocks are cut to it)
+ *  @param[in] out_stride Image output stride (in pixels) for memory width alignment
+ *  @param[in] keep_block Flag to leave the output block in shared memory
+ *  @param[in] out_x Output region left column in the image
+ *  @param[in] out_y Output region top row in the image
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam C Number of output channels
+ *  @tparam T Output storage type (float, half, unsigned char or unsigned short)
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, int C, class T, class TC>
+__device__
+void alg5v6_block_output( Matrix<float,WS,WS+1>& block,
+                          T *g_out,
+                          const Vector<float,R+1>& w,
+                          const Vector<float,R+1>& w_cols,
+                          int axes,
+                          const int& border,
+                          const Matrix<TC,R,WS> *g_py,
+                          const Matrix<TC,R,WS> *g_ez,
+                          const Matrix<TC,R,WS> *g_ptu,
+                          const Matrix<TC,R,WS> *g_etv,
+                          int m, int n,
+                          int m_size, int n_size,
+                          int out_width, int out_height,
+                          int out_stride,
+                          bool keep_block=false,
+                          int out_x=0, int out_y=0 ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y;
+
+#ifdef REGS
+    float x[32]; // 32 regs
+#endif
+
+    if (ty==0) {
+
+#ifdef REGS
+#pragma unroll
+        for (int i=0; i<32; ++i)
+            x[i] = block[tx][i];
+#endif
+
+        Vector<float,R> p, e;
+
+        if (axes != COLUMNS_ONLY) {
+
+#ifdef LDG
+#pragma unroll
+            for (int r=0; r<R; ++r)
+                p[r] = __ldg((const TC *)&g_py[n*(m_size+1)+m][r][tx]);
+#else
+            p = convert<float>(((Matrix<TC,R,WS>*)&g_py[n*(m_size+1)+m][0][tx])->col(0));
+#endif
+
+#pragma unroll // calculate block, scan left -> right
+            for (int j=0; j<WS; ++j)
 #ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
+                x[j] = fwdI(p, x[j], w);
 #else
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
+                block[tx][j] = fwdI(p, block[tx][j], w);
 #endif
 
 #ifdef LDG
 #pragma unroll
-        for (int r=0; r<R; ++r)
-            e[r] = __ldg((const float *)&g_ez[n*(m_size+1)+m+1][r][tx]);
+            for (int r=0; r<R; ++r)
+                e[r] = __ldg((const TC *)&g_ez[n*(m_size+1)+m+1][r][tx]);
 #else
-        e = ((Matrix<float,R,WS>*)&g_ez[n*(m_size+1)+m+1][0][tx])->col(0);
+            e = convert<float>(((Matrix<TC,R,WS>*)&g_ez[n*(m_size+1)+m+1][0][tx])->col(0));
 #endif
 
 #pragma unroll // calculate block, scan right -> left
-        for (int j=WS-1; j>=0; --j)
+            for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-            x[j] = revI(x[j], e, c_weights);
+                x[j] = revI(x[j], e, w);
 #else
-            block[tx][j] = revI(block[tx][j], e, c_weights);
+                block[tx][j] = revI(block[tx][j], e, w);
 #endif
 
+        }
+
 #ifdef REGS
 #pragma unroll // tranpose regs part-1
         for (int i=0; i<32; ++i)
@@ -426,64 +978,1091 @@ void alg5v6_step4v5( float *g_out,
             x[i] = block[i][tx];
 #endif
 
+        if (axes != ROWS_ONLY) {
+
 #ifdef LDG
 #pragma unroll
-        for (int r=0; r<R; ++r)
-            p[r] = __ldg((const float *)&g_ptu[m*(n_size+1)+n][r][tx]);
+            for (int r=0; r<R; ++r)
+                p[r] = __ldg((const TC *)&g_ptu[m*(n_size+1)+n][r][tx]);
 #else
-        p = ((Matrix<float,R,WS>*)&g_ptu[m*(n_size+1)+n][0][tx])->col(0);
+            p = convert<float>(((Matrix<TC,R,WS>*)&g_ptu[m*(n_size+1)+n][0][tx])->col(0));
 #endif
 
 #pragma unroll // calculate block, scan top -> bottom
-        for (int j=0; j<WS; ++j)
+            for (int j=0; j<WS; ++j)
 #ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
+                x[j] = fwdI(p, x[j], w_cols);
 #else
-            block[j][tx] = fwdI(p, block[j][tx], c_weights);
+                block[j][tx] = fwdI(p, block[j][tx], w_cols);
 #endif
 
 #ifdef LDG
 #pragma unroll
-        for (int r=0; r<R; ++r)
-            e[r] = __ldg((float *)&g_etv[m*(n_size+1)+n+1][r][tx]);
+            for (int r=0; r<R; ++r)
+                e[r] = __ldg((const TC *)&g_etv[m*(n_size+1)+n+1][r][tx]);
 #else
-        e = ((Matrix<float,R,WS>*)&g_etv[m*(n_size+1)+n+1][0][tx])->col(0);
+            e = convert<float>(((Matrix<TC,R,WS>*)&g_etv[m*(n_size+1)+n+1][0][tx])->col(0));
 #endif
 
 #pragma unroll // calculate block, scan bottom -> top
-        for (int j=WS-1; j>=0; --j)
+            for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-            x[j] = revI(x[j], e, c_weights);
+                x[j] = revI(x[j], e, w_cols);
 #else
-            block[j][tx] = revI(block[j][tx], e, c_weights);
+                block[j][tx] = revI(block[j][tx], e, w_cols);
 #endif
 
-        if (BORDER) {
-            if ((m >= c_border) && (m < m_size-c_border) && (n >= c_border) && (n < n_size-c_border)) {
-                g_out += ((n-c_border+1)*WS-1)*out_stride + (m-c_border)*WS+tx;
+        }
+
+        int ox = m*WS-out_x, oy = n*WS-out_y; // block offset in the output image
+        if (BORDER) { ox -= border*WS; oy -= border*WS; }
+
+        if (ox > -WS && oy > -WS && ox < out_width && oy < out_height) {
+            g_out += ((oy+WS-1)*out_stride + ox+tx)*C;
+            if (ox >= 0 && oy >= 0 && ox+WS <= out_width && oy+WS <= out_height) {
 #pragma unroll // write block inside valid image
-                for (int i=0; i<WS; ++i, g_out-=out_stride) {
+                for (int i=0; i<WS; ++i, g_out-=out_stride*C) {
 #ifdef REGS
-                    *g_out = x[WS-1-i];
+                    store(g_out, x[WS-1-i]);
 #else
-                    *g_out = block[WS-1-i][tx];
+                    store(g_out, block[WS-1-i][tx]);
 #endif
                 }
-            }
-        } else {
-            g_out += ((n+1)*WS-1)*out_stride + m*WS+tx;
-#pragma unroll // write block
-            for (int i=0; i<WS; ++i, g_out-=out_stride) {
+            } else if (ox+tx >= 0 && ox+tx < out_width) {
+#pragma unroll // write edge block only inside valid image (tight pitch or region)
+                for (int i=0; i<WS; ++i, g_out-=out_stride*C) {
+                    if (oy+WS-1-i >= 0 && oy+WS-1-i < out_height)
 #ifdef REGS
-                *g_out = x[WS-1-i];
+                        store(g_out, x[WS-1-i]);
 #else
-                *g_out = block[WS-1-i][tx];
+                        store(g_out, block[WS-1-i][tx]);
 #endif
+                }
             }
         }
 
+#ifdef REGS
+        if (keep_block) {
+#pragma unroll // store output block back (see alg6_cascade_step5())
+            for (int i=0; i<32; ++i)
+                block[i][tx] = x[i];
+        }
+#endif
+
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 5 step 4 or algorithm 6 step 5
+ *
+ *  This function computes the algorithm step 5.4 (corresponding to
+ *  the step 5.6 in [NehabEtAl:2011]) or algorithm step 6.5 following:
+ *
+ *  \li In parallel for all \f$m\f$ and \f$n\f$, load input block
+ *  \f$B_{m,n}(X)\f$ and all its block feedbacks \f$P_{m-1,n}(Y)\f$,
+ *  \f$E_{m+1,n}(Z)\f$, \f$P^T_{m,n-1}(U)\f$, and
+ *  \f$E^T_{m,n+1}(V)\f$.  Compute and store \f$B_{m,n}(V)\f$.
+ *
+ *  @note The CUDA kernel functions (as this one) have many
+ *  idiosyncrasies and should not be used lightly.
+ *
+ *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
+ *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] in The input in linear memory (in-place plans, see prepare_inplace())
+ *  @param[out] g_out The output 2D image
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights and border)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] out_width Output image width
+ *  @param[in] out_height Output image height
+ *  @param[in] out_stride Image output stride for memory width alignment
+ *  @param[in] out_size Image output size (stride times height) in batch
+ *  @param[in] out_x Output region left column in the image (see prepare_roi())
+ *  @param[in] out_y Output region top row in the image
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam T Output storage type (float, half, unsigned char or unsigned short)
+ *  @tparam TC Carry type (float or double)
+ *  @tparam W Number of warps (see tune_config)
+ */
+template <bool BORDER, int R, class T, class TC, int W>
+__global__ __launch_bounds__(WS*W, NBW(W))
+void alg5v6_step4v5( cudaTextureObject_t tex,
+                     const linear_input in,
+                     T *g_out,
+                     const Matrix<TC,R,WS> *g_py,
+                     const Matrix<TC,R,WS> *g_ez,
+                     const Matrix<TC,R,WS> *g_ptu,
+                     const Matrix<TC,R,WS> *g_etv,
+                     const filter_params<R,TC> params,
+                     float inv_width, float inv_height,
+                     int m_size, int n_size,
+                     int out_width, int out_height,
+                     int out_stride, int out_size,
+                     int out_x, int out_y ) {
+
+    // the grid covers only the blocks of the output region
+    int m = blockIdx.x + out_x/WS + (BORDER ? params.border : 0),
+        n = blockIdx.y + out_y/WS + (BORDER ? params.border : 0), l = blockIdx.z;
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    if (in.ptr) // read in place (no border blocks)
+        read_block<W>(block, in, m, n, l);
+    else if (BORDER) // read considering borders
+        read_block<W>(block, tex, m-params.border, n-params.border, l, inv_width, inv_height);
+    else
+        read_block<W>(block, tex, m, n, l, inv_width, inv_height);
+
+    // offset carries and output to the image (in batch) of this block
+    g_py += l*(m_size+1)*n_size;
+    g_ez += l*(m_size+1)*n_size;
+    g_ptu += l*(n_size+1)*m_size;
+    g_etv += l*(n_size+1)*m_size;
+    g_out += l*out_size;
+    __syncthreads();
+
+    alg5v6_block_output<BORDER,R,1>(block, g_out, params.weights, params.weights_cols,
+                                    params.axes, params.border,
+                                    g_py, g_ez, g_ptu, g_etv,
+                                    m, n, m_size, n_size,
+                                    out_width, out_height, out_stride,
+                                    false, out_x, out_y);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 5 step 4 or algorithm 6 step 5 of multi-channel images
+ *
+ *  Same as alg5v6_step4v5() for images of C interleaved channels,
+ *  each texel is read once for all channels (see
+ *  alg5v6_step1_channels()) and the output is written interleaved.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] in The input in linear memory (in-place plans, see prepare_inplace())
+ *  @param[out] g_out The output 2D image (C interleaved channels)
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights and border)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] out_width Output image width
+ *  @param[in] out_height Output image height
+ *  @param[in] out_stride Image output stride (in pixels) for memory width alignment
+ *  @param[in] out_size Image output size (in floats) in batch
+ *  @param[in] out_x Output region left column in the image (see prepare_roi())
+ *  @param[in] out_y Output region top row in the image
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam C Number of channels (2, 3 or 4)
+ *  @tparam T Output storage type (float, half, unsigned char or unsigned short)
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, int C, class T, class TC>
+__global__ __launch_bounds__(WS*NWW, NBCW)
+void alg5v6_step4v5_channels( cudaTextureObject_t tex,
+                              const linear_input in,
+                              T *g_out,
+                              const Matrix<TC,R,WS> *g_py,
+                              const Matrix<TC,R,WS> *g_ez,
+                              const Matrix<TC,R,WS> *g_ptu,
+                              const Matrix<TC,R,WS> *g_etv,
+                              const filter_params<R,TC> params,
+                              float inv_width, float inv_height,
+                              int m_size, int n_size,
+                              int out_width, int out_height,
+                              int out_stride, int out_size,
+                              int out_x, int out_y ) {
+
+    // the grid covers only the blocks of the output region
+    int m = blockIdx.x + out_x/WS + (BORDER ? params.border : 0),
+        n = blockIdx.y + out_y/WS + (BORDER ? params.border : 0), l = blockIdx.z;
+
+    float texels[C*TPT(NWW)];
+    if (in.ptr) // read in place (no border blocks)
+        read_texels<NWW,C>(texels, in, m, n, l);
+    else if (BORDER) // read considering borders
+        read_texels<NWW,C>(texels, tex, m-params.border, n-params.border, l, inv_width, inv_height);
+    else
+        read_texels<NWW,C>(texels, tex, m, n, l, inv_width, inv_height);
+
+    __shared__ Matrix<float,WS,WS+1> block;
+
+    g_out += l*out_size;
+
+#pragma unroll
+    for (int c=0; c<C; ++c) {
+
+        fill_block<NWW,C>(block, texels, c);
+        __syncthreads();
+
+        int k = l*C+c; // carries of this channel
+        alg5v6_block_output<BORDER,R,C>(block, g_out + c,
+                                        params.weights, params.weights_cols,
+                                        params.axes, params.border,
+                                        g_py + k*(m_size+1)*n_size,
+                                        g_ez + k*(m_size+1)*n_size,
+                                        g_ptu + k*(n_size+1)*m_size,
+                                        g_etv + k*(n_size+1)*m_size,
+                                        m, n, m_size, n_size,
+                                        out_width, out_height, out_stride,
+                                        false, out_x, out_y);
+        __syncthreads();
+
+    }
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 1 or algorithm 6 step 1 of a single-channel plan
+ *
+ *  Selects the kernel of the number of warps collecting carries of
+ *  the plan launch configuration (see tune_config).
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[out] d_pybar All \f$P_{m,n}(Y)\f$
+ *  @param[out] d_ezhat All \f$E_{m,n}(Z)\f$
+ *  @param[out] d_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[out] d_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters of the plan
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class TC>
+void launch_alg5v6_step1_warps( const alg_plan& plan,
+                                Matrix<TC,R,WS> *d_pybar,
+                                Matrix<TC,R,WS> *d_ezhat,
+                                Matrix<TC,R,WS> *d_ptucheck,
+                                Matrix<TC,R,WS> *d_etvtilde,
+                                const filter_params<R,TC>& params ) {
+
+    dim3 grid(plan.m_size, plan.n_size, plan.batch);
+    linear_input in = make_linear_input(plan);
+
+#define ALG5V6_STEP1(nw)                                                \
+    alg5v6_step1<BORDER,R,TC,nw><<< grid, dim3(WS, nw), 0, plan.stream >>> \
+        ( plan.tex_in, in, d_pybar, d_ezhat, d_ptucheck, d_etvtilde, params, \
+          plan.inv_width, plan.inv_height, plan.m_size, plan.n_size )
+
+    switch (plan.tune.nwc) {
+    case 4: ALG5V6_STEP1(4); break;
+    case 8: ALG5V6_STEP1(8); break;
+    default: ALG5V6_STEP1(NWC);
     }
 
+#undef ALG5V6_STEP1
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 4 or algorithm 6 step 5 of a single-channel plan
+ *
+ *  Selects the kernel of the number of warps writing results of the
+ *  plan launch configuration (see tune_config).
+ *
+ *  @param[in,out] plan The plan to run (its output is written)
+ *  @param[out] d_out The plan output in the storage type
+ *  @param[in] d_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] d_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] d_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] d_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters of the plan
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam T Output storage type (float, half, unsigned char or unsigned short)
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class T, class TC>
+void launch_alg5v6_step4v5_warps( alg_plan& plan,
+                                  T *d_out,
+                                  const Matrix<TC,R,WS> *d_py,
+                                  const Matrix<TC,R,WS> *d_ez,
+                                  const Matrix<TC,R,WS> *d_ptu,
+                                  const Matrix<TC,R,WS> *d_etv,
+                                  const filter_params<R,TC>& params ) {
+
+    dim3 grid = output_grid(plan);
+    int out_size = plan.out_height*plan.stride_img;
+    linear_input in = make_linear_input(plan);
+
+#define ALG5V6_STEP4V5(nw)                                              \
+    alg5v6_step4v5<BORDER,R,T,TC,nw><<< grid, dim3(WS, nw), 0, plan.stream >>> \
+        ( plan.tex_in, in, d_out, d_py, d_ez, d_ptu, d_etv, params,     \
+          plan.inv_width, plan.inv_height, plan.m_size, plan.n_size,    \
+          plan.out_width, plan.out_height, plan.stride_img, out_size,   \
+          plan.out_x, plan.out_y )
+
+    switch (plan.tune.nww) {
+    case 4: ALG5V6_STEP4V5(4); break;
+    case 8: ALG5V6_STEP4V5(8); break;
+    default: ALG5V6_STEP4V5(NWW);
+    }
+
+#undef ALG5V6_STEP4V5
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 1 or algorithm 6 step 1 of a plan
+ *
+ *  Selects the single or multi-channel kernel by the plan channels.
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[out] d_pybar All \f$P_{m,n}(Y)\f$
+ *  @param[out] d_ezhat All \f$E_{m,n}(Z)\f$
+ *  @param[out] d_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[out] d_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters of the plan
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class TC>
+void launch_alg5v6_step1( const alg_plan& plan,
+                          Matrix<TC,R,WS> *d_pybar,
+                          Matrix<TC,R,WS> *d_ezhat,
+                          Matrix<TC,R,WS> *d_ptucheck,
+                          Matrix<TC,R,WS> *d_etvtilde,
+                          const filter_params<R,TC>& params ) {
+
+    dim3 grid(plan.m_size, plan.n_size, plan.batch), block(WS, NWC);
+    linear_input in = make_linear_input(plan);
+
+    switch (plan.channels) {
+    case 2:
+        alg5v6_step1_channels<BORDER,R,2,TC><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, d_pybar, d_ezhat, d_ptucheck, d_etvtilde, params,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size );
+        break;
+    case 3:
+        alg5v6_step1_channels<BORDER,R,3,TC><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, d_pybar, d_ezhat, d_ptucheck, d_etvtilde, params,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size );
+        break;
+    case 4:
+        alg5v6_step1_channels<BORDER,R,4,TC><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, d_pybar, d_ezhat, d_ptucheck, d_etvtilde, params,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size );
+        break;
+    default:
+        launch_alg5v6_step1_warps<BORDER>(plan, d_pybar, d_ezhat, d_ptucheck,
+                                          d_etvtilde, params);
+    }
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 4 or algorithm 6 step 5 of a plan
+ *
+ *  Selects the single or multi-channel kernel by the plan channels,
+ *  writing to the output in single or half precision or quantized to
+ *  the plan output format.
+ *
+ *  @param[in,out] plan The plan to run (its output is written)
+ *  @param[out] d_out The plan output in the storage type
+ *  @param[in] d_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] d_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] d_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] d_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters of the plan
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam T Output storage type (float, half, unsigned char or unsigned short)
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class T, class TC>
+void launch_alg5v6_step4v5( alg_plan& plan,
+                            T *d_out,
+                            const Matrix<TC,R,WS> *d_py,
+                            const Matrix<TC,R,WS> *d_ez,
+                            const Matrix<TC,R,WS> *d_ptu,
+                            const Matrix<TC,R,WS> *d_etv,
+                            const filter_params<R,TC>& params ) {
+
+    dim3 grid = output_grid(plan), block(WS, NWW);
+    int out_size = plan.out_height*plan.stride_img*plan.channels;
+    linear_input in = make_linear_input(plan);
+
+    switch (plan.channels) {
+    case 2:
+        alg5v6_step4v5_channels<BORDER,R,2,T,TC><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, d_out, d_py, d_ez, d_ptu, d_etv, params,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size,
+              plan.out_width, plan.out_height, plan.stride_img, out_size,
+              plan.out_x, plan.out_y );
+        break;
+    case 3:
+        alg5v6_step4v5_channels<BORDER,R,3,T,TC><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, d_out, d_py, d_ez, d_ptu, d_etv, params,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size,
+              plan.out_width, plan.out_height, plan.stride_img, out_size,
+              plan.out_x, plan.out_y );
+        break;
+    case 4:
+        alg5v6_step4v5_channels<BORDER,R,4,T,TC><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, d_out, d_py, d_ez, d_ptu, d_etv, params,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size,
+              plan.out_width, plan.out_height, plan.stride_img, out_size,
+              plan.out_x, plan.out_y );
+        break;
+    default:
+        launch_alg5v6_step4v5_warps<BORDER>(plan, d_out, d_py, d_ez, d_ptu,
+                                            d_etv, params);
+    }
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 4 or algorithm 6 step 5 of a plan
+ *  @overload
+ *  @param[in,out] plan The plan to run (its output is written)
+ *  @param[in] d_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] d_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] d_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] d_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters of the plan
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class TC>
+void launch_alg5v6_step4v5( alg_plan& plan,
+                            const Matrix<TC,R,WS> *d_py,
+                            const Matrix<TC,R,WS> *d_ez,
+                            const Matrix<TC,R,WS> *d_ptu,
+                            const Matrix<TC,R,WS> *d_etv,
+                            const filter_params<R,TC>& params ) {
+    if (plan.out_format == PIXEL_UINT8)
+        launch_alg5v6_step4v5<BORDER,R>(plan, &plan.d_img8, d_py, d_ez, d_ptu, d_etv, params);
+    else if (plan.out_format == PIXEL_UINT16)
+        launch_alg5v6_step4v5<BORDER,R>(plan, &plan.d_img16, d_py, d_ez, d_ptu, d_etv, params);
+    else if (plan.half)
+        launch_alg5v6_step4v5<BORDER,R>(plan, &plan.d_himg, d_py, d_ez, d_ptu, d_etv, params);
+    else
+        launch_alg5v6_step4v5<BORDER,R>(plan, output_ptr(plan), d_py, d_ez, d_ptu, d_etv, params);
+}
+
+/**
+ *  @struct alg5v6_plan alg3v4v5v6_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Common filter plan of algorithms 5 and 6
+ *
+ *  Algorithms 5 and 6 share the same matrices and carries, only the
+ *  way carries are fixed differs.  This plan holds them, and each
+ *  algorithm (and boundary variant) derives its own plan from this.
+ *  The carries (and the matrices applied to them) may be kept in
+ *  double precision while the image stays in single precision, this
+ *  mixed precision bounds the error growth of carries propagated
+ *  over many blocks in large images and high orders.  Or they may
+ *  be kept compact in half precision (adjusted in single precision,
+ *  see carry_traits), halving the carry memory traffic of all steps
+ *  (the carries of order r are r/8 of the image size) at the cost
+ *  of carries rounded to about three decimal digits.  The plan passes its own
+ *  filter parameters and texture object to kernels,
+ *  thus plans of algorithms 5 and 6 run concurrently on different
+ *  streams (the boundary variants as well, see border_params).
+ *  The carries may be adjusted with look-back (see prepare_lookback()).
+ *  The scans of each block may run as dense products on tensor cores
+ *  (see prepare_tensor()).
+ *  The columns may be filtered by their own weights, and only one
+ *  axis may be filtered (see prepare_axes()).
+ *
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float, double or half)
+ */
+template <int R, class TC=float>
+struct alg5v6_plan : public alg_plan {
+    typedef typename carry_traits<TC>::compute TF; ///< Carry arithmetic type
+    Vector<float,R+1> w; ///< Filter weights
+    alg_matrices<R,TF> mat; ///< Pre-computed basic matrices
+    filter_params<R,TC> params; ///< Filter parameters passed to kernels
+    FilterAxes axes; ///< Filtered axes (both by default)
+    Vector<float,R+1> w_cols; ///< Filter weights of columns (same as rows by default)
+    alg_matrices<R,TF> mat_cols; ///< Pre-computed basic matrices of columns
+    filter_params<R,TC> params_cols; ///< Filter parameters of columns (steps adjusting column carries)
+    dvector< Matrix<TC,R,WS> > d_pybar, d_ezhat; ///< Row carries
+    dvector< Matrix<TC,R,WS> > d_ptucheck, d_etvtilde; ///< Column carries
+    dvector< Matrix<TF,R,WS> > d_cmat; ///< Constant matrices in global memory
+    bool lookback; ///< Flag to adjust carries with look-back (off by default, see skinny_plan())
+    Matrix<TF,R,R> AbF_T_C, AbR_T_C; ///< Carry adjusting matrices of a look-back tile
+    Matrix<TF,R,R> AbF_T_C_cols, AbR_T_C_cols; ///< Carry adjusting matrices of a look-back tile of columns
+    dvector< Matrix<TF,R,WS> > d_lbcarry; ///< Look-back carries (two per tile)
+    dvector<int> d_lbflags; ///< Look-back tile counter and flags (one per tile)
+    TensorPrecision tensor; ///< Precision of the block products on tensor cores (off by default, see prepare_tensor())
+    dvector<float> d_tcmat; ///< Block product operators (TF32 products)
+    dvector<__half> d_tcmat16; ///< Block product operators (FP16 products)
+    /// Default constructor
+    alg5v6_plan() : axes(BOTH_AXES), lookback(false), tensor(TENSOR_OFF) { }
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the common filter plan of algorithms 5 and 6
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] use_border Flag to consider border input padding
+ *  @param[in] layers Number of input layers (zero means not layered)
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @param[in] half Flag for half-precision input and output storage
+ *  @param[in] tight Flag to allocate the output with tight pitch (stride equal to width)
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_alg5v6( alg5v6_plan<R,TC>& plan,
+                     int width, int height,
+                     const Vector<float, R+1>& w,
+                     int border, BorderType btype,
+                     bool use_border,
+                     int layers=0,
+                     int channels=1,
+                     bool half=false,
+                     bool tight=false ) {
+
+    prepare_plan(plan, width, height, border, btype, use_border, layers,
+                 channels, half, tight);
+
+    plan.w = w;
+    calc_matrices(plan.mat, w);
+    plan.params = make_params(w, plan.mat, plan.border);
+    plan.axes = BOTH_AXES;
+    plan.tensor = TENSOR_OFF;
+    plan.w_cols = w;
+    plan.mat_cols = plan.mat;
+    plan.params_cols = plan.params;
+    plan.tune = find_tuning(R, (long)plan.m_size*plan.n_size);
+
+    // each channel of each image has its own carries
+    int m_size = plan.m_size, n_size = plan.n_size,
+        batch = plan.batch*plan.channels;
+
+    // +1 padding is important even in zero-border to avoid if's in kernels
+    plan.d_pybar.resize((m_size+1)*n_size*batch);
+    plan.d_ezhat.resize((m_size+1)*n_size*batch);
+    plan.d_ptucheck.resize((n_size+1)*m_size*batch);
+    plan.d_etvtilde.resize((n_size+1)*m_size*batch);
+    plan.d_pybar.fillzero();
+    plan.d_ezhat.fillzero();
+    plan.d_ptucheck.fillzero();
+    plan.d_etvtilde.fillzero();
+
+    // the following matrices can not be read from constant memory as one warp
+    // will access each column by a different thread, serializing access and
+    // hurting performance, the solution is to store them in global memory
+    // and manage to have them in L1 cache as soon as possible;
+    // constant r x b matrices: ARE_T, ARB_AFP_T, TAFB, HARB_AFB
+    plan.d_cmat.resize(4);
+    upload_cmat(plan);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload the carry fixing matrices of a plan to global memory
+ *
+ *  The first two matrices (ARE_T and ARB_AFP_T) run the row carries
+ *  through the block rows, thus they come from the weights of rows,
+ *  the last two (TAFB and HARB_AFB) take them along the block columns,
+ *  thus they come from the weights of columns.
+ *
+ *  @param[in,out] plan The plan with the matrices to upload
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void upload_cmat( alg5v6_plan<R,TC>& plan ) {
+    typedef typename alg5v6_plan<R,TC>::TF TF;
+    Matrix<TF,R,WS> h_cmat[4] = { plan.mat.ARE_T, plan.mat.ARB_AFP_T,
+                                  plan.mat_cols.TAFB, plan.mat_cols.HARB_AFB };
+    cudaMemcpy(&plan.d_cmat, h_cmat, 4*sizeof(Matrix<TF,R,WS>),
+               cudaMemcpyHostToDevice);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Pad filter weights to a higher order
+ *
+ *  The feedback coefficients beyond the given order are zero, thus the
+ *  padded filter is exactly the same (at the cost of the higher order).
+ *  This lets rows and columns of a plan have filters of different
+ *  orders (see prepare_axes()).
+ *
+ *  @param[in] w Filter weights of order N-1 (feedforward and feedback coefficients)
+ *  @return Filter weights of order R
+ *  @tparam R Filter order to pad to (at least N-1)
+ *  @tparam N Number of given weights (order plus one)
+ */
+template <int R, int N>
+Vector<float,R+1> pad_weights( const Vector<float,N>& w ) {
+    if (N > R+1)
+        throw std::runtime_error("Filter weights above the order to pad to");
+    Vector<float,R+1> p = zeros<float,R+1>();
+    for (int i = 0; i < N; ++i)
+        p[i] = w[i];
+    return p;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the filter of columns and the filtered axes of a plan
+ *
+ *  By default the rows and columns of a plan are filtered by the same
+ *  weights.  The columns may have their own weights (for anisotropic
+ *  filters), of an order up to the plan order (lower orders are
+ *  zero-padded, see pad_weights()).  The row carries are then adjusted
+ *  by the matrices of rows, the column carries by the matrices of
+ *  columns, and the carry fixing matrices mix both (see upload_cmat()).
+ *  Filtering only rows (or only columns) skips the carries, the
+ *  adjustments and the block scans of the other axis, thus costing
+ *  about half of both.  Only the common kernels (alg5_gpu() and
+ *  alg6_gpu()) follow this, the boundary variants filter both axes by
+ *  the weights of rows.  It must be called after the plan is prepared
+ *  (and again if the plan is prepared again), and turns off tensor
+ *  cores (see prepare_tensor(), to be called again after).
+ *
+ *  @param[in,out] plan The prepared plan
+ *  @param[in] w_cols Filter weights of columns of order N-1
+ *  @param[in] axes Filtered axes
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ *  @tparam N Number of weights of columns (order plus one)
+ */
+template <int R, class TC, int N>
+void prepare_axes( alg5v6_plan<R,TC>& plan,
+                   const Vector<float,N>& w_cols,
+                   FilterAxes axes=BOTH_AXES ) {
+
+    if (axes < BOTH_AXES || axes > COLUMNS_ONLY)
+        throw std::runtime_error("Invalid filtered axes");
+
+    plan.graph.reset(); // the captured kernels change
+    plan.tensor = TENSOR_OFF; // operators of the old axes (see prepare_tensor())
+
+    plan.axes = axes;
+    plan.w_cols = pad_weights<R>(w_cols);
+    calc_matrices(plan.mat_cols, plan.w_cols);
+    plan.params_cols = make_params(plan.w_cols, plan.mat_cols, plan.border);
+    plan.params.weights_cols = plan.params_cols.weights_cols = plan.w_cols;
+    plan.params.axes = plan.params_cols.axes = axes;
+
+    upload_cmat(plan);
+
+    if (plan.lookback) prepare_lookback(plan); // of the new columns
+
+    // carries of an axis not filtered stay zero (as prepared)
+    plan.d_pybar.fillzero();
+    plan.d_ezhat.fillzero();
+    plan.d_ptucheck.fillzero();
+    plan.d_etvtilde.fillzero();
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the filtered axes of a plan
+ *  @overload
+ *  @param[in,out] plan The prepared plan
+ *  @param[in] axes Filtered axes (keeping the weights of columns)
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_axes( alg5v6_plan<R,TC>& plan,
+                   FilterAxes axes ) {
+    prepare_axes(plan, plan.w_cols, axes);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the carries adjustment with look-back of a plan
+ *
+ *  The carries adjustment (algorithm 5 steps 2 and 3 and algorithm 6
+ *  steps 2 and 4) runs sequentially along each row (or column) of
+ *  blocks, with only one CUDA block per row (or column) of blocks,
+ *  hence few blocks on wide (or tall) images and small batches.  With
+ *  look-back, each row (or column) of blocks is split in tiles of LBC
+ *  blocks adjusted in parallel, each tile publishing its carry and
+ *  looking back the carries of the previous tiles, in a single pass
+ *  (see alg3v4v5v6_step2v4_lookback_fwd()).  The results are the
+ *  same up to rounding (carries are summed in a different order).
+ *  It must be called after the plan is prepared (and again if the
+ *  plan is prepared again).
+ *
+ *  @param[in,out] plan The prepared plan
+ *  @param[in] lookback Flag to adjust carries with look-back
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_lookback( alg5v6_plan<R,TC>& plan,
+                       bool lookback=true ) {
+
+    plan.lookback = lookback;
+    plan.graph.reset(); // the captured kernels change
+
+    if (!lookback) return;
+
+    plan.AbF_T_C = plan.params.AbF_T;
+    plan.AbR_T_C = plan.params.AbR_T;
+    plan.AbF_T_C_cols = plan.params_cols.AbF_T;
+    plan.AbR_T_C_cols = plan.params_cols.AbR_T;
+    for (int k = 1; k < LBC; ++k) {
+        plan.AbF_T_C = plan.AbF_T_C * plan.params.AbF_T;
+        plan.AbR_T_C = plan.AbR_T_C * plan.params.AbR_T;
+        plan.AbF_T_C_cols = plan.AbF_T_C_cols * plan.params_cols.AbF_T;
+        plan.AbR_T_C_cols = plan.AbR_T_C_cols * plan.params_cols.AbR_T;
+    }
+
+    // tiles of rows of blocks or of columns of blocks (the most)
+    int m_size = plan.m_size, n_size = plan.n_size,
+        batch = plan.batch*plan.channels,
+        tiles = std::max(((m_size+LBC-1)/LBC)*n_size,
+                         ((n_size+LBC-1)/LBC)*m_size)*batch;
+
+    plan.d_lbcarry.resize(2*tiles);
+    plan.d_lbflags.resize(1+tiles);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Check if a plan is of a skinny image (too few carry chains)
+ *
+ *  The carries adjustment runs one CUDA block per row (or column) of
+ *  blocks walking it sequentially, thus skinny images (e.g. line-scan
+ *  images of 64 x 2000000) have too few long chains on one axis,
+ *  leaving the GPU almost idle for most of the run.  An axis is
+ *  skinny if its chains are SKA times longer than their number (of
+ *  all images and channels) and they are not enough to fill the GPU
+ *  (with NBA blocks per multiprocessor).  The common plans (of
+ *  alg5_gpu() and alg6_gpu()) of skinny images are prepared with
+ *  look-back (see prepare_lookback()), splitting the long chains in
+ *  tiles adjusted in parallel, which can be undone by calling
+ *  prepare_lookback() with false after.
+ *
+ *  @param[in] plan The prepared plan
+ *  @return True if the rows or columns of blocks are skinny
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+bool skinny_plan( const alg5v6_plan<R,TC>& plan ) {
+    static long resident = (long)tune_sms()*NBA;
+    const long batch = plan.batch*plan.channels,
+        rows = (long)plan.n_size*batch, cols = (long)plan.m_size*batch;
+    return (plan.m_size > LBC && rows < resident && plan.m_size >= SKA*rows) ||
+        (plan.n_size > LBC && cols < resident && plan.n_size >= SKA*cols);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Set the input and output pixel formats of a plan
+ *
+ *  Integer inputs (8 or 16 bits per channel) are uploaded as they
+ *  are and read normalized by the texture, the output may be
+ *  quantized back to integers (scaled, rounded and saturated) as it
+ *  is written by the last step.  Both cut the image bytes moved (up
+ *  to four times for 8 bits) and avoid separate conversion kernels.
+ *  Only layered plans (algorithms 5 and 6) read the input texture
+ *  object and write the output in other formats.  It must be called
+ *  after the plan is prepared (and again if the plan is prepared
+ *  again), the plan is then uploaded and downloaded in these formats
+ *  (see upload_integer() and download_integer()).  It turns off
+ *  tensor cores (see prepare_tensor(), to be called again after).
+ *
+ *  @param[in,out] plan The prepared plan
+ *  @param[in] in_format Input array pixel format
+ *  @param[in] out_format Output image pixel format
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_formats( alg5v6_plan<R,TC>& plan,
+                      PixelFormat in_format,
+                      PixelFormat out_format ) {
+
+    if (!plan.layered)
+        throw std::runtime_error("Pixel formats need a layered plan");
+    if (plan.inplace && (in_format != PIXEL_FLOAT || out_format != PIXEL_FLOAT))
+        throw std::runtime_error("Integer pixel formats do not combine with in-place plans");
+    if (plan.half && (in_format != PIXEL_FLOAT || out_format != PIXEL_FLOAT))
+        throw std::runtime_error("Integer pixel formats do not combine with half storage");
+
+    plan.graph.reset(); // the captured kernels change
+    plan.tensor = TENSOR_OFF; // float output only (see prepare_tensor())
+
+    if (in_format != plan.in_format) {
+        plan.in_format = in_format;
+        alloc_input(plan);
+        size_t value_size = in_format == PIXEL_UINT8 ? sizeof(unsigned char)
+            : in_format == PIXEL_UINT16 ? sizeof(unsigned short) : sizeof(float);
+        int pack_size = plan.batch*plan.height*plan.width*4;
+        plan.d_pack.resize(plan.channels == 3 ?
+                           (pack_size*value_size+sizeof(float)-1)/sizeof(float) : 0);
+    }
+
+    plan.out_format = out_format;
+    int out_size = plan.batch*plan.out_height*plan.stride_img*plan.channels;
+    plan.d_img.resize(out_format == PIXEL_FLOAT && !plan.half ? out_size : 0);
+    plan.d_img8.resize(out_format == PIXEL_UINT8 ? out_size : 0);
+    plan.d_img16.resize(out_format == PIXEL_UINT16 ? out_size : 0);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Make a plan of algorithms 5 and 6 filter in place
+ *
+ *  The input is uploaded to the plan output, read from it by the
+ *  first step (instead of the input array) and overwritten by the
+ *  last step, thus the input array is freed and the output gets a
+ *  tight pitch, leaving about one image plus carries in device
+ *  memory.  This is safe as each block of the last step only reads
+ *  its own pixels before writing them, which holds without border
+ *  blocks, and with repeat or reflect borders only for image sizes
+ *  multiple of the block size (otherwise the edge blocks read pixels
+ *  of the opposite or previous blocks).  Only the common kernels
+ *  read in place (alg5_gpu() and alg6_gpu() of plans in float
+ *  storage), and the input must be uploaded again before each run.
+ *  It must be called after the plan is prepared (and again if the
+ *  plan is prepared again).
+ *
+ *  @param[in,out] plan The prepared plan
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_inplace( alg5v6_plan<R,TC>& plan ) {
+
+    if (!plan.layered)
+        throw std::runtime_error("In-place filtering needs a layered plan");
+    if (plan.half || plan.in_format != PIXEL_FLOAT || plan.out_format != PIXEL_FLOAT)
+        throw std::runtime_error("In-place filtering needs float storage");
+    if (plan.border > 0)
+        throw std::runtime_error("In-place filtering does not combine with border blocks");
+    if (plan.out_width != plan.width || plan.out_height != plan.height)
+        throw std::runtime_error("In-place filtering does not combine with an output region");
+    if ((plan.btype == REPEAT || plan.btype == REFLECT) &&
+        (plan.width % WS != 0 || plan.height % WS != 0))
+        throw std::runtime_error("In-place repeat or reflect needs sizes multiple of 32");
+
+    plan.graph.reset(); // the captured kernels change
+    plan.inplace = true;
+
+    if (plan.tex_in) cudaDestroyTextureObject(plan.tex_in);
+    if (plan.a_in) cudaFreeArray(plan.a_in);
+    plan.tex_in = 0;
+    plan.a_in = 0;
+
+    // swap to free the memory (resize keeps the capacity)
+    plan.stride_img = plan.width;
+    dvector<float> d_img(plan.batch*plan.height*plan.stride_img*plan.channels),
+        d_pack;
+    swap(plan.d_img, d_img);
+    swap(plan.d_pack, d_pack);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Make an in-place plan of algorithms 5 and 6 filter external memory
+ *
+ *  The plan reads its input from and writes its output to images in
+ *  device memory owned by the caller (e.g. a tensor of a Python
+ *  framework), with no upload nor download copies, thus the plan
+ *  output image is freed.  The images (the plan batch, of the plan
+ *  channels interleaved) are one after the other, each of the given
+ *  row stride.  It must be called after prepare_inplace() (and again
+ *  if the memory or stride change, or the plan is prepared again).
+ *
+ *  @param[in,out] plan The in-place plan
+ *  @param[in,out] d_img The in(out)put images in device memory
+ *  @param[in] stride The images row stride (in pixels, at least the width)
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_external( alg5v6_plan<R,TC>& plan,
+                       float *d_img,
+                       int stride ) {
+
+    if (!plan.inplace)
+        throw std::runtime_error("External memory needs an in-place plan");
+    if (!d_img || stride < plan.width)
+        throw std::runtime_error("Invalid external memory or stride");
+
+    plan.graph.reset(); // the captured kernels change
+    plan.d_ext = d_img;
+    plan.stride_img = stride;
+
+    dvector<float> d_own; // swap to free the memory
+    swap(plan.d_img, d_own);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Make a plan of algorithms 5 and 6 output only a region of interest
+ *
+ *  The recursion is global, thus the carries are still computed and
+ *  adjusted over the whole image (with its exact boundary handling),
+ *  but the last step runs only over the blocks intersecting the region
+ *  (see output_grid()) and writes only the region, tightly packed
+ *  (stride equal to its width), thus the output image shrinks to the
+ *  region size and downloads copy only the region.  Only the common
+ *  kernels (alg5_gpu() and alg6_gpu()) write the region.  It must be
+ *  called after the plan is prepared (and again if the plan is
+ *  prepared again), and does not combine with in-place plans.
+ *
+ *  @param[in,out] plan The prepared plan
+ *  @param[in] x Region left column in the image
+ *  @param[in] y Region top row in the image
+ *  @param[in] width Region width
+ *  @param[in] height Region height
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void prepare_roi( alg5v6_plan<R,TC>& plan,
+                  int x, int y,
+                  int width, int height ) {
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x+width > plan.width || y+height > plan.height)
+        throw std::runtime_error("Output region outside the image");
+    if (plan.inplace)
+        throw std::runtime_error("In-place filtering does not combine with an output region");
+
+    plan.graph.reset(); // the captured kernels change
+
+    plan.out_x = x;
+    plan.out_y = y;
+    plan.out_width = width;
+    plan.out_height = height;
+    plan.stride_img = width;
+
+    // swap to free the memory (resize keeps the capacity)
+    int out_size = plan.batch*height*width*plan.channels;
+    dvector<float> d_img(plan.d_img.size() ? out_size : 0);
+    dvector<__half> d_himg(plan.d_himg.size() ? out_size : 0);
+    dvector<unsigned char> d_img8(plan.d_img8.size() ? out_size : 0);
+    dvector<unsigned short> d_img16(plan.d_img16.size() ? out_size : 0);
+    swap(plan.d_img, d_img);
+    swap(plan.d_himg, d_himg);
+    swap(plan.d_img8, d_img8);
+    swap(plan.d_img16, d_img16);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm step 2 or 4 of a plan of algorithms 5 and 6
+ *
+ *  Launch alg3v4v5v6_step2v4() on the plan stream or, with look-back
+ *  (see prepare_lookback()), alg3v4v5v6_step2v4_lookback_fwd() and
+ *  alg3v4v5v6_step2v4_lookback_rev() with their flags reset before.
+ *
+ *  @param[in,out] plan The plan (with the look-back buffers)
+ *  @param[in,out] d_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] d_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @param[in] n_size The big N or M (number of rows or columns of blocks)
+ *  @param[in] cols Flag of column carries (adjusted by the filter of columns)
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void launch_alg3v4v5v6_step2v4( alg5v6_plan<R,TC>& plan,
+                                Matrix<TC,R,WS> *d_pybar,
+                                Matrix<TC,R,WS> *d_ezhat,
+                                int m_size, int n_size,
+                                bool cols=false ) {
+
+    const int batch = plan.batch*plan.channels;
+    const filter_params<R,TC>& params = cols ? plan.params_cols : plan.params;
+
+    if (!plan.lookback) {
+        alg3v4v5v6_step2v4<<< dim3(1, n_size, batch), dim3(WS, NWA), 0, plan.stream >>>
+            ( d_pybar, d_ezhat, params, m_size );
+        return;
+    }
+
+    const int seqs = n_size*batch, tiles = ((m_size+LBC-1)/LBC)*seqs;
+
+    cudaMemsetAsync(&plan.d_lbflags, 0, (1+tiles)*sizeof(int), plan.stream);
+
+    alg3v4v5v6_step2v4_lookback_fwd<<< tiles, WS, 0, plan.stream >>>
+        ( d_pybar, &plan.d_lbcarry, &plan.d_lbflags, params,
+          cols ? plan.AbF_T_C_cols : plan.AbF_T_C, m_size, seqs );
+
+    cudaMemsetAsync(&plan.d_lbflags, 0, (1+tiles)*sizeof(int), plan.stream);
+
+    alg3v4v5v6_step2v4_lookback_rev<<< tiles, WS, 0, plan.stream >>>
+        ( d_pybar, d_ezhat, &plan.d_lbcarry, &plan.d_lbflags, params,
+          cols ? plan.AbR_T_C_cols : plan.AbR_T_C, m_size, seqs );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Configure the cache of the common kernels of W warps
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ *  @tparam W Number of warps (see tune_config)
+ */
+template <bool BORDER, int R, class TC, int W>
+void config_alg5v6_warps() {
+    cudaFuncSetCacheConfig(alg5v6_step1<BORDER,R,TC,W>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg5v6_step4v5<BORDER,R,float,TC,W>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg5v6_step4v5<BORDER,R,__half,TC,W>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg5v6_step4v5<BORDER,R,unsigned char,TC,W>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg5v6_step4v5<BORDER,R,unsigned short,TC,W>, cudaFuncCachePreferShared);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Configure the cache of the common kernels of algorithms 5 and 6
+ *
+ *  The collect carries and write results kernels (of all compiled
+ *  numbers of warps) prefer shared memory, and the carry adjusting
+ *  kernel follows the plan launch configuration (see tune_config).
+ *
+ *  @param[in] plan The plan with the launch configuration
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class TC>
+void config_alg5v6( const alg5v6_plan<R,TC>& plan ) {
+    config_alg5v6_warps<BORDER,R,TC,4>();
+    config_alg5v6_warps<BORDER,R,TC,NWC>();
+    config_alg5v6_warps<BORDER,R,TC,NWW>();
+    config_alg5v6_warps<BORDER,R,TC,8>();
+    cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,TC>, plan.tune.cache2);
 }
 
 //==============================================================================
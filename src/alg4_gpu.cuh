@@ -9,7 +9,6 @@
 #ifndef ALG4_GPU_CUH
 #define ALG4_GPU_CUH
 
-#define MST == // measure step time: no: == ; yes: >=
 #define LDG // uncomment to use __ldg
 //#if ORDER==1 || ORDER==2 || ORDER==5
 #define REGS // uncomment to use registers
@@ -48,6 +47,7 @@ namespace gpufilter {
  *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The texture object of the input (or transposed) image
  *  @param[out] g_transp_out The output transposed 2D image
  *  @param[in] g_rows_py All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$ 
  *  @param[in] g_rows_ez All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$ 
@@ -64,7 +64,8 @@ namespace gpufilter {
  */
 template <bool FUSION, bool BORDER, int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg4_step3v5( float *g_transp_out,
+void alg4_step3v5( cudaTextureObject_t tex,
+                   float *g_transp_out,
                    const Matrix<float,R,WS> *g_rows_py,
                    const Matrix<float,R,WS> *g_rows_ez,
                    Matrix<float,R,WS> *g_cols_py,
@@ -77,9 +78,9 @@ void alg4_step3v5( float *g_transp_out,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWW>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
+        read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
 #ifdef REGS
@@ -107,9 +108,9 @@ void alg4_step3v5( float *g_transp_out,
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
 #ifdef REGS
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], consts<R>().weights);
 #else
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
+            block[tx][j] = fwdI(p, block[tx][j], consts<R>().weights);
 #endif
 
 #ifdef LDG
@@ -123,9 +124,9 @@ void alg4_step3v5( float *g_transp_out,
 #pragma unroll // calculate block, scan right -> left
         for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, consts<R>().weights);
 #else
-            block[tx][j] = revI(block[tx][j], e, c_weights);
+            block[tx][j] = revI(block[tx][j], e, consts<R>().weights);
 #endif
 
         if (BORDER) {
@@ -172,9 +173,9 @@ void alg4_step3v5( float *g_transp_out,
 #pragma unroll // calculate pybar cols, scan left -> right
             for (int j=0; j<WS; ++j)
 #ifdef REGS
-                x[j] = fwdI(p, x[j], c_weights);
+                x[j] = fwdI(p, x[j], consts<R>().weights);
 #else
-                block[j][tx] = fwdI(p, block[j][tx], c_weights);
+                block[j][tx] = fwdI(p, block[j][tx], consts<R>().weights);
 #endif
 
             pybar.set_col(0, p); // store pybar cols
@@ -184,9 +185,9 @@ void alg4_step3v5( float *g_transp_out,
 #pragma unroll // calculate ezhat cols, scan right -> left
             for (int j=WS-1; j>=0; --j)
 #ifdef REGS
-                revI(x[j], e, c_weights);
+                revI(x[j], e, consts<R>().weights);
 #else
-                revI(block[j][tx], e, c_weights);
+                revI(block[j][tx], e, consts<R>().weights);
 #endif
 
             ezhat.set_col(0, e); // store ezhat cols
@@ -198,14 +199,30 @@ void alg4_step3v5( float *g_transp_out,
 }
 
 /**
+ *  @struct alg4_plan alg4_gpu.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm 4 in the GPU
+ *  @brief Filter plan of algorithm 4
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+struct alg4_plan : public alg_plan {
+    Vector<float,R+1> w; ///< Filter weights
+    alg_matrices<R> mat; ///< Pre-computed basic matrices
+    int stride_transp_img; ///< Transposed image stride
+    dvector<float> d_transp_img; ///< Transposed intermediate image
+    pitch_texture tex_transp; ///< Texture object of the transposed image
+    dvector< Matrix<float,R,WS> > d_rows_pybar, d_rows_ezhat; ///< Row carries
+    dvector< Matrix<float,R,WS> > d_cols_pybar, d_cols_ezhat; ///< Column carries
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 4 plan in the GPU
  *
- *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[out] plan The plan to prepare
  *  @param[in] width Image width
  *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
  *  @param[in] w Filter weights (feedforward and feedback coefficients)
  *  @param[in] border Number of border blocks (32x32) outside image
  *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
@@ -214,176 +231,170 @@ void alg4_step3v5( float *g_transp_out,
  */
 template <bool BORDER, int R>
 __host__
-void alg4_gpu( float *h_img,
-               int width, int height, int runtimes,
-               const Vector<float, R+1> &w,
-               int border=0,
-               BorderType border_type=CLAMP_TO_ZERO ) {
-
-    const int B = WS;
+void prepare_alg4( alg4_plan<BORDER,R>& plan,
+                   int width, int height,
+                   const Vector<float, R+1> &w,
+                   int border=0,
+                   BorderType btype=CLAMP_TO_ZERO ) {
 
-    // pre-compute basic alg4 matrices
-    Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
+    if (!BORDER) { border = 0; btype = CLAMP_TO_ZERO; }
 
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w),
-                      ARE_T = rev(Zrb, Ir, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w),
-                      ARB_T = rev(Ib, Zbr, w);
+    prepare_plan(plan, width, height, border, btype, BORDER);
 
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T),
-                      AbR_T = head<R>(ARE_T),
-                      HARB_AFP_T = AFP_T*head<R>(ARB_T);
+    plan.w = w;
+    calc_matrices(plan.mat, w);
 
-    int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
-    if (BORDER) {
-        int border_left, border_top, border_right, border_bottom;
-        calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
-                     width, height, border);
-        int ewidth = width+border_left+border_right,
-            eheight = height+border_top+border_bottom;
-
-        m_size = (ewidth+WS-1)/WS;
-        n_size = (eheight+WS-1)/WS;
-
-        copy_to_symbol(c_border, border);
-    }
-
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AbR_T, AbR_T);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-
-    cudaArray *a_in;
-    size_t offset;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-
-    if (BORDER) {
-        switch(border_type) {
-        case CLAMP_TO_ZERO:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-            break;
-        case CLAMP_TO_EDGE:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
-            break;
-        case REPEAT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
-            break;
-        case REFLECT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeMirror;
-            break;
-        }
-    }
-
-    int stride_img = width+WS, stride_transp_img = width+WS;
-    if (BORDER) stride_img = stride_transp_img = width+WS*border+WS;
-
-    dvector<float> d_img(height*stride_img), d_transp_img(width*stride_transp_img);
+    plan.stride_transp_img = plan.stride_img;
+    plan.d_transp_img.resize(width*plan.stride_transp_img);
+    plan.tex_transp.create(plan.d_transp_img, plan.height, plan.width,
+                           plan.stride_transp_img, address_mode(plan.btype));
 
     // +1 padding is important even in zero-border to avoid if's in kernels
-    dvector< Matrix<float,R,B> >
-        d_rows_pybar((m_size+1)*n_size), d_rows_ezhat((m_size+1)*n_size),
-        d_cols_pybar((n_size+1)*m_size), d_cols_ezhat((n_size+1)*m_size);
-    d_rows_pybar.fillzero();
-    d_rows_ezhat.fillzero();
-    d_cols_pybar.fillzero();
-    d_cols_ezhat.fillzero();
+    plan.d_rows_pybar.resize((m_size+1)*n_size);
+    plan.d_rows_ezhat.resize((m_size+1)*n_size);
+    plan.d_cols_pybar.resize((n_size+1)*m_size);
+    plan.d_cols_ezhat.resize((n_size+1)*m_size);
+    plan.d_rows_pybar.fillzero();
+    plan.d_rows_ezhat.fillzero();
+    plan.d_cols_pybar.fillzero();
+    plan.d_cols_ezhat.fillzero();
 
     cudaFuncSetCacheConfig(alg3v4_step1<BORDER,R>, cudaFuncCachePreferShared);
     cudaFuncSetCacheConfig(alg4_step3v5<true,BORDER,R>, cudaFuncCachePreferShared);
     cudaFuncSetCacheConfig(alg4_step3v5<false,BORDER,R>, cudaFuncCachePreferShared);
 
     if (R == 1)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferL1);
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, cudaFuncCachePreferL1);
     else if (R == 2)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferEqual);
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, cudaFuncCachePreferEqual);
     else if (R >= 3)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferShared);
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, cudaFuncCachePreferShared);
 
-    double te[5] = {0, 0, 0, 0, 0}; // time elapsed for the five steps
-    base_timer *timer[5];
-    for (int i = 0; i < 5; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+}
 
-    base_timer &timer_total = timers.gpu_add("alg4_gpu", width*height, "iP");
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 4 plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional five timers to measure each step
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+__host__
+void alg4_gpu( alg4_plan<BORDER,R>& plan,
+               base_timer **timer=0 ) {
 
-    for(int r = 0; r < runtimes; ++r) {
+    if (make_current(plan)) {
+        copy_to_symbol(c_border, plan.border);
+        copy_to_constants(&filter_constants<R>::weights, plan.w);
 
-        if (runtimes MST 1) { timer[0]->start(); }
+        copy_to_constants(&filter_constants<R>::AbF_T, plan.mat.AbF_T);
+        copy_to_constants(&filter_constants<R>::AbR_T, plan.mat.AbR_T);
+        copy_to_constants(&filter_constants<R>::HARB_AFP_T, plan.mat.HARB_AFP_T);
+    }
 
-        cudaBindTextureToArray(t_in, a_in);
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    const filter_params<R> params = make_params(plan.w, plan.mat, plan.border);
 
-        alg3v4_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_rows_pybar, &d_rows_ezhat, inv_width, inv_height, m_size );
+    if (timer) timer[0]->start();
 
-        if (runtimes MST 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    alg3v4_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_rows_pybar, &plan.d_rows_ezhat, plan.inv_width, plan.inv_height, m_size );
 
-        alg3v4v5v6_step2v4<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_rows_pybar, &d_rows_ezhat, m_size );
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-        if (runtimes MST 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    alg3v4v5v6_step2v4<<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_rows_pybar, &plan.d_rows_ezhat, params, m_size );
 
-        alg4_step3v5<true, BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_transp_img, &d_rows_pybar, &d_rows_ezhat, &d_cols_pybar, &d_cols_ezhat,
-              inv_width, inv_height, m_size, n_size, stride_transp_img );
-    
-        cudaUnbindTexture(t_in);
-        cudaBindTexture2D(&offset, t_in, d_transp_img, height, width, stride_transp_img*sizeof(float));
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-        if (runtimes MST 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+    alg4_step3v5<true, BORDER><<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_transp_img, &plan.d_rows_pybar, &plan.d_rows_ezhat,
+          &plan.d_cols_pybar, &plan.d_cols_ezhat,
+          plan.inv_width, plan.inv_height, m_size, n_size, plan.stride_transp_img );
 
-        alg3v4v5v6_step2v4<<< dim3(1, m_size), dim3(WS, NWA) >>>
-            ( &d_cols_pybar, &d_cols_ezhat, n_size );
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        if (runtimes MST 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); timer[4]->start(); }
+    alg3v4v5v6_step2v4<<< dim3(1, m_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_cols_pybar, &plan.d_cols_ezhat, params, n_size );
 
-        alg4_step3v5<false, BORDER><<< dim3(n_size, m_size), dim3(WS, NWW) >>>
-            ( d_img, &d_cols_pybar, &d_cols_ezhat, &d_rows_pybar, &d_rows_ezhat,
-              inv_height, inv_width, n_size, m_size, stride_img );
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
 
-        cudaUnbindTexture(t_in);
+    alg4_step3v5<false, BORDER><<< dim3(n_size, m_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_transp.tex, plan.d_img, &plan.d_cols_pybar, &plan.d_cols_ezhat,
+          &plan.d_rows_pybar, &plan.d_rows_ezhat,
+          plan.inv_height, plan.inv_width, n_size, m_size, plan.stride_img );
 
-        if (runtimes MST 1) { timer[4]->stop(); te[4] += timer[4]->elapsed(); }
+    if (timer) timer[4]->stop();
 
-    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 4 in the GPU
+ *
+ *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+__host__
+void alg4_gpu( float *h_img,
+               int width, int height, int runtimes,
+               const Vector<float, R+1> &w,
+               int border=0,
+               BorderType border_type=CLAMP_TO_ZERO ) {
+
+    alg4_plan<BORDER,R> plan;
+    prepare_alg4(plan, width, height, w, border, border_type);
+
+    upload(plan, h_img);
+
+    const char *steps[5] = { "step 1", "step 2", "step 3", "step 4", "step 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i)
+        timer[i] = new step_timer(std::string("alg4_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg4_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg4_gpu(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 5; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        if (runtimes MST 1) {
+        if (timed) {
             for (int i = 0; i < 5; ++i)
-                std::cout << std::fixed << " " << te[i]/(double)runtimes << std::flush;
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
         } else {
             std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
         }
 
     } else {
 
-        timers.gpu_add("step 1", timer[0]);
-        timers.gpu_add("step 2", timer[1]);
-        timers.gpu_add("step 3", timer[2]);
-        timers.gpu_add("step 4", timer[3]);
-        timers.gpu_add("step 5", timer[4]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
@@ -9,18 +9,18 @@
 #ifndef ALG5_GPU_CUH
 #define ALG5_GPU_CUH
 
-#define MST == // measure step time: no: == ; yes: >=
 #ifndef ALG5ORIG // external define it to run alg5 original
 #define LDG // uncomment to use __ldg
 //#if ORDER==1 || ORDER==2 || ORDER==4
 #define REGS // uncomment to use registers
-#define GMAT // uncomment to use global constant matrices
+#define GMAT // uncomment to keep global constant matrices in registers
 //#endif
 #endif
 
 //== INCLUDES ==================================================================
 
 #include "alg3v4v5v6_gpu.cuh"
+#include "alg5v6_tc.cuh"
 
 //== NAMESPACES ================================================================
 
@@ -49,38 +49,46 @@ namespace gpufilter {
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
  *  @param[in] g_cmat Constant pre-computed matrices on equations (27) and (29)
+ *  @param[in] params Filter parameters with the carry adjusting matrices
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
  *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
  */
-template <int R>
+template <int R, class T>
 __global__ __launch_bounds__(WS*NWAC, NBA)
-void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
-                 Matrix<float,R,WS> *g_etvtilde,
-                 const Matrix<float,R,WS> *g_py,
-                 const Matrix<float,R,WS> *g_ez,
-#ifdef GMAT
-                  const Matrix<float,R,WS> *g_cmat,
-#endif
-                  int m_size, int n_size ) {
-
+void alg5_step3( Matrix<T,R,WS> *g_ptucheck,
+                 Matrix<T,R,WS> *g_etvtilde,
+                 const Matrix<T,R,WS> *g_py,
+                 const Matrix<T,R,WS> *g_ez,
+                 const Matrix<typename carry_traits<T>::compute,R,WS> *g_cmat,
+                 const filter_params<R,T> params,
+                 int m_size, int n_size ) {
+
+    typedef typename carry_traits<T>::compute TF;
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n;
-    Matrix<float,R,WS> *gptucheck, *getvtilde;
-    Vector<float,R> ptu, etv, ptucheck, etvtilde;
-    Vector<float,R> py, ez;
-    __shared__ Matrix<float,R,WS> sptucheck[NWAC], setvtilde[NWAC];
-    __shared__ Matrix<float,R,WS> spy[NWAC], sez[NWAC];
+    Matrix<T,R,WS> *gptucheck, *getvtilde;
+    Vector<TF,R> ptu, etv, ptucheck, etvtilde;
+    Vector<TF,R> py, ez;
+    __shared__ Matrix<TF,R,WS> sptucheck[NWAC], setvtilde[NWAC];
+    __shared__ Matrix<TF,R,WS> spy[NWAC], sez[NWAC];
+
+    // offset carries to the image (in batch) of this block
+    g_ptucheck += blockIdx.z*(n_size+1)*m_size;
+    g_etvtilde += blockIdx.z*(n_size+1)*m_size;
+    g_py += blockIdx.z*(m_size+1)*n_size;
+    g_ez += blockIdx.z*(m_size+1)*n_size;
 
 #ifdef GMAT
-    Vector<float,R> cmat[3];
+    Vector<TF,R> cmat[3];
 
     if (ty == 0) {
 #pragma unroll
         for (int r=0; r<R; ++r) {
 #ifdef LDG
-            cmat[0][r] = __ldg((const float *)&g_cmat[0][r][tx]);
-            cmat[1][r] = __ldg((const float *)&g_cmat[1][r][tx]);
-            cmat[2][r] = __ldg((const float *)&g_cmat[2][r][tx]);
+            cmat[0][r] = __ldg((const TF *)&g_cmat[0][r][tx]);
+            cmat[1][r] = __ldg((const TF *)&g_cmat[1][r][tx]);
+            cmat[2][r] = __ldg((const TF *)&g_cmat[2][r][tx]);
 #else
             cmat[0][r] = g_cmat[0][r][tx];
             cmat[1][r] = g_cmat[1][r][tx];
@@ -92,22 +100,22 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
 
     // Pt(ucheck) -> Pt(u) processing ------------------------------------------
     n = 0;
-    gptucheck = (Matrix<float,R,WS> *)&g_ptucheck[m*(n_size+1)+n+ty+1][0][tx];
-    ptu = zeros<float,R>();
+    gptucheck = (Matrix<T,R,WS> *)&g_ptucheck[m*(n_size+1)+n+ty+1][0][tx];
+    ptu = zeros<TF,R>();
 
     for (; n < n_size; n += NWAC) { // for all image blocks
 
         if (n+ty < n_size) { // using smem as cache
-            sptucheck[ty].set_col(tx, gptucheck->col(0));
+            sptucheck[ty].set_col(tx, convert<TF>(gptucheck->col(0)));
 #ifdef LDG
 #pragma unroll
             for (int r=0; r<R; ++r) {
-                spy[ty][r][tx] = __ldg((const float *)&g_py[(n+ty)*(m_size+1)+m+0][r][tx]);
-                sez[ty][r][tx] = __ldg((const float *)&g_ez[(n+ty)*(m_size+1)+m+1][r][tx]);
+                spy[ty][r][tx] = __ldg((const T *)&g_py[(n+ty)*(m_size+1)+m+0][r][tx]);
+                sez[ty][r][tx] = __ldg((const T *)&g_ez[(n+ty)*(m_size+1)+m+1][r][tx]);
             }
 #else
-            spy[ty].set_col(tx, ((Matrix<float,R,WS> *)&g_py[(n+ty)*(m_size+1)+m+0][0][tx])->col(0));
-            sez[ty].set_col(tx, ((Matrix<float,R,WS> *)&g_ez[(n+ty)*(m_size+1)+m+1][0][tx])->col(0));
+            spy[ty].set_col(tx, convert<TF>(((Matrix<T,R,WS> *)&g_py[(n+ty)*(m_size+1)+m+0][0][tx])->col(0)));
+            sez[ty].set_col(tx, convert<TF>(((Matrix<T,R,WS> *)&g_ez[(n+ty)*(m_size+1)+m+1][0][tx])->col(0)));
 #endif
         }
 
@@ -121,14 +129,14 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
                 py = spy[w].col(tx);
                 ez = sez[w].col(tx);
 
-                ptu = ptucheck + ptu * c_AbF_T;
+                ptu = ptucheck + ptu * params.AbF_T;
 
 #ifdef GMAT
                 fixpet(ptu, cmat[2], cmat[0], ez);
                 fixpet(ptu, cmat[2], cmat[1], py);
 #else
-                fixpet(ptu, c_TAFB, c_ARE_T, ez);
-                fixpet(ptu, c_TAFB, c_ARB_AFP_T, py);
+                fixpet(ptu, g_cmat[2], g_cmat[0], ez);
+                fixpet(ptu, g_cmat[2], g_cmat[1], py);
 #endif
                 sptucheck[w].set_col(tx, ptu);
 
@@ -138,7 +146,7 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
         __syncthreads(); // wait to store result in gmem
 
         if (n+ty < n_size)
-            gptucheck->set_col(0, sptucheck[ty].col(tx));
+            gptucheck->set_col(0, convert<T>(sptucheck[ty].col(tx)));
 
         gptucheck += NWAC;
 
@@ -149,7 +157,7 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
 #pragma unroll
         for (int r=0; r<R; ++r) {
 #ifdef LDG
-            cmat[2][r] = __ldg((const float *)&g_cmat[3][r][tx]);
+            cmat[2][r] = __ldg((const TF *)&g_cmat[3][r][tx]);
 #else
             cmat[2][r] = g_cmat[3][r][tx];
 #endif
@@ -159,24 +167,24 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
 
     // Et(vtilde) -> Et(v) processing ------------------------------------------
     n = n_size-1;
-    getvtilde = (Matrix<float,R,WS> *)&g_etvtilde[m*(n_size+1)+n-ty][0][tx];
-    gptucheck = (Matrix<float,R,WS> *)&g_ptucheck[m*(n_size+1)+n-ty][0][tx];
-    etv = zeros<float,R>();
+    getvtilde = (Matrix<T,R,WS> *)&g_etvtilde[m*(n_size+1)+n-ty][0][tx];
+    gptucheck = (Matrix<T,R,WS> *)&g_ptucheck[m*(n_size+1)+n-ty][0][tx];
+    etv = zeros<TF,R>();
 
     for (; n >= 0; n -= NWAC) { // for all image blocks
 
         if (n-ty >= 0) { // using smem as cache
-            setvtilde[ty].set_col(tx, getvtilde->col(0));
-            sptucheck[ty].set_col(tx, gptucheck->col(0));
+            setvtilde[ty].set_col(tx, convert<TF>(getvtilde->col(0)));
+            sptucheck[ty].set_col(tx, convert<TF>(gptucheck->col(0)));
 #ifdef LDG
 #pragma unroll
             for (int r=0; r<R; ++r) {
-                spy[ty][r][tx] = __ldg((const float *)&g_py[(n-ty)*(m_size+1)+m+0][r][tx]);
-                sez[ty][r][tx] = __ldg((const float *)&g_ez[(n-ty)*(m_size+1)+m+1][r][tx]);
+                spy[ty][r][tx] = __ldg((const T *)&g_py[(n-ty)*(m_size+1)+m+0][r][tx]);
+                sez[ty][r][tx] = __ldg((const T *)&g_ez[(n-ty)*(m_size+1)+m+1][r][tx]);
             }
 #else
-            spy[ty].set_col(tx, ((Matrix<float,R,WS> *)&g_py[(n-ty)*(m_size+1)+m+0][0][tx])->col(0));
-            sez[ty].set_col(tx, ((Matrix<float,R,WS> *)&g_ez[(n-ty)*(m_size+1)+m+1][0][tx])->col(0));
+            spy[ty].set_col(tx, convert<TF>(((Matrix<T,R,WS> *)&g_py[(n-ty)*(m_size+1)+m+0][0][tx])->col(0)));
+            sez[ty].set_col(tx, convert<TF>(((Matrix<T,R,WS> *)&g_ez[(n-ty)*(m_size+1)+m+1][0][tx])->col(0)));
 #endif
         }
 
@@ -191,14 +199,14 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
                 py = spy[w].col(tx);
                 ez = sez[w].col(tx);
 
-                etv = etvtilde + etv * c_AbR_T + ptu * c_HARB_AFP_T;
+                etv = etvtilde + etv * params.AbR_T + ptu * params.HARB_AFP_T;
 
 #ifdef GMAT
                 fixpet(etv, cmat[2], cmat[0], ez);
                 fixpet(etv, cmat[2], cmat[1], py);
 #else
-                fixpet(etv, c_HARB_AFB, c_ARE_T, ez);
-                fixpet(etv, c_HARB_AFB, c_ARB_AFP_T, py);
+                fixpet(etv, g_cmat[3], g_cmat[0], ez);
+                fixpet(etv, g_cmat[3], g_cmat[1], py);
 #endif
 
                 setvtilde[w].set_col(tx, etv);
@@ -209,7 +217,7 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
         __syncthreads(); // wait to store result in gmem
 
         if (n-ty >= 0)
-            getvtilde->set_col(0, setvtilde[ty].col(tx));
+            getvtilde->set_col(0, convert<T>(setvtilde[ty].col(tx)));
 
         getvtilde -= NWAC;
         gptucheck -= NWAC;
@@ -218,196 +226,345 @@ void alg5_step3( Matrix<float,R,WS> *g_ptucheck,
 
 }
 
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 5 step 3 with look-back
+ *
+ *  Same as alg5_step3() but in parallel for all tiles of LBC blocks
+ *  of all columns of blocks, as alg3v4v5v6_step2v4_lookback_fwd()
+ *  and alg3v4v5v6_step2v4_lookback_rev(): the fixes of
+ *  \f$P^T_{m,n}(U)\f$ (or \f$E^T_{m,n}(V)\f$) by \f$P_{m,n}(Y)\f$
+ *  and \f$E_{m,n}(Z)\f$ do not depend on the recursion, thus they
+ *  are added to each carry before adjusting the tile.  It is launched
+ *  twice, forward then reverse, with the look-back flags (and tile
+ *  counter) zero at each launch (see launch_alg5_step3()).
+ *
+ *  @param[in,out] g_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_cmat Constant pre-computed matrices on equations (27) and (29)
+ *  @param[in,out] g_lbcarry Look-back carries (two per tile)
+ *  @param[in,out] g_lbflags Look-back tile counter and flags (one per tile)
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] AbC_T Carry adjusting matrix (of the direction) to the power of LBC
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] seqs All columns of blocks (of all images in batch)
+ *  @tparam REV Flag to adjust the reverse carries (forward otherwise)
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float, double or half, see carry_traits)
+ */
+template <bool REV, int R, class T>
+__global__ __launch_bounds__(WS)
+void alg5_step3_lookback( Matrix<T,R,WS> *g_ptucheck,
+                          Matrix<T,R,WS> *g_etvtilde,
+                          const Matrix<T,R,WS> *g_py,
+                          const Matrix<T,R,WS> *g_ez,
+                          const Matrix<typename carry_traits<T>::compute,R,WS> *g_cmat,
+                          Matrix<typename carry_traits<T>::compute,R,WS> *g_lbcarry,
+                          int *g_lbflags,
+                          const filter_params<R,T> params,
+                          const Matrix<typename carry_traits<T>::compute,R,R> AbC_T,
+                          int m_size, int n_size, int seqs ) {
+
+    int tx = threadIdx.x, id = lookback_tile(g_lbflags),
+        tiles = (n_size+LBC-1)/LBC, s = id % seqs,
+        t = REV ? tiles-1 - id / seqs : id / seqs,
+        m = s % m_size, n0 = t*LBC, c = min(LBC, n_size-n0);
+    typedef typename carry_traits<T>::compute TF;
+    Vector<TF,R> pet[LBC], cmat[3], py, ez, x;
+
+    // offset carries to the column (of the image in batch) of this tile
+    g_ptucheck += s*(n_size+1);
+    g_etvtilde += s*(n_size+1);
+    g_py += (s / m_size)*(m_size+1)*n_size;
+    g_ez += (s / m_size)*(m_size+1)*n_size;
+    g_lbcarry += 2*s*tiles;
+    g_lbflags += 1 + s*tiles;
+
+#pragma unroll
+    for (int r=0; r<R; ++r) {
+        cmat[0][r] = g_cmat[0][r][tx];
+        cmat[1][r] = g_cmat[1][r][tx];
+        cmat[2][r] = g_cmat[REV ? 3 : 2][r][tx];
+    }
+
+#pragma unroll // fixed carries of this tile
+    for (int k = 0; k < LBC; ++k) {
+        if (k < c) {
+            int n = n0+k;
+            py = convert<TF>(((const Matrix<T,R,WS> *)&g_py[n*(m_size+1)+m+0][0][tx])->col(0));
+            ez = convert<TF>(((const Matrix<T,R,WS> *)&g_ez[n*(m_size+1)+m+1][0][tx])->col(0));
+            if (REV)
+                pet[k] = convert<TF>(((Matrix<T,R,WS> *)&g_etvtilde[n][0][tx])->col(0))
+                    + convert<TF>(((Matrix<T,R,WS> *)&g_ptucheck[n][0][tx])->col(0)) * params.HARB_AFP_T;
+            else
+                pet[k] = convert<TF>(((Matrix<T,R,WS> *)&g_ptucheck[n+1][0][tx])->col(0));
+            fixpet(pet[k], cmat[2], cmat[0], ez);
+            fixpet(pet[k], cmat[2], cmat[1], py);
+        }
+    }
+
+    x = zeros<TF,R>();
+
+    if (t != (REV ? tiles-1 : 0)) {
+#pragma unroll // aggregate of this tile
+        for (int k = 0; k < LBC; ++k) {
+            int j = REV ? LBC-1-k : k;
+            if (j < c) x = pet[j] + x * (REV ? params.AbR_T : params.AbF_T);
+        }
+        lookback_publish(&g_lbcarry[2*t], &g_lbflags[t], x, 1);
+        x = lookback_incoming(g_lbcarry, g_lbflags, t, REV ? -1 : 1, AbC_T);
+    }
+
+#pragma unroll // adjust ptucheck top -> bottom or etvtilde bottom -> top
+    for (int k = 0; k < LBC; ++k) {
+        int j = REV ? LBC-1-k : k;
+        if (j < c) {
+            x = pet[j] + x * (REV ? params.AbR_T : params.AbF_T);
+            if (REV) ((Matrix<T,R,WS> *)&g_etvtilde[n0+j][0][tx])->set_col(0, convert<T>(x));
+            else ((Matrix<T,R,WS> *)&g_ptucheck[n0+j+1][0][tx])->set_col(0, convert<T>(x));
+        }
+    }
+
+    if (t != (REV ? 0 : tiles-1))
+        lookback_publish(&g_lbcarry[2*t], &g_lbflags[t], x, 2);
+
+}
+
 /**
  *  @ingroup api_gpu
- *  @brief Compute algorithm 5 in the GPU
+ *  @brief Launch algorithm 5 step 3 of a plan
  *
- *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  Launch alg5_step3() on the plan stream or, with look-back (see
+ *  prepare_lookback()), alg5_step3_lookback() forward and reverse
+ *  with their flags reset before.  The column carries are adjusted
+ *  by the filter of columns (see prepare_axes()).
+ *
+ *  @param[in,out] plan The plan (with the carries and look-back buffers)
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <int R, class TC>
+void launch_alg5_step3( alg5v6_plan<R,TC>& plan ) {
+
+    const int m_size = plan.m_size, n_size = plan.n_size,
+        batch = plan.batch*plan.channels;
+
+    if (!plan.lookback) {
+        alg5_step3<<< dim3(m_size, 1, batch), dim3(WS, NWAC), 0, plan.stream >>>
+            ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+              &plan.d_cmat, plan.params_cols, m_size, n_size );
+        return;
+    }
+
+    const int seqs = m_size*batch, tiles = ((n_size+LBC-1)/LBC)*seqs;
+
+    cudaMemsetAsync(&plan.d_lbflags, 0, (1+tiles)*sizeof(int), plan.stream);
+
+    alg5_step3_lookback<false><<< tiles, WS, 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_cmat, &plan.d_lbcarry, &plan.d_lbflags, plan.params_cols,
+          plan.AbF_T_C_cols, m_size, n_size, seqs );
+
+    cudaMemsetAsync(&plan.d_lbflags, 0, (1+tiles)*sizeof(int), plan.stream);
+
+    alg5_step3_lookback<true><<< tiles, WS, 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_cmat, &plan.d_lbcarry, &plan.d_lbflags, plan.params_cols,
+          plan.AbR_T_C_cols, m_size, n_size, seqs );
+
+}
+
+/**
+ *  @struct alg5_plan alg5_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of algorithm 5
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float, double or half precision carries)
+ */
+template <bool BORDER, int R, class TC=float>
+struct alg5_plan : public alg5v6_plan<R,TC> { };
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 5 plan in the GPU
+ *
+ *  Pre-compute matrices, allocate device memory and configure
+ *  kernels once for a given image size, filter weights and border.
+ *  The same plan can then run on many input images.
+ *  Plans of skinny images adjust carries with look-back (see
+ *  skinny_plan()).
+ *
+ *  @param[out] plan The plan to prepare
  *  @param[in] width Image width
  *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
  *  @param[in] w Filter weights (feedforward and feedback coefficients)
  *  @param[in] border Number of border blocks (32x32) outside image
  *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] batch Number of images (of same size) filtered together
+ *  @param[in] channels Number of interleaved channels per pixel (1 to 4)
+ *  @param[in] half Flag for half-precision input and output storage
+ *  @param[in] tight Flag to allocate the output with tight pitch (stride equal to width)
  *  @tparam BORDER Flag to consider border input padding
  *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
  */
-template <bool BORDER, int R>
-void alg5_gpu( float *h_img,
-               int width, int height, int runtimes,
-               const Vector<float, R+1>& w,
-               int border=0,
-               BorderType border_type=CLAMP_TO_ZERO ) {
+template <bool BORDER, int R, class TC>
+void prepare_alg5( alg5_plan<BORDER,R,TC>& plan,
+                   int width, int height,
+                   const Vector<float, R+1>& w,
+                   int border=0,
+                   BorderType btype=CLAMP_TO_ZERO,
+                   int batch=1,
+                   int channels=1,
+                   bool half=false,
+                   bool tight=false ) {
 
-    const int B = WS;
+    if (!BORDER) { border = 0; btype = CLAMP_TO_ZERO; }
 
-    // pre-compute basic alg5 matrices
-    Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
+    prepare_alg5v6(plan, width, height, w, border, btype, BORDER,
+                   batch > 1 ? batch : 1, channels, half, tight);
 
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w), ARE_T = rev(Zrb, Ir, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w), ARB_T = rev(Ib, Zbr, w);
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T), AbR_T = head<R>(ARE_T);
-    Matrix<float,R,R> AbF = transp(AbF_T), AbR = transp(AbR_T);
-    Matrix<float,R,R> HARB_AFP_T = AFP_T*head<R>(ARB_T);
-    Matrix<float,R,R> HARB_AFP = transp(HARB_AFP_T);
-    Matrix<float,R,B> ARB_AFP_T = AFP_T*ARB_T, TAFB = transp(tail<R>(AFB_T));
-    Matrix<float,R,B> HARB_AFB = transp(AFB_T*head<R>(ARB_T));
+    config_alg5v6<BORDER>(plan);
+    cudaFuncSetCacheConfig(alg5_step3<R,TC>, cudaFuncCachePreferShared);
 
-    int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
+    if (skinny_plan(plan)) prepare_lookback(plan);
 
-    if (BORDER) {
-        int border_left, border_top, border_right, border_bottom;
-        calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
-                     width, height, border);
-        int ewidth = width+border_left+border_right,
-            eheight = height+border_top+border_bottom;
+}
 
-        m_size = (ewidth+WS-1)/WS;
-        n_size = (eheight+WS-1)/WS;
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 5 plan in the GPU
+ *
+ *  The plan input is filtered to the plan output in device memory,
+ *  see upload() and download().  With the plan graph enabled, the
+ *  kernels are captured on the first run and replayed after (see
+ *  plan_graph).  Steps 2 and 3 may adjust carries with look-back
+ *  (see prepare_lookback()).  Filtering only rows skips step 3, only
+ *  columns skips step 2 (see prepare_axes()).  Steps 1 and 4 may run
+ *  on tensor cores (see prepare_tensor()).
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional four timers to measure each step
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class TC>
+void alg5_gpu( alg5_plan<BORDER,R,TC>& plan,
+               base_timer **timer=0 ) {
 
-        copy_to_symbol(c_border, border);
-    }
+    if (!timer && launch_graph(plan, alg5_gpu<BORDER,R,TC>))
+        return; // replayed the captured kernels (see plan_graph)
 
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AbR_T, AbR_T);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T);
-
-    copy_to_symbol(c_ARE_T, ARE_T);
-    copy_to_symbol(c_ARB_AFP_T, ARB_AFP_T);
-    copy_to_symbol(c_TAFB, TAFB);
-    copy_to_symbol(c_HARB_AFB, HARB_AFB);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-
-    if (BORDER) {
-        switch(border_type) {
-        case CLAMP_TO_ZERO:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-            break;
-        case CLAMP_TO_EDGE:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
-            break;
-        case REPEAT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
-            break;
-        case REFLECT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeMirror;
-            break;
-        }
-    }
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
-    int stride_img = width+WS;
-    if (BORDER) stride_img = width+WS*border+WS;
-
-    dvector<float> d_img(height*stride_img);
-
-    // +1 padding is important even in zero-border to avoid if's in kernels
-    dvector< Matrix<float,R,B> > d_pybar((m_size+1)*n_size), d_ezhat((m_size+1)*n_size);
-    dvector< Matrix<float,R,B> > d_ptucheck((n_size+1)*m_size), d_etvtilde((n_size+1)*m_size);
-    d_pybar.fillzero();
-    d_ezhat.fillzero();
-    d_ptucheck.fillzero();
-    d_etvtilde.fillzero();
-
-    // the following matrices can not be read from constant memory as one warp
-    // will access each column by a different thread, serializing access and
-    // hurting performance, the solution is to store them in global memory
-    // and manage to have them in L1 cache as soon as possible;
-    // constant r x b matrices: ARE_T, ARB_AFP_T, TAFB, HARB_AFB
-    Matrix<float,R,B> h_cmat[4] = { ARE_T, ARB_AFP_T, TAFB, HARB_AFB };
-    dvector< Matrix<float,R,B> > d_cmat(h_cmat, 4);
-
-    cudaFuncSetCacheConfig(alg5v6_step1<BORDER,R>, cudaFuncCachePreferShared);
-    cudaFuncSetCacheConfig(alg5v6_step4v5<BORDER,R>, cudaFuncCachePreferShared);
-    cudaFuncSetCacheConfig(alg5_step3<R>, cudaFuncCachePreferShared);
-
-    if (R == 1)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferL1);
-    else if (R == 2)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferEqual);
-    else if (R >= 3)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferShared);
-
-    double te[4] = {0, 0, 0, 0}; // time elapsed for the four steps
-    base_timer *timer[4];
-    for (int i = 0; i < 4; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+    if (timer) timer[0]->start();
 
-    base_timer &timer_total = timers.gpu_add("alg5_gpu", width*height, "iP");
+    if (plan.tensor)
+        launch_alg5v6_tc_step1<BORDER>(plan);
+    else
+        launch_alg5v6_step1<BORDER>(plan, &plan.d_pybar, &plan.d_ezhat,
+                                    &plan.d_ptucheck, &plan.d_etvtilde, plan.params);
 
-    for(int r = 0; r < runtimes; ++r) {
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-        if (runtimes MST 1) { timer[0]->start(); }
+    if (plan.axes != COLUMNS_ONLY)
+        launch_alg3v4v5v6_step2v4(plan, &plan.d_pybar, &plan.d_ezhat, m_size, n_size);
 
-        cudaBindTextureToArray(t_in, a_in);
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-        alg5v6_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size );
+    if (plan.axes != ROWS_ONLY)
+        launch_alg5_step3(plan);
 
-        if (runtimes MST 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        alg3v4v5v6_step2v4<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar, &d_ezhat, m_size );
+    if (plan.tensor)
+        launch_alg5v6_tc_step4v5<BORDER>(plan);
+    else
+        launch_alg5v6_step4v5<BORDER>(plan, &plan.d_pybar, &plan.d_ezhat,
+                                      &plan.d_ptucheck, &plan.d_etvtilde, plan.params);
 
-        if (runtimes MST 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    if (timer) timer[3]->stop();
 
-        alg5_step3<<< dim3(m_size, 1), dim3(WS, NWAC) >>>
-            ( &d_ptucheck, &d_etvtilde, &d_pybar, &d_ezhat,
-#ifdef GMAT
-              &d_cmat,
-#endif
-              m_size, n_size );
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 5 in the GPU
+ *
+ *  @see [NehabEtAl:2011] cited in alg5() and [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+void alg5_gpu( float *h_img,
+               int width, int height, int runtimes,
+               const Vector<float, R+1>& w,
+               int border=0,
+               BorderType border_type=CLAMP_TO_ZERO ) {
 
-        if (runtimes MST 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+#ifdef MIXED // external define it to keep carries in double precision
+    alg5_plan<BORDER,R,double> plan;
+#elif defined(COMPACT) // external define it to store carries in half precision
+    alg5_plan<BORDER,R,__half> plan;
+#else
+    alg5_plan<BORDER,R> plan;
+#endif
+#ifdef HALF // external define it to store images in half precision
+    prepare_alg5(plan, width, height, w, border, border_type, 1, 1, true);
+#else
+    prepare_alg5(plan, width, height, w, border, border_type);
+#endif
+    if (tensor_precision()) // see tensor_precision()
+        prepare_tensor(plan, tensor_precision());
 
-        alg5v6_step4v5<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size, stride_img );
+    upload(plan, h_img);
 
-        cudaUnbindTexture(t_in);
+    const char *steps[4] = { "step 1", "step 2", "step 3", "step 4" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[4];
+    for (int i = 0; i < 4; ++i)
+        timer[i] = new step_timer(std::string("alg5_gpu ") + steps[i]);
 
-        if (runtimes MST 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); }
+    base_timer &timer_total = timers.gpu_add("alg5_gpu", width*height, "iP");
 
-    }
+    for(int r = 0; r < runtimes; ++r)
+        alg5_gpu(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 4; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        if (runtimes MST 1) {
+        if (timed) {
             for (int i = 0; i < 4; ++i)
-                std::cout << std::fixed << " " << te[i]/(double)runtimes << std::flush;
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
         } else {
             std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
         }
 
     } else {
 
-        timers.gpu_add("step 1", timer[0]);
-        timers.gpu_add("step 2", timer[1]);
-        timers.gpu_add("step 3", timer[2]);
-        timers.gpu_add("step 4", timer[3]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
@@ -9,6 +9,10 @@
 #ifndef ALG5F4_GPU_CUH
 #define ALG5F4_GPU_CUH
 
+//== INCLUDES ==================================================================
+
+#include "gpuplan.h"
+
 //== GLOBAL-SCOPE DEFINITIONS ==================================================
 
 // there is no template option for CUDA constant variables
@@ -38,6 +42,7 @@ __constant__ Matrix<float,R1,WS> c_ARE_T1, c_ARB_AFP_T1, c_TAFB1, c_HARB_AFB1;
  *  @brief Algorithm 5 stage 1 for order r1=1
  *  @note This follows the original implementation in [NehabEtAl:2011]
  *  @see alg5_stage1()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
@@ -50,7 +55,8 @@ __constant__ Matrix<float,R1,WS> c_ARE_T1, c_ARB_AFP_T1, c_TAFB1, c_HARB_AFB1;
  */
 template <bool BORDER>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg5_stage1_r1( Matrix<float,R1,WS> *g_pybar, 
+void alg5_stage1_r1( cudaTextureObject_t tex,
+                     Matrix<float,R1,WS> *g_pybar, 
                      Matrix<float,R1,WS> *g_ezhat,
                      Matrix<float,R1,WS> *g_ptucheck,
                      Matrix<float,R1,WS> *g_etvtilde,
@@ -61,9 +67,9 @@ void alg5_stage1_r1( Matrix<float,R1,WS> *g_pybar,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWC>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWC>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWC>(block, m, n, inv_width, inv_height);
+        read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     if (ty==0) {
@@ -324,6 +330,7 @@ void alg5_stage3_r1( Matrix<float,R1,WS> *g_ptucheck,
  *  @note This follows the original implementation in [NehabEtAl:2011]
  *  @see alg5_stage4()
  *  @see alg4_stage1()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
@@ -340,7 +347,8 @@ void alg5_stage3_r1( Matrix<float,R1,WS> *g_ptucheck,
  */
 template <bool BORDER>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg5f4_r1r2( float *g_out,
+void alg5f4_r1r2( cudaTextureObject_t tex,
+                  float *g_out,
                   const Matrix<float,R1,WS> *g_py,
                   const Matrix<float,R1,WS> *g_ez,
                   const Matrix<float,R1,WS> *g_ptu,
@@ -355,9 +363,9 @@ void alg5f4_r1r2( float *g_out,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWW>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
+        read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     Matrix<float,R1,WS> 
@@ -437,6 +445,7 @@ void alg5f4_r1r2( float *g_out,
  *  @brief Algorithm 4 stage 1 for order r2=2
  *  @note This follows the original implementation in [NehabEtAl:2011]
  *  @see alg4_stage1()
+ *  @param[in] tex The texture object of the image to filter
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[in] inv_width Image width inversed (1/w)
@@ -446,7 +455,8 @@ void alg5f4_r1r2( float *g_out,
  */
 template <bool BORDER>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg4_stage1_r2( Matrix<float,R2,WS> *g_pybar, 
+void alg4_stage1_r2( cudaTextureObject_t tex,
+                     Matrix<float,R2,WS> *g_pybar, 
                      Matrix<float,R2,WS> *g_ezhat,
                      float inv_width, float inv_height,
                      int m_size ) {
@@ -455,9 +465,9 @@ void alg4_stage1_r2( Matrix<float,R2,WS> *g_pybar,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWC>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWC>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWC>(block, m, n, inv_width, inv_height);
+        read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     if (ty==0) {
@@ -578,6 +588,7 @@ void alg4_stage2v4_r2( Matrix<float,R2,WS> *g_pybar,
  *  @brief Algorithm 4 stage 3 or 5 for order r2=2
  *  @note This follows the original implementation in [NehabEtAl:2011]
  *  @see alg4_stage3v5()
+ *  @param[in] tex The texture object of the filtered (or transposed) image
  *  @param[out] g_transp_out The output transposed 2D image
  *  @param[in] g_rows_py All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$ 
  *  @param[in] g_rows_ez All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$ 
@@ -593,7 +604,8 @@ void alg4_stage2v4_r2( Matrix<float,R2,WS> *g_pybar,
  */
 template <bool FUSION, bool BORDER>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg4_stage3v5_r2( float *g_transp_out,
+void alg4_stage3v5_r2( cudaTextureObject_t tex,
+                       float *g_transp_out,
                        const Matrix<float,R2,WS> *g_rows_py,
                        const Matrix<float,R2,WS> *g_rows_ez,
                        Matrix<float,R2,WS> *g_cols_py,
@@ -606,9 +618,9 @@ void alg4_stage3v5_r2( float *g_transp_out,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWW>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
+        read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     Matrix<float,R2,WS> 
@@ -674,14 +686,33 @@ void alg4_stage3v5_r2( float *g_transp_out,
 }
 
 /**
+ *  @struct alg5f4_plan alg5f4_gpu.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm 5 fusioned with algorithm 4 in the GPU
- *  @see alg5_gpu()
- *  @see alg4_gpu()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @brief Filter plan of algorithm 5 fusioned with algorithm 4
+ *  @tparam BORDER Flag to consider border input padding
+ */
+template <bool BORDER>
+struct alg5f4_plan : public alg_plan {
+    Vector<float,R1+1> w1; ///< Filter weights for order r1=1
+    Vector<float,R2+1> w2; ///< Filter weights for order r2=2
+    alg_matrices<R1> mat1; ///< Pre-computed basic matrices for order r1
+    alg_matrices<R2> mat2; ///< Pre-computed basic matrices for order r2
+    int stride_transp_img; ///< Transposed image stride
+    dvector<float> d_transp_img; ///< Transposed intermediate image
+    pitch_texture tex_img, tex_transp; ///< Texture objects of the intermediate and transposed images
+    dvector< Matrix<float,R1,WS> > d_pybar1, d_ezhat1; ///< Row carries for order r1
+    dvector< Matrix<float,R1,WS> > d_ptucheck1, d_etvtilde1; ///< Column carries for order r1
+    dvector< Matrix<float,R2,WS> > d_pybar2, d_ezhat2; ///< Row carries for order r2
+    dvector< Matrix<float,R2,WS> > d_pubar2, d_evhat2; ///< Column carries for order r2
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 5 fusioned with algorithm 4 plan in the GPU
+ *
+ *  @param[out] plan The plan to prepare
  *  @param[in] width Image width
  *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
  *  @param[in] w1 Filter weights for order r1=1
  *  @param[in] w2 Filter weights for order r2=2
  *  @param[in] border Number of border blocks (32x32) outside image
@@ -689,221 +720,205 @@ void alg4_stage3v5_r2( float *g_transp_out,
  *  @tparam BORDER Flag to consider border input padding
  */
 template <bool BORDER>
-void alg5f4_gpu( float *h_img,
-                 int width, int height, int runtimes,
-                 const Vector<float, R1+1>& w1,
-                 const Vector<float, R2+1>& w2,
-                 int border=0,
-                 BorderType border_type=CLAMP_TO_ZERO ) {
+void prepare_alg5f4( alg5f4_plan<BORDER>& plan,
+                     int width, int height,
+                     const Vector<float, R1+1>& w1,
+                     const Vector<float, R2+1>& w2,
+                     int border=0,
+                     BorderType btype=CLAMP_TO_ZERO ) {
 
-    const int B = WS;
-
-    // pre-compute basic alg5 matrices
-    Matrix<float,B,B> Ib = identity<float,B,B>();
-
-    // for order r1
-    Matrix<float,R1,R1> Ir1 = identity<float,R1,R1>();
-    Matrix<float,B,R1> Zbr1 = zeros<float,B,R1>();
-    Matrix<float,R1,B> Zrb1 = zeros<float,R1,B>();
-
-    Matrix<float,R1,B> AFP_T1 = fwd(Ir1, Zrb1, w1), ARE_T1 = rev(Zrb1, Ir1, w1);
-    Matrix<float,B,B> AFB_T1 = fwd(Zbr1, Ib, w1), ARB_T1 = rev(Ib, Zbr1, w1);
-    Matrix<float,R1,R1> AbF_T1 = tail<R1>(AFP_T1), AbR_T1 = head<R1>(ARE_T1);
-    Matrix<float,R1,R1> AbF1 = transp(AbF_T1), AbR1 = transp(AbR_T1);
-    Matrix<float,R1,R1> HARB_AFP_T1 = AFP_T1*head<R1>(ARB_T1);
-    Matrix<float,R1,R1> HARB_AFP1 = transp(HARB_AFP_T1);
-    Matrix<float,R1,B> ARB_AFP_T1 = AFP_T1*ARB_T1, TAFB1 = transp(tail<R1>(AFB_T1));
-    Matrix<float,R1,B> HARB_AFB1 = transp(AFB_T1*head<R1>(ARB_T1));
-
-    // for order r2
-    Matrix<float,R2,R2> Ir2 = identity<float,R2,R2>();
-    Matrix<float,B,R2> Zbr2 = zeros<float,B,R2>();
-    Matrix<float,R2,B> Zrb2 = zeros<float,R2,B>();
-
-    Matrix<float,R2,B> AFP_T2 = fwd(Ir2, Zrb2, w2), ARE_T2 = rev(Zrb2, Ir2, w2);
-    Matrix<float,B,B> AFB_T2 = fwd(Zbr2, Ib, w2), ARB_T2 = rev(Ib, Zbr2, w2);
-    Matrix<float,R2,R2> AbF_T2 = tail<R2>(AFP_T2), AbR_T2 = head<R2>(ARE_T2);
-    Matrix<float,R2,R2> AbF2 = transp(AbF_T2), AbR2 = transp(AbR_T2);
-    Matrix<float,R2,R2> HARB_AFP_T2 = AFP_T2*head<R2>(ARB_T2);
-    Matrix<float,R2,R2> HARB_AFP2 = transp(HARB_AFP_T2);
-    Matrix<float,R2,B> ARB_AFP_T2 = AFP_T2*ARB_T2, TAFB2 = transp(tail<R2>(AFB_T2));
-    Matrix<float,R2,B> HARB_AFB2 = transp(AFB_T2*head<R2>(ARB_T2));
-
-    int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
-
-    if (BORDER) {
-        int border_left, border_top, border_right, border_bottom;
-        calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
-                     width, height, border);
-        int ewidth = width+border_left+border_right,
-            eheight = height+border_top+border_bottom;
-
-        m_size = (ewidth+WS-1)/WS;
-        n_size = (eheight+WS-1)/WS;
-
-        copy_to_symbol(c_border, border);
-    }
+    if (!BORDER) { border = 0; btype = CLAMP_TO_ZERO; }
 
-    // upload to the GPU
+    prepare_plan(plan, width, height, border, btype, BORDER);
 
-    // order r1
-    copy_to_symbol(c_weights1, w1);
+    plan.w1 = w1;
+    plan.w2 = w2;
+    calc_matrices(plan.mat1, w1);
+    calc_matrices(plan.mat2, w2);
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
-    copy_to_symbol(c_AbF_T1, AbF_T1);
-    copy_to_symbol(c_AbR_T1, AbR_T1);
-    copy_to_symbol(c_HARB_AFP_T1, HARB_AFP_T1);
+    plan.stride_transp_img = plan.stride_img;
+    plan.d_transp_img.resize(width*plan.stride_transp_img);
+    plan.tex_img.create(plan.d_img, height, width, plan.stride_img,
+                        address_mode(plan.btype));
+    plan.tex_transp.create(plan.d_transp_img, height, width,
+                           plan.stride_transp_img, address_mode(plan.btype));
 
-    copy_to_symbol(c_ARE_T1, ARE_T1);
-    copy_to_symbol(c_ARB_AFP_T1, ARB_AFP_T1);
-    copy_to_symbol(c_TAFB1, TAFB1);
-    copy_to_symbol(c_HARB_AFB1, HARB_AFB1);
+    // +1 padding is important even in zero-border to avoid if's in kernels
+    // order r1
+    plan.d_pybar1.resize((m_size+1)*n_size);
+    plan.d_ezhat1.resize((m_size+1)*n_size);
+    plan.d_ptucheck1.resize((n_size+1)*m_size);
+    plan.d_etvtilde1.resize((n_size+1)*m_size);
+    plan.d_pybar1.fillzero();
+    plan.d_ezhat1.fillzero();
+    plan.d_ptucheck1.fillzero();
+    plan.d_etvtilde1.fillzero();
 
     // order r2
-    copy_to_symbol(c_weights2, w2);
-
-    copy_to_symbol(c_AbF_T2, AbF_T2);
-    copy_to_symbol(c_AbR_T2, AbR_T2);
-    copy_to_symbol(c_HARB_AFP_T2, HARB_AFP_T2);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-    size_t offset;
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-
-    if (BORDER) {
-        switch(border_type) {
-        case CLAMP_TO_ZERO:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-            break;
-        case CLAMP_TO_EDGE:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
-            break;
-        case REPEAT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
-            break;
-        case REFLECT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeMirror;
-            break;
-        }
-    }
+    plan.d_pybar2.resize((m_size+1)*n_size);
+    plan.d_ezhat2.resize((m_size+1)*n_size);
+    plan.d_pubar2.resize((n_size+1)*m_size);
+    plan.d_evhat2.resize((n_size+1)*m_size);
+    plan.d_pybar2.fillzero();
+    plan.d_ezhat2.fillzero();
+    plan.d_pubar2.fillzero();
+    plan.d_evhat2.fillzero();
 
-    int stride_img = width+WS, stride_transp_img = width+WS;
-    if (BORDER) stride_img = stride_transp_img = width+WS*border+WS;
+}
 
-    dvector<float> d_img(height*stride_img), d_transp_img(width*stride_transp_img);
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 5 fusioned with algorithm 4 plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional eight timers to measure each stage
+ *  @tparam BORDER Flag to consider border input padding
+ */
+template <bool BORDER>
+void alg5f4_gpu( alg5f4_plan<BORDER>& plan,
+                 base_timer **timer=0 ) {
 
-    // +1 padding is important even in zero-border to avoid if's in kernels
-    // order r1
-    dvector< Matrix<float,R1,B> > d_pybar1((m_size+1)*n_size), d_ezhat1((m_size+1)*n_size);
-    dvector< Matrix<float,R1,B> > d_ptucheck1((n_size+1)*m_size), d_etvtilde1((n_size+1)*m_size);
-    d_pybar1.fillzero();
-    d_ezhat1.fillzero();
-    d_ptucheck1.fillzero();
-    d_etvtilde1.fillzero();
+    if (make_current(plan)) {
+        copy_to_symbol(c_border, plan.border);
 
-    // order r2
-    dvector< Matrix<float,R2,B> > d_pybar2((m_size+1)*n_size), d_ezhat2((m_size+1)*n_size);
-    dvector< Matrix<float,R2,B> > d_pubar2((n_size+1)*m_size), d_evhat2((n_size+1)*m_size);
-    d_pybar2.fillzero();
-    d_ezhat2.fillzero();
-    d_pubar2.fillzero();
-    d_evhat2.fillzero();
-
-    double te[8] = {0, 0, 0, 0, 0, 0, 0, 0}; // time elapsed for eight stages
-    base_timer *timer[8];
-    for (int i = 0; i < 8; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+        // order r1
+        copy_to_symbol(c_weights1, plan.w1);
 
-    base_timer &timer_total = timers.gpu_add("alg5f4_gpu", width*height, "iP");
+        copy_to_symbol(c_AbF_T1, plan.mat1.AbF_T);
+        copy_to_symbol(c_AbR_T1, plan.mat1.AbR_T);
+        copy_to_symbol(c_HARB_AFP_T1, plan.mat1.HARB_AFP_T);
 
-    for(int r = 0; r < runtimes; ++r) {
+        copy_to_symbol(c_ARE_T1, plan.mat1.ARE_T);
+        copy_to_symbol(c_ARB_AFP_T1, plan.mat1.ARB_AFP_T);
+        copy_to_symbol(c_TAFB1, plan.mat1.TAFB);
+        copy_to_symbol(c_HARB_AFB1, plan.mat1.HARB_AFB);
 
-        if (runtimes == 1) { timer[0]->start(); }
+        // order r2
+        copy_to_symbol(c_weights2, plan.w2);
 
-        cudaBindTextureToArray(t_in, a_in);
+        copy_to_symbol(c_AbF_T2, plan.mat2.AbF_T);
+        copy_to_symbol(c_AbR_T2, plan.mat2.AbR_T);
+        copy_to_symbol(c_HARB_AFP_T2, plan.mat2.HARB_AFP_T);
+    }
 
-        alg5_stage1_r1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar1, &d_ezhat1, &d_ptucheck1, &d_etvtilde1, inv_width, inv_height, m_size, n_size );
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    const float inv_width = plan.inv_width, inv_height = plan.inv_height;
 
-        if (runtimes == 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    if (timer) timer[0]->start();
 
-        alg5_stage2_r1<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar1, &d_ezhat1, m_size );
+    alg5_stage1_r1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar1, &plan.d_ezhat1, &plan.d_ptucheck1, &plan.d_etvtilde1,
+          inv_width, inv_height, m_size, n_size );
 
-        if (runtimes == 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-        alg5_stage3_r1<<< dim3(m_size, 1), dim3(WS, NWA) >>>
-            ( &d_ptucheck1, &d_etvtilde1, &d_pybar1, &d_ezhat1, m_size, n_size );
+    alg5_stage2_r1<<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pybar1, &plan.d_ezhat1, m_size );
 
-        if (runtimes == 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-        alg5f4_r1r2<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar1, &d_ezhat1, &d_ptucheck1, &d_etvtilde1,
-              &d_pybar2, &d_ezhat2, inv_width, inv_height,
-              m_size, n_size, stride_img );
+    alg5_stage3_r1<<< dim3(m_size, 1), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_ptucheck1, &plan.d_etvtilde1, &plan.d_pybar1, &plan.d_ezhat1,
+          m_size, n_size );
 
-        cudaUnbindTexture(t_in);
-        cudaBindTexture2D( &offset, t_in, d_img, height, width, stride_img*sizeof(float) );
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        if (runtimes == 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); timer[4]->start(); }
+    alg5f4_r1r2<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar1, &plan.d_ezhat1, &plan.d_ptucheck1, &plan.d_etvtilde1,
+          &plan.d_pybar2, &plan.d_ezhat2, inv_width, inv_height,
+          m_size, n_size, plan.stride_img );
 
-        alg4_stage2v4_r2<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar2, &d_ezhat2, m_size );
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
 
-        if (runtimes == 1) { timer[4]->stop(); te[4] += timer[4]->elapsed(); timer[5]->start(); }
+    alg4_stage2v4_r2<<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pybar2, &plan.d_ezhat2, m_size );
 
-        alg4_stage3v5_r2<true, BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_transp_img, &d_pybar2, &d_ezhat2, &d_pubar2, &d_evhat2,
-              inv_width, inv_height, m_size, n_size, stride_transp_img );
+    if (timer) { timer[4]->stop(); timer[5]->start(); }
 
-        cudaUnbindTexture(t_in);
-        cudaBindTexture2D(&offset, t_in, d_transp_img, height, width, stride_transp_img*sizeof(float));
+    alg4_stage3v5_r2<true, BORDER><<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_img.tex, plan.d_transp_img, &plan.d_pybar2, &plan.d_ezhat2, &plan.d_pubar2, &plan.d_evhat2,
+          inv_width, inv_height, m_size, n_size, plan.stride_transp_img );
 
-        if (runtimes == 1) { timer[5]->stop(); te[5] += timer[5]->elapsed(); timer[6]->start(); }
+    if (timer) { timer[5]->stop(); timer[6]->start(); }
 
-        alg4_stage2v4_r2<<< dim3(1, m_size), dim3(WS, NWA) >>>
-            ( &d_pubar2, &d_evhat2, n_size );
+    alg4_stage2v4_r2<<< dim3(1, m_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pubar2, &plan.d_evhat2, n_size );
 
-        if (runtimes == 1) { timer[6]->stop(); te[6] += timer[6]->elapsed(); timer[7]->start(); }
+    if (timer) { timer[6]->stop(); timer[7]->start(); }
 
-        alg4_stage3v5_r2<false, BORDER><<< dim3(n_size, m_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pubar2, &d_evhat2, &d_pybar2, &d_ezhat2,
-              inv_height, inv_width, n_size, m_size, stride_img );
+    alg4_stage3v5_r2<false, BORDER><<< dim3(n_size, m_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_transp.tex, plan.d_img, &plan.d_pubar2, &plan.d_evhat2, &plan.d_pybar2, &plan.d_ezhat2,
+          inv_height, inv_width, n_size, m_size, plan.stride_img );
 
-        cudaUnbindTexture(t_in);
+    if (timer) timer[7]->stop();
 
-        if (runtimes == 1) { timer[7]->stop(); te[7] += timer[7]->elapsed(); }
+}
 
-    }
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 5 fusioned with algorithm 4 in the GPU
+ *  @see alg5_gpu()
+ *  @see alg4_gpu()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w1 Filter weights for order r1=1
+ *  @param[in] w2 Filter weights for order r2=2
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam BORDER Flag to consider border input padding
+ */
+template <bool BORDER>
+void alg5f4_gpu( float *h_img,
+                 int width, int height, int runtimes,
+                 const Vector<float, R1+1>& w1,
+                 const Vector<float, R2+1>& w2,
+                 int border=0,
+                 BorderType border_type=CLAMP_TO_ZERO ) {
+
+    alg5f4_plan<BORDER> plan;
+    prepare_alg5f4(plan, width, height, w1, w2, border, border_type);
+
+    upload(plan, h_img);
+
+    const char *steps[8] = { "alg5 stage 1", "alg5 stage 2", "alg5 stage 3", "5.4 + 4.1",
+                             "alg4 stage 2", "alg4 stage 3", "alg4 stage 4", "alg4 stage 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[8];
+    for (int i = 0; i < 8; ++i)
+        timer[i] = new step_timer(std::string("alg5f4_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg5f4_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg5f4_gpu(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 8; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        if (timed) {
+            for (int i = 0; i < 8; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
 
     } else {
 
-        timers.gpu_add("alg5 stage 1", timer[0]);
-        timers.gpu_add("alg5 stage 2", timer[1]);
-        timers.gpu_add("alg5 stage 3", timer[2]);
-        timers.gpu_add("5.4 + 4.1", timer[3]);
-        timers.gpu_add("alg4 stage 2", timer[4]);
-        timers.gpu_add("alg4 stage 3", timer[5]);
-        timers.gpu_add("alg4 stage 4", timer[6]);
-        timers.gpu_add("alg4 stage 5", timer[7]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
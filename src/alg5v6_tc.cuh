@@ -0,0 +1,570 @@
+/**
+ *  @file alg5v6_tc.cuh
+ *  @brief Algorithms 5 and 6 block products on tensor cores
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG5V6_TC_CUH
+#define ALG5V6_TC_CUH
+
+//== INCLUDES ==================================================================
+
+#include <mma.h>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include "alg3v4v5v6_gpu.cuh"
+
+//== DEFINES ===================================================================
+
+#define NWT 4 ///< # of warps multiplying blocks on tensor cores
+#define TKP 48 ///< Padded inner size of the block products (b plus 2r carries)
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct tensor_traits alg5v6_tc.cuh
+ *  @ingroup gpu
+ *  @brief Operand storage and 16x16 tile product of a tensor precision
+ *
+ *  The operands are stored (in shared and global memory) in the
+ *  operand type with a leading dimension LD keeping the tiles aligned
+ *  to 256 bits, and multiplied in the tensor precision with
+ *  accumulation in single precision.  The products compile to nothing
+ *  on architectures without the precision (see prepare_tensor()).
+ *
+ *  @tparam P Tensor precision (TF32 or FP16)
+ */
+template <TensorPrecision P>
+struct tensor_traits;
+
+template <>
+struct tensor_traits<TENSOR_TF32> {
+    typedef float T; ///< Operand type
+    enum { LD = 52, ARCH = 80 }; ///< Operands leading dimension and minimum architecture
+    /// Convert a single-precision value to the operand type
+    __device__ static T to( float v ) { return v; }
+    /// Multiply a 16 x K tile times a K x 16 tile into a 16 x 16 tile (row-major)
+    template <int K>
+    __device__ static void product( float *c, int ldc,
+                                    const T *a, int lda,
+                                    const T *b, int ldb ) {
+#if __CUDA_ARCH__ >= 800
+        using namespace nvcuda;
+        wmma::fragment<wmma::matrix_a, 16, 16, 8, wmma::precision::tf32, wmma::row_major> fa;
+        wmma::fragment<wmma::matrix_b, 16, 16, 8, wmma::precision::tf32, wmma::row_major> fb;
+        wmma::fragment<wmma::accumulator, 16, 16, 8, float> fc;
+        wmma::fill_fragment(fc, 0.f);
+#pragma unroll
+        for (int k=0; k<K; k+=8) {
+            wmma::load_matrix_sync(fa, a+k, lda);
+            wmma::load_matrix_sync(fb, b+k*ldb, ldb);
+#pragma unroll
+            for (int i=0; i<fa.num_elements; ++i)
+                fa.x[i] = wmma::__float_to_tf32(fa.x[i]);
+#pragma unroll
+            for (int i=0; i<fb.num_elements; ++i)
+                fb.x[i] = wmma::__float_to_tf32(fb.x[i]);
+            wmma::mma_sync(fc, fa, fb, fc);
+        }
+        wmma::store_matrix_sync(c, fc, ldc, wmma::mem_row_major);
+#endif
+    }
+};
+
+template <>
+struct tensor_traits<TENSOR_FP16> {
+    typedef __half T; ///< Operand type
+    enum { LD = 56, ARCH = 70 }; ///< Operands leading dimension and minimum architecture
+    /// Convert a single-precision value to the operand type
+    __device__ static T to( float v ) { return __float2half(v); }
+    /// Multiply a 16 x K tile times a K x 16 tile into a 16 x 16 tile (row-major)
+    template <int K>
+    __device__ static void product( float *c, int ldc,
+                                    const T *a, int lda,
+                                    const T *b, int ldb ) {
+#if __CUDA_ARCH__ >= 700
+        using namespace nvcuda;
+        wmma::fragment<wmma::matrix_a, 16, 16, 16, __half, wmma::row_major> fa;
+        wmma::fragment<wmma::matrix_b, 16, 16, 16, __half, wmma::row_major> fb;
+        wmma::fragment<wmma::accumulator, 16, 16, 16, float> fc;
+        wmma::fill_fragment(fc, 0.f);
+#pragma unroll
+        for (int k=0; k<K; k+=16) {
+            wmma::load_matrix_sync(fa, a+k, lda);
+            wmma::load_matrix_sync(fb, b+k*ldb, ldb);
+            wmma::mma_sync(fc, fa, fb, fc);
+        }
+        wmma::store_matrix_sync(c, fc, ldc, wmma::mem_row_major);
+#endif
+    }
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 5 step 1 or algorithm 6 step 1 on tensor cores
+ *
+ *  Same as alg5v6_step1() with the scans of the block replaced by
+ *  dense products (see prepare_tensor()).  The row scans of block
+ *  \f$B_{m,n}(X)\f$ are one 32 x 48 product giving the block filtered
+ *  along rows (with zero carries) and its row perimeters
+ *  \f$P_{m,n}(Y)\f$ and \f$E_{m,n}(Z)\f$, and the column scans of
+ *  that are one 16 x 32 product giving the column perimeters
+ *  \f$P^T_{m,n}(U)\f$ and \f$E^T_{m,n}(V)\f$.  Each warp computes
+ *  some of the 16x16 output tiles.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] in The input in linear memory (in-place plans, see prepare_inplace())
+ *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
+ *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
+ *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] g_rows The 32 x 48 row operator (leading dimension TKP)
+ *  @param[in] g_cols The 16 x 32 column operator (leading dimension WS)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float)
+ *  @tparam P Tensor precision (TF32 or FP16)
+ */
+template <bool BORDER, int R, class TC, TensorPrecision P>
+__global__ __launch_bounds__(WS*NWT)
+void alg5v6_tc_step1( cudaTextureObject_t tex,
+                      const linear_input in,
+                      Matrix<TC,R,WS> *g_pybar,
+                      Matrix<TC,R,WS> *g_ezhat,
+                      Matrix<TC,R,WS> *g_ptucheck,
+                      Matrix<TC,R,WS> *g_etvtilde,
+                      const typename tensor_traits<P>::T *g_rows,
+                      const typename tensor_traits<P>::T *g_cols,
+                      int border,
+                      float inv_width, float inv_height,
+                      int m_size, int n_size ) {
+
+    typedef tensor_traits<P> tt;
+    typedef typename tt::T T;
+    enum { LD = tt::LD };
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y, l = blockIdx.z;
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    __shared__ __align__(32) T s_op[WS*LD];
+    __shared__ __align__(32) float s_res[WS*LD];
+
+    if (in.ptr) // read in place (no border blocks)
+        read_block<NWT>(block, in, m, n, l);
+    else if (BORDER) // read considering borders
+        read_block<NWT>(block, tex, m-border, n-border, l, inv_width, inv_height);
+    else
+        read_block<NWT>(block, tex, m, n, l, inv_width, inv_height);
+    __syncthreads();
+
+#pragma unroll
+    for (int i=ty; i<WS; i+=NWT)
+        s_op[i*LD+tx] = tt::to(block[i][tx]);
+    __syncthreads();
+
+    // rows: [ X*M | P(Y) | E(Z) ] = X * [ M | Kp | Ke ], 2x3 tiles
+    for (int t=ty; t<6; t+=NWT) {
+        int ti = (t/3)*16, tj = (t%3)*16;
+        tt::template product<WS>(s_res+ti*LD+tj, LD, s_op+ti*LD, LD, g_rows+tj, TKP);
+    }
+    __syncthreads();
+
+    g_pybar += l*(m_size+1)*n_size;
+    g_ezhat += l*(m_size+1)*n_size;
+    g_ptucheck += l*(n_size+1)*m_size;
+    g_etvtilde += l*(n_size+1)*m_size;
+
+    for (int r=ty; r<R; r+=NWT) {
+        g_pybar[n*(m_size+1)+m+1][r][tx] = (TC)s_res[tx*LD+WS+r];
+        g_ezhat[n*(m_size+1)+m][r][tx] = (TC)s_res[tx*LD+WS+R+r];
+    }
+
+#pragma unroll
+    for (int i=ty; i<WS; i+=NWT)
+        s_op[i*LD+tx] = tt::to(s_res[i*LD+tx]);
+    __syncthreads();
+
+    // columns: [ P^T(U) ; E^T(V) ] = [ Kp^T ; Ke^T ] * (X*M), 1x2 tiles
+    if (ty < 2)
+        tt::template product<WS>(s_res+ty*16, LD, g_cols, WS, s_op+ty*16, LD);
+    __syncthreads();
+
+    for (int r=ty; r<R; r+=NWT) {
+        g_ptucheck[m*(n_size+1)+n+1][r][tx] = (TC)s_res[r*LD+tx];
+        g_etvtilde[m*(n_size+1)+n][r][tx] = (TC)s_res[(R+r)*LD+tx];
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 5 step 4 or algorithm 6 step 5 on tensor cores
+ *
+ *  Same as alg5v6_step4v5() with the scans of the block replaced by
+ *  dense products (see prepare_tensor()).  The block \f$B_{m,n}(X)\f$
+ *  is extended by its row carries \f$P_{m-1,n}(Y)\f$ and
+ *  \f$E_{m+1,n}(Z)\f$ as 32 x 48 operand times the 48 x 32 row
+ *  operator, and the result extended by its column carries
+ *  \f$P^T_{m,n-1}(U)\f$ and \f$E^T_{m,n+1}(V)\f$ as 48 x 32 operand
+ *  times the 32 x 48 column operator gives \f$B_{m,n}(V)\f$.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] in The input in linear memory (in-place plans, see prepare_inplace())
+ *  @param[out] g_out The output 2D image
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] g_rows The 48 x 32 row operator (leading dimension WS)
+ *  @param[in] g_cols The 32 x 48 column operator (leading dimension TKP)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] out_width Output image width
+ *  @param[in] out_height Output image height
+ *  @param[in] out_stride Image output stride for memory width alignment
+ *  @param[in] out_size Image output size (stride times height) in batch
+ *  @param[in] out_x Output region left column in the image (see prepare_roi())
+ *  @param[in] out_y Output region top row in the image
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float)
+ *  @tparam P Tensor precision (TF32 or FP16)
+ */
+template <bool BORDER, int R, class TC, TensorPrecision P>
+__global__ __launch_bounds__(WS*NWT)
+void alg5v6_tc_step4v5( cudaTextureObject_t tex,
+                        const linear_input in,
+                        float *g_out,
+                        const Matrix<TC,R,WS> *g_py,
+                        const Matrix<TC,R,WS> *g_ez,
+                        const Matrix<TC,R,WS> *g_ptu,
+                        const Matrix<TC,R,WS> *g_etv,
+                        const typename tensor_traits<P>::T *g_rows,
+                        const typename tensor_traits<P>::T *g_cols,
+                        int border,
+                        float inv_width, float inv_height,
+                        int m_size, int n_size,
+                        int out_width, int out_height,
+                        int out_stride, int out_size,
+                        int out_x, int out_y ) {
+
+    typedef tensor_traits<P> tt;
+    typedef typename tt::T T;
+    enum { LD = tt::LD };
+
+    int tx = threadIdx.x, ty = threadIdx.y, l = blockIdx.z;
+
+    // the grid covers only the blocks of the output region
+    int m = blockIdx.x + out_x/WS + (BORDER ? border : 0),
+        n = blockIdx.y + out_y/WS + (BORDER ? border : 0);
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    __shared__ __align__(32) T s_op[TKP*LD];
+    __shared__ __align__(32) float s_res[WS*LD];
+
+    if (in.ptr) // read in place (no border blocks)
+        read_block<NWT>(block, in, m, n, l);
+    else if (BORDER) // read considering borders
+        read_block<NWT>(block, tex, m-border, n-border, l, inv_width, inv_height);
+    else
+        read_block<NWT>(block, tex, m, n, l, inv_width, inv_height);
+
+    g_py += l*(m_size+1)*n_size;
+    g_ez += l*(m_size+1)*n_size;
+    g_ptu += l*(n_size+1)*m_size;
+    g_etv += l*(n_size+1)*m_size;
+    g_out += l*out_size;
+    __syncthreads();
+
+    // rows operand: [ X | P(Y)^T | E(Z)^T | 0 ]
+#pragma unroll
+    for (int i=ty; i<WS; i+=NWT)
+        s_op[i*LD+tx] = tt::to(block[i][tx]);
+    for (int j=ty; j<TKP-WS; j+=NWT) {
+        float v = 0.f;
+        if (j < R) v = (float)g_py[n*(m_size+1)+m][j][tx];
+        else if (j < 2*R) v = (float)g_ez[n*(m_size+1)+m+1][j-R][tx];
+        s_op[tx*LD+WS+j] = tt::to(v);
+    }
+    __syncthreads();
+
+    // rows: Z = [ X | P(Y)^T | E(Z)^T ] * [ M ; Hp ; He ], 2x2 tiles
+    for (int t=ty; t<4; t+=NWT) {
+        int ti = (t/2)*16, tj = (t%2)*16;
+        tt::template product<TKP>(s_res+ti*LD+tj, LD, s_op+ti*LD, LD, g_rows+tj, WS);
+    }
+    __syncthreads();
+
+    // columns operand: [ Z ; P^T(U) ; E^T(V) ; 0 ]
+#pragma unroll
+    for (int i=ty; i<WS; i+=NWT)
+        s_op[i*LD+tx] = tt::to(s_res[i*LD+tx]);
+    for (int j=ty; j<TKP-WS; j+=NWT) {
+        float v = 0.f;
+        if (j < R) v = (float)g_ptu[m*(n_size+1)+n][j][tx];
+        else if (j < 2*R) v = (float)g_etv[m*(n_size+1)+n+1][j-R][tx];
+        s_op[(WS+j)*LD+tx] = tt::to(v);
+    }
+    __syncthreads();
+
+    // columns: V = [ M^T | Hp^T | He^T ] * [ Z ; P^T(U) ; E^T(V) ], 2x2 tiles
+    for (int t=ty; t<4; t+=NWT) {
+        int ti = (t/2)*16, tj = (t%2)*16;
+        tt::template product<TKP>(s_res+ti*LD+tj, LD, g_cols+ti*TKP, TKP, s_op+tj, LD);
+    }
+    __syncthreads();
+
+    int ox = m*WS-out_x, oy = n*WS-out_y; // block offset in the output image
+    if (BORDER) { ox -= border*WS; oy -= border*WS; }
+
+    if (ox+tx < 0 || ox+tx >= out_width) return;
+
+    for (int i=ty; i<WS; i+=NWT) // write block only inside valid image
+        if (oy+i >= 0 && oy+i < out_height)
+            g_out[(oy+i)*out_stride + ox+tx] = s_res[i*LD+tx];
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the responses of the forward and reverse scans of one block
+ *
+ *  The forward then reverse scans (fwdI() then revI()) of a row of
+ *  b values are linear in the values and in the initial carries,
+ *  thus they are given by the responses to each impulse.  The rows
+ *  of the (b+2r) x b response matrix are the scanned rows of an
+ *  impulse in each value, then in each forward carry, then in each
+ *  reverse carry.  The carries left by the scans of each impulse in
+ *  a value (with zero initial carries) are the b x r perimeter
+ *  responses of the forward and the reverse scans.
+ *
+ *  @param[out] A The response of the values and initial carries
+ *  @param[out] Kp The forward perimeter response of the values
+ *  @param[out] Ke The reverse perimeter response of the values
+ *  @param[in] wf Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void calc_block_responses( Matrix<double,WS+2*R,WS>& A,
+                           Matrix<double,WS,R>& Kp,
+                           Matrix<double,WS,R>& Ke,
+                           const Vector<float,R+1>& wf ) {
+    Vector<double,R+1> w = convert<double>(wf);
+    for (int j=0; j<WS+2*R; ++j) {
+        Vector<double,R> p = zeros<double,R>(), e = zeros<double,R>();
+        Vector<double,WS> x = zeros<double,WS>();
+        if (j < WS) x[j] = 1.;
+        else if (j < WS+R) p[j-WS] = 1.;
+        for (int k=0; k<WS; ++k)
+            x[k] = fwdI(p, x[k], w);
+        if (j < WS) Kp[j] = p;
+        if (j >= WS+R) e[j-WS-R] = 1.;
+        for (int k=WS-1; k>=0; --k)
+            x[k] = revI(x[k], e, w);
+        if (j < WS) Ke[j] = e;
+        A[j] = x;
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the block products on tensor cores of a plan
+ *
+ *  The scans of each block in algorithm 5 step 1 and step 4 and
+ *  algorithm 6 step 1 and step 5 (see alg5v6_block_carries() and
+ *  alg5v6_block_output()) are the same linear maps applied to every
+ *  block, thus small dense products: the row scans of a block
+ *  extended by its row carries times a 48 x 32 operator, then the
+ *  column scans of the result extended by the column carries times
+ *  a 32 x 48 operator (see calc_block_responses()).  With tensor
+ *  cores these products run in TF32 (Ampere and newer) or FP16
+ *  (Volta and newer) with single-precision accumulation, instead of
+ *  the scans of one warp in single precision, at the cost of operands
+ *  rounded to 10 bits of mantissa (about three decimal digits, see
+ *  scripts/run_tensor.sh for the error against alg0_cpu()).  Only
+ *  single-channel plans of single-precision carries, input and output
+ *  filtering both axes are supported.  It must be called after the
+ *  plan is prepared (and again if the plan is prepared again).
+ *
+ *  @param[in,out] plan The prepared plan
+ *  @param[in] precision Tensor precision (off to run the scans)
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float)
+ */
+template <int R, class TC>
+void prepare_tensor( alg5v6_plan<R,TC>& plan,
+                     TensorPrecision precision ) {
+
+    plan.tensor = TENSOR_OFF;
+    plan.graph.reset(); // the captured kernels change
+
+    if (precision == TENSOR_OFF) return;
+
+    if (sizeof(TC) != sizeof(float) || plan.channels != 1 || plan.half
+        || plan.out_format != PIXEL_FLOAT || plan.axes != BOTH_AXES)
+        throw std::runtime_error("Tensor cores need single-channel float plans filtering both axes");
+    if (2*R > TKP-WS)
+        throw std::runtime_error("Filter order too high for tensor cores");
+
+    int device, arch;
+    cudaDeviceProp prop;
+    cudaFuncAttributes attr;
+    cudaGetDevice(&device);
+    cudaGetDeviceProperties(&prop, device);
+    if (precision == TENSOR_TF32) {
+        arch = tensor_traits<TENSOR_TF32>::ARCH;
+        cudaFuncGetAttributes(&attr, alg5v6_tc_step1<false,R,TC,TENSOR_TF32>);
+    } else {
+        arch = tensor_traits<TENSOR_FP16>::ARCH;
+        cudaFuncGetAttributes(&attr, alg5v6_tc_step1<false,R,TC,TENSOR_FP16>);
+    }
+    check_cuda_error("Error querying tensor-core kernels");
+    if (prop.major*10+prop.minor < arch)
+        throw std::runtime_error("Device without tensor cores of this precision");
+    if (attr.ptxVersion < arch)
+        throw std::runtime_error("Tensor-core kernels not compiled for this architecture");
+
+    Matrix<double,WS+2*R,WS> A, A_cols;
+    Matrix<double,WS,R> Kp, Ke, Kp_cols, Ke_cols;
+    calc_block_responses(A, Kp, Ke, plan.w);
+    calc_block_responses(A_cols, Kp_cols, Ke_cols, plan.w_cols);
+
+    // operators of step 1 rows (32 x 48) and columns (16 x 32), and of
+    // step 4 or 5 rows (48 x 32) and columns (32 x 48), zero padded
+    std::vector<float> h_op(4*WS*TKP, 0.f);
+    float *s1_rows = &h_op[0], *s1_cols = s1_rows + WS*TKP,
+        *s5_rows = s1_cols + WS*TKP, *s5_cols = s5_rows + WS*TKP;
+    for (int j=0; j<WS; ++j) {
+        for (int k=0; k<WS; ++k) {
+            s1_rows[j*TKP+k] = (float)A[j][k];
+            s5_cols[k*TKP+j] = (float)A_cols[j][k];
+        }
+        for (int r=0; r<R; ++r) {
+            s1_rows[j*TKP+WS+r] = (float)Kp[j][r];
+            s1_rows[j*TKP+WS+R+r] = (float)Ke[j][r];
+            s1_cols[r*WS+j] = (float)Kp_cols[j][r];
+            s1_cols[(R+r)*WS+j] = (float)Ke_cols[j][r];
+        }
+    }
+    for (int j=0; j<WS+2*R; ++j)
+        for (int k=0; k<WS; ++k) {
+            s5_rows[j*WS+k] = (float)A[j][k];
+            if (j >= WS) s5_cols[k*TKP+j] = (float)A_cols[j][k];
+        }
+
+    if (precision == TENSOR_TF32) {
+        plan.d_tcmat = h_op;
+    } else {
+        std::vector<__half> h_op16(h_op.size());
+        for (size_t i=0; i<h_op.size(); ++i)
+            h_op16[i] = __float2half(h_op[i]);
+        plan.d_tcmat16 = h_op16;
+    }
+
+    plan.tensor = precision;
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Tensor precision chosen at run time
+ *
+ *  The precision of the block products on tensor cores of the
+ *  algorithm executables is given by the GPUFILTER_TENSOR environment
+ *  variable (tf32 or fp16), and they are off by default.
+ *
+ *  @return The tensor precision (off if not given)
+ */
+inline TensorPrecision tensor_precision() {
+    const char *t = getenv("GPUFILTER_TENSOR");
+    if (!t) return TENSOR_OFF;
+    if (std::string(t) == "tf32") return TENSOR_TF32;
+    if (std::string(t) == "fp16") return TENSOR_FP16;
+    return TENSOR_OFF;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 1 or algorithm 6 step 1 on tensor cores
+ *  @param[in,out] plan The plan to run (see prepare_tensor())
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float)
+ */
+template <bool BORDER, int R, class TC>
+void launch_alg5v6_tc_step1( alg5v6_plan<R,TC>& plan ) {
+
+    dim3 grid(plan.m_size, plan.n_size, plan.batch), block(WS, NWT);
+    linear_input in = make_linear_input(plan);
+
+    if (plan.tensor == TENSOR_TF32)
+        alg5v6_tc_step1<BORDER,R,TC,TENSOR_TF32><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck,
+              &plan.d_etvtilde, &plan.d_tcmat, &plan.d_tcmat + WS*TKP, plan.border,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size );
+    else
+        alg5v6_tc_step1<BORDER,R,TC,TENSOR_FP16><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck,
+              &plan.d_etvtilde, &plan.d_tcmat16, &plan.d_tcmat16 + WS*TKP, plan.border,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch algorithm 5 step 4 or algorithm 6 step 5 on tensor cores
+ *  @param[in,out] plan The plan to run (its output is written, see prepare_tensor())
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float)
+ */
+template <bool BORDER, int R, class TC>
+void launch_alg5v6_tc_step4v5( alg5v6_plan<R,TC>& plan ) {
+
+    dim3 grid = output_grid(plan), block(WS, NWT);
+    int out_size = plan.out_height*plan.stride_img;
+    linear_input in = make_linear_input(plan);
+
+    if (plan.tensor == TENSOR_TF32)
+        alg5v6_tc_step4v5<BORDER,R,TC,TENSOR_TF32><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, output_ptr(plan), &plan.d_pybar, &plan.d_ezhat,
+              &plan.d_ptucheck, &plan.d_etvtilde,
+              &plan.d_tcmat + 2*WS*TKP, &plan.d_tcmat + 3*WS*TKP, plan.border,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size,
+              plan.out_width, plan.out_height, plan.stride_img, out_size,
+              plan.out_x, plan.out_y );
+    else
+        alg5v6_tc_step4v5<BORDER,R,TC,TENSOR_FP16><<< grid, block, 0, plan.stream >>>
+            ( plan.tex_in, in, output_ptr(plan), &plan.d_pybar, &plan.d_ezhat,
+              &plan.d_ptucheck, &plan.d_etvtilde,
+              &plan.d_tcmat16 + 2*WS*TKP, &plan.d_tcmat16 + 3*WS*TKP, plan.border,
+              plan.inv_width, plan.inv_height, plan.m_size, plan.n_size,
+              plan.out_width, plan.out_height, plan.stride_img, out_size,
+              plan.out_x, plan.out_y );
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG5V6_TC_CUH
+//==============================================================================
@@ -6,8 +6,10 @@
  *  @copyright The MIT License
  */
 
-#define ORDER 1 // filter order is fixed
-#define APPNAME "[alg5varc]"
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg5varc_" << ORDER << "]"
 
 //== INCLUDES ==================================================================
 
@@ -36,27 +38,47 @@
 
 //== IMPLEMENTATION ============================================================
 
+/**
+ *  @brief Build a foveated sigma map growing away from the center
+ *  @param[out] sigma The sigma per position
+ *  @param[in] n The number of positions
+ *  @param[in] smin Sigma at the center
+ *  @param[in] smax Sigma at both ends
+ */
+void foveated_sigma( std::vector<float>& sigma,
+                     int n, float smin, float smax ) {
+    sigma.resize(n);
+    for (int i = 0; i < n; ++i)
+        sigma[i] = smin + (smax-smin)*std::abs(2.f*(i+.5f)/n - 1.f);
+}
+
 // Main ------------------------------------------------------------------------
 
 int main( int argc, char** argv ) {
 
-    assert(ORDER==1); // Currently supporting order 1 only!
-
     int width = 1024, height = 1024;
     int runtimes = 1; // # of run times (1 for debug; 1000 for performance)
     float me = 0.f, mre = 0.f; // maximum error and maximum relative error
     int border = 1;
+    float smin = 1.f, smax = 8.f; // foveated sigma (when not the B-spline)
+    bool spline = ORDER == 1; // cubic B-spline prefilter by default
 
-    if ((argc > 1 && argc < 5) ||
-        (argc==5 && (sscanf(argv[1], "%d", &width) != 1 ||
+    if ((argc > 1 && argc < 5) || argc == 6 || argc > 7 ||
+        (argc>=5 && (sscanf(argv[1], "%d", &width) != 1 ||
                      sscanf(argv[2], "%d", &height) != 1 ||
                      sscanf(argv[3], "%d", &runtimes) != 1 ||
-                     sscanf(argv[4], "%d", &border) != 1))) {
+                     sscanf(argv[4], "%d", &border) != 1)) ||
+        (argc==7 && (sscanf(argv[5], "%f", &smin) != 1 ||
+                     sscanf(argv[6], "%f", &smax) != 1 ||
+                     smin <= 0.f || smax <= 0.f))) {
         std::cerr << APPNAME << " Bad arguments!\n";
         std::cout << APPNAME << " Usage: " << argv[0]
-                  << " [width height runtimes border]\n";
+                  << " [width height runtimes border [sigma-min sigma-max]]\n";
+        std::cout << APPNAME << " Where: sigma-min and sigma-max give a foveated"
+                  << " Gaussian (from center to edges) instead of the B-spline\n";
         return 1;
     }
+    if (argc == 7) spline = false;
 
     std::vector< float > cpu_img(width*height), gpu_img(width*height);
 
@@ -64,23 +86,47 @@ int main( int argc, char** argv ) {
     for (int i = 0; i < width*height; ++i)
         gpu_img[i] = cpu_img[i] = rand() / (float)RAND_MAX;
 
-    gpufilter::Vector<float, ORDER+1> w;
-    w[0] = spline::w0;
-    w[1] = spline::w1;
+    std::vector< float > sigma_w, sigma_h;
+    if (!spline) {
+        foveated_sigma(sigma_w, width, smin, smax);
+        foveated_sigma(sigma_h, height, smin, smax);
+    }
 
     if (runtimes == 1) { // running for debugging
         std::cout << APPNAME << " Size: " << width << " x " << height
-                  << "  Order: 1  Run-times: 1\n";
-        std::cout << APPNAME << " Boundary: reflect  Border: " << border << "\n";
-        std::cout << APPNAME << " Weights: " << w << "\n";
+                  << "  Order: " << ORDER << "  Run-times: 1\n";
+        if (spline) {
+            std::cout << APPNAME << " Boundary: reflect  Border: " << border << "\n";
+            std::cout << APPNAME << " Weights: cubic B-spline\n";
+        } else {
+            std::cout << APPNAME << " Boundary: zero  Border: auto\n";
+            std::cout << APPNAME << " Weights: foveated Gaussian sigma "
+                      << smin << " to " << smax << "\n";
+        }
         std::cout << APPNAME << " (1) Runs the reference in the CPU (ref)\n";
         std::cout << APPNAME << " (2) Runs the algorithm in the GPU (res)\n";
         std::cout << APPNAME << " (3) Checks computations (ref x res)\n";
     }
 
-    gpufilter::nehab_hoppe_tr2011_recfilter(&cpu_img[0], width, height);
+    if (spline) {
+
+        gpufilter::nehab_hoppe_tr2011_recfilter(&cpu_img[0], width, height);
 
-    gpufilter::alg5varc_gpu<ORDER>(&gpu_img[0], width, height, runtimes, border);
+        gpufilter::alg5varc_gpu<ORDER>(&gpu_img[0], width, height, runtimes, border);
+
+    } else {
+
+        std::vector< gpufilter::Vector<float, ORDER+1> > aw(width), ah(height);
+        for (int i = 0; i < width; ++i) gpufilter::weights(sigma_w[i], aw[i]);
+        for (int i = 0; i < height; ++i) gpufilter::weights(sigma_h[i], ah[i]);
+
+        gpufilter::varc_recfilter<float, ORDER>(&cpu_img[0], width, height,
+                                                &aw[0], &aw[0], &ah[0], &ah[0]);
+
+        gpufilter::alg5varc_gpu<ORDER>(&gpu_img[0], width, height, runtimes,
+                                       &sigma_w[0], &sigma_h[0]);
+
+    }
 
     if (runtimes == 1) // running for debugging
         std::cout << APPNAME << " [max-error] [max-relative-error]:";
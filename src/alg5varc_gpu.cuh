@@ -9,11 +9,19 @@
 #ifndef ALG5VARC_GPU_CUH
 #define ALG5VARC_GPU_CUH
 
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <algorithm>
+
+#include "gpuplan.h"
+#include "vardefs.h"
+
 //== NAMESPACES ================================================================
 
 namespace gpufilter {
 
-// basics
+// feedforward weights of the middle blocks (forward and reverse)
 __constant__ float c_b0f, c_b0r;
 
 //== IMPLEMENTATION ============================================================
@@ -24,6 +32,7 @@ __constant__ float c_b0f, c_b0r;
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage1()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
@@ -32,19 +41,25 @@ __constant__ float c_b0f, c_b0r;
  *  @param[in] inv_height Image height inversed (1/h)
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
- *  @param[in] g_aw The feedback coefficients in width direction
- *  @param[in] g_ah The feedback coefficients in height direction
+ *  @param[in] g_awf The forward weights per column
+ *  @param[in] g_awr The reverse weights per column
+ *  @param[in] g_ahf The forward weights per row
+ *  @param[in] g_ahr The reverse weights per row
  *  @tparam R Filter order
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar, 
+void alg5varc_stage1_bor( cudaTextureObject_t tex,
+                          Matrix<float,R,WS> *g_pybar, 
                           Matrix<float,R,WS> *g_ezhat,
                           Matrix<float,R,WS> *g_ptucheck,
                           Matrix<float,R,WS> *g_etvtilde,
                           float inv_width, float inv_height,
                           int m_size, int n_size,
-                          const float *g_aw, const float *g_ah ) {
+                          const Vector<float,R+1> *g_awf,
+                          const Vector<float,R+1> *g_awr,
+                          const Vector<float,R+1> *g_ahf,
+                          const Vector<float,R+1> *g_ahr ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
 
@@ -52,14 +67,19 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
         (n >= c_border && n <= n_size-1-c_border)) // at the middle
         return;
 
+    __shared__ Vector<float,R+1> s_awf[WS], s_awr[WS], s_ahf[WS], s_ahr[WS];
+
+    if (ty==0) {
+        s_awf[tx] = g_awf[m*WS+tx];
+        s_awr[tx] = g_awr[m*WS+tx];
+        s_ahf[tx] = g_ahf[n*WS+tx];
+        s_ahr[tx] = g_ahr[n*WS+tx];
+    }
+
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWC>(block, m, n, inv_width, inv_height);
+    read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
-    __shared__ float s_aw[WS+1], s_ah[WS+1];
-    g_aw+=m*WS+tx+1;
-    g_ah+=n*WS+tx+1;
-
     float x[32]; // 32 regs
 
     if (ty==0) {
@@ -68,14 +88,11 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
         for (int i=0; i<32; ++i)
             x[i] = block[tx][i];
 
-        s_aw[tx+1] = __ldg(g_aw);
-        s_ah[tx+1] = __ldg(g_ah);
-
         Vector<float,R> p = zeros<float,R>();
 
 #pragma unroll // calculate pybar, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, s_aw+j);
+            x[j] = fwd(p, x[j], s_awf+j);
 
         g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
 
@@ -83,7 +100,7 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ezhat, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = rev(x[j], e, c_b0r, s_aw+j+1);
+            x[j] = rev(x[j], e, s_awr+j);
 
         g_ezhat[n*(m_size+1)+m].set_col(tx, e);
 
@@ -98,7 +115,7 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ptucheck, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, s_ah+j);
+            x[j] = fwd(p, x[j], s_ahf+j);
 
         g_ptucheck[m*(n_size+1)+n+1].set_col(tx, p);
 
@@ -106,7 +123,7 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate etvtilde, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            rev(x[j], e, c_b0r, s_ah+j+1);
+            rev(x[j], e, s_ahr+j);
 
         g_etvtilde[m*(n_size+1)+n].set_col(tx, e);
 
@@ -120,6 +137,7 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage1()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
@@ -132,7 +150,8 @@ void alg5varc_stage1_bor( Matrix<float,R,WS> *g_pybar,
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
+void alg5varc_stage1_mid( cudaTextureObject_t tex,
+                          Matrix<float,R,WS> *g_pybar,
                           Matrix<float,R,WS> *g_ezhat,
                           Matrix<float,R,WS> *g_ptucheck,
                           Matrix<float,R,WS> *g_etvtilde,
@@ -146,7 +165,7 @@ void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
         return;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWC>(block, m, n, inv_width, inv_height);
+    read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32]; // 32 regs
@@ -161,7 +180,7 @@ void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate pybar, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, &c_weights[1]);
+            x[j] = fwd(p, c_b0f*x[j], consts<R>().weights);
 
         g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
         
@@ -169,7 +188,7 @@ void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ezhat, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = rev(x[j], e, c_b0r, &c_weights[1]);
+            x[j] = rev(c_b0r*x[j], e, consts<R>().weights);
 
         g_ezhat[n*(m_size+1)+m].set_col(tx, e);
 
@@ -184,7 +203,7 @@ void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ptucheck, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, &c_weights[1]);
+            x[j] = fwd(p, c_b0f*x[j], consts<R>().weights);
 
         g_ptucheck[m*(n_size+1)+n+1].set_col(tx, p);
 
@@ -192,7 +211,7 @@ void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate etvtilde, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            rev(x[j], e, c_b0r, &c_weights[1]);
+            rev(c_b0r*x[j], e, consts<R>().weights);
 
         g_etvtilde[m*(n_size+1)+n].set_col(tx, e);
 
@@ -202,7 +221,11 @@ void alg5varc_stage1_mid( Matrix<float,R,WS> *g_pybar,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 5 varying coefficients stage 2 for border blocks
+ *  @brief Algorithm 5 varying coefficients stage 2 with matrices per block
+ *
+ *  The carries cross all blocks along each row (or column) of blocks,
+ *  hence a single border block varying makes this run for all of them.
+ *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage2()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
@@ -226,9 +249,6 @@ void alg5varc_stage2_bor( Matrix<float,R,WS> *g_pybar,
 
     int tx = threadIdx.x, ty = threadIdx.y, m, n = blockIdx.y;
 
-    if (n >= c_border && n <= n_size-1-c_border) // at the middle
-        return;
-
     Matrix<float,R,WS> *gpybar, *gezhat;
     Vector<float,R> py, ez, pybar, ezhat;
     __shared__ Matrix<float,R,WS> spybar[NWA], sezhat[NWA];
@@ -307,7 +327,7 @@ void alg5varc_stage2_bor( Matrix<float,R,WS> *g_pybar,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 5 varying coefficients stage 2 for middle blocks
+ *  @brief Algorithm 5 varying coefficients stage 2 for constant matrices
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage2()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
@@ -349,7 +369,7 @@ void alg5varc_stage2_mid( Matrix<float,R,WS> *g_pybar,
 
                 pybar = spybar[w].col(tx);
 
-                py = pybar + py * c_AbF_T;
+                py = pybar + py * consts<R>().AbF_T;
 
                 spybar[w].set_col(tx, py);
 
@@ -386,7 +406,7 @@ void alg5varc_stage2_mid( Matrix<float,R,WS> *g_pybar,
                 ezhat = sezhat[w].col(tx);
                 py = spybar[w].col(tx);
 
-                ez = ezhat + py * c_HARB_AFP_T + ez * c_AbR_T;
+                ez = ezhat + py * consts<R>().HARB_AFP_T + ez * consts<R>().AbR_T;
 
                 sezhat[w].set_col(tx, ez);
 
@@ -406,7 +426,11 @@ void alg5varc_stage2_mid( Matrix<float,R,WS> *g_pybar,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 5 varying coefficients stage 3 for border blocks
+ *  @brief Algorithm 5 varying coefficients stage 3 with matrices per block
+ *
+ *  The carries cross all blocks along each row (or column) of blocks,
+ *  hence a single border block varying makes this run for all of them.
+ *
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage3()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
@@ -442,9 +466,6 @@ void alg5varc_stage3_bor( Matrix<float,R,WS> *g_ptucheck,
 
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n;
 
-    if (m >= c_border && m <= m_size-1-c_border) // at the middle
-        return;
-
     Matrix<float,R,WS> *gptucheck, *getvtilde;
     Vector<float,R> ptu, etv, ptucheck, etvtilde;
     Matrix<float,R,WS> *gpy, *gez;
@@ -550,7 +571,7 @@ void alg5varc_stage3_bor( Matrix<float,R,WS> *g_ptucheck,
 
 /**
  *  @ingroup gpu
- *  @brief Algorithm 5 varying coefficients stage 3 for middle blocks
+ *  @brief Algorithm 5 varying coefficients stage 3 for constant matrices
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage3()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
@@ -606,10 +627,10 @@ void alg5varc_stage3_mid( Matrix<float,R,WS> *g_ptucheck,
                 py = spy[w].col(tx);
                 ez = sez[w].col(tx);
 
-                ptu = ptucheck + ptu * c_AbF_T;
+                ptu = ptucheck + ptu * consts<R>().AbF_T;
 
-                fixpet(ptu, c_TAFB, c_ARE_T, ez);
-                fixpet(ptu, c_TAFB, c_ARB_AFP_T, py);
+                fixpet(ptu, consts<R>().TAFB, consts<R>().ARE_T, ez);
+                fixpet(ptu, consts<R>().TAFB, consts<R>().ARB_AFP_T, py);
 
                 sptucheck[w].set_col(tx, ptu);
 
@@ -652,10 +673,10 @@ void alg5varc_stage3_mid( Matrix<float,R,WS> *g_ptucheck,
                 py = spy[w].col(tx);
                 ez = sez[w].col(tx);
 
-                etv = etvtilde + etv * c_AbR_T + ptu * c_HARB_AFP_T;
+                etv = etvtilde + etv * consts<R>().AbR_T + ptu * consts<R>().HARB_AFP_T;
 
-                fixpet(etv, c_HARB_AFB, c_ARE_T, ez);
-                fixpet(etv, c_HARB_AFB, c_ARB_AFP_T, py);
+                fixpet(etv, consts<R>().HARB_AFB, consts<R>().ARE_T, ez);
+                fixpet(etv, consts<R>().HARB_AFB, consts<R>().ARB_AFP_T, py);
 
                 setvtilde[w].set_col(tx, etv);
 
@@ -679,6 +700,7 @@ void alg5varc_stage3_mid( Matrix<float,R,WS> *g_ptucheck,
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage4()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ezhat All \f$E_{m,n}(Z)\f$
@@ -689,13 +711,16 @@ void alg5varc_stage3_mid( Matrix<float,R,WS> *g_ptucheck,
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
  *  @param[in] out_stride Image output stride for memory width alignment
- *  @param[in] g_aw The feedback coefficients in width direction
- *  @param[in] g_ah The feedback coefficients in height direction
+ *  @param[in] g_awf The forward weights per column
+ *  @param[in] g_awr The reverse weights per column
+ *  @param[in] g_ahf The forward weights per row
+ *  @param[in] g_ahr The reverse weights per row
  *  @tparam R Filter order
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg5varc_stage4_bor( float *g_out,
+void alg5varc_stage4_bor( cudaTextureObject_t tex,
+                          float *g_out,
                           const Matrix<float,R,WS> *g_py,
                           const Matrix<float,R,WS> *g_ez,
                           const Matrix<float,R,WS> *g_ptu,
@@ -703,7 +728,10 @@ void alg5varc_stage4_bor( float *g_out,
                           float inv_width, float inv_height,
                           int m_size, int n_size,
                           int out_stride,
-                          const float *g_aw, const float *g_ah ) {
+                          const Vector<float,R+1> *g_awf,
+                          const Vector<float,R+1> *g_awr,
+                          const Vector<float,R+1> *g_ahf,
+                          const Vector<float,R+1> *g_ahr ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
 
@@ -711,10 +739,17 @@ void alg5varc_stage4_bor( float *g_out,
         (n >= c_border && n <= n_size-1-c_border)) // at the middle
         return;
 
-    __shared__ float s_aw[WS+1], s_ah[WS+1];
+    __shared__ Vector<float,R+1> s_awf[WS], s_awr[WS], s_ahf[WS], s_ahr[WS];
+
+    if (ty==0) {
+        s_awf[tx] = g_awf[m*WS+tx];
+        s_awr[tx] = g_awr[m*WS+tx];
+        s_ahf[tx] = g_ahf[n*WS+tx];
+        s_ahr[tx] = g_ahr[n*WS+tx];
+    }
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWW>(block, m, n, inv_width, inv_height);
+    read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32];
@@ -725,14 +760,6 @@ void alg5varc_stage4_bor( float *g_out,
         for (int i=0; i<32; ++i)
             x[i] = block[tx][i];
 
-        g_aw+=m*WS; g_ah+=n*WS;
-        if (tx==0) s_aw[0]=*g_aw;
-        if (tx==1) s_ah[0]=*g_ah;
-        g_aw+=tx+1; g_ah+=tx+1;
-
-        s_aw[tx+1] = __ldg(g_aw);
-        s_ah[tx+1] = __ldg(g_ah);
-
         Vector<float,R> p, e;
 
         for (int r=0; r<R; ++r)
@@ -740,14 +767,14 @@ void alg5varc_stage4_bor( float *g_out,
 
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, s_aw+j);
+            x[j] = fwd(p, x[j], s_awf+j);
 
         for (int r=0; r<R; ++r)
             e[r] = __ldg((const float *)&g_ez[n*(m_size+1)+m+1][r][tx]);
 
 #pragma unroll // calculate block, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = rev(x[j], e, c_b0r, s_aw+j+1);
+            x[j] = rev(x[j], e, s_awr+j);
 
 #pragma unroll // tranpose regs part-1
         for (int i=0; i<32; ++i)
@@ -761,14 +788,14 @@ void alg5varc_stage4_bor( float *g_out,
 
 #pragma unroll // calculate block, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, s_ah+j);
+            x[j] = fwd(p, x[j], s_ahf+j);
 
         for (int r=0; r<R; ++r)
             e[r] = __ldg((float *)&g_etv[m*(n_size+1)+n+1][r][tx]);
 
 #pragma unroll // calculate block, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            x[j] = rev(x[j], e, c_b0r, s_ah+j+1);
+            x[j] = rev(x[j], e, s_ahr+j);
 
         g_out += ((n+1)*WS-1)*out_stride + m*WS+tx;
 #pragma unroll // write block
@@ -785,6 +812,7 @@ void alg5varc_stage4_bor( float *g_out,
  *  @note This follows the improved base-line implementation in [NehabMaximo:2016]
  *  @see alg5_stage4()
  *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ezhat All \f$E_{m,n}(Z)\f$
@@ -799,7 +827,8 @@ void alg5varc_stage4_bor( float *g_out,
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg5varc_stage4_mid( float *g_out,
+void alg5varc_stage4_mid( cudaTextureObject_t tex,
+                          float *g_out,
                           const Matrix<float,R,WS> *g_py,
                           const Matrix<float,R,WS> *g_ez,
                           const Matrix<float,R,WS> *g_ptu,
@@ -815,7 +844,7 @@ void alg5varc_stage4_mid( float *g_out,
         return;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWW>(block, m, n, inv_width, inv_height);
+    read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32]; // 32 regs
@@ -833,14 +862,14 @@ void alg5varc_stage4_mid( float *g_out,
 
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, &c_weights[1]);
+            x[j] = fwd(p, c_b0f*x[j], consts<R>().weights);
 
         for (int r=0; r<R; ++r)
             e[r] = __ldg((const float *)&g_ez[n*(m_size+1)+m+1][r][tx]);
 
 #pragma unroll // calculate block, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = rev(x[j], e, c_b0r, &c_weights[1]);
+            x[j] = rev(c_b0r*x[j], e, consts<R>().weights);
 
 #pragma unroll // tranpose regs part-1
         for (int i=0; i<32; ++i)
@@ -854,14 +883,14 @@ void alg5varc_stage4_mid( float *g_out,
 
 #pragma unroll // calculate block, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwd(p, x[j], c_b0f, &c_weights[1]);
+            x[j] = fwd(p, c_b0f*x[j], consts<R>().weights);
 
         for (int r=0; r<R; ++r)
             e[r] = __ldg((float *)&g_etv[m*(n_size+1)+n+1][r][tx]);
 
 #pragma unroll // calculate block, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            x[j] = rev(x[j], e, c_b0r, &c_weights[1]);
+            x[j] = rev(c_b0r*x[j], e, consts<R>().weights);
 
         g_out += ((n+1)*WS-1)*out_stride + m*WS+tx;
 #pragma unroll // write block
@@ -873,210 +902,677 @@ void alg5varc_stage4_mid( float *g_out,
 }
 
 /**
- *  @ingroup api_gpu
- *  @brief Compute algorithm 5 with varying coefficients in the GPU
- *  @see alg5_gpu()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
- *  @param[in] width Image width
- *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
- *  @param[in] border Number of border blocks (32x32) outside image
+ *  @ingroup gpu
+ *  @brief Compute the basic matrices of one block given varying weights
+ *
+ *  One warp filters unit impulses through the block to get the block
+ *  forward and reverse matrices \f$A_{FB}^T\f$ and \f$A_{RB}^T\f$
+ *  (one row per thread), and unit prologues and epilogues to get
+ *  \f$A_{FP}^T\f$ and \f$A_{RE}^T\f$ (one row per each of the first
+ *  \f$R\f$ threads), in shared memory.
+ *
+ *  @param[out] s_AFB_T Block forward matrix \f$A_{FB}^T\f$
+ *  @param[out] s_ARB_T Block reverse matrix \f$A_{RB}^T\f$
+ *  @param[out] s_AFP_T Prologue matrix \f$A_{FP}^T\f$
+ *  @param[out] s_ARE_T Epilogue matrix \f$A_{RE}^T\f$
+ *  @param[in] g_wf The forward weights per position
+ *  @param[in] g_wr The reverse weights per position
+ *  @param[in] b The block index
  *  @tparam R Filter order
  */
 template <int R>
-void alg5varc_gpu( float *h_img,
-                   int width, int height, int runtimes,
-                   int border=1 ) {
-    if (R!=1) return;
-    const int B = WS;
-    const int m_size = (width+B-1)/B, n_size = (height+B-1)/B;
-
-    float *aw=0, *ah=0;
-    if (!build_coefficients(aw, width)) { std::cerr << "Error building variable coefficients!\n"; return; }
-    if (!build_coefficients(ah, height)) { std::cerr << "Error building variable coefficients!\n"; return; }
-
-    Vector<float, R+1> w;
-    w[0] = 0.f; // will not be used
-    w[1] = spline::linf;
-
-    // pre-compute basic alg5 matrices
-    Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
-
-    // matrices in fwd/rev different than fwdT/revT
-    std::vector< Matrix<float,R,B> > AFP_T(m_size), ARE_T(m_size);
-    std::vector< Matrix<float,R,R> > AbF_T(m_size), AbR_T(m_size);
-    std::vector< Matrix<float,B,B> > AFB_T(m_size), ARB_T(m_size);
-    std::vector< Matrix<float,R,R> > HARB_AFP_T(m_size);
-    std::vector< Matrix<float,R,B> > ARB_AFP_T(m_size);
-    for (int m=0; m<m_size; ++m) {
-        AFP_T[m] = fwd(Ir, Zrb, b0f, aw+m*B);
-        AbF_T[m] = tail<R>(AFP_T[m]);
-        ARE_T[m] = rev(Zrb, Ir, b0r, aw+1+m*B);
-        AbR_T[m] = head<R>(ARE_T[m]);
-        AFB_T[m] = fwd(Zbr, Ib, b0f, aw+m*B);
-        ARB_T[m] = rev(Ib, Zbr, b0r, aw+1+m*B);
-        HARB_AFP_T[m] = AFP_T[m]*head<R>(ARB_T[m]);
-        ARB_AFP_T[m] = AFP_T[m]*ARB_T[m];
+__device__
+void varc_block_matrices( Matrix<float,WS,WS+1>& s_AFB_T,
+                          Matrix<float,WS,WS+1>& s_ARB_T,
+                          Matrix<float,R,WS>& s_AFP_T,
+                          Matrix<float,R,WS>& s_ARE_T,
+                          const Vector<float,R+1> *g_wf,
+                          const Vector<float,R+1> *g_wr,
+                          int b ) {
+
+    __shared__ Vector<float,R+1> s_wf[WS], s_wr[WS];
+
+    int tx = threadIdx.x;
+
+    s_wf[tx] = g_wf[b*WS+tx];
+    s_wr[tx] = g_wr[b*WS+tx];
+
+    __syncthreads();
+
+    Vector<float,R> p = zeros<float,R>(), e = zeros<float,R>();
+
+    for (int j=0; j<WS; ++j) // impulse at tx, scan left -> right
+        s_AFB_T[tx][j] = fwd(p, j==tx ? 1.f : 0.f, s_wf+j);
+
+    for (int j=WS-1; j>=0; --j) // impulse at tx, scan right -> left
+        s_ARB_T[tx][j] = rev(j==tx ? 1.f : 0.f, e, s_wr+j);
+
+    if (tx < R) {
+
+        p = zeros<float,R>();
+        p[tx] = 1.f;
+        for (int j=0; j<WS; ++j) // unit prologue, scan left -> right
+            s_AFP_T[tx][j] = fwd(p, 0.f, s_wf+j);
+
+        e = zeros<float,R>();
+        e[tx] = 1.f;
+        for (int j=WS-1; j>=0; --j) // unit epilogue, scan right -> left
+            s_ARE_T[tx][j] = rev(0.f, e, s_wr+j);
+
     }
 
-    std::vector< Matrix<float,B,R> > AFP(n_size), ARE(n_size);
-    std::vector< Matrix<float,R,R> > AbF(n_size), AbR(n_size);
-    std::vector< Matrix<float,B,B> > AFB(n_size), ARB(n_size);
-    std::vector< Matrix<float,R,R> > HARB_AFP(n_size);
-    std::vector< Matrix<float,R,B> > TAFB(n_size), HARB_AFB(n_size);
-    for (int n=0; n<n_size; ++n) {
-        AFP[n] = fwdT(Ir, Zbr, b0f, ah+n*B);
-        AbF[n] = tailT<R>(AFP[n]);
-        ARE[n] = revT(Zbr, Ir, b0r, ah+1+n*B);
-        AbR[n] = headT<R>(ARE[n]);
-        AFB[n] = fwdT(Zrb, Ib, b0f, ah+n*B);
-        ARB[n] = revT(Ib, Zrb, b0r, ah+1+n*B);
-        HARB_AFP[n] = headT<R>(ARB[n])*AFP[n];
-        TAFB[n] = tailT<R>(AFB[n]);
-        HARB_AFB[n] = headT<R>(ARB[n])*AFB[n];
+    __syncthreads();
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Compute the row matrices per block given varying weights
+ *  @see prepare_alg5varc()
+ *  @param[out] g_AbF_T All \f$A_{bF}^T\f$ per block
+ *  @param[out] g_AbR_T All \f$A_{bR}^T\f$ per block
+ *  @param[out] g_HARB_AFP_T All \f$H(A_{RB}^T) A_{FP}^T\f$ per block
+ *  @param[out] g_ARE_T All \f$A_{RE}^T\f$ per block
+ *  @param[out] g_ARB_AFP_T All \f$A_{RB}^T A_{FP}^T\f$ per block
+ *  @param[in] g_awf The forward weights per column
+ *  @param[in] g_awr The reverse weights per column
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS, 1)
+void alg5varc_row_matrices( Matrix<float,R,R> *g_AbF_T,
+                            Matrix<float,R,R> *g_AbR_T,
+                            Matrix<float,R,R> *g_HARB_AFP_T,
+                            Matrix<float,R,WS> *g_ARE_T,
+                            Matrix<float,R,WS> *g_ARB_AFP_T,
+                            const Vector<float,R+1> *g_awf,
+                            const Vector<float,R+1> *g_awr ) {
+
+    int tx = threadIdx.x, m = blockIdx.x;
+
+    __shared__ Matrix<float,WS,WS+1> s_AFB_T, s_ARB_T;
+    __shared__ Matrix<float,R,WS> s_AFP_T, s_ARE_T;
+
+    varc_block_matrices(s_AFB_T, s_ARB_T, s_AFP_T, s_ARE_T, g_awf, g_awr, m);
+
+#pragma unroll
+    for (int r=0; r<R; ++r) {
+        float v = 0.f;
+        for (int k=0; k<WS; ++k) // column tx of AFP_T * ARB_T
+            v += s_AFP_T[r][k] * s_ARB_T[k][tx];
+        g_ARB_AFP_T[m][r][tx] = v;
+        g_ARE_T[m][r][tx] = s_ARE_T[r][tx];
+        if (tx < R) {
+            g_AbF_T[m][r][tx] = s_AFP_T[r][WS-R+tx];
+            g_AbR_T[m][r][tx] = s_ARE_T[r][tx];
+            g_HARB_AFP_T[m][r][tx] = v;
+        }
     }
 
-    float inv_width = 1.f/width, inv_height = 1.f/height;
+}
 
-    // upload to the GPU
-    copy_to_symbol(c_b0f, b0f);
-    copy_to_symbol(c_b0r, b0r);
+/**
+ *  @ingroup gpu
+ *  @brief Compute the column matrices per block given varying weights
+ *  @see prepare_alg5varc()
+ *  @param[out] g_AbF All \f$A_{bF}\f$ per block
+ *  @param[out] g_AbR All \f$A_{bR}\f$ per block
+ *  @param[out] g_HARB_AFP All \f$H(A_{RB}) A_{FP}\f$ per block
+ *  @param[out] g_TAFB All \f$T(A_{FB})\f$ per block
+ *  @param[out] g_HARB_AFB All \f$H(A_{RB}) A_{FB}\f$ per block
+ *  @param[in] g_ahf The forward weights per row
+ *  @param[in] g_ahr The reverse weights per row
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS, 1)
+void alg5varc_col_matrices( Matrix<float,R,R> *g_AbF,
+                            Matrix<float,R,R> *g_AbR,
+                            Matrix<float,R,R> *g_HARB_AFP,
+                            Matrix<float,R,WS> *g_TAFB,
+                            Matrix<float,R,WS> *g_HARB_AFB,
+                            const Vector<float,R+1> *g_ahf,
+                            const Vector<float,R+1> *g_ahr ) {
 
-    copy_to_symbol(c_border, border);
+    int tx = threadIdx.x, n = blockIdx.x;
 
-    copy_to_symbol(c_weights, w);
+    __shared__ Matrix<float,WS,WS+1> s_AFB_T, s_ARB_T;
+    __shared__ Matrix<float,R,WS> s_AFP_T, s_ARE_T;
 
-    copy_to_symbol(c_AbF_T, AbF_T[border+1]);
-    copy_to_symbol(c_AbR_T, AbR_T[border+1]);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T[border+1]);
+    varc_block_matrices(s_AFB_T, s_ARB_T, s_AFP_T, s_ARE_T, g_ahf, g_ahr, n);
 
-    copy_to_symbol(c_ARE_T, ARE_T[border+1]);
-    copy_to_symbol(c_ARB_AFP_T, ARB_AFP_T[border+1]);
-    copy_to_symbol(c_TAFB, TAFB[border+1]);
-    copy_to_symbol(c_HARB_AFB, HARB_AFB[border+1]);
+    // column matrices are the transposed of the row ones on row weights
+#pragma unroll
+    for (int r=0; r<R; ++r) {
+        float v = 0.f;
+        for (int k=0; k<WS; ++k) // row tx of AFB_T * head(ARB_T)
+            v += s_AFB_T[tx][k] * s_ARB_T[k][r];
+        g_HARB_AFB[n][r][tx] = v;
+        g_TAFB[n][r][tx] = s_AFB_T[tx][WS-R+r];
+        if (tx < R) {
+            float h = 0.f;
+            for (int k=0; k<WS; ++k) // row tx of AFP_T * head(ARB_T)
+                h += s_AFP_T[tx][k] * s_ARB_T[k][r];
+            g_AbF[n][r][tx] = s_AFP_T[tx][WS-R+r];
+            g_AbR[n][r][tx] = s_ARE_T[tx][r];
+            g_HARB_AFP[n][r][tx] = h;
+        }
+    }
 
-    dvector<float> d_aw(aw, width+1), d_ah(ah, height+1);
+}
 
-    dvector< Matrix<float,R,R> > d_AbF_T(AbF_T), d_AbR_T(AbR_T),
-        d_HARB_AFP_T(HARB_AFP_T), d_AbF(AbF), d_AbR(AbR), d_HARB_AFP(HARB_AFP);
+/**
+ *  @struct alg5varc_plan alg5varc_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of algorithm 5 with varying coefficients
+ *
+ *  The weights vary per column (in the row pass) and per row (in the
+ *  column pass), each position with its own forward and reverse
+ *  weights.  The basic matrices of this plan are the ones of the
+ *  middle blocks (stored in constant memory), where the weights are
+ *  constant, while the matrices of the border blocks vary per block
+ *  and are stored in global memory.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg5varc_plan : public alg_plan {
+    Vector<float,R+1> w; ///< Forward weights of the middle blocks (only to fill the constant)
+    float b0r; ///< Reverse feedforward weight of the middle blocks
+    alg_matrices<R> mat; ///< Pre-computed matrices of the middle blocks
+    dvector< Vector<float,R+1> > d_awf, d_awr; ///< Forward and reverse weights per column
+    dvector< Vector<float,R+1> > d_ahf, d_ahr; ///< Forward and reverse weights per row
+    dvector< Matrix<float,R,R> > d_AbF_T, d_AbR_T, d_HARB_AFP_T; ///< Row matrices per block
+    dvector< Matrix<float,R,R> > d_AbF, d_AbR, d_HARB_AFP; ///< Column matrices per block
+    dvector< Matrix<float,R,WS> > d_TAFB, d_ARE_T, d_ARB_AFP_T, d_HARB_AFB; ///< Carry fixing matrices per block
+    dvector< Matrix<float,R,WS> > d_pybar, d_ezhat; ///< Row carries
+    dvector< Matrix<float,R,WS> > d_ptucheck, d_etvtilde; ///< Column carries
+    cudaStream_t stream1, stream2; ///< Streams for border and middle blocks
+
+    /// Default constructor
+    alg5varc_plan() : b0r(0.f), stream1(0), stream2(0) { }
+
+    /// Destructor
+    ~alg5varc_plan() {
+        if (stream1) cudaStreamDestroy(stream1);
+        if (stream2) cudaStreamDestroy(stream2);
+    }
+};
 
-    dvector< Matrix<float,R,B> > d_TAFB(TAFB), d_ARE_T(ARE_T),
-        d_ARB_AFP_T(ARB_AFP_T), d_HARB_AFB(HARB_AFB);
+/**
+ *  @ingroup api_gpu
+ *  @brief Check if two weights are the same
+ *  @param[in] a First weights
+ *  @param[in] b Second weights
+ *  @param[in] first Index of the first weight to compare (1 to skip the feedforward)
+ *  @return True if the weights are the same
+ *  @tparam R Filter order
+ */
+template <int R>
+bool same_weights( const Vector<float,R+1>& a,
+                   const Vector<float,R+1>& b,
+                   int first=0 ) {
+    for (int k = first; k <= R; ++k)
+        if (a[k] != b[k]) return false;
+    return true;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the number of border blocks of varying weights
+ *
+ *  The border is the smallest number of blocks at each end such that
+ *  all the blocks in the middle have the given constant weights.
+ *
+ *  @param[in] wf The forward weights per position (blocks*WS)
+ *  @param[in] wr The reverse weights per position (blocks*WS)
+ *  @param[in] blocks The number of blocks
+ *  @param[in] cf The constant forward weights of the middle blocks
+ *  @param[in] cr The constant reverse weights of the middle blocks
+ *  @return The number of border blocks
+ *  @tparam R Filter order
+ */
+template <int R>
+int varying_border( const Vector<float,R+1> *wf,
+                    const Vector<float,R+1> *wr,
+                    int blocks,
+                    const Vector<float,R+1>& cf,
+                    const Vector<float,R+1>& cr ) {
+    int border = 0;
+    for (int b = 0; b < blocks; ++b) {
+        bool uniform = true;
+        for (int i = b*WS; i < (b+1)*WS && uniform; ++i)
+            uniform = same_weights<R>(wf[i], cf) && same_weights<R>(wr[i], cr);
+        if (!uniform) border = std::max(border, std::min(b, blocks-1-b)+1);
+    }
+    return border;
+}
 
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the matrices per block of algorithm 5 with varying weights
+ *
+ *  The matrices are computed in the GPU directly from the weights in
+ *  the plan (one block of threads per block of the image), hence the
+ *  weights can change on every run without host computations.  The
+ *  matrices of the middle blocks (if any) are then downloaded to the
+ *  plan to go to constant memory.
+ *
+ *  @param[in,out] plan The plan with weights to compute the matrices of
+ *  @tparam R Filter order
+ */
+template <int R>
+void compute_alg5varc_matrices( alg5varc_plan<R>& plan ) {
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+
+    plan.d_AbF_T.resize(m_size);
+    plan.d_AbR_T.resize(m_size);
+    plan.d_HARB_AFP_T.resize(m_size);
+    plan.d_ARE_T.resize(m_size);
+    plan.d_ARB_AFP_T.resize(m_size);
+
+    plan.d_AbF.resize(n_size);
+    plan.d_AbR.resize(n_size);
+    plan.d_HARB_AFP.resize(n_size);
+    plan.d_TAFB.resize(n_size);
+    plan.d_HARB_AFB.resize(n_size);
+
+    alg5varc_row_matrices<<< m_size, WS, 0, plan.stream >>>
+        ( &plan.d_AbF_T, &plan.d_AbR_T, &plan.d_HARB_AFP_T, &plan.d_ARE_T,
+          &plan.d_ARB_AFP_T, &plan.d_awf, &plan.d_awr );
+    alg5varc_col_matrices<<< n_size, WS, 0, plan.stream >>>
+        ( &plan.d_AbF, &plan.d_AbR, &plan.d_HARB_AFP, &plan.d_TAFB,
+          &plan.d_HARB_AFB, &plan.d_ahf, &plan.d_ahr );
+
+    check_cuda_error("Error computing varying coefficients matrices");
+
+    if (2*plan.border < m_size && 2*plan.border < n_size) { // middle blocks
+        const int mb = plan.border, nb = plan.border; // each [] downloads
+        plan.w = plan.d_awf[mb*WS];
+        plan.b0r = plan.d_awr[mb*WS][0];
+        plan.mat.AbF_T = plan.d_AbF_T[mb];
+        plan.mat.AbR_T = plan.d_AbR_T[mb];
+        plan.mat.HARB_AFP_T = plan.d_HARB_AFP_T[mb];
+        plan.mat.ARE_T = plan.d_ARE_T[mb];
+        plan.mat.ARB_AFP_T = plan.d_ARB_AFP_T[mb];
+        plan.mat.TAFB = plan.d_TAFB[nb];
+        plan.mat.HARB_AFB = plan.d_HARB_AFB[nb];
+    }
+
+    current_plan_id() = -1; // constants changed, upload them again
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 5 with varying weights plan in the GPU
+ *
+ *  The weights per column and per row are given in host memory (at
+ *  least width and height of them).  Weights past the image are
+ *  zero, stopping the filter exactly at the image edges.  A negative
+ *  border finds the smallest one keeping the middle blocks constant
+ *  (see varying_border()), all blocks varying if the middle rows and
+ *  columns do not share the same weights.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] awf Forward weights per column
+ *  @param[in] awr Reverse weights per column
+ *  @param[in] ahf Forward weights per row
+ *  @param[in] ahr Reverse weights per row
+ *  @param[in] border Number of border blocks (32x32) of varying weights
+ *  @return True if the plan was prepared
+ *  @tparam R Filter order
+ */
+template <int R>
+bool prepare_alg5varc( alg5varc_plan<R>& plan,
+                       int width, int height,
+                       const Vector<float,R+1> *awf,
+                       const Vector<float,R+1> *awr,
+                       const Vector<float,R+1> *ahf,
+                       const Vector<float,R+1> *ahr,
+                       int border=-1 ) {
+    const int B = WS;
 
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
+    prepare_plan(plan, width, height, 0, CLAMP_TO_ZERO, false);
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+
+    std::vector< Vector<float,R+1> > wf(m_size*B, zeros<float,R+1>()), wr(wf),
+        hf(n_size*B, zeros<float,R+1>()), hr(hf);
+    std::copy(awf, awf+width, wf.begin());
+    std::copy(awr, awr+width, wr.begin());
+    std::copy(ahf, ahf+height, hf.begin());
+    std::copy(ahr, ahr+height, hr.begin());
+
+    const int mc = m_size/2, nc = n_size/2; // center blocks
+    if (border < 0) {
+        if (same_weights<R>(wf[mc*B], wr[mc*B], 1) &&
+            same_weights<R>(wf[mc*B], hf[nc*B]) &&
+            same_weights<R>(wr[mc*B], hr[nc*B]))
+            border = std::max(varying_border<R>(&wf[0], &wr[0], m_size, wf[mc*B], wr[mc*B]),
+                              varying_border<R>(&hf[0], &hr[0], n_size, wf[mc*B], wr[mc*B]));
+        else
+            border = std::max(m_size, n_size);
+    }
+    plan.border = border;
 
-    int stride_img = width+WS;
+    plan.d_awf = wf;
+    plan.d_awr = wr;
+    plan.d_ahf = hf;
+    plan.d_ahr = hr;
 
-    dvector<float> d_img(height*stride_img);
+    compute_alg5varc_matrices(plan);
 
     // +1 padding is important even in zero-border to avoid if's in kernels
-    dvector< Matrix<float,R,B> > d_pybar((m_size+1)*n_size), d_ezhat((m_size+1)*n_size);
-    dvector< Matrix<float,R,B> > d_ptucheck((n_size+1)*m_size), d_etvtilde((n_size+1)*m_size);
+    plan.d_pybar.resize((m_size+1)*n_size);
+    plan.d_ezhat.resize((m_size+1)*n_size);
+    plan.d_ptucheck.resize((n_size+1)*m_size);
+    plan.d_etvtilde.resize((n_size+1)*m_size);
 
-    d_pybar.fillzero();
-    d_ezhat.fillzero();
-    d_ptucheck.fillzero();
-    d_etvtilde.fillzero();
+    plan.d_pybar.fillzero();
+    plan.d_ezhat.fillzero();
+    plan.d_ptucheck.fillzero();
+    plan.d_etvtilde.fillzero();
 
-    cudaStream_t stream1, stream2;
-    cudaStreamCreate(&stream1);
-    cudaStreamCreate(&stream2);
+    if (!plan.stream1) cudaStreamCreate(&plan.stream1);
+    if (!plan.stream2) cudaStreamCreate(&plan.stream2);
 
-    double te[4] = {0, 0, 0, 0}; // time elapsed for four stages
-    base_timer *timer[4];
-    for (int i = 0; i < 4; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+    return true;
+}
 
-    base_timer &timer_total = timers.gpu_add("alg5varc_gpu", width*height, "iP");
+/**
+ *  @ingroup api_gpu
+ *  @brief Update the weights of algorithm 5 with varying weights plan in the GPU
+ *
+ *  The weights per column and per row are given in device memory (at
+ *  least width and height of them), e.g. computed by a kernel from
+ *  a depth or sigma map on every frame.  They are copied to the plan
+ *  and the matrices recomputed in the GPU (see
+ *  compute_alg5varc_matrices()), with no host computation.  As the
+ *  weights are not inspected, all blocks vary unless a border is
+ *  given whose middle blocks have constant weights.
+ *
+ *  @param[in,out] plan The plan already prepared for the image size
+ *  @param[in] d_awf Forward weights per column in device memory
+ *  @param[in] d_awr Reverse weights per column in device memory
+ *  @param[in] d_ahf Forward weights per row in device memory
+ *  @param[in] d_ahr Reverse weights per row in device memory
+ *  @param[in] border Number of border blocks (32x32) of varying weights
+ *  @tparam R Filter order
+ */
+template <int R>
+void update_alg5varc( alg5varc_plan<R>& plan,
+                      const Vector<float,R+1> *d_awf,
+                      const Vector<float,R+1> *d_awr,
+                      const Vector<float,R+1> *d_ahf,
+                      const Vector<float,R+1> *d_ahr,
+                      int border=-1 ) {
+    const size_t wsize = sizeof(Vector<float,R+1>);
+    // the weights past the image stay zero from the prepare
+    cudaMemcpy(&plan.d_awf, d_awf, plan.width*wsize, cudaMemcpyDeviceToDevice);
+    cudaMemcpy(&plan.d_awr, d_awr, plan.width*wsize, cudaMemcpyDeviceToDevice);
+    cudaMemcpy(&plan.d_ahf, d_ahf, plan.height*wsize, cudaMemcpyDeviceToDevice);
+    cudaMemcpy(&plan.d_ahr, d_ahr, plan.height*wsize, cudaMemcpyDeviceToDevice);
+
+    plan.border = border < 0 ? std::max(plan.m_size, plan.n_size) : border;
+
+    compute_alg5varc_matrices(plan);
+}
 
-    for(int r = 0; r < runtimes; ++r) {
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 5 with varying coefficients plan in the GPU
+ *
+ *  The varying coefficients are the ones of the cubic B-spline
+ *  prefilter in [NehabHoppe:2011] (see build_weights()), any higher
+ *  order weights being zero.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @return True if the plan was prepared
+ *  @tparam R Filter order
+ */
+template <int R>
+bool prepare_alg5varc( alg5varc_plan<R>& plan,
+                       int width, int height,
+                       int border=1 ) {
+    std::vector< Vector<float,2> > awf, awr, ahf, ahr;
+    if (!build_weights(awf, awr, width, width) ||
+        !build_weights(ahf, ahr, height, height)) {
+        std::cerr << "Error building variable coefficients!\n";
+        return false;
+    }
 
-        if (runtimes == 1) { timer[0]->start(); }
+    std::vector< Vector<float,R+1> > wf(width, zeros<float,R+1>()), wr(wf),
+        hf(height, zeros<float,R+1>()), hr(hf);
+    for (int i = 0; i < width; ++i)
+        for (int k = 0; k < 2; ++k) { wf[i][k] = awf[i][k]; wr[i][k] = awr[i][k]; }
+    for (int i = 0; i < height; ++i)
+        for (int k = 0; k < 2; ++k) { hf[i][k] = ahf[i][k]; hr[i][k] = ahr[i][k]; }
 
-        cudaBindTextureToArray(t_in, a_in);
+    return prepare_alg5varc(plan, width, height, &wf[0], &wr[0], &hf[0], &hr[0],
+                            border);
+}
 
-        alg5varc_stage1_bor<<< dim3(m_size, n_size), dim3(WS, NWC), 0, stream1 >>>
-            ( &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde,
-              inv_width, inv_height, m_size, n_size, &d_aw, &d_ah );
-        alg5varc_stage1_mid<<< dim3(m_size, n_size), dim3(WS, NWC), 0, stream2 >>>
-            ( &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde,
-              inv_width, inv_height, m_size, n_size );
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 5 with varying Gaussian sigma plan in the GPU
+ *
+ *  Each column (in the row pass) and each row (in the column pass)
+ *  has its own sigma, the weights of the R-order Gaussian
+ *  approximation being the same forward and reverse (see weights()).
+ *  This gives a spatially varying blur, e.g. for depth of field or
+ *  foveated rendering.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] sigma_w Gaussian sigma per column
+ *  @param[in] sigma_h Gaussian sigma per row
+ *  @return True if the plan was prepared
+ *  @tparam R Filter order
+ */
+template <int R>
+bool prepare_alg5varc( alg5varc_plan<R>& plan,
+                       int width, int height,
+                       const float *sigma_w,
+                       const float *sigma_h ) {
+    std::vector< Vector<float,R+1> > aw(width), ah(height);
+    for (int i = 0; i < width; ++i) weights(sigma_w[i], aw[i]);
+    for (int i = 0; i < height; ++i) weights(sigma_h[i], ah[i]);
+    return prepare_alg5varc(plan, width, height, &aw[0], &aw[0], &ah[0], &ah[0]);
+}
 
-        cudaDeviceSynchronize();
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 5 with varying coefficients plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional four timers to measure each stage
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg5varc_gpu( alg5varc_plan<R>& plan,
+                   base_timer **timer=0 ) {
 
-        if (runtimes == 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    if (make_current(plan)) {
+        copy_to_symbol(c_b0f, plan.w[0]);
+        copy_to_symbol(c_b0r, plan.b0r);
 
+        copy_to_symbol(c_border, plan.border);
+
+        copy_to_constants(&filter_constants<R>::weights, plan.w);
+
+        copy_to_constants(&filter_constants<R>::AbF_T, plan.mat.AbF_T);
+        copy_to_constants(&filter_constants<R>::AbR_T, plan.mat.AbR_T);
+        copy_to_constants(&filter_constants<R>::HARB_AFP_T, plan.mat.HARB_AFP_T);
+
+        copy_to_constants(&filter_constants<R>::ARE_T, plan.mat.ARE_T);
+        copy_to_constants(&filter_constants<R>::ARB_AFP_T, plan.mat.ARB_AFP_T);
+        copy_to_constants(&filter_constants<R>::TAFB, plan.mat.TAFB);
+        copy_to_constants(&filter_constants<R>::HARB_AFB, plan.mat.HARB_AFB);
+    }
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    const float inv_width = plan.inv_width, inv_height = plan.inv_height;
+    cudaStream_t stream1 = plan.stream1, stream2 = plan.stream2;
+
+    if (timer) timer[0]->start();
+
+    alg5varc_stage1_bor<<< dim3(m_size, n_size), dim3(WS, NWC), 0, stream1 >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          inv_width, inv_height, m_size, n_size,
+          &plan.d_awf, &plan.d_awr, &plan.d_ahf, &plan.d_ahr );
+    alg5varc_stage1_mid<<< dim3(m_size, n_size), dim3(WS, NWC), 0, stream2 >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          inv_width, inv_height, m_size, n_size );
+
+    cudaDeviceSynchronize();
+
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
+
+    if (plan.border > 0) // any border block makes matrices vary per block
         alg5varc_stage2_bor<<< dim3(1, n_size), dim3(WS, NWA), 0, stream1 >>>
-            ( &d_pybar, &d_ezhat, m_size, n_size, &d_AbF_T,
-              &d_AbR_T, &d_HARB_AFP_T );
+            ( &plan.d_pybar, &plan.d_ezhat, m_size, n_size, &plan.d_AbF_T,
+              &plan.d_AbR_T, &plan.d_HARB_AFP_T );
+    else
         alg5varc_stage2_mid<<< dim3(1, n_size), dim3(WS, NWA), 0, stream2 >>>
-            ( &d_pybar, &d_ezhat, m_size, n_size );
+            ( &plan.d_pybar, &plan.d_ezhat, m_size, n_size );
 
-        cudaDeviceSynchronize();
+    cudaDeviceSynchronize();
 
-        if (runtimes == 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
+    if (plan.border > 0)
         alg5varc_stage3_bor<<< dim3(m_size, 1), dim3(WS, NWA), 0, stream1 >>>
-            ( &d_ptucheck, &d_etvtilde, &d_pybar, &d_ezhat, m_size, n_size,
-              &d_AbF, &d_TAFB, &d_ARE_T, &d_ARB_AFP_T, &d_AbR, &d_HARB_AFP,
-              &d_HARB_AFB );
+            ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat, m_size, n_size,
+              &plan.d_AbF, &plan.d_TAFB, &plan.d_ARE_T, &plan.d_ARB_AFP_T, &plan.d_AbR,
+              &plan.d_HARB_AFP, &plan.d_HARB_AFB );
+    else
         alg5varc_stage3_mid<<< dim3(m_size, 1), dim3(WS, NWA), 0, stream2 >>>
-            ( &d_ptucheck, &d_etvtilde, &d_pybar, &d_ezhat, m_size, n_size );
+            ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat, m_size, n_size );
 
-        cudaDeviceSynchronize();
+    cudaDeviceSynchronize();
 
-        if (runtimes == 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        alg5varc_stage4_bor<<< dim3(m_size, n_size), dim3(WS, NWW), 0, stream1 >>>
-            ( d_img, &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde,
-              inv_width, inv_height, m_size, n_size, stride_img,
-              &d_aw, &d_ah );
-        alg5varc_stage4_mid<<< dim3(m_size, n_size), dim3(WS, NWW), 0, stream2 >>>
-            ( d_img, &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde,
-              inv_width, inv_height, m_size, n_size, stride_img );
+    alg5varc_stage4_bor<<< dim3(m_size, n_size), dim3(WS, NWW), 0, stream1 >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          inv_width, inv_height, m_size, n_size, plan.stride_img,
+          &plan.d_awf, &plan.d_awr, &plan.d_ahf, &plan.d_ahr );
+    alg5varc_stage4_mid<<< dim3(m_size, n_size), dim3(WS, NWW), 0, stream2 >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          inv_width, inv_height, m_size, n_size, plan.stride_img );
 
-        cudaDeviceSynchronize();
+    cudaDeviceSynchronize();
 
-        cudaUnbindTexture(t_in);
+    if (timer) timer[3]->stop();
 
-        if (runtimes == 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); }
+}
 
-    }
+/**
+ *  @ingroup api_gpu
+ *  @brief Run a prepared algorithm 5 with varying coefficients plan on a host image
+ *  @param[in,out] plan The prepared plan to run
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg5varc_gpu( alg5varc_plan<R>& plan,
+                   float *h_img,
+                   int runtimes ) {
+
+    upload(plan, h_img);
+
+    const char *steps[4] = { "stage 1", "stage 2", "stage 3", "stage 4" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[4];
+    for (int i = 0; i < 4; ++i)
+        timer[i] = new step_timer(std::string("alg5varc_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg5varc_gpu", plan.width*plan.height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg5varc_gpu(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 4; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        if (timed) {
+            for (int i = 0; i < 4; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
 
     } else {
 
-        timers.gpu_add("stage 1", timer[0]);
-        timers.gpu_add("stage 2", timer[1]);
-        timers.gpu_add("stage 3", timer[2]);
-        timers.gpu_add("stage 4", timer[3]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 5 with varying coefficients in the GPU
+ *  @see alg5_gpu()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg5varc_gpu( float *h_img,
+                   int width, int height, int runtimes,
+                   int border=1 ) {
+
+    alg5varc_plan<R> plan;
+    if (!prepare_alg5varc(plan, width, height, border)) return;
+
+    alg5varc_gpu(plan, h_img, runtimes);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 5 with varying Gaussian sigma in the GPU
+ *  @see prepare_alg5varc()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] sigma_w Gaussian sigma per column
+ *  @param[in] sigma_h Gaussian sigma per row
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg5varc_gpu( float *h_img,
+                   int width, int height, int runtimes,
+                   const float *sigma_w,
+                   const float *sigma_h ) {
+
+    alg5varc_plan<R> plan;
+    if (!prepare_alg5varc(plan, width, height, sigma_w, sigma_h)) return;
 
-    cudaStreamDestroy(stream1);
-    cudaStreamDestroy(stream2);
+    alg5varc_gpu(plan, h_img, runtimes);
 
-    delete [] aw;
-    delete [] ah;
 }
 
 //==============================================================================
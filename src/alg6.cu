@@ -34,10 +34,12 @@
 #include "cpudefs.h"
 #include "gpudefs.h"
 #include "alg0_cpu.h"
+#include "refcheck.cuh"
 #include "alg6_gpu.cuh"
 #include "alg6_clamp.cuh"
 #include "alg6_repeat.cuh"
 #include "alg6_reflect.cuh"
+#include "gpufilter_inst.cuh"
 
 //== IMPLEMENTATION ============================================================
 
@@ -116,11 +118,14 @@ int main( int argc, char** argv ) {
     if (runtimes == 1) // running for debugging
         print_info(width, height, btype, border, a0border, w);
 
-    gpufilter::alg0_cpu<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+    gpufilter::alg0_cached<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+
+    // the result is checked in the GPU before its download (see gpu_reference)
+    gpufilter::gpu_reference ref( &cpu_img[0], width, height );
 
     alg6<ORDER>(&gpu_img[0], width, height, runtimes, w, border, btype);
 
-    gpufilter::check_cpu_reference( &cpu_img[0], &gpu_img[0], width*height, me, mre );
+    ref.check( &gpu_img[0], me, mre );
 
     if (runtimes == 1) // running for debugging
         std::cout << APPNAME << " [max-error] [max-relative-error]:";
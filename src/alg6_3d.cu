@@ -0,0 +1,95 @@
+/**
+ *  @file alg6_3d.cu
+ *  @brief Algorithm 6 for 3D volumes in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#ifndef DEPTH
+#define DEPTH 64 // default volume depth (number of slices)
+#endif
+#define APPNAME "[alg6_3d_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg6_3d_gpu.cuh"
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, gpu_img, w, a0border, me, mre,
+                  argc, argv);
+
+    if (btype != gpufilter::CLAMP_TO_ZERO
+        && (btype != gpufilter::CLAMP_TO_EDGE || border == 0)) {
+        std::cerr << APPNAME << " Volumes support only zero or clamp (with border blocks)\n";
+        return 1;
+    }
+
+    const int depth = DEPTH;
+
+    cpu_img.resize(width*height*depth);
+    gpu_img.resize(width*height*depth);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height*depth; ++i)
+        gpu_img[i] = cpu_img[i] = rand() / (float)RAND_MAX;
+
+    if (runtimes == 1) { // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+        std::cout << APPNAME << " Volume depth: " << depth << "\n";
+    }
+
+    gpufilter::alg0_cpu_3d<ORDER>(&cpu_img[0], width, height, depth, w, a0border, btype);
+
+    if (border == 0)
+        gpufilter::alg6_3d_gpu<false, ORDER>(&gpu_img[0], width, height, depth,
+                                             runtimes, w);
+    else
+        gpufilter::alg6_3d_gpu<true, ORDER>(&gpu_img[0], width, height, depth,
+                                            runtimes, w, border, btype);
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &gpu_img[0], width*height*depth, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,358 @@
+/**
+ *  @file alg6_3d_gpu.cuh
+ *  @brief Algorithm 6 for 3D volumes in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_3D_GPU_CUH
+#define ALG6_3D_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <stdexcept>
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Read one voxel along the depth of a volume in global memory
+ *  @param[in] g_col Pointer to the voxel at depth zero of this column
+ *  @param[in] inside Flag of the column inside the volume width
+ *  @param[in] z Depth index (possibly outside the volume)
+ *  @param[in] depth Volume depth
+ *  @param[in] slice_size Size of each slice (in floats)
+ *  @param[in] clamp Flag to clamp the depth index (else zero outside)
+ *  @return The voxel value
+ */
+__device__ inline
+float read_depth( const float *g_col,
+                  bool inside,
+                  int z, int depth,
+                  size_t slice_size,
+                  bool clamp ) {
+    if (!inside) return 0.f;
+    if (z < 0 || z >= depth) {
+        if (!clamp) return 0.f;
+        z = z < 0 ? 0 : depth-1;
+    }
+    return g_col[z*slice_size];
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 for 3D volumes depth step 1
+ *
+ *  In parallel for all pixels \f$(x,y)\f$ of the slices and all depth
+ *  blocks \f$l\f$ (of 32 slices), compute and store the depth
+ *  perimeters \f$P_l(Y)\f$ and \f$E_l(Z)\f$, the same as algorithm 6
+ *  step 1 computes for rows but along the depth.  Each warp handles
+ *  32 consecutive pixels of one row (coalesced reads of each slice),
+ *  thus the carries are stored per group of 32 pixels exactly as the
+ *  row carries are stored per block row, and fixed by
+ *  alg3v4v5v6_step2v4().
+ *
+ *  @param[in] g_vol The volume in global memory (filtered in rows and columns)
+ *  @param[out] g_pdbar All \f$P_l(Y)\f$ along depth
+ *  @param[out] g_edhat All \f$E_l(Z)\f$ along depth
+ *  @param[in] params Filter parameters (weights and border blocks)
+ *  @param[in] width Volume width
+ *  @param[in] height Volume height
+ *  @param[in] depth Volume depth
+ *  @param[in] stride Volume row stride (in floats)
+ *  @param[in] l_size The big L (number of depth blocks, including borders)
+ *  @param[in] clamp Flag to clamp border slices (else zero)
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS*NWD)
+void alg6_3d_depth_step1( const float *g_vol,
+                          Matrix<float,R,WS> *g_pdbar,
+                          Matrix<float,R,WS> *g_edhat,
+                          const filter_params<R> params,
+                          int width, int height, int depth, int stride,
+                          int l_size, bool clamp ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, g = blockIdx.x,
+        y = blockIdx.y*NWD+ty, l = blockIdx.z, x = g*WS+tx,
+        n = y*gridDim.x+g, z0 = (l-params.border)*WS;
+
+    if (y >= height) return;
+
+    size_t slice_size = (size_t)height*stride;
+    const float *gcol = g_vol + y*stride + x;
+
+    float v[WS];
+
+#pragma unroll
+    for (int j=0; j<WS; ++j)
+        v[j] = read_depth(gcol, x < width, z0+j, depth, slice_size, clamp);
+
+    Vector<float,R> p = zeros<float,R>();
+
+#pragma unroll // calculate pdbar, scan front -> back
+    for (int j=0; j<WS; ++j)
+        v[j] = fwdI(p, v[j], params.weights);
+
+    g_pdbar[n*(l_size+1)+l+1].set_col(tx, p);
+
+    Vector<float,R> e = zeros<float,R>();
+
+#pragma unroll // calculate edhat, scan back -> front
+    for (int j=WS-1; j>=0; --j)
+        revI(v[j], e, params.weights);
+
+    g_edhat[n*(l_size+1)+l].set_col(tx, e);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 for 3D volumes depth step 3
+ *
+ *  In parallel for all pixels \f$(x,y)\f$ and all depth blocks
+ *  \f$l\f$ inside the volume, filter the depth block forward and
+ *  reverse starting from the fixed carries, writing the output in
+ *  place.  Each thread reads all slices of its block before writing
+ *  (border slices outside the volume only repeat the slices of the
+ *  same block), thus in-place writing is safe.
+ *
+ *  @param[in,out] g_vol The volume in global memory (filtered in rows and columns)
+ *  @param[in] g_pd All \f$P_l(y)\f$ along depth (fixed)
+ *  @param[in] g_ed All \f$E_l(z)\f$ along depth (fixed)
+ *  @param[in] params Filter parameters (weights and border blocks)
+ *  @param[in] width Volume width
+ *  @param[in] height Volume height
+ *  @param[in] depth Volume depth
+ *  @param[in] stride Volume row stride (in floats)
+ *  @param[in] l_size The big L (number of depth blocks, including borders)
+ *  @param[in] clamp Flag to clamp border slices (else zero)
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS*NWD)
+void alg6_3d_depth_step3( float *g_vol,
+                          const Matrix<float,R,WS> *g_pd,
+                          const Matrix<float,R,WS> *g_ed,
+                          const filter_params<R> params,
+                          int width, int height, int depth, int stride,
+                          int l_size, bool clamp ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, g = blockIdx.x,
+        y = blockIdx.y*NWD+ty, l = blockIdx.z+params.border, x = g*WS+tx,
+        n = y*gridDim.x+g, z0 = (l-params.border)*WS;
+
+    if (y >= height) return;
+
+    size_t slice_size = (size_t)height*stride;
+    float *gcol = g_vol + y*stride + x;
+
+    float v[WS];
+
+#pragma unroll
+    for (int j=0; j<WS; ++j)
+        v[j] = read_depth(gcol, x < width, z0+j, depth, slice_size, clamp);
+
+    Vector<float,R> p = ((Matrix<float,R,WS>*)&g_pd[n*(l_size+1)+l][0][tx])->col(0);
+
+#pragma unroll // calculate block, scan front -> back
+    for (int j=0; j<WS; ++j)
+        v[j] = fwdI(p, v[j], params.weights);
+
+    Vector<float,R> e = ((Matrix<float,R,WS>*)&g_ed[n*(l_size+1)+l+1][0][tx])->col(0);
+
+#pragma unroll // calculate block, scan back -> front
+    for (int j=WS-1; j>=0; --j)
+        v[j] = revI(v[j], e, params.weights);
+
+    if (x >= width) return;
+
+#pragma unroll
+    for (int j=0; j<WS; ++j)
+        if (z0+j < depth)
+            gcol[(z0+j)*slice_size] = v[j];
+
+}
+
+/**
+ *  @struct alg6_3d_plan alg6_3d_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of algorithm 6 for 3D volumes
+ *
+ *  The volume slices are the layers of the algorithm 6 plan, filtered
+ *  in rows and columns by the algorithm 6 steps, then filtered along
+ *  the depth by the same block machinery (depth step 1, step 2 and
+ *  depth step 3) directly on the output volume, without transposing.
+ *  The number of slices is limited by the maximum number of layers of
+ *  a layered CUDA array.
+ *
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+struct alg6_3d_plan : public alg6_plan<BORDER,R> {
+    int depth; ///< Volume depth (number of slices)
+    int l_size; ///< The big L (number of depth blocks, including borders)
+    int groups; ///< Number of groups of 32 pixels of each row
+    dvector< Matrix<float,R,WS> > d_pdbar, d_edhat; ///< Depth carries
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 plan for 3D volumes in the GPU
+ *
+ *  Only zero and clamp-to-edge borders are supported along the depth,
+ *  thus also in rows and columns.
+ *
+ *  @param[out] plan Prepared plan
+ *  @param[in] width Volume width
+ *  @param[in] height Volume height
+ *  @param[in] depth Volume depth
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32x32) outside volume
+ *  @param[in] btype Border type (either zero or clamp)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+void prepare_alg6_3d( alg6_3d_plan<BORDER,R>& plan,
+                      const int& width, const int& height, const int& depth,
+                      const Vector<float, R+1>& w,
+                      const int& border=0,
+                      const BorderType& btype=CLAMP_TO_ZERO ) {
+
+    if (btype != CLAMP_TO_ZERO && btype != CLAMP_TO_EDGE)
+        throw std::runtime_error("Volumes support only zero or clamp borders");
+
+    prepare_alg6(plan, width, height, w, border, btype, depth);
+
+    plan.depth = depth;
+    plan.l_size = (depth+WS-1)/WS + 2*plan.border;
+    plan.groups = (width+WS-1)/WS;
+
+    plan.d_pdbar.resize((plan.l_size+1)*plan.groups*height);
+    plan.d_edhat.resize((plan.l_size+1)*plan.groups*height);
+    plan.d_pdbar.fillzero();
+    plan.d_edhat.fillzero();
+
+    cudaFuncSetCacheConfig(alg6_3d_depth_step1<R>, cudaFuncCachePreferL1);
+    cudaFuncSetCacheConfig(alg6_3d_depth_step3<R>, cudaFuncCachePreferL1);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 plan for 3D volumes in the GPU
+ *  @param[in,out] plan The plan to run (with its input uploaded)
+ *  @param[in,out] timer Timers for the six steps (optional)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+void alg6_3d_gpu( alg6_3d_plan<BORDER,R>& plan,
+                  base_timer **timer=0 ) {
+
+    alg6_gpu(plan, timer);
+
+    const bool clamp = plan.btype == CLAMP_TO_EDGE && plan.border > 0;
+    const int rows = (plan.height+NWD-1)/NWD;
+
+    if (timer) timer[5]->start();
+
+    alg6_3d_depth_step1<<< dim3(plan.groups, rows, plan.l_size), dim3(WS, NWD), 0, plan.stream >>>
+        ( &plan.d_img, &plan.d_pdbar, &plan.d_edhat, plan.params,
+          plan.width, plan.height, plan.depth, plan.stride_img,
+          plan.l_size, clamp );
+
+    alg3v4v5v6_step2v4<<< dim3(1, plan.groups, plan.height), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pdbar, &plan.d_edhat, plan.params, plan.l_size );
+
+    alg6_3d_depth_step3<<< dim3(plan.groups, rows, plan.l_size-2*plan.border), dim3(WS, NWD), 0, plan.stream >>>
+        ( &plan.d_img, &plan.d_pdbar, &plan.d_edhat, plan.params,
+          plan.width, plan.height, plan.depth, plan.stride_img,
+          plan.l_size, clamp );
+
+    if (timer) timer[5]->stop();
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 for 3D volumes in the GPU
+ *
+ *  Given an input 3D volume (slice after slice) compute the recursive
+ *  filtering along its rows, columns and depth.
+ *
+ *  @param[in,out] h_vol The in(out)put 3D volume to filter in host memory
+ *  @param[in] width Volume width
+ *  @param[in] height Volume height
+ *  @param[in] depth Volume depth
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32x32) outside volume
+ *  @param[in] btype Border type (either zero or clamp)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+void alg6_3d_gpu( float *h_vol,
+                  const int& width, const int& height, const int& depth,
+                  const int& runtimes,
+                  const Vector<float, R+1>& w,
+                  const int& border=0,
+                  const BorderType& btype=CLAMP_TO_ZERO ) {
+
+    alg6_3d_plan<BORDER,R> plan;
+    prepare_alg6_3d(plan, width, height, depth, w, border, btype);
+
+    upload(plan, h_vol);
+
+    const char *steps[6] = { "step 1", "step 2", "step 3", "step 4", "step 5", "depth" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[6];
+    for (int i = 0; i < 6; ++i)
+        timer[i] = new step_timer(std::string("alg6_3d_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg6_3d_gpu", width*height*depth, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_3d_gpu(plan, timed ? timer : 0);
+
+    timer_total.stop();
+
+    for (int i = 0; i < 6; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
+    if (runtimes > 1) {
+
+        if (timed) {
+            for (int i = 0; i < 6; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
+
+    } else {
+
+        timers.flush();
+
+    }
+
+    download(plan, h_vol);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_3D_GPU_CUH
+//==============================================================================
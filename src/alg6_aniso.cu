@@ -0,0 +1,159 @@
+/**
+ *  @file alg6_aniso.cu
+ *  @brief Algorithm 6 in the GPU with per-axis filters and single-axis modes
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 2 // default filter order r=2
+#endif
+#define APPNAME "[alg6_aniso_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg6_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Name of filtered axes
+ *  @param[in] axes Filtered axes
+ *  @return Filtered axes name
+ */
+const char *axes_name( const gpufilter::FilterAxes& axes ) {
+    return axes==gpufilter::ROWS_ONLY ? "rows" :
+        axes==gpufilter::COLUMNS_ONLY ? "cols" : "both";
+}
+
+/**
+ *  @brief Run an algorithm 6 plan and download its output to the host
+ *  @param[in,out] plan The plan to run
+ *  @param[in] h_in The input 2D image in the host
+ *  @param[out] h_out The output 2D image in the host
+ *  @param[in] runtimes Number of run times to average
+ *  @return Time elapsed (average in seconds) of the filter
+ */
+template <int R>
+double run_alg6( gpufilter::alg6_plan<false,R>& plan,
+                 const float *h_in,
+                 float *h_out,
+                 int runtimes ) {
+    gpufilter::upload(plan, h_in);
+    gpufilter::alg6_gpu(plan); // warm up
+    gpufilter::gpu_timer timer(0, "", false);
+    timer.start();
+    for (int r = 0; r < runtimes; ++r)
+        gpufilter::alg6_gpu(plan);
+    timer.stop();
+    gpufilter::download(plan, h_out);
+    return timer.elapsed() / runtimes;
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1024, height = 1024;
+    int runtimes = 1; // # of run times (1 for debug; 1000 for performance)
+    float me = 0.f, mre = 0.f; // maximum error and maximum relative error
+
+    if ((argc != 1 && argc != 4) ||
+        (argc == 4 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%d", &runtimes) != 1)) ||
+        width <= 0 || height <= 0 || runtimes <= 0) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height runtimes]\n";
+        return 1;
+    }
+
+    std::vector< float > in_img(width*height), cpu_img(width*height),
+        gpu_img(width*height);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        in_img[i] = rand() / (float)RAND_MAX;
+
+    float sigma_rows = 4.f, sigma_cols = 8.f; // anisotropic gaussian
+
+    gpufilter::Vector<float, ORDER+1> wr;
+    gpufilter::Vector<float, 2> wc; // first-order columns
+    gpufilter::weights(sigma_rows, wr);
+    gpufilter::weights(sigma_cols, wc);
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Order of rows: " << ORDER << "  of columns: 1"
+                  << "  Run-times: 1\n";
+        std::cout << APPNAME << " Weights of rows: " << wr << "\n";
+        std::cout << APPNAME << " Weights of columns: " << wc << "\n";
+        std::cout << APPNAME << " (1) Runs the reference in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the GPU on both, rows and columns (res)\n";
+        std::cout << APPNAME << " (3) Checks computations (ref x res)\n";
+    }
+
+    gpufilter::alg6_plan<false,ORDER> plan;
+    gpufilter::prepare_alg6(plan, width, height, wr);
+
+    const gpufilter::FilterAxes modes[3] = { gpufilter::BOTH_AXES,
+                                             gpufilter::ROWS_ONLY,
+                                             gpufilter::COLUMNS_ONLY };
+    double t[3];
+
+    std::cout << std::fixed << APPNAME << " [axes] [filter-ms] [max-error] [max-relative-error]\n";
+
+    for (int a = 0; a < 3; ++a) {
+
+        std::copy(in_img.begin(), in_img.end(), cpu_img.begin());
+
+        if (modes[a] != gpufilter::COLUMNS_ONLY) {
+            gpufilter::recursive_rows_fwd<ORDER>(&cpu_img[0], width, height, wr);
+            gpufilter::recursive_rows_rev<ORDER>(&cpu_img[0], width, height, wr);
+        }
+        if (modes[a] != gpufilter::ROWS_ONLY) {
+            gpufilter::recursive_cols_fwd<1>(&cpu_img[0], width, height, wc);
+            gpufilter::recursive_cols_rev<1>(&cpu_img[0], width, height, wc);
+        }
+
+        gpufilter::prepare_axes(plan, wc, modes[a]);
+
+        t[a] = run_alg6(plan, &in_img[0], &gpu_img[0], runtimes);
+
+        gpufilter::check_cpu_reference( &cpu_img[0], &gpu_img[0], width*height, me, mre );
+
+        std::cout << APPNAME << " " << axes_name(modes[a]) << " "
+                  << std::fixed << std::setprecision(3) << t[a]*1000 << " "
+                  << std::scientific << me << " " << mre << "\n";
+
+    }
+
+    std::cout << std::fixed << APPNAME << " Single axis: " << std::setprecision(1)
+              << 100.*t[1]/t[0] << "% (rows) " << 100.*t[2]/t[0] << "% (cols)"
+              << " of both\n";
+
+    return 0;
+
+}
@@ -0,0 +1,125 @@
+/**
+ *  @file alg6_axes.cu
+ *  @brief Algorithm 6 in the GPU with one boundary condition per axis
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_axes_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg6_axes.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Name of a border type
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @return Border type name
+ */
+const char *btype_name( const gpufilter::BorderType& btype ) {
+    return btype==gpufilter::CLAMP_TO_ZERO ? "zero" :
+        btype==gpufilter::CLAMP_TO_EDGE ? "clamp" :
+        btype==gpufilter::REPEAT ? "repeat" : "reflect";
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1024, height = 1024;
+    int runtimes = 1; // # of run times (1 for debug; 1000 for performance)
+    int row_btype = gpufilter::REPEAT, col_btype = gpufilter::CLAMP_TO_EDGE;
+    float me = 0.f, mre = 0.f; // maximum error and maximum relative error
+
+    if ((argc != 1 && argc != 6) ||
+        (argc == 6 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%d", &runtimes) != 1 ||
+                       sscanf(argv[4], "%d", &row_btype) != 1 ||
+                       sscanf(argv[5], "%d", &col_btype) != 1)) ||
+        width <= 0 || height <= 0 || runtimes <= 0 ||
+        row_btype < 0 || row_btype > 3 || col_btype < 0 || col_btype > 3) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height runtimes row_btype col_btype]\n";
+        std::cout << APPNAME << " Where: border types are 0 zero, 1 clamp,"
+                  << " 2 repeat or 3 reflect (default 2 1)\n";
+        return 1;
+    }
+
+    const gpufilter::BorderType rbt = (gpufilter::BorderType)row_btype,
+        cbt = (gpufilter::BorderType)col_btype;
+
+    std::vector< float > cpu_img(width*height), gpu_img(width*height);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        gpu_img[i] = cpu_img[i] = rand() / (float)RAND_MAX;
+
+    float sigma = 4.f; // width / 6.f;
+
+    gpufilter::Vector<float, ORDER+1> w;
+    gpufilter::weights(sigma, w);
+
+    int a0border = (std::max(width, height)+63)/64; // up to half-image border in blocks
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Order: " << ORDER << "  Run-times: 1\n";
+        std::cout << APPNAME << " Border type of rows: " << btype_name(rbt)
+                  << "  of columns: " << btype_name(cbt) << "\n";
+        std::cout << APPNAME << " Weights: " << w << "\n";
+        std::cout << APPNAME << " Border for the reference (alg0): "
+                  << a0border << "\n";
+        std::cout << APPNAME << " (1) Runs the reference in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the algorithm in the GPU (res)\n";
+        std::cout << APPNAME << " (3) Checks computations (ref x res)\n";
+    }
+
+    gpufilter::alg0_cpu_axes<ORDER>(&cpu_img[0], width, height, w, a0border, rbt, cbt);
+
+    if (runtimes > 1)
+        std::cout << APPNAME << " [gpu-MiP/s]: ";
+
+    gpufilter::alg6_axes<ORDER>(&gpu_img[0], width, height, runtimes, w, rbt, cbt);
+
+    if (runtimes > 1)
+        std::cout << "\n";
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &gpu_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,261 @@
+/**
+ *  @file alg6_axes.cuh
+ *  @brief Algorithm 6 with one boundary condition per axis
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_AXES_CUH
+#define ALG6_AXES_CUH
+
+//== INCLUDES ==================================================================
+
+#include <stdexcept>
+
+#include "alg6_gpu.cuh"
+#include "alg6_clamp.cuh"
+#include "alg6_repeat.cuh"
+#include "alg6_reflect.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg6_axes_plan alg6_axes.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of algorithm 6 with one border type per axis
+ *
+ *  The rows (left and right) and the columns (top and bottom) are
+ *  extended by their own border type, each exactly as in alg6_clamp(),
+ *  alg6_repeat() and alg6_reflect() (or zero as in alg6_gpu()), with
+ *  no border blocks.  The plan holds the carry matrices of all types
+ *  and its own input texture object addressed per axis, passed to
+ *  kernels as the other plans of algorithm 6, thus plans of this
+ *  and other algorithms run concurrently.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_axes_plan : public alg5v6_plan<R> {
+    BorderType row_btype, col_btype; ///< Border types of rows and columns
+    border_params<R> bparams; ///< Carry matrices of all border types passed to kernels
+
+    /// Default constructor
+    alg6_axes_plan() : row_btype(CLAMP_TO_ZERO), col_btype(CLAMP_TO_ZERO) { }
+};
+
+//=== IMPLEMENTATION ===========================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Launch the stage 2 or 4 of a border type on a plan stream
+ *
+ *  Zero uses alg3v4v5v6_step2v4() (whose carries of the padding slots
+ *  stay zero), the others use their own algorithm 6 kernel.
+ *
+ *  @param[in] plan The plan (with its stream and parameters)
+ *  @param[in] btype Border type of the axis
+ *  @param[in,out] d_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] d_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] m_size The big M or N (number of blocks along the axis)
+ *  @param[in] n_size The big N or M (number of rows or columns of blocks)
+ *  @tparam in_width Flag for choosing stage 2 (rows) or 4 (columns)
+ *  @tparam R Filter order
+ */
+template <bool in_width, int R>
+void launch_alg6_axes_stage2v4( const alg6_axes_plan<R>& plan,
+                                BorderType btype,
+                                Matrix<float,R,WS> *d_pybar,
+                                Matrix<float,R,WS> *d_ezhat,
+                                int m_size, int n_size ) {
+
+    dim3 grid(1, n_size), block(WS, NWA);
+
+    if (btype == CLAMP_TO_EDGE)
+        alg6_clamp_stage2v4<<< grid, block, 0, plan.stream >>>
+            ( d_pybar, d_ezhat, plan.params, plan.bparams, m_size );
+    else if (btype == REPEAT)
+        alg6_repeat_stage2v4<in_width><<< grid, block, 0, plan.stream >>>
+            ( d_pybar, d_ezhat, plan.params, plan.bparams, m_size );
+    else if (btype == REFLECT)
+        alg6_reflect_stage2v4<in_width><<< grid, block, 0, plan.stream >>>
+            ( d_pybar, d_ezhat, plan.params, plan.bparams, m_size );
+    else
+        alg3v4v5v6_step2v4<<< grid, block, 0, plan.stream >>>
+            ( d_pybar, d_ezhat, plan.params, m_size );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 with one border type per axis in the GPU
+ *
+ *  The stages 1, 3 and 5 are the ones of clamp (storing and fixing the
+ *  clamp carries only on the clamp axes), the stages 2 and 4 are the
+ *  ones of the border type of each axis.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] row_btype Border type of rows (left and right)
+ *  @param[in] col_btype Border type of columns (top and bottom)
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void prepare_alg6_axes( alg6_axes_plan<R>& plan,
+                        const int& width, const int& height,
+                        const Vector<float, R+1>& w,
+                        BorderType row_btype,
+                        BorderType col_btype ) {
+
+    if (row_btype < CLAMP_TO_ZERO || row_btype > REFLECT ||
+        col_btype < CLAMP_TO_ZERO || col_btype > REFLECT)
+        throw std::runtime_error("Invalid border type of rows or columns");
+
+    // the plan border type is the one of rows, the input texture is
+    // addressed in width by the rows type and in height by the columns type
+    prepare_alg5v6(plan, width, height, w, 0, row_btype, false);
+    create_input_texture(plan, address_mode(row_btype), address_mode(col_btype));
+
+    plan.row_btype = row_btype;
+    plan.col_btype = col_btype;
+
+    prepare_clamp_matrices<R>(plan, w);
+    prepare_repeat_matrices<R>(plan);
+    prepare_reflect_matrices<R>(plan, w);
+
+    cudaFuncSetCacheConfig(alg6_clamp_stage1<R>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg6_clamp_stage5<R>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg6_clamp_stage3<R>, cudaFuncCachePreferL1);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 with one border type per axis in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional five timers to measure each stage
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void alg6_axes( alg6_axes_plan<R>& plan,
+                base_timer **timer=0 ) {
+
+    check_whole_output(plan);
+
+    if (!timer && launch_graph(plan, alg6_axes<R>))
+        return; // replayed the captured kernels (see plan_graph)
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    const bool clamp_rows = plan.row_btype == CLAMP_TO_EDGE,
+        clamp_cols = plan.col_btype == CLAMP_TO_EDGE;
+
+    if (timer) timer[0]->start();
+
+    alg6_clamp_stage1<<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size, clamp_rows, clamp_cols );
+
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
+
+    launch_alg6_axes_stage2v4<true>(plan, plan.row_btype, &plan.d_pybar, &plan.d_ezhat,
+                                    m_size, n_size);
+
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
+
+    alg6_clamp_stage3<<< dim3(m_size, n_size), dim3(WS, NWARC), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_cmat, m_size, n_size, clamp_cols );
+
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
+
+    launch_alg6_axes_stage2v4<false>(plan, plan.col_btype, &plan.d_ptucheck, &plan.d_etvtilde,
+                                     n_size, m_size);
+
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
+
+    alg6_clamp_stage5<<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size, plan.stride_img );
+
+    if (timer) timer[4]->stop();
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 with one border type per axis in the GPU
+ *
+ *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in/output 2D image to compute recursive filtering in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] row_btype Border type of rows (left and right)
+ *  @param[in] col_btype Border type of columns (top and bottom)
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void alg6_axes( float *h_img,
+                const int& width, const int& height, const int& runtimes,
+                const Vector<float, R+1>& w,
+                BorderType row_btype,
+                BorderType col_btype ) {
+
+    alg6_axes_plan<R> plan;
+    prepare_alg6_axes(plan, width, height, w, row_btype, col_btype);
+
+    upload(plan, h_img);
+
+    const char *steps[5] = { "stage 1", "stage 2", "stage 3", "stage 4", "stage 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i)
+        timer[i] = new step_timer(std::string("alg6_axes ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg6_axes", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_axes(plan, timed ? timer : 0);
+
+    timer_total.stop();
+
+    for (int i = 0; i < 5; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
+    if (runtimes > 1) {
+
+        if (timed) {
+            for (int i = 0; i < 5; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
+
+    } else {
+
+        timers.flush();
+
+    }
+
+    download(plan, h_img);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_AXES_CUH
+//==============================================================================
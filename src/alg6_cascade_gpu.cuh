@@ -0,0 +1,537 @@
+/**
+ *  @file alg6_cascade_gpu.cuh
+ *  @brief Cascade of algorithm 6 filters fusioned in one pipeline in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_CASCADE_GPU_CUH
+#define ALG6_CASCADE_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <stdexcept>
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Read a block of an image in global memory (zero outside)
+ *  @param[out] block The block read
+ *  @param[in] g_in The input 2D image
+ *  @param[in] m The block column
+ *  @param[in] n The block row
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] in_stride Image input stride for memory width alignment
+ *  @tparam W Number of warps reading the block
+ */
+template <int W>
+__device__
+void read_block_global( Matrix<float,WS,WS+1>& block,
+                        const float *g_in,
+                        int m, int n,
+                        int width, int height,
+                        int in_stride ) {
+    int tx = threadIdx.x, ty = threadIdx.y, x = m*WS+tx;
+#pragma unroll
+    for (int i=ty; i<WS; i+=W) {
+        int y = n*WS+i;
+        block[i][tx] = (x < width && y < height) ? g_in[y*in_stride+x] : 0.f;
+    }
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 5 of one cascade stage fusioned with step 1 of the next
+ *
+ *  This function computes the algorithm step 6.5 of stage \f$k\f$ of
+ *  a cascade and, while the output block \f$B_{m,n}(V)\f$ is still in
+ *  shared memory, the algorithm step 6.1 of stage \f$k+1\f$: the
+ *  block perimeters \f$P_{m,n}(Y)\f$, \f$E_{m,n}(Z)\f$,
+ *  \f$P^T_{m,n}(U)\f$ and \f$E^T_{m,n}(V)\f$ of the next filter.
+ *  This is the same fusion of alg5f4_r1r2() for any pair of orders,
+ *  thus the intermediate image is written once and read once (by the
+ *  step 6.5 of the next stage) instead of twice.  The output pixels
+ *  outside the image are zeroed before the next perimeters, as the
+ *  next stage sees the intermediate image with zero boundary.
+ *
+ *  @note The CUDA kernel functions (as this one) have many
+ *  idiosyncrasies and should not be used lightly.
+ *
+ *  @param[in] tex The input texture object (of the first stage)
+ *  @param[in] g_in The input 2D image (output of the previous stage)
+ *  @param[in] in_stride Image input stride for memory width alignment
+ *  @param[out] g_out The output 2D image
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$ of this stage
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$ of this stage
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$ of this stage
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$ of this stage
+ *  @param[in] params Filter parameters of this stage
+ *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$ of the next stage
+ *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$ of the next stage
+ *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$ of the next stage
+ *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$ of the next stage
+ *  @param[in] w2 Filter weights of the next stage
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] out_stride Image output stride for memory width alignment
+ *  @tparam FIRST Flag of the first stage (reading the input texture)
+ *  @tparam FUSE Flag to compute the step 1 of the next stage
+ *  @tparam R1 Filter order of this stage
+ *  @tparam R2 Filter order of the next stage
+ */
+template <bool FIRST, bool FUSE, int R1, int R2>
+__global__ __launch_bounds__(WS*NWW, NBCW)
+void alg6_cascade_step5( cudaTextureObject_t tex,
+                         const float *g_in, int in_stride,
+                         float *g_out,
+                         const Matrix<float,R1,WS> *g_py,
+                         const Matrix<float,R1,WS> *g_ez,
+                         const Matrix<float,R1,WS> *g_ptu,
+                         const Matrix<float,R1,WS> *g_etv,
+                         const filter_params<R1,float> params,
+                         Matrix<float,R2,WS> *g_pybar,
+                         Matrix<float,R2,WS> *g_ezhat,
+                         Matrix<float,R2,WS> *g_ptucheck,
+                         Matrix<float,R2,WS> *g_etvtilde,
+                         const Vector<float,R2+1> w2,
+                         float inv_width, float inv_height,
+                         int width, int height,
+                         int m_size, int n_size,
+                         int out_stride ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    if (FIRST)
+        read_block<NWW>(block, tex, m, n, 0, inv_width, inv_height);
+    else
+        read_block_global<NWW>(block, g_in, m, n, width, height, in_stride);
+    __syncthreads();
+
+    alg5v6_block_output<false,R1,1>(block, g_out, params.weights, params.weights,
+                                    BOTH_AXES, 0,
+                                    g_py, g_ez, g_ptu, g_etv,
+                                    m, n, m_size, n_size, width, height,
+                                    out_stride, FUSE);
+
+    if (FUSE) {
+
+        __syncthreads();
+
+        int x = m*WS+tx;
+#pragma unroll // zero output block outside image
+        for (int i=ty; i<WS; i+=NWW)
+            if (x >= width || n*WS+i >= height)
+                block[i][tx] = 0.f;
+        __syncthreads();
+
+        alg5v6_block_carries(block, w2, w2, BOTH_AXES,
+                             g_pybar, g_ezhat, g_ptucheck, g_etvtilde,
+                             m, n, m_size, n_size);
+
+    }
+
+}
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct cascade_stage alg6_cascade_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief One stage (filter of any order) of a cascade plan
+ *
+ *  Each stage owns an algorithm 6 plan of its order, the stages of
+ *  different orders are run through this interface so the cascade is
+ *  given at run time, see alg6_cascade_stage.
+ */
+struct cascade_stage {
+
+    int order; ///< Filter order of this stage
+
+    /// Constructor
+    cascade_stage( int r ) : order(r) { }
+
+    /// Destructor
+    virtual ~cascade_stage() { }
+
+    /// @return The algorithm 6 plan of this stage
+    virtual alg_plan& plan() = 0;
+
+    /// @return The algorithm 6 plan of this stage
+    virtual const alg_plan& plan() const = 0;
+
+    /**
+     *  @brief Prepare the plan of this stage
+     *  @param[in] width Image width
+     *  @param[in] height Image height
+     *  @param[in] first Flag of the first stage (owning the input array)
+     *  @param[in] stream Stream to launch kernels on
+     */
+    virtual void prepare( int width, int height, bool first,
+                          cudaStream_t stream ) = 0;
+
+    /// Run the step 1 of this stage (reading the input texture)
+    virtual void step1() = 0;
+
+    /// Run the steps 2, 3 and 4 of this stage
+    virtual void step2v3v4() = 0;
+
+    /**
+     *  @brief Run the step 5 of this stage (fusioned with the step 1 of the next)
+     *  @param[in] prev Previous stage (zero means the input texture)
+     *  @param[in,out] next Next stage (zero means the last stage)
+     */
+    virtual void step5( const cascade_stage *prev,
+                        cascade_stage *next ) = 0;
+
+};
+
+/**
+ *  @struct alg6_cascade_stage alg6_cascade_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Cascade stage of order R
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_cascade_stage : public cascade_stage {
+
+    Vector<float,R+1> w; ///< Filter weights
+    alg6_plan<false,R> p; ///< Algorithm 6 plan of this stage
+
+    /**
+     *  Constructor
+     *  @param[in] _w Filter weights
+     */
+    alg6_cascade_stage( const Vector<float,R+1>& _w ) : cascade_stage(R), w(_w) { }
+
+    alg_plan& plan() { return p; }
+
+    const alg_plan& plan() const { return p; }
+
+    void prepare( int width, int height, bool first,
+                  cudaStream_t stream ) {
+        prepare_alg6(p, width, height, w);
+        p.stream = stream;
+        if (!first) { // input is the output of the previous stage
+            cudaDestroyTextureObject(p.tex_in);
+            cudaFreeArray(p.a_in);
+            p.tex_in = 0;
+            p.a_in = 0;
+        }
+    }
+
+    void step1() {
+        launch_alg5v6_step1<false>(p, &p.d_pybar, &p.d_ezhat,
+                                   &p.d_ptucheck, &p.d_etvtilde, p.params);
+    }
+
+    void step2v3v4() {
+        alg3v4v5v6_step2v4<<< dim3(1, p.n_size), dim3(WS, NWA), 0, p.stream >>>
+            ( &p.d_pybar, &p.d_ezhat, p.params, p.m_size );
+        alg6_step3<<< dim3(p.m_size, p.n_size), dim3(WS, NWARC), 0, p.stream >>>
+            ( &p.d_ptucheck, &p.d_etvtilde, &p.d_pybar, &p.d_ezhat,
+              &p.d_cmat, p.params, p.m_size, p.n_size );
+        alg3v4v5v6_step2v4<<< dim3(1, p.m_size), dim3(WS, NWA), 0, p.stream >>>
+            ( &p.d_ptucheck, &p.d_etvtilde, p.params, p.n_size );
+    }
+
+    void step5( const cascade_stage *prev,
+                cascade_stage *next ) {
+        switch (next ? next->order : 0) {
+        case 1: launch_step5(prev, (alg6_cascade_stage<1>*)next); break;
+        case 2: launch_step5(prev, (alg6_cascade_stage<2>*)next); break;
+        case 3: launch_step5(prev, (alg6_cascade_stage<3>*)next); break;
+        case 4: launch_step5(prev, (alg6_cascade_stage<4>*)next); break;
+        case 5: launch_step5(prev, (alg6_cascade_stage<5>*)next); break;
+        default: launch_step5(prev, (alg6_cascade_stage<R>*)0);
+        }
+    }
+
+    /**
+     *  @brief Launch the step 5 of this stage given the next stage order
+     *  @param[in] prev Previous stage (zero means the input texture)
+     *  @param[in,out] next Next stage (zero means the last stage)
+     *  @tparam R2 Filter order of the next stage
+     */
+    template <int R2>
+    void launch_step5( const cascade_stage *prev,
+                       alg6_cascade_stage<R2> *next ) {
+        dim3 grid(p.m_size, p.n_size), block(WS, NWW);
+        const float *d_in = prev ? &prev->plan().d_img : 0;
+        int in_stride = prev ? prev->plan().stride_img : 0;
+        Matrix<float,R2,WS> *d_pybar = 0, *d_ezhat = 0,
+            *d_ptucheck = 0, *d_etvtilde = 0;
+        Vector<float,R2+1> w2 = zeros<float,R2+1>();
+        if (next) {
+            d_pybar = &next->p.d_pybar;
+            d_ezhat = &next->p.d_ezhat;
+            d_ptucheck = &next->p.d_ptucheck;
+            d_etvtilde = &next->p.d_etvtilde;
+            w2 = next->w;
+        }
+#define ALG6_CASCADE_STEP5(first, fuse)                                 \
+        alg6_cascade_step5<first, fuse, R, R2><<< grid, block, 0, p.stream >>> \
+            ( p.tex_in, d_in, in_stride, &p.d_img,                      \
+              &p.d_pybar, &p.d_ezhat, &p.d_ptucheck, &p.d_etvtilde, p.params, \
+              d_pybar, d_ezhat, d_ptucheck, d_etvtilde, w2,             \
+              p.inv_width, p.inv_height, p.width, p.height,             \
+              p.m_size, p.n_size, p.stride_img )
+        if (!prev && next) ALG6_CASCADE_STEP5(true, true);
+        else if (!prev) ALG6_CASCADE_STEP5(true, false);
+        else if (next) ALG6_CASCADE_STEP5(false, true);
+        else ALG6_CASCADE_STEP5(false, false);
+#undef ALG6_CASCADE_STEP5
+    }
+
+};
+
+/**
+ *  @struct alg6_cascade_plan alg6_cascade_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of a cascade of algorithm 6 filters fusioned in one pipeline
+ *
+ *  An ordered list of recursive filters (each of any order from 1 to
+ *  5 and its own weights) is applied one after the other on the same
+ *  image with zero boundary, generalizing algorithm 5 fusioned with
+ *  algorithm 4 (see alg5f4_gpu()).  Neighbour stages are fusioned:
+ *  the last step of one stage computes the first step of the next on
+ *  the output block still in shared memory, thus the step 1 of all
+ *  but the first stage does not re-read the intermediate image.  The
+ *  intermediate images stay in device memory, read from global
+ *  memory by the next stage (only the first stage has an input
+ *  array).  All stages run on the plan stream, and the kernels of
+ *  all stages are captured in one graph when enabled (see
+ *  plan_graph).
+ */
+struct alg6_cascade_plan {
+
+    int width, height; ///< Image width and height
+    cudaStream_t stream; ///< Stream to launch kernels on (default stream)
+    std::vector<cascade_stage*> stages; ///< Ordered list of stages
+    plan_graph graph; ///< CUDA Graph replaying all stages (off by default)
+
+    /// Default constructor
+    alg6_cascade_plan() : width(0), height(0), stream(0) { }
+
+    /// Destructor
+    ~alg6_cascade_plan() {
+        release();
+    }
+
+    /// Release all stages
+    void release() {
+        for (size_t k = 0; k < stages.size(); ++k)
+            delete stages[k];
+        stages.clear();
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    alg6_cascade_plan( const alg6_cascade_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    alg6_cascade_plan& operator = ( const alg6_cascade_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Add one stage at the end of a cascade plan
+ *
+ *  Stages are added before preparing the plan, see
+ *  prepare_alg6_cascade().
+ *
+ *  @param[in,out] plan The cascade plan
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void add_stage( alg6_cascade_plan& plan,
+                const Vector<float, R+1>& w ) {
+    plan.stages.push_back(new alg6_cascade_stage<R>(w));
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Add one stage at the end of a cascade plan
+ *  @overload
+ *  @param[in,out] plan The cascade plan
+ *  @param[in] w Filter weights (R plus one coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void add_stage( alg6_cascade_plan& plan,
+                const float *w ) {
+    Vector<float,R+1> v;
+    for (int i = 0; i <= R; ++i)
+        v[i] = w[i];
+    add_stage<R>(plan, v);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Add one stage of run-time order at the end of a cascade plan
+ *  @param[in,out] plan The cascade plan
+ *  @param[in] order Filter order (1 to 5)
+ *  @param[in] w Filter weights (order plus one coefficients)
+ */
+inline void add_stage( alg6_cascade_plan& plan,
+                       int order,
+                       const float *w ) {
+    switch (order) {
+    case 1: add_stage<1>(plan, w); break;
+    case 2: add_stage<2>(plan, w); break;
+    case 3: add_stage<3>(plan, w); break;
+    case 4: add_stage<4>(plan, w); break;
+    case 5: add_stage<5>(plan, w); break;
+    default: throw std::runtime_error("Cascade stage order must be from 1 to 5");
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the cascade plan in the GPU
+ *
+ *  Prepares the algorithm 6 plan of each stage already added to the
+ *  cascade, see add_stage().
+ *
+ *  @param[in,out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ */
+inline void prepare_alg6_cascade( alg6_cascade_plan& plan,
+                                  int width, int height ) {
+    if (plan.stages.empty())
+        throw std::runtime_error("Cascade plan without stages");
+    plan.graph.reset(); // sizes and buffers change, capture again
+    plan.width = width;
+    plan.height = height;
+    for (size_t k = 0; k < plan.stages.size(); ++k)
+        plan.stages[k]->prepare(width, height, k == 0, plan.stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run the cascade plan in the GPU
+ *
+ *  The plan input (of the first stage) is filtered by all stages to
+ *  the plan output (of the last stage) in device memory, see upload()
+ *  and download().
+ *
+ *  @param[in,out] plan The plan to run
+ */
+inline void alg6_cascade_gpu( alg6_cascade_plan& plan ) {
+    const size_t K = plan.stages.size();
+    if (plan.graph.enabled) { // replay the kernels of all stages
+        if (!plan.graph.exec) {
+            cudaStream_t capture = begin_graph(plan.stream);
+            for (size_t k = 0; k < K; ++k)
+                plan.stages[k]->plan().stream = capture;
+            plan.graph.enabled = false; // launch the kernels being captured
+            alg6_cascade_gpu(plan);
+            plan.graph.enabled = true;
+            for (size_t k = 0; k < K; ++k)
+                plan.stages[k]->plan().stream = plan.stream;
+            end_graph(plan.graph, capture, plan.stream);
+        }
+        cudaGraphLaunch(plan.graph.exec, plan.stream);
+        return;
+    }
+    plan.stages[0]->step1();
+    for (size_t k = 0; k < K; ++k) {
+        plan.stages[k]->step2v3v4();
+        plan.stages[k]->step5(k > 0 ? plan.stages[k-1] : 0,
+                              k+1 < K ? plan.stages[k+1] : 0);
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload an input image in host memory to the cascade plan
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] h_img The input 2D image in host memory
+ */
+inline void upload( alg6_cascade_plan& plan,
+                    const float *h_img ) {
+    upload(plan.stages.front()->plan(), h_img);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the cascade plan output image to host memory
+ *  @param[in] plan The plan with the output image
+ *  @param[out] h_img The output 2D image in host memory
+ */
+inline void download( const alg6_cascade_plan& plan,
+                      float *h_img ) {
+    download(plan.stages.back()->plan(), h_img);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute a cascade of algorithm 6 filters in the GPU
+ *  @see alg5f4_gpu()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in,out] plan The cascade plan with its stages added (prepared here)
+ */
+inline void alg6_cascade_gpu( float *h_img,
+                              int width, int height, int runtimes,
+                              alg6_cascade_plan& plan ) {
+
+    prepare_alg6_cascade(plan, width, height);
+
+    upload(plan, h_img);
+
+    base_timer &timer_total = timers.gpu_add("alg6_cascade_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_cascade_gpu(plan);
+
+    timer_total.stop();
+
+    if (runtimes > 1) {
+
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+
+    } else {
+
+        timers.flush();
+
+    }
+
+    download(plan, h_img);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_CASCADE_GPU_CUH
+//==============================================================================
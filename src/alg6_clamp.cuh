@@ -25,29 +25,36 @@ namespace gpufilter {
  *  @see The base algorithm description in alg6_stage1()
  *
  *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
  *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights)
  *  @param[in] inv_width Image width inversed (1/w)
  *  @param[in] inv_height Image height inversed (1/h)
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] clamp_rows Flag to store the clamp carries of rows (see alg6_axes())
+ *  @param[in] clamp_cols Flag to store the clamp carries of columns (see alg6_axes())
  *  @tparam R Filter order
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar, 
+void alg6_clamp_stage1( cudaTextureObject_t tex,
+                        Matrix<float,R,WS> *g_pybar, 
                         Matrix<float,R,WS> *g_ezhat,
                         Matrix<float,R,WS> *g_ptucheck,
                         Matrix<float,R,WS> *g_etvtilde,
+                        const filter_params<R> params,
                         float inv_width, float inv_height,
-                        int m_size, int n_size ) {
+                        int m_size, int n_size,
+                        bool clamp_rows=true, bool clamp_cols=true ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWC>(block, m, n, inv_width, inv_height);
+    read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32]; // 32 regs
@@ -58,11 +65,11 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
         for (int i=0; i<32; ++i)
             x[i] = block[tx][i];
 
-        if (m == 0) { // store p(x) in pybar_0
+        if (clamp_rows && m == 0) { // store p(x) in pybar_0
 #pragma unroll
             for (int j=0; j<R; ++j)
                 g_pybar[n*(m_size+1)+0][j][tx] = x[0];
-        } else if (m == m_size-1) { // store e(x) in ezhat_M
+        } else if (clamp_rows && m == m_size-1) { // store e(x) in ezhat_M
 #pragma unroll
             for (int j=0; j<R; ++j)
                 g_ezhat[n*(m_size+1)+m_size][j][tx] = x[WS-1];
@@ -72,7 +79,7 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate pybar, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
         g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
         
@@ -80,7 +87,7 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ezhat, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, params.weights);
 
         g_ezhat[n*(m_size+1)+m].set_col(tx, e);
 
@@ -91,11 +98,11 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
         for (int i=0; i<32; ++i)
             x[i] = block[i][tx];
 
-        if (n == 0) { // store pt(zhat) in ptucheck_0
+        if (clamp_cols && n == 0) { // store pt(zhat) in ptucheck_0
 #pragma unroll
             for (int j=0; j<R; ++j)
                 g_ptucheck[m*(n_size+1)+0][j][tx] = x[0];
-        } else if (n == n_size-1) { // store et(zhat) in etvtilde_M
+        } else if (clamp_cols && n == n_size-1) { // store et(zhat) in etvtilde_M
 #pragma unroll
             for (int j=0; j<R; ++j)
                 g_etvtilde[m*(n_size+1)+n_size][j][tx] = x[WS-1];
@@ -105,7 +112,7 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ptucheck, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
         g_ptucheck[m*(n_size+1)+n+1].set_col(tx, p);
 
@@ -113,7 +120,7 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate etvtilde, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            revI(x[j], e, c_weights);
+            revI(x[j], e, params.weights);
 
         g_etvtilde[m*(n_size+1)+n].set_col(tx, e);
 
@@ -135,6 +142,8 @@ void alg6_clamp_stage1( Matrix<float,R,WS> *g_pybar,
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
  *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] bparams Carry matrices of the exact boundaries
  *  @param[in] m_size The big M or N
  *  @tparam R Filter order
  */
@@ -142,6 +151,8 @@ template <int R>
 __global__ __launch_bounds__(WS*NWA, NBA)
 void alg6_clamp_stage2v4( Matrix<float,R,WS> *g_pybar,
                           Matrix<float,R,WS> *g_ezhat,
+                          const filter_params<R> params,
+                          const border_params<R> bparams,
                           int m_size ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m, n = blockIdx.y;
@@ -156,7 +167,7 @@ void alg6_clamp_stage2v4( Matrix<float,R,WS> *g_pybar,
 
         gpybar = (Matrix<float,R,WS> *)&g_pybar[n*(m_size+1)+m][0][tx];
         py = gpybar->col(0);
-        py = py * c_AbarFIArF_T;
+        py = py * bparams.AbarFIArF_T;
         gpybar->set_col(0, py);
 
     }
@@ -178,7 +189,7 @@ void alg6_clamp_stage2v4( Matrix<float,R,WS> *g_pybar,
 
                 pybar = spybar[w].col(tx);
 
-                py = pybar + py * c_AbF_T;
+                py = pybar + py * params.AbF_T;
 
                 spybar[w].set_col(tx, py);
 
@@ -200,7 +211,7 @@ void alg6_clamp_stage2v4( Matrix<float,R,WS> *g_pybar,
 
         gezhat = (Matrix<float,R,WS> *)&g_ezhat[n*(m_size+1)+m+1][0][tx];
         ez = gezhat->col(0);
-        ez = py * c_ArFSRRF_T + ez * c_AbarFIArFAbarRIArRArFSRRF_T;
+        ez = py * bparams.ArFSRRF_T + ez * bparams.AbarFIArFAbarRIArRArFSRRF_T;
         gezhat->set_col(0, ez);
 
     }
@@ -225,7 +236,7 @@ void alg6_clamp_stage2v4( Matrix<float,R,WS> *g_pybar,
                 ezhat = sezhat[w].col(tx);
                 py = spybar[w].col(tx);
 
-                ez = ezhat + py * c_HARB_AFP_T + ez * c_AbR_T;
+                ez = ezhat + py * params.HARB_AFP_T + ez * params.AbR_T;
 
                 sezhat[w].set_col(tx, ez);
 
@@ -260,6 +271,7 @@ void alg6_clamp_stage2v4( Matrix<float,R,WS> *g_pybar,
  *  @param[in] g_cmat Constant pre-computed matrices
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] clamp_cols Flag to fix the clamp carries of columns (see alg6_axes())
  *  @tparam R Filter order
  */
 template <int R>
@@ -269,7 +281,8 @@ void alg6_clamp_stage3( Matrix<float,R,WS> *g_ptucheck,
                         const Matrix<float,R,WS> *g_py,
                         const Matrix<float,R,WS> *g_ez,
                         const Matrix<float,R,WS> *g_cmat,
-                        int m_size, int n_size ) {
+                        int m_size, int n_size,
+                        bool clamp_cols=true ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
     Matrix<float,R,WS> *gptuetv;
@@ -307,7 +320,7 @@ void alg6_clamp_stage3( Matrix<float,R,WS> *g_ptucheck,
 
     if (ty == 0) {
 
-        if (n == 0) {
+        if (clamp_cols && n == 0) {
 
 #pragma unroll
             for (int r=0; r<R; ++r)
@@ -331,7 +344,7 @@ void alg6_clamp_stage3( Matrix<float,R,WS> *g_ptucheck,
 
     } else if (ty == 1) {
 
-        if (n == n_size-1) {
+        if (clamp_cols && n == n_size-1) {
 
 #pragma unroll
             for (int r=0; r<R; ++r)
@@ -379,11 +392,13 @@ void alg6_clamp_stage3( Matrix<float,R,WS> *g_ptucheck,
  *  @see The base algorithm description in alg6_stage5()
  *
  *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
  *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
  *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights)
  *  @param[in] inv_width Image width inversed (1/w)
  *  @param[in] inv_height Image height inversed (1/h)
  *  @param[in] m_size The big M (number of row blocks)
@@ -393,11 +408,13 @@ void alg6_clamp_stage3( Matrix<float,R,WS> *g_ptucheck,
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg6_clamp_stage5( float *g_out,
+void alg6_clamp_stage5( cudaTextureObject_t tex,
+                        float *g_out,
                         const Matrix<float,R,WS> *g_py,
                         const Matrix<float,R,WS> *g_ez,
                         const Matrix<float,R,WS> *g_ptu,
                         const Matrix<float,R,WS> *g_etv,
+                        const filter_params<R> params,
                         float inv_width, float inv_height,
                         int m_size, int n_size,
                         int out_stride ) {
@@ -405,7 +422,7 @@ void alg6_clamp_stage5( float *g_out,
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWW>(block, m, n, inv_width, inv_height);
+    read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32];
@@ -424,14 +441,14 @@ void alg6_clamp_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
         for (int r=0; r<R; ++r)
             e[r] = __ldg((const float *)&g_ez[n*(m_size+1)+m+1][r][tx]);
 
 #pragma unroll // calculate block, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, params.weights);
 
 #pragma unroll // tranpose regs part-1
         for (int i=0; i<32; ++i)
@@ -446,7 +463,7 @@ void alg6_clamp_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
 #pragma unroll
         for (int r=0; r<R; ++r)
@@ -454,7 +471,7 @@ void alg6_clamp_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, params.weights);
 
         g_out += ((n+1)*WS-1)*out_stride + m*WS+tx;
 #pragma unroll // write block
@@ -466,44 +483,37 @@ void alg6_clamp_stage5( float *g_out,
 }
 
 /**
+ *  @struct alg6_clamp_plan alg6_clamp.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm 6 for clamp in the GPU
+ *  @brief Filter plan of algorithm 6 for clamp
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_clamp_plan : public alg5v6_plan<R> {
+    border_params<R> bparams; ///< Clamp carry matrices passed to kernels
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Pre-compute the clamp carry matrices of a plan
  *
- *  @see [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] h_img The in/output 2D image to compute recursive filtering in host memory
- *  @param[in] width Image width
- *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  The clamp matrices do not depend on the image size, thus they are
+ *  the same for rows and columns.
+ *
+ *  @param[in,out] plan The plan (with the filter matrices) to store the matrices in
  *  @param[in] w Filter weights (feedforward and feedback coefficients)
  *  @tparam R Filter order
+ *  @tparam P Plan type (with the clamp carry matrices)
  */
-template <int R>
+template <int R, class P>
 __host__
-void alg6_clamp( float *h_img,
-                 const int& width, const int& height, const int& runtimes,
-                 const Vector<float, R+1>& w ) {
-
-    const int B = WS;
+void prepare_clamp_matrices( P& plan,
+                             const Vector<float, R+1>& w ) {
 
-    // pre-compute basic alg5 matrices
     Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
-
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w), ARE_T = rev(Zrb, Ir, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w), ARB_T = rev(Ib, Zbr, w);
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T), AbR_T = head<R>(ARE_T);
-    Matrix<float,R,R> AbF = transp(AbF_T), AbR = transp(AbR_T);
-    Matrix<float,R,R> HARB_AFP_T = AFP_T*head<R>(ARB_T);
-    Matrix<float,R,R> HARB_AFP = transp(HARB_AFP_T);
-    Matrix<float,R,B> ARB_AFP_T = AFP_T*ARB_T, TAFB = transp(tail<R>(AFB_T));
-    Matrix<float,R,B> HARB_AFB = transp(AFB_T*head<R>(ARB_T));
-
-    const int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
 
     // pre-compute clamp matrices
-    Matrix<float,R,R> ArF_T = head<R>(AFP_T), AbarF_T;
+    Matrix<float,R,R> ArF_T = head<R>(plan.mat.AFP_T), AbarF_T;
     
     for (int i=0; i<R; ++i) {
         int j;
@@ -541,49 +551,31 @@ void alg6_clamp( float *h_img,
                 SRRF_T[i][j] = b[R*i+j];
     }
 
-    Matrix<float,R,R> AbarFIArF_T = AbarF_T * IArF_T;
-    Matrix<float,R,R> ArFSRRF_T = ArF_T * SRRF_T;
-    Matrix<float,R,R> AbarFIArFAbarRIArRArFSRRF_T = AbarF_T * IArF_T * ( AbarR_T * IArR_T - ArF_T * SRRF_T );
-
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AbR_T, AbR_T);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T);
-
-    copy_to_symbol(c_ARE_T, ARE_T);
-    copy_to_symbol(c_ARB_AFP_T, ARB_AFP_T);
-    copy_to_symbol(c_TAFB, TAFB);
-    copy_to_symbol(c_HARB_AFB, HARB_AFB);
+    plan.bparams.AbarFIArF_T = AbarF_T * IArF_T;
+    plan.bparams.ArFSRRF_T = ArF_T * SRRF_T;
+    plan.bparams.AbarFIArFAbarRIArRArFSRRF_T = AbarF_T * IArF_T * ( AbarR_T * IArR_T - ArF_T * SRRF_T );
 
-    copy_to_symbol(c_AbarFIArF_T, AbarFIArF_T);
-    copy_to_symbol(c_ArFSRRF_T,  ArFSRRF_T);
-    copy_to_symbol(c_AbarFIArFAbarRIArRArFSRRF_T, AbarFIArFAbarRIArRArFSRRF_T);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
+}
 
-    int stride_img = width+WS;
-    dvector<float> d_img(height*stride_img);
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 for clamp plan in the GPU
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void prepare_alg6_clamp( alg6_clamp_plan<R>& plan,
+                         const int& width, const int& height,
+                         const Vector<float, R+1>& w ) {
 
-    dvector< Matrix<float,R,B> > d_pybar((m_size+1)*n_size), d_ezhat((m_size+1)*n_size);
-    dvector< Matrix<float,R,B> > d_ptucheck((n_size+1)*m_size), d_etvtilde((n_size+1)*m_size);
-    d_pybar.fillzero();
-    d_ezhat.fillzero();
-    d_ptucheck.fillzero();
-    d_etvtilde.fillzero();
+    prepare_alg5v6(plan, width, height, w, 0, CLAMP_TO_EDGE, false);
 
-    Matrix<float,R,B> h_cmat[4] = { ARE_T, ARB_AFP_T, TAFB, HARB_AFB };
-    dvector< Matrix<float,R,B> > d_cmat(h_cmat, 4);
+    prepare_clamp_matrices<R>(plan, w);
 
     cudaFuncSetCacheConfig(alg6_clamp_stage1<R>, cudaFuncCachePreferShared);
     cudaFuncSetCacheConfig(alg6_clamp_stage5<R>, cudaFuncCachePreferShared);
@@ -596,66 +588,117 @@ void alg6_clamp( float *h_img,
     else if (R >= 3)
         cudaFuncSetCacheConfig(alg6_clamp_stage2v4<R>, cudaFuncCachePreferShared);
 
-    double te[5] = {0, 0, 0, 0, 0}; // time elapsed for the five stages
-    base_timer *timer[5];
-    for (int i = 0; i < 5; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+}
 
-    base_timer &timer_total = timers.gpu_add("alg6_clamp", width*height, "iP");
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 for clamp plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional five timers to measure each stage
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void alg6_clamp( alg6_clamp_plan<R>& plan,
+                 base_timer **timer=0 ) {
 
-    for(int r = 0; r < runtimes; ++r) {
+    check_whole_output(plan);
 
-        if (runtimes == 1) { timer[0]->start(); }
+    if (!timer && launch_graph(plan, alg6_clamp<R>))
+        return; // replayed the captured kernels (see plan_graph)
 
-        cudaBindTextureToArray(t_in, a_in);
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
-        alg6_clamp_stage1<<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size );
+    if (timer) timer[0]->start();
 
-        if (runtimes == 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    alg6_clamp_stage1<<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size );
 
-        alg6_clamp_stage2v4<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar, &d_ezhat, m_size );
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-        if (runtimes == 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    alg6_clamp_stage2v4<<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pybar, &plan.d_ezhat, plan.params, plan.bparams, m_size );
 
-        alg6_clamp_stage3<<< dim3(m_size, n_size), dim3(WS, NWARC) >>>
-            ( &d_ptucheck, &d_etvtilde, &d_pybar, &d_ezhat, &d_cmat, m_size, n_size );
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-        if (runtimes == 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+    alg6_clamp_stage3<<< dim3(m_size, n_size), dim3(WS, NWARC), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_cmat, m_size, n_size );
 
-        alg6_clamp_stage2v4<<< dim3(1, m_size), dim3(WS, NWA) >>>
-            ( &d_ptucheck, &d_etvtilde, n_size );
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        if (runtimes == 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); timer[4]->start(); }
+    alg6_clamp_stage2v4<<< dim3(1, m_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, plan.params, plan.bparams, n_size );
 
-        alg6_clamp_stage5<<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size, stride_img );
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
 
-        cudaUnbindTexture(t_in);
+    alg6_clamp_stage5<<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size, plan.stride_img );
 
-        if (runtimes == 1) { timer[4]->stop(); te[4] += timer[4]->elapsed(); }
+    if (timer) timer[4]->stop();
 
-    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 for clamp in the GPU
+ *
+ *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in/output 2D image to compute recursive filtering in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void alg6_clamp( float *h_img,
+                 const int& width, const int& height, const int& runtimes,
+                 const Vector<float, R+1>& w ) {
+
+    alg6_clamp_plan<R> plan;
+    prepare_alg6_clamp(plan, width, height, w);
+
+    upload(plan, h_img);
+
+    const char *steps[5] = { "stage 1", "stage 2", "stage 3", "stage 4", "stage 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i)
+        timer[i] = new step_timer(std::string("alg6_clamp ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg6_clamp", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_clamp(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 5; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        if (timed) {
+            for (int i = 0; i < 5; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
 
     } else {
 
-        timers.gpu_add("stage 1", timer[0]);
-        timers.gpu_add("stage 2", timer[1]);
-        timers.gpu_add("stage 3", timer[2]);
-        timers.gpu_add("stage 4", timer[3]);
-        timers.gpu_add("stage 5", timer[4]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
@@ -0,0 +1,129 @@
+/**
+ *  @file alg6_cpu.cu
+ *  @brief Algorithm 6 in the CPU (many-core) versus in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_cpu_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "refcheck.cuh"
+#include "alg6_cpu.h"
+#include "alg6_gpu.cuh"
+#include "alg6_clamp.cuh"
+#include "alg6_repeat.cuh"
+#include "alg6_reflect.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 in the GPU with the given boundary condition
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam R Filter order
+ */
+template<int R>
+void alg6( float *h_img,
+           const int& width, const int& height, const int& runtimes,
+           const gpufilter::Vector<float, R+1>& w,
+           const gpufilter::BorderType& btype ) {
+    if (btype == gpufilter::CLAMP_TO_ZERO)
+        gpufilter::alg6_gpu<false, R>(h_img, width, height, runtimes, w);
+    else if (btype == gpufilter::CLAMP_TO_EDGE)
+        gpufilter::alg6_clamp<R>(h_img, width, height, runtimes, w);
+    else if (btype == gpufilter::REPEAT)
+        gpufilter::alg6_repeat<R>(h_img, width, height, runtimes, w);
+    else if (btype == gpufilter::REFLECT)
+        gpufilter::alg6_reflect<R>(h_img, width, height, runtimes, w);
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, alg6_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, alg6_img, w, a0border, me, mre,
+                  argc, argv);
+
+    // the boundary conditions are computed exactly, no border blocks
+    border = 0;
+    gpu_img = alg6_img;
+
+    if (runtimes == 1) // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+
+    gpufilter::alg0_cached<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+
+    if (runtimes > 1) // CPU and GPU throughputs side by side
+        std::cout << APPNAME << " [cpu-MiP/s] [gpu-MiP/s]: ";
+
+    gpufilter::alg6_cpu<ORDER>(&alg6_img[0], width, height, runtimes, w, btype);
+
+    if (runtimes > 1)
+        std::cout << " ";
+
+    // the result is checked in the GPU before its download (see gpu_reference)
+    gpufilter::gpu_reference ref( &cpu_img[0], width, height );
+
+    alg6<ORDER>(&gpu_img[0], width, height, runtimes, w, btype);
+
+    if (runtimes > 1)
+        std::cout << "\n";
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &alg6_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error] cpu:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    ref.check( &gpu_img[0], me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error] gpu:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,543 @@
+/**
+ *  @file alg6_cpu.h
+ *  @brief Algorithm 6 in the CPU (block-parallel on many cores)
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_CPU_H
+#define ALG6_CPU_H
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <vector>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <util/image.h>
+#include <util/linalg.h>
+#include <util/recfilter.h>
+#include <util/timer.h>
+
+#include "cpupool.h"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg6_cpu_mats alg6_cpu.h
+ *  @ingroup api_cpu
+ *  @brief Carry matrices of one block length (along rows or columns)
+ *
+ *  The carries are row vectors as in the GPU plans: a carry \f$P\f$
+ *  entering a block goes out as \f$P A_F\f$ after the block (causal),
+ *  an epilogue \f$E\f$ goes out as \f$E A_R\f$ (anticausal), and the
+ *  causal carry \f$P\f$ entering a block adds \f$P H\f$ to the
+ *  anticausal carry going out of it.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_cpu_mats {
+    Matrix<float,R,R> AF, AR, H; ///< Block forward, reverse and cross matrices
+};
+
+/**
+ *  @struct alg6_cpu_axis alg6_cpu.h
+ *  @ingroup api_cpu
+ *  @brief Blocked sequences of one filtering axis (rows or columns)
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_cpu_axis {
+    int length; ///< Length of each sequence (image width or height)
+    int count; ///< Number of sequences (image height or width)
+    int elem_stride; ///< Distance between consecutive sequence elements
+    int seq_stride; ///< Distance between consecutive sequences
+    int blocks; ///< Number of blocks of each sequence
+    int vblocks; ///< Number of virtual blocks (twice for reflect)
+    alg6_cpu_mats<R> full, last; ///< Matrices of full and last blocks
+    Matrix<float,R,R> IGF, IGR; ///< Periodic inverse matrices (repeat and reflect)
+    Matrix<float,R,R> CT; ///< Tail matrix (zero padding to 32 or clamp)
+    std::vector< Vector<float,R> > pc, ec; ///< Causal and anticausal carries
+
+    /**
+     *  @brief Carry slot of a virtual block of a sequence
+     *
+     *  Block-major, thus the tasks of different blocks do not write
+     *  to the same cache lines.
+     *
+     *  @param[in] v The slot (virtual block) index
+     *  @param[in] s The sequence index
+     *  @return The carry index
+     */
+    size_t slot( int v, int s ) const { return (size_t)v*count + s; }
+};
+
+/**
+ *  @struct alg6_cpu_plan alg6_cpu.h
+ *  @ingroup api_cpu
+ *  @brief Filter plan of algorithm 6 in the CPU
+ *
+ *  The image is split in b x b blocks as in the GPU, and each axis
+ *  runs the three block-parallel steps of algorithm 6 on its own:
+ *  the carries of each block alone, the fix of the carries along
+ *  each sequence (the only sequential step, over blocks not pixels)
+ *  and the output of each block from its fixed carries.  The steps
+ *  run on a work-stealing pool (see cpu_pool).
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_cpu_plan {
+
+    int width, height; ///< Image width and height
+    int b; ///< Block size (b x b pixels)
+    BorderType btype; ///< Border type (either zero, clamp, repeat or reflect)
+    Vector<float,R+1> w; ///< Filter weights
+    float gain; ///< Steady-state gain of each causal or anticausal filter
+    alg6_cpu_axis<R> rows, cols; ///< Blocked rows and columns
+    cpu_pool *pool; ///< Work-stealing thread pool
+    float *img; ///< Image being filtered (in-place)
+
+    /// Default constructor
+    alg6_cpu_plan() : width(0), height(0), b(64), btype(CLAMP_TO_ZERO),
+                      gain(0.f), pool(0), img(0) { }
+
+    /// Destructor
+    ~alg6_cpu_plan() { delete pool; }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    alg6_cpu_plan( const alg6_cpu_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    alg6_cpu_plan& operator = ( const alg6_cpu_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute the carry matrices of a block length
+ *
+ *  Each row of a matrix is the response of the block (with zero
+ *  input) to one unit carry.
+ *
+ *  @param[out] mats The carry matrices
+ *  @param[in] len The block length
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void calc_alg6_cpu_mats( alg6_cpu_mats<R>& mats,
+                         int len,
+                         const Vector<float,R+1>& w ) {
+    std::vector<float> y(len);
+    for (int r = 0; r < R; ++r) {
+        Vector<float,R> p = zeros<float,R>(), e = zeros<float,R>();
+        p[r] = 1.f;
+        for (int k = 0; k < len; ++k)
+            y[k] = fwd(p, 0.f, w);
+        mats.AF[r] = p;
+        for (int k = len-1; k >= 0; --k)
+            rev(y[k]*w[0], e, w);
+        mats.H[r] = e;
+        e = zeros<float,R>();
+        e[r] = 1.f;
+        for (int k = 0; k < len; ++k)
+            rev(0.f, e, w);
+        mats.AR[r] = e;
+    }
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute the tail matrix of the zero or clamp boundary
+ *
+ *  The epilogue entering the last block from the extension after it
+ *  is the response of the causal carry leaving the last block over
+ *  the tail: for zero, the padding of the sequence length to 32 (as
+ *  alg0_cpu() and the GPU algorithms); for clamp, the infinite
+ *  constant extension, i.e. the steady state plus the transient of
+ *  the carry minus its steady state, filtered until it vanishes.
+ *
+ *  @param[out] CT The tail matrix
+ *  @param[in] length Length of each sequence
+ *  @param[in] btype Border type (either zero or clamp)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+void calc_alg6_cpu_tail( Matrix<float,R,R>& CT,
+                         int length,
+                         BorderType btype,
+                         const Vector<float,R+1>& w ) {
+    alg6_cpu_mats<R> tail;
+    if (btype == CLAMP_TO_ZERO) {
+        CT = zeros<float,R,R>();
+        if (length%32 > 0) {
+            calc_alg6_cpu_mats(tail, 32-length%32, w);
+            CT = tail.H;
+        }
+        return;
+    }
+    int len = 32;
+    for (;;) { // tail length until all transients vanish
+        Vector<float,R> p = zeros<float,R>();
+        for (int r = 0; r < R; ++r) p[r] = 1.f;
+        for (int k = 0; k < len; ++k) fwd(p, 0.f, w);
+        float m = 0.f;
+        for (int r = 0; r < R; ++r) m = std::max(m, std::fabs(p[r]));
+        if (m < 1e-9f || len >= (1<<20)) break;
+        len *= 2;
+    }
+    len *= 2; // the anticausal transient decays as much after it
+    calc_alg6_cpu_mats(tail, len, w);
+    CT = tail.H;
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Prepare one filtering axis of an algorithm 6 plan in the CPU
+ *  @param[in,out] plan The plan with the axis
+ *  @param[out] axis The axis to prepare
+ *  @param[in] length Length of each sequence
+ *  @param[in] count Number of sequences
+ *  @param[in] elem_stride Distance between consecutive sequence elements
+ *  @param[in] seq_stride Distance between consecutive sequences
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg6_cpu_axis( alg6_cpu_plan<R>& plan,
+                            alg6_cpu_axis<R>& axis,
+                            int length, int count,
+                            int elem_stride, int seq_stride ) {
+
+    axis.length = length;
+    axis.count = count;
+    axis.elem_stride = elem_stride;
+    axis.seq_stride = seq_stride;
+    axis.blocks = (length+plan.b-1)/plan.b;
+    axis.vblocks = plan.btype == REFLECT ? 2*axis.blocks : axis.blocks;
+
+    calc_alg6_cpu_mats(axis.full, plan.b, plan.w);
+    calc_alg6_cpu_mats(axis.last, length-(axis.blocks-1)*plan.b, plan.w);
+
+    // whole period of the virtual sequence (the image reflected for reflect)
+    Matrix<float,R,R> GF = identity<float,R,R>(), GR = identity<float,R,R>();
+    for (int i = 0; i < axis.vblocks; ++i) {
+        int m = i < axis.blocks ? i : axis.vblocks-1-i;
+        const alg6_cpu_mats<R>& mats = m == axis.blocks-1 ? axis.last : axis.full;
+        GF = GF * mats.AF;
+        GR = mats.AR * GR;
+    }
+    axis.IGF = inv(identity<float,R,R>() - GF);
+    axis.IGR = inv(identity<float,R,R>() - GR);
+
+    if (plan.btype == CLAMP_TO_ZERO || plan.btype == CLAMP_TO_EDGE)
+        calc_alg6_cpu_tail(axis.CT, length, plan.btype, plan.w);
+
+    // slot 0 of causal carries is the prologue, slot vblocks of
+    // anticausal carries is the epilogue of the virtual sequence
+    axis.pc.resize((size_t)count*(axis.vblocks+1));
+    axis.ec.resize((size_t)count*(axis.vblocks+1));
+
+}
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Prepare algorithm 6 plan in the CPU
+ *
+ *  Pre-compute the carry matrices and allocate the carries once for
+ *  a given image size, filter weights and boundary.  The same plan
+ *  can then run on many input images.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] nthreads Number of threads (zero means one per core)
+ *  @param[in] b Block size (b x b pixels)
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg6_cpu( alg6_cpu_plan<R>& plan,
+                       int width, int height,
+                       const Vector<float, R+1>& w,
+                       BorderType btype=CLAMP_TO_ZERO,
+                       int nthreads=0,
+                       int b=64 ) {
+
+    if (width <= 0 || height <= 0 || b <= 0)
+        throw std::invalid_argument("Image and block sizes must be positive");
+
+    plan.width = width;
+    plan.height = height;
+    plan.b = b;
+    plan.btype = btype;
+    plan.w = w;
+
+    float s = 1.f; // steady state of the causal filter: y (1 + sum w_k) = w_0 x
+    for (int r = 1; r <= R; ++r) s += w[r];
+    plan.gain = w[0]/s;
+
+    prepare_alg6_cpu_axis(plan, plan.rows, width, height, 1, width);
+    prepare_alg6_cpu_axis(plan, plan.cols, height, width, width, 1);
+
+    if (!plan.pool || (nthreads > 0 && plan.pool->size() != nthreads)) {
+        delete plan.pool;
+        plan.pool = new cpu_pool(nthreads);
+    }
+
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Task context of one step of an algorithm 6 axis in the CPU
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_cpu_task {
+    alg6_cpu_plan<R> *plan; ///< The plan running
+    alg6_cpu_axis<R> *axis; ///< The axis filtering
+};
+
+/**
+ *  @ingroup cpu
+ *  @brief Algorithm 6 step 1 in the CPU for one block of one axis
+ *
+ *  Computes the causal carry \f$\bar{P}\f$ of each sequence of the
+ *  block alone (zero prologue) and the anticausal carry \f$\hat{E}\f$
+ *  of its causal output (zero epilogue), also of the block reversed
+ *  for the reflect boundary.  The task is one block of b sequences.
+ *
+ *  @param[in] arg The task context (see alg6_cpu_task)
+ *  @param[in] i The task (block) index
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_cpu_step1( void *arg, int i ) {
+    alg6_cpu_plan<R>& plan = *((alg6_cpu_task<R> *)arg)->plan;
+    alg6_cpu_axis<R>& a = *((alg6_cpu_task<R> *)arg)->axis;
+    const Vector<float,R+1>& w = plan.w;
+    const int b = plan.b, m = i % a.blocks, s0 = (i / a.blocks)*b,
+        len = std::min(b, a.length-m*b), s1 = std::min(s0+b, a.count),
+        es = a.elem_stride, V = a.vblocks;
+    std::vector<float> y(len);
+    for (int s = s0; s < s1; ++s) {
+        const float *x = plan.img + (long)s*a.seq_stride + (long)m*b*es;
+        Vector<float,R> p = zeros<float,R>(), e = zeros<float,R>();
+        for (int k = 0; k < len; ++k)
+            y[k] = fwd(p, x[k*es]*w[0], w);
+        for (int k = len-1; k >= 0; --k)
+            rev(y[k]*w[0], e, w);
+        a.pc[a.slot(m+1,s)] = p;
+        a.ec[a.slot(m,s)] = e;
+        if (V > a.blocks) { // the same block reversed (virtual block 2M-1-m)
+            int j = V-1-m;
+            p = zeros<float,R>(); e = zeros<float,R>();
+            for (int k = 0; k < len; ++k)
+                y[k] = fwd(p, x[(len-1-k)*es]*w[0], w);
+            for (int k = len-1; k >= 0; --k)
+                rev(y[k]*w[0], e, w);
+            a.pc[a.slot(j+1,s)] = p;
+            a.ec[a.slot(j,s)] = e;
+        }
+    }
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Algorithm 6 step 2 in the CPU for b sequences of one axis
+ *
+ *  Fixes the carries of each sequence block after block, from the
+ *  prologue to the epilogue of the boundary: zero; the steady state
+ *  of the constant extension (clamp); or the carries of the whole
+ *  period solved once (repeat, and reflect as repeat with the
+ *  sequence followed by its reverse).
+ *
+ *  @param[in] arg The task context (see alg6_cpu_task)
+ *  @param[in] i The task index
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_cpu_step2( void *arg, int i ) {
+    alg6_cpu_plan<R>& plan = *((alg6_cpu_task<R> *)arg)->plan;
+    alg6_cpu_axis<R>& a = *((alg6_cpu_task<R> *)arg)->axis;
+    const int b = plan.b, M = a.blocks, V = a.vblocks,
+        s0 = i*b, s1 = std::min(s0+b, a.count);
+    const bool periodic = plan.btype == REPEAT || plan.btype == REFLECT;
+    std::vector<const alg6_cpu_mats<R>*> mats(V);
+    for (int v = 0; v < V; ++v) { // virtual block v is the image block v or 2M-1-v
+        int m = v < M ? v : V-1-v;
+        mats[v] = m == M-1 ? &a.last : &a.full;
+    }
+    for (int s = s0; s < s1; ++s) {
+        const float *x = plan.img + (long)s*a.seq_stride;
+        Vector<float,R> p = zeros<float,R>(), e = zeros<float,R>();
+        if (periodic) { // carry of the whole period from zero prologue
+            for (int v = 0; v < V; ++v)
+                p = a.pc[a.slot(v+1,s)] + p * mats[v]->AF;
+            p = p * a.IGF;
+        } else if (plan.btype == CLAMP_TO_EDGE) {
+            for (int r = 0; r < R; ++r) p[r] = plan.gain*x[0];
+        }
+        a.pc[a.slot(0,s)] = p;
+        for (int v = 0; v < V; ++v) {
+            p = a.pc[a.slot(v+1,s)] + p * mats[v]->AF;
+            a.pc[a.slot(v+1,s)] = p;
+        }
+        if (periodic) { // carry of the whole period from zero epilogue
+            for (int v = V-1; v >= 0; --v)
+                e = a.ec[a.slot(v,s)] + a.pc[a.slot(v,s)] * mats[v]->H + e * mats[v]->AR;
+            e = e * a.IGR;
+        } else {
+            float yss = plan.btype == CLAMP_TO_EDGE ?
+                plan.gain*x[(long)(a.length-1)*a.elem_stride] : 0.f;
+            for (int r = 0; r < R; ++r) p[r] -= yss;
+            e = p * a.CT;
+            for (int r = 0; r < R; ++r) e[r] += plan.gain*yss;
+        }
+        a.ec[a.slot(V,s)] = e;
+        for (int v = V-1; v >= 0; --v) {
+            e = a.ec[a.slot(v,s)] + a.pc[a.slot(v,s)] * mats[v]->H + e * mats[v]->AR;
+            a.ec[a.slot(v,s)] = e;
+        }
+    }
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Algorithm 6 step 3 in the CPU for one block of one axis
+ *
+ *  Computes the output of each sequence of the block from its fixed
+ *  prologue and epilogue, in-place.
+ *
+ *  @param[in] arg The task context (see alg6_cpu_task)
+ *  @param[in] i The task (block) index
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_cpu_step3( void *arg, int i ) {
+    alg6_cpu_plan<R>& plan = *((alg6_cpu_task<R> *)arg)->plan;
+    alg6_cpu_axis<R>& a = *((alg6_cpu_task<R> *)arg)->axis;
+    const Vector<float,R+1>& w = plan.w;
+    const int b = plan.b, m = i % a.blocks, s0 = (i / a.blocks)*b,
+        len = std::min(b, a.length-m*b), s1 = std::min(s0+b, a.count),
+        es = a.elem_stride;
+    for (int s = s0; s < s1; ++s) {
+        float *x = plan.img + (long)s*a.seq_stride + (long)m*b*es;
+        Vector<float,R> p = a.pc[a.slot(m,s)], e = a.ec[a.slot(m+1,s)];
+        for (int k = 0; k < len; ++k)
+            x[k*es] = fwd(p, x[k*es]*w[0], w);
+        for (int k = len-1; k >= 0; --k)
+            x[k*es] = rev(x[k*es]*w[0], e, w);
+    }
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Run the three steps of algorithm 6 on one axis in the CPU
+ *  @param[in,out] plan The plan to run
+ *  @param[in,out] axis The axis to filter
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_cpu_axis_run( alg6_cpu_plan<R>& plan,
+                        alg6_cpu_axis<R>& axis ) {
+    alg6_cpu_task<R> task = { &plan, &axis };
+    int groups = (axis.count+plan.b-1)/plan.b;
+    plan.pool->run(groups*axis.blocks, alg6_cpu_step1<R>, &task);
+    plan.pool->run(groups, alg6_cpu_step2<R>, &task);
+    plan.pool->run(groups*axis.blocks, alg6_cpu_step3<R>, &task);
+}
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Run algorithm 6 plan in the CPU
+ *
+ *  The image is filtered in-place along rows and then along columns,
+ *  with the exact infinite extension of the plan boundary (as
+ *  alg6_clamp(), alg6_repeat() and alg6_reflect() in the GPU).
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in,out] inout The 2D image to filter
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_cpu( alg6_cpu_plan<R>& plan,
+               float *inout ) {
+    plan.img = inout;
+    alg6_cpu_axis_run(plan, plan.rows);
+    alg6_cpu_axis_run(plan, plan.cols);
+    plan.img = 0;
+}
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute algorithm 6 in the CPU
+ *
+ *  Same as alg6_gpu() and its boundary flavors without border blocks:
+ *  the boundary is the exact infinite extension of the border type.
+ *
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] nthreads Number of threads (zero means one per core)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_cpu( float *h_img,
+               const int& width, const int& height, const int& runtimes,
+               const Vector<float, R+1>& w,
+               const BorderType& btype=CLAMP_TO_ZERO,
+               int nthreads=0 ) {
+
+    alg6_cpu_plan<R> plan;
+    prepare_alg6_cpu(plan, width, height, w, btype, nthreads);
+
+    std::vector<float> h_in(h_img, h_img + width*height);
+
+    base_timer &timer_total = timers.cpu_add("alg6_cpu", width*height, "iP");
+
+    for (int r = 0; r < runtimes; ++r) {
+        if (r > 0) // filtering is in-place, restart from the input
+            std::copy(h_in.begin(), h_in.end(), h_img);
+        alg6_cpu(plan, h_img);
+    }
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_CPU_H
+//==============================================================================
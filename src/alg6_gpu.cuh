@@ -9,16 +9,16 @@
 #ifndef ALG6_GPU_CUH
 #define ALG6_GPU_CUH
 
-#define MST == // measure step time: no: == ; yes: >=
 #define LDG // uncomment to use __ldg
 //#if ORDER==1 || ORDER==2 || ORDER==4
 #define REGS // uncomment to use registers
 //#endif
-#define GMAT // uncomment to use global constant matrices
+#define GMAT // uncomment to keep global constant matrices in registers
 
 //== INCLUDES ==================================================================
 
 #include "alg3v4v5v6_gpu.cuh"
+#include "alg5v6_tc.cuh"
 
 //== NAMESPACES ================================================================
 
@@ -45,27 +45,35 @@ namespace gpufilter {
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
  *  @param[in] g_cmat Constant pre-computed matrices on equations (27) and (29)
+ *  @param[in] params Filter parameters with the carry adjusting matrices
  *  @param[in] m_size The big M (number of row blocks)
  *  @param[in] n_size The big N (number of column blocks)
  *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
  */
-template <int R>
+template <int R, class T>
 __global__ __launch_bounds__(WS*NWARC, NBARC)
-void alg6_step3( Matrix<float,R,WS> *g_ptucheck,
-                 Matrix<float,R,WS> *g_etvtilde,
-                 const Matrix<float,R,WS> *g_py,
-                 const Matrix<float,R,WS> *g_ez,
-#ifdef GMAT
-                 const Matrix<float,R,WS> *g_cmat,
-#endif
+void alg6_step3( Matrix<T,R,WS> *g_ptucheck,
+                 Matrix<T,R,WS> *g_etvtilde,
+                 const Matrix<T,R,WS> *g_py,
+                 const Matrix<T,R,WS> *g_ez,
+                 const Matrix<typename carry_traits<T>::compute,R,WS> *g_cmat,
+                 const filter_params<R,T> params,
                  int m_size, int n_size ) {
 
+    typedef typename carry_traits<T>::compute TF;
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
-    Matrix<float,R,WS> *gptuetv;
-    Vector<float,R> py, ez, ptuetv;
-    __shared__ Matrix<float,R,WS> spy, sez;
+    Matrix<T,R,WS> *gptuetv;
+    Vector<TF,R> py, ez, ptuetv;
+    __shared__ Matrix<TF,R,WS> spy, sez;
+
+    // offset carries to the image (in batch) of this block
+    g_ptucheck += blockIdx.z*(n_size+1)*m_size;
+    g_etvtilde += blockIdx.z*(n_size+1)*m_size;
+    g_py += blockIdx.z*(m_size+1)*n_size;
+    g_ez += blockIdx.z*(m_size+1)*n_size;
 #ifdef GMAT
-    Vector<float,R> cmat[3];
+    Vector<TF,R> cmat[3];
 #endif
 
     if (ty == 0) {
@@ -73,9 +81,9 @@ void alg6_step3( Matrix<float,R,WS> *g_ptucheck,
         for (int r=0; r<R; ++r) {
 #ifdef GMAT
 #ifdef LDG
-            cmat[0][r] = __ldg((const float *)&g_cmat[0][r][tx]);
-            cmat[1][r] = __ldg((const float *)&g_cmat[1][r][tx]);
-            cmat[2][r] = __ldg((const float *)&g_cmat[2][r][tx]);
+            cmat[0][r] = __ldg((const TF *)&g_cmat[0][r][tx]);
+            cmat[1][r] = __ldg((const TF *)&g_cmat[1][r][tx]);
+            cmat[2][r] = __ldg((const TF *)&g_cmat[2][r][tx]);
 #else
             cmat[0][r] = g_cmat[0][r][tx];
             cmat[1][r] = g_cmat[1][r][tx];
@@ -84,15 +92,15 @@ void alg6_step3( Matrix<float,R,WS> *g_ptucheck,
 #endif
             ptuetv[r] = g_ptucheck[m*(n_size+1)+n+1][r][tx];
         }
-        gptuetv = (Matrix<float,R,WS> *)&g_ptucheck[m*(n_size+1)+n+1][0][tx];
+        gptuetv = (Matrix<T,R,WS> *)&g_ptucheck[m*(n_size+1)+n+1][0][tx];
     } else if (ty == 1) {
 #pragma unroll
         for (int r=0; r<R; ++r) {
 #ifdef GMAT
 #ifdef LDG
-            cmat[0][r] = __ldg((const float *)&g_cmat[0][r][tx]);
-            cmat[1][r] = __ldg((const float *)&g_cmat[1][r][tx]);
-            cmat[2][r] = __ldg((const float *)&g_cmat[3][r][tx]);
+            cmat[0][r] = __ldg((const TF *)&g_cmat[0][r][tx]);
+            cmat[1][r] = __ldg((const TF *)&g_cmat[1][r][tx]);
+            cmat[2][r] = __ldg((const TF *)&g_cmat[3][r][tx]);
 #else
             cmat[0][r] = g_cmat[0][r][tx];
             cmat[1][r] = g_cmat[1][r][tx];
@@ -101,22 +109,22 @@ void alg6_step3( Matrix<float,R,WS> *g_ptucheck,
 #endif
             ptuetv[r] = g_etvtilde[m*(n_size+1)+n][r][tx];
         }
-        gptuetv = (Matrix<float,R,WS> *)&g_etvtilde[m*(n_size+1)+n][0][tx];
+        gptuetv = (Matrix<T,R,WS> *)&g_etvtilde[m*(n_size+1)+n][0][tx];
     } else if (ty == 2) {
 #ifdef LDG
 #pragma unroll
         for (int r=0; r<R; ++r)
-            spy[r][tx] = __ldg((const float *)&g_py[(n)*(m_size+1)+m+0][r][tx]);
+            spy[r][tx] = __ldg((const T *)&g_py[(n)*(m_size+1)+m+0][r][tx]);
 #else
-        spy.set_col(tx, ((Matrix<float,R,WS>*)&g_py[n*(m_size+1)+m][0][tx])->col(0));
+        spy.set_col(tx, convert<TF>(((Matrix<T,R,WS>*)&g_py[n*(m_size+1)+m][0][tx])->col(0)));
 #endif
     } else if (ty == 3) {
 #ifdef LDG
 #pragma unroll
         for (int r=0; r<R; ++r)
-            sez[r][tx] = __ldg((const float *)&g_ez[(n)*(m_size+1)+m+1][r][tx]);
+            sez[r][tx] = __ldg((const T *)&g_ez[(n)*(m_size+1)+m+1][r][tx]);
 #else
-        sez.set_col(tx, ((Matrix<float,R,WS>*)&g_ez[n*(m_size+1)+m+1][0][tx])->col(0));
+        sez.set_col(tx, convert<TF>(((Matrix<T,R,WS>*)&g_ez[n*(m_size+1)+m+1][0][tx])->col(0)));
 #endif
     }
 
@@ -132,215 +140,249 @@ void alg6_step3( Matrix<float,R,WS> *g_ptucheck,
         fixpet(ptuetv, cmat[2], cmat[1], py);
 #else
         if (ty == 0) {
-            fixpet(ptuetv, c_TAFB, c_ARE_T, ez);
-            fixpet(ptuetv, c_TAFB, c_ARB_AFP_T, py);
+            fixpet(ptuetv, g_cmat[2], g_cmat[0], ez);
+            fixpet(ptuetv, g_cmat[2], g_cmat[1], py);
         } else { // ty == 1
-            fixpet(ptuetv, c_HARB_AFB, c_ARE_T, ez);
-            fixpet(ptuetv, c_HARB_AFB, c_ARB_AFP_T, py);
+            fixpet(ptuetv, g_cmat[3], g_cmat[0], ez);
+            fixpet(ptuetv, g_cmat[3], g_cmat[1], py);
         }
 #endif
 
-        gptuetv->set_col(0, ptuetv);
+        gptuetv->set_col(0, convert<T>(ptuetv));
 
     }
 
 }
 
 /**
+ *  @struct alg6_plan alg6_gpu.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm 6 in the GPU
+ *  @brief Filter plan of algorithm 6
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float, double or half precision carries)
+ */
+template <bool BORDER, int R, class TC=float>
+struct alg6_plan : public alg5v6_plan<R,TC> { };
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 plan in the GPU
  *
- *  @see [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  Pre-compute matrices, allocate device memory and configure
+ *  kernels once for a given image size, filter weights and border.
+ *  The same plan can then run on many input images.
+ *  Plans of skinny images adjust carries with look-back (see
+ *  skinny_plan()).
+ *
+ *  @param[out] plan The plan to prepare
  *  @param[in] width Image width
  *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
  *  @param[in] w Filter weights (feedforward and feedback coefficients)
  *  @param[in] border Number of border blocks (32x32) outside image
  *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] batch Number of images (of same size) filtered together
+ *  @param[in] channels Number of interleaved channels per pixel (1 to 4)
+ *  @param[in] half Flag for half-precision input and output storage
+ *  @param[in] tight Flag to allocate the output with tight pitch (stride equal to width)
  *  @tparam BORDER Flag to consider border input padding
  *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
  */
-template <bool BORDER, int R>
-void alg6_gpu( float *h_img,
-               const int& width, const int& height, const int& runtimes,
-               const Vector<float, R+1>& w,
-               const int& border=0,
-               const BorderType& border_type=CLAMP_TO_ZERO ) {
+template <bool BORDER, int R, class TC>
+void prepare_alg6( alg6_plan<BORDER,R,TC>& plan,
+                   const int& width, const int& height,
+                   const Vector<float, R+1>& w,
+                   const int& border=0,
+                   const BorderType& btype=CLAMP_TO_ZERO,
+                   const int& batch=1,
+                   const int& channels=1,
+                   bool half=false,
+                   bool tight=false ) {
+
+    prepare_alg5v6(plan, width, height, w, BORDER ? border : 0,
+                   BORDER ? btype : CLAMP_TO_ZERO, BORDER, batch > 1 ? batch : 1,
+                   channels, half, tight);
+
+    config_alg5v6<BORDER>(plan);
+    cudaFuncSetCacheConfig(alg6_step3<R,TC>, cudaFuncCachePreferL1);
+
+    if (skinny_plan(plan)) prepare_lookback(plan);
 
-    const int B = WS;
+}
 
-    // pre-compute basic alg5 matrices
-    Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 plan in the GPU
+ *
+ *  The plan input is filtered to the plan output in device memory,
+ *  see upload() and download().  With the plan graph enabled, the
+ *  kernels are captured on the first run and replayed after (see
+ *  plan_graph).  Steps 2 and 4 may adjust carries with look-back
+ *  (see prepare_lookback()).  Filtering only rows skips steps 3 and
+ *  4, only columns skips steps 2 and 3 (see prepare_axes()).  Steps
+ *  1 and 5 may run on tensor cores (see prepare_tensor()).
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional five timers to measure each step
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ *  @tparam TC Carry type (float or double)
+ */
+template <bool BORDER, int R, class TC>
+void alg6_gpu( alg6_plan<BORDER,R,TC>& plan,
+               base_timer **timer=0 ) {
 
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w), ARE_T = rev(Zrb, Ir, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w), ARB_T = rev(Ib, Zbr, w);
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T), AbR_T = head<R>(ARE_T);
-    Matrix<float,R,R> AbF = transp(AbF_T), AbR = transp(AbR_T);
-    Matrix<float,R,R> HARB_AFP_T = AFP_T*head<R>(ARB_T);
-    Matrix<float,R,R> HARB_AFP = transp(HARB_AFP_T);
-    Matrix<float,R,B> ARB_AFP_T = AFP_T*ARB_T, TAFB = transp(tail<R>(AFB_T));
-    Matrix<float,R,B> HARB_AFB = transp(AFB_T*head<R>(ARB_T));
+    if (!timer && launch_graph(plan, alg6_gpu<BORDER,R,TC>))
+        return; // replayed the captured kernels (see plan_graph)
 
-    int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
+    // carries are fixed for each channel of each image
+    const int m_size = plan.m_size, n_size = plan.n_size,
+        batch = plan.batch*plan.channels;
 
-    if (BORDER) {
-        int border_left, border_top, border_right, border_bottom;
-        calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
-                     width, height, border);
-        int ewidth = width+border_left+border_right,
-            eheight = height+border_top+border_bottom;
+    if (timer) timer[0]->start();
 
-        m_size = (ewidth+WS-1)/WS;
-        n_size = (eheight+WS-1)/WS;
+    if (plan.tensor)
+        launch_alg5v6_tc_step1<BORDER>(plan);
+    else
+        launch_alg5v6_step1<BORDER>(plan, &plan.d_pybar, &plan.d_ezhat,
+                                    &plan.d_ptucheck, &plan.d_etvtilde, plan.params);
 
-        copy_to_symbol(c_border, border);
-    }
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AbR_T, AbR_T);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T);
-
-    copy_to_symbol(c_ARE_T, ARE_T);
-    copy_to_symbol(c_ARB_AFP_T, ARB_AFP_T);
-    copy_to_symbol(c_TAFB, TAFB);
-    copy_to_symbol(c_HARB_AFB, HARB_AFB);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-
-    if (BORDER) {
-        switch(border_type) {
-        case CLAMP_TO_ZERO:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-            break;
-        case CLAMP_TO_EDGE:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
-            break;
-        case REPEAT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
-            break;
-        case REFLECT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeMirror;
-            break;
-        }
-    }
+    if (plan.axes != COLUMNS_ONLY)
+        launch_alg3v4v5v6_step2v4(plan, &plan.d_pybar, &plan.d_ezhat, m_size, n_size);
 
-    int stride_img = width+WS;
-    if (BORDER) stride_img = width+WS*border+WS;
-
-    dvector<float> d_img(height*stride_img);
-
-    // +1 padding is important even in zero-border to avoid if's in kernels
-    dvector< Matrix<float,R,B> > d_pybar((m_size+1)*n_size), d_ezhat((m_size+1)*n_size);
-    dvector< Matrix<float,R,B> > d_ptucheck((n_size+1)*m_size), d_etvtilde((n_size+1)*m_size);
-    d_pybar.fillzero();
-    d_ezhat.fillzero();
-    d_ptucheck.fillzero();
-    d_etvtilde.fillzero();
-
-    // the following matrices can not be read from constant memory as one warp
-    // will access each column by a different thread, serializing access and
-    // hurting performance, the solution is to store them in global memory
-    // and manage to have them in L1 cache as soon as possible;
-    // constant r x b matrices: ARE_T, ARB_AFP_T, TAFB, HARB_AFB
-    Matrix<float,R,B> h_cmat[4] = { ARE_T, ARB_AFP_T, TAFB, HARB_AFB };
-    dvector< Matrix<float,R,B> > d_cmat(h_cmat, 4);
-
-    cudaFuncSetCacheConfig(alg5v6_step1<BORDER,R>, cudaFuncCachePreferShared);
-    cudaFuncSetCacheConfig(alg5v6_step4v5<BORDER,R>, cudaFuncCachePreferShared);
-    cudaFuncSetCacheConfig(alg6_step3<R>, cudaFuncCachePreferL1);
-
-    if (R == 1)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferL1);
-    else if (R == 2)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferEqual);
-    else if (R >= 3)
-        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R>, cudaFuncCachePreferShared);
-
-    double te[5] = {0, 0, 0, 0, 0}; // time elapsed for the five steps
-    base_timer *timer[5];
-    for (int i = 0; i < 5; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-    base_timer &timer_total = timers.gpu_add("alg6_gpu", width*height, "iP");
+    if (plan.axes == BOTH_AXES)
+        alg6_step3<<< dim3(m_size, n_size, batch), dim3(WS, NWARC), 0, plan.stream >>>
+            ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+              &plan.d_cmat, plan.params, m_size, n_size );
 
-    for(int r = 0; r < runtimes; ++r) {
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        if (runtimes MST 1) { timer[0]->start(); }
+    if (plan.axes != ROWS_ONLY)
+        launch_alg3v4v5v6_step2v4(plan, &plan.d_ptucheck, &plan.d_etvtilde, n_size, m_size, true);
 
-        cudaBindTextureToArray(t_in, a_in);
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
 
-        alg5v6_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size );
+    if (plan.tensor)
+        launch_alg5v6_tc_step4v5<BORDER>(plan);
+    else
+        launch_alg5v6_step4v5<BORDER>(plan, &plan.d_pybar, &plan.d_ezhat,
+                                      &plan.d_ptucheck, &plan.d_etvtilde, plan.params);
 
-        if (runtimes MST 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    if (timer) timer[4]->stop();
 
-        alg3v4v5v6_step2v4<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar, &d_ezhat, m_size );
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Copy one row of column carries between two carry arrays
+ *
+ *  The column carries of a band are stored as \f$M\f$ times (batch)
+ *  columns of \f$N+1\f$ carries, thus one slot \f$n\f$ of all
+ *  columns is a strided (2D) copy.  Any side may be in another
+ *  device or in (pinned) host memory, a contiguous row of carries
+ *  is given by slot zero and big N zero.
+ *
+ *  @param[out] d_dst Column carries of the destination band
+ *  @param[in] dst_n Slot of the destination carries
+ *  @param[in] dst_n_size The big N of the destination band
+ *  @param[in] d_src Column carries of the source band
+ *  @param[in] src_n Slot of the source carries
+ *  @param[in] src_n_size The big N of the source band
+ *  @param[in] columns Number of columns of carries (big M times batch)
+ *  @param[in] stream Stream to copy on
+ *  @tparam R Filter order
+ */
+template <int R>
+void copy_column_carries( Matrix<float,R,WS> *d_dst,
+                          int dst_n, int dst_n_size,
+                          const Matrix<float,R,WS> *d_src,
+                          int src_n, int src_n_size,
+                          int columns,
+                          cudaStream_t stream ) {
+    cudaMemcpy2DAsync(d_dst + dst_n, (dst_n_size+1)*sizeof(Matrix<float,R,WS>),
+                      d_src + src_n, (src_n_size+1)*sizeof(Matrix<float,R,WS>),
+                      sizeof(Matrix<float,R,WS>), columns,
+                      cudaMemcpyDefault, stream);
+}
 
-        if (runtimes MST 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 in the GPU
+ *
+ *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+void alg6_gpu( float *h_img,
+               const int& width, const int& height, const int& runtimes,
+               const Vector<float, R+1>& w,
+               const int& border=0,
+               const BorderType& border_type=CLAMP_TO_ZERO ) {
 
-        alg6_step3<<< dim3(m_size, n_size), dim3(WS, NWARC) >>>
-            ( &d_ptucheck, &d_etvtilde, &d_pybar, &d_ezhat,
-#ifdef GMAT
-              &d_cmat,
+#ifdef MIXED // external define it to keep carries in double precision
+    alg6_plan<BORDER,R,double> plan;
+#elif defined(COMPACT) // external define it to store carries in half precision
+    alg6_plan<BORDER,R,__half> plan;
+#else
+    alg6_plan<BORDER,R> plan;
 #endif
-              m_size, n_size );
-
-        if (runtimes MST 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+#ifdef HALF // external define it to store images in half precision
+    prepare_alg6(plan, width, height, w, border, border_type, 1, 1, true);
+#else
+    prepare_alg6(plan, width, height, w, border, border_type);
+#endif
+    if (tensor_precision()) // see tensor_precision()
+        prepare_tensor(plan, tensor_precision());
 
-        alg3v4v5v6_step2v4<<< dim3(1, m_size), dim3(WS, NWA) >>>
-            ( &d_ptucheck, &d_etvtilde, n_size );
+    upload(plan, h_img);
 
-        if (runtimes MST 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); timer[4]->start(); }
+    const char *steps[5] = { "step 1", "step 2", "step 3", "step 4", "step 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i)
+        timer[i] = new step_timer(std::string("alg6_gpu ") + steps[i]);
 
-        alg5v6_step4v5<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size, stride_img );
+    base_timer &timer_total = timers.gpu_add("alg6_gpu", width*height, "iP");
 
-        cudaUnbindTexture(t_in);
+    for(int r = 0; r < runtimes; ++r)
+        alg6_gpu(plan, timed ? timer : 0);
 
-        if (runtimes MST 1) { timer[4]->stop(); te[4] += timer[4]->elapsed(); }
+    timer_total.stop();
 
+    for (int i = 0; i < 5; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
     }
 
-    timer_total.stop();
-
     if (runtimes > 1) {
 
-        if (runtimes MST 1) {
+        if (timed) {
             for (int i = 0; i < 5; ++i)
-                std::cout << std::fixed << " " << te[i]/(double)runtimes << std::flush;
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
         } else {
             std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
         }
 
     } else {
 
-        timers.gpu_add("step 1", timer[0]);
-        timers.gpu_add("step 2", timer[1]);
-        timers.gpu_add("step 3", timer[2]);
-        timers.gpu_add("step 4", timer[3]);
-        timers.gpu_add("step 5", timer[4]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
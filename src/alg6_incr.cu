@@ -0,0 +1,144 @@
+/**
+ *  @file alg6_incr.cu
+ *  @brief Algorithm 6 in the GPU refiltering brush strokes incrementally
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_incr_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg6_incr.cuh"
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 4096, height = 4096;
+    int strokes = 16; // # of brush strokes (one dirty rectangle each)
+    int brush = 48; // brush size (dirty rectangle width and height)
+    float tolerance = 0.f; // change tolerance (zero refilters exactly)
+    float me = 0.f, mre = 0.f; // maximum error and maximum relative error
+
+    if ((argc != 1 && argc != 4 && argc != 6) ||
+        (argc >= 4 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%d", &strokes) != 1)) ||
+        (argc == 6 && (sscanf(argv[4], "%d", &brush) != 1 ||
+                       sscanf(argv[5], "%f", &tolerance) != 1)) ||
+        width <= 0 || height <= 0 || strokes <= 0 ||
+        brush <= 0 || brush > width || brush > height || tolerance < 0.f) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height strokes [brush tolerance]]\n";
+        return 1;
+    }
+
+    std::vector< float > in_img(width*height), cpu_img(width*height),
+        full_img(width*height), incr_img(width*height);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        in_img[i] = rand() / (float)RAND_MAX;
+
+    float sigma = 4.f; // width / 6.f;
+
+    gpufilter::Vector<float, ORDER+1> w;
+    gpufilter::weights(sigma, w);
+
+    gpufilter::alg6_plan<false,ORDER> full;
+    gpufilter::alg6_incr_plan<ORDER> incr;
+    gpufilter::prepare_alg6(full, width, height, w);
+    gpufilter::prepare_alg6_incr(incr, width, height, w, tolerance);
+
+    std::cout << APPNAME << " Size: " << width << " x " << height
+              << "  Order: " << ORDER << "  Strokes: " << strokes
+              << " of " << brush << " x " << brush << "\n";
+    std::cout << APPNAME << " Weights: " << w << "\n";
+    std::cout << APPNAME << " Tolerance: " << tolerance << "  Reach: "
+              << incr.reach << " blocks\n";
+    std::cout << APPNAME << " (1) Runs GPU refiltering the whole image per stroke (full)\n";
+    std::cout << APPNAME << " (2) Runs GPU refiltering the dirty rectangle per stroke (res)\n";
+    std::cout << APPNAME << " (3) Runs the reference in the CPU of the last image (ref)\n";
+    std::cout << APPNAME << " (4) Checks computations (ref x res)\n";
+
+    gpufilter::upload(full, &in_img[0]);
+    gpufilter::upload(incr, &in_img[0]);
+    gpufilter::alg6_gpu(full); // warm up
+    gpufilter::alg6_gpu(incr); // the output of the first image
+
+    double tf = 0., ti = 0.;
+    gpufilter::gpu_timer timer(0, "", false);
+
+    for (int s = 0; s < strokes; ++s) {
+
+        int x = rand() % (width-brush+1), y = rand() % (height-brush+1);
+        float ink = rand() / (float)RAND_MAX;
+        for (int i = 0; i < brush; ++i)
+            for (int j = 0; j < brush; ++j)
+                in_img[(y+i)*width+x+j] = ink;
+
+        timer.start();
+        gpufilter::upload(full, &in_img[0]);
+        gpufilter::alg6_gpu(full);
+        timer.stop();
+        tf += timer.elapsed();
+
+        timer.start();
+        gpufilter::alg6_update(incr, &in_img[y*width+x], width*sizeof(float),
+                               x, y, brush, brush, cudaMemcpyHostToDevice);
+        timer.stop();
+        ti += timer.elapsed();
+
+    }
+
+    gpufilter::download(full, &full_img[0]);
+    gpufilter::download(incr, &incr_img[0]);
+
+    std::copy(in_img.begin(), in_img.end(), cpu_img.begin());
+    gpufilter::alg0_cpu<ORDER>(&cpu_img[0], width, height, w);
+
+    std::cout << std::fixed << APPNAME << " [refilter] [upload+filter-ms-per-stroke]\n";
+    std::cout << APPNAME << " full        " << std::setprecision(3) << tf*1000/strokes << "\n";
+    std::cout << APPNAME << " incremental " << std::setprecision(3) << ti*1000/strokes << "\n";
+    std::cout << APPNAME << " Saved: " << std::setprecision(1)
+              << 100.*(tf-ti)/tf << "% time\n";
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &full_img[0], width*height, me, mre );
+
+    std::cout << APPNAME << " [max-error] [max-relative-error] full: "
+              << std::scientific << me << " " << mre << "\n";
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &incr_img[0], width*height, me, mre );
+
+    std::cout << APPNAME << " [max-error] [max-relative-error] res: "
+              << std::scientific << me << " " << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,409 @@
+/**
+ *  @file alg6_incr.cuh
+ *  @brief Algorithm 6 refiltering incrementally the changes of an input region
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_INCR_CUH
+#define ALG6_INCR_CUH
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <stdexcept>
+#include <algorithm>
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Read the change of a block of the input inside a dirty rectangle
+ *
+ *  Each pixel of the block inside the rectangle is its new value
+ *  minus its old value (read from the input texture object), and
+ *  each pixel outside is zero (no change).
+ *
+ *  @param[out] block The block of changes \f$B_{m,n}(\Delta X)\f$
+ *  @param[in] tex The input texture object (of the old input)
+ *  @param[in] g_new The new pixels of the rectangle
+ *  @param[in] new_stride The new pixels stride (the rectangle width)
+ *  @param[in] rx Rectangle left column
+ *  @param[in] ry Rectangle top row
+ *  @param[in] rw Rectangle width
+ *  @param[in] rh Rectangle height
+ *  @param[in] m The block column
+ *  @param[in] n The block row
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @tparam W Number of warps
+ */
+template <int W>
+__device__
+void read_delta_block( Matrix<float,WS,WS+1>& block,
+                       cudaTextureObject_t tex,
+                       const float *g_new,
+                       int new_stride,
+                       int rx, int ry, int rw, int rh,
+                       int m, int n,
+                       float inv_width, float inv_height ) {
+    int tx = threadIdx.x, ty = threadIdx.y, x = m*WS+tx;
+#pragma unroll
+    for (int i=ty; i<WS; i+=W) {
+        int y = n*WS+i;
+        float d = 0.f;
+        if (x >= rx && x < rx+rw && y >= ry && y < ry+rh)
+            d = g_new[(y-ry)*new_stride+x-rx]
+                - tex2DLayered<float>(tex, (x+.5f)*inv_width, (y+.5f)*inv_height, 0);
+        block[i][tx] = d;
+    }
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 1 of the changes in a dirty rectangle
+ *
+ *  Same as alg5v6_step1() on the changes of the input (see
+ *  read_delta_block()), launched only over the blocks of the dirty
+ *  rectangle, the perimeters of all other blocks are zero.
+ *
+ *  @param[in] tex The input texture object (of the old input)
+ *  @param[in] g_new The new pixels of the rectangle
+ *  @param[in] new_stride The new pixels stride (the rectangle width)
+ *  @param[in] rx Rectangle left column
+ *  @param[in] ry Rectangle top row
+ *  @param[in] rw Rectangle width
+ *  @param[in] rh Rectangle height
+ *  @param[out] g_pybar All \f$P_{m,n}(\Delta Y)\f$
+ *  @param[out] g_ezhat All \f$E_{m,n}(\Delta Z)\f$
+ *  @param[out] g_ptucheck All \f$P^T_{m,n}(\Delta U)\f$
+ *  @param[out] g_etvtilde All \f$E^T_{m,n}(\Delta V)\f$
+ *  @param[in] params Filter parameters (weights)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS*NWC, NBCW)
+void alg6_incr_step1( cudaTextureObject_t tex,
+                      const float *g_new,
+                      int new_stride,
+                      int rx, int ry, int rw, int rh,
+                      Matrix<float,R,WS> *g_pybar,
+                      Matrix<float,R,WS> *g_ezhat,
+                      Matrix<float,R,WS> *g_ptucheck,
+                      Matrix<float,R,WS> *g_etvtilde,
+                      const filter_params<R> params,
+                      float inv_width, float inv_height,
+                      int m_size, int n_size ) {
+
+    int m = blockIdx.x + rx/WS, n = blockIdx.y + ry/WS;
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    read_delta_block<NWC>(block, tex, g_new, new_stride, rx, ry, rw, rh,
+                          m, n, inv_width, inv_height);
+    __syncthreads();
+
+    alg5v6_block_carries(block, params.weights, params.weights_cols, params.axes,
+                         g_pybar, g_ezhat, g_ptucheck, g_etvtilde,
+                         m, n, m_size, n_size);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 5 adding the changes to the output
+ *
+ *  Same as alg5v6_step4v5() on the changes of the input (see
+ *  read_delta_block()) and their carries, launched only over the
+ *  blocks reached by the changes, each adding its output block of
+ *  changes to the previous output.
+ *
+ *  @param[in] tex The input texture object (of the old input)
+ *  @param[in] g_new The new pixels of the rectangle
+ *  @param[in] new_stride The new pixels stride (the rectangle width)
+ *  @param[in] rx Rectangle left column
+ *  @param[in] ry Rectangle top row
+ *  @param[in] rw Rectangle width
+ *  @param[in] rh Rectangle height
+ *  @param[in,out] g_out The output 2D image (previous output)
+ *  @param[in] g_py All \f$P_{m,n}(\Delta Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(\Delta Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(\Delta U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(\Delta V)\f$
+ *  @param[in] params Filter parameters (weights)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m0 First block column reached
+ *  @param[in] n0 First block row reached
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] out_stride Image output stride for memory width alignment
+ *  @tparam R Filter order
+ */
+template <int R>
+__global__ __launch_bounds__(WS*NWW, NBCW)
+void alg6_incr_step5( cudaTextureObject_t tex,
+                      const float *g_new,
+                      int new_stride,
+                      int rx, int ry, int rw, int rh,
+                      float *g_out,
+                      const Matrix<float,R,WS> *g_py,
+                      const Matrix<float,R,WS> *g_ez,
+                      const Matrix<float,R,WS> *g_ptu,
+                      const Matrix<float,R,WS> *g_etv,
+                      const filter_params<R> params,
+                      float inv_width, float inv_height,
+                      int m0, int n0,
+                      int m_size, int n_size,
+                      int width, int height,
+                      int out_stride ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y,
+        m = blockIdx.x + m0, n = blockIdx.y + n0;
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    read_delta_block<NWW>(block, tex, g_new, new_stride, rx, ry, rw, rh,
+                          m, n, inv_width, inv_height);
+    __syncthreads();
+
+    // an empty output keeps the block of changes in shared memory
+    alg5v6_block_output<false,R,1>(block, g_out, params.weights, params.weights_cols,
+                                   params.axes, 0, g_py, g_ez, g_ptu, g_etv,
+                                   m, n, m_size, n_size, 0, 0, out_stride, true);
+    __syncthreads();
+
+    int x = m*WS+tx;
+#pragma unroll // add block of changes inside image
+    for (int i=ty; i<WS; i+=NWW) {
+        int y = n*WS+i;
+        if (x < width && y < height)
+            g_out[y*out_stride+x] += block[i][tx];
+    }
+
+}
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg6_incr_plan alg6_incr.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of algorithm 6 refiltering changes incrementally
+ *
+ *  The recursive filter is linear, thus the output of a changed input
+ *  is the previous output plus the output of the changes, and the
+ *  changes of a dirty rectangle are zero outside it.  Their carries
+ *  are collected only over the blocks of the rectangle, adjusted only
+ *  along the rows of blocks crossing it (the other row carries are
+ *  zero), and the output of changes is added only to the blocks they
+ *  reach.  The previous output (and input) stays resident in the plan.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_incr_plan : public alg6_plan<false,R> {
+    float tolerance; ///< Change tolerance of the output blocks not rewritten
+    int reach; ///< Number of blocks reached by changes (around the rectangle)
+    dvector<float> d_new; ///< New pixels of the dirty rectangle
+    /// Default constructor
+    alg6_incr_plan() : tolerance(0.f), reach(0) { }
+};
+
+//=== IMPLEMENTATION ===========================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Largest absolute value of a matrix
+ *  @param[in] a The matrix
+ *  @return The largest absolute value of all elements
+ *  @tparam R Matrix rows and columns
+ */
+template <int R>
+float max_abs( const Matrix<float,R,R>& a ) {
+    float v = 0.f;
+    for (int i = 0; i < R; ++i)
+        for (int j = 0; j < R; ++j)
+            v = std::max(v, std::abs(a[i][j]));
+    return v;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Number of blocks reached by the changes of an input
+ *
+ *  The carries of changes fade away block after block (by the carry
+ *  adjusting matrices), below the tolerance after this number of
+ *  blocks in both directions of rows and columns.  Zero tolerance
+ *  reaches the whole image (exact refiltering).
+ *
+ *  @param[in] plan The plan with the matrices of rows and columns
+ *  @param[in] tolerance Change tolerance (relative to the largest input change)
+ *  @return The number of blocks reached around the changes
+ *  @tparam R Filter order
+ */
+template <int R>
+int changes_reach( const alg6_incr_plan<R>& plan,
+                   float tolerance ) {
+    int full = std::max(plan.m_size, plan.n_size);
+    if (tolerance <= 0.f) return full;
+    Matrix<float,R,R> F = plan.mat.AbF_T, B = plan.mat.AbR_T,
+        Fc = plan.mat_cols.AbF_T, Bc = plan.mat_cols.AbR_T;
+    for (int k = 1; k < full; ++k) {
+        if (max_abs(F) < tolerance && max_abs(B) < tolerance &&
+            max_abs(Fc) < tolerance && max_abs(Bc) < tolerance)
+            return k;
+        F = F * plan.mat.AbF_T;
+        B = B * plan.mat.AbR_T;
+        Fc = Fc * plan.mat_cols.AbF_T;
+        Bc = Bc * plan.mat_cols.AbR_T;
+    }
+    return full;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 plan refiltering changes incrementally
+ *
+ *  The plan is an algorithm 6 plan of zero boundary (no border
+ *  blocks) of one single-channel image in float storage.  With a
+ *  tolerance, the output blocks farther from the changes than their
+ *  reach (see changes_reach()) are not rewritten, their changes are
+ *  below the tolerance times the largest input change.  Zero
+ *  tolerance refilters exactly (rewriting the whole output).
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] tolerance Change tolerance of the output blocks not rewritten
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg6_incr( alg6_incr_plan<R>& plan,
+                        const int& width, const int& height,
+                        const Vector<float, R+1>& w,
+                        float tolerance=0.f ) {
+
+    prepare_alg6(plan, width, height, w);
+
+    plan.tolerance = tolerance;
+    plan.reach = changes_reach(plan, tolerance);
+
+    cudaFuncSetCacheConfig(alg6_incr_step1<R>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg6_incr_step5<R>, cudaFuncCachePreferShared);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Refilter incrementally the changes of a dirty rectangle
+ *
+ *  The plan must hold the output of its input, i.e. run once by
+ *  alg6_gpu() after the input is uploaded (see upload()), then each
+ *  update writes the new pixels of a dirty rectangle in the plan
+ *  input and refilters only their changes, adding them to the plan
+ *  output.  Running alg6_gpu() again refilters the whole input (e.g.
+ *  to clear the rounding of many updates or their changes below the
+ *  tolerance).
+ *
+ *  @param[in,out] plan The plan with the previous input and output
+ *  @param[in] img The new pixels of the rectangle (in device memory by default)
+ *  @param[in] pitch The new pixels pitch in bytes (row size in memory)
+ *  @param[in] x Rectangle left column
+ *  @param[in] y Rectangle top row
+ *  @param[in] width Rectangle width
+ *  @param[in] height Rectangle height
+ *  @param[in] kind Memory copy kind (where the new pixels are)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_update( alg6_incr_plan<R>& plan,
+                  const float *img,
+                  size_t pitch,
+                  int x, int y,
+                  int width, int height,
+                  cudaMemcpyKind kind=cudaMemcpyDeviceToDevice ) {
+
+    if (x < 0 || y < 0 || width <= 0 || height <= 0 ||
+        x+width > plan.width || y+height > plan.height)
+        throw std::runtime_error("Dirty rectangle outside the image");
+    if (plan.half || plan.inplace || plan.out_format != PIXEL_FLOAT ||
+        plan.out_width != plan.width || plan.out_height != plan.height ||
+        plan.batch != 1 || plan.channels != 1 || plan.axes != BOTH_AXES)
+        throw std::runtime_error("Incremental refiltering needs the whole output of one image in float storage");
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    cudaStream_t stream = plan.stream;
+
+    plan.d_new.set_stream(stream); // the old pixels may still be read
+    plan.d_new.resize(width*height);
+    cudaMemcpy2DAsync(&plan.d_new, width*sizeof(float), img, pitch,
+                      width*sizeof(float), height, kind, stream);
+
+    // the carries of changes are zero outside the dirty blocks
+    cudaMemsetAsync(&plan.d_pybar, 0, plan.d_pybar.size()*sizeof(Matrix<float,R,WS>), stream);
+    cudaMemsetAsync(&plan.d_ezhat, 0, plan.d_ezhat.size()*sizeof(Matrix<float,R,WS>), stream);
+    cudaMemsetAsync(&plan.d_ptucheck, 0, plan.d_ptucheck.size()*sizeof(Matrix<float,R,WS>), stream);
+    cudaMemsetAsync(&plan.d_etvtilde, 0, plan.d_etvtilde.size()*sizeof(Matrix<float,R,WS>), stream);
+
+    const int m0 = x/WS, n0 = y/WS,
+        m1 = (x+width-1)/WS, n1 = (y+height-1)/WS,
+        nrows = n1-n0+1;
+
+    alg6_incr_step1<<< dim3(m1-m0+1, nrows), dim3(WS, NWC), 0, stream >>>
+        ( plan.tex_in, &plan.d_new, width, x, y, width, height,
+          &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size );
+
+    // only the rows of blocks crossing the rectangle have row carries
+    alg3v4v5v6_step2v4<<< dim3(1, nrows), dim3(WS, NWA), 0, stream >>>
+        ( &plan.d_pybar + n0*(m_size+1), &plan.d_ezhat + n0*(m_size+1),
+          plan.params, m_size );
+
+    alg6_step3<<< dim3(m_size, nrows), dim3(WS, NWARC), 0, stream >>>
+        ( &plan.d_ptucheck + n0, &plan.d_etvtilde + n0,
+          &plan.d_pybar + n0*(m_size+1), &plan.d_ezhat + n0*(m_size+1),
+          &plan.d_cmat, plan.params, m_size, n_size );
+
+    launch_alg3v4v5v6_step2v4(plan, &plan.d_ptucheck, &plan.d_etvtilde, n_size, m_size, true);
+
+    const int r = plan.reach,
+        rm0 = std::max(0, m0-r), rn0 = std::max(0, n0-r),
+        rm1 = std::min(m_size-1, m1+r), rn1 = std::min(n_size-1, n1+r);
+
+    alg6_incr_step5<<< dim3(rm1-rm0+1, rn1-rn0+1), dim3(WS, NWW), 0, stream >>>
+        ( plan.tex_in, &plan.d_new, width, x, y, width, height,
+          &plan.d_img, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, rm0, rn0, m_size, n_size,
+          plan.width, plan.height, plan.stride_img );
+
+    // the new pixels become the plan input
+    cudaMemcpy3DParms parms = {0};
+    parms.srcPtr = make_cudaPitchedPtr((void *)&plan.d_new, width*sizeof(float),
+                                       width, height);
+    parms.dstArray = plan.a_in;
+    parms.dstPos = make_cudaPos(x, y, 0);
+    parms.extent = make_cudaExtent(width, height, 1);
+    parms.kind = cudaMemcpyDeviceToDevice;
+    cudaMemcpy3DAsync(&parms, stream);
+
+    check_cuda_error("Error refiltering dirty rectangle");
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_INCR_CUH
+//==============================================================================
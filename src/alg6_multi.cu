@@ -0,0 +1,81 @@
+/**
+ *  @file alg6_multi.cu
+ *  @brief Algorithm 6 in multiple GPUs
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_multi_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "refcheck.cuh"
+#include "alg6_multi_gpu.cuh"
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, gpu_img, w, a0border, me, mre,
+                  argc, argv);
+
+    if (border != 0 || btype != gpufilter::CLAMP_TO_ZERO) {
+        std::cerr << APPNAME << " Only zero border is supported in multiple GPUs\n";
+        return 1;
+    }
+
+    int devices = 0;
+    cudaGetDeviceCount(&devices);
+
+    if (runtimes == 1) { // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+        std::cout << APPNAME << " Number of devices: " << devices << "\n";
+    }
+
+    gpufilter::alg0_cached<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+
+    gpufilter::alg6_multi_gpu<ORDER>(&gpu_img[0], width, height, runtimes, w);
+
+    gpufilter::check_gpu_reference( &cpu_img[0], &gpu_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,394 @@
+/**
+ *  @file alg6_multi_gpu.cuh
+ *  @brief Algorithm 6 in multiple GPUs exchanging border carries
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_MULTI_GPU_CUH
+#define ALG6_MULTI_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg6_multi_plan alg6_multi_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of algorithm 6 splitting the image in bands of rows, one per GPU
+ *
+ *  The \f$N\f$ rows of blocks of the image are partitioned in
+ *  contiguous bands, each band filtered by an algorithm 6 plan in its
+ *  own GPU and stream.  Steps 1, 2 and 3 (row carries) are local to
+ *  each band, only the column carries crossing band borders (one
+ *  \f$P^T\f$ row of carries forward and one \f$E^T\f$ row of carries
+ *  backward) are exchanged, peer-to-peer when possible, chaining the
+ *  step 4 of the bands.  Only zero border (clamp-to-zero without
+ *  border blocks) is supported, since the input array of each band
+ *  holds only the band rows.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_multi_plan {
+
+    int width, height; ///< Image width and height
+    int channels; ///< Number of interleaved channels per pixel (1 to 4)
+    std::vector<int> devices; ///< Device of each band
+    std::vector<int> rows; ///< First image row of each band
+    std::vector< alg6_plan<false,R>* > bands; ///< Plan of each band (in its device)
+    std::vector<cudaEvent_t> e_fwd, e_rev, e_done; ///< Carry exchange and completion events per band
+
+    /// Default constructor
+    alg6_multi_plan() : width(0), height(0), channels(1) { }
+
+    /// Destructor
+    ~alg6_multi_plan() {
+        release();
+    }
+
+    /// Release all band plans, streams and events (each in its device)
+    void release() {
+        for (size_t k = 0; k < bands.size(); ++k) {
+            cudaSetDevice(devices[k]);
+            cudaStreamSynchronize(bands[k]->stream);
+            cudaStreamDestroy(bands[k]->stream);
+            cudaEventDestroy(e_fwd[k]);
+            cudaEventDestroy(e_rev[k]);
+            cudaEventDestroy(e_done[k]);
+            delete bands[k];
+        }
+        if (!devices.empty()) cudaSetDevice(devices[0]);
+        devices.clear(); rows.clear(); bands.clear();
+        e_fwd.clear(); e_rev.clear(); e_done.clear();
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    alg6_multi_plan( const alg6_multi_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    alg6_multi_plan& operator = ( const alg6_multi_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the multi-GPU algorithm 6 plan
+ *
+ *  The rows of blocks are split as evenly as possible among the
+ *  devices (devices without at least one row of blocks are not
+ *  used).  Peer access is enabled between the devices of neighbour
+ *  bands when supported, otherwise the carry exchange is staged by
+ *  the driver through the host.
+ *
+ *  @param[out] plan The multi-GPU plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] num_devices Number of devices to use (zero means all visible)
+ *  @param[in] channels Number of interleaved channels per pixel (1 to 4)
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg6_multi( alg6_multi_plan<R>& plan,
+                         const int& width, const int& height,
+                         const Vector<float, R+1>& w,
+                         int num_devices=0,
+                         const int& channels=1 ) {
+
+    int count = 0;
+    cudaGetDeviceCount(&count);
+    check_cuda_error("Error querying devices");
+    if (num_devices <= 0 || num_devices > count)
+        num_devices = count;
+    if (num_devices < 1)
+        throw std::runtime_error("No device available");
+
+    plan.release();
+
+    plan.width = width;
+    plan.height = height;
+    plan.channels = channels;
+
+    int n_size = (height+WS-1)/WS;
+    if (num_devices > n_size)
+        num_devices = n_size;
+
+    for (int k = 0; k < num_devices; ++k) {
+
+        int n0 = (n_size*k)/num_devices, n1 = (n_size*(k+1))/num_devices;
+        int row0 = n0*WS, row1 = std::min(n1*WS, height);
+
+        cudaSetDevice(k);
+
+        alg6_plan<false,R> *band = new alg6_plan<false,R>;
+        prepare_alg6(*band, width, row1-row0, w, 0, CLAMP_TO_ZERO, 1, channels);
+        cudaStreamCreateWithFlags(&band->stream, cudaStreamNonBlocking);
+
+        cudaEvent_t e[3];
+        for (int i = 0; i < 3; ++i)
+            cudaEventCreateWithFlags(&e[i], cudaEventDisableTiming);
+
+        plan.devices.push_back(k);
+        plan.rows.push_back(row0);
+        plan.bands.push_back(band);
+        plan.e_fwd.push_back(e[0]);
+        plan.e_rev.push_back(e[1]);
+        plan.e_done.push_back(e[2]);
+
+        if (k > 0) { // peer access between neighbour bands (both ways)
+            int fwd = 0, bwd = 0;
+            cudaDeviceCanAccessPeer(&fwd, k, k-1);
+            cudaDeviceCanAccessPeer(&bwd, k-1, k);
+            if (fwd && bwd) {
+                cudaDeviceEnablePeerAccess(k-1, 0);
+                cudaSetDevice(k-1);
+                cudaDeviceEnablePeerAccess(k, 0);
+            }
+            cudaGetLastError(); // already enabled is not an error here
+        }
+
+        check_cuda_error("Error preparing multi-GPU band");
+
+    }
+
+    cudaSetDevice(plan.devices[0]);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 in multiple GPUs
+ *
+ *  Each band runs steps 1, 2 and 3 independently.  Step 4 is split
+ *  in its forward and reverse halves: the forward half runs band
+ *  after band from top to bottom, each band receiving in its
+ *  (padding) slot zero the last \f$P^T\f$ row of carries of the
+ *  previous band; the reverse half runs from bottom to top, each band
+ *  receiving in its slot \f$N\f$ the first \f$E^T\f$ row of carries of
+ *  the next band.  Step 5 is again independent.  All work is
+ *  asynchronous, ordered by events between the band streams.
+ *
+ *  @param[in,out] plan The multi-GPU plan (with its input uploaded)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_multi_gpu( alg6_multi_plan<R>& plan ) {
+
+    const int nb = (int)plan.bands.size();
+
+    for (int k = 0; k < nb; ++k) { // steps 1, 2 and 3 in all bands
+
+        alg6_plan<false,R>& band = *plan.bands[k];
+        const int m_size = band.m_size, n_size = band.n_size,
+            batch = band.batch*band.channels;
+
+        cudaSetDevice(plan.devices[k]);
+
+        launch_alg5v6_step1<false>(band, &band.d_pybar, &band.d_ezhat,
+                                   &band.d_ptucheck, &band.d_etvtilde, band.params);
+
+        alg3v4v5v6_step2v4<<< dim3(1, n_size, batch), dim3(WS, NWA), 0, band.stream >>>
+            ( &band.d_pybar, &band.d_ezhat, band.params, m_size );
+
+        alg6_step3<<< dim3(m_size, n_size, batch), dim3(WS, NWARC), 0, band.stream >>>
+            ( &band.d_ptucheck, &band.d_etvtilde, &band.d_pybar, &band.d_ezhat,
+              &band.d_cmat, band.params, m_size, n_size );
+
+    }
+
+    for (int k = 0; k < nb; ++k) { // step 4 forward, top to bottom
+
+        alg6_plan<false,R>& band = *plan.bands[k];
+        const int m_size = band.m_size, n_size = band.n_size,
+            batch = band.batch*band.channels;
+
+        cudaSetDevice(plan.devices[k]);
+
+        if (k > 0) cudaStreamWaitEvent(band.stream, plan.e_fwd[k-1], 0);
+
+        alg3v4v5v6_step2v4_fwd<<< dim3(1, m_size, batch), dim3(WS, NWA), 0, band.stream >>>
+            ( &band.d_ptucheck, band.params, n_size );
+
+        if (k < nb-1) {
+            alg6_plan<false,R>& next = *plan.bands[k+1];
+            // the next band may still be reading its carries (previous run)
+            cudaStreamWaitEvent(band.stream, plan.e_done[k+1], 0);
+            copy_column_carries(&next.d_ptucheck, 0, next.n_size,
+                                &band.d_ptucheck, n_size, n_size,
+                                m_size*batch, band.stream);
+            cudaEventRecord(plan.e_fwd[k], band.stream);
+        }
+
+    }
+
+    for (int k = nb-1; k >= 0; --k) { // step 4 reverse, bottom to top
+
+        alg6_plan<false,R>& band = *plan.bands[k];
+        const int m_size = band.m_size, n_size = band.n_size,
+            batch = band.batch*band.channels;
+
+        cudaSetDevice(plan.devices[k]);
+
+        if (k < nb-1) cudaStreamWaitEvent(band.stream, plan.e_rev[k+1], 0);
+
+        alg3v4v5v6_step2v4_rev<<< dim3(1, m_size, batch), dim3(WS, NWA), 0, band.stream >>>
+            ( &band.d_ptucheck, &band.d_etvtilde, band.params, n_size );
+
+        if (k > 0) {
+            alg6_plan<false,R>& prev = *plan.bands[k-1];
+            cudaStreamWaitEvent(band.stream, plan.e_done[k-1], 0);
+            copy_column_carries(&prev.d_etvtilde, prev.n_size, prev.n_size,
+                                &band.d_etvtilde, 0, n_size,
+                                m_size*batch, band.stream);
+            cudaEventRecord(plan.e_rev[k], band.stream);
+        }
+
+    }
+
+    for (int k = 0; k < nb; ++k) { // step 5 in all bands
+
+        alg6_plan<false,R>& band = *plan.bands[k];
+
+        cudaSetDevice(plan.devices[k]);
+
+        launch_alg5v6_step4v5<false>(band, &band.d_pybar, &band.d_ezhat,
+                                     &band.d_ptucheck, &band.d_etvtilde, band.params);
+
+        cudaEventRecord(plan.e_done[k], band.stream);
+
+    }
+
+    cudaSetDevice(plan.devices[0]);
+    check_cuda_error("Error running multi-GPU algorithm 6");
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Wait for all bands of a multi-GPU plan to finish
+ *  @param[in] plan The multi-GPU plan
+ *  @tparam R Filter order
+ */
+template <int R>
+void synchronize( const alg6_multi_plan<R>& plan ) {
+    for (size_t k = 0; k < plan.bands.size(); ++k) {
+        cudaSetDevice(plan.devices[k]);
+        cudaStreamSynchronize(plan.bands[k]->stream);
+    }
+    if (!plan.devices.empty()) cudaSetDevice(plan.devices[0]);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload an input image in host memory to the bands of the plan
+ *  @param[in,out] plan The multi-GPU plan to receive the input image
+ *  @param[in] h_img The input 2D image in host memory
+ *  @tparam R Filter order
+ */
+template <int R>
+void upload( alg6_multi_plan<R>& plan,
+             const float *h_img ) {
+    size_t pitch = plan.width*plan.channels*sizeof(float);
+    for (size_t k = 0; k < plan.bands.size(); ++k) {
+        cudaSetDevice(plan.devices[k]);
+        upload(*plan.bands[k], h_img + (size_t)plan.rows[k]*plan.width*plan.channels,
+               pitch, cudaMemcpyHostToDevice);
+    }
+    cudaSetDevice(plan.devices[0]);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the output image of the bands of the plan to host memory
+ *  @param[in] plan The multi-GPU plan with the output image
+ *  @param[out] h_img The output 2D image in host memory
+ *  @tparam R Filter order
+ */
+template <int R>
+void download( const alg6_multi_plan<R>& plan,
+               float *h_img ) {
+    synchronize(plan);
+    size_t pitch = plan.width*plan.channels*sizeof(float);
+    for (size_t k = 0; k < plan.bands.size(); ++k) {
+        cudaSetDevice(plan.devices[k]);
+        download(*plan.bands[k], h_img + (size_t)plan.rows[k]*plan.width*plan.channels,
+                 pitch, cudaMemcpyDeviceToHost);
+    }
+    cudaSetDevice(plan.devices[0]);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 in multiple GPUs
+ *
+ *  Given an input 2D image compute the recursive filtering with zero
+ *  border of the image splitting it among the devices.  The
+ *  throughput printed (when runtimes is more than one) counts the
+ *  time of all devices together, including the carry exchanges but
+ *  not the upload and download of the image.
+ *
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] num_devices Number of devices to use (zero means all visible)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_multi_gpu( float *h_img,
+                     const int& width, const int& height, const int& runtimes,
+                     const Vector<float, R+1>& w,
+                     int num_devices=0 ) {
+
+    alg6_multi_plan<R> plan;
+    prepare_alg6_multi(plan, width, height, w, num_devices);
+
+    upload(plan, h_img);
+    synchronize(plan);
+
+    base_timer &timer_total = timers.cpu_add("alg6_multi_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_multi_gpu(plan);
+
+    synchronize(plan);
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+    download(plan, h_img);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_MULTI_GPU_CUH
+//==============================================================================
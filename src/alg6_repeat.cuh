@@ -24,10 +24,12 @@ namespace gpufilter {
  *  @see The base algorithm description in alg6_stage1()
  *
  *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
  *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
  *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights)
  *  @param[in] inv_width Image width inversed (1/w)
  *  @param[in] inv_height Image height inversed (1/h)
  *  @param[in] m_size The big M (number of row blocks)
@@ -36,17 +38,19 @@ namespace gpufilter {
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void alg6_repeat_stage1( Matrix<float,R,WS> *g_pybar,
+void alg6_repeat_stage1( cudaTextureObject_t tex,
+                         Matrix<float,R,WS> *g_pybar,
                          Matrix<float,R,WS> *g_ezhat,
                          Matrix<float,R,WS> *g_ptucheck,
                          Matrix<float,R,WS> *g_etvtilde,
+                         const filter_params<R> params,
                          float inv_width, float inv_height,
                          int m_size, int n_size ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWC>(block, m, n, inv_width, inv_height);
+    read_block<NWC>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32]; // 32 regs
@@ -61,7 +65,7 @@ void alg6_repeat_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate pybar, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
         g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
         
@@ -69,7 +73,7 @@ void alg6_repeat_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ezhat, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, params.weights);
 
         g_ezhat[n*(m_size+1)+m].set_col(tx, e);
 
@@ -84,7 +88,7 @@ void alg6_repeat_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ptucheck, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
         g_ptucheck[m*(n_size+1)+n+1].set_col(tx, p);
 
@@ -92,7 +96,7 @@ void alg6_repeat_stage1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate etvtilde, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            revI(x[j], e, c_weights);
+            revI(x[j], e, params.weights);
 
         g_etvtilde[m*(n_size+1)+n].set_col(tx, e);
 
@@ -114,6 +118,8 @@ void alg6_repeat_stage1( Matrix<float,R,WS> *g_pybar,
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
  *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] bparams Carry matrices of the exact boundaries
  *  @param[in] m_size The big M or N
  *  @tparam in_width Flag for choosing stage 2 or 4
  *  @tparam R Filter order
@@ -122,6 +128,8 @@ template <bool in_width, int R>
 __global__ __launch_bounds__(WS*NWA, NBA)
 void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
                            Matrix<float,R,WS> *g_ezhat,
+                           const filter_params<R> params,
+                           const border_params<R> bparams,
                            int m_size ) {
 
     int tx = threadIdx.x, ty = threadIdx.y, m, n = blockIdx.y;
@@ -148,7 +156,7 @@ void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
 
                 pybar = spybar[w].col(tx);
 
-                py = pybar + py * c_AbF_T;
+                py = pybar + py * params.AbF_T;
 
             }
         }
@@ -165,8 +173,8 @@ void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
     if (ty == 0) {
 
         gpybar = (Matrix<float,R,WS> *)&g_pybar[n*(m_size+1)+m][0][tx];
-        if (in_width)  py = py * c_IAwF_T;
-        else py = py * c_IAhF_T;
+        if (in_width)  py = py * bparams.IAwF_T;
+        else py = py * bparams.IAhF_T;
         gpybar->set_col(0, py);
 
     }
@@ -186,7 +194,7 @@ void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
 
                 pybar = spybar[w].col(tx);
 
-                py = pybar + py * c_AbF_T;
+                py = pybar + py * params.AbF_T;
 
                 spybar[w].set_col(tx, py);
 
@@ -225,7 +233,7 @@ void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
                 ezhat = sezhat[w].col(tx);
                 py = spybar[w].col(tx);
 
-                ez = ezhat + py * c_HARB_AFP_T + ez * c_AbR_T;
+                ez = ezhat + py * params.HARB_AFP_T + ez * params.AbR_T;
 
             }
         }
@@ -243,8 +251,8 @@ void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
     if (ty == 0) {
 
         gezhat = (Matrix<float,R,WS> *)&g_ezhat[n*(m_size+1)+m+1][0][tx];
-        if (in_width) ez = ez * c_IAwR_T;
-        else ez = ez * c_IAhR_T;
+        if (in_width) ez = ez * bparams.IAwR_T;
+        else ez = ez * bparams.IAhR_T;
         gezhat->set_col(0, ez);
 
     }
@@ -269,7 +277,7 @@ void alg6_repeat_stage2v4( Matrix<float,R,WS> *g_pybar,
                 ezhat = sezhat[w].col(tx);
                 py = spybar[w].col(tx);
 
-                ez = ezhat + py * c_HARB_AFP_T + ez * c_AbR_T;
+                ez = ezhat + py * params.HARB_AFP_T + ez * params.AbR_T;
 
                 sezhat[w].set_col(tx, ez);
 
@@ -375,11 +383,13 @@ void alg6_repeat_stage3( Matrix<float,R,WS> *g_ptucheck,
  *  @see The base algorithm description in alg6_stage5()
  *
  *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
  *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
  *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights)
  *  @param[in] inv_width Image width inversed (1/w)
  *  @param[in] inv_height Image height inversed (1/h)
  *  @param[in] m_size The big M (number of row blocks)
@@ -389,11 +399,13 @@ void alg6_repeat_stage3( Matrix<float,R,WS> *g_ptucheck,
  */
 template <int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void alg6_repeat_stage5( float *g_out,
+void alg6_repeat_stage5( cudaTextureObject_t tex,
+                         float *g_out,
                          const Matrix<float,R,WS> *g_py,
                          const Matrix<float,R,WS> *g_ez,
                          const Matrix<float,R,WS> *g_ptu,
                          const Matrix<float,R,WS> *g_etv,
+                         const filter_params<R> params,
                          float inv_width, float inv_height,
                          int m_size, int n_size,
                          int out_stride ) {
@@ -401,7 +413,7 @@ void alg6_repeat_stage5( float *g_out,
     int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
 
     __shared__ Matrix<float,WS,WS+1> block;
-    read_block<NWW>(block, m, n, inv_width, inv_height);
+    read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     float x[32];
@@ -420,7 +432,7 @@ void alg6_repeat_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
 #pragma unroll
         for (int r=0; r<R; ++r)
@@ -428,7 +440,7 @@ void alg6_repeat_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan right -> left
         for (int j=WS-1; j>=0; --j)
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, params.weights);
 
 #pragma unroll // tranpose regs part-1
         for (int i=0; i<32; ++i)
@@ -443,7 +455,7 @@ void alg6_repeat_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            x[j] = fwdI(p, x[j], c_weights);
+            x[j] = fwdI(p, x[j], params.weights);
 
 #pragma unroll
         for (int r=0; r<R; ++r)
@@ -451,7 +463,7 @@ void alg6_repeat_stage5( float *g_out,
 
 #pragma unroll // calculate block, scan bottom -> top
         for (int j=WS-1; j>=0; --j)
-            x[j] = revI(x[j], e, c_weights);
+            x[j] = revI(x[j], e, params.weights);
 
         g_out += ((n+1)*WS-1)*out_stride + m*WS+tx;
 #pragma unroll // write block
@@ -463,54 +475,38 @@ void alg6_repeat_stage5( float *g_out,
 }
 
 /**
+ *  @struct alg6_repeat_plan alg6_repeat.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm 6 for repeat in the GPU
- *
- *  @see [NehabMaximo:2016] cited in alg6()
- *  @param[in,out] h_img The in/output 2D image to compute recursive filtering in host memory
- *  @param[in] width Image width
- *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
- *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @brief Filter plan of algorithm 6 for repeat
  *  @tparam R Filter order
  */
 template <int R>
+struct alg6_repeat_plan : public alg5v6_plan<R> {
+    border_params<R> bparams; ///< Repeat carry matrices (in width and height) passed to kernels
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Pre-compute the repeat carry matrices of a plan
+ *
+ *  The repeat matrices depend on the image width (for rows) and
+ *  height (for columns).
+ *
+ *  @param[in,out] plan The plan (with the filter matrices and sizes) to store the matrices in
+ *  @tparam R Filter order
+ *  @tparam P Plan type (with the repeat carry matrices)
+ */
+template <int R, class P>
 __host__
-void alg6_repeat( float *h_img,
-                  const int& width, const int& height, const int& runtimes,
-                  const Vector<float, R+1>& w ) {
+void prepare_repeat_matrices( P& plan ) {
 
-    const int B = WS;
+    const int m_size = plan.m_size, n_size = plan.n_size;
+    const Matrix<float,R,R>& AbF_T = plan.mat.AbF_T;
+    const Matrix<float,R,R>& AbR_T = plan.mat.AbR_T;
 
-    // pre-compute basic alg5 matrices
     Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
-
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w), ARE_T = rev(Zrb, Ir, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w), ARB_T = rev(Ib, Zbr, w);
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T), AbR_T = head<R>(ARE_T);
-    Matrix<float,R,R> AbF = transp(AbF_T), AbR = transp(AbR_T);
-    Matrix<float,R,R> HARB_AFP_T = AFP_T*head<R>(ARB_T);
-    Matrix<float,R,R> HARB_AFP = transp(HARB_AFP_T);
-    Matrix<float,R,B> ARB_AFP_T = AFP_T*ARB_T, TAFB = transp(tail<R>(AFB_T));
-    Matrix<float,R,B> HARB_AFB = transp(AFB_T*head<R>(ARB_T));
-
-    const int m_size = (width+WS-1)/WS, n_size = (height+WS-1)/WS;
 
     // pre-compute repeat matrices
-    Matrix<float,R,R> ArF_T = head<R>(AFP_T), AbarF_T;
-    
-    for (int i=0; i<R; ++i) {
-        int j;
-        for (j=0; j<i; ++j) AbarF_T[i][j] = 0;
-        AbarF_T[i][j] = w[0];
-        for (++j; j<R; ++j) AbarF_T[i][j] = w[0]*ArF_T[R-1][j-i-1];
-    }
-
-    Matrix<float,R,R> ArR_T = flip(ArF_T), AbarR_T = flip(AbarF_T);
-
     std::vector< Matrix<float,R,R> > AbmF_T(m_size), AbmR_T(m_size);
     std::vector< Matrix<float,R,R> > AbnF_T(n_size), AbnR_T(n_size);
 
@@ -531,54 +527,32 @@ void alg6_repeat( float *h_img,
     Matrix<float,R,R> AwR_T = AbmR_T[0];
     Matrix<float,R,R> AhR_T = AbnR_T[0];
 
-    Matrix<float,R,R> IAwF_T = inv(Ir - AwF_T);
-    Matrix<float,R,R> IAwR_T = inv(Ir - AwR_T);
-    Matrix<float,R,R> IAhF_T = inv(Ir - AhF_T);
-    Matrix<float,R,R> IAhR_T = inv(Ir - AhR_T);
-
-    Matrix<float,R,R> HARw_AFP_T = ArF_T*AwR_T;
-    Matrix<float,R,R> HARh_AFP_T = ArF_T*AhR_T;
-
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AbR_T, AbR_T);
-    copy_to_symbol(c_HARB_AFP_T, HARB_AFP_T);
+    plan.bparams.IAwF_T = inv(Ir - AwF_T);
+    plan.bparams.IAwR_T = inv(Ir - AwR_T);
+    plan.bparams.IAhF_T = inv(Ir - AhF_T);
+    plan.bparams.IAhR_T = inv(Ir - AhR_T);
 
-    copy_to_symbol(c_ARE_T, ARE_T);
-    copy_to_symbol(c_ARB_AFP_T, ARB_AFP_T);
-    copy_to_symbol(c_TAFB, TAFB);
-    copy_to_symbol(c_HARB_AFB, HARB_AFB);
-
-    copy_to_symbol(c_IAwF_T, IAwF_T);
-    copy_to_symbol(c_IAwR_T, IAwR_T);
-    copy_to_symbol(c_IAhF_T, IAhF_T);
-    copy_to_symbol(c_IAhR_T, IAhR_T);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
+}
 
-    int stride_img = width+WS;
-    dvector<float> d_img(height*stride_img);
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 for repeat plan in the GPU
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void prepare_alg6_repeat( alg6_repeat_plan<R>& plan,
+                          const int& width, const int& height,
+                          const Vector<float, R+1>& w ) {
 
-    dvector< Matrix<float,R,B> > d_pybar((m_size+1)*n_size), d_ezhat((m_size+1)*n_size);
-    dvector< Matrix<float,R,B> > d_ptucheck((n_size+1)*m_size), d_etvtilde((n_size+1)*m_size);
-    d_pybar.fillzero();
-    d_ezhat.fillzero();
-    d_ptucheck.fillzero();
-    d_etvtilde.fillzero();
+    prepare_alg5v6(plan, width, height, w, 0, REPEAT, false);
 
-    Matrix<float,R,B> h_cmat[4] = { ARE_T, ARB_AFP_T, TAFB, HARB_AFB };
-    dvector< Matrix<float,R,B> > d_cmat(h_cmat, 4);
+    prepare_repeat_matrices<R>(plan);
 
     cudaFuncSetCacheConfig(alg6_repeat_stage1<R>, cudaFuncCachePreferShared);
     cudaFuncSetCacheConfig(alg6_repeat_stage5<R>, cudaFuncCachePreferShared);
@@ -595,66 +569,117 @@ void alg6_repeat( float *h_img,
         cudaFuncSetCacheConfig(alg6_repeat_stage2v4<false, R>, cudaFuncCachePreferShared);
     }
 
-    double te[5] = {0, 0, 0, 0, 0}; // time elapsed for the five stages
-    base_timer *timer[5];
-    for (int i = 0; i < 5; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+}
 
-    base_timer &timer_total = timers.gpu_add("alg6_repeat", width*height, "iP");
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 for repeat plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional five timers to measure each stage
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void alg6_repeat( alg6_repeat_plan<R>& plan,
+                  base_timer **timer=0 ) {
 
-    for(int r = 0; r < runtimes; ++r) {
+    check_whole_output(plan);
 
-        if (runtimes == 1) { timer[0]->start(); }
+    if (!timer && launch_graph(plan, alg6_repeat<R>))
+        return; // replayed the captured kernels (see plan_graph)
 
-        cudaBindTextureToArray(t_in, a_in);
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
-        alg6_repeat_stage1<<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size );
+    if (timer) timer[0]->start();
 
-        if (runtimes == 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    alg6_repeat_stage1<<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size );
 
-        alg6_repeat_stage2v4<true><<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_pybar, &d_ezhat, m_size );
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-        if (runtimes == 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    alg6_repeat_stage2v4<true><<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pybar, &plan.d_ezhat, plan.params, plan.bparams, m_size );
 
-        alg6_repeat_stage3<<< dim3(m_size, n_size), dim3(WS, NWARC) >>>
-            ( &d_ptucheck, &d_etvtilde, &d_pybar, &d_ezhat, &d_cmat, m_size, n_size );
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
 
-        if (runtimes == 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+    alg6_repeat_stage3<<< dim3(m_size, n_size), dim3(WS, NWARC), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_cmat, m_size, n_size );
 
-        alg6_repeat_stage2v4<false><<< dim3(1, m_size), dim3(WS, NWA) >>>
-            ( &d_ptucheck, &d_etvtilde, n_size );
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        if (runtimes == 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); timer[4]->start(); }
+    alg6_repeat_stage2v4<false><<< dim3(1, m_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, plan.params, plan.bparams, n_size );
 
-        alg6_repeat_stage5<<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar, &d_ezhat, &d_ptucheck, &d_etvtilde, inv_width, inv_height, m_size, n_size, stride_img );
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
 
-        cudaUnbindTexture(t_in);
+    alg6_repeat_stage5<<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck, &plan.d_etvtilde,
+          plan.params, plan.inv_width, plan.inv_height, m_size, n_size, plan.stride_img );
 
-        if (runtimes == 1) { timer[4]->stop(); te[4] += timer[4]->elapsed(); }
+    if (timer) timer[4]->stop();
 
-    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 for repeat in the GPU
+ *
+ *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in/output 2D image to compute recursive filtering in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ */
+template <int R>
+__host__
+void alg6_repeat( float *h_img,
+                  const int& width, const int& height, const int& runtimes,
+                  const Vector<float, R+1>& w ) {
+
+    alg6_repeat_plan<R> plan;
+    prepare_alg6_repeat(plan, width, height, w);
+
+    upload(plan, h_img);
+
+    const char *steps[5] = { "stage 1", "stage 2", "stage 3", "stage 4", "stage 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i)
+        timer[i] = new step_timer(std::string("alg6_repeat ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg6_repeat", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_repeat(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 5; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        if (timed) {
+            for (int i = 0; i < 5; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
 
     } else {
 
-        timers.gpu_add("stage 1", timer[0]);
-        timers.gpu_add("stage 2", timer[1]);
-        timers.gpu_add("stage 3", timer[2]);
-        timers.gpu_add("stage 4", timer[3]);
-        timers.gpu_add("stage 5", timer[4]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
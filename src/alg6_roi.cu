@@ -0,0 +1,145 @@
+/**
+ *  @file alg6_roi.cu
+ *  @brief Algorithm 6 in the GPU with the whole output versus a region of interest
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_roi_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg6_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Run an algorithm 6 plan and download its output to the host
+ *  @param[in,out] plan The plan to run
+ *  @param[in] h_in The input 2D image in the host
+ *  @param[out] h_out The output 2D image (or region) in the host
+ *  @param[in] runtimes Number of run times to average
+ *  @return Time elapsed (average in seconds) of filter and download
+ */
+template <int R>
+double run_alg6( gpufilter::alg6_plan<false,R>& plan,
+                 const float *h_in,
+                 float *h_out,
+                 int runtimes ) {
+    gpufilter::upload(plan, h_in);
+    gpufilter::alg6_gpu(plan); // warm up
+    gpufilter::gpu_timer timer(0, "", false);
+    timer.start();
+    for (int r = 0; r < runtimes; ++r) {
+        gpufilter::alg6_gpu(plan);
+        gpufilter::download(plan, h_out);
+    }
+    timer.stop();
+    return timer.elapsed() / runtimes;
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 8192, height = 8192;
+    int runtimes = 1; // # of run times (1 for debug; 1000 for performance)
+    int rx = 3001, ry = 2017, rw = 640, rh = 480; // region of interest
+    float me = 0.f, mre = 0.f; // maximum error and maximum relative error
+
+    if ((argc != 1 && argc != 4 && argc != 8) ||
+        (argc >= 4 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%d", &runtimes) != 1)) ||
+        (argc == 8 && (sscanf(argv[4], "%d", &rx) != 1 ||
+                       sscanf(argv[5], "%d", &ry) != 1 ||
+                       sscanf(argv[6], "%d", &rw) != 1 ||
+                       sscanf(argv[7], "%d", &rh) != 1)) ||
+        rx < 0 || ry < 0 || rw <= 0 || rh <= 0 ||
+        rx+rw > width || ry+rh > height) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height runtimes [x y roi_width roi_height]]\n";
+        return 1;
+    }
+
+    std::vector< float > cpu_img(width*height), in_img(width*height),
+        full_img(width*height), roi_img(rw*rh);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        in_img[i] = cpu_img[i] = rand() / (float)RAND_MAX;
+
+    float sigma = 4.f; // width / 6.f;
+
+    gpufilter::Vector<float, ORDER+1> w;
+    gpufilter::weights(sigma, w);
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Order: " << ORDER << "  Run-times: 1\n";
+        std::cout << APPNAME << " Region: " << rw << " x " << rh
+                  << " at (" << rx << ", " << ry << ")\n";
+        std::cout << APPNAME << " Weights: " << w << "\n";
+        std::cout << APPNAME << " (1) Runs the reference in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the GPU writing the whole image (full)\n";
+        std::cout << APPNAME << " (3) Runs the GPU writing the region (res)\n";
+        std::cout << APPNAME << " (4) Checks computations (ref x res)\n";
+    }
+
+    gpufilter::alg0_cpu<ORDER>(&cpu_img[0], width, height, w);
+
+    gpufilter::alg6_plan<false,ORDER> full, roi;
+    gpufilter::prepare_alg6(full, width, height, w);
+    gpufilter::prepare_alg6(roi, width, height, w);
+    gpufilter::prepare_roi(roi, rx, ry, rw, rh);
+
+    double tf = run_alg6(full, &in_img[0], &full_img[0], runtimes),
+        tr = run_alg6(roi, &in_img[0], &roi_img[0], runtimes);
+
+    std::cout << std::fixed << APPNAME << " [output] [filter+download-ms]\n";
+    std::cout << APPNAME << " full   " << std::setprecision(3) << tf*1000 << "\n";
+    std::cout << APPNAME << " region " << std::setprecision(3) << tr*1000 << "\n";
+    std::cout << APPNAME << " Saved: " << std::setprecision(1)
+              << 100.*(tf-tr)/tf << "% time\n";
+
+    std::vector< float > cpu_roi(rw*rh);
+    for (int y = 0; y < rh; ++y)
+        std::copy(&cpu_img[(ry+y)*width+rx], &cpu_img[(ry+y)*width+rx+rw],
+                  &cpu_roi[y*rw]);
+
+    gpufilter::check_cpu_reference( &cpu_roi[0], &roi_img[0], rw*rh, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error] res:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
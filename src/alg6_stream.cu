@@ -0,0 +1,75 @@
+/**
+ *  @file alg6_stream.cu
+ *  @brief Algorithm 6 streaming strips of the image through the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#ifndef STRIP_ROWS
+#define STRIP_ROWS 256 // rows of each strip streamed (zero means from free memory)
+#endif
+#define APPNAME "[alg6_stream_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "refcheck.cuh"
+#include "alg6_stream.cuh"
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, gpu_img, w, a0border, me, mre,
+                  argc, argv);
+
+    if (runtimes == 1) // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+
+    gpufilter::alg0_cached<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+
+    gpufilter::alg6_stream_gpu<ORDER>(&gpu_img[0], width, height, runtimes, w,
+                                      border, btype, STRIP_ROWS);
+
+    gpufilter::check_gpu_reference( &cpu_img[0], &gpu_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,427 @@
+/**
+ *  @file alg6_stream.cuh
+ *  @brief Algorithm 6 streaming strips of images larger than device memory
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_STREAM_CUH
+#define ALG6_STREAM_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg6_stream_plan alg6_stream.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of algorithm 6 streaming horizontal strips through the GPU
+ *
+ *  Only one strip of the image (a multiple of 32 rows) is in the
+ *  device at a time, filtered by a zero-border algorithm 6 plan.  The
+ *  image is streamed twice: top to bottom keeping only the last row
+ *  of forward column carries \f$P^T\f$ of each strip (in pinned host
+ *  memory), and bottom to top re-filtering each strip with its
+ *  incoming \f$P^T\f$ and \f$E^T\f$ carries, giving the output.  The
+ *  result is exactly the same as filtering the whole image in the
+ *  device.  Border blocks (approximating infinite extensions as in
+ *  alg6_gpu() with borders) are materialized in the host while
+ *  filling each strip, thus any border type is supported.  Host
+ *  strip buffers are pinned and double-buffered, overlapping the
+ *  host copies of one strip with the filtering of the other.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct alg6_stream_plan {
+
+    int width, height; ///< Image width and height
+    int border; ///< Number of border blocks (32x32) outside image
+    BorderType btype; ///< Border type (either zero, clamp, repeat or reflect)
+    int pad; ///< Border size in pixels (border blocks times 32)
+    int pwidth, pheight; ///< Padded image width and height (image plus border)
+    int strip_rows; ///< Number of rows of each strip (multiple of 32)
+    int n_strips; ///< Number of strips of the padded image
+    alg6_plan<false,R> strip; ///< Zero-border plan of one strip
+    float *h_in[2], *h_out[2]; ///< Pinned host strip buffers (double-buffered)
+    Matrix<float,R,WS> *h_pt; ///< Incoming forward column carries of each strip (pinned)
+    cudaEvent_t e_in[2], e_out[2]; ///< Upload and download done per strip buffer
+
+    /// Default constructor
+    alg6_stream_plan() : width(0), height(0), border(0), btype(CLAMP_TO_ZERO),
+                         pad(0), pwidth(0), pheight(0), strip_rows(0),
+                         n_strips(0), h_pt(0) {
+        h_in[0] = h_in[1] = h_out[0] = h_out[1] = 0;
+        e_in[0] = e_in[1] = e_out[0] = e_out[1] = 0;
+    }
+
+    /// Destructor
+    ~alg6_stream_plan() {
+        release();
+    }
+
+    /// Release pinned buffers, events and the strip stream
+    void release() {
+        if (strip.stream) {
+            cudaStreamSynchronize(strip.stream);
+            cudaStreamDestroy(strip.stream);
+            strip.stream = 0;
+        }
+        for (int i = 0; i < 2; ++i) {
+            if (h_in[i]) cudaFreeHost(h_in[i]);
+            if (h_out[i]) cudaFreeHost(h_out[i]);
+            if (e_in[i]) cudaEventDestroy(e_in[i]);
+            if (e_out[i]) cudaEventDestroy(e_out[i]);
+            h_in[i] = h_out[i] = 0;
+            e_in[i] = e_out[i] = 0;
+        }
+        if (h_pt) cudaFreeHost(h_pt);
+        h_pt = 0;
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    alg6_stream_plan( const alg6_stream_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    alg6_stream_plan& operator = ( const alg6_stream_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the streaming algorithm 6 plan
+ *
+ *  Given zero strip rows, the strip size is chosen to use about half
+ *  of the free device memory (the input array and output image of
+ *  one strip dominate the device footprint).  Infinite extensions
+ *  are approximated by border blocks, thus a border type other than
+ *  zero requires at least one border block.
+ *
+ *  @param[out] plan The streaming plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] strip_rows Number of rows of each strip (rounded up to 32)
+ *  @tparam R Filter order
+ */
+template <int R>
+void prepare_alg6_stream( alg6_stream_plan<R>& plan,
+                          const int& width, const int& height,
+                          const Vector<float, R+1>& w,
+                          const int& border=0,
+                          const BorderType& btype=CLAMP_TO_ZERO,
+                          int strip_rows=0 ) {
+
+    if (border == 0 && btype != CLAMP_TO_ZERO)
+        throw std::runtime_error("Streaming borders other than zero need border blocks");
+
+    plan.release();
+
+    plan.width = width;
+    plan.height = height;
+    plan.border = border;
+    plan.btype = btype;
+    plan.pad = border*WS;
+    plan.pwidth = width + 2*plan.pad;
+    plan.pheight = height + 2*plan.pad;
+
+    if (strip_rows <= 0) {
+        size_t free_mem = 0, total_mem = 0;
+        cudaMemGetInfo(&free_mem, &total_mem);
+        // array plus output image (aligned stride) plus the carries
+        size_t row_bytes = (size_t)(plan.pwidth+WS)*sizeof(float)*3;
+        strip_rows = (int)std::min(free_mem/2/row_bytes, (size_t)plan.pheight);
+    }
+    strip_rows = std::max(WS, (strip_rows+WS-1)/WS*WS);
+    strip_rows = std::min(strip_rows, (plan.pheight+WS-1)/WS*WS);
+
+    plan.strip_rows = strip_rows;
+    plan.n_strips = (plan.pheight+strip_rows-1)/strip_rows;
+
+    prepare_alg6(plan.strip, plan.pwidth, strip_rows, w);
+    cudaStreamCreateWithFlags(&plan.strip.stream, cudaStreamNonBlocking);
+
+    size_t strip_bytes = (size_t)plan.pwidth*strip_rows*sizeof(float),
+        carries = (size_t)plan.n_strips*plan.strip.m_size;
+
+    for (int i = 0; i < 2; ++i) {
+        cudaMallocHost((void **)&plan.h_in[i], strip_bytes);
+        cudaMallocHost((void **)&plan.h_out[i], strip_bytes);
+        cudaEventCreateWithFlags(&plan.e_in[i], cudaEventDisableTiming);
+        cudaEventCreateWithFlags(&plan.e_out[i], cudaEventDisableTiming);
+    }
+    cudaMallocHost((void **)&plan.h_pt, carries*sizeof(Matrix<float,R,WS>));
+    memset(plan.h_pt, 0, carries*sizeof(Matrix<float,R,WS>));
+
+    check_cuda_error("Error preparing streaming plan");
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Index of the image row or column read outside the image
+ *  @param[in] i Row or column index (possibly outside the image)
+ *  @param[in] n Image height or width
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @return Index inside the image or -1 for zero
+ */
+inline int extension_index( int i, int n,
+                            const BorderType& btype ) {
+    if (i >= 0 && i < n) return i;
+    switch(btype) {
+    case CLAMP_TO_EDGE: return i < 0 ? 0 : n-1;
+    case REPEAT: return (i%n + n)%n;
+    case REFLECT: i = (i%(2*n) + 2*n)%(2*n); return i < n ? i : 2*n-1-i;
+    default: return -1;
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Fill a host strip buffer with one strip of the padded image
+ *  @param[in] plan The streaming plan
+ *  @param[out] h_strip Host strip buffer (padded width times strip rows)
+ *  @param[in] k Strip index
+ *  @param[in] h_img The input 2D image in host memory
+ *  @tparam R Filter order
+ */
+template <int R>
+void fill_strip( const alg6_stream_plan<R>& plan,
+                 float *h_strip,
+                 int k,
+                 const float *h_img ) {
+    const int pad = plan.pad, pw = plan.pwidth;
+    for (int r = 0; r < plan.strip_rows; ++r) {
+        float *dst = h_strip + (size_t)r*pw;
+        int pr = k*plan.strip_rows + r,
+            y = pr < plan.pheight ? extension_index(pr-pad, plan.height, plan.btype) : -1;
+        if (y < 0) {
+            memset(dst, 0, pw*sizeof(float));
+            continue;
+        }
+        const float *src = h_img + (size_t)y*plan.width;
+        memcpy(dst + pad, src, plan.width*sizeof(float));
+        for (int x = 0; x < pad; ++x) {
+            int xl = extension_index(x-pad, plan.width, plan.btype),
+                xr = extension_index(plan.width+x, plan.width, plan.btype);
+            dst[x] = xl < 0 ? 0.f : src[xl];
+            dst[pad+plan.width+x] = xr < 0 ? 0.f : src[xr];
+        }
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Store the image rows of a host strip buffer in the output image
+ *  @param[in] plan The streaming plan
+ *  @param[in] h_strip Host strip buffer (padded width times strip rows)
+ *  @param[in] k Strip index
+ *  @param[out] h_img The output 2D image in host memory
+ *  @tparam R Filter order
+ */
+template <int R>
+void store_strip( const alg6_stream_plan<R>& plan,
+                  const float *h_strip,
+                  int k,
+                  float *h_img ) {
+    for (int r = 0; r < plan.strip_rows; ++r) {
+        int y = k*plan.strip_rows + r - plan.pad;
+        if (y < 0 || y >= plan.height) continue;
+        memcpy(h_img + (size_t)y*plan.width,
+               h_strip + (size_t)r*plan.pwidth + plan.pad,
+               plan.width*sizeof(float));
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 steps 1 to 3 and the forward half of step 4 of a strip
+ *  @param[in,out] plan The streaming plan (with the strip uploaded)
+ *  @param[in] k Strip index (to get its incoming forward carries)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_stream_forward( alg6_stream_plan<R>& plan,
+                          int k ) {
+
+    alg6_plan<false,R>& strip = plan.strip;
+    const int m_size = strip.m_size, n_size = strip.n_size;
+
+    launch_alg5v6_step1<false>(strip, &strip.d_pybar, &strip.d_ezhat,
+                               &strip.d_ptucheck, &strip.d_etvtilde, strip.params);
+
+    alg3v4v5v6_step2v4<<< dim3(1, n_size, 1), dim3(WS, NWA), 0, strip.stream >>>
+        ( &strip.d_pybar, &strip.d_ezhat, strip.params, m_size );
+
+    alg6_step3<<< dim3(m_size, n_size, 1), dim3(WS, NWARC), 0, strip.stream >>>
+        ( &strip.d_ptucheck, &strip.d_etvtilde, &strip.d_pybar, &strip.d_ezhat,
+          &strip.d_cmat, strip.params, m_size, n_size );
+
+    copy_column_carries(&strip.d_ptucheck, 0, n_size,
+                        plan.h_pt + (size_t)k*m_size, 0, 0,
+                        m_size, strip.stream);
+
+    alg3v4v5v6_step2v4_fwd<<< dim3(1, m_size, 1), dim3(WS, NWA), 0, strip.stream >>>
+        ( &strip.d_ptucheck, strip.params, n_size );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 streaming strips of the image
+ *
+ *  The input and output images may be the same only for zero border
+ *  (the border of one strip may read rows of others).
+ *
+ *  @param[in,out] plan The streaming plan
+ *  @param[in] h_in The input 2D image in host memory
+ *  @param[out] h_out The output 2D image in host memory
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_stream_gpu( alg6_stream_plan<R>& plan,
+                      const float *h_in,
+                      float *h_out ) {
+
+    alg6_plan<false,R>& strip = plan.strip;
+    const int m_size = strip.m_size, n_size = strip.n_size, ns = plan.n_strips;
+    const size_t pitch = plan.pwidth*sizeof(float);
+
+    // top to bottom: keep the outgoing forward carries of each strip
+    for (int k = 0; k < ns-1; ++k) {
+
+        int j = k%2;
+
+        cudaEventSynchronize(plan.e_in[j]);
+        fill_strip(plan, plan.h_in[j], k, h_in);
+        upload(strip, plan.h_in[j], pitch, cudaMemcpyHostToDevice, strip.stream);
+        cudaEventRecord(plan.e_in[j], strip.stream);
+
+        alg6_stream_forward(plan, k);
+
+        copy_column_carries(plan.h_pt + (size_t)(k+1)*m_size, 0, 0,
+                            &strip.d_ptucheck, n_size, n_size,
+                            m_size, strip.stream);
+
+    }
+
+    // bottom to top: re-filter each strip with its incoming carries
+    cudaMemset2DAsync(&strip.d_etvtilde + n_size, (n_size+1)*sizeof(Matrix<float,R,WS>),
+                      0, sizeof(Matrix<float,R,WS>), m_size, strip.stream);
+
+    for (int k = ns-1, i = 0; k >= 0; --k, ++i) {
+
+        int j = i%2;
+
+        cudaEventSynchronize(plan.e_in[j]);
+        fill_strip(plan, plan.h_in[j], k, h_in);
+        upload(strip, plan.h_in[j], pitch, cudaMemcpyHostToDevice, strip.stream);
+        cudaEventRecord(plan.e_in[j], strip.stream);
+
+        alg6_stream_forward(plan, k);
+
+        alg3v4v5v6_step2v4_rev<<< dim3(1, m_size, 1), dim3(WS, NWA), 0, strip.stream >>>
+            ( &strip.d_ptucheck, &strip.d_etvtilde, strip.params, n_size );
+
+        launch_alg5v6_step4v5<false>(strip, &strip.d_pybar, &strip.d_ezhat,
+                                     &strip.d_ptucheck, &strip.d_etvtilde, strip.params);
+
+        // the first reverse carries are the incoming ones of the strip above
+        copy_column_carries(&strip.d_etvtilde, n_size, n_size,
+                            &strip.d_etvtilde, 0, n_size,
+                            m_size, strip.stream);
+
+        download(strip, plan.h_out[j], pitch, cudaMemcpyDeviceToHost, strip.stream);
+        cudaEventRecord(plan.e_out[j], strip.stream);
+
+        if (i > 0) { // store the strip below while this one is filtered
+            cudaEventSynchronize(plan.e_out[1-j]);
+            store_strip(plan, plan.h_out[1-j], k+1, h_out);
+        }
+
+    }
+
+    cudaEventSynchronize(plan.e_out[(ns-1)%2]);
+    store_strip(plan, plan.h_out[(ns-1)%2], 0, h_out);
+
+    check_cuda_error("Error streaming algorithm 6");
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 streaming strips of the image
+ *
+ *  Given an input 2D image in host memory compute the recursive
+ *  filtering of the image keeping only one strip of it in the device.
+ *  The throughput printed (when runtimes is more than one) includes
+ *  all host and device copies, since streaming is the point here.
+ *
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] strip_rows Number of rows of each strip (zero means from free memory)
+ *  @tparam R Filter order
+ */
+template <int R>
+void alg6_stream_gpu( float *h_img,
+                      const int& width, const int& height, const int& runtimes,
+                      const Vector<float, R+1>& w,
+                      const int& border=0,
+                      const BorderType& btype=CLAMP_TO_ZERO,
+                      int strip_rows=0 ) {
+
+    alg6_stream_plan<R> plan;
+    prepare_alg6_stream(plan, width, height, w, border, btype, strip_rows);
+
+    // keep the input to filter the same image on each run (even in-place)
+    std::vector<float> h_in(h_img, h_img + (size_t)width*height);
+
+    base_timer &timer_total = timers.cpu_add("alg6_stream_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6_stream_gpu(plan, &h_in[0], h_img);
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_STREAM_CUH
+//==============================================================================
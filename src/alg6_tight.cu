@@ -0,0 +1,147 @@
+/**
+ *  @file alg6_tight.cu
+ *  @brief Algorithm 6 in the GPU with padded versus tight output pitch
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_tight_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "alg6_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Run an algorithm 6 plan and download its output to the host
+ *  @param[in,out] plan The plan to run
+ *  @param[in] h_in The input 2D image in the host
+ *  @param[out] h_out The output 2D image in the host
+ *  @param[in] runtimes Number of run times to average
+ *  @return Time elapsed (average in seconds) of filter and download
+ */
+template <int R>
+double run_alg6( gpufilter::alg6_plan<false,R>& plan,
+                 const float *h_in,
+                 float *h_out,
+                 int runtimes ) {
+    size_t pitch = plan.width*sizeof(float);
+    gpufilter::upload(plan, h_in);
+    gpufilter::alg6_gpu(plan); // warm up
+    gpufilter::gpu_timer timer(0, "", false);
+    timer.start();
+    for (int r = 0; r < runtimes; ++r) {
+        gpufilter::alg6_gpu(plan);
+        gpufilter::download(plan, h_out, pitch, cudaMemcpyDeviceToHost);
+    }
+    timer.stop();
+    return timer.elapsed() / runtimes;
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1917, height = 1081; // odd-sized crop by default
+    int runtimes = 1; // # of run times (1 for debug; 1000 for performance)
+    float me = 0.f, mre = 0.f; // maximum error and maximum relative error
+
+    if ((argc > 1 && argc < 4) ||
+        (argc >= 4 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%d", &runtimes) != 1))) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height runtimes]\n";
+        return 1;
+    }
+
+    std::vector< float > cpu_img(width*height), in_img(width*height),
+        padded_img(width*height), tight_img(width*height);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        in_img[i] = cpu_img[i] = rand() / (float)RAND_MAX;
+
+    float sigma = 4.f; // width / 6.f;
+
+    gpufilter::Vector<float, ORDER+1> w;
+    gpufilter::weights(sigma, w);
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Order: " << ORDER << "  Run-times: 1\n";
+        std::cout << APPNAME << " Boundary: zero  Border: 0\n";
+        std::cout << APPNAME << " Weights: " << w << "\n";
+        std::cout << APPNAME << " (1) Runs the reference in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the GPU with padded pitch (pad)\n";
+        std::cout << APPNAME << " (3) Runs the GPU with tight pitch (res)\n";
+        std::cout << APPNAME << " (4) Checks computations (ref x pad x res)\n";
+    }
+
+    gpufilter::alg0_cpu<ORDER>(&cpu_img[0], width, height, w);
+
+    gpufilter::alg6_plan<false,ORDER> padded, tight;
+    gpufilter::prepare_alg6(padded, width, height, w);
+    gpufilter::prepare_alg6(tight, width, height, w, 0, gpufilter::CLAMP_TO_ZERO,
+                            1, 1, false, true);
+
+    double tp = run_alg6(padded, &in_img[0], &padded_img[0], runtimes),
+        tt = run_alg6(tight, &in_img[0], &tight_img[0], runtimes);
+
+    size_t mp = padded.d_img.size()*sizeof(float),
+        mt = tight.d_img.size()*sizeof(float);
+
+    std::cout << std::fixed << APPNAME << " [pitch] [output-MB] [filter+download-ms]\n";
+    std::cout << APPNAME << " padded " << std::setprecision(2) << mp/(1024.*1024.)
+              << " " << std::setprecision(3) << tp*1000 << "\n";
+    std::cout << APPNAME << " tight  " << std::setprecision(2) << mt/(1024.*1024.)
+              << " " << std::setprecision(3) << tt*1000 << "\n";
+    std::cout << APPNAME << " Saved: " << std::setprecision(1)
+              << 100.*(mp-mt)/mp << "% memory  "
+              << 100.*(tp-tt)/tp << "% time\n";
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &padded_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error] pad:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &tight_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error] res:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,78 @@
+/**
+ *  @file alg6_tune.cu
+ *  @brief Autotuning of the algorithm 6 launch configuration in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#define APPNAME "[alg6_tune_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg6_tune.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int min_size = 256, max_size = 8192; // square image sizes to tune
+    int runtimes = 16; // # of run times to average each candidate
+
+    if ((argc > 1 && argc < 4) ||
+        (argc >= 4 && (sscanf(argv[1], "%d", &min_size) != 1 ||
+                       sscanf(argv[2], "%d", &max_size) != 1 ||
+                       sscanf(argv[3], "%d", &runtimes) != 1))) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [min_size max_size runtimes]\n";
+        return 1;
+    }
+
+    gpufilter::Vector<float, ORDER+1> w;
+    gpufilter::weights(4.f, w);
+
+    srand( 1234 );
+
+    std::cout << APPNAME << " Tuning file: " << gpufilter::tune_file()
+              << "  Architecture: sm_" << gpufilter::tune_arch() << "\n";
+    std::cout << APPNAME << " [size] [size-class] [warps-step1] [warps-step5] [cache-step2]\n";
+
+    // one image size per size class (each class has four times more blocks)
+    for (int size = min_size; size <= max_size; size *= 2) {
+
+        gpufilter::tune_config c = gpufilter::autotune_alg6<ORDER>(size, size, w, runtimes);
+
+        std::cout << APPNAME << " " << size << " "
+                  << gpufilter::size_class(((size+WS-1)/WS)*((size+WS-1)/WS)) << " "
+                  << c.nwc << " " << c.nww << " " << (int)c.cache2 << "\n";
+
+    }
+
+    return 0;
+
+}
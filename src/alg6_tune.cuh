@@ -0,0 +1,133 @@
+/**
+ *  @file alg6_tune.cuh
+ *  @brief Autotuning of the algorithm 6 launch configuration in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6_TUNE_CUH
+#define ALG6_TUNE_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Time the five steps of an algorithm 6 plan
+ *  @param[in,out] plan The plan to run
+ *  @param[out] te Time elapsed (average in seconds) of each step
+ *  @param[in] runtimes Number of run times to average
+ *  @tparam R Filter order
+ */
+template <int R>
+void time_alg6_steps( alg6_plan<false,R>& plan,
+                      double te[5],
+                      int runtimes ) {
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i) {
+        timer[i] = new gpu_timer(0, "", false);
+        te[i] = 0;
+    }
+    alg6_gpu(plan); // warm up
+    for (int r = 0; r < runtimes; ++r) {
+        alg6_gpu(plan, timer);
+        for (int i = 0; i < 5; ++i)
+            te[i] += timer[i]->elapsed();
+    }
+    for (int i = 0; i < 5; ++i) {
+        te[i] /= runtimes;
+        delete timer[i];
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Autotune the launch configuration of algorithm 6 in the GPU
+ *
+ *  Times the candidate configurations on the current device for the
+ *  given filter order and the size class of the given image size (see
+ *  size_class()), and saves the winner to the tuning cache file (see
+ *  tune_file()), picked up by all plans of algorithms 5 and 6 of the
+ *  same order and size class prepared afterwards.  The steps are
+ *  independent, thus each is tuned on its own: the number of warps of
+ *  step 1 and of step 5 (see is_tuned_warps()) and the cache
+ *  preference of steps 2 and 4.
+ *
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] runtimes Number of run times to average each candidate
+ *  @param[in] save Flag to save the winner to the tuning cache file
+ *  @return The tuned launch configuration
+ *  @tparam R Filter order
+ */
+template <int R>
+tune_config autotune_alg6( int width, int height,
+                           const Vector<float, R+1>& w,
+                           int runtimes=16,
+                           bool save=true ) {
+
+    const int warps[] = { 4, NWC, 8 };
+    const cudaFuncCache caches[] = { cudaFuncCachePreferL1,
+                                     cudaFuncCachePreferEqual,
+                                     cudaFuncCachePreferShared };
+
+    alg6_plan<false,R> plan;
+    prepare_alg6(plan, width, height, w);
+
+    std::vector<float> h_img(width*height);
+    for (int i = 0; i < width*height; ++i)
+        h_img[i] = rand() / (float)RAND_MAX;
+    upload(plan, &h_img[0]);
+
+    tune_config best = plan.tune;
+    double te[5], best_step1 = -1, best_step5 = -1, best_step24 = -1;
+
+    for (int i = 0; i < 3; ++i) {
+        plan.tune.nwc = plan.tune.nww = warps[i];
+        time_alg6_steps(plan, te, runtimes);
+        if (best_step1 < 0 || te[0] < best_step1) {
+            best_step1 = te[0];
+            best.nwc = warps[i];
+        }
+        if (best_step5 < 0 || te[4] < best_step5) {
+            best_step5 = te[4];
+            best.nww = warps[i];
+        }
+    }
+
+    plan.tune = best;
+
+    for (int i = 0; i < 3; ++i) {
+        cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, caches[i]);
+        time_alg6_steps(plan, te, runtimes);
+        if (best_step24 < 0 || te[1]+te[3] < best_step24) {
+            best_step24 = te[1]+te[3];
+            best.cache2 = caches[i];
+        }
+    }
+
+    cudaFuncSetCacheConfig(alg3v4v5v6_step2v4<R,float>, best.cache2);
+
+    if (save)
+        save_tuning(R, (long)plan.m_size*plan.n_size, best);
+
+    return best;
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6_TUNE_CUH
+//==============================================================================
@@ -0,0 +1,84 @@
+/**
+ *  @file alg6b.cu
+ *  @brief Algorithm 6 with blocks larger than the warp size in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ORDER
+#define ORDER 1 // default filter order r=1
+#endif
+#ifndef BLOCK
+#define BLOCK 64 // default block size b=64 (b x b blocks)
+#endif
+#define APPNAME "[alg6b_" << ORDER << "]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "refcheck.cuh"
+#include "alg6b_gpu.cuh"
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, gpu_img, w, a0border, me, mre,
+                  argc, argv);
+
+    if (btype != gpufilter::CLAMP_TO_ZERO || border != 0) {
+        std::cerr << APPNAME << " Larger blocks support only zero boundary (without border blocks)\n";
+        return 1;
+    }
+
+    if (runtimes == 1) { // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+        std::cout << APPNAME << " Block size: " << BLOCK << " x " << BLOCK << "\n";
+    }
+
+    gpufilter::alg0_cached<ORDER>(&cpu_img[0], width, height, w, a0border, btype);
+
+    // the result is checked in the GPU before its download (see gpu_reference)
+    gpufilter::gpu_reference ref( &cpu_img[0], width, height );
+
+    gpufilter::alg6b_gpu<ORDER, BLOCK>(&gpu_img[0], width, height, runtimes, w);
+
+    ref.check( &gpu_img[0], me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
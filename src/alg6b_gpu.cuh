@@ -0,0 +1,526 @@
+/**
+ *  @file alg6b_gpu.cuh
+ *  @brief Algorithm 6 in the GPU with blocks larger than the warp size
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef ALG6B_GPU_CUH
+#define ALG6B_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include "alg6_gpu.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Read a b x b block from the (layered) input texture object
+ *  @param[out] block The block read
+ *  @param[in] tex The input texture object (layered)
+ *  @param[in] m The block column
+ *  @param[in] n The block row
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int B>
+__device__
+void read_block_b( Matrix<float,B,B+1>& block,
+                   cudaTextureObject_t tex,
+                   int m, int n,
+                   float inv_width, float inv_height ) {
+    int tx = threadIdx.x;
+    float tu = (m*B+tx+.5f)*inv_width;
+#pragma unroll
+    for (int i=threadIdx.y; i<B; i+=NRB)
+        block[i][tx] = tex2DLayered<float>(tex, tu, (n*B+i+.5f)*inv_height, 0);
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 1 with b x b blocks
+ *
+ *  Same as alg5v6_step1() for blocks of b x b pixels (b a multiple
+ *  of the warp size), each block perimeter computed by b threads
+ *  (b/32 warps) and the block read by NRB rows of b threads.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
+ *  @param[out] g_ezhat All \f$E_{m,n}(Z)\f$
+ *  @param[out] g_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+__global__ __launch_bounds__(B*NRB)
+void alg6b_step1( cudaTextureObject_t tex,
+                  Matrix<float,R,B> *g_pybar,
+                  Matrix<float,R,B> *g_ezhat,
+                  Matrix<float,R,B> *g_ptucheck,
+                  Matrix<float,R,B> *g_etvtilde,
+                  const Vector<float,R+1> w,
+                  float inv_width, float inv_height,
+                  int m_size, int n_size ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+
+    __shared__ Matrix<float,B,B+1> block;
+    read_block_b<B>(block, tex, m, n, inv_width, inv_height);
+    __syncthreads();
+
+    Vector<float,R> p, e;
+
+    if (ty==0) {
+
+        p = zeros<float,R>();
+
+#pragma unroll // calculate pybar, scan left -> right
+        for (int j=0; j<B; ++j)
+            block[tx][j] = fwdI(p, block[tx][j], w);
+
+        g_pybar[n*(m_size+1)+m+1].set_col(tx, p);
+
+        e = zeros<float,R>();
+
+#pragma unroll // calculate ezhat, scan right -> left
+        for (int j=B-1; j>=0; --j)
+            block[tx][j] = revI(block[tx][j], e, w);
+
+        g_ezhat[n*(m_size+1)+m].set_col(tx, e);
+
+    }
+
+    __syncthreads(); // rows by more than one warp
+
+    if (ty==0) {
+
+        p = zeros<float,R>();
+
+#pragma unroll // calculate ptucheck, scan top -> bottom
+        for (int j=0; j<B; ++j)
+            block[j][tx] = fwdI(p, block[j][tx], w);
+
+        g_ptucheck[m*(n_size+1)+n+1].set_col(tx, p);
+
+        e = zeros<float,R>();
+
+#pragma unroll // calculate etvtilde, scan bottom -> top
+        for (int j=B-1; j>=0; --j)
+            revI(block[j][tx], e, w);
+
+        g_etvtilde[m*(n_size+1)+n].set_col(tx, e);
+
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 2 or 4 with b x b blocks
+ *
+ *  Same as alg3v4v5v6_step2v4() for carries of b x b blocks, each of
+ *  the b threads adjusts one row (or column) of carries sequentially
+ *  for each block, reading and writing carries directly in global
+ *  memory (coalesced by the b threads).
+ *
+ *  @param[in,out] g_pybar All \f$P_{m,n}(Y)\f$ or \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] g_ezhat All \f$E_{m,n}(Z)\f$ or \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters with the carry adjusting matrices
+ *  @param[in] m_size The big M or N (number of row or column blocks)
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+__global__ __launch_bounds__(B)
+void alg6b_step2v4( Matrix<float,R,B> *g_pybar,
+                    Matrix<float,R,B> *g_ezhat,
+                    const filter_params<R,float> params,
+                    int m_size ) {
+
+    int tx = threadIdx.x, n = blockIdx.y;
+
+    g_pybar += n*(m_size+1);
+    g_ezhat += n*(m_size+1);
+
+    Vector<float,R> py = g_pybar[0].col(tx), ez;
+
+    for (int m = 0; m < m_size; ++m) { // adjust pybar left -> right
+        py = g_pybar[m+1].col(tx) + py * params.AbF_T;
+        g_pybar[m+1].set_col(tx, py);
+    }
+
+    ez = g_ezhat[m_size].col(tx);
+
+    for (int m = m_size-1; m >= 0; --m) { // adjust ezhat right -> left
+        ez = g_ezhat[m].col(tx) + g_pybar[m].col(tx) * params.HARB_AFP_T
+            + ez * params.AbR_T;
+        g_ezhat[m].set_col(tx, ez);
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 3 with b x b blocks
+ *
+ *  Same as alg6_step3() for carries of b x b blocks.  The b rows of
+ *  carries of each block are reduced to the r x r products of the
+ *  fixing matrices (as fixpet() does by shuffles in one warp) in
+ *  shared memory, then each of the b threads fixes one column.
+ *
+ *  @param[in,out] g_ptucheck All \f$P^T_{m,n}(U)\f$
+ *  @param[in,out] g_etvtilde All \f$E^T_{m,n}(V)\f$
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_cmat Constant pre-computed matrices on equations (27) and (29)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+__global__ __launch_bounds__(B*2)
+void alg6b_step3( Matrix<float,R,B> *g_ptucheck,
+                  Matrix<float,R,B> *g_etvtilde,
+                  const Matrix<float,R,B> *g_py,
+                  const Matrix<float,R,B> *g_ez,
+                  const Matrix<float,R,B> *g_cmat,
+                  int m_size, int n_size ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+
+    __shared__ Matrix<float,B,R> spe[2]; // py and ez of each block row
+    __shared__ float sfix[2][2][R][R]; // (ptu, etv) x (py, ez) products
+
+    if (ty == 0) spe[0][tx] = g_py[n*(m_size+1)+m].col(tx);
+    else spe[1][tx] = g_ez[n*(m_size+1)+m+1].col(tx);
+
+    __syncthreads();
+
+    // ptu is fixed by TAFB and etv by HARB_AFB (times py and ez)
+    for (int q = ty*B+tx; q < 4*R*R; q += 2*B) {
+        int k = q/(2*R*R), s = (q/(R*R))%2, i = (q/R)%R, j = q%R;
+        const Matrix<float,R,B>& a = g_cmat[2+k];
+        float v = 0.f;
+        for (int r = 0; r < B; ++r)
+            v += a[i][r] * spe[s][r][j];
+        sfix[k][s][i][j] = v;
+    }
+
+    __syncthreads();
+
+    Matrix<float,R,B> *gptuetv = ty == 0 ? &g_ptucheck[m*(n_size+1)+n+1]
+        : &g_etvtilde[m*(n_size+1)+n];
+    Vector<float,R> ptuetv = gptuetv->col(tx);
+
+#pragma unroll
+    for (int i = 0; i < R; ++i)
+#pragma unroll
+        for (int j = 0; j < R; ++j)
+            ptuetv[i] += g_cmat[1][j][tx] * sfix[ty][0][i][j]
+                + g_cmat[0][j][tx] * sfix[ty][1][i][j];
+
+    gptuetv->set_col(tx, ptuetv);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 5 with b x b blocks
+ *
+ *  Same as alg5v6_step4v5() for blocks of b x b pixels, writing only
+ *  the pixels inside the image.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[out] g_out The output 2D image
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] out_stride Image output stride for memory width alignment
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+__global__ __launch_bounds__(B*NRB)
+void alg6b_step5( cudaTextureObject_t tex,
+                  float *g_out,
+                  const Matrix<float,R,B> *g_py,
+                  const Matrix<float,R,B> *g_ez,
+                  const Matrix<float,R,B> *g_ptu,
+                  const Matrix<float,R,B> *g_etv,
+                  const Vector<float,R+1> w,
+                  float inv_width, float inv_height,
+                  int width, int height,
+                  int m_size, int n_size,
+                  int out_stride ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+
+    __shared__ Matrix<float,B,B+1> block;
+    read_block_b<B>(block, tex, m, n, inv_width, inv_height);
+    __syncthreads();
+
+    Vector<float,R> p, e;
+
+    if (ty==0) {
+
+        p = g_py[n*(m_size+1)+m].col(tx);
+
+#pragma unroll // calculate block, scan left -> right
+        for (int j=0; j<B; ++j)
+            block[tx][j] = fwdI(p, block[tx][j], w);
+
+        e = g_ez[n*(m_size+1)+m+1].col(tx);
+
+#pragma unroll // calculate block, scan right -> left
+        for (int j=B-1; j>=0; --j)
+            block[tx][j] = revI(block[tx][j], e, w);
+
+    }
+
+    __syncthreads(); // rows by more than one warp
+
+    if (ty==0) {
+
+        p = g_ptu[m*(n_size+1)+n].col(tx);
+
+#pragma unroll // calculate block, scan top -> bottom
+        for (int j=0; j<B; ++j)
+            block[j][tx] = fwdI(p, block[j][tx], w);
+
+        e = g_etv[m*(n_size+1)+n+1].col(tx);
+
+#pragma unroll // calculate block, scan bottom -> top
+        for (int j=B-1; j>=0; --j)
+            block[j][tx] = revI(block[j][tx], e, w);
+
+    }
+
+    __syncthreads();
+
+    int x = m*B+tx;
+    if (x < width) {
+#pragma unroll // write block inside image
+        for (int i=ty; i<B; i+=NRB) {
+            int y = n*B+i;
+            if (y < height)
+                g_out[y*out_stride+x] = block[i][tx];
+        }
+    }
+
+}
+
+/**
+ *  @struct alg6b_plan alg6b_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Filter plan of algorithm 6 with b x b blocks
+ *
+ *  The block size b is decoupled from the warp size: each block is
+ *  filtered by b/32 warps and has r x b carries per side, thus the
+ *  carries per pixel (and the work of steps 2, 3 and 4) are divided
+ *  by b/32 as compared to alg6_plan.  This pays off for high orders
+ *  (r = 4 or 5) where carries dominate, small orders keep the fast
+ *  path of alg6_gpu().  The block size is 64 (or 32) to fit the
+ *  block in shared memory, with zero boundary only.
+ *
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+struct alg6b_plan : public alg_plan {
+    Vector<float,R+1> w; ///< Filter weights
+    alg_matrices<R,float,B> mat; ///< Pre-computed basic matrices
+    filter_params<R,float> params; ///< Filter parameters passed to kernels
+    dvector< Matrix<float,R,B> > d_pybar, d_ezhat; ///< Row carries
+    dvector< Matrix<float,R,B> > d_ptucheck, d_etvtilde; ///< Column carries
+    dvector< Matrix<float,R,B> > d_cmat; ///< Constant matrices in global memory
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm 6 plan with b x b blocks in the GPU
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+void prepare_alg6b( alg6b_plan<R,B>& plan,
+                    int width, int height,
+                    const Vector<float, R+1>& w ) {
+
+    prepare_plan(plan, width, height, 0, CLAMP_TO_ZERO, false, 1);
+
+    // b x b blocks and output of exact width (only inside pixels are written)
+    plan.m_size = (width+B-1)/B;
+    plan.n_size = (height+B-1)/B;
+    plan.stride_img = width;
+    plan.d_img.resize(height*width);
+
+    plan.w = w;
+    calc_matrices(plan.mat, w);
+    plan.params = make_params(w, plan.mat, 0);
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+
+    // +1 padding is important even in zero-border to avoid if's in kernels
+    plan.d_pybar.resize((m_size+1)*n_size);
+    plan.d_ezhat.resize((m_size+1)*n_size);
+    plan.d_ptucheck.resize((n_size+1)*m_size);
+    plan.d_etvtilde.resize((n_size+1)*m_size);
+    plan.d_pybar.fillzero();
+    plan.d_ezhat.fillzero();
+    plan.d_ptucheck.fillzero();
+    plan.d_etvtilde.fillzero();
+
+    // constant r x b matrices: ARE_T, ARB_AFP_T, TAFB, HARB_AFB
+    Matrix<float,R,B> h_cmat[4] = { plan.mat.ARE_T, plan.mat.ARB_AFP_T,
+                                    plan.mat.TAFB, plan.mat.HARB_AFB };
+    plan.d_cmat.resize(4);
+    cudaMemcpy(&plan.d_cmat, h_cmat, 4*sizeof(Matrix<float,R,B>),
+               cudaMemcpyHostToDevice);
+
+    cudaFuncSetCacheConfig(alg6b_step1<R,B>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg6b_step5<R,B>, cudaFuncCachePreferShared);
+    cudaFuncSetCacheConfig(alg6b_step2v4<R,B>, cudaFuncCachePreferL1);
+    cudaFuncSetCacheConfig(alg6b_step3<R,B>, cudaFuncCachePreferL1);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm 6 plan with b x b blocks in the GPU
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional five timers to measure each step
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+void alg6b_gpu( alg6b_plan<R,B>& plan,
+                base_timer **timer=0 ) {
+
+    const int m_size = plan.m_size, n_size = plan.n_size;
+
+    if (timer) timer[0]->start();
+
+    alg6b_step1<R,B><<< dim3(m_size, n_size), dim3(B, NRB), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ezhat, &plan.d_ptucheck,
+          &plan.d_etvtilde, plan.w, plan.inv_width, plan.inv_height,
+          m_size, n_size );
+
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
+
+    alg6b_step2v4<R,B><<< dim3(1, n_size), dim3(B), 0, plan.stream >>>
+        ( &plan.d_pybar, &plan.d_ezhat, plan.params, m_size );
+
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
+
+    alg6b_step3<R,B><<< dim3(m_size, n_size), dim3(B, 2), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_cmat, m_size, n_size );
+
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
+
+    alg6b_step2v4<R,B><<< dim3(1, m_size), dim3(B), 0, plan.stream >>>
+        ( &plan.d_ptucheck, &plan.d_etvtilde, plan.params, n_size );
+
+    if (timer) { timer[3]->stop(); timer[4]->start(); }
+
+    alg6b_step5<R,B><<< dim3(m_size, n_size), dim3(B, NRB), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_img, &plan.d_pybar, &plan.d_ezhat,
+          &plan.d_ptucheck, &plan.d_etvtilde, plan.w,
+          plan.inv_width, plan.inv_height,
+          plan.width, plan.height, m_size, n_size, plan.stride_img );
+
+    if (timer) timer[4]->stop();
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 with b x b blocks in the GPU
+ *
+ *  @see [NehabMaximo:2016] cited in alg6()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, int B>
+void alg6b_gpu( float *h_img,
+                const int& width, const int& height, const int& runtimes,
+                const Vector<float, R+1>& w ) {
+
+    alg6b_plan<R,B> plan;
+    prepare_alg6b(plan, width, height, w);
+
+    upload(plan, h_img);
+
+    const char *steps[5] = { "step 1", "step 2", "step 3", "step 4", "step 5" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[5];
+    for (int i = 0; i < 5; ++i)
+        timer[i] = new step_timer(std::string("alg6b_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("alg6b_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        alg6b_gpu(plan, timed ? timer : 0);
+
+    timer_total.stop();
+
+    for (int i = 0; i < 5; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
+    if (runtimes > 1) {
+
+        if (timed) {
+            for (int i = 0; i < 5; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
+
+    } else {
+
+        timers.flush();
+
+    }
+
+    download(plan, h_img);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // ALG6B_GPU_CUH
+//==============================================================================
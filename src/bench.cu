@@ -0,0 +1,606 @@
+/**
+ *  @file bench.cu
+ *  @brief Benchmark of the GPU algorithms sweeping all their parameters
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#define APPNAME "[bench]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cassert>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "gpudefs.h"
+#include "alg0_simd_cpu.h"
+#include "alg3_gpu.cuh"
+#include "alg4_gpu.cuh"
+#include "alg5_gpu.cuh"
+#include "alg6_gpu.cuh"
+#include "alg6_clamp.cuh"
+#include "alg6_repeat.cuh"
+#include "alg6_reflect.cuh"
+#include "gpufilter_inst.cuh"
+
+//== STRUCTS ===================================================================
+
+/**
+ *  @struct bench_options bench.cu
+ *  @brief Sweep of the benchmark (each list is one axis of the sweep)
+ */
+struct bench_options {
+    std::vector<int> algs; ///< Algorithms (3 to 6)
+    std::vector<int> orders; ///< Filter orders (1 to 5)
+    std::vector<int> btypes; ///< Border types (0 zero, 1 clamp, 2 repeat, 3 reflect)
+    std::vector<int> sizes; ///< Image sizes (widths of images)
+    int aspect; ///< Aspect ratio (height over width, one for square images)
+    int border; ///< Number of border blocks (32x32) outside image
+    int warmup; ///< Number of warmup runs (not measured)
+    int runs; ///< Number of measured runs (one sample each)
+    bool check; ///< Flag to check each job against the CPU reference
+    bool graph; ///< Flag to replay the plans as CUDA Graphs (see plan_graph)
+    bool lookback; ///< Flag to adjust carries with look-back (see prepare_lookback())
+    gpufilter::TensorPrecision tensor; ///< Block products on tensor cores (see prepare_tensor())
+    std::string json, csv; ///< Output file names (empty for none)
+};
+
+/**
+ *  @struct bench_result bench.cu
+ *  @brief Result of one job of the benchmark sweep
+ */
+struct bench_result {
+    int alg, order, btype, border; ///< Job algorithm, order, border type and blocks
+    int width, height; ///< Job image size
+    double min_ms, median_ms, p90_ms, p99_ms; ///< Run time statistics (ms)
+    double gpix_s; ///< Throughput (Gpixel/s) of the median run
+    double gb_s; ///< Effective bandwidth (GB/s) of the median run
+    double roofline_gb_s; ///< Device-to-device memcpy bandwidth (GB/s)
+    float me, mre; ///< Maximum (relative) error (if checked)
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Run one plan of each algorithm
+ *  @param[in,out] plan The plan to run
+ */
+template <bool BORDER, int R>
+void run_plan( gpufilter::alg3_plan<BORDER,R>& plan ) { gpufilter::alg3_gpu(plan); }
+
+template <bool BORDER, int R>
+void run_plan( gpufilter::alg4_plan<BORDER,R>& plan ) { gpufilter::alg4_gpu(plan); }
+
+template <bool BORDER, int R>
+void run_plan( gpufilter::alg5_plan<BORDER,R>& plan ) { gpufilter::alg5_gpu(plan); }
+
+template <bool BORDER, int R>
+void run_plan( gpufilter::alg6_plan<BORDER,R>& plan ) { gpufilter::alg6_gpu(plan); }
+
+template <int R>
+void run_plan( gpufilter::alg6_clamp_plan<R>& plan ) { gpufilter::alg6_clamp(plan); }
+
+template <int R>
+void run_plan( gpufilter::alg6_repeat_plan<R>& plan ) { gpufilter::alg6_repeat(plan); }
+
+template <int R>
+void run_plan( gpufilter::alg6_reflect_plan<R>& plan ) { gpufilter::alg6_reflect(plan); }
+
+/**
+ *  @brief Compute a percentile of sorted samples (nearest rank)
+ *  @param[in] t The sorted samples
+ *  @param[in] p The percentile (from 0 to 100)
+ *  @return The sample at percentile p
+ */
+double percentile( const std::vector<double>& t, double p ) {
+    int i = (int)std::ceil(p/100.*t.size()) - 1;
+    return t[std::max(0, std::min(i, (int)t.size()-1))];
+}
+
+/**
+ *  @brief Measure runs of a job one by one, after warmup runs
+ *  @param[in] job Function running the job once (in the GPU)
+ *  @param[in] arg Argument of the job
+ *  @param[in] opts The benchmark options (warmup and runs)
+ *  @return Sorted run times (in seconds)
+ */
+std::vector<double> measure( void (*job)(void *), void *arg,
+                             const bench_options& opts ) {
+    for (int r = 0; r < opts.warmup; ++r)
+        job(arg);
+    std::vector<double> t(opts.runs);
+    gpufilter::gpu_timer timer(0, "", false);
+    for (int r = 0; r < opts.runs; ++r) {
+        timer.start();
+        job(arg);
+        timer.stop();
+        t[r] = timer.elapsed();
+    }
+    std::sort(t.begin(), t.end());
+    return t;
+}
+
+/// Job running a plan once
+template <class PLAN>
+void plan_job( void *plan ) { run_plan(*(PLAN *)plan); }
+
+/**
+ *  @struct memcpy_arg bench.cu
+ *  @brief Argument of the device-to-device memcpy job
+ */
+struct memcpy_arg {
+    gpufilter::dvector<float> src, dst; ///< Source and destination buffers
+};
+
+/// Job copying the source to the destination once
+void memcpy_job( void *arg ) {
+    memcpy_arg& m = *(memcpy_arg *)arg;
+    cudaMemcpy(&m.dst, &m.src, m.src.size()*sizeof(float),
+               cudaMemcpyDeviceToDevice);
+}
+
+/**
+ *  @brief Measure the memory roofline of an image size
+ *
+ *  Filtering reads and writes each pixel at least once, as a
+ *  device-to-device copy of the image does, hence the copy bandwidth
+ *  is the roofline of the effective bandwidth of all algorithms.
+ *
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] opts The benchmark options (warmup and runs)
+ *  @return Median copy bandwidth (in GB/s, counting read and write)
+ */
+double memcpy_roofline( int width, int height,
+                        const bench_options& opts ) {
+    memcpy_arg m;
+    m.src.resize(width*height);
+    m.dst.resize(width*height);
+    m.src.fillzero();
+    std::vector<double> t = measure(memcpy_job, &m, opts);
+    return 2.*width*height*sizeof(float) / percentile(t, 50) / 1e9;
+}
+
+/**
+ *  @brief Benchmark one prepared plan
+ *  @param[in,out] plan The prepared plan to benchmark
+ *  @param[in] h_in The input 2D image in the host
+ *  @param[in] h_ref The reference output in the host (null to skip check)
+ *  @param[in] opts The benchmark options
+ *  @param[in,out] res The job result (filled with statistics and errors)
+ *  @tparam PLAN Plan type
+ */
+template <class PLAN>
+void bench_plan( PLAN& plan,
+                 const float *h_in,
+                 const float *h_ref,
+                 const bench_options& opts,
+                 bench_result& res ) {
+    plan.graph.enabled = opts.graph;
+    gpufilter::upload(plan, h_in);
+    std::vector<double> t = measure(plan_job<PLAN>, &plan, opts);
+    res.min_ms = t[0]*1000;
+    res.median_ms = percentile(t, 50)*1000;
+    res.p90_ms = percentile(t, 90)*1000;
+    res.p99_ms = percentile(t, 99)*1000;
+    double pixels = (double)res.width*res.height, median = res.median_ms/1000;
+    res.gpix_s = pixels / median / 1e9;
+    res.gb_s = 2.*pixels*sizeof(float) / median / 1e9;
+    res.me = res.mre = 0.f;
+    if (h_ref) {
+        std::vector<float> h_out(res.width*res.height);
+        gpufilter::download(plan, &h_out[0]);
+        gpufilter::check_cpu_reference(h_ref, &h_out[0], res.width*res.height,
+                                       res.me, res.mre);
+    }
+}
+
+/**
+ *  @brief Benchmark one job of a given filter order
+ *
+ *  Without border blocks, algorithm 6 computes each border type
+ *  exactly and the other algorithms only compute the zero border,
+ *  with border blocks all algorithms pad the input instead, as in
+ *  the library (see gpufilter.h).
+ *
+ *  @param[in] h_in The input 2D image in the host
+ *  @param[in] h_ref The reference output in the host (null to skip check)
+ *  @param[in] opts The benchmark options
+ *  @param[in,out] res The job (filled with its result)
+ *  @tparam R Filter order
+ *  @return True if the job ran (false if not supported)
+ */
+template <int R>
+bool bench_order( const float *h_in,
+                  const float *h_ref,
+                  const bench_options& opts,
+                  bench_result& res ) {
+    gpufilter::Vector<float, R+1> w;
+    gpufilter::weights(4.f, w);
+    const int width = res.width, height = res.height, border = res.border;
+    const gpufilter::BorderType btype = (gpufilter::BorderType)res.btype;
+    const bool zero = border == 0 && btype == gpufilter::CLAMP_TO_ZERO;
+    if (res.alg == 6 && border == 0) {
+        if (btype == gpufilter::CLAMP_TO_ZERO) {
+            gpufilter::alg6_plan<false,R> plan;
+            gpufilter::prepare_alg6(plan, width, height, w);
+            if (opts.lookback) gpufilter::prepare_lookback(plan);
+            if (opts.tensor) gpufilter::prepare_tensor(plan, opts.tensor);
+            bench_plan(plan, h_in, h_ref, opts, res);
+        } else if (btype == gpufilter::CLAMP_TO_EDGE) {
+            gpufilter::alg6_clamp_plan<R> plan;
+            gpufilter::prepare_alg6_clamp(plan, width, height, w);
+            bench_plan(plan, h_in, h_ref, opts, res);
+        } else if (btype == gpufilter::REPEAT) {
+            gpufilter::alg6_repeat_plan<R> plan;
+            gpufilter::prepare_alg6_repeat(plan, width, height, w);
+            bench_plan(plan, h_in, h_ref, opts, res);
+        } else {
+            gpufilter::alg6_reflect_plan<R> plan;
+            gpufilter::prepare_alg6_reflect(plan, width, height, w);
+            bench_plan(plan, h_in, h_ref, opts, res);
+        }
+    } else if (res.alg == 6) {
+        gpufilter::alg6_plan<true,R> plan;
+        gpufilter::prepare_alg6(plan, width, height, w, border, btype);
+        if (opts.lookback) gpufilter::prepare_lookback(plan);
+        if (opts.tensor) gpufilter::prepare_tensor(plan, opts.tensor);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else if (res.alg == 5 && zero) {
+        gpufilter::alg5_plan<false,R> plan;
+        gpufilter::prepare_alg5(plan, width, height, w);
+        if (opts.lookback) gpufilter::prepare_lookback(plan);
+        if (opts.tensor) gpufilter::prepare_tensor(plan, opts.tensor);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else if (res.alg == 5 && border > 0) {
+        gpufilter::alg5_plan<true,R> plan;
+        gpufilter::prepare_alg5(plan, width, height, w, border, btype);
+        if (opts.lookback) gpufilter::prepare_lookback(plan);
+        if (opts.tensor) gpufilter::prepare_tensor(plan, opts.tensor);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else if (res.alg == 4 && zero) {
+        gpufilter::alg4_plan<false,R> plan;
+        gpufilter::prepare_alg4(plan, width, height, w);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else if (res.alg == 4 && border > 0) {
+        gpufilter::alg4_plan<true,R> plan;
+        gpufilter::prepare_alg4(plan, width, height, w, border, btype);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else if (res.alg == 3 && zero) {
+        gpufilter::alg3_plan<false,R> plan;
+        gpufilter::prepare_alg3(plan, width, height, w);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else if (res.alg == 3 && border > 0) {
+        gpufilter::alg3_plan<true,R> plan;
+        gpufilter::prepare_alg3(plan, width, height, w, border, btype);
+        bench_plan(plan, h_in, h_ref, opts, res);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ *  @brief Compute the CPU reference of one job
+ *
+ *  The reference extends the image by the job border blocks, or up
+ *  to half the image for the exact boundaries of algorithm 6 without
+ *  border blocks (as the algN_R applications do).
+ *
+ *  @param[in,out] h_img The in(out)put 2D image in the host
+ *  @param[in] res The job
+ *  @tparam R Filter order
+ */
+template <int R>
+void reference_order( float *h_img,
+                      const bench_result& res ) {
+    gpufilter::Vector<float, R+1> w;
+    gpufilter::weights(4.f, w);
+    int a0border = res.border;
+    if (res.border == 0 && res.btype != gpufilter::CLAMP_TO_ZERO)
+        a0border = (res.width+63)/64;
+    gpufilter::alg0_simd_cpu<R>(h_img, res.width, res.height, w, a0border,
+                                (gpufilter::BorderType)res.btype);
+}
+
+/**
+ *  @brief Parse a list of integers (e.g. "1,2,5" or "64:8192:64")
+ *  @param[in] s The list: comma-separated values or first:last[:step] ranges
+ *  @param[out] v The parsed values
+ *  @return True if the list is well formed
+ */
+bool parse_list( const char *s, std::vector<int>& v ) {
+    v.clear();
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int a, b, step = 1;
+        int n = sscanf(item.c_str(), "%d:%d:%d", &a, &b, &step);
+        if (n == 1) b = a;
+        if (n < 1 || step <= 0 || b < a) return false;
+        for (int i = a; i <= b; i += step)
+            v.push_back(i);
+    }
+    return !v.empty();
+}
+
+/**
+ *  @brief Name of a tensor precision (as given to -tensor)
+ *  @param[in] p The tensor precision
+ *  @return The precision name (off if not on tensor cores)
+ */
+const char *tensor_name( gpufilter::TensorPrecision p ) {
+    return p == gpufilter::TENSOR_TF32 ? "tf32" : p == gpufilter::TENSOR_FP16 ? "fp16" : "off";
+}
+
+/**
+ *  @brief Print the application usage
+ *  @param[in] name Application name
+ */
+void usage( const char *name ) {
+    std::cout << APPNAME << " Usage: " << name << " [options]\n"
+              << APPNAME << "  -algs LIST     algorithms 3 to 6 (default 5,6)\n"
+              << APPNAME << "  -orders LIST   filter orders 1 to 5 (default 1:5)\n"
+              << APPNAME << "  -btypes LIST   0 zero, 1 clamp, 2 repeat, 3 reflect (default 0)\n"
+              << APPNAME << "  -sizes LIST    image widths, square unless -aspect (default 64:8192:64)\n"
+              << APPNAME << "  -aspect N      images N times taller than wide (default 1)\n"
+              << APPNAME << "  -border N      border blocks (32x32) outside image (default 0)\n"
+              << APPNAME << "  -warmup N      warmup runs (default 10)\n"
+              << APPNAME << "  -runs N        measured runs (default 100)\n"
+              << APPNAME << "  -check         check each job against the CPU reference\n"
+              << APPNAME << "  -graph         replay the kernels as CUDA Graphs (algorithms 5 and 6)\n"
+              << APPNAME << "  -lookback      adjust carries with look-back (algorithms 5 and 6)\n"
+              << APPNAME << "  -tensor P      block products on tensor cores in tf32 or fp16 (algorithms 5 and 6)\n"
+              << APPNAME << "  -json FILE     write the results as JSON\n"
+              << APPNAME << "  -csv FILE      write the results as CSV\n"
+              << APPNAME << " Lists are comma-separated values or first:last[:step] ranges\n";
+}
+
+/**
+ *  @brief Parse the command-line options
+ *  @param[out] opts The benchmark options
+ *  @param[in] argc Number of arguments
+ *  @param[in] argv Arguments
+ *  @return True if all options are well formed
+ */
+bool parse_options( bench_options& opts, int argc, char **argv ) {
+    parse_list("5,6", opts.algs);
+    parse_list("1:5", opts.orders);
+    parse_list("0", opts.btypes);
+    parse_list("64:8192:64", opts.sizes);
+    opts.aspect = 1;
+    opts.border = 0;
+    opts.warmup = 10;
+    opts.runs = 100;
+    opts.check = false;
+    opts.graph = false;
+    opts.lookback = false;
+    opts.tensor = gpufilter::TENSOR_OFF;
+    for (int i = 1; i < argc; ++i) {
+        std::string o = argv[i];
+        if (o == "-check") { opts.check = true; continue; }
+        if (o == "-graph") { opts.graph = true; continue; }
+        if (o == "-lookback") { opts.lookback = true; continue; }
+        if (i+1 >= argc) return false;
+        const char *a = argv[++i];
+        bool ok = true;
+        if (o == "-algs") ok = parse_list(a, opts.algs);
+        else if (o == "-orders") ok = parse_list(a, opts.orders);
+        else if (o == "-btypes") ok = parse_list(a, opts.btypes);
+        else if (o == "-sizes") ok = parse_list(a, opts.sizes);
+        else if (o == "-aspect") ok = sscanf(a, "%d", &opts.aspect) == 1;
+        else if (o == "-border") ok = sscanf(a, "%d", &opts.border) == 1;
+        else if (o == "-warmup") ok = sscanf(a, "%d", &opts.warmup) == 1;
+        else if (o == "-runs") ok = sscanf(a, "%d", &opts.runs) == 1;
+        else if (o == "-tensor") {
+            std::string p = a;
+            ok = p == "tf32" || p == "fp16";
+            opts.tensor = p == "fp16" ? gpufilter::TENSOR_FP16 : gpufilter::TENSOR_TF32;
+        }
+        else if (o == "-json") opts.json = a;
+        else if (o == "-csv") opts.csv = a;
+        else ok = false;
+        if (!ok) return false;
+    }
+    for (size_t i = 0; i < opts.algs.size(); ++i)
+        if (opts.algs[i] < 3 || opts.algs[i] > 6) return false;
+    for (size_t i = 0; i < opts.orders.size(); ++i)
+        if (opts.orders[i] < 1 || opts.orders[i] > 5) return false;
+    for (size_t i = 0; i < opts.btypes.size(); ++i)
+        if (opts.btypes[i] < 0 || opts.btypes[i] > 3) return false;
+    for (size_t i = 0; i < opts.sizes.size(); ++i)
+        if (opts.sizes[i] <= 0) return false;
+    return opts.aspect > 0 && opts.border >= 0 && opts.warmup >= 0 && opts.runs > 0;
+}
+
+/**
+ *  @brief Write the results as JSON
+ *  @param[in] fn File name
+ *  @param[in] device Device name
+ *  @param[in] opts The benchmark options
+ *  @param[in] results The results of all jobs
+ */
+void write_json( const std::string& fn,
+                 const std::string& device,
+                 const bench_options& opts,
+                 const std::vector<bench_result>& results ) {
+    std::ofstream out(fn.c_str());
+    out << "{\n  \"device\": \"" << device << "\",\n"
+        << "  \"warmup\": " << opts.warmup << ",\n"
+        << "  \"runs\": " << opts.runs << ",\n"
+        << "  \"graph\": " << (opts.graph ? "true" : "false") << ",\n"
+        << "  \"lookback\": " << (opts.lookback ? "true" : "false") << ",\n"
+        << "  \"tensor\": \"" << tensor_name(opts.tensor) << "\",\n"
+        << "  \"results\": [";
+    out << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        out << (i ? ",\n" : "\n")
+            << "    {\"alg\": " << r.alg << ", \"order\": " << r.order
+            << ", \"btype\": " << r.btype << ", \"border\": " << r.border
+            << ", \"width\": " << r.width << ", \"height\": " << r.height
+            << ", \"min_ms\": " << r.min_ms << ", \"median_ms\": " << r.median_ms
+            << ", \"p90_ms\": " << r.p90_ms << ", \"p99_ms\": " << r.p99_ms
+            << ", \"gpix_s\": " << r.gpix_s << ", \"gb_s\": " << r.gb_s
+            << ", \"roofline_gb_s\": " << r.roofline_gb_s
+            << ", \"roofline_pct\": " << 100.*r.gb_s/r.roofline_gb_s;
+        if (opts.check)
+            out << ", \"max_error\": " << r.me << ", \"max_rel_error\": " << r.mre;
+        out << "}";
+    }
+    out << "\n  ]\n}\n";
+}
+
+/**
+ *  @brief Write the results as CSV (one header line and one line per job)
+ *  @param[in] fn File name
+ *  @param[in] opts The benchmark options
+ *  @param[in] results The results of all jobs
+ */
+void write_csv( const std::string& fn,
+                const bench_options& opts,
+                const std::vector<bench_result>& results ) {
+    std::ofstream out(fn.c_str());
+    out << "alg,order,btype,border,width,height,min_ms,median_ms,p90_ms,p99_ms,"
+        << "gpix_s,gb_s,roofline_gb_s,roofline_pct";
+    if (opts.check) out << ",max_error,max_rel_error";
+    out << "\n" << std::setprecision(6);
+    for (size_t i = 0; i < results.size(); ++i) {
+        const bench_result& r = results[i];
+        out << r.alg << "," << r.order << "," << r.btype << "," << r.border << ","
+            << r.width << "," << r.height << "," << r.min_ms << ","
+            << r.median_ms << "," << r.p90_ms << "," << r.p99_ms << ","
+            << r.gpix_s << "," << r.gb_s << "," << r.roofline_gb_s << ","
+            << 100.*r.gb_s/r.roofline_gb_s;
+        if (opts.check) out << "," << r.me << "," << r.mre;
+        out << "\n";
+    }
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    bench_options opts;
+    if (!parse_options(opts, argc, argv)) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        usage(argv[0]);
+        return 1;
+    }
+
+    cudaDeviceProp prop;
+    cudaGetDeviceProperties(&prop, 0);
+    std::string device = prop.name;
+
+    std::cout << APPNAME << " Device: " << device << "  Warmup: " << opts.warmup
+              << "  Runs: " << opts.runs << "  Graph: " << (opts.graph ? "on" : "off")
+              << "  Look-back: " << (opts.lookback ? "on" : "off")
+              << "  Tensor: " << tensor_name(opts.tensor) << "\n";
+    std::cout << APPNAME << " [alg] [order] [btype] [size] [median-ms] [p99-ms]"
+              << " [Gpix/s] [GB/s] [%roofline]"
+              << (opts.check ? " [max-error] [max-relative-error]" : "") << "\n";
+
+    std::vector<bench_result> results;
+
+    for (size_t si = 0; si < opts.sizes.size(); ++si) {
+
+        const int width = opts.sizes[si], height = opts.sizes[si]*opts.aspect;
+
+        std::vector<float> h_in(width*height), h_ref;
+        srand( 1234 );
+        for (int i = 0; i < width*height; ++i)
+            h_in[i] = rand() / (float)RAND_MAX;
+
+        double roofline = memcpy_roofline(width, height, opts);
+
+        for (size_t oi = 0; oi < opts.orders.size(); ++oi) {
+            for (size_t bi = 0; bi < opts.btypes.size(); ++bi) {
+
+                bench_result res;
+                res.order = opts.orders[oi];
+                res.btype = opts.btypes[bi];
+                res.border = opts.border;
+                res.width = width;
+                res.height = height;
+                res.roofline_gb_s = roofline;
+
+                if (opts.check) { // one reference for all algorithms
+                    h_ref = h_in;
+                    switch (res.order) {
+                    case 1: reference_order<1>(&h_ref[0], res); break;
+                    case 2: reference_order<2>(&h_ref[0], res); break;
+                    case 3: reference_order<3>(&h_ref[0], res); break;
+                    case 4: reference_order<4>(&h_ref[0], res); break;
+                    case 5: reference_order<5>(&h_ref[0], res); break;
+                    }
+                }
+                const float *ref = opts.check ? &h_ref[0] : 0;
+
+                for (size_t ai = 0; ai < opts.algs.size(); ++ai) {
+
+                    res.alg = opts.algs[ai];
+
+                    bool ran = false;
+                    switch (res.order) {
+                    case 1: ran = bench_order<1>(&h_in[0], ref, opts, res); break;
+                    case 2: ran = bench_order<2>(&h_in[0], ref, opts, res); break;
+                    case 3: ran = bench_order<3>(&h_in[0], ref, opts, res); break;
+                    case 4: ran = bench_order<4>(&h_in[0], ref, opts, res); break;
+                    case 5: ran = bench_order<5>(&h_in[0], ref, opts, res); break;
+                    }
+                    if (!ran) continue; // border type needs border blocks
+
+                    results.push_back(res);
+
+                    std::cout << APPNAME << " " << res.alg << " " << res.order << " "
+                              << res.btype << " " << width << "x" << height
+                              << std::fixed << std::setprecision(4)
+                              << " " << res.median_ms << " " << res.p99_ms
+                              << std::setprecision(3) << " " << res.gpix_s
+                              << std::setprecision(1) << " " << res.gb_s
+                              << " " << 100.*res.gb_s/res.roofline_gb_s;
+                    if (opts.check)
+                        std::cout << " " << std::scientific << res.me
+                                  << " " << std::scientific << res.mre;
+                    std::cout << "\n" << std::flush;
+
+                }
+
+            }
+        }
+
+    }
+
+    gpufilter::cuda_pool_stats pool = gpufilter::cuda_pool::instance().stats();
+    std::cout << APPNAME << " Memory pool: " << pool.hits << " hits  "
+              << pool.misses << " misses  " << std::fixed << std::setprecision(1)
+              << pool.peak_reserved/1048576. << " MiB peak\n";
+
+    if (!opts.json.empty())
+        write_json(opts.json, device, opts, results);
+    if (!opts.csv.empty())
+        write_csv(opts.csv, opts, results);
+
+    return 0;
+
+}
@@ -0,0 +1,137 @@
+/**
+ *  @file box.cu
+ *  @brief Box sum, mean and variance filters in the GPU on summed-area tables
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#define APPNAME "[box]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <algorithm>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/image.h>
+
+#include "box_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute the box filter in the CPU (reference)
+ *
+ *  Brute force sum of the box around each pixel extending the image
+ *  by the border type.
+ *
+ *  @param[out] h_out The output 2D image
+ *  @param[in] h_img The input 2D image
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] r Box radius (both axes)
+ *  @param[in] stat Box statistic
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+void box_cpu( float *h_out, const float *h_img,
+              int width, int height, int r,
+              gpufilter::BoxStat stat,
+              gpufilter::BorderType btype ) {
+
+    const double area = (double)(2*r+1)*(2*r+1);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            double s = 0., s2 = 0.;
+            for (int dy = -r; dy <= r; ++dy) {
+                for (int dx = -r; dx <= r; ++dx) {
+                    double v = gpufilter::getpix(h_img, x+dx, y+dy, width, height, btype);
+                    s += v;
+                    s2 += v*v;
+                }
+            }
+            double mean = s / area;
+            h_out[y*width+x] = stat == gpufilter::BOX_SUM ? (float)s
+                : stat == gpufilter::BOX_MEAN ? (float)mean
+                : (float)std::max(s2/area - mean*mean, 0.);
+        }
+    }
+
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1024, height = 1024, radius = 4, stat = 1, border_type = 1,
+        runtimes = 1;
+    float me = 0.f, mre = 0.f;
+
+    if ((argc > 1 && argc < 3) ||
+        (argc >= 3 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1)) ||
+        (argc >= 4 && (sscanf(argv[3], "%d", &radius) != 1 || radius < 0 ||
+                       radius >= width || radius >= height)) ||
+        (argc >= 5 && (sscanf(argv[4], "%d", &stat) != 1 ||
+                       stat < 0 || stat > 2)) ||
+        (argc >= 6 && (sscanf(argv[5], "%d", &border_type) != 1 ||
+                       border_type < 0 || border_type > 3)) ||
+        (argc >= 7 && sscanf(argv[6], "%d", &runtimes) != 1)) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height [radius [stat [border-type [runtimes]]]]]\n";
+        std::cout << APPNAME << " Stats: 0 sum, 1 mean, 2 variance\n";
+        std::cout << APPNAME << " Border types: 0 zero, 1 clamp, 2 repeat, 3 reflect\n";
+        return 1;
+    }
+
+    const char *stat_names[3] = { "sum", "mean", "variance" };
+    gpufilter::BorderType btype = (gpufilter::BorderType)border_type;
+
+    std::vector< unsigned char > img(width*height);
+    std::vector< float > fimg(width*height), cpu_img(width*height),
+        gpu_img(width*height);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        fimg[i] = img[i] = rand() % 256;
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Radius: " << radius << "  Run-times: 1\n";
+        std::cout << APPNAME << " Input: uint8  Statistic: " << stat_names[stat]
+                  << "  Border type: " << border_type << "\n";
+        std::cout << APPNAME << " (1) Runs the brute-force box in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the tables and box in the GPU (res)\n";
+        std::cout << APPNAME << " (3) Checks computations (ref x res)\n";
+    }
+
+    box_cpu(&cpu_img[0], &fimg[0], width, height, radius,
+            (gpufilter::BoxStat)stat, btype);
+
+    gpufilter::box_gpu<unsigned long long>(&gpu_img[0], &img[0], width, height,
+                                           1, runtimes, radius, radius,
+                                           (gpufilter::BoxStat)stat, btype);
+
+    gpufilter::check_cpu_reference( &cpu_img[0], &gpu_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
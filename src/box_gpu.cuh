@@ -0,0 +1,394 @@
+/**
+ *  @file box_gpu.cuh
+ *  @brief Box sum, mean and variance filters in the GPU on summed-area tables
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef BOX_GPU_CUH
+#define BOX_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <stdexcept>
+
+#include "sat_moments_gpu.cuh"
+
+//== DEFINES ===================================================================
+
+#define NWBX 8 ///< # of warps evaluating boxes (one row of pixels each)
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== ENUMERATIONS ==============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Statistic of the pixels inside a box
+ */
+enum BoxStat {
+    BOX_SUM, ///< Sum of the pixels
+    BOX_MEAN, ///< Mean of the pixels
+    BOX_VARIANCE ///< Variance of the pixels (needs the sums of squares table)
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Split a range of pixels extended by a border type into image ranges
+ *
+ *  The range \f$[a,b]\f$ of one axis, possibly outside the image, is
+ *  the sum of up to three weighted ranges inside the image: the part
+ *  inside it and the parts before and after it mapped back by the
+ *  border type (the clamped edge pixel weighted by how many times it
+ *  is repeated).  Zero border drops the parts outside.  The parts
+ *  outside must be shorter than the image for repeat and reflect.
+ *
+ *  @param[in] a First pixel of the range
+ *  @param[in] b Last pixel of the range
+ *  @param[in] n Image size in this axis
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[out] lo First pixels of the image ranges
+ *  @param[out] hi Last pixels of the image ranges
+ *  @param[out] wt Weights of the image ranges
+ *  @return Number of image ranges
+ */
+__device__ inline
+int box_ranges( int a, int b, int n, BorderType btype,
+                int *lo, int *hi, int *wt ) {
+    int k = 0;
+    if (max(a, 0) <= min(b, n-1)) {
+        lo[k] = max(a, 0); hi[k] = min(b, n-1); wt[k++] = 1;
+    }
+    if (btype == CLAMP_TO_ZERO) return k;
+    if (a < 0) { // part before the image [a, min(b,-1)]
+        int e = min(b, -1);
+        if (btype == CLAMP_TO_EDGE) { lo[k] = hi[k] = 0; wt[k++] = e-a+1; }
+        else if (btype == REPEAT) { lo[k] = a+n; hi[k] = e+n; wt[k++] = 1; }
+        else { lo[k] = -e-1; hi[k] = -a-1; wt[k++] = 1; }
+    }
+    if (b >= n) { // part after the image [max(a,n), b]
+        int s = max(a, n);
+        if (btype == CLAMP_TO_EDGE) { lo[k] = hi[k] = n-1; wt[k++] = b-s+1; }
+        else if (btype == REPEAT) { lo[k] = s-n; hi[k] = b-n; wt[k++] = 1; }
+        else { lo[k] = 2*n-b-1; hi[k] = 2*n-s-1; wt[k++] = 1; }
+    }
+    for (int i=0; i<k; ++i) { // guard against too long parts outside
+        lo[i] = max(lo[i], 0); hi[i] = min(hi[i], n-1);
+    }
+    return k;
+}
+
+template <class T>
+__device__ inline // summed-area table value (zero above or left of the image)
+T sat_value( const T *g_sat, int width, int x, int y ) {
+    return (x < 0 || y < 0) ? (T)0 : __ldg(&g_sat[y*width+x]);
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Sum of the pixels of a box extended by a border type
+ *
+ *  Each axis range is split by box_ranges() and the box sum is the
+ *  weighted sum of up to nine rectangles inside the image, each from
+ *  four values of the summed-area table.  Unsigned accumulators are
+ *  exact as the differences wrap around.
+ *
+ *  @param[in] g_sat The summed-area table (tight pitch)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] x0 First column of the box
+ *  @param[in] y0 First row of the box
+ *  @param[in] x1 Last column of the box
+ *  @param[in] y1 Last row of the box
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @return The box sum
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__device__
+T box_sum( const T *g_sat, int width, int height,
+           int x0, int y0, int x1, int y1,
+           BorderType btype ) {
+    int xlo[3], xhi[3], xwt[3], ylo[3], yhi[3], ywt[3];
+    int nx = box_ranges(x0, x1, width, btype, xlo, xhi, xwt),
+        ny = box_ranges(y0, y1, height, btype, ylo, yhi, ywt);
+    T s = (T)0;
+    for (int j=0; j<ny; ++j) {
+        for (int i=0; i<nx; ++i) {
+            T r = sat_value(g_sat, width, xhi[i], yhi[j])
+                - sat_value(g_sat, width, xlo[i]-1, yhi[j])
+                - sat_value(g_sat, width, xhi[i], ylo[j]-1)
+                + sat_value(g_sat, width, xlo[i]-1, ylo[j]-1);
+            s += (T)(xwt[i]*ywt[j]) * r;
+        }
+    }
+    return s;
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Evaluate a box statistic of all channels and store it
+ *
+ *  The mean divides by the box area (pixels outside count as zero in
+ *  zero border) and the variance is the mean of squares minus the
+ *  squared mean, both evaluated in double precision.
+ *
+ *  @param[out] g_out The output (at the box, channels interleaved)
+ *  @param[in] g_sat The summed-area tables of moments (see sat_moments_plan)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of channels
+ *  @param[in] x0 First column of the box
+ *  @param[in] y0 First row of the box
+ *  @param[in] x1 Last column of the box
+ *  @param[in] y1 Last row of the box
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] stat Box statistic
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__device__
+void box_stats( float *g_out,
+                const T *g_sat, int width, int height, int channels,
+                int x0, int y0, int x1, int y1,
+                BorderType btype, BoxStat stat ) {
+    const size_t table = (size_t)width*height;
+    const double area = (double)(x1-x0+1)*(y1-y0+1);
+    for (int c=0; c<channels; ++c) {
+        double s = (double)box_sum(g_sat+c*table, width, height,
+                                   x0, y0, x1, y1, btype);
+        if (stat == BOX_SUM) { g_out[c] = (float)s; continue; }
+        double mean = s / area;
+        if (stat == BOX_MEAN) { g_out[c] = (float)mean; continue; }
+        double s2 = (double)box_sum(g_sat+(channels+c)*table, width, height,
+                                    x0, y0, x1, y1, btype);
+        g_out[c] = (float)max(s2/area - mean*mean, 0.);
+    }
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Box filter of all pixels
+ *
+ *  Each thread evaluates the box centered at its pixel, of the given
+ *  radii or of the radius of its pixel in the radius map.
+ *
+ *  @param[out] g_out The output 2D image (channels interleaved)
+ *  @param[in] g_sat The summed-area tables of moments (see sat_moments_plan)
+ *  @param[in] g_radius The radius map (or null for fixed radii)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of channels
+ *  @param[in] rx Box radius in x (fixed radii)
+ *  @param[in] ry Box radius in y (fixed radii)
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] stat Box statistic
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__global__ __launch_bounds__(WS*NWBX)
+void box_filter( float *g_out,
+                 const T *g_sat, const int *g_radius,
+                 int width, int height, int channels,
+                 int rx, int ry,
+                 BorderType btype, BoxStat stat ) {
+
+    const int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWBX+threadIdx.y;
+
+    if (x >= width || y >= height) return;
+
+    if (g_radius) rx = ry = __ldg(&g_radius[y*width+x]);
+
+    box_stats(g_out + (y*width+x)*channels, g_sat, width, height, channels,
+              x-rx, y-ry, x+rx, y+ry, btype, stat);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Box statistics of a list of query rectangles
+ *  @param[out] g_out The output statistics (channels interleaved per rectangle)
+ *  @param[in] g_sat The summed-area tables of moments (see sat_moments_plan)
+ *  @param[in] g_rects The rectangles (first column, first row, last column and last row)
+ *  @param[in] count Number of rectangles
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of channels
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] stat Box statistic
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__global__ __launch_bounds__(WS*NWBX)
+void box_rects( float *g_out,
+                const T *g_sat, const int4 *g_rects, int count,
+                int width, int height, int channels,
+                BorderType btype, BoxStat stat ) {
+
+    const int q = blockIdx.x*WS*NWBX + threadIdx.y*WS + threadIdx.x;
+
+    if (q >= count) return;
+
+    int4 r = g_rects[q];
+
+    box_stats(g_out + q*channels, g_sat, width, height, channels,
+              r.x, r.y, r.z, r.w, btype, stat);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Check a box statistic may be evaluated on summed-area tables
+ *  @param[in] stat Box statistic
+ *  @tparam K Number of moments of the tables
+ */
+template <int K>
+inline void check_box_stat( BoxStat stat ) {
+    if (stat == BOX_VARIANCE && K < 2)
+        throw std::runtime_error("Box variance needs the sums of squares table");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Box filter an image given its summed-area tables in the GPU
+ *
+ *  Every output pixel is a statistic of the box of radii \f$r_x\f$
+ *  and \f$r_y\f$ around it (or of its radius in the radius map), in
+ *  constant time per pixel for any radius, the image extended by the
+ *  border type.  Radii must be smaller than the image size for repeat
+ *  and reflect borders.
+ *
+ *  @param[in] sat The run plan with the summed-area tables of the image
+ *  @param[out] d_out The output 2D image (channels interleaved)
+ *  @param[in] rx Box radius in x
+ *  @param[in] ry Box radius in y
+ *  @param[in] stat Box statistic
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] d_radius Optional radius map (one radius per pixel for both axes)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments of the tables
+ */
+template <class T, int K>
+__host__
+void box_gpu( const sat_moments_plan<T,K>& sat,
+              dvector<float>& d_out,
+              int rx, int ry,
+              BoxStat stat=BOX_MEAN,
+              BorderType btype=CLAMP_TO_ZERO,
+              const dvector<int> *d_radius=0 ) {
+
+    check_box_stat<K>(stat);
+    if (btype != CLAMP_TO_ZERO && btype != CLAMP_TO_EDGE && !d_radius &&
+        (rx >= sat.width || ry >= sat.height))
+        throw std::runtime_error("Box radius must be smaller than image size");
+
+    d_out.resize(sat.width*sat.height*sat.channels);
+
+    box_filter<<< dim3((sat.width+WS-1)/WS, (sat.height+NWBX-1)/NWBX),
+        dim3(WS, NWBX), 0, sat.stream >>>
+        ( &d_out, &sat.d_sat, d_radius ? &(*d_radius) : 0,
+          sat.width, sat.height, sat.channels, rx, ry, btype, stat );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Evaluate box statistics of query rectangles in the GPU
+ *
+ *  Rectangles may go outside the image, extended by the border type.
+ *
+ *  @param[in] sat The run plan with the summed-area tables of the image
+ *  @param[out] d_out The output statistics (channels interleaved per rectangle)
+ *  @param[in] d_rects The rectangles (first column, first row, last column and last row)
+ *  @param[in] stat Box statistic
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments of the tables
+ */
+template <class T, int K>
+__host__
+void box_query_gpu( const sat_moments_plan<T,K>& sat,
+                    dvector<float>& d_out,
+                    const dvector<int4>& d_rects,
+                    BoxStat stat=BOX_MEAN,
+                    BorderType btype=CLAMP_TO_ZERO ) {
+
+    check_box_stat<K>(stat);
+
+    const int count = d_rects.size();
+    d_out.resize(count*sat.channels);
+    if (count == 0) return;
+
+    box_rects<<< dim3((count+WS*NWBX-1)/(WS*NWBX)), dim3(WS, NWBX), 0, sat.stream >>>
+        ( &d_out, &sat.d_sat, &d_rects, count,
+          sat.width, sat.height, sat.channels, btype, stat );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Box filter an image in the GPU
+ *
+ *  The whole pipeline stays in the GPU: the summed-area tables of the
+ *  sums and sums of squares are computed and the box filter reads
+ *  them, the tables are never copied to the host.
+ *
+ *  @param[out] h_out The output 2D image (channels interleaved) in host memory
+ *  @param[in] h_img The input 2D image (channels interleaved) in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] rx Box radius in x
+ *  @param[in] ry Box radius in y
+ *  @param[in] stat Box statistic
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam TI Input type
+ */
+template <class T, class TI>
+__host__
+void box_gpu( float *h_out,
+              const TI *h_img,
+              int width, int height, int channels, int runtimes,
+              int rx, int ry,
+              BoxStat stat=BOX_MEAN,
+              BorderType btype=CLAMP_TO_ZERO ) {
+
+    sat_moments_plan<T,2> plan;
+    prepare_sat_moments(plan, width, height, channels);
+
+    std::vector<float> img(h_img, h_img+width*height*channels);
+    upload(plan, &img[0]);
+
+    dvector<float> d_out;
+
+    base_timer &timer_total = timers.gpu_add("box_gpu", width*height, "iP");
+
+    for (int r = 0; r < runtimes; ++r) {
+        sat_moments_gpu(plan);
+        box_gpu(plan, d_out, rx, ry, stat, btype);
+    }
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+    d_out.copy_to(h_out, width*height*channels);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // BOX_GPU_CUH
+//==============================================================================
@@ -0,0 +1,195 @@
+/**
+ *  @file bspline3.cu
+ *  @brief Cubic B-spline prefilter and warped sampling in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#define APPNAME "[bspline3]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <complex>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "bspline3_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Sample the cubic B-spline of coefficients in the CPU
+ *
+ *  The 4x4 taps are weighted exactly, positions outside the image
+ *  clamp the coefficients.  It serves only for reference.
+ *
+ *  @param[in] c The coefficients 2D image
+ *  @param[in] w Image width
+ *  @param[in] h Image height
+ *  @param[in] px Position column in pixels (centers at half integers)
+ *  @param[in] py Position row in pixels (centers at half integers)
+ *  @return The cubic B-spline value at the position
+ */
+float bspline3_cpu( const float *c,
+                    int w, int h,
+                    float px, float py ) {
+    float cx = px-.5f, cy = py-.5f, ix = std::floor(cx), iy = std::floor(cy);
+    float fx = cx-ix, fy = cy-iy, wx[4], wy[4];
+    wx[0] = (1-fx)*(1-fx)*(1-fx)/6; wx[3] = fx*fx*fx/6;
+    wx[1] = (4-6*fx*fx+3*fx*fx*fx)/6; wx[2] = 1-wx[0]-wx[1]-wx[3];
+    wy[0] = (1-fy)*(1-fy)*(1-fy)/6; wy[3] = fy*fy*fy/6;
+    wy[1] = (4-6*fy*fy+3*fy*fy*fy)/6; wy[2] = 1-wy[0]-wy[1]-wy[3];
+    float s = 0.f;
+    for (int j = 0; j < 4; ++j) {
+        int y = std::min(std::max((int)iy-1+j, 0), h-1);
+        for (int i = 0; i < 4; ++i) {
+            int x = std::min(std::max((int)ix-1+i, 0), w-1);
+            s += wy[j]*wx[i]*c[y*w+x];
+        }
+    }
+    return s;
+}
+
+/**
+ *  @brief Largest absolute difference between two images
+ *  @param[in] a First image
+ *  @param[in] b Second image
+ *  @param[in] n Number of pixels
+ *  @return The maximum error
+ */
+float max_error( const float *a, const float *b, int n ) {
+    float me = 0.f;
+    for (int i = 0; i < n; ++i)
+        me = std::max(me, std::abs(a[i]-b[i]));
+    return me;
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1024, height = 1024;
+    int runtimes = 1; // # of run times (1 for debug; 1000 for performance)
+    int border = 1; // reflected border blocks of the prefilter
+    float angle = 0.3f, scale = 1.25f; // affine warp rotation and zoom
+
+    if ((argc != 1 && argc != 4 && argc != 6) ||
+        (argc >= 4 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%d", &runtimes) != 1)) ||
+        (argc == 6 && (sscanf(argv[4], "%f", &angle) != 1 ||
+                       sscanf(argv[5], "%f", &scale) != 1)) ||
+        width <= 0 || height <= 0 || runtimes <= 0 || scale <= 0.f) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height runtimes [angle scale]]\n";
+        return 1;
+    }
+
+    const int n = width*height, mw = 17, mh = 17; // mesh vertices
+    std::vector< float > in_img(n), coef(n), cpu_aff(n), cpu_mesh(n),
+        gpu_aff(n), gpu_mesh(n), gpu_id(n);
+
+    srand( 1234 );
+    for (int i = 0; i < n; ++i)
+        in_img[i] = coef[i] = rand() / (float)RAND_MAX;
+
+    // rotation and zoom about the image center (output to input)
+    float ca = std::cos(angle)/scale, sa = std::sin(angle)/scale,
+        hx = width/2.f, hy = height/2.f;
+    gpufilter::affine_warp aff = { { ca, -sa, hx - ca*hx + sa*hy,
+                                     sa, ca, hy - sa*hx - ca*hy } },
+        id = { { 1.f, 0.f, 0.f, 0.f, 1.f, 0.f } };
+
+    // sinusoidal ripple mesh (input position of each vertex)
+    std::vector< float2 > mesh(mw*mh);
+    for (int j = 0; j < mh; ++j)
+        for (int i = 0; i < mw; ++i) {
+            float x = i*width/(mw-1.f), y = j*height/(mh-1.f);
+            mesh[j*mw+i] = make_float2(x + 8.f*std::sin(6.2832f*y/height),
+                                       y + 8.f*std::sin(6.2832f*x/width));
+        }
+    gpufilter::dvector< float2 > d_mesh(mesh);
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Run-times: 1\n";
+        std::cout << APPNAME << " Boundary: reflect  Border: " << border << "\n";
+        std::cout << APPNAME << " Affine warp: rotate " << angle << " zoom "
+                  << scale << "  Mesh warp: " << mw << " x " << mh << " ripple\n";
+        std::cout << APPNAME << " (1) Runs the prefilter and sampling in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the prefilter into the texture and warps in the GPU (res)\n";
+        std::cout << APPNAME << " (3) Checks computations (ref x res, input x identity warp)\n";
+    }
+
+    gpufilter::alg0_cpu<1>(&coef[0], width, height, gpufilter::bspline3_weights(),
+                           border, gpufilter::REFLECT);
+
+    for (int y = 0; y < height; ++y)
+        for (int x = 0; x < width; ++x) {
+            float px = x+.5f, py = y+.5f;
+            cpu_aff[y*width+x] = bspline3_cpu(&coef[0], width, height,
+                                              aff.a[0]*px + aff.a[1]*py + aff.a[2],
+                                              aff.a[3]*px + aff.a[4]*py + aff.a[5]);
+            float u = std::min(px*(mw-1)/width, mw-1.001f),
+                v = std::min(py*(mh-1)/height, mh-1.001f);
+            int i = (int)u, j = (int)v;
+            u -= i; v -= j;
+            const float2 *p = &mesh[j*mw+i];
+            float mx = (1-v)*(p[0].x + u*(p[1].x-p[0].x)) + v*(p[mw].x + u*(p[mw+1].x-p[mw].x)),
+                my = (1-v)*(p[0].y + u*(p[1].y-p[0].y)) + v*(p[mw].y + u*(p[mw+1].y-p[mw].y));
+            cpu_mesh[y*width+x] = bspline3_cpu(&coef[0], width, height, mx, my);
+        }
+
+    gpufilter::bspline3_plan plan;
+    gpufilter::prepare_bspline3(plan, width, height, border);
+    gpufilter::mesh_warp mwarp = gpufilter::make_mesh_warp(&d_mesh, mw, mh, width, height);
+
+    gpufilter::upload(plan.pre, &in_img[0]);
+
+    gpufilter::bspline3_prefilter(plan); // warm up
+    gpufilter::bspline3_warp(plan, aff, width, height);
+
+    gpufilter::gpu_timer timer(0, "", false);
+    timer.start();
+    for (int r = 0; r < runtimes; ++r) {
+        gpufilter::bspline3_prefilter(plan);
+        gpufilter::bspline3_warp(plan, aff, width, height);
+    }
+    timer.stop();
+
+    gpufilter::download_warped(plan, &gpu_aff[0]);
+    gpufilter::bspline3_warp(plan, mwarp, width, height);
+    gpufilter::download_warped(plan, &gpu_mesh[0]);
+    gpufilter::bspline3_warp(plan, id, width, height);
+    gpufilter::download_warped(plan, &gpu_id[0]);
+
+    gpufilter::check_cuda_error("Error running cubic B-spline warps");
+
+    std::cout << std::fixed << APPNAME << " [prefilter+warp-ms]: "
+              << std::setprecision(3) << timer.elapsed()*1000/runtimes << "\n";
+
+    std::cout << APPNAME << " [max-error] affine: " << std::scientific
+              << max_error(&cpu_aff[0], &gpu_aff[0], n) << "  mesh: "
+              << max_error(&cpu_mesh[0], &gpu_mesh[0], n) << "  identity: "
+              << max_error(&in_img[0], &gpu_id[0], n) << "\n";
+
+    return 0;
+
+}
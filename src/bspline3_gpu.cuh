@@ -0,0 +1,417 @@
+/**
+ *  @file bspline3_gpu.cuh
+ *  @brief Cubic B-spline prefilter writing a texture sampled by warps in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef BSPLINE3_GPU_CUH
+#define BSPLINE3_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+
+#include <util/solve.h>
+
+#include "alg6_gpu.cuh"
+
+//== DEFINES ===================================================================
+
+#define NWS 8 ///< # of warps of the cubic B-spline sampling kernel
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct affine_warp bspline3_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Affine warp from output to input positions
+ *
+ *  The input position of an output position \f$(x,y)\f$ is
+ *  \f$(a_0 x + a_1 y + a_2, a_3 x + a_4 y + a_5)\f$, all positions
+ *  in pixels with pixel centers at half integers.
+ */
+struct affine_warp {
+    float a[6]; ///< Row-major 2x3 affine matrix
+    /// Input position of an output position
+    __device__ float2 operator () ( float x, float y ) const {
+        return make_float2(a[0]*x + a[1]*y + a[2], a[3]*x + a[4]*y + a[5]);
+    }
+};
+
+/**
+ *  @struct mesh_warp bspline3_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Mesh warp from output to input positions
+ *
+ *  The mesh is a grid of input positions (in device memory) spread
+ *  evenly over the output, its first and last vertices at the output
+ *  corners, interpolated bilinearly between vertices.
+ */
+struct mesh_warp {
+    const float2 *pos; ///< Input position of each vertex (row-major)
+    int width, height; ///< Number of vertices in width and height (at least 2)
+    float sx, sy; ///< Output to mesh scale (vertices - 1 over output size)
+    /// Input position of an output position
+    __device__ float2 operator () ( float x, float y ) const {
+        float u = fminf(fmaxf(x*sx, 0.f), width-1.001f),
+            v = fminf(fmaxf(y*sy, 0.f), height-1.001f);
+        int i = (int)u, j = (int)v;
+        u -= i; v -= j;
+        const float2 *p = pos + j*width + i;
+        float2 t = make_float2(p[0].x + u*(p[1].x-p[0].x), p[0].y + u*(p[1].y-p[0].y)),
+            b = make_float2(p[width].x + u*(p[width+1].x-p[width].x),
+                            p[width].y + u*(p[width+1].y-p[width].y));
+        return make_float2(t.x + v*(b.x-t.x), t.y + v*(b.y-t.y));
+    }
+};
+
+/**
+ *  @struct bspline3_plan bspline3_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of cubic B-spline prefilter and warped sampling
+ *
+ *  The prefilter is algorithm 6 (first order, reflected border
+ *  blocks) writing its coefficients straight into an array bound to
+ *  a linear-filtering texture, and each warp samples the cubic
+ *  B-spline of the coefficients, all on the plan stream (no
+ *  intermediate copy nor host synchronization).
+ */
+struct bspline3_plan {
+
+    int width, height; ///< Image width and height
+    alg6_plan<true,1> pre; ///< Prefilter plan (input uploaded here)
+    cudaArray *a_coef; ///< Coefficients array (bound to the texture and surface)
+    cudaTextureObject_t tex_coef; ///< Coefficients texture object (linear filtering)
+    cudaSurfaceObject_t surf_coef; ///< Coefficients surface object (prefilter output)
+    int out_width, out_height; ///< Warped output width and height
+    dvector<float> d_img; ///< Warped output image in device memory (tight pitch)
+
+    /// Default constructor
+    bspline3_plan() : width(0), height(0), a_coef(0), tex_coef(0), surf_coef(0),
+                      out_width(0), out_height(0) { }
+
+    /// Destructor
+    ~bspline3_plan() {
+        if (tex_coef) cudaDestroyTextureObject(tex_coef);
+        if (surf_coef) cudaDestroySurfaceObject(surf_coef);
+        if (a_coef) cudaFreeArray(a_coef);
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    bspline3_plan( const bspline3_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    bspline3_plan& operator = ( const bspline3_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Algorithm 6 step 5 writing the coefficients surface
+ *
+ *  Same as alg5v6_step4v5() (with border blocks) but each output
+ *  block is written to the coefficients surface instead of linear
+ *  memory.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[out] surf The coefficients surface object
+ *  @param[in] g_py All \f$P_{m,n}(Y)\f$
+ *  @param[in] g_ez All \f$E_{m,n}(Z)\f$
+ *  @param[in] g_ptu All \f$P^T_{m,n}(U)\f$
+ *  @param[in] g_etv All \f$E^T_{m,n}(V)\f$
+ *  @param[in] params Filter parameters (weights and border)
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ */
+__global__ __launch_bounds__(WS*NWW, NBCW)
+void bspline3_step5( cudaTextureObject_t tex,
+                     cudaSurfaceObject_t surf,
+                     const Matrix<float,1,WS> *g_py,
+                     const Matrix<float,1,WS> *g_ez,
+                     const Matrix<float,1,WS> *g_ptu,
+                     const Matrix<float,1,WS> *g_etv,
+                     const filter_params<1> params,
+                     float inv_width, float inv_height,
+                     int m_size, int n_size,
+                     int width, int height ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y,
+        m = blockIdx.x + params.border, n = blockIdx.y + params.border;
+
+    __shared__ Matrix<float,WS,WS+1> block;
+    read_block<NWW>(block, tex, m-params.border, n-params.border, 0, inv_width, inv_height);
+    __syncthreads();
+
+    // an empty output keeps the coefficients block in shared memory
+    alg5v6_block_output<true,1,1>(block, (float *)0, params.weights, params.weights_cols,
+                                  params.axes, params.border, g_py, g_ez, g_ptu, g_etv,
+                                  m, n, m_size, n_size, 0, 0, 0, true);
+    __syncthreads();
+
+    int x = (m-params.border)*WS+tx;
+#pragma unroll // write coefficients inside image
+    for (int i=ty; i<WS; i+=NWW) {
+        int y = (n-params.border)*WS+i;
+        if (x < width && y < height)
+            surf2Dwrite(block[i][tx], surf, x*sizeof(float), y);
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Sample the cubic B-spline of the coefficients at a position
+ *
+ *  The 4x4 cubic B-spline taps are computed by 2x2 bilinear fetches
+ *  of the coefficients texture following [SiggHadwiger:2005], thus
+ *  the tap weights have the texture filtering precision (9 bits of
+ *  fraction).  Positions outside the image clamp the coefficients.
+ *
+ *  @verbatim
+@inproceedings{SiggHadwiger:2005,
+  title = {Fast Third-Order Texture Filtering},
+  author = {Sigg, C. and Hadwiger, M.},
+  booktitle = {GPU Gems 2},
+  pages = {313--329},
+  year = {2005},
+}   @endverbatim
+ *
+ *  @param[in] tex The coefficients texture object
+ *  @param[in] p The position in pixels (centers at half integers)
+ *  @return The cubic B-spline value at the position
+ */
+__device__
+float bspline3_sample( cudaTextureObject_t tex,
+                       float2 p ) {
+    float2 c = make_float2(p.x-.5f, p.y-.5f), i = make_float2(floorf(c.x), floorf(c.y)),
+        f = make_float2(c.x-i.x, c.y-i.y), f2 = make_float2(f.x*f.x, f.y*f.y),
+        f3 = make_float2(f2.x*f.x, f2.y*f.y);
+    // cubic B-spline weights of the four taps (w0 to w3) on each axis
+    float2 w0 = make_float2((1.f-3.f*f.x+3.f*f2.x-f3.x)/6.f, (1.f-3.f*f.y+3.f*f2.y-f3.y)/6.f),
+        w1 = make_float2((4.f-6.f*f2.x+3.f*f3.x)/6.f, (4.f-6.f*f2.y+3.f*f3.y)/6.f),
+        w3 = make_float2(f3.x/6.f, f3.y/6.f),
+        g0 = make_float2(w0.x+w1.x, w0.y+w1.y), g1 = make_float2(1.f-g0.x, 1.f-g0.y);
+    // bilinear fetch positions merging taps 0 and 1, and taps 2 and 3
+    float2 h0 = make_float2(i.x-.5f+w1.x/g0.x, i.y-.5f+w1.y/g0.y),
+        h1 = make_float2(i.x+1.5f+w3.x/g1.x, i.y+1.5f+w3.y/g1.y);
+    return g0.y*(g0.x*tex2D<float>(tex, h0.x, h0.y) + g1.x*tex2D<float>(tex, h1.x, h0.y)) +
+        g1.y*(g0.x*tex2D<float>(tex, h0.x, h1.y) + g1.x*tex2D<float>(tex, h1.x, h1.y));
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Sample the cubic B-spline of the coefficients by a warp
+ *  @param[in] tex The coefficients texture object
+ *  @param[in] warp The warp from output to input positions
+ *  @param[out] g_out The warped output image
+ *  @param[in] out_width Output width
+ *  @param[in] out_height Output height
+ *  @tparam Warp Warp type (see affine_warp and mesh_warp)
+ */
+template <class Warp>
+__global__ __launch_bounds__(WS*NWS)
+void bspline3_warp( cudaTextureObject_t tex,
+                    const Warp warp,
+                    float *g_out,
+                    int out_width, int out_height ) {
+    int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWS+threadIdx.y;
+    if (x >= out_width || y >= out_height) return;
+    g_out[y*out_width+x] = bspline3_sample(tex, warp(x+.5f, y+.5f));
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Cubic B-spline interpolation prefilter weights
+ *
+ *  The prefilter \f$6/(z+4+z^{-1})\f$ is a causal and an anticausal
+ *  first-order filter of pole \f$\sqrt{3}-2\f$, each of feedforward
+ *  coefficient square root of the gain (see solve.h).
+ *
+ *  @return The first-order weights (feedforward and feedback coefficients)
+ */
+inline Vector<float,2> bspline3_weights() {
+    Vector<float,2> w;
+    w[0] = spline::w0;
+    w[1] = spline::w1;
+    return w;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the cubic B-spline prefilter and sampling plan
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] border Number of reflected border blocks (32x32) outside image
+ */
+inline void prepare_bspline3( bspline3_plan& plan,
+                              int width, int height,
+                              int border=1 ) {
+
+    if (border < 1)
+        throw std::runtime_error("Cubic B-spline prefilter needs border blocks");
+
+    prepare_alg6(plan.pre, width, height, bspline3_weights(), border, REFLECT);
+
+    plan.width = width;
+    plan.height = height;
+
+    if (plan.tex_coef) cudaDestroyTextureObject(plan.tex_coef);
+    if (plan.surf_coef) cudaDestroySurfaceObject(plan.surf_coef);
+    if (plan.a_coef) cudaFreeArray(plan.a_coef);
+
+    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
+    cudaMallocArray(&plan.a_coef, &ccd, width, height, cudaArraySurfaceLoadStore);
+
+    cudaResourceDesc res;
+    memset(&res, 0, sizeof(res));
+    res.resType = cudaResourceTypeArray;
+    res.res.array.array = plan.a_coef;
+
+    cudaTextureDesc tex;
+    memset(&tex, 0, sizeof(tex));
+    tex.addressMode[0] = tex.addressMode[1] = cudaAddressModeClamp;
+    tex.filterMode = cudaFilterModeLinear;
+    tex.readMode = cudaReadModeElementType;
+    tex.normalizedCoords = 0;
+
+    cudaCreateTextureObject(&plan.tex_coef, &res, &tex, 0);
+    cudaCreateSurfaceObject(&plan.surf_coef, &res);
+
+    cudaFuncSetCacheConfig(bspline3_step5, cudaFuncCachePreferShared);
+
+    check_cuda_error("Error preparing cubic B-spline plan");
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run the cubic B-spline prefilter into the coefficients texture
+ *
+ *  Same steps of alg6_gpu() on the plan input (see upload() of the
+ *  prefilter plan) except the last one writing the coefficients
+ *  surface (see bspline3_step5()).
+ *
+ *  @param[in,out] plan The plan to run
+ */
+inline void bspline3_prefilter( bspline3_plan& plan ) {
+
+    alg6_plan<true,1>& pre = plan.pre;
+    const int m_size = pre.m_size, n_size = pre.n_size;
+
+    launch_alg5v6_step1<true>(pre, &pre.d_pybar, &pre.d_ezhat,
+                              &pre.d_ptucheck, &pre.d_etvtilde, pre.params);
+
+    launch_alg3v4v5v6_step2v4(pre, &pre.d_pybar, &pre.d_ezhat, m_size, n_size);
+
+    alg6_step3<<< dim3(m_size, n_size), dim3(WS, NWARC), 0, pre.stream >>>
+        ( &pre.d_ptucheck, &pre.d_etvtilde, &pre.d_pybar, &pre.d_ezhat,
+          &pre.d_cmat, pre.params, m_size, n_size );
+
+    launch_alg3v4v5v6_step2v4(pre, &pre.d_ptucheck, &pre.d_etvtilde, n_size, m_size, true);
+
+    // only the image blocks have coefficients (not the border blocks)
+    bspline3_step5<<< dim3((plan.width+WS-1)/WS, (plan.height+WS-1)/WS), dim3(WS, NWW),
+        0, pre.stream >>>
+        ( pre.tex_in, plan.surf_coef, &pre.d_pybar, &pre.d_ezhat,
+          &pre.d_ptucheck, &pre.d_etvtilde, pre.params, pre.inv_width, pre.inv_height,
+          m_size, n_size, plan.width, plan.height );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Sample the cubic B-spline of the coefficients by a warp
+ *
+ *  The warped output (tight pitch) stays in the plan, re-allocated
+ *  only when its size changes.
+ *
+ *  @param[in,out] plan The plan with the coefficients (see bspline3_prefilter())
+ *  @param[in] warp The warp from output to input positions
+ *  @param[in] out_width Output width
+ *  @param[in] out_height Output height
+ *  @tparam Warp Warp type (see affine_warp and mesh_warp)
+ */
+template <class Warp>
+void bspline3_warp( bspline3_plan& plan,
+                    const Warp& warp,
+                    int out_width, int out_height ) {
+
+    if (out_width <= 0 || out_height <= 0)
+        throw std::runtime_error("Invalid warped output size");
+
+    plan.out_width = out_width;
+    plan.out_height = out_height;
+    plan.d_img.resize(out_width*out_height);
+
+    bspline3_warp<<< dim3((out_width+WS-1)/WS, (out_height+NWS-1)/NWS), dim3(WS, NWS),
+        0, plan.pre.stream >>>
+        ( plan.tex_coef, warp, &plan.d_img, out_width, out_height );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Make a mesh warp from vertices in device memory
+ *  @param[in] d_pos Input position of each vertex (row-major, in device memory)
+ *  @param[in] width Number of vertices in width (at least 2)
+ *  @param[in] height Number of vertices in height (at least 2)
+ *  @param[in] out_width Output width
+ *  @param[in] out_height Output height
+ *  @return The mesh warp
+ */
+inline mesh_warp make_mesh_warp( const float2 *d_pos,
+                                 int width, int height,
+                                 int out_width, int out_height ) {
+    if (width < 2 || height < 2)
+        throw std::runtime_error("Mesh warp needs at least 2x2 vertices");
+    mesh_warp m;
+    m.pos = d_pos;
+    m.width = width;
+    m.height = height;
+    m.sx = (width-1)/(float)out_width;
+    m.sy = (height-1)/(float)out_height;
+    return m;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the warped output to the host
+ *  @param[in] plan The plan with the warped output
+ *  @param[out] h_out The warped output in host memory (tight pitch)
+ */
+inline void download_warped( const bspline3_plan& plan,
+                             float *h_out ) {
+    cudaMemcpyAsync(h_out, &plan.d_img, plan.out_width*plan.out_height*sizeof(float),
+                    cudaMemcpyDeviceToHost, plan.pre.stream);
+    cudaStreamSynchronize(plan.pre.stream);
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // BSPLINE3_GPU_CUH
+//==============================================================================
@@ -0,0 +1,250 @@
+/**
+ *  @file cpupool.h
+ *  @brief Work-stealing thread pool of the CPU algorithms
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef CPUPOOL_H
+#define CPUPOOL_H
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <pthread.h>
+#include <unistd.h>
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @class cpu_pool cpupool.h
+ *  @ingroup api_cpu
+ *  @brief Work-stealing thread pool running parallel loops of tasks
+ *
+ *  A parallel loop of n tasks is split in one contiguous range of
+ *  tasks per thread.  Each thread runs the tasks from the front of
+ *  its own range and, when it is empty, steals the back half of the
+ *  range of another thread, thus uneven tasks (e.g. ragged edge
+ *  blocks or a busy core) are balanced without a central queue.  The
+ *  calling thread is one of the pool threads, and the loop returns
+ *  when all its tasks are done.  Tasks must not throw nor run loops
+ *  on the same pool.
+ */
+class cpu_pool {
+
+public:
+
+    typedef void (*task_fn)(void *arg, int i); ///< Task i of a loop on arg
+
+    /**
+     *  Constructor
+     *  @param[in] nthreads Number of threads (zero means one per core)
+     */
+    explicit cpu_pool( int nthreads = 0 ) : m_generation(0), m_busy(0),
+                                            m_quit(false), m_fn(0), m_arg(0) {
+        if (nthreads <= 0)
+            nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+        m_size = nthreads > 0 ? nthreads : 1;
+        m_ranges = new range[m_size];
+        pthread_mutex_init(&m_mutex, 0);
+        pthread_cond_init(&m_start, 0);
+        pthread_cond_init(&m_done, 0);
+        m_threads.resize(m_size);
+        m_args.resize(m_size);
+        for (int id = 1; id < m_size; ++id) {
+            m_args[id].pool = this;
+            m_args[id].id = id;
+            pthread_create(&m_threads[id], 0, thread_main, &m_args[id]);
+        }
+    }
+
+    /// Destructor
+    ~cpu_pool() {
+        pthread_mutex_lock(&m_mutex);
+        m_quit = true;
+        pthread_cond_broadcast(&m_start);
+        pthread_mutex_unlock(&m_mutex);
+        for (int id = 1; id < m_size; ++id)
+            pthread_join(m_threads[id], 0);
+        pthread_cond_destroy(&m_done);
+        pthread_cond_destroy(&m_start);
+        pthread_mutex_destroy(&m_mutex);
+        delete [] m_ranges;
+    }
+
+    /**
+     *  @brief Number of threads of this pool (including the caller)
+     *  @return Number of threads
+     */
+    int size() const { return m_size; }
+
+    /**
+     *  @brief Run a parallel loop of tasks and wait for all of them
+     *  @param[in] n Number of tasks (from 0 to n-1)
+     *  @param[in] fn Function running one task
+     *  @param[in] arg Argument passed to all tasks
+     */
+    void run( int n, task_fn fn, void *arg ) {
+        if (n <= 0) return;
+        pthread_mutex_lock(&m_mutex);
+        m_fn = fn;
+        m_arg = arg;
+        for (int id = 0; id < m_size; ++id) {
+            pthread_mutex_lock(&m_ranges[id].mutex);
+            m_ranges[id].begin = (int)(((long)n*id)/m_size);
+            m_ranges[id].end = (int)(((long)n*(id+1))/m_size);
+            pthread_mutex_unlock(&m_ranges[id].mutex);
+        }
+        m_busy = m_size-1;
+        ++m_generation;
+        pthread_cond_broadcast(&m_start);
+        pthread_mutex_unlock(&m_mutex);
+        work(0);
+        pthread_mutex_lock(&m_mutex);
+        while (m_busy > 0)
+            pthread_cond_wait(&m_done, &m_mutex);
+        pthread_mutex_unlock(&m_mutex);
+    }
+
+private:
+
+    /**
+     *  @struct range cpupool.h
+     *  @brief Range of tasks of one thread (locked when taken or stolen)
+     */
+    struct range {
+        pthread_mutex_t mutex; ///< Lock of this range
+        int begin, end; ///< First and one past last task
+        /// Default constructor
+        range() : begin(0), end(0) { pthread_mutex_init(&mutex, 0); }
+        /// Destructor
+        ~range() { pthread_mutex_destroy(&mutex); }
+    };
+
+    /**
+     *  @struct thread_arg cpupool.h
+     *  @brief Argument of each pool thread
+     */
+    struct thread_arg {
+        cpu_pool *pool; ///< The pool of the thread
+        int id; ///< Thread identifier in the pool
+    };
+
+    /**
+     *  @brief Main function of each pool thread but the caller
+     *  @param[in] p The thread argument
+     *  @return Nothing
+     */
+    static void *thread_main( void *p ) {
+        cpu_pool *pool = ((thread_arg *)p)->pool;
+        int id = ((thread_arg *)p)->id, seen = 0;
+        for (;;) {
+            pthread_mutex_lock(&pool->m_mutex);
+            while (pool->m_generation == seen && !pool->m_quit)
+                pthread_cond_wait(&pool->m_start, &pool->m_mutex);
+            if (pool->m_quit) {
+                pthread_mutex_unlock(&pool->m_mutex);
+                return 0;
+            }
+            seen = pool->m_generation;
+            pthread_mutex_unlock(&pool->m_mutex);
+            pool->work(id);
+            pthread_mutex_lock(&pool->m_mutex);
+            if (--pool->m_busy == 0)
+                pthread_cond_signal(&pool->m_done);
+            pthread_mutex_unlock(&pool->m_mutex);
+        }
+    }
+
+    /**
+     *  @brief Run tasks of the own range then stolen ones until none is left
+     *  @param[in] id Thread identifier in the pool
+     */
+    void work( int id ) {
+        int i;
+        while (pop(id, i) || steal(id, i))
+            m_fn(m_arg, i);
+    }
+
+    /**
+     *  @brief Take the next task from the front of the own range
+     *  @param[in] id Thread identifier in the pool
+     *  @param[out] i The task taken
+     *  @return True if a task was taken
+     */
+    bool pop( int id, int& i ) {
+        range& r = m_ranges[id];
+        pthread_mutex_lock(&r.mutex);
+        bool taken = r.begin < r.end;
+        if (taken) i = r.begin++;
+        pthread_mutex_unlock(&r.mutex);
+        return taken;
+    }
+
+    /**
+     *  @brief Steal the back half of the range of another thread
+     *
+     *  The first stolen task is taken and the others become the own
+     *  range, where they can be stolen again.
+     *
+     *  @param[in] id Thread identifier in the pool
+     *  @param[out] i The task taken
+     *  @return True if a task was stolen
+     */
+    bool steal( int id, int& i ) {
+        for (int k = 1; k < m_size; ++k) {
+            range& v = m_ranges[(id+k)%m_size];
+            pthread_mutex_lock(&v.mutex);
+            int end = v.end, mid = v.begin + (v.end-v.begin)/2;
+            if (mid < end) v.end = mid;
+            pthread_mutex_unlock(&v.mutex);
+            if (mid < end) {
+                range& r = m_ranges[id];
+                pthread_mutex_lock(&r.mutex);
+                r.begin = mid+1;
+                r.end = end;
+                pthread_mutex_unlock(&r.mutex);
+                i = mid;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Pool to copy to this object
+     */
+    cpu_pool( const cpu_pool& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Pool to copy from
+     *  @return This pool with assigned values
+     */
+    cpu_pool& operator = ( const cpu_pool& p );
+
+    int m_size; ///< Number of threads (including the caller)
+    range *m_ranges; ///< Range of tasks of each thread
+    std::vector<pthread_t> m_threads; ///< Pool threads (but the caller)
+    std::vector<thread_arg> m_args; ///< Argument of each pool thread
+    pthread_mutex_t m_mutex; ///< Lock of the loop state
+    pthread_cond_t m_start, m_done; ///< Loop start and done conditions
+    int m_generation; ///< Number of loops started
+    int m_busy; ///< Number of pool threads still working in the loop
+    bool m_quit; ///< Flag to stop all pool threads
+    task_fn m_fn; ///< Task function of the current loop
+    void *m_arg; ///< Task argument of the current loop
+
+};
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // CPUPOOL_H
+//==============================================================================
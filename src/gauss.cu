@@ -0,0 +1,135 @@
+/**
+ *  @file gauss.cu
+ *  @brief Gaussian blur in the GPU choosing the direct, FFT or recursive method
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#define APPNAME "[gauss]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+
+#include "gauss_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @brief Calibrate all Gaussian blur methods on a sweep of sizes and sigmas
+ *
+ *  Square sizes double from 256 up to the maximum size and sigmas
+ *  grow by a half octave from 0.5 up to 200, one calibration per
+ *  size and sigma class (see calibrate_gauss()).
+ *
+ *  @param[in] max_size Maximum (square) image size
+ */
+void calibrate( int max_size ) {
+
+    std::cout << APPNAME << " Calibrating into " << gpufilter::gauss_file() << "\n";
+    std::cout << APPNAME << " [size] [sigma] [direct-ms] [fft-ms] [fft-error]"
+              << " [recursive-ms] [recursive-error] [chosen]\n";
+
+    for (int size = 256; size <= max_size; size *= 2) {
+        for (float sigma = .5f; sigma <= 200.f; sigma *= std::sqrt(2.f)) {
+            gpufilter::gauss_calib c = gpufilter::calibrate_gauss(size, size, sigma);
+            std::cout << APPNAME << " " << size << " " << std::fixed
+                      << std::setprecision(2) << sigma << std::setprecision(4)
+                      << " " << c.time[0]*1000 << " " << c.time[1]*1000
+                      << " " << std::scientific << std::setprecision(2)
+                      << c.error[1] << " " << std::fixed << std::setprecision(4)
+                      << c.time[2]*1000 << " " << std::scientific
+                      << std::setprecision(2) << c.error[2] << " "
+                      << gauss_method_name(gpufilter::choose_gauss(size, size, sigma))
+                      << "\n" << std::flush;
+        }
+    }
+
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1024, height = 1024, method = 0, runtimes = 1;
+    float sigma = 4.f, me = 0.f, mre = 0.f;
+
+    if (argc > 1 && !strcmp(argv[1], "-calibrate")) {
+        int max_size = 4096;
+        if (argc > 2 && (sscanf(argv[2], "%d", &max_size) != 1 || max_size < 256)) {
+            std::cerr << APPNAME << " Bad arguments!\n";
+            return 1;
+        }
+        calibrate(max_size);
+        return 0;
+    }
+
+    if ((argc > 1 && argc < 4) ||
+        (argc >= 4 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1 ||
+                       sscanf(argv[3], "%f", &sigma) != 1 || sigma <= 0.f)) ||
+        (argc >= 5 && (sscanf(argv[4], "%d", &method) != 1 ||
+                       method < 0 || method > 3)) ||
+        (argc >= 6 && sscanf(argv[5], "%d", &runtimes) != 1)) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height sigma [method [runtimes]]]\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " -calibrate [max-size]\n";
+        std::cout << APPNAME << " Methods: 0 auto, 1 direct, 2 fft, 3 recursive\n";
+        return 1;
+    }
+
+    gpufilter::GaussMethod m = method == 0 ?
+        gpufilter::choose_gauss(width, height, sigma) : (gpufilter::GaussMethod)method;
+
+    std::vector< float > ref_img(width*height), gpu_img(width*height);
+
+    srand( 1234 );
+    for (int i = 0; i < width*height; ++i)
+        gpu_img[i] = ref_img[i] = rand() / (float)RAND_MAX;
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Sigma: " << sigma << "  Run-times: 1\n";
+        std::cout << APPNAME << " Boundary: clamp  Method: "
+                  << gauss_method_name(m) << "\n";
+        std::cout << APPNAME << " (1) Runs the direct method in the GPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the chosen method in the GPU (res)\n";
+        std::cout << APPNAME << " (3) Checks computations (ref x res)\n";
+    }
+
+    {
+        gpufilter::gauss_plan plan;
+        gpufilter::prepare_gauss(plan, width, height, sigma, gpufilter::GAUSS_DIRECT);
+        gpufilter::dvector<float> d_in(ref_img);
+        gpufilter::gauss_gpu(plan, d_in);
+        cudaMemcpy(&ref_img[0], &plan.d_img, width*height*sizeof(float),
+                   cudaMemcpyDeviceToHost);
+    }
+
+    gpufilter::gauss_gpu(&gpu_img[0], width, height, runtimes, sigma, m);
+
+    gpufilter::check_cpu_reference( &ref_img[0], &gpu_img[0], width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
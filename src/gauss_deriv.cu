@@ -0,0 +1,121 @@
+/**
+ *  @file gauss_deriv.cu
+ *  @brief Recursive Gaussian derivatives in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#define ORDER 3 // third-order recursive Gaussian
+#define APPNAME "[gauss_deriv]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <cassert>
+#include <iostream>
+#include <algorithm>
+#include <iomanip>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+#include <util/gaussian.h>
+
+#include "cpudefs.h"
+#include "gpudefs.h"
+#include "alg0_cpu.h"
+#include "gauss_deriv_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute the Gaussian derivatives in the CPU (reference)
+ *
+ *  The image is smoothed by algorithm 0 and differentiated by central
+ *  differences extending the smoothed image by the border type.
+ *
+ *  @param[in,out] h_img The in(out)put 2D image (smoothed at output)
+ *  @param[out] h_d The five output images: Gx, Gy, Gxx, Gyy and Gxy
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] a0border Number of border blocks for algorithm 0
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+void gauss_deriv_cpu( float *h_img, float *h_d[5],
+                      int width, int height,
+                      const gpufilter::Vector<float, ORDER+1>& w,
+                      int a0border,
+                      const gpufilter::BorderType& btype ) {
+
+    gpufilter::alg0_cpu<ORDER>(h_img, width, height, w, a0border, btype);
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+#define G(dx, dy) gpufilter::getpix(h_img, x+dx, y+dy, width, height, btype)
+            const int i = y*width+x;
+            h_d[0][i] = .5f*(G(1,0) - G(-1,0));
+            h_d[1][i] = .5f*(G(0,1) - G(0,-1));
+            h_d[2][i] = G(1,0) - 2.f*G(0,0) + G(-1,0);
+            h_d[3][i] = G(0,1) - 2.f*G(0,0) + G(0,-1);
+            h_d[4][i] = .25f*(G(1,1) - G(-1,1) - G(1,-1) + G(-1,-1));
+#undef G
+        }
+    }
+
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width, height, runtimes, border, a0border;
+    gpufilter::BorderType btype;
+    std::vector<float> cpu_img, gpu_img;
+    gpufilter::Vector<float, ORDER+1> w;
+    float me, mre;
+
+    initial_setup(width, height, runtimes, btype, border,
+                  cpu_img, gpu_img, w, a0border, me, mre,
+                  argc, argv);
+
+    if (border != 0) {
+        std::cout << APPNAME << " Only the infinite extension (0 border blocks)"
+                  << " is supported!\n";
+        return 1;
+    }
+
+    if (runtimes == 1) // running for debugging
+        print_info(width, height, btype, border, a0border, w);
+
+    std::vector<float> cpu_d(5*width*height), gpu_d(5*width*height);
+    float *h_cpu[5], *h_gpu[5];
+    for (int k = 0; k < 5; ++k) {
+        h_cpu[k] = &cpu_d[k*width*height];
+        h_gpu[k] = &gpu_d[k*width*height];
+    }
+
+    gauss_deriv_cpu(&cpu_img[0], h_cpu, width, height, w, a0border, btype);
+
+    gpufilter::gauss_deriv_gpu(&gpu_img[0], h_gpu, width, height, runtimes,
+                               4.f, btype); // same sigma as initial_setup
+
+    gpufilter::check_cpu_reference( &cpu_d[0], &gpu_d[0], 5*width*height, me, mre );
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,300 @@
+/**
+ *  @file gauss_deriv_gpu.cuh
+ *  @brief Recursive Gaussian derivatives in the GPU with exact boundaries
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GAUSS_DERIV_GPU_CUH
+#define GAUSS_DERIV_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <util/gaussian.h>
+
+#include "alg6_gpu.cuh"
+#include "alg6_clamp.cuh"
+#include "alg6_repeat.cuh"
+#include "alg6_reflect.cuh"
+
+//== DEFINES ===================================================================
+
+#define NWDV 8 ///< # of warps computing derivatives (one row of pixels each)
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct gauss_deriv_plan gauss_deriv_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of the Gaussian derivatives of one image size and sigma
+ *
+ *  The image is smoothed once by the third-order recursive Gaussian
+ *  of algorithm 6, computing the boundary exactly (only the plan of
+ *  the border type is prepared), and all derivatives are central
+ *  differences of the smoothed image computed together from one
+ *  read of it, as in [vanVliet:1998] cited in weights().  Hence a
+ *  scale space costs the same per pixel for any sigma.  The outputs
+ *  stay in the plan (in device memory).
+ */
+struct gauss_deriv_plan {
+
+    int width, height; ///< Image width and height
+    float sigma; ///< Gaussian sigma
+    BorderType btype; ///< Border type (either zero, clamp, repeat or reflect)
+    alg6_plan<false,3> zero; ///< Smoothing plan for zero border
+    alg6_clamp_plan<3> clamp; ///< Smoothing plan for clamp border
+    alg6_repeat_plan<3> repeat; ///< Smoothing plan for repeat border
+    alg6_reflect_plan<3> reflect; ///< Smoothing plan for reflect border
+    dvector<float> d_g; ///< Smoothed image G
+    dvector<float> d_gx, d_gy; ///< First derivatives Gx and Gy
+    dvector<float> d_gxx, d_gyy, d_gxy; ///< Second derivatives Gxx, Gyy and Gxy
+
+    /// Default constructor
+    gauss_deriv_plan() : width(0), height(0), sigma(0.f),
+                         btype(CLAMP_TO_ZERO) { }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    gauss_deriv_plan( const gauss_deriv_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    gauss_deriv_plan& operator = ( const gauss_deriv_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Read a smoothed pixel given a border type
+ *
+ *  Pixels outside the image are zero or taken from the image as the
+ *  input image is extended by the border type (up to one pixel off).
+ *
+ *  @param[in] g_in The smoothed image
+ *  @param[in] x Pixel column (from -1 to width)
+ *  @param[in] y Pixel row (from -1 to height)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @return The pixel value
+ */
+__device__ inline
+float deriv_pixel( const float *g_in,
+                   int x, int y, int width, int height,
+                   BorderType btype ) {
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        if (btype == CLAMP_TO_ZERO) return 0.f;
+        if (btype == REPEAT) {
+            x = (x+width) % width;
+            y = (y+height) % height;
+        } else if (btype == REFLECT) {
+            x = x < 0 ? -x-1 : x >= width ? 2*width-x-1 : x;
+            y = y < 0 ? -y-1 : y >= height ? 2*height-y-1 : y;
+        }
+        x = min(max(x, 0), width-1);
+        y = min(max(y, 0), height-1);
+    }
+    return __ldg(&g_in[y*width+x]);
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Compute Gaussian derivatives as central differences
+ *
+ *  Each CUDA block loads its tile of the smoothed image (with one
+ *  pixel around) to shared memory once and computes all derivatives
+ *  asked for (non-null outputs) from it:
+ *
+ *  \li \f$G_x = (G_{x+1} - G_{x-1})/2\f$ and \f$G_{xx} = G_{x+1} - 2G + G_{x-1}\f$;
+ *
+ *  \li \f$G_y\f$ and \f$G_{yy}\f$ likewise in columns;
+ *
+ *  \li \f$G_{xy} = (G_{x+1,y+1} - G_{x-1,y+1} - G_{x+1,y-1} + G_{x-1,y-1})/4\f$.
+ *
+ *  @param[out] g_gx First derivative in x (or null)
+ *  @param[out] g_gy First derivative in y (or null)
+ *  @param[out] g_gxx Second derivative in x (or null)
+ *  @param[out] g_gyy Second derivative in y (or null)
+ *  @param[out] g_gxy Mixed second derivative (or null)
+ *  @param[in] g_in The smoothed image
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+__global__ __launch_bounds__(WS*NWDV)
+void gauss_derivs( float *g_gx, float *g_gy,
+                   float *g_gxx, float *g_gyy, float *g_gxy,
+                   const float *g_in,
+                   int width, int height,
+                   BorderType btype ) {
+
+    __shared__ float s_g[NWDV+2][WS+2];
+
+    const int tx = threadIdx.x, ty = threadIdx.y,
+        x0 = blockIdx.x*WS-1, y0 = blockIdx.y*NWDV-1;
+
+    for (int i = ty*WS+tx; i < (NWDV+2)*(WS+2); i += WS*NWDV)
+        s_g[i/(WS+2)][i%(WS+2)] = deriv_pixel(g_in, x0+i%(WS+2), y0+i/(WS+2),
+                                              width, height, btype);
+
+    __syncthreads();
+
+    const int x = x0+1+tx, y = y0+1+ty, i = y*width+x;
+
+    if (x >= width || y >= height) return;
+
+    const float c = s_g[ty+1][tx+1],
+        l = s_g[ty+1][tx], r = s_g[ty+1][tx+2],
+        u = s_g[ty][tx+1], d = s_g[ty+2][tx+1];
+
+    if (g_gx) g_gx[i] = .5f*(r - l);
+    if (g_gy) g_gy[i] = .5f*(d - u);
+    if (g_gxx) g_gxx[i] = r - 2.f*c + l;
+    if (g_gyy) g_gyy[i] = d - 2.f*c + u;
+    if (g_gxy) g_gxy[i] = .25f*(s_g[ty+2][tx+2] - s_g[ty+2][tx]
+                                - s_g[ty][tx+2] + s_g[ty][tx]);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare a Gaussian derivatives plan in the GPU
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+inline void prepare_gauss_deriv( gauss_deriv_plan& plan,
+                                 int width, int height, float sigma,
+                                 BorderType btype=CLAMP_TO_EDGE ) {
+
+    plan.width = width;
+    plan.height = height;
+    plan.sigma = sigma;
+    plan.btype = btype;
+
+    Vector<float, 4> w;
+    weights(sigma, w);
+
+    if (btype == CLAMP_TO_ZERO) prepare_alg6(plan.zero, width, height, w);
+    else if (btype == CLAMP_TO_EDGE) prepare_alg6_clamp(plan.clamp, width, height, w);
+    else if (btype == REPEAT) prepare_alg6_repeat(plan.repeat, width, height, w);
+    else prepare_alg6_reflect(plan.reflect, width, height, w);
+
+    plan.d_g.resize(width*height);
+    plan.d_gx.resize(width*height);
+    plan.d_gy.resize(width*height);
+    plan.d_gxx.resize(width*height);
+    plan.d_gyy.resize(width*height);
+    plan.d_gxy.resize(width*height);
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run a Gaussian derivatives plan in the GPU
+ *
+ *  The smoothed image is always computed, the derivatives only if
+ *  asked for.  Derivatives are per pixel, multiply them by sigma (or
+ *  sigma squared for second derivatives) to normalize across scales.
+ *
+ *  @param[in,out] plan The plan to run (with the output images)
+ *  @param[in] d_in The input image in device memory
+ *  @param[in] first Flag to compute the first derivatives Gx and Gy
+ *  @param[in] second Flag to compute the second derivatives Gxx, Gyy and Gxy
+ */
+inline void gauss_deriv_gpu( gauss_deriv_plan& plan,
+                             const dvector<float>& d_in,
+                             bool first=true, bool second=true ) {
+
+    if (plan.btype == CLAMP_TO_ZERO) {
+        upload(plan.zero, d_in);
+        alg6_gpu(plan.zero);
+        download(plan.zero, plan.d_g);
+    } else if (plan.btype == CLAMP_TO_EDGE) {
+        upload(plan.clamp, d_in);
+        alg6_clamp(plan.clamp);
+        download(plan.clamp, plan.d_g);
+    } else if (plan.btype == REPEAT) {
+        upload(plan.repeat, d_in);
+        alg6_repeat(plan.repeat);
+        download(plan.repeat, plan.d_g);
+    } else {
+        upload(plan.reflect, d_in);
+        alg6_reflect(plan.reflect);
+        download(plan.reflect, plan.d_g);
+    }
+
+    if (!first && !second) return;
+
+    gauss_derivs<<< dim3((plan.width+WS-1)/WS, (plan.height+NWDV-1)/NWDV),
+        dim3(WS, NWDV) >>>
+        ( first ? &plan.d_gx : 0, first ? &plan.d_gy : 0,
+          second ? &plan.d_gxx : 0, second ? &plan.d_gyy : 0,
+          second ? &plan.d_gxy : 0,
+          &plan.d_g, plan.width, plan.height, plan.btype );
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the Gaussian derivatives in the GPU
+ *  @param[in] h_img The input 2D image in host memory
+ *  @param[out] h_d The five output images in host memory: Gx, Gy, Gxx, Gyy and Gxy
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+inline void gauss_deriv_gpu( const float *h_img,
+                             float *h_d[5],
+                             int width, int height, int runtimes,
+                             float sigma,
+                             BorderType btype=CLAMP_TO_EDGE ) {
+
+    gauss_deriv_plan plan;
+    prepare_gauss_deriv(plan, width, height, sigma, btype);
+
+    dvector<float> d_in(h_img, width*height);
+
+    base_timer &timer_total = timers.gpu_add("gauss_deriv_gpu", width*height, "iP");
+
+    for (int r = 0; r < runtimes; ++r)
+        gauss_deriv_gpu(plan, d_in);
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+    const dvector<float> *d_d[5] = { &plan.d_gx, &plan.d_gy, &plan.d_gxx,
+                                     &plan.d_gyy, &plan.d_gxy };
+    for (int k = 0; k < 5; ++k)
+        cudaMemcpy(h_d[k], *d_d[k], width*height*sizeof(float),
+                   cudaMemcpyDeviceToHost);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GAUSS_DERIV_GPU_CUH
+//==============================================================================
@@ -73,11 +73,6 @@ __constant__ int c_width, c_height;
 __constant__ Vector< float, KERNEL_RADIUS * 2 + 1 > c_kernel;
 __constant__ int c_fft_width;
 
-texture< float, 2, cudaReadModeElementType > t_in_img;
-
-surface< void, 2 > f_in_img;
-surface< void, 2 > f_out_img;
-
 /// Memory types are: TMEM texture memory; SMEM shared memory; GMEM
 /// global memory
 
@@ -96,6 +91,32 @@ int d_clamp( const int& i, const int& n ) {
     else return i;
 }
 
+// auxiliary function creating the texture object of an array (clamped)
+cudaTextureObject_t create_tex_img( cudaArray *a_img ) {
+    cudaResourceDesc res; memset( &res, 0, sizeof(res) );
+    res.resType = cudaResourceTypeArray;
+    res.res.array.array = a_img;
+    cudaTextureDesc td; memset( &td, 0, sizeof(td) );
+    td.addressMode[0] = cudaAddressModeClamp;
+    td.addressMode[1] = cudaAddressModeClamp;
+    td.filterMode = cudaFilterModePoint;
+    td.readMode = cudaReadModeElementType;
+    td.normalizedCoords = 0;
+    cudaTextureObject_t t_img = 0;
+    cudaCreateTextureObject( &t_img, &res, &td, 0 );
+    return t_img;
+}
+
+// auxiliary function creating the surface object of an array
+cudaSurfaceObject_t create_surf_img( cudaArray *a_img ) {
+    cudaResourceDesc res; memset( &res, 0, sizeof(res) );
+    res.resType = cudaResourceTypeArray;
+    res.res.array.array = a_img;
+    cudaSurfaceObject_t f_img = 0;
+    cudaCreateSurfaceObject( &f_img, &res );
+    return f_img;
+}
+
 ///----------------- GAUSS-0 - TWO-PASS CONVOLUTION IN GMEM -----------------
 template< int p_radius >
 __global__ __launch_bounds__( WS*NW, NB )
@@ -146,7 +167,7 @@ void gauss0_cols( float *g_out, const float *g_in ) {
 ///----------------- GAUSS-1 - TWO-PASS CONVOLUTION IN TMEM -----------------
 template< int p_radius >
 __global__ __launch_bounds__( WS1*NW1, NB1 )
-void gauss1_rows( void ) {
+void gauss1_rows( cudaTextureObject_t t_in_img, cudaSurfaceObject_t f_out_img ) {
 
     const int tx = threadIdx.x, ty = threadIdx.y,
         bx = blockIdx.x, by = blockIdx.y, col = bx*WS1+tx, row = by*NW1+ty;
@@ -157,7 +178,7 @@ void gauss1_rows( void ) {
 
 #pragma unroll
     for (int k = -p_radius; k <= p_radius; ++k) {
-        s += tex2D( t_in_img, tu+k, tv ) * c_kernel[ k + p_radius ];
+        s += tex2D<float>( t_in_img, tu+k, tv ) * c_kernel[ k + p_radius ];
     }
 
     surf2Dwrite( s, f_out_img, col*4, row, cudaBoundaryModeTrap ); // trap kills kernel if outside boundary
@@ -166,7 +187,7 @@ void gauss1_rows( void ) {
 
 template< int p_radius >
 __global__ __launch_bounds__( WS1*NW1, NB1 )
-void gauss1_cols( float *g_out ) {
+void gauss1_cols( cudaTextureObject_t t_in_img, float *g_out ) {
     const int tx = threadIdx.x, ty = threadIdx.y,
         bx = blockIdx.x, by = blockIdx.y, col = bx*WS1+tx, row = by*NW1+ty;
     if( row >= c_height or col >= c_width ) return;
@@ -176,7 +197,7 @@ void gauss1_cols( float *g_out ) {
 
 #pragma unroll
     for (int k = -p_radius; k <= p_radius; ++k) {
-        s += tex2D( t_in_img, tu, tv+k ) * c_kernel[ k + p_radius ];
+        s += tex2D<float>( t_in_img, tu, tv+k ) * c_kernel[ k + p_radius ];
     }
 
     *g_out = s;
@@ -186,17 +207,17 @@ void gauss1_cols( float *g_out ) {
 ///----------------- GAUSS-2 - TWO-PASS CONVOLUTION IN SMEM -----------------
 template< int p_radius >
 __global__ __launch_bounds__( MNT, MNB )
-void gauss2_rows( void ) {
+void gauss2_rows( cudaTextureObject_t t_in_img, cudaSurfaceObject_t f_out_img ) {
     const int tx = threadIdx.x, bx = blockIdx.x, by = blockIdx.y;
 
     float tu = bx*MNT+tx + .5f, tv = by + .5f;
     float s = 0.f;
     volatile __shared__ float s_row[ MNT + p_radius*2 ];
 
-    s_row[ p_radius + tx ] = tex2D( t_in_img, tu, tv );
+    s_row[ p_radius + tx ] = tex2D<float>( t_in_img, tu, tv );
 
-    if( tx < p_radius ) s_row[ tx ] = tex2D( t_in_img, tu - p_radius, tv );
-    else if( tx < 2*p_radius ) s_row[ MNT + tx ] = tex2D( t_in_img, tu - p_radius + MNT, tv );
+    if( tx < p_radius ) s_row[ tx ] = tex2D<float>( t_in_img, tu - p_radius, tv );
+    else if( tx < 2*p_radius ) s_row[ MNT + tx ] = tex2D<float>( t_in_img, tu - p_radius + MNT, tv );
 
     __syncthreads();
     if( bx*MNT+tx >= c_width ) return;
@@ -212,7 +233,7 @@ void gauss2_rows( void ) {
 
 template< int p_radius >
 __global__ __launch_bounds__( WS2*NW2, NB2 )
-void gauss2_cols( float *g_out ) {
+void gauss2_cols( cudaTextureObject_t t_in_img, float *g_out ) {
     const int tx = threadIdx.x, ty = threadIdx.y,
         bx = blockIdx.x, by = blockIdx.y;
 
@@ -221,22 +242,22 @@ void gauss2_cols( float *g_out ) {
 
     volatile __shared__ float s_cols[ WS2 ][ NW2 + p_radius*2 + 1 ];
 
-    s_cols[ tx ][ p_radius + ty ] = tex2D( t_in_img, tu, tv );
+    s_cols[ tx ][ p_radius + ty ] = tex2D<float>( t_in_img, tu, tv );
 
     if( p_radius <= NW2/2 ) {
-        if( ty < p_radius ) s_cols[ tx ][ ty ] = tex2D( t_in_img, tu, tv - p_radius );
-        else if( ty < 2*p_radius ) s_cols[ tx ][ NW2 + ty ] = tex2D( t_in_img, tu, tv - p_radius + NW2 );
+        if( ty < p_radius ) s_cols[ tx ][ ty ] = tex2D<float>( t_in_img, tu, tv - p_radius );
+        else if( ty < 2*p_radius ) s_cols[ tx ][ NW2 + ty ] = tex2D<float>( t_in_img, tu, tv - p_radius + NW2 );
     } else if( p_radius <= NW2 ) {
         if( ty < p_radius ) {
-            s_cols[ tx ][ ty ] = tex2D( t_in_img, tu, tv - p_radius );
-            s_cols[ tx ][ p_radius + NW2 + ty ] = tex2D( t_in_img, tu, tv + NW2 );
+            s_cols[ tx ][ ty ] = tex2D<float>( t_in_img, tu, tv - p_radius );
+            s_cols[ tx ][ p_radius + NW2 + ty ] = tex2D<float>( t_in_img, tu, tv + NW2 );
         }
     } else {
         for (int i = 0; i < (p_radius+NW2-1)/NW2; ++i) {
             int wy = i*NW2+ty;
             if( wy < p_radius ) {
-                s_cols[ tx ][ wy ] = tex2D( t_in_img, tu, tv - p_radius + i*NW2 );
-                s_cols[ tx ][ p_radius + NW2 + wy ] = tex2D( t_in_img, tu, tv + NW2 + i*NW2 );
+                s_cols[ tx ][ wy ] = tex2D<float>( t_in_img, tu, tv - p_radius + i*NW2 );
+                s_cols[ tx ][ p_radius + NW2 + wy ] = tex2D<float>( t_in_img, tu, tv + NW2 + i*NW2 );
             }
         }
     }
@@ -258,26 +279,26 @@ void gauss2_cols( float *g_out ) {
 ///----------------- GAUSS-3 - ONE-PASS CONVOLUTION -----------------
 template< int p_radius >
 __device__
-void load_convolve_rows( volatile float *s_in, const int& tx, const float& tu, const float& tv ) {
+void load_convolve_rows( cudaTextureObject_t t_in_img, volatile float *s_in, const int& tx, const float& tu, const float& tv ) {
 
     // load middle data
-    s_in[ p_radius + tx ] = tex2D( t_in_img, tu, tv );
+    s_in[ p_radius + tx ] = tex2D<float>( t_in_img, tu, tv );
 
     // load left and right data
     if( p_radius <= WS3/2 ) {
-        if( tx < p_radius ) s_in[ tx ] = tex2D( t_in_img, tu - p_radius, tv );
-        else if( tx < p_radius*2 ) s_in[ WS3 + tx ] = tex2D( t_in_img, tu - p_radius + WS3, tv );
+        if( tx < p_radius ) s_in[ tx ] = tex2D<float>( t_in_img, tu - p_radius, tv );
+        else if( tx < p_radius*2 ) s_in[ WS3 + tx ] = tex2D<float>( t_in_img, tu - p_radius + WS3, tv );
     } else if( p_radius <= WS3 ) {
         if( tx < p_radius ) {
-            s_in[ tx ] = tex2D( t_in_img, tu - p_radius, tv );
-            s_in[ p_radius + WS3 + tx ] = tex2D( t_in_img, tu + WS3, tv );
+            s_in[ tx ] = tex2D<float>( t_in_img, tu - p_radius, tv );
+            s_in[ p_radius + WS3 + tx ] = tex2D<float>( t_in_img, tu + WS3, tv );
         }
     } else {
         for (int i = 0; i < (p_radius+WS3-1)/WS3; ++i) {
             int wx = i*WS3+tx;
             if( wx < p_radius ) {
-                s_in[ wx ] = tex2D( t_in_img, tu - p_radius + i*WS3, tv );
-                s_in[ p_radius + WS3 + wx ] = tex2D( t_in_img, tu + WS3 + i*WS3, tv );
+                s_in[ wx ] = tex2D<float>( t_in_img, tu - p_radius + i*WS3, tv );
+                s_in[ p_radius + WS3 + wx ] = tex2D<float>( t_in_img, tu + WS3 + i*WS3, tv );
             }
         }
     }
@@ -296,7 +317,7 @@ void load_convolve_rows( volatile float *s_in, const int& tx, const float& tu, c
 
 template< int p_radius >
 __global__ __launch_bounds__( WS3*NW3, NB3 )
-void gauss3( float *g_out ) {
+void gauss3( cudaTextureObject_t t_in_img, float *g_out ) {
     int tx = threadIdx.x, ty = threadIdx.y,
         bx = blockIdx.x, by = blockIdx.y, col = bx*WS3+tx, row = by*NW3+ty;
     if( row >= c_height or col >= c_width ) bx = -1;
@@ -304,23 +325,23 @@ void gauss3( float *g_out ) {
     volatile __shared__ float s_inblock[ NW3 + p_radius*2 ][ WS3 + p_radius*2 ];
 
     // load middle data
-    load_convolve_rows< p_radius >( &s_inblock[ p_radius + ty ][0], tx, tu, tv );
+    load_convolve_rows< p_radius >( t_in_img, &s_inblock[ p_radius + ty ][0], tx, tu, tv );
 
     // load upper and lower data
     if( p_radius <= NW3/2 ) {
-        if( ty < p_radius ) load_convolve_rows< p_radius >( &s_inblock[ ty ][0], tx, tu, tv - p_radius );
-        else if( ty < p_radius*2 ) load_convolve_rows< p_radius >( &s_inblock[ NW3 + ty ][0], tx, tu, tv - p_radius + NW3 );
+        if( ty < p_radius ) load_convolve_rows< p_radius >( t_in_img, &s_inblock[ ty ][0], tx, tu, tv - p_radius );
+        else if( ty < p_radius*2 ) load_convolve_rows< p_radius >( t_in_img, &s_inblock[ NW3 + ty ][0], tx, tu, tv - p_radius + NW3 );
     } else if( p_radius <= NW3 ) {
         if( ty < p_radius ) {
-            load_convolve_rows< p_radius >( &s_inblock[ ty ][0], tx, tu, tv - p_radius );
-            load_convolve_rows< p_radius >( &s_inblock[ p_radius + NW3 + ty ][0], tx, tu, tv + NW3 );
+            load_convolve_rows< p_radius >( t_in_img, &s_inblock[ ty ][0], tx, tu, tv - p_radius );
+            load_convolve_rows< p_radius >( t_in_img, &s_inblock[ p_radius + NW3 + ty ][0], tx, tu, tv + NW3 );
         }
     } else {
         for (int i = 0; i < (p_radius+NW3-1)/NW3; ++i) {
             int wy = i*NW3+ty;
             if( wy < p_radius ) {
-                load_convolve_rows< p_radius >( &s_inblock[ wy ][0], tx, tu, tv - p_radius + i*NW3 );
-                load_convolve_rows< p_radius >( &s_inblock[ p_radius + NW3 + wy ][0], tx, tu, tv + NW3 + i*NW3 );
+                load_convolve_rows< p_radius >( t_in_img, &s_inblock[ wy ][0], tx, tu, tv - p_radius + i*NW3 );
+                load_convolve_rows< p_radius >( t_in_img, &s_inblock[ p_radius + NW3 + wy ][0], tx, tu, tv + NW3 + i*NW3 );
             }
         }
     }
@@ -481,13 +502,12 @@ int main( int argc, char** argv ) {
     copy_to_symbol(c_kernel, kernel_gpu);
     copy_to_symbol(c_fft_width, fft_width);
 
-    t_in_img.addressMode[0] = cudaAddressModeClamp;
-    t_in_img.addressMode[1] = cudaAddressModeClamp;
-    t_in_img.filterMode = cudaFilterModePoint;
-    t_in_img.normalized = false;
-
     if( !a_in_img || !a_fin_img || !a_out_img || !d_in_img || !d_out_img ) { fprintf( stderr, "!!! error!\n" ); return 1; }
 
+    // fortunately output surface can be used as input texture afterwards
+    cudaTextureObject_t t_in_img = create_tex_img( a_in_img ), t_out_img = create_tex_img( a_out_img );
+    cudaSurfaceObject_t f_out_img = create_surf_img( a_out_img );
+
     if( !res_out ) { printf( "done!\n[gauss] Computing in GPU ...\n" ); }
 
     if( !res_out ) { printf( "[gauss] Info: r = %d ; b = %dx%d\n", radius, WS, NW ); fflush(stdin); }
@@ -541,27 +561,21 @@ int main( int argc, char** argv ) {
     { // gauss-1
         cudaMemcpyToArray( a_in_img, 0, 0, &h_in_img[0], sizeof(float)*ne, cudaMemcpyHostToDevice );
         cudaEventRecord( start_device, 0 );
-        cudaBindSurfaceToArray( f_out_img, a_out_img );
 
         for (int i = 0; i <= res_out*(RUN_TIMES-1); ++i) {
 
-            cudaBindTextureToArray( t_in_img, a_in_img );
-
             gauss1_rows< KERNEL_RADIUS >
-                <<< dim3((width+WS1-1)/WS1, (height+NW1-1)/NW1), dim3(WS1, NW1) >>>();
-
-            // fortunately output surface can be used as input texture afterwards
-            cudaBindTextureToArray( t_in_img, a_out_img );
+                <<< dim3((width+WS1-1)/WS1, (height+NW1-1)/NW1), dim3(WS1, NW1) >>>(
+                    t_in_img, f_out_img );
 
             gauss1_cols< KERNEL_RADIUS >
                 <<< dim3((width+WS1-1)/WS1, (height+NW1-1)/NW1), dim3(WS1, NW1) >>>(
-                    d_out_img );
+                    t_out_img, d_out_img );
 
         }
 
         cudaEventRecord( stop_device, 0 );
         cudaEventSynchronize( stop_device );
-        cudaUnbindTexture( t_in_img );
 
         dt = 0.f; cudaEventElapsedTime(&dt, start_device, stop_device); dt /= 1000.f;
         if( res_out == 1 ) dt /= float(RUN_TIMES);
@@ -585,26 +599,21 @@ int main( int argc, char** argv ) {
     { // gauss-2
         cudaMemcpyToArray( a_in_img, 0, 0, &h_in_img[0], sizeof(float)*ne, cudaMemcpyHostToDevice );
         cudaEventRecord( start_device, 0 );
-        cudaBindSurfaceToArray( f_out_img, a_out_img );
 
         for (int i = 0; i <= res_out*(RUN_TIMES-1); ++i) {
 
-            cudaBindTextureToArray( t_in_img, a_in_img );
-
             gauss2_rows< KERNEL_RADIUS >
-                <<< dim3((width+MNT-1)/MNT, height), dim3(MNT, 1) >>>();
-
-            cudaBindTextureToArray( t_in_img, a_out_img );
+                <<< dim3((width+MNT-1)/MNT, height), dim3(MNT, 1) >>>(
+                    t_in_img, f_out_img );
 
             gauss2_cols< KERNEL_RADIUS >
                 <<< dim3((width+WS2-1)/WS2, (height+NW2-1)/NW2), dim3(WS2, NW2) >>>(
-                    d_out_img );
+                    t_out_img, d_out_img );
 
         }
 
         cudaEventRecord( stop_device, 0 );
         cudaEventSynchronize( stop_device );
-        cudaUnbindTexture( t_in_img );
 
         dt = 0.f; cudaEventElapsedTime(&dt, start_device, stop_device); dt /= 1000.f;
         if( res_out == 1 ) dt /= float(RUN_TIMES);
@@ -635,18 +644,16 @@ int main( int argc, char** argv ) {
     { // gauss-3
         cudaMemcpyToArray( a_in_img, 0, 0, &h_in_img[0], sizeof(float)*ne, cudaMemcpyHostToDevice );
         cudaEventRecord( start_device, 0 );
-        cudaBindTextureToArray( t_in_img, a_in_img );
 
         for (int i = 0; i <= res_out*(RUN_TIMES-1); ++i) {
 
             gauss3< KERNEL_RADIUS >
                 <<< dim3((width+WS3-1)/WS3, (height+NW3-1)/NW3), dim3(WS3, NW3) >>>(
-                    d_out_img );
+                    t_in_img, d_out_img );
         }
 
         cudaEventRecord( stop_device, 0 );
         cudaEventSynchronize( stop_device );
-        cudaUnbindTexture( t_in_img );
 
         dt = 0.f; cudaEventElapsedTime(&dt, start_device, stop_device); dt /= 1000.f;
         if( res_out == 1 ) dt /= float(RUN_TIMES);
@@ -742,6 +749,10 @@ int main( int argc, char** argv ) {
 
     cudaEventDestroy(start_device); cudaEventDestroy(stop_device);
 
+    cudaDestroyTextureObject( t_in_img );
+    cudaDestroyTextureObject( t_out_img );
+    cudaDestroySurfaceObject( f_out_img );
+
     cudaFreeArray( a_in_img );
     cudaFreeArray( a_fin_img );
     cudaFreeArray( a_out_img );
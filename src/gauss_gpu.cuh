@@ -0,0 +1,673 @@
+/**
+ *  @file gauss_gpu.cuh
+ *  @brief Gaussian blur in the GPU choosing the direct, FFT or recursive method
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GAUSS_GPU_CUH
+#define GAUSS_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <map>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include <cufft.h>
+
+#include <util/gaussian.h>
+
+#include "alg6_gpu.cuh"
+#include "alg6_clamp.cuh"
+
+//== DEFINES ===================================================================
+
+#define NWG 8 ///< # of warps of the direct and FFT Gaussian kernels
+#define GAUSS_TOL 5e-3f ///< Default maximum error of an exact-enough blur
+#define GAUSS_DIR_RADIUS 12 ///< Largest direct radius if not calibrated
+#define GAUSS_REC_ERROR 2e-3f ///< Recursive error if not calibrated (sigma >= 2)
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== ENUMERATION ===============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Method computing the Gaussian blur
+ */
+enum GaussMethod {
+    GAUSS_AUTO = 0, ///< Fastest exact-enough method (see choose_gauss())
+    GAUSS_DIRECT, ///< Direct (two-pass) convolution of radius four sigma
+    GAUSS_FFT, ///< Convolution through FFT (cuFFT) of the padded image
+    GAUSS_RECURSIVE ///< Third-order recursive filter (algorithm 6 for clamp)
+};
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct gauss_calib gauss_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Calibration of the Gaussian blur methods on one size and sigma
+ *
+ *  Run time (in seconds) and maximum error (against the direct
+ *  method) of each method, indexed by the method minus one.
+ */
+struct gauss_calib {
+    float time[3]; ///< Run time of direct, FFT and recursive methods
+    float error[3]; ///< Maximum error of direct, FFT and recursive methods
+};
+
+/**
+ *  @struct fft_plans gauss_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Forward (real to complex) and inverse cuFFT plans of one size
+ */
+struct fft_plans {
+    cufftHandle fwd, inv; ///< Forward and inverse plans
+};
+
+/**
+ *  @struct gauss_plan gauss_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of the Gaussian blur of one image size and sigma
+ *
+ *  All methods extend the image by clamping to its edge, thus they
+ *  compute the same blur and differ only by accuracy and speed.  The
+ *  output stays in the plan (in device memory).
+ */
+struct gauss_plan {
+
+    int width, height; ///< Image width and height
+    float sigma; ///< Gaussian sigma
+    GaussMethod method; ///< Method chosen (never GAUSS_AUTO after prepared)
+    int radius; ///< Direct kernel radius and FFT padding
+    int fft_width, fft_height; ///< FFT (padded image) width and height
+    dvector<float> d_img; ///< Output image in device memory
+    dvector<float> d_tmp; ///< Intermediate (rows or padded) image
+    dvector<float> d_kernel; ///< Direct kernel (2*radius+1 weights)
+    dvector<float2> d_hat; ///< Spectrum of the padded image
+    alg6_clamp_plan<3> rec; ///< Recursive filter plan (if recursive)
+
+    /// Default constructor
+    gauss_plan() : width(0), height(0), sigma(0.f), method(GAUSS_AUTO),
+                   radius(0), fft_width(0), fft_height(0) { }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    gauss_plan( const gauss_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    gauss_plan& operator = ( const gauss_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Name of a Gaussian blur method
+ *  @param[in] m The method
+ *  @return The method name
+ */
+inline const char *gauss_method_name( GaussMethod m ) {
+    return m == GAUSS_DIRECT ? "direct" : m == GAUSS_FFT ? "fft"
+        : m == GAUSS_RECURSIVE ? "recursive" : "auto";
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Radius of the direct Gaussian kernel of a sigma
+ *  @param[in] sigma Gaussian sigma
+ *  @return Radius of four sigma (at least one)
+ */
+inline int gauss_radius( float sigma ) {
+    return std::max(1, (int)std::ceil(4.f*sigma));
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Sigma class of a Gaussian blur
+ *
+ *  Each class holds sigmas of up to a half octave more than the
+ *  previous class, from 0.5 (class zero), e.g. class 8 is from 8 up
+ *  to 11.3.
+ *
+ *  @param[in] sigma Gaussian sigma
+ *  @return The sigma class
+ */
+inline int sigma_class( float sigma ) {
+    return std::max(0, (int)std::floor(2.f*std::log(sigma/.5f)/std::log(2.f)));
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Smallest FFT size (of factors 2, 3, 5 and 7) holding a length
+ *  @param[in] n The length
+ *  @return The FFT size (fast in cuFFT)
+ */
+inline int fft_size( int n ) {
+    static const int primes[4] = { 2, 3, 5, 7 };
+    for (;; ++n) {
+        int m = n;
+        for (int i = 0; i < 4; ++i)
+            while (m % primes[i] == 0) m /= primes[i];
+        if (m == 1) return n;
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Name of the Gaussian calibration file
+ *
+ *  The file is given by the GPUFILTER_GAUSS environment variable,
+ *  otherwise it is gpufilter.gauss in the working directory.
+ *
+ *  @return The Gaussian calibration file name
+ */
+inline std::string gauss_file() {
+    const char *f = getenv("GPUFILTER_GAUSS");
+    return f ? f : "gpufilter.gauss";
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Key of one calibration (architecture, size class and sigma class)
+ *  @param[in] arch Compute capability (see tune_arch())
+ *  @param[in] sclass Size class (see size_class())
+ *  @param[in] gclass Sigma class (see sigma_class())
+ *  @return The calibration key
+ */
+inline long gauss_key( int arch, int sclass, int gclass ) {
+    return ((long)arch*64 + sclass)*64 + gclass;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Table of all calibrations, loaded once from the calibration file
+ *
+ *  Each line of the file is one calibration: architecture, size
+ *  class, sigma class, then run time and maximum error of the
+ *  direct, FFT and recursive methods.
+ *
+ *  @return Reference to the calibration table
+ */
+inline std::map<long, gauss_calib>& gauss_table() {
+    static std::map<long, gauss_calib> table;
+    static bool loaded = false;
+    if (!loaded) {
+        loaded = true;
+        std::ifstream in(gauss_file().c_str());
+        int arch, sclass, gclass;
+        gauss_calib c;
+        while (in >> arch >> sclass >> gclass
+               >> c.time[0] >> c.error[0] >> c.time[1] >> c.error[1]
+               >> c.time[2] >> c.error[2])
+            table[gauss_key(arch, sclass, gclass)] = c;
+    }
+    return table;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Save a calibration to the Gaussian calibration file
+ *
+ *  The calibration replaces any previous one of the same key and the
+ *  whole table is written back to the file.
+ *
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] c The calibration
+ *  @return True if the file was written
+ */
+inline bool save_gauss_calib( int width, int height, float sigma,
+                              const gauss_calib& c ) {
+    static int arch = tune_arch();
+    long blocks = (long)((width+WS-1)/WS)*((height+WS-1)/WS);
+    std::map<long, gauss_calib>& table = gauss_table();
+    table[gauss_key(arch, size_class(blocks), sigma_class(sigma))] = c;
+    std::ofstream out(gauss_file().c_str());
+    for (std::map<long, gauss_calib>::const_iterator it = table.begin();
+         it != table.end(); ++it) {
+        long k = it->first;
+        out << k/(64*64) << " " << (k/64)%64 << " " << k%64;
+        for (int i = 0; i < 3; ++i)
+            out << " " << it->second.time[i] << " " << it->second.error[i];
+        out << "\n";
+    }
+    return !out.fail();
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Choose the fastest exact-enough Gaussian blur method
+ *
+ *  With a calibration of the current device for the image size and
+ *  sigma classes (see calibrate_gauss()), the fastest method with
+ *  error up to the tolerance is chosen (or the most accurate if none
+ *  is).  Otherwise, the direct method is chosen for small radii (up
+ *  to GAUSS_DIR_RADIUS), the recursive method if its typical error
+ *  (GAUSS_REC_ERROR) is tolerated, and the FFT method if not.
+ *
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] tol Tolerance of the maximum error
+ *  @return The method chosen
+ */
+inline GaussMethod choose_gauss( int width, int height, float sigma,
+                                 float tol=GAUSS_TOL ) {
+    static int arch = tune_arch();
+    long blocks = (long)((width+WS-1)/WS)*((height+WS-1)/WS);
+    std::map<long, gauss_calib>& table = gauss_table();
+    std::map<long, gauss_calib>::const_iterator it =
+        table.find(gauss_key(arch, size_class(blocks), sigma_class(sigma)));
+    if (it == table.end()) {
+        if (gauss_radius(sigma) <= GAUSS_DIR_RADIUS) return GAUSS_DIRECT;
+        return GAUSS_REC_ERROR <= tol ? GAUSS_RECURSIVE : GAUSS_FFT;
+    }
+    const gauss_calib& c = it->second;
+    int best = -1, exact = 0;
+    for (int i = 0; i < 3; ++i) {
+        if (c.error[i] <= tol && (best < 0 || c.time[i] < c.time[best]))
+            best = i;
+        if (c.error[i] < c.error[exact])
+            exact = i;
+    }
+    return (GaussMethod)((best < 0 ? exact : best) + 1);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Table of the cuFFT plans created, one per FFT size
+ *  @return Reference to the cuFFT plans table
+ */
+inline std::map< std::pair<int,int>, fft_plans >& fft_plan_cache() {
+    static std::map< std::pair<int,int>, fft_plans > cache;
+    return cache;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Find the cuFFT plans of a size, creating them on first use
+ *
+ *  Creating cuFFT plans is much slower than running them, thus the
+ *  plans of each size are created once and kept (see
+ *  clear_fft_plans()), shared by all Gaussian plans of that size.
+ *
+ *  @param[in] fft_width FFT width (real values)
+ *  @param[in] fft_height FFT height
+ *  @return The forward and inverse plans
+ */
+inline const fft_plans& find_fft_plans( int fft_width, int fft_height ) {
+    std::map< std::pair<int,int>, fft_plans >& cache = fft_plan_cache();
+    std::pair<int,int> key(fft_width, fft_height);
+    std::map< std::pair<int,int>, fft_plans >::iterator it = cache.find(key);
+    if (it != cache.end())
+        return it->second;
+    fft_plans p;
+    if (cufftPlan2d(&p.fwd, fft_height, fft_width, CUFFT_R2C) != CUFFT_SUCCESS)
+        throw std::runtime_error("Error creating the forward FFT plan");
+    if (cufftPlan2d(&p.inv, fft_height, fft_width, CUFFT_C2R) != CUFFT_SUCCESS) {
+        cufftDestroy(p.fwd);
+        throw std::runtime_error("Error creating the inverse FFT plan");
+    }
+    return cache[key] = p;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Destroy all cuFFT plans created (releasing their work areas)
+ */
+inline void clear_fft_plans() {
+    std::map< std::pair<int,int>, fft_plans >& cache = fft_plan_cache();
+    for (std::map< std::pair<int,int>, fft_plans >::iterator it = cache.begin();
+         it != cache.end(); ++it) {
+        cufftDestroy(it->second.fwd);
+        cufftDestroy(it->second.inv);
+    }
+    cache.clear();
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Direct Gaussian convolution of rows (clamp to edge)
+ *  @param[out] g_out The output image
+ *  @param[in] g_in The input image
+ *  @param[in] g_kernel The kernel (2*radius+1 weights)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] radius Kernel radius
+ */
+__global__ __launch_bounds__(WS*NWG)
+void gauss_dir_rows( float *g_out,
+                     const float *g_in,
+                     const float *g_kernel,
+                     int width, int height, int radius ) {
+    int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWG+threadIdx.y;
+    if (x >= width || y >= height) return;
+    g_in += y*width;
+    float s = 0.f;
+    for (int k = -radius; k <= radius; ++k)
+        s += __ldg(&g_in[min(max(x+k, 0), width-1)]) * __ldg(&g_kernel[k+radius]);
+    g_out[y*width+x] = s;
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Direct Gaussian convolution of columns (clamp to edge)
+ *  @param[out] g_out The output image
+ *  @param[in] g_in The input image
+ *  @param[in] g_kernel The kernel (2*radius+1 weights)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] radius Kernel radius
+ */
+__global__ __launch_bounds__(WS*NWG)
+void gauss_dir_cols( float *g_out,
+                     const float *g_in,
+                     const float *g_kernel,
+                     int width, int height, int radius ) {
+    int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWG+threadIdx.y;
+    if (x >= width || y >= height) return;
+    g_in += x;
+    float s = 0.f;
+    for (int k = -radius; k <= radius; ++k)
+        s += __ldg(&g_in[min(max(y+k, 0), height-1)*width]) * __ldg(&g_kernel[k+radius]);
+    g_out[y*width+x] = s;
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Pad an image for the FFT (clamp to edge)
+ *
+ *  The image is placed at (pad, pad) of the FFT image and extended
+ *  up to its right and bottom edges, the FFT wraps around the image
+ *  at least pad pixels away on each side.
+ *
+ *  @param[out] g_out The FFT (padded) image
+ *  @param[in] g_in The input image
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] fft_width FFT width
+ *  @param[in] fft_height FFT height
+ *  @param[in] pad Padding before the image (in both directions)
+ */
+__global__ __launch_bounds__(WS*NWG)
+void gauss_fft_pad( float *g_out,
+                    const float *g_in,
+                    int width, int height,
+                    int fft_width, int fft_height, int pad ) {
+    int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWG+threadIdx.y;
+    if (x >= fft_width || y >= fft_height) return;
+    g_out[y*fft_width+x] = __ldg(&g_in[min(max(y-pad, 0), height-1)*width
+                                       + min(max(x-pad, 0), width-1)]);
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Multiply the spectrum of the padded image by the Gaussian one
+ *
+ *  The Gaussian spectrum is sampled at the FFT frequencies, and the
+ *  FFT scale (one over the number of values) is folded in.
+ *
+ *  @param[in,out] g_hat The spectrum (fft_width/2+1 by fft_height values)
+ *  @param[in] fft_width FFT width
+ *  @param[in] fft_height FFT height
+ *  @param[in] cte The Gaussian spectrum constant (two pi squared sigma squared)
+ */
+__global__ __launch_bounds__(WS*NWG)
+void gauss_fft_hat( float2 *g_hat,
+                    int fft_width, int fft_height, float cte ) {
+    int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWG+threadIdx.y,
+        hat_width = fft_width/2+1;
+    if (x >= hat_width || y >= fft_height) return;
+    float fx = x/(float)fft_width,
+        fy = (y <= fft_height/2 ? y : y-fft_height)/(float)fft_height,
+        g = expf(-cte*(fx*fx + fy*fy)) / ((float)fft_width*fft_height);
+    float2 v = g_hat[y*hat_width+x];
+    v.x *= g;
+    v.y *= g;
+    g_hat[y*hat_width+x] = v;
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Crop the image back from the FFT (padded) image
+ *  @param[out] g_out The output image
+ *  @param[in] g_in The FFT (padded) image
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] fft_width FFT width
+ *  @param[in] pad Padding before the image (in both directions)
+ */
+__global__ __launch_bounds__(WS*NWG)
+void gauss_fft_crop( float *g_out,
+                     const float *g_in,
+                     int width, int height,
+                     int fft_width, int pad ) {
+    int x = blockIdx.x*WS+threadIdx.x, y = blockIdx.y*NWG+threadIdx.y;
+    if (x >= width || y >= height) return;
+    g_out[y*width+x] = g_in[(y+pad)*fft_width+x+pad];
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare a Gaussian blur plan in the GPU
+ *
+ *  The method is chosen once for the image size and sigma (see
+ *  choose_gauss()) unless given, and only its buffers (and plans)
+ *  are allocated.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] method Method to compute the blur (or GAUSS_AUTO)
+ *  @param[in] tol Tolerance of the maximum error (with GAUSS_AUTO)
+ */
+inline void prepare_gauss( gauss_plan& plan,
+                           int width, int height, float sigma,
+                           GaussMethod method=GAUSS_AUTO,
+                           float tol=GAUSS_TOL ) {
+
+    plan.width = width;
+    plan.height = height;
+    plan.sigma = sigma;
+    plan.method = method == GAUSS_AUTO ? choose_gauss(width, height, sigma, tol) : method;
+    plan.radius = gauss_radius(sigma);
+    plan.d_img.resize(width*height);
+
+    if (plan.method == GAUSS_DIRECT) {
+
+        std::vector<float> kernel(2*plan.radius+1);
+        float sum = 0.f;
+        for (int k = -plan.radius; k <= plan.radius; ++k)
+            sum += kernel[k+plan.radius] = std::exp(-.5f*k*k/(sigma*sigma));
+        for (size_t k = 0; k < kernel.size(); ++k)
+            kernel[k] /= sum;
+        plan.d_kernel = kernel;
+        plan.d_tmp.resize(width*height);
+
+    } else if (plan.method == GAUSS_FFT) {
+
+        plan.fft_width = fft_size(width + 2*plan.radius);
+        plan.fft_height = fft_size(height + 2*plan.radius);
+        plan.d_tmp.resize(plan.fft_width*plan.fft_height);
+        plan.d_hat.resize((plan.fft_width/2+1)*plan.fft_height);
+        find_fft_plans(plan.fft_width, plan.fft_height);
+
+    } else {
+
+        Vector<float, 4> w;
+        weights(sigma, w);
+        prepare_alg6_clamp(plan.rec, width, height, w);
+
+    }
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run a Gaussian blur plan in the GPU
+ *  @param[in,out] plan The plan to run (with the output image)
+ *  @param[in] d_in The input image in device memory
+ */
+inline void gauss_gpu( gauss_plan& plan,
+                       const dvector<float>& d_in ) {
+
+    const int width = plan.width, height = plan.height;
+    dim3 block(WS, NWG), grid((width+WS-1)/WS, (height+NWG-1)/NWG);
+
+    if (plan.method == GAUSS_DIRECT) {
+
+        gauss_dir_rows<<< grid, block >>>( &plan.d_tmp, &d_in, &plan.d_kernel,
+                                           width, height, plan.radius );
+        gauss_dir_cols<<< grid, block >>>( &plan.d_img, &plan.d_tmp, &plan.d_kernel,
+                                           width, height, plan.radius );
+
+    } else if (plan.method == GAUSS_FFT) {
+
+        const int fw = plan.fft_width, fh = plan.fft_height;
+        const fft_plans& p = find_fft_plans(fw, fh);
+        const float pi = 3.14159265358979f, cte = 2.f*pi*pi*plan.sigma*plan.sigma;
+
+        gauss_fft_pad<<< dim3((fw+WS-1)/WS, (fh+NWG-1)/NWG), block >>>
+            ( &plan.d_tmp, &d_in, width, height, fw, fh, plan.radius );
+        cufftExecR2C(p.fwd, &plan.d_tmp, (cufftComplex *)&plan.d_hat);
+        gauss_fft_hat<<< dim3((fw/2+1+WS-1)/WS, (fh+NWG-1)/NWG), block >>>
+            ( &plan.d_hat, fw, fh, cte );
+        cufftExecC2R(p.inv, (cufftComplex *)&plan.d_hat, &plan.d_tmp);
+        gauss_fft_crop<<< grid, block >>>( &plan.d_img, &plan.d_tmp,
+                                           width, height, fw, plan.radius );
+
+    } else {
+
+        upload(plan.rec, d_in);
+        alg6_clamp(plan.rec);
+        download(plan.rec, plan.d_img);
+
+    }
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Calibrate the Gaussian blur methods on an image size and sigma
+ *
+ *  Each method runs on a random image, its run time is the average
+ *  of the runs and its maximum error is against the direct method
+ *  (of radius four sigma).  The calibration is saved (see
+ *  save_gauss_calib()) for choose_gauss().
+ *
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] runs Number of runs measured (after one warmup run)
+ *  @return The calibration
+ */
+inline gauss_calib calibrate_gauss( int width, int height, float sigma,
+                                    int runs=10 ) {
+
+    std::vector<float> h_in(width*height), h_ref(width*height), h_out(width*height);
+    srand(1234);
+    for (int i = 0; i < width*height; ++i)
+        h_in[i] = rand() / (float)RAND_MAX;
+    dvector<float> d_in(h_in);
+
+    gauss_calib c;
+
+    for (int m = GAUSS_DIRECT; m <= GAUSS_RECURSIVE; ++m) {
+
+        gauss_plan plan;
+        prepare_gauss(plan, width, height, sigma, (GaussMethod)m);
+
+        gauss_gpu(plan, d_in); // warmup (and cuFFT plans)
+
+        gpu_timer timer(0, "", false);
+        timer.start();
+        for (int r = 0; r < runs; ++r)
+            gauss_gpu(plan, d_in);
+        timer.stop();
+
+        c.time[m-1] = timer.elapsed()/runs;
+
+        cudaMemcpy(m == GAUSS_DIRECT ? &h_ref[0] : &h_out[0], &plan.d_img,
+                   width*height*sizeof(float), cudaMemcpyDeviceToHost);
+
+        float me = 0.f, mre = 0.f;
+        if (m != GAUSS_DIRECT)
+            check_cpu_reference(&h_ref[0], &h_out[0], width*height, me, mre);
+        c.error[m-1] = me;
+
+    }
+
+    save_gauss_calib(width, height, sigma, c);
+
+    return c;
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the Gaussian blur in the GPU
+ *  @param[in,out] h_img The in(out)put 2D image to blur in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] sigma Gaussian sigma
+ *  @param[in] method Method to compute the blur (or GAUSS_AUTO)
+ *  @param[in] tol Tolerance of the maximum error (with GAUSS_AUTO)
+ */
+inline void gauss_gpu( float *h_img,
+                       int width, int height, int runtimes,
+                       float sigma,
+                       GaussMethod method=GAUSS_AUTO,
+                       float tol=GAUSS_TOL ) {
+
+    gauss_plan plan;
+    prepare_gauss(plan, width, height, sigma, method, tol);
+
+    dvector<float> d_in(h_img, width*height);
+
+    base_timer &timer_total = timers.gpu_add("gauss_gpu", width*height, "iP");
+
+    for (int r = 0; r < runtimes; ++r)
+        gauss_gpu(plan, d_in);
+
+    timer_total.stop();
+
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+
+    cudaMemcpy(h_img, &plan.d_img, width*height*sizeof(float),
+               cudaMemcpyDeviceToHost);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GAUSS_GPU_CUH
+//==============================================================================
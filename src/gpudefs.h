@@ -9,6 +9,10 @@
 #ifndef GPUDEFS_H
 #define GPUDEFS_H
 
+//== INCLUDES ==================================================================
+
+#include <cuda_fp16.h>
+
 //== GLOBAL-SCOPE DEFINITIONS ==================================================
 
 #define WS 32 ///< Warp size (defines b x b block size where b = WS)
@@ -27,9 +31,16 @@ def sm(nb, r, nc):
 #define NWARC 4 ///< # of warps adjusting carries rows+cols
 #define NBA 8 ///< # of blocks adjusting carries
 #define NBARC 16 ///< # of blocks adjusting carries rows+cols
+#define LBC 8 ///< # of carries per tile adjusting carries with look-back
+#define SKA 16 ///< Aspect ratio (in blocks) of skinny images adjusted with look-back
 #define NWC 5 ///< # of warps collect carries
 #define NWW 5 ///< # of warps write results
 #define NBCW 11 ///< # of blocks collect carries / write results
+#define NBW(W) ((NBCW*NWC)/(W)) ///< # of blocks collect carries / write results with W warps
+#define NWD 4 ///< # of warps filtering depth (one row of pixels each)
+#define NW1 4 ///< # of warps filtering 1D signals (32 blocks of 32 samples each)
+#define NRB 4 ///< # of rows of threads reading blocks larger than WS (see alg6b_gpu())
+#define TPT(W) ((WS+(W)-1)/(W)) ///< # of texels per thread reading with W warps
 
 //== NAMESPACES ================================================================
 
@@ -39,38 +50,227 @@ namespace gpufilter {
 
 // basics
 __constant__ int c_border;
-__constant__ Vector<float,ORDER+1> c_weights;
 
-// alg3 and alg4
-__constant__ Matrix<float,ORDER,ORDER> c_AbF_T, c_AbR_T, c_HARB_AFP_T;
+/**
+ *  @struct filter_constants gpudefs.h
+ *  @ingroup gpu
+ *  @brief Constants (weights and matrices) of one filter order
+ *
+ *  Each filter order has its own bank of constants in the GPU, thus
+ *  all orders can be compiled side by side and chosen at run time.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct filter_constants {
+    // basics
+    Vector<float,R+1> weights;
+    // alg3 and alg4
+    Matrix<float,R,R> AbF_T, AbR_T, HARB_AFP_T;
+    // alg5
+    Matrix<float,R,WS> ARE_T, ARB_AFP_T, TAFB, HARB_AFB;
+    // sat
+    Matrix<float,R,WS> AFP_T;
+};
+
+/**
+ *  @struct constant_bank gpudefs.h
+ *  @ingroup gpu
+ *  @brief Access to the constants bank of one filter order
+ *  @tparam R Filter order
+ */
+template <int R>
+struct constant_bank;
+
+#define CONSTANT_BANK(r)                                                \
+    __constant__ filter_constants<r> c_constants##r;                    \
+    template <> struct constant_bank<r> {                               \
+        __device__ static const filter_constants<r>& get() {            \
+            return c_constants##r; }                                    \
+        static const filter_constants<r>& symbol() {                    \
+            return c_constants##r; }                                    \
+    };
+
+CONSTANT_BANK(1)
+CONSTANT_BANK(2)
+CONSTANT_BANK(3)
+CONSTANT_BANK(4)
+CONSTANT_BANK(5)
 
-// alg5
-__constant__ Matrix<float,ORDER,WS> c_ARE_T, c_ARB_AFP_T, c_TAFB, c_HARB_AFB;
+#undef CONSTANT_BANK
 
-// sat
-__constant__ Matrix<float,ORDER,WS> c_AFP_T;
+/**
+ *  @struct carry_traits gpudefs.h
+ *  @ingroup gpu
+ *  @brief Arithmetic type of the carries stored in a carry type
+ *
+ *  Carries are stored in the carry type and adjusted (steps 2 to 4)
+ *  in its arithmetic type, the same for float and double carries and
+ *  single precision for compact (half) carries, thus only the carry
+ *  memory traffic is halved.
+ *
+ *  @tparam T Carry type (float, double or half)
+ */
+template <class T>
+struct carry_traits {
+    typedef T compute; ///< Arithmetic type of the carries
+};
 
-// clamp
-__constant__ Matrix<float,ORDER,ORDER> c_AbarFIArF_T, c_ArFSRRF_T,
-    c_AbarFIArFAbarRIArRArFSRRF_T;
+template <>
+struct carry_traits<__half> {
+    typedef float compute;
+};
 
-// repeat
-__constant__ Matrix<float,ORDER,ORDER> c_IAwF_T, c_IAwR_T, c_IAhF_T, c_IAhR_T;
+/**
+ *  @struct filter_params gpudefs.h
+ *  @ingroup gpu
+ *  @brief Per-plan filter parameters passed by value to kernels
+ *
+ *  Kernel parameters are copied with each launch, thus plans with
+ *  different weights (even of the same order) can run concurrently
+ *  on different streams, as opposed to the constants banks.  Only the
+ *  weights, the small r x r carry adjusting matrices and the border
+ *  (plus the weights of columns and the filtered axes used by the
+ *  block steps) go this way, the r x b carry fixing matrices are kept in global
+ *  memory by each plan.
+ *
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float, double or half, see carry_traits)
+ */
+template <int R, class T=float>
+struct filter_params {
+    Vector<float,R+1> weights;
+    Matrix<T,R,R> AbF_T, AbR_T, HARB_AFP_T;
+    int border;
+    Vector<float,R+1> weights_cols; ///< Weights of columns (see prepare_axes())
+    int axes; ///< Filtered axes (see FilterAxes)
+};
 
-// reflect
-__constant__ Matrix<float,ORDER,ORDER>
-    c_IArFVAbarFV_T, c_IArFVAbarFVAwF_T, c_IArFVAbarFVAhF_T,
-    c_HARwAFPIArFVAbarFVAwFAwR_T,
-    c_HARhAFPIArFVAbarFVAhFAhR_T,
-    c_IArFVAbarFVAwRHARwAFPIArFVAbarFVAwFAwR_T,
-    c_IArFVAbarFVAhRHARhAFPIArFVAbarFVAhFAhR_T;
+/**
+ *  @struct filter_params gpudefs.h
+ *  @ingroup gpu
+ *  @brief Filter parameters of compact (half) carries (in single precision)
+ *  @tparam R Filter order
+ */
+template <int R>
+struct filter_params<R,__half> : public filter_params<R,float> {
+    /// Default constructor
+    filter_params() { }
+    /// Constructor from the single-precision parameters
+    filter_params( const filter_params<R,float>& p ) : filter_params<R,float>(p) { }
+};
 
-texture<float, cudaTextureType2D, cudaReadModeElementType> t_in;
+/**
+ *  @struct border_params gpudefs.h
+ *  @ingroup gpu
+ *  @brief Per-plan carry matrices of the exact boundaries passed by value to kernels
+ *
+ *  The clamp, repeat and reflect variants of algorithm 6 (and their
+ *  mix per axis, see alg6_axes()) pass these r x r matrices along
+ *  with the filter_params to their carry adjusting kernels, as
+ *  opposed to the constants banks, thus plans of these variants run
+ *  concurrently as well.
+ *
+ *  @tparam R Filter order
+ */
+template <int R>
+struct border_params {
+    // clamp
+    Matrix<float,R,R> AbarFIArF_T, ArFSRRF_T, AbarFIArFAbarRIArRArFSRRF_T;
+    // repeat
+    Matrix<float,R,R> IAwF_T, IAwR_T, IAhF_T, IAhR_T;
+    // reflect
+    Matrix<float,R,R>
+        IArFVAbarFV_T, IArFVAbarFVAwF_T, IArFVAbarFVAhF_T,
+        HARwAFPIArFVAbarFVAwFAwR_T,
+        HARhAFPIArFVAbarFVAhFAhR_T,
+        IArFVAbarFVAwRHARwAFPIArFVAbarFVAwFAwR_T,
+        IArFVAbarFVAhRHARhAFPIArFVAbarFVAhFAhR_T;
+};
 
 //== IMPLEMENTATION ============================================================
 
 // Auxiliary functions ---------------------------------------------------------
 
+__device__ __forceinline__ // store a value in single precision
+void store( float *p, const float& v ) {
+    *p = v;
+}
+
+__device__ __forceinline__ // store a value in half precision
+void store( __half *p, const float& v ) {
+    *p = __float2half(v);
+}
+
+__device__ __forceinline__ // store a normalized value quantized to 8 bits
+void store( unsigned char *p, const float& v ) {
+    *p = (unsigned char)__float2uint_rn(__saturatef(v)*255.f);
+}
+
+__device__ __forceinline__ // store a normalized value quantized to 16 bits
+void store( unsigned short *p, const float& v ) {
+    *p = (unsigned short)__float2uint_rn(__saturatef(v)*65535.f);
+}
+
+__device__ __forceinline__ // store an 8-bit value as is
+void store( unsigned char *p, const unsigned char& v ) {
+    *p = v;
+}
+
+__device__ __forceinline__ // store a 16-bit value as is
+void store( unsigned short *p, const unsigned short& v ) {
+    *p = v;
+}
+
+template <class T>
+__device__ __forceinline__ // shuffle up by k lanes within a (full) warp
+T shfl_up( const T& v, const unsigned int& k ) {
+#if CUDART_VERSION >= 9000
+    return __shfl_up_sync(0xffffffff, v, k);
+#else
+    return __shfl_up(v, k);
+#endif
+}
+
+template <class T>
+__device__ __forceinline__ // shuffle from one lane within a (full) warp
+T shfl( const T& v, const int& lane ) {
+#if CUDART_VERSION >= 9000
+    return __shfl_sync(0xffffffff, v, lane);
+#else
+    return __shfl(v, lane);
+#endif
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Constants of a filter order in the GPU
+ *  @return Constants bank of the given order
+ *  @tparam R Filter order
+ */
+template <int R>
+__device__ __forceinline__
+const filter_constants<R>& consts() {
+    return constant_bank<R>::get();
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Copy a value to one member of the constants of a filter order
+ *  @param[in] member Member of the constants to copy to
+ *  @param[in] value Value to copy
+ *  @tparam R Filter order
+ *  @tparam T Member type
+ */
+template <int R, class T>
+void copy_to_constants( T filter_constants<R>::*member,
+                        const T& value ) {
+    const filter_constants<R>& bank = constant_bank<R>::symbol();
+    size_t offset = (const char *)&(bank.*member) - (const char *)&bank;
+    cudaMemcpyToSymbol(bank, &value, sizeof(T), offset);
+    check_cuda_error("Error copying constants to device");
+}
+
 template <class T, int R>
 HOSTDEV
 T fwdI( Vector<T,R> &p,
@@ -100,8 +300,9 @@ T revI( T x,
 }
 
 template <int W, int V>
-__device__
+__device__ // read block of image from (non-layered) input texture object
 void read_block( Matrix<float,WS,V>& block,
+                 cudaTextureObject_t tex,
                  const int& m, const int& n,
                  const float& inv_width,
                  const float& inv_height ) {
@@ -111,13 +312,177 @@ void read_block( Matrix<float,WS,V>& block,
     float (*bdata)[V] = (float (*)[V]) &block[ty][tx];
 #pragma unroll
     for (int i=0; i<WS-(WS%W); i+=W) {
-        **bdata = tex2D(t_in, tu, tv);
+        **bdata = tex2D<float>(tex, tu, tv);
+        bdata += W;
+        tv += W*inv_height;
+    }
+    if (ty < WS%W) {
+        **bdata = tex2D<float>(tex, tu, tv);
+    }
+}
+
+template <int W, int V>
+__device__ // read block of image (layer) l from layered input texture object
+void read_block( Matrix<float,WS,V>& block,
+                 cudaTextureObject_t tex,
+                 const int& m, const int& n, const int& l,
+                 const float& inv_width,
+                 const float& inv_height ) {
+    int tx = threadIdx.x, ty = threadIdx.y;
+    float tu = (m*WS+tx+.5f)*inv_width,
+          tv = (n*WS+ty+.5f)*inv_height;
+    float (*bdata)[V] = (float (*)[V]) &block[ty][tx];
+#pragma unroll
+    for (int i=0; i<WS-(WS%W); i+=W) {
+        **bdata = tex2DLayered<float>(tex, tu, tv, l);
         bdata += W;
         tv += W*inv_height;
     }
     if (ty < WS%W) {
-        **bdata = tex2D(t_in, tu, tv);
+        **bdata = tex2DLayered<float>(tex, tu, tv, l);
+    }
+}
+
+/**
+ *  @struct fetch_texel gpudefs.h
+ *  @ingroup gpu
+ *  @brief Fetch all channels of one texel of a multi-channel input
+ *
+ *  One channel is read from a float texture object, two channels
+ *  from a float2 one, three and four channels from a float4 one
+ *  (three channels padded to four).
+ *
+ *  @tparam C Number of channels (1 to 4)
+ */
+template <int C>
+struct fetch_texel;
+
+template <>
+struct fetch_texel<1> {
+    __device__ static void get( float *v, cudaTextureObject_t tex,
+                                float tu, float tv, int l ) {
+        v[0] = tex2DLayered<float>(tex, tu, tv, l);
+    }
+};
+
+template <>
+struct fetch_texel<2> {
+    __device__ static void get( float *v, cudaTextureObject_t tex,
+                                float tu, float tv, int l ) {
+        float2 t = tex2DLayered<float2>(tex, tu, tv, l);
+        v[0] = t.x; v[1] = t.y;
     }
+};
+
+template <>
+struct fetch_texel<3> {
+    __device__ static void get( float *v, cudaTextureObject_t tex,
+                                float tu, float tv, int l ) {
+        float4 t = tex2DLayered<float4>(tex, tu, tv, l);
+        v[0] = t.x; v[1] = t.y; v[2] = t.z;
+    }
+};
+
+template <>
+struct fetch_texel<4> {
+    __device__ static void get( float *v, cudaTextureObject_t tex,
+                                float tu, float tv, int l ) {
+        float4 t = tex2DLayered<float4>(tex, tu, tv, l);
+        v[0] = t.x; v[1] = t.y; v[2] = t.z; v[3] = t.w;
+    }
+};
+
+template <int W, int C>
+__device__ // read all C channels of block of image (layer) l into registers
+void read_texels( float *texels,
+                  cudaTextureObject_t tex,
+                  const int& m, const int& n, const int& l,
+                  const float& inv_width,
+                  const float& inv_height ) {
+    int tx = threadIdx.x, ty = threadIdx.y;
+    float tu = (m*WS+tx+.5f)*inv_width,
+          tv = (n*WS+ty+.5f)*inv_height;
+#pragma unroll
+    for (int i=0; i<TPT(W); ++i) {
+        if (i*W+ty < WS)
+            fetch_texel<C>::get(texels+i*C, tex, tu, tv, l);
+        tv += W*inv_height;
+    }
+}
+
+/**
+ *  @struct linear_input gpudefs.h
+ *  @ingroup gpu
+ *  @brief Input image read in place from linear memory instead of the texture
+ *
+ *  Only reads inside the image or past its right and bottom edges
+ *  (zero or the edge pixel) are needed, as in-place plans have no
+ *  border blocks (see prepare_inplace()).
+ */
+struct linear_input {
+    const float *ptr; ///< Input images (interleaved channels), zero reads the texture
+    int width, height; ///< Image width and height
+    int stride; ///< Image stride (in pixels)
+    int size; ///< Image size (in floats) in batch
+    bool zero; ///< Flag to read zero outside the image (instead of the edge pixel)
+};
+
+template <int C>
+__device__ // load all C channels of pixel (x,y) of image l from linear memory
+void load_texel( float *v,
+                 const linear_input& in,
+                 int x, int y, int l ) {
+    if (in.zero && (x >= in.width || y >= in.height)) {
+#pragma unroll
+        for (int c=0; c<C; ++c)
+            v[c] = 0.f;
+        return;
+    }
+    const float *p = in.ptr + l*in.size
+        + (min(y, in.height-1)*in.stride + min(x, in.width-1))*C;
+#pragma unroll
+    for (int c=0; c<C; ++c)
+#ifdef LDG
+        v[c] = __ldg(p+c);
+#else
+        v[c] = p[c];
+#endif
+}
+
+template <int W, int V>
+__device__ // read block of image l from linear memory (see linear_input)
+void read_block( Matrix<float,WS,V>& block,
+                 const linear_input& in,
+                 const int& m, const int& n, const int& l ) {
+    int tx = threadIdx.x, ty = threadIdx.y;
+#pragma unroll
+    for (int i=0; i<TPT(W); ++i)
+        if (i*W+ty < WS)
+            load_texel<1>(&block[i*W+ty][tx], in, m*WS+tx, n*WS+i*W+ty, l);
+}
+
+template <int W, int C>
+__device__ // read all C channels of block of image l from linear memory into registers
+void read_texels( float *texels,
+                  const linear_input& in,
+                  const int& m, const int& n, const int& l ) {
+    int tx = threadIdx.x, ty = threadIdx.y;
+#pragma unroll
+    for (int i=0; i<TPT(W); ++i)
+        if (i*W+ty < WS)
+            load_texel<C>(texels+i*C, in, m*WS+tx, n*WS+i*W+ty, l);
+}
+
+template <int W, int C, int V>
+__device__ // fill block with one channel c of the texels read
+void fill_block( Matrix<float,WS,V>& block,
+                 const float *texels,
+                 const int& c ) {
+    int tx = threadIdx.x, ty = threadIdx.y;
+#pragma unroll
+    for (int i=0; i<TPT(W); ++i)
+        if (i*W+ty < WS)
+            block[i*W+ty][tx] = texels[i*C+c];
 }
 
 template <class T, int R>
@@ -210,8 +575,8 @@ void mad( Matrix<T,R,WS> &r,
 template <class T, int R>
 __device__ // fix Pt or Et giving P or E and fixing matrices a and b
 void fixpet( Vector<T,R>& pet,
-             const Matrix<float,R,WS>& a,
-             const Matrix<float,R,WS>& b,
+             const Matrix<T,R,WS>& a,
+             const Matrix<T,R,WS>& b,
              const Vector<T,R>& pe ) {
     int tx = threadIdx.x; // one-warp computing (ty==0)
     // pt||et += B_T * ( p||e * A_T )
@@ -219,14 +584,14 @@ void fixpet( Vector<T,R>& pet,
     for (int i = 0; i < R; ++i) {
 #pragma unroll // computing corner rows south||north west||east
         for (int j = 0; j < R; ++j) {
-            float v = a[i][tx] * pe[j];
+            T v = a[i][tx] * pe[j];
 #pragma unroll // recursive doubling by shuffle
             for (int k = 1; k < WS; k *= 2) {
-                float p = __shfl_up(v, k);
+                T p = shfl_up(v, k);
                 if (tx >= k)
                     v += p;
             }
-            pet[i] += b[j][tx] * __shfl(v, WS-1);
+            pet[i] += b[j][tx] * shfl(v, WS-1);
         }
     }
 }
@@ -234,8 +599,8 @@ void fixpet( Vector<T,R>& pet,
 template <class T, int R>
 __device__ // fix Pt or Et giving P or E and fixing matrices a and b
 void fixpet( Vector<T,R>& pet,
-             const Vector<float,R>& a,
-             const Vector<float,R>& b,
+             const Vector<T,R>& a,
+             const Vector<T,R>& b,
              const Vector<T,R>& pe ) {
     int tx = threadIdx.x; // one-warp computing (ty==0)
     // pt||et += B_T * ( p||e * A_T )
@@ -243,14 +608,14 @@ void fixpet( Vector<T,R>& pet,
     for (int i = 0; i < R; ++i) {
 #pragma unroll // computing corner rows south||north west||east
         for (int j = 0; j < R; ++j) {
-            float v = a[i] * pe[j];
+            T v = a[i] * pe[j];
 #pragma unroll // recursive doubling by shuffle
             for (int k = 1; k < WS; k *= 2) {
-                float p = __shfl_up(v, k);
+                T p = shfl_up(v, k);
                 if (tx >= k)
                     v += p;
             }
-            pet[i] += b[j] * __shfl(v, WS-1);
+            pet[i] += b[j] * shfl(v, WS-1);
         }
     }
 }
@@ -0,0 +1,186 @@
+/**
+ *  @file gpufilter.cu
+ *  @brief GPU recursive filtering library with run-time filter order
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+#include <vector>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+#include <util/recfilter.h>
+#include <util/image.h>
+
+#include "gpudefs.h"
+#include "alg0_simd_cpu.h"
+#include "alg3_gpu.cuh"
+#include "alg4_gpu.cuh"
+#include "alg5_gpu.cuh"
+#include "alg6_gpu.cuh"
+#include "alg6_clamp.cuh"
+#include "alg6_repeat.cuh"
+#include "alg6_reflect.cuh"
+#include "gpufilter.h"
+
+#define GPUFILTER_TEMPLATE template // instantiations defined in the library
+#include "gpufilter_inst.cuh"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+#ifdef LAZY_LOADING
+/**
+ *  @ingroup utils
+ *  @brief Lazy loading of the library kernels
+ *
+ *  The library carries the kernels of all algorithms, orders and
+ *  border types for all GPUFILTER_ARCHS, thus loading them all when
+ *  the CUDA context is created delays the start-up.  Before main()
+ *  (and the context), the CUDA_MODULE_LOADING environment variable
+ *  is set to LAZY (CUDA 11.7 or newer), then only the kernels
+ *  launched are loaded, at their first launch.  A value set by the
+ *  user (e.g. EAGER) is kept.
+ */
+struct lazy_loading {
+    /// Constructor setting the module loading before the context
+    lazy_loading() { setenv("CUDA_MODULE_LOADING", "LAZY", 0); }
+};
+
+static lazy_loading lazy_loading_init; ///< Lazy loading set at start-up
+#endif
+
+// Order dispatch --------------------------------------------------------------
+
+template <int R>
+void alg0_order( float *h_img,
+                 int width, int height, int runtimes,
+                 const float *w,
+                 int border,
+                 BorderType btype ) {
+    Vector<float, R+1> wr;
+    for (int i = 0; i <= R; ++i) wr[i] = w[i];
+    std::vector<float> h_in(h_img, h_img + width*height);
+    base_timer &timer_total = timers.cpu_add("alg0_simd_cpu", width*height, "iP");
+    for (int r = 0; r < runtimes; ++r) {
+        if (r > 0) // filtering is in-place, restart from the input
+            std::copy(h_in.begin(), h_in.end(), h_img);
+        alg0_simd_cpu<R>(h_img, width, height, wr, border, btype);
+    }
+    timer_total.stop();
+    if (runtimes > 1)
+        std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+    else
+        timers.flush();
+}
+
+template <int R>
+void alg5_order( float *h_img,
+                 int width, int height, int runtimes,
+                 const float *w,
+                 int border,
+                 BorderType btype ) {
+    Vector<float, R+1> wr;
+    for (int i = 0; i <= R; ++i) wr[i] = w[i];
+    if (border == 0)
+        alg5_gpu<false, R>(h_img, width, height, runtimes, wr);
+    else
+        alg5_gpu<true, R>(h_img, width, height, runtimes, wr, border, btype);
+}
+
+template <int R>
+void alg6_order( float *h_img,
+                 int width, int height, int runtimes,
+                 const float *w,
+                 int border,
+                 BorderType btype ) {
+    Vector<float, R+1> wr;
+    for (int i = 0; i <= R; ++i) wr[i] = w[i];
+    if (border == 0) {
+        if (btype == CLAMP_TO_ZERO)
+            alg6_gpu<false, R>(h_img, width, height, runtimes, wr);
+        else if (btype == CLAMP_TO_EDGE)
+            alg6_clamp<R>(h_img, width, height, runtimes, wr);
+        else if (btype == REPEAT)
+            alg6_repeat<R>(h_img, width, height, runtimes, wr);
+        else if (btype == REFLECT)
+            alg6_reflect<R>(h_img, width, height, runtimes, wr);
+    } else {
+        alg6_gpu<true, R>(h_img, width, height, runtimes, wr, border, btype);
+    }
+}
+
+// Library functions -----------------------------------------------------------
+
+void alg0( float *h_img,
+           int width, int height, int runtimes,
+           const float *w,
+           int order,
+           int border,
+           BorderType btype ) {
+    if (border < 0)
+        throw std::invalid_argument("Negative number of border blocks");
+    switch (order) {
+    case 1: alg0_order<1>(h_img, width, height, runtimes, w, border, btype); break;
+    case 2: alg0_order<2>(h_img, width, height, runtimes, w, border, btype); break;
+    case 3: alg0_order<3>(h_img, width, height, runtimes, w, border, btype); break;
+    case 4: alg0_order<4>(h_img, width, height, runtimes, w, border, btype); break;
+    case 5: alg0_order<5>(h_img, width, height, runtimes, w, border, btype); break;
+    default: throw std::invalid_argument("Filter order not compiled in library");
+    }
+}
+
+void alg5( float *h_img,
+           int width, int height, int runtimes,
+           const float *w,
+           int order,
+           int border,
+           BorderType btype ) {
+    if (border < 0)
+        throw std::invalid_argument("Negative number of border blocks");
+    switch (order) {
+    case 1: alg5_order<1>(h_img, width, height, runtimes, w, border, btype); break;
+    case 2: alg5_order<2>(h_img, width, height, runtimes, w, border, btype); break;
+    case 3: alg5_order<3>(h_img, width, height, runtimes, w, border, btype); break;
+    case 4: alg5_order<4>(h_img, width, height, runtimes, w, border, btype); break;
+    case 5: alg5_order<5>(h_img, width, height, runtimes, w, border, btype); break;
+    default: throw std::invalid_argument("Filter order not compiled in library");
+    }
+}
+
+void alg6( float *h_img,
+           int width, int height, int runtimes,
+           const float *w,
+           int order,
+           int border,
+           BorderType btype ) {
+    if (border < 0)
+        throw std::invalid_argument("Negative number of border blocks");
+    switch (order) {
+    case 1: alg6_order<1>(h_img, width, height, runtimes, w, border, btype); break;
+    case 2: alg6_order<2>(h_img, width, height, runtimes, w, border, btype); break;
+    case 3: alg6_order<3>(h_img, width, height, runtimes, w, border, btype); break;
+    case 4: alg6_order<4>(h_img, width, height, runtimes, w, border, btype); break;
+    case 5: alg6_order<5>(h_img, width, height, runtimes, w, border, btype); break;
+    default: throw std::invalid_argument("Filter order not compiled in library");
+    }
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
@@ -0,0 +1,103 @@
+/**
+ *  @file gpufilter.h
+ *  @brief GPU recursive filtering library with run-time filter order
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUFILTER_H
+#define GPUFILTER_H
+
+//== INCLUDES ==================================================================
+
+#include <util/image.h>
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== GLOBAL-SCOPE DEFINITIONS ==================================================
+
+const int max_order = 5; ///< Maximum filter order compiled in the library
+
+//== DEFINITIONS ===============================================================
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute algorithm 0 in the CPU with any filter order
+ *
+ *  Same arguments as alg5() and alg6(), thus the same job runs with
+ *  or without a GPU, on the vectorized and multithreaded CPU backend
+ *  (see alg0_simd_cpu()).  The boundary is given by the border blocks
+ *  extended by the border type, as in alg0_cpu().
+ *
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (order+1 feedforward and feedback coefficients)
+ *  @param[in] order Filter order (from 1 to max_order)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+void alg0( float *h_img,
+           int width, int height, int runtimes,
+           const float *w,
+           int order,
+           int border=0,
+           BorderType btype=CLAMP_TO_ZERO );
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 5 in the GPU with any filter order
+ *
+ *  All filter orders from 1 to max_order are compiled side by side
+ *  in the library, the order is chosen at run time.
+ *
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (order+1 feedforward and feedback coefficients)
+ *  @param[in] order Filter order (from 1 to max_order)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+void alg5( float *h_img,
+           int width, int height, int runtimes,
+           const float *w,
+           int order,
+           int border=0,
+           BorderType btype=CLAMP_TO_ZERO );
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm 6 in the GPU with any filter order
+ *
+ *  All filter orders from 1 to max_order are compiled side by side
+ *  in the library, the order is chosen at run time.  Without border
+ *  padding, the border type selects the exact boundary treatment
+ *  (clamp, repeat or reflect) of alg6.
+ *
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (order+1 feedforward and feedback coefficients)
+ *  @param[in] order Filter order (from 1 to max_order)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ */
+void alg6( float *h_img,
+           int width, int height, int runtimes,
+           const float *w,
+           int order,
+           int border=0,
+           BorderType btype=CLAMP_TO_ZERO );
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GPUFILTER_H
+//==============================================================================
@@ -0,0 +1,134 @@
+/**
+ *  @file gpufilter_c.cu
+ *  @brief C interface of GPU recursive filtering plans on external device memory
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+//== INCLUDES ==================================================================
+
+#include <string>
+#include <stdexcept>
+
+#include <util/error.h>
+#include <util/dvector.h>
+
+#include "gpudefs.h"
+#include "alg6_gpu.cuh"
+#include "gpufilter_c.h"
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct gpufilter_plan gpufilter_c.cu
+ *  @ingroup api_gpu
+ *  @brief Plan of the C interface of any filter order
+ */
+struct gpufilter_plan {
+    /// Destructor
+    virtual ~gpufilter_plan() { }
+    /// Filter images in device memory in place on a stream
+    virtual void run( float *d_img, int stride, cudaStream_t stream ) = 0;
+};
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct c_plan gpufilter_c.cu
+ *  @ingroup api_gpu
+ *  @brief Plan of the C interface of filter order R
+ *  @tparam R Filter order
+ */
+template <int R>
+struct c_plan : public gpufilter_plan {
+    alg6_plan<false,R> plan; ///< In-place algorithm 6 plan
+
+    /// Constructor preparing the plan
+    c_plan( int width, int height, int batch, int channels, const float *w ) {
+        Vector<float, R+1> wr;
+        for (int i = 0; i <= R; ++i) wr[i] = w[i];
+        prepare_alg6(plan, width, height, wr, 0, CLAMP_TO_ZERO, batch, channels);
+        prepare_inplace(plan);
+    }
+
+    /// Filter images in device memory in place on a stream
+    void run( float *d_img, int stride, cudaStream_t stream ) {
+        if (d_img != plan.d_ext || stride != plan.stride_img)
+            prepare_external(plan, d_img, stride);
+        plan.stream = stream;
+        alg6_gpu(plan);
+        check_cuda_error("Error filtering external memory");
+    }
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Last error message of each thread of the C interface
+ *  @return The error message of the calling thread
+ */
+inline std::string& c_error() {
+    static __thread std::string *msg = 0;
+    if (!msg) msg = new std::string;
+    return *msg;
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+
+// C interface -----------------------------------------------------------------
+
+gpufilter_plan *gpufilter_plan_create( int width, int height,
+                                       int batch, int channels,
+                                       const float *w,
+                                       int order ) {
+    using namespace gpufilter;
+    c_error().clear();
+    try {
+        if (width <= 0 || height <= 0 || batch <= 0 || channels < 1 || channels > 4 || !w)
+            throw std::invalid_argument("Invalid image size, batch, channels or weights");
+        switch (order) {
+        case 1: return new c_plan<1>(width, height, batch, channels, w);
+        case 2: return new c_plan<2>(width, height, batch, channels, w);
+        case 3: return new c_plan<3>(width, height, batch, channels, w);
+        case 4: return new c_plan<4>(width, height, batch, channels, w);
+        case 5: return new c_plan<5>(width, height, batch, channels, w);
+        default: throw std::invalid_argument("Filter order not compiled in library");
+        }
+    } catch (std::exception& e) {
+        c_error() = e.what();
+    }
+    return 0;
+}
+
+int gpufilter_plan_run( gpufilter_plan *plan,
+                        float *d_img,
+                        int stride,
+                        void *stream ) {
+    using namespace gpufilter;
+    c_error().clear();
+    try {
+        if (!plan)
+            throw std::invalid_argument("Invalid plan");
+        plan->run(d_img, stride, (cudaStream_t)stream);
+        return 0;
+    } catch (std::exception& e) {
+        c_error() = e.what();
+    }
+    return -1;
+}
+
+void gpufilter_plan_destroy( gpufilter_plan *plan ) {
+    delete plan;
+}
+
+const char *gpufilter_error( void ) {
+    return gpufilter::c_error().c_str();
+}
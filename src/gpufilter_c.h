@@ -0,0 +1,85 @@
+/**
+ *  @file gpufilter_c.h
+ *  @brief C interface of GPU recursive filtering plans on external device memory
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUFILTER_C_H
+#define GPUFILTER_C_H
+
+//== DEFINITIONS ===============================================================
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Opaque plan of the C interface (see gpufilter_plan_create())
+ */
+typedef struct gpufilter_plan gpufilter_plan;
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Create an algorithm 6 plan filtering device memory in place
+ *
+ *  The plan filters with zero boundary (no border blocks) images in
+ *  float storage owned by the caller (e.g. tensors of PyTorch or CuPy
+ *  on the current device), with no copies (see prepare_external()).
+ *  All filter orders from 1 to 5 are compiled in the library.
+ *
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] batch Number of images filtered together (one after the other)
+ *  @param[in] channels Number of interleaved channels per pixel (1 to 4)
+ *  @param[in] w Filter weights (order+1 feedforward and feedback coefficients)
+ *  @param[in] order Filter order (from 1 to 5)
+ *  @return The plan, or zero on error (see gpufilter_error())
+ */
+gpufilter_plan *gpufilter_plan_create( int width, int height,
+                                       int batch, int channels,
+                                       const float *w,
+                                       int order );
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Filter images in device memory in place on a stream
+ *
+ *  The kernels are launched on the given stream (the caller's, e.g.
+ *  the current stream of the framework) and the call returns with no
+ *  host synchronization.
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in,out] d_img The in(out)put images in device memory
+ *  @param[in] stride The images row stride (in pixels, at least the width)
+ *  @param[in] stream The CUDA stream to launch on (cudaStream_t, zero is the default)
+ *  @return Zero on success, or -1 on error (see gpufilter_error())
+ */
+int gpufilter_plan_run( gpufilter_plan *plan,
+                        float *d_img,
+                        int stride,
+                        void *stream );
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Destroy a plan (freeing its device memory)
+ *  @param[in] plan The plan to destroy (zero is ignored)
+ */
+void gpufilter_plan_destroy( gpufilter_plan *plan );
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Message of the last error of the calling thread
+ *  @return The error message (empty if no error)
+ */
+const char *gpufilter_error( void );
+
+#ifdef __cplusplus
+}
+#endif
+
+//==============================================================================
+#endif // GPUFILTER_C_H
+//==============================================================================
@@ -0,0 +1,153 @@
+/**
+ *  @file gpufilter_inst.cuh
+ *  @brief Explicit instantiations of the algorithms in the gpufilter library
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUFILTER_INST_CUH
+#define GPUFILTER_INST_CUH
+
+//== INCLUDES ==================================================================
+
+#include "gpudefs.h"
+
+//== DEFINES ===================================================================
+
+/*
+ *  Included after the algorithm headers, the plans of each algorithm
+ *  included among algorithms 3 to 6 (of float carries and images, all
+ *  filter orders up to max_order and all border types, as run by
+ *  src/algN_R and src/bench) are declared as instantiated in
+ *  the gpufilter library, thus their host functions and kernels are
+ *  not compiled again in the executables linking the library, and
+ *  the kernels are those of all GPUFILTER_ARCHS.  The prepare and
+ *  run functions of a plan are instantiated together, as they share
+ *  the constants of their compilation unit.  The library itself
+ *  defines GPUFILTER_TEMPLATE as template to instantiate them.  The
+ *  variants storing half images or other carries (HALF, MIXED or
+ *  COMPACT external defines) and the original algorithm 5 (ALG5ORIG)
+ *  compile their own.  The other executables (e.g. alg1d, alg6_3d,
+ *  alg6b, alg5varc or sat) run their own plans and kernels, often
+ *  tuned by their own defines, and are not in the library.
+ */
+#if !defined(HALF) && !defined(MIXED) && !defined(COMPACT) && !defined(ALG5ORIG)
+#define GPUFILTER_INSTANTIATED ///< Algorithms instantiated in the library
+#endif
+
+#ifndef GPUFILTER_TEMPLATE
+#define GPUFILTER_TEMPLATE extern template ///< Instantiation declaration (or definition)
+#endif
+
+#define GPUFILTER_TEMPLATES_ALG34(NAME, B, R) \
+    GPUFILTER_TEMPLATE void prepare_##NAME< B, R >( NAME##_plan< B, R >&, \
+        int, int, const Vector<float, R+1>&, int, BorderType ); \
+    GPUFILTER_TEMPLATE void NAME##_gpu< B, R >( NAME##_plan< B, R >&, base_timer ** ); \
+    GPUFILTER_TEMPLATE void NAME##_gpu< B, R >( float *, int, int, int, \
+        const Vector<float, R+1>&, int, BorderType );
+
+#define GPUFILTER_TEMPLATES_ALG5(B, R) \
+    GPUFILTER_TEMPLATE void prepare_alg5< B, R, float >( alg5_plan< B, R, float >&, \
+        int, int, const Vector<float, R+1>&, int, BorderType, int, int, bool, bool ); \
+    GPUFILTER_TEMPLATE void alg5_gpu< B, R, float >( alg5_plan< B, R, float >&, base_timer ** ); \
+    GPUFILTER_TEMPLATE void alg5_gpu< B, R >( float *, int, int, int, \
+        const Vector<float, R+1>&, int, BorderType );
+
+#define GPUFILTER_TEMPLATES_ALG6(B, R) \
+    GPUFILTER_TEMPLATE void prepare_alg6< B, R, float >( alg6_plan< B, R, float >&, \
+        const int&, const int&, const Vector<float, R+1>&, const int&, const BorderType&, \
+        const int&, const int&, bool, bool ); \
+    GPUFILTER_TEMPLATE void alg6_gpu< B, R, float >( alg6_plan< B, R, float >&, base_timer ** ); \
+    GPUFILTER_TEMPLATE void alg6_gpu< B, R >( float *, const int&, const int&, const int&, \
+        const Vector<float, R+1>&, const int&, const BorderType& );
+
+#define GPUFILTER_TEMPLATES_ALG6_BORDER(NAME, R) \
+    GPUFILTER_TEMPLATE void prepare_##NAME< R >( NAME##_plan< R >&, \
+        const int&, const int&, const Vector<float, R+1>& ); \
+    GPUFILTER_TEMPLATE void NAME< R >( NAME##_plan< R >&, base_timer ** ); \
+    GPUFILTER_TEMPLATE void NAME< R >( float *, const int&, const int&, const int&, \
+        const Vector<float, R+1>& );
+
+#define GPUFILTER_TEMPLATES_TENSOR(R) \
+    GPUFILTER_TEMPLATE void prepare_tensor< R, float >( alg5v6_plan< R, float >&, TensorPrecision );
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== EXTERNAL TEMPLATES ========================================================
+
+#ifdef GPUFILTER_INSTANTIATED
+
+#ifdef ALG5V6_TC_CUH
+GPUFILTER_TEMPLATES_TENSOR(1)
+GPUFILTER_TEMPLATES_TENSOR(2)
+GPUFILTER_TEMPLATES_TENSOR(3)
+GPUFILTER_TEMPLATES_TENSOR(4)
+GPUFILTER_TEMPLATES_TENSOR(5)
+#endif
+
+#ifdef ALG3_GPU_CUH
+GPUFILTER_TEMPLATES_ALG34(alg3, false, 1) GPUFILTER_TEMPLATES_ALG34(alg3, true, 1)
+GPUFILTER_TEMPLATES_ALG34(alg3, false, 2) GPUFILTER_TEMPLATES_ALG34(alg3, true, 2)
+GPUFILTER_TEMPLATES_ALG34(alg3, false, 3) GPUFILTER_TEMPLATES_ALG34(alg3, true, 3)
+GPUFILTER_TEMPLATES_ALG34(alg3, false, 4) GPUFILTER_TEMPLATES_ALG34(alg3, true, 4)
+GPUFILTER_TEMPLATES_ALG34(alg3, false, 5) GPUFILTER_TEMPLATES_ALG34(alg3, true, 5)
+#endif
+
+#ifdef ALG4_GPU_CUH
+GPUFILTER_TEMPLATES_ALG34(alg4, false, 1) GPUFILTER_TEMPLATES_ALG34(alg4, true, 1)
+GPUFILTER_TEMPLATES_ALG34(alg4, false, 2) GPUFILTER_TEMPLATES_ALG34(alg4, true, 2)
+GPUFILTER_TEMPLATES_ALG34(alg4, false, 3) GPUFILTER_TEMPLATES_ALG34(alg4, true, 3)
+GPUFILTER_TEMPLATES_ALG34(alg4, false, 4) GPUFILTER_TEMPLATES_ALG34(alg4, true, 4)
+GPUFILTER_TEMPLATES_ALG34(alg4, false, 5) GPUFILTER_TEMPLATES_ALG34(alg4, true, 5)
+#endif
+
+#ifdef ALG5_GPU_CUH
+GPUFILTER_TEMPLATES_ALG5(false, 1) GPUFILTER_TEMPLATES_ALG5(true, 1)
+GPUFILTER_TEMPLATES_ALG5(false, 2) GPUFILTER_TEMPLATES_ALG5(true, 2)
+GPUFILTER_TEMPLATES_ALG5(false, 3) GPUFILTER_TEMPLATES_ALG5(true, 3)
+GPUFILTER_TEMPLATES_ALG5(false, 4) GPUFILTER_TEMPLATES_ALG5(true, 4)
+GPUFILTER_TEMPLATES_ALG5(false, 5) GPUFILTER_TEMPLATES_ALG5(true, 5)
+#endif
+
+#ifdef ALG6_GPU_CUH
+GPUFILTER_TEMPLATES_ALG6(false, 1) GPUFILTER_TEMPLATES_ALG6(true, 1)
+GPUFILTER_TEMPLATES_ALG6(false, 2) GPUFILTER_TEMPLATES_ALG6(true, 2)
+GPUFILTER_TEMPLATES_ALG6(false, 3) GPUFILTER_TEMPLATES_ALG6(true, 3)
+GPUFILTER_TEMPLATES_ALG6(false, 4) GPUFILTER_TEMPLATES_ALG6(true, 4)
+GPUFILTER_TEMPLATES_ALG6(false, 5) GPUFILTER_TEMPLATES_ALG6(true, 5)
+#endif
+
+#ifdef ALG6_CLAMP_CUH
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_clamp, 1)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_clamp, 2)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_clamp, 3)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_clamp, 4)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_clamp, 5)
+#endif
+
+#ifdef ALG6_REPEAT_CUH
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_repeat, 1)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_repeat, 2)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_repeat, 3)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_repeat, 4)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_repeat, 5)
+#endif
+
+#ifdef ALG6_REFLECT_CUH
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_reflect, 1)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_reflect, 2)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_reflect, 3)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_reflect, 4)
+GPUFILTER_TEMPLATES_ALG6_BORDER(alg6_reflect, 5)
+#endif
+
+#endif // GPUFILTER_INSTANTIATED
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GPUFILTER_INST_CUH
+//==============================================================================
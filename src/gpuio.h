@@ -0,0 +1,369 @@
+/**
+ *  @file gpuio.h
+ *  @brief Memory-mapped image files uploaded and downloaded with no copies
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUIO_H
+#define GPUIO_H
+
+//== INCLUDES ==================================================================
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "gpuplan.h"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct image_file gpuio.h
+ *  @ingroup api_gpu
+ *  @brief Image file mapped in memory to be uploaded or downloaded in place
+ *
+ *  The file is memory-mapped and its pages are registered (pinned)
+ *  with CUDA, thus the plan upload copies the pixels by DMA straight
+ *  from the page cache and the plan download straight into it, with
+ *  no intermediate host copy.  Raw files and binary PGM/PPM (8 or 16
+ *  bits) and PFM files are supported.  16-bit PGM/PPM files are
+ *  big-endian, their pixels are swapped in place when opened (in a
+ *  private mapping, the file is unchanged) and before created files
+ *  are closed.  PFM files store rows bottom to top, which is kept
+ *  (the image is flipped upside down, see bottom_up).  Registering
+ *  pages costs per page, for many small files it may be turned off
+ *  and the copies go through the CUDA staging buffers instead (see
+ *  also alg_pipeline).
+ */
+struct image_file {
+
+    int width, height, channels; ///< Image size and number of interleaved channels
+    PixelFormat format; ///< Pixel format (of each channel)
+    bool bottom_up; ///< Flag for rows stored bottom to top (PFM files)
+    size_t pitch; ///< Row size in bytes
+    void *pixels; ///< First pixel (in the mapping)
+    int fd; ///< File descriptor (of created files)
+    void *map; ///< Memory mapping of the whole file
+    size_t map_size; ///< Memory mapping size in bytes
+    bool registered; ///< Flag for pages registered (pinned) with CUDA
+    bool swap; ///< Flag to swap 16-bit pixels before the file is closed
+
+    /// Default constructor
+    image_file() : width(0), height(0), channels(0), format(PIXEL_FLOAT),
+                   bottom_up(false), pitch(0), pixels(0), fd(-1), map(0),
+                   map_size(0), registered(false), swap(false) { }
+
+    /// Destructor
+    ~image_file() { close(); }
+
+    /// Size of each image channel value in bytes
+    size_t value_size() const {
+        return format == PIXEL_UINT8 ? 1 : format == PIXEL_UINT16 ? 2 : 4;
+    }
+
+    /// Unmap the file (writing created files back)
+    void close() {
+        if (!map) return;
+        if (registered) cudaHostUnregister(map);
+        if (swap) swap_values();
+        munmap(map, map_size);
+        if (fd >= 0) ::close(fd);
+        pixels = map = 0;
+        fd = -1;
+        map_size = 0;
+        registered = swap = false;
+    }
+
+    /// Swap the bytes of all 16-bit values in place
+    void swap_values() {
+        unsigned char *p = (unsigned char *)pixels;
+        for (size_t i = 0; i < pitch*height; i += 2)
+            std::swap(p[i], p[i+1]);
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] f File to copy to this object
+     */
+    image_file( const image_file& f );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] f File to copy from
+     *  @return This file with assigned values
+     */
+    image_file& operator = ( const image_file& f );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Map an image file given its layout
+ *  @param[out] img The mapped image file
+ *  @param[in] fd File descriptor (opened for reading and writing)
+ *  @param[in] offset First pixel offset in bytes (header size)
+ *  @param[in] private_map Flag for a private mapping (the file is not changed)
+ *  @param[in] register_pages Flag to register (pin) the file pages with CUDA
+ */
+inline void map_image( image_file& img,
+                       int fd, size_t offset,
+                       bool private_map, bool register_pages ) {
+    img.pitch = img.width*img.channels*img.value_size();
+    img.map_size = offset + img.pitch*img.height;
+    img.map = mmap(0, img.map_size, PROT_READ | PROT_WRITE,
+                   private_map ? MAP_PRIVATE : MAP_SHARED, fd, 0);
+    if (img.map == MAP_FAILED) {
+        img.map = 0;
+        throw std::runtime_error("Error mapping image file");
+    }
+    img.pixels = (char *)img.map + offset;
+    if (register_pages)
+        img.registered = cudaHostRegister(img.map, img.map_size,
+                                          cudaHostRegisterDefault) == cudaSuccess;
+    if (!img.registered)
+        cudaGetLastError(); // pageable copies still work (through staging)
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Open a raw image file (no header) mapped in memory
+ *  @param[out] img The mapped image file
+ *  @param[in] filename The file name
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @param[in] format Pixel format
+ *  @param[in] offset First pixel offset in bytes (e.g. to skip a header)
+ *  @param[in] register_pages Flag to register (pin) the file pages with CUDA
+ */
+inline void open_raw_image( image_file& img,
+                            const char *filename,
+                            int width, int height, int channels,
+                            PixelFormat format,
+                            size_t offset=0,
+                            bool register_pages=true ) {
+    img.close();
+    img.width = width;
+    img.height = height;
+    img.channels = channels;
+    img.format = format;
+    img.bottom_up = false;
+    int fd = open(filename, O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Error opening image file ") + filename);
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        (size_t)st.st_size < offset + (size_t)width*height*channels*img.value_size()) {
+        ::close(fd);
+        throw std::runtime_error(std::string("Image file too small ") + filename);
+    }
+    try {
+        map_image(img, fd, offset, true, register_pages);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd); // the mapping keeps the file
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Open a PGM, PPM or PFM image file mapped in memory
+ *
+ *  The format is given by the file magic number: P5 (PGM) is one
+ *  channel and P6 (PPM) is three channels of 8 bits (maximum value
+ *  below 256) or 16 bits, Pf is one and PF is three float channels
+ *  (little-endian, that is a negative scale).
+ *
+ *  @param[out] img The mapped image file
+ *  @param[in] filename The file name
+ *  @param[in] register_pages Flag to register (pin) the file pages with CUDA
+ */
+inline void open_image( image_file& img,
+                        const char *filename,
+                        bool register_pages=true ) {
+    FILE *f = fopen(filename, "rb");
+    if (!f)
+        throw std::runtime_error(std::string("Error opening image file ") + filename);
+    char magic[3] = { 0, 0, 0 };
+    int width = 0, height = 0, channels = 0;
+    double maxval = 0.;
+    bool ok = fread(magic, 1, 2, f) == 2 &&
+        fscanf(f, "%d %d %lf", &width, &height, &maxval) == 3 &&
+        fgetc(f) != EOF; // one whitespace before the pixels
+    long offset = ftell(f);
+    fclose(f);
+    PixelFormat format = PIXEL_FLOAT;
+    if (ok && (!strcmp(magic, "P5") || !strcmp(magic, "P6"))) {
+        channels = magic[1] == '5' ? 1 : 3;
+        format = maxval < 256. ? PIXEL_UINT8 : PIXEL_UINT16;
+    } else if (ok && (!strcmp(magic, "Pf") || !strcmp(magic, "PF"))) {
+        channels = magic[1] == 'f' ? 1 : 3;
+        if (maxval >= 0.)
+            throw std::runtime_error(std::string("Big-endian PFM not supported ") + filename);
+    } else {
+        throw std::runtime_error(std::string("Unknown image file format ") + filename);
+    }
+    open_raw_image(img, filename, width, height, channels, format, offset,
+                   register_pages && format != PIXEL_UINT16);
+    img.bottom_up = format == PIXEL_FLOAT;
+    if (format == PIXEL_UINT16) { // big-endian, swap then pin
+        img.swap_values();
+        if (register_pages)
+            img.registered = cudaHostRegister(img.map, img.map_size,
+                                              cudaHostRegisterDefault) == cudaSuccess;
+        if (!img.registered) cudaGetLastError();
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Create an image file mapped in memory to be written in place
+ *
+ *  With a header, one or three channels are stored as PGM or PPM (8
+ *  or 16 bits) or PFM (float, rows bottom to top as in bottom_up),
+ *  otherwise the file is raw.  The pixels are written when the file
+ *  is closed (or goes out of scope).
+ *
+ *  @param[out] img The mapped image file
+ *  @param[in] filename The file name
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @param[in] format Pixel format
+ *  @param[in] header Flag to write the PGM, PPM or PFM header
+ *  @param[in] register_pages Flag to register (pin) the file pages with CUDA
+ */
+inline void create_image( image_file& img,
+                          const char *filename,
+                          int width, int height, int channels,
+                          PixelFormat format,
+                          bool header=true,
+                          bool register_pages=true ) {
+    img.close();
+    if (header && channels != 1 && channels != 3)
+        throw std::runtime_error("Image file header needs one or three channels");
+    img.width = width;
+    img.height = height;
+    img.channels = channels;
+    img.format = format;
+    img.bottom_up = header && format == PIXEL_FLOAT;
+    char head[64] = "";
+    if (header && format == PIXEL_FLOAT)
+        sprintf(head, "%s\n%d %d\n-1.0\n", channels == 1 ? "Pf" : "PF", width, height);
+    else if (header)
+        sprintf(head, "%s\n%d %d\n%d\n", channels == 1 ? "P5" : "P6", width, height,
+                format == PIXEL_UINT8 ? 255 : 65535);
+    size_t offset = strlen(head),
+        size = offset + (size_t)width*height*channels*img.value_size();
+    int fd = open(filename, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        throw std::runtime_error(std::string("Error creating image file ") + filename);
+    if (ftruncate(fd, size) != 0 ||
+        (offset > 0 && pwrite(fd, head, offset, 0) != (ssize_t)offset)) {
+        ::close(fd);
+        throw std::runtime_error(std::string("Error writing image file ") + filename);
+    }
+    try {
+        map_image(img, fd, offset, false, register_pages);
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    img.fd = fd;
+    img.swap = header && format == PIXEL_UINT16; // PGM/PPM are big-endian
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Check an image file matches the plan images
+ *  @param[in] plan The plan
+ *  @param[in] img The mapped image file (the batch of images one below the other)
+ *  @param[in] output Flag to match the plan output region (see prepare_roi())
+ */
+inline void check_image( const alg_plan& plan,
+                         const image_file& img,
+                         bool output=false ) {
+    int width = output ? plan.out_width : plan.width,
+        height = output ? plan.out_height : plan.height;
+    if (!img.pixels || img.width != width ||
+        img.height != height*plan.batch || img.channels != plan.channels)
+        throw std::runtime_error("Image file size differs from plan size");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a mapped image file to the plan
+ *
+ *  The plan input format must be the file format (see
+ *  prepare_formats()).  Given a stream, the copy is asynchronous
+ *  (the file must stay open until it is done).
+ *
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] img The mapped image file
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void upload( alg_plan& plan,
+                    const image_file& img,
+                    cudaStream_t stream=0 ) {
+    check_image(plan, img);
+    if (img.format == PIXEL_UINT8)
+        upload(plan, (const unsigned char *)img.pixels, img.pitch,
+               cudaMemcpyHostToDevice, stream);
+    else if (img.format == PIXEL_UINT16)
+        upload(plan, (const unsigned short *)img.pixels, img.pitch,
+               cudaMemcpyHostToDevice, stream);
+    else
+        upload(plan, (const float *)img.pixels, img.pitch,
+               cudaMemcpyHostToDevice, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan output image to a mapped image file
+ *
+ *  The plan output format must be the file format (see
+ *  prepare_formats()).  Given a stream, the copy is asynchronous
+ *  (the file must stay open until it is done).
+ *
+ *  @param[in] plan The plan with the output image
+ *  @param[in,out] img The mapped image file (see create_image())
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void download( const alg_plan& plan,
+                      image_file& img,
+                      cudaStream_t stream=0 ) {
+    check_image(plan, img, true);
+    if (img.format == PIXEL_UINT8)
+        download(plan, (unsigned char *)img.pixels, img.pitch,
+                 cudaMemcpyDeviceToHost, stream);
+    else if (img.format == PIXEL_UINT16)
+        download(plan, (unsigned short *)img.pixels, img.pitch,
+                 cudaMemcpyDeviceToHost, stream);
+    else
+        download(plan, (float *)img.pixels, img.pitch,
+                 cudaMemcpyDeviceToHost, stream);
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GPUIO_H
+//==============================================================================
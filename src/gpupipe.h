@@ -0,0 +1,252 @@
+/**
+ *  @file gpupipe.h
+ *  @brief Asynchronous pipeline of frames overlapping copies and filtering
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUPIPE_H
+#define GPUPIPE_H
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+#include <stdexcept>
+
+#include "gpuplan.h"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg_pipeline gpupipe.h
+ *  @ingroup api_gpu
+ *  @brief Pipeline of frames filtered by a plan using three streams
+ *
+ *  The pipeline keeps a ring of slots (its queue depth), each slot
+ *  with pinned host input and output buffers and device staging
+ *  buffers.  Uploads, filtering and downloads run on their own
+ *  streams, chained by events, thus the upload of frame k+1, the
+ *  filtering of frame k and the download of frame k-1 overlap.  The
+ *  plan input array and output image are only touched by the filter
+ *  stream (device-to-device copies from and to the staging buffers),
+ *  so the texture binding of the plan is never changed while its
+ *  kernels run.
+ *
+ *  Usage: fill next_input(), call submit() and later wait_output()
+ *  for that frame; an output is valid until depth more frames are
+ *  submitted.
+ */
+struct alg_pipeline {
+
+    int depth; ///< Queue depth (number of frames in flight)
+    int frames; ///< Number of frames submitted so far
+    size_t frame_size; ///< Number of floats of each input frame (including batch and channels)
+    size_t out_size; ///< Number of floats of each output frame (of the plan output region)
+    int out_width, out_height; ///< Output region size of the plan (see prepare_roi())
+    std::vector<float *> h_in, h_out; ///< Pinned host buffers per slot
+    std::vector<float *> d_in, d_out; ///< Device staging buffers per slot
+    std::vector<cudaEvent_t> e_up, e_filter, e_down; ///< Events per slot
+    cudaStream_t s_up, s_filter, s_down; ///< Upload, filter and download streams
+
+    /// Default constructor
+    alg_pipeline() : depth(0), frames(0), frame_size(0), out_size(0),
+                     out_width(0), out_height(0),
+                     s_up(0), s_filter(0), s_down(0) { }
+
+    /// Destructor
+    ~alg_pipeline() {
+        release();
+    }
+
+    /// Release all buffers, events and streams
+    void release() {
+        if (s_up) cudaStreamSynchronize(s_up);
+        if (s_filter) cudaStreamSynchronize(s_filter);
+        if (s_down) cudaStreamSynchronize(s_down);
+        for (int i = 0; i < depth; ++i) {
+            cudaFreeHost(h_in[i]); cudaFreeHost(h_out[i]);
+            cudaFree(d_in[i]); cudaFree(d_out[i]);
+            cudaEventDestroy(e_up[i]);
+            cudaEventDestroy(e_filter[i]);
+            cudaEventDestroy(e_down[i]);
+        }
+        if (s_up) cudaStreamDestroy(s_up);
+        if (s_filter) cudaStreamDestroy(s_filter);
+        if (s_down) cudaStreamDestroy(s_down);
+        h_in.clear(); h_out.clear(); d_in.clear(); d_out.clear();
+        e_up.clear(); e_filter.clear(); e_down.clear();
+        s_up = s_filter = s_down = 0;
+        depth = frames = 0;
+        frame_size = out_size = 0;
+        out_width = out_height = 0;
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Pipeline to copy to this object
+     */
+    alg_pipeline( const alg_pipeline& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Pipeline to copy from
+     *  @return This pipeline with assigned values
+     */
+    alg_pipeline& operator = ( const alg_pipeline& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare a pipeline for a prepared plan
+ *
+ *  The plan kernels are redirected to the pipeline filter stream, so
+ *  the plan should only be run by the pipeline afterwards.  The output
+ *  buffers are of the plan output region (see prepare_roi()), thus the
+ *  region must be set before and kept while the pipeline runs.
+ *
+ *  @param[out] pipe The pipeline to prepare
+ *  @param[in,out] plan The (prepared) plan to run on each frame
+ *  @param[in] depth Queue depth (at least two to overlap anything)
+ */
+inline void prepare_pipeline( alg_pipeline& pipe,
+                              alg_plan& plan,
+                              int depth=3 ) {
+
+    if (depth < 1)
+        throw std::runtime_error("Pipeline depth must be positive");
+
+    pipe.release();
+
+    pipe.depth = depth;
+    pipe.frame_size = (size_t)plan.width*plan.height*plan.batch*plan.channels;
+    pipe.out_width = plan.out_width;
+    pipe.out_height = plan.out_height;
+    pipe.out_size = (size_t)plan.out_width*plan.out_height*plan.batch*plan.channels;
+
+    size_t bytes = pipe.frame_size*sizeof(float),
+        out_bytes = pipe.out_size*sizeof(float);
+
+    pipe.h_in.resize(depth); pipe.h_out.resize(depth);
+    pipe.d_in.resize(depth); pipe.d_out.resize(depth);
+    pipe.e_up.resize(depth); pipe.e_filter.resize(depth);
+    pipe.e_down.resize(depth);
+
+    for (int i = 0; i < depth; ++i) {
+        cudaMallocHost((void **)&pipe.h_in[i], bytes);
+        cudaMallocHost((void **)&pipe.h_out[i], out_bytes);
+        cudaMalloc((void **)&pipe.d_in[i], bytes);
+        cudaMalloc((void **)&pipe.d_out[i], out_bytes);
+        cudaEventCreateWithFlags(&pipe.e_up[i], cudaEventDisableTiming);
+        cudaEventCreateWithFlags(&pipe.e_filter[i], cudaEventDisableTiming);
+        cudaEventCreateWithFlags(&pipe.e_down[i], cudaEventDisableTiming);
+    }
+
+    cudaStreamCreateWithFlags(&pipe.s_up, cudaStreamNonBlocking);
+    cudaStreamCreateWithFlags(&pipe.s_filter, cudaStreamNonBlocking);
+    cudaStreamCreateWithFlags(&pipe.s_down, cudaStreamNonBlocking);
+
+    check_cuda_error("Error preparing pipeline");
+
+    plan.stream = pipe.s_filter;
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Host input buffer of the next frame to submit
+ *
+ *  Waits until the upload of the frame that previously used the same
+ *  slot is done, then the returned pinned buffer can be filled.
+ *
+ *  @param[in] pipe The pipeline
+ *  @return Pinned host buffer (plan width x height x batch pixels, interleaved channels)
+ */
+inline float *next_input( alg_pipeline& pipe ) {
+    int slot = pipe.frames % pipe.depth;
+    cudaEventSynchronize(pipe.e_up[slot]);
+    return pipe.h_in[slot];
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Submit the next frame (filled in next_input()) to the pipeline
+ *
+ *  Enqueues the frame upload, its filtering by the plan and its
+ *  download, returning without waiting for any of them.
+ *
+ *  @param[in,out] pipe The pipeline
+ *  @param[in,out] plan The plan given to prepare_pipeline()
+ *  @param[in] run The plan run function, e.g. alg6_gpu<true,R>
+ *  @return Frame number to be given to wait_output()
+ *  @tparam PLAN Plan type
+ */
+template <class PLAN>
+int submit( alg_pipeline& pipe,
+            PLAN& plan,
+            void (*run)(PLAN&, base_timer**) ) {
+
+    if (plan.out_width != pipe.out_width || plan.out_height != pipe.out_height)
+        throw std::runtime_error("Plan output region differs from pipeline output");
+
+    int frame = pipe.frames++, slot = frame % pipe.depth;
+    size_t pitch = plan.width*plan.channels*sizeof(float),
+        out_pitch = plan.out_width*plan.channels*sizeof(float);
+
+    // the staging input is free only when its last filtering is done
+    cudaStreamWaitEvent(pipe.s_up, pipe.e_filter[slot], 0);
+    cudaMemcpyAsync(pipe.d_in[slot], pipe.h_in[slot],
+                    pipe.frame_size*sizeof(float),
+                    cudaMemcpyHostToDevice, pipe.s_up);
+    cudaEventRecord(pipe.e_up[slot], pipe.s_up);
+
+    // the staging output is free only when its last download is done
+    cudaStreamWaitEvent(pipe.s_filter, pipe.e_up[slot], 0);
+    cudaStreamWaitEvent(pipe.s_filter, pipe.e_down[slot], 0);
+    upload(plan, pipe.d_in[slot], pitch, cudaMemcpyDeviceToDevice, pipe.s_filter);
+    run(plan, 0);
+    download(plan, pipe.d_out[slot], out_pitch, cudaMemcpyDeviceToDevice, pipe.s_filter);
+    cudaEventRecord(pipe.e_filter[slot], pipe.s_filter);
+
+    cudaStreamWaitEvent(pipe.s_down, pipe.e_filter[slot], 0);
+    cudaMemcpyAsync(pipe.h_out[slot], pipe.d_out[slot],
+                    pipe.out_size*sizeof(float),
+                    cudaMemcpyDeviceToHost, pipe.s_down);
+    cudaEventRecord(pipe.e_down[slot], pipe.s_down);
+
+    check_cuda_error("Error submitting frame to pipeline");
+
+    return frame;
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Wait for a submitted frame to be filtered and downloaded
+ *  @param[in] pipe The pipeline
+ *  @param[in] frame Frame number returned by submit()
+ *  @return Pinned host buffer with the output region (valid until depth more submits)
+ */
+inline const float *wait_output( alg_pipeline& pipe,
+                                 int frame ) {
+    if (frame < 0 || frame >= pipe.frames || frame + pipe.depth < pipe.frames)
+        throw std::runtime_error("Frame not in pipeline");
+    int slot = frame % pipe.depth;
+    cudaEventSynchronize(pipe.e_down[slot]);
+    return pipe.h_out[slot];
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GPUPIPE_H
+//==============================================================================
@@ -0,0 +1,1237 @@
+/**
+ *  @file gpuplan.h
+ *  @brief Filter plan definition and implementation (prepare once, run many)
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUPLAN_H
+#define GPUPLAN_H
+
+//== INCLUDES ==================================================================
+
+#include <cstring>
+
+#include "gputune.h"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== ENUMERATIONS ==============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Pixel format of the plan input array or output image
+ *
+ *  Integer formats are normalized: the input is read as floats from
+ *  0 to 1 (as cudaReadModeNormalizedFloat) and the output is scaled
+ *  back, rounded and saturated to the integer range.
+ */
+enum PixelFormat {
+    PIXEL_FLOAT, ///< Single precision (or half precision in half plans)
+    PIXEL_UINT8, ///< Unsigned 8-bit integers
+    PIXEL_UINT16 ///< Unsigned 16-bit integers
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Axes filtered by a plan of algorithms 5 and 6
+ *
+ *  Filtering only rows (or only columns) skips the carries and the
+ *  scans of the other axis in all steps (see prepare_axes()).
+ */
+enum FilterAxes {
+    BOTH_AXES, ///< Rows then columns (default)
+    ROWS_ONLY, ///< Only rows (horizontal filter)
+    COLUMNS_ONLY ///< Only columns (vertical filter)
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Precision of the block products on tensor cores of algorithms 5 and 6
+ *
+ *  The scans of each block may run as dense products on tensor cores
+ *  with single-precision accumulation (see prepare_tensor()).
+ */
+enum TensorPrecision {
+    TENSOR_OFF, ///< Scans of one warp in single precision (default)
+    TENSOR_TF32, ///< TF32 products (Ampere and newer)
+    TENSOR_FP16 ///< FP16 products (Volta and newer)
+};
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct alg_matrices gpuplan.h
+ *  @ingroup api_gpu
+ *  @brief Basic pre-computed matrices of the block-based algorithms
+ *
+ *  These are the matrices derived from the filter weights that all
+ *  algorithms (3 to 6 and SAT) need to fix carries between blocks.
+ *  They depend only on the weights, thus they are computed once per
+ *  plan.  The naming follows [NehabMaximo:2016] cited in alg6().
+ *
+ *  @tparam R Filter order
+ *  @tparam T Matrix element type (double for double-precision carries)
+ *  @tparam B Block size (b x b blocks, see alg6b_gpu())
+ */
+template <int R, class T=float, int B=WS>
+struct alg_matrices {
+    Matrix<T,R,B> AFP_T, ARE_T; ///< Prologue and epilogue matrices
+    Matrix<T,B,B> AFB_T, ARB_T; ///< Block forward and reverse matrices
+    Matrix<T,R,R> AbF_T, AbR_T, HARB_AFP_T; ///< Carry adjusting matrices
+    Matrix<T,R,B> ARB_AFP_T, TAFB, HARB_AFB; ///< Carry fixing matrices
+};
+
+/**
+ *  @struct plan_graph gpuplan.h
+ *  @ingroup api_gpu
+ *  @brief CUDA Graph of the kernels of one run of a plan
+ *
+ *  When enabled, the first run of a plan captures its whole kernel
+ *  chain into a CUDA Graph and every run replays it with a single
+ *  launch, cutting the launch latency that dominates small images.
+ *  The graph is captured again after the plan is prepared again (its
+ *  buffers and sizes change), and it is bypassed by timed runs (the
+ *  step timers need the kernels launched one by one).
+ */
+struct plan_graph {
+
+    bool enabled; ///< Flag to capture and replay the plan kernels
+    cudaGraphExec_t exec; ///< Executable graph (zero until captured)
+
+    /// Default constructor
+    plan_graph() : enabled(false), exec(0) { }
+
+    /// Destructor
+    ~plan_graph() { reset(); }
+
+    /// Release the captured graph (to be captured again on next run)
+    void reset() {
+        if (exec) cudaGraphExecDestroy(exec);
+        exec = 0;
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] g Graph to copy to this object
+     */
+    plan_graph( const plan_graph& g );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] g Graph to copy from
+     *  @return This graph with assigned values
+     */
+    plan_graph& operator = ( const plan_graph& g );
+
+};
+
+/**
+ *  @struct pitch_texture gpuplan.h
+ *  @ingroup api_gpu
+ *  @brief Texture object of an intermediate image in (pitched) device memory
+ *
+ *  Algorithms reading back an image they wrote (as the transposed
+ *  image of algorithm 4) read it by this texture object, addressed
+ *  as the plan input texture object (normalized coordinates).
+ */
+struct pitch_texture {
+
+    cudaTextureObject_t tex; ///< Texture object (zero until created)
+
+    /// Default constructor
+    pitch_texture() : tex(0) { }
+
+    /// Destructor
+    ~pitch_texture() { reset(); }
+
+    /// Destroy the texture object
+    void reset() {
+        if (tex) cudaDestroyTextureObject(tex);
+        tex = 0;
+    }
+
+    /**
+     *  @brief Create the texture object of an image in device memory
+     *  @param[in] d_ptr The image in device memory
+     *  @param[in] width Image width (in texture coordinates)
+     *  @param[in] height Image height (in texture coordinates)
+     *  @param[in] stride Image row stride (in floats)
+     *  @param[in] mode Texture address mode (in width and height)
+     */
+    void create( const float *d_ptr,
+                 int width, int height, int stride,
+                 cudaTextureAddressMode mode ) {
+        reset();
+        cudaResourceDesc res;
+        memset(&res, 0, sizeof(res));
+        res.resType = cudaResourceTypePitch2D;
+        res.res.pitch2D.devPtr = (void *)d_ptr;
+        res.res.pitch2D.desc = cudaCreateChannelDesc<float>();
+        res.res.pitch2D.width = width;
+        res.res.pitch2D.height = height;
+        res.res.pitch2D.pitchInBytes = stride*sizeof(float);
+        cudaTextureDesc td;
+        memset(&td, 0, sizeof(td));
+        td.addressMode[0] = td.addressMode[1] = mode;
+        td.filterMode = cudaFilterModePoint;
+        td.readMode = cudaReadModeElementType;
+        td.normalizedCoords = 1;
+        cudaCreateTextureObject(&tex, &res, &td, 0);
+        check_cuda_error("Error creating pitch texture object");
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] t Texture to copy to this object
+     */
+    pitch_texture( const pitch_texture& t );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] t Texture to copy from
+     *  @return This texture with assigned values
+     */
+    pitch_texture& operator = ( const pitch_texture& t );
+
+};
+
+/**
+ *  @struct alg_plan gpuplan.h
+ *  @ingroup api_gpu
+ *  @brief Base filter plan with the input and output image storage
+ *
+ *  A filter plan holds everything that depends only on the image
+ *  size, the filter order, the weights and the border type: the
+ *  pre-computed matrices and all device buffers.  It is prepared once
+ *  and then run many times, avoiding re-computing matrices,
+ *  re-allocating device memory and re-uploading constants on each
+ *  filter call.  Each algorithm derives its own plan from this one.
+ */
+struct alg_plan {
+
+    int id; ///< Unique plan identifier (to upload constants once)
+    int width, height; ///< Image width and height
+    int m_size, n_size; ///< The big M and N (number of row and column blocks)
+    int border; ///< Number of border blocks (32x32) outside image
+    BorderType btype; ///< Border type (either zero, clamp, repeat or reflect)
+    int stride_img; ///< Output image stride for memory width alignment
+    int out_x, out_y; ///< Output region origin in the image (see prepare_roi())
+    int out_width, out_height; ///< Output region width and height (the image size by default)
+    int batch; ///< Number of images filtered together (same size)
+    int channels; ///< Number of interleaved channels per pixel (1 to 4)
+    bool layered; ///< Flag for layered input array (one layer per image)
+    bool half; ///< Flag for half-precision input and output storage
+    bool inplace; ///< Flag to read the input in place from the output (see prepare_inplace())
+    float inv_width, inv_height; ///< Image width and height inversed
+    cudaArray *a_in; ///< Input image array (read by the texture object)
+    cudaTextureObject_t tex_in; ///< Input texture object (of the input array)
+    dvector<float> d_img; ///< Output image(s) in device memory
+    float *d_ext; ///< External output image(s) in device memory (see prepare_external()), zero uses d_img
+    dvector<__half> d_himg; ///< Output image(s) in device memory (half storage)
+    PixelFormat in_format, out_format; ///< Input array and output image pixel formats
+    dvector<unsigned char> d_img8; ///< Output image(s) in device memory (8-bit storage)
+    dvector<unsigned short> d_img16; ///< Output image(s) in device memory (16-bit storage)
+    dvector<float> d_pack; ///< Input packed for the array (padded or half)
+    cudaStream_t stream; ///< Stream to launch kernels on (default stream)
+    tune_config tune; ///< Launch configuration (tuned for the device)
+    plan_graph graph; ///< CUDA Graph replaying the plan kernels (off by default)
+
+    /// Default constructor
+    alg_plan() : id(-1), width(0), height(0), m_size(0), n_size(0),
+                 border(0), btype(CLAMP_TO_ZERO), stride_img(0),
+                 out_x(0), out_y(0), out_width(0), out_height(0),
+                 batch(1), channels(1), layered(false), half(false),
+                 inplace(false), inv_width(0.f), inv_height(0.f), a_in(0), tex_in(0),
+                 d_ext(0), in_format(PIXEL_FLOAT), out_format(PIXEL_FLOAT),
+                 stream(0) { }
+
+    /// Destructor
+    ~alg_plan() {
+        if (tex_in) cudaDestroyTextureObject(tex_in);
+        if (a_in) cudaFreeArray(a_in);
+    }
+
+private:
+
+    /**
+     *  Copy Constructor (deleted)
+     *  @param[in] p Plan to copy to this object
+     */
+    alg_plan( const alg_plan& p );
+
+    /**
+     *  @brief Assign operator (deleted)
+     *  @param[in] p Plan to copy from
+     *  @return This plan with assigned values
+     */
+    alg_plan& operator = ( const alg_plan& p );
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the basic matrices of the block-based algorithms
+ *  @param[out] a The basic matrices computed
+ *  @param[in] wf Filter weights (feedforward and feedback coefficients)
+ *  @tparam R Filter order
+ *  @tparam T Matrix element type (the weights are converted to it)
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, class T, int B>
+void calc_matrices( alg_matrices<R,T,B>& a,
+                    const Vector<float, R+1>& wf ) {
+
+    Vector<T,R+1> w = convert<T>(wf);
+    Matrix<T,R,R> Ir = identity<T,R,R>();
+    Matrix<T,B,R> Zbr = zeros<T,B,R>();
+    Matrix<T,R,B> Zrb = zeros<T,R,B>();
+    Matrix<T,B,B> Ib = identity<T,B,B>();
+
+    a.AFP_T = fwd(Ir, Zrb, w);
+    a.ARE_T = rev(Zrb, Ir, w);
+    a.AFB_T = fwd(Zbr, Ib, w);
+    a.ARB_T = rev(Ib, Zbr, w);
+    a.AbF_T = tail<R>(a.AFP_T);
+    a.AbR_T = head<R>(a.ARE_T);
+    a.HARB_AFP_T = a.AFP_T*head<R>(a.ARB_T);
+    a.ARB_AFP_T = a.AFP_T*a.ARB_T;
+    a.TAFB = transp(tail<R>(a.AFB_T));
+    a.HARB_AFB = transp(a.AFB_T*head<R>(a.ARB_T));
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Gather the per-plan filter parameters passed to kernels
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] a The basic matrices of the plan
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @return The filter parameters
+ *  @tparam R Filter order
+ *  @tparam T Carry type (float or double)
+ *  @tparam B Block size (b x b blocks)
+ */
+template <int R, class T, int B>
+filter_params<R,T> make_params( const Vector<float, R+1>& w,
+                                const alg_matrices<R,T,B>& a,
+                                int border ) {
+    filter_params<R,T> p;
+    p.weights = w;
+    p.AbF_T = a.AbF_T;
+    p.AbR_T = a.AbR_T;
+    p.HARB_AFP_T = a.HARB_AFP_T;
+    p.border = border;
+    p.weights_cols = w;
+    p.axes = BOTH_AXES;
+    return p;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Identifier of the plan whose constants are in the GPU
+ *  @return Reference to the current plan identifier
+ */
+inline int& current_plan_id() {
+    static int id = -1;
+    return id;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Check that a plan writes the whole image
+ *
+ *  Only the common kernels of algorithms 5 and 6 write an output
+ *  region (see prepare_roi()), all others write the whole image.
+ *
+ *  @param[in] plan The plan to check
+ */
+inline void check_whole_output( const alg_plan& plan ) {
+    if (plan.out_width != plan.width || plan.out_height != plan.height)
+        throw std::runtime_error("Output region needs the common kernels of algorithms 5 and 6");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Make a plan the current one (owning the GPU constants)
+ *
+ *  Only plans running kernels of the constants banks become current,
+ *  and these kernels write the whole image (see check_whole_output()).
+ *
+ *  @param[in] plan The plan to become current
+ *  @return True if the plan constants must be uploaded
+ */
+inline bool make_current( const alg_plan& plan ) {
+    check_whole_output(plan);
+    if (current_plan_id() == plan.id)
+        return false;
+    current_plan_id() = plan.id;
+    return true;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Begin capturing the kernels launched on a stream
+ *
+ *  The legacy default stream can not be captured, thus a new stream
+ *  is created to capture on in that case.
+ *
+ *  @param[in] stream Stream the kernels are launched on
+ *  @return Stream to launch the kernels on while capturing
+ */
+inline cudaStream_t begin_graph( cudaStream_t stream ) {
+    cudaStream_t capture = stream;
+    if (capture == 0)
+        cudaStreamCreateWithFlags(&capture, cudaStreamNonBlocking);
+    cudaStreamBeginCapture(capture, cudaStreamCaptureModeThreadLocal);
+    check_cuda_error("Error beginning graph capture");
+    return capture;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief End capturing the kernels into an executable graph
+ *  @param[out] g The graph to hold the captured kernels
+ *  @param[in] capture Stream returned by begin_graph()
+ *  @param[in] stream Stream given to begin_graph()
+ */
+inline void end_graph( plan_graph& g,
+                       cudaStream_t capture,
+                       cudaStream_t stream ) {
+    cudaGraph_t graph;
+    cudaStreamEndCapture(capture, &graph);
+    if (capture != stream)
+        cudaStreamDestroy(capture);
+    g.reset();
+#if CUDART_VERSION >= 11040
+    cudaGraphInstantiateWithFlags(&g.exec, graph, 0);
+#else
+    cudaGraphInstantiate(&g.exec, graph, 0, 0, 0);
+#endif
+    cudaGraphDestroy(graph);
+    check_cuda_error("Error instantiating graph");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Replay the graph of a plan run, capturing it on first use
+ *
+ *  Only plans passing their own parameters to kernels can be
+ *  captured (kernels reading constants banks depend on host calls
+ *  at each run).
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] run Function running the plan kernels (untimed)
+ *  @return True if the graph was launched (false if not enabled)
+ *  @tparam PLAN Plan type
+ */
+template <class PLAN>
+bool launch_graph( PLAN& plan,
+                   void (*run)(PLAN&, base_timer**) ) {
+    if (!plan.graph.enabled)
+        return false;
+    if (!plan.graph.exec) {
+        cudaStream_t stream = plan.stream;
+        plan.stream = begin_graph(stream);
+        plan.graph.enabled = false; // launch the kernels being captured
+        run(plan, 0);
+        plan.graph.enabled = true;
+        end_graph(plan.graph, plan.stream, stream);
+        plan.stream = stream;
+    }
+    cudaGraphLaunch(plan.graph.exec, plan.stream);
+    return true;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Texture address mode corresponding to a border type
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @return The texture address mode
+ */
+inline cudaTextureAddressMode address_mode( const BorderType& btype ) {
+    switch(btype) {
+    case CLAMP_TO_EDGE: return cudaAddressModeClamp;
+    case REPEAT: return cudaAddressModeWrap;
+    case REFLECT: return cudaAddressModeMirror;
+    default: return cudaAddressModeBorder;
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Output image(s) in float storage of a plan
+ *
+ *  Plans bound to external memory (see prepare_external()) write
+ *  their output there, otherwise in their own output image.
+ *
+ *  @param[in] plan The plan to write the output of
+ *  @return The output image(s) in device memory
+ */
+inline float *output_ptr( alg_plan& plan ) {
+    return plan.d_ext ? plan.d_ext : &plan.d_img;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @overload const float *output_ptr( const alg_plan& plan )
+ *  @brief Output image(s) in float storage of a plan
+ */
+inline const float *output_ptr( const alg_plan& plan ) {
+    return plan.d_ext ? plan.d_ext : &plan.d_img;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Input in linear memory of a plan read in place
+ *
+ *  In-place plans (see prepare_inplace()) read their input from their
+ *  output, otherwise the kernels read the input texture object.
+ *
+ *  @param[in] plan The plan to read the input of
+ *  @return The input in linear memory (its pointer is zero if not in place)
+ */
+inline linear_input make_linear_input( const alg_plan& plan ) {
+    linear_input in;
+    in.ptr = plan.inplace ? output_ptr(plan) : 0;
+    in.width = plan.width;
+    in.height = plan.height;
+    in.stride = plan.stride_img;
+    in.size = plan.height*plan.stride_img*plan.channels;
+    in.zero = plan.btype == CLAMP_TO_ZERO;
+    return in;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Grid of the blocks of the plan output region
+ *
+ *  The last step of algorithms 5 and 6 launches only the blocks
+ *  intersecting the output region (the whole image by default, no
+ *  border blocks), one grid layer per image.
+ *
+ *  @param[in] plan The plan with the output region
+ *  @return The grid of the output blocks
+ */
+inline dim3 output_grid( const alg_plan& plan ) {
+    int m0 = plan.out_x/WS, n0 = plan.out_y/WS,
+        m1 = (plan.out_x+plan.out_width-1)/WS,
+        n1 = (plan.out_y+plan.out_height-1)/WS;
+    return dim3(m1-m0+1, n1-n0+1, plan.batch);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Create the texture object of the plan input array
+ *
+ *  The input is addressed in width and in height by their own modes,
+ *  the same mode of the plan border type by default (see
+ *  alloc_input()) or one per axis (see prepare_alg6_axes()).
+ *
+ *  @param[in,out] plan The plan with the input array
+ *  @param[in] mode_x Texture address mode in width (rows)
+ *  @param[in] mode_y Texture address mode in height (columns)
+ */
+inline void create_input_texture( alg_plan& plan,
+                                  cudaTextureAddressMode mode_x,
+                                  cudaTextureAddressMode mode_y ) {
+    if (plan.tex_in) cudaDestroyTextureObject(plan.tex_in);
+    cudaResourceDesc res;
+    memset(&res, 0, sizeof(res));
+    res.resType = cudaResourceTypeArray;
+    res.res.array.array = plan.a_in;
+    cudaTextureDesc tex;
+    memset(&tex, 0, sizeof(tex));
+    tex.addressMode[0] = mode_x;
+    tex.addressMode[1] = mode_y;
+    tex.filterMode = cudaFilterModePoint;
+    tex.readMode = plan.in_format == PIXEL_FLOAT ? cudaReadModeElementType
+        : cudaReadModeNormalizedFloat;
+    tex.normalizedCoords = 1;
+    cudaCreateTextureObject(&plan.tex_in, &res, &tex, 0);
+    check_cuda_error("Error creating input texture object");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Allocate the plan input array and create its texture object
+ *
+ *  The array has the plan size, layers, channels (three padded to
+ *  four) and input pixel format, integer formats are read normalized
+ *  by the texture.
+ *
+ *  @param[in,out] plan The plan to allocate the input array of
+ */
+inline void alloc_input( alg_plan& plan ) {
+
+    if (plan.a_in) cudaFreeArray(plan.a_in);
+    const int channels = plan.channels;
+    cudaChannelFormatDesc ccd;
+    if (plan.in_format == PIXEL_UINT8)
+        ccd = channels == 1 ? cudaCreateChannelDesc<unsigned char>()
+            : channels == 2 ? cudaCreateChannelDesc<uchar2>()
+            : cudaCreateChannelDesc<uchar4>();
+    else if (plan.in_format == PIXEL_UINT16)
+        ccd = channels == 1 ? cudaCreateChannelDesc<unsigned short>()
+            : channels == 2 ? cudaCreateChannelDesc<ushort2>()
+            : cudaCreateChannelDesc<ushort4>();
+    else if (plan.half)
+        ccd = channels == 1 ? cudaCreateChannelDescHalf()
+            : channels == 2 ? cudaCreateChannelDescHalf2()
+            : cudaCreateChannelDescHalf4();
+    else
+        ccd = channels == 1 ? cudaCreateChannelDesc<float>()
+            : channels == 2 ? cudaCreateChannelDesc<float2>()
+            : cudaCreateChannelDesc<float4>();
+    if (plan.layered)
+        cudaMalloc3DArray(&plan.a_in, &ccd,
+                          make_cudaExtent(plan.width, plan.height, plan.batch),
+                          cudaArrayLayered);
+    else
+        cudaMallocArray(&plan.a_in, &ccd, plan.width, plan.height);
+    check_cuda_error("Error allocating input array");
+
+    create_input_texture(plan, address_mode(plan.btype), address_mode(plan.btype));
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare the base plan: sizes, input array and output image
+ *
+ *  A layered plan holds a batch of images of the same size, one per
+ *  input array layer to be read by the layered input texture (kernels
+ *  select the image by the grid z dimension).  The output images are
+ *  stacked one after the other in the plan output.
+ *
+ *  A multi-channel plan holds images of interleaved channels (2, 3
+ *  or 4 floats per pixel), always in a layered float2 or float4
+ *  input array (three channels are padded to four), and its output
+ *  images are interleaved as well.
+ *
+ *  A half plan stores its input array and output images in half
+ *  precision (all filter computations stay in single precision),
+ *  halving the image memory traffic.  Upload and download convert
+ *  from and to single precision.
+ *
+ *  Integer input and output pixel formats are set after the plan is
+ *  prepared (see prepare_formats()).
+ *
+ *  Each plan has its own texture object of its input array, so
+ *  kernels of different plans can run concurrently.
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @param[in] use_border Flag to consider border input padding
+ *  @param[in] layers Number of layers (zero means not layered)
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @param[in] half Flag for half-precision input and output storage
+ *  @param[in] tight Flag to allocate the output with tight pitch (stride equal to width)
+ */
+inline void prepare_plan( alg_plan& plan,
+                          int width, int height,
+                          int border, BorderType btype,
+                          bool use_border,
+                          int layers=0,
+                          int channels=1,
+                          bool half=false,
+                          bool tight=false ) {
+
+    if (channels < 1 || channels > 4)
+        throw std::runtime_error("Number of channels must be from 1 to 4");
+    if (channels > 1 && layers < 1)
+        layers = 1;
+
+    static int next_id = 0;
+
+    plan.graph.reset(); // sizes and buffers change, capture again
+    plan.id = next_id++;
+    plan.width = width;
+    plan.height = height;
+    plan.border = border;
+    plan.btype = btype;
+    plan.batch = layers > 1 ? layers : 1;
+    plan.channels = channels;
+    plan.layered = layers > 0;
+    plan.half = half;
+    plan.inplace = false;
+    plan.in_format = PIXEL_FLOAT;
+    plan.out_format = PIXEL_FLOAT;
+    plan.inv_width = 1.f/width;
+    plan.inv_height = 1.f/height;
+    plan.out_x = plan.out_y = 0;
+    plan.out_width = width;
+    plan.out_height = height;
+
+    plan.m_size = (width+WS-1)/WS;
+    plan.n_size = (height+WS-1)/WS;
+    plan.stride_img = width+WS;
+
+    if (use_border) {
+        int border_left, border_top, border_right, border_bottom;
+        calc_borders(&border_left, &border_top, &border_right, &border_bottom,
+                     width, height, border);
+        int ewidth = width+border_left+border_right,
+            eheight = height+border_top+border_bottom;
+
+        plan.m_size = (ewidth+WS-1)/WS;
+        plan.n_size = (eheight+WS-1)/WS;
+        plan.stride_img = width+WS*border+WS;
+    }
+
+    if (tight) // only for algorithms writing edge blocks cut to the image
+        plan.stride_img = width;
+
+    alloc_input(plan);
+
+    int out_size = plan.batch*height*plan.stride_img*channels,
+        pack_size = plan.batch*height*width*(channels == 3 ? 4 : channels);
+    if (half) {
+        plan.d_img.resize(0);
+        plan.d_himg.resize(out_size);
+        plan.d_pack.resize((pack_size+1)/2);
+    } else {
+        plan.d_img.resize(out_size);
+        plan.d_himg.resize(0);
+        plan.d_pack.resize(channels == 3 ? pack_size : 0);
+    }
+    plan.d_img8.resize(0);
+    plan.d_img16.resize(0);
+    plan.d_ext = 0;
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Pack an input image as stored in the plan input array
+ *
+ *  Converts interleaved channels to the storage type T, padding C
+ *  channels to CP channels (three to four).  Integer inputs are
+ *  stored as they are.
+ *
+ *  @param[out] g_out The packed image (CP values of type T per pixel)
+ *  @param[in] g_in The input image (C values of type TI per pixel)
+ *  @param[in] width Image width
+ *  @param[in] height Image height (times batch)
+ *  @param[in] in_stride Input image stride (in values)
+ *  @tparam T Storage type (float, half, unsigned char or unsigned short)
+ *  @tparam C Number of input channels
+ *  @tparam CP Number of packed channels
+ *  @tparam TI Input type (float for float or half, else same as storage)
+ */
+template <class T, int C, int CP, class TI>
+__global__
+void pack_input( T *g_out,
+                 const TI *g_in,
+                 int width, int height,
+                 int in_stride ) {
+    int x = blockIdx.x*blockDim.x + threadIdx.x,
+        y = blockIdx.y*blockDim.y + threadIdx.y;
+    if (x >= width || y >= height) return;
+    const TI *p = g_in + y*in_stride + x*C;
+    T *q = g_out + (y*width+x)*CP;
+#pragma unroll
+    for (int c=0; c<CP; ++c)
+        store(q+c, c < C ? p[c] : (TI)0);
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Unpack an output image stored in half precision
+ *  @param[out] g_out The output image (in floats)
+ *  @param[in] g_in The plan output image (in halves)
+ *  @param[in] row_size Number of values per row (width times channels)
+ *  @param[in] height Image height (times batch)
+ *  @param[in] out_stride Output image stride (in floats)
+ *  @param[in] in_stride Plan output image stride (in halves)
+ */
+__global__
+void unpack_output( float *g_out,
+                    const __half *g_in,
+                    int row_size, int height,
+                    int out_stride, int in_stride ) {
+    int x = blockIdx.x*blockDim.x + threadIdx.x,
+        y = blockIdx.y*blockDim.y + threadIdx.y;
+    if (x >= row_size || y >= height) return;
+    g_out[y*out_stride+x] = __half2float(g_in[y*in_stride+x]);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Pack an input image in device memory into the plan
+ *  @param[in,out] plan The plan to receive the packed image
+ *  @param[in] d_src The input image in device memory
+ *  @param[in] in_stride The input image stride (in values)
+ *  @param[in] stream Stream to launch the packing kernel on
+ *  @tparam T Storage type (float, half, unsigned char or unsigned short)
+ *  @tparam TI Input type (float for float or half, else same as storage)
+ */
+template <class T, class TI>
+void pack_input( alg_plan& plan,
+                 const TI *d_src,
+                 int in_stride,
+                 cudaStream_t stream ) {
+    int rows = plan.height*plan.batch;
+    T *d_pack = (T *)&plan.d_pack;
+    dim3 grid((plan.width+WS-1)/WS, (rows+7)/8), block(WS, 8);
+    switch (plan.channels) {
+    case 1: pack_input<T,1,1,TI><<< grid, block, 0, stream >>>( d_pack, d_src, plan.width, rows, in_stride ); break;
+    case 2: pack_input<T,2,2,TI><<< grid, block, 0, stream >>>( d_pack, d_src, plan.width, rows, in_stride ); break;
+    case 3: pack_input<T,3,4,TI><<< grid, block, 0, stream >>>( d_pack, d_src, plan.width, rows, in_stride ); break;
+    case 4: pack_input<T,4,4,TI><<< grid, block, 0, stream >>>( d_pack, d_src, plan.width, rows, in_stride ); break;
+    }
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Copy a pitched image already in the array storage type to the plan
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] img The input 2D image (CP channels of type T per pixel)
+ *  @param[in] pitch The input image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the input image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ *  @tparam T Array storage type (float, half, unsigned char or unsigned short)
+ */
+template <class T>
+inline void copy_to_input( alg_plan& plan,
+                           const T *img,
+                           size_t pitch,
+                           cudaMemcpyKind kind,
+                           cudaStream_t stream ) {
+    int cp = plan.channels == 3 ? 4 : plan.channels; // array channels
+    size_t row_size = plan.width*cp*sizeof(T);
+    if (plan.layered) {
+        cudaMemcpy3DParms parms = {0};
+        parms.srcPtr = make_cudaPitchedPtr((void *)img, pitch,
+                                           plan.width, plan.height);
+        parms.dstArray = plan.a_in;
+        parms.extent = make_cudaExtent(plan.width, plan.height, plan.batch);
+        parms.kind = kind;
+        if (stream) cudaMemcpy3DAsync(&parms, stream);
+        else cudaMemcpy3D(&parms);
+    } else if (stream) {
+        cudaMemcpy2DToArrayAsync(plan.a_in, 0, 0, img, pitch,
+                                 row_size, plan.height, kind, stream);
+    } else {
+        cudaMemcpy2DToArray(plan.a_in, 0, 0, img, pitch,
+                            row_size, plan.height, kind);
+    }
+    check_cuda_error("Error uploading input image");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a pitched input image to the plan
+ *
+ *  This avoids the host round trip when the input image is already
+ *  in device memory (the default), still it also accepts any other
+ *  memory copy kind.  Given a stream, the copy is asynchronous and
+ *  ordered in that stream (host memory should then be pinned).
+ *  Multi-channel input images are interleaved, thus each pitch row
+ *  holds width times channels floats.  In-place plans receive the
+ *  input image in their output (see prepare_inplace()).
+ *
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] img The input 2D image (in device memory by default)
+ *  @param[in] pitch The input image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the input image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void upload( alg_plan& plan,
+                    const float *img,
+                    size_t pitch,
+                    cudaMemcpyKind kind=cudaMemcpyDeviceToDevice,
+                    cudaStream_t stream=0 ) {
+    if (plan.in_format != PIXEL_FLOAT)
+        throw std::runtime_error("Input image format differs from plan input format");
+    if (plan.inplace) { // the input is read from the output (no input array)
+        size_t row_size = plan.width*plan.channels*sizeof(float);
+        if (stream)
+            cudaMemcpy2DAsync(output_ptr(plan), plan.stride_img*plan.channels*sizeof(float),
+                              img, pitch, row_size, plan.height*plan.batch,
+                              kind, stream);
+        else
+            cudaMemcpy2D(output_ptr(plan), plan.stride_img*plan.channels*sizeof(float),
+                         img, pitch, row_size, plan.height*plan.batch, kind);
+        check_cuda_error("Error uploading input image");
+        return;
+    }
+    int cp = plan.channels == 3 ? 4 : plan.channels; // array channels
+    if (plan.half || plan.channels == 3) { // pack in device memory first
+        int rows = plan.height*plan.batch;
+        const float *d_src = img;
+        dvector<float> d_tmp;
+        d_tmp.set_stream(stream); // freed while packing (see cuda_pool)
+        if (kind != cudaMemcpyDeviceToDevice) {
+            size_t in_row = plan.width*plan.channels*sizeof(float);
+            d_tmp.resize(rows*plan.width*plan.channels);
+            if (stream)
+                cudaMemcpy2DAsync(&d_tmp, in_row, img, pitch, in_row, rows, kind, stream);
+            else
+                cudaMemcpy2D(&d_tmp, in_row, img, pitch, in_row, rows, kind);
+            d_src = &d_tmp;
+            pitch = in_row;
+        }
+        if (plan.half) {
+            pack_input<__half>(plan, d_src, pitch/sizeof(float), stream);
+            copy_to_input(plan, (const __half *)&plan.d_pack,
+                          plan.width*cp*sizeof(__half),
+                          cudaMemcpyDeviceToDevice, stream);
+        } else {
+            pack_input<float>(plan, d_src, pitch/sizeof(float), stream);
+            copy_to_input(plan, (const float *)&plan.d_pack,
+                          plan.width*cp*sizeof(float),
+                          cudaMemcpyDeviceToDevice, stream);
+        }
+        return;
+    }
+    copy_to_input(plan, img, pitch, kind, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a pitched integer input image to the plan
+ *
+ *  Same as upload() of floats for plans of integer input format (see
+ *  prepare_formats()), the image is copied as is (four times fewer
+ *  bytes than floats for 8-bit images) and read normalized.
+ *
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] img The input 2D image (in device memory by default)
+ *  @param[in] pitch The input image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the input image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ *  @tparam T Input type (unsigned char or unsigned short)
+ */
+template <class T>
+inline void upload_integer( alg_plan& plan,
+                            const T *img,
+                            size_t pitch,
+                            cudaMemcpyKind kind,
+                            cudaStream_t stream ) {
+    if (plan.in_format != (sizeof(T) == 1 ? PIXEL_UINT8 : PIXEL_UINT16))
+        throw std::runtime_error("Input image format differs from plan input format");
+    if (plan.channels == 3) { // pad in device memory first
+        int rows = plan.height*plan.batch;
+        const T *d_src = img;
+        dvector<T> d_tmp;
+        d_tmp.set_stream(stream); // freed while padding (see cuda_pool)
+        if (kind != cudaMemcpyDeviceToDevice) {
+            size_t in_row = plan.width*plan.channels*sizeof(T);
+            d_tmp.resize(rows*plan.width*plan.channels);
+            if (stream)
+                cudaMemcpy2DAsync(&d_tmp, in_row, img, pitch, in_row, rows, kind, stream);
+            else
+                cudaMemcpy2D(&d_tmp, in_row, img, pitch, in_row, rows, kind);
+            d_src = &d_tmp;
+            pitch = in_row;
+        }
+        pack_input<T>(plan, d_src, pitch/sizeof(T), stream);
+        copy_to_input(plan, (const T *)&plan.d_pack, plan.width*4*sizeof(T),
+                      cudaMemcpyDeviceToDevice, stream);
+        return;
+    }
+    copy_to_input(plan, img, pitch, kind, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a pitched 8-bit input image to the plan
+ *  @see upload_integer()
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] img The input 2D image (in device memory by default)
+ *  @param[in] pitch The input image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the input image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void upload( alg_plan& plan,
+                    const unsigned char *img,
+                    size_t pitch,
+                    cudaMemcpyKind kind=cudaMemcpyDeviceToDevice,
+                    cudaStream_t stream=0 ) {
+    upload_integer(plan, img, pitch, kind, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a pitched 16-bit input image to the plan
+ *  @see upload_integer()
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] img The input 2D image (in device memory by default)
+ *  @param[in] pitch The input image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the input image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void upload( alg_plan& plan,
+                    const unsigned short *img,
+                    size_t pitch,
+                    cudaMemcpyKind kind=cudaMemcpyDeviceToDevice,
+                    cudaStream_t stream=0 ) {
+    upload_integer(plan, img, pitch, kind, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload an 8-bit input image in host memory to the plan
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] h_img The input 2D image(s) in host memory
+ */
+inline void upload( alg_plan& plan,
+                    const unsigned char *h_img ) {
+    upload(plan, h_img, plan.width*plan.channels*sizeof(unsigned char),
+           cudaMemcpyHostToDevice);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload a 16-bit input image in host memory to the plan
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] h_img The input 2D image(s) in host memory
+ */
+inline void upload( alg_plan& plan,
+                    const unsigned short *h_img ) {
+    upload(plan, h_img, plan.width*plan.channels*sizeof(unsigned short),
+           cudaMemcpyHostToDevice);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload an input image in host memory to the plan
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] h_img The input 2D image(s) in host memory
+ */
+inline void upload( alg_plan& plan,
+                    const float *h_img ) {
+    upload(plan, h_img, plan.width*plan.channels*sizeof(float),
+           cudaMemcpyHostToDevice);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Upload an input image in device memory to the plan
+ *  @param[in,out] plan The plan to receive the input image
+ *  @param[in] d_img The input 2D image in device memory
+ *  @param[in] stride The input image stride in floats (zero means image width times channels)
+ */
+inline void upload( alg_plan& plan,
+                    const dvector<float>& d_img,
+                    int stride=0 ) {
+    if (stride == 0) stride = plan.width*plan.channels;
+    if (d_img.size() < (size_t)stride*plan.height*plan.batch)
+        throw std::runtime_error("Input image smaller than plan image");
+    upload(plan, &d_img, stride*sizeof(float));
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan output image to a pitched image
+ *
+ *  This avoids the host round trip when the output image is to stay
+ *  in device memory (the default), still it also accepts any other
+ *  memory copy kind.  Given a stream, the copy is asynchronous and
+ *  ordered in that stream (host memory should then be pinned).  A
+ *  half plan output is converted back to single precision.
+ *
+ *  @param[in] plan The plan with the output image
+ *  @param[out] img The output 2D image (in device memory by default)
+ *  @param[in] pitch The output image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the output image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void download( const alg_plan& plan,
+                      float *img,
+                      size_t pitch,
+                      cudaMemcpyKind kind=cudaMemcpyDeviceToDevice,
+                      cudaStream_t stream=0 ) {
+    if (plan.out_format != PIXEL_FLOAT)
+        throw std::runtime_error("Output image format differs from plan output format");
+    size_t stride_size = plan.stride_img*plan.channels*sizeof(float),
+        row_size = plan.out_width*plan.channels*sizeof(float);
+    if (plan.half) { // unpack in device memory first
+        int rows = plan.out_height*plan.batch, row_len = plan.out_width*plan.channels;
+        dim3 grid((row_len+WS-1)/WS, (rows+7)/8), block(WS, 8);
+        if (kind == cudaMemcpyDeviceToDevice) {
+            unpack_output<<< grid, block, 0, stream >>>
+                ( img, &plan.d_himg, row_len, rows, pitch/sizeof(float),
+                  plan.stride_img*plan.channels );
+            check_cuda_error("Error downloading output image");
+            return;
+        }
+        dvector<float> d_tmp(rows*row_len);
+        d_tmp.set_stream(stream);
+        unpack_output<<< grid, block, 0, stream >>>
+            ( &d_tmp, &plan.d_himg, row_len, rows, row_len,
+              plan.stride_img*plan.channels );
+        cudaMemcpy2DAsync(img, pitch, &d_tmp, row_size, row_size, rows,
+                          kind, stream);
+        check_cuda_error("Error downloading output image");
+        return; // the reuse of d_tmp waits for the copy (see cuda_pool)
+    }
+    if (stream)
+        cudaMemcpy2DAsync(img, pitch, output_ptr(plan), stride_size,
+                          row_size, plan.out_height*plan.batch, kind, stream);
+    else
+        cudaMemcpy2D(img, pitch, output_ptr(plan), stride_size,
+                     row_size, plan.out_height*plan.batch, kind);
+    check_cuda_error("Error downloading output image");
+}
+
+/// Function called with a plan before its output is downloaded to the host
+typedef void (*download_hook_t)( const alg_plan& plan );
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Hook called with each plan before its download to host memory
+ *
+ *  A check of the output against a reference (see gpu_reference)
+ *  reads it in device memory before it leaves the GPU.
+ *
+ *  @return The hook (zero for none)
+ */
+inline download_hook_t& download_hook() {
+    static download_hook_t hook = 0;
+    return hook;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan output image to host memory
+ *  @param[in] plan The plan with the output image
+ *  @param[out] h_img The output 2D image(s) in host memory
+ */
+inline void download( const alg_plan& plan,
+                      float *h_img ) {
+    if (download_hook()) download_hook()(plan);
+    download(plan, h_img, plan.out_width*plan.channels*sizeof(float),
+             cudaMemcpyDeviceToHost);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan output image to device memory
+ *  @param[in] plan The plan with the output image
+ *  @param[out] d_img The output 2D image in device memory
+ *  @param[in] stride The output image stride in floats (zero means image width times channels)
+ */
+inline void download( const alg_plan& plan,
+                      dvector<float>& d_img,
+                      int stride=0 ) {
+    if (stride == 0) stride = plan.out_width*plan.channels;
+    if (d_img.size() < (size_t)stride*plan.out_height*plan.batch)
+        d_img.resize(stride*plan.out_height*plan.batch);
+    download(plan, &d_img, stride*sizeof(float));
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan integer output image to a pitched image
+ *
+ *  Same as download() of floats for plans of integer output format
+ *  (see prepare_formats()), the output is already quantized thus it
+ *  is copied as is.
+ *
+ *  @param[in] plan The plan with the output image
+ *  @param[in] d_out The plan output image (of the plan output format)
+ *  @param[out] img The output 2D image (in device memory by default)
+ *  @param[in] pitch The output image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the output image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ *  @tparam T Output type (unsigned char or unsigned short)
+ */
+template <class T>
+inline void download_integer( const alg_plan& plan,
+                              const dvector<T>& d_out,
+                              T *img,
+                              size_t pitch,
+                              cudaMemcpyKind kind,
+                              cudaStream_t stream ) {
+    if (plan.out_format != (sizeof(T) == 1 ? PIXEL_UINT8 : PIXEL_UINT16))
+        throw std::runtime_error("Output image format differs from plan output format");
+    size_t stride_size = plan.stride_img*plan.channels*sizeof(T),
+        row_size = plan.out_width*plan.channels*sizeof(T);
+    if (stream)
+        cudaMemcpy2DAsync(img, pitch, &d_out, stride_size,
+                          row_size, plan.out_height*plan.batch, kind, stream);
+    else
+        cudaMemcpy2D(img, pitch, &d_out, stride_size,
+                     row_size, plan.out_height*plan.batch, kind);
+    check_cuda_error("Error downloading output image");
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan 8-bit output image to a pitched image
+ *  @see download_integer()
+ *  @param[in] plan The plan with the output image
+ *  @param[out] img The output 2D image (in device memory by default)
+ *  @param[in] pitch The output image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the output image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void download( const alg_plan& plan,
+                      unsigned char *img,
+                      size_t pitch,
+                      cudaMemcpyKind kind=cudaMemcpyDeviceToDevice,
+                      cudaStream_t stream=0 ) {
+    download_integer(plan, plan.d_img8, img, pitch, kind, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan 16-bit output image to a pitched image
+ *  @see download_integer()
+ *  @param[in] plan The plan with the output image
+ *  @param[out] img The output 2D image (in device memory by default)
+ *  @param[in] pitch The output image pitch in bytes (row size in memory)
+ *  @param[in] kind Memory copy kind (where the output image is)
+ *  @param[in] stream Stream to copy on (zero means synchronous copy)
+ */
+inline void download( const alg_plan& plan,
+                      unsigned short *img,
+                      size_t pitch,
+                      cudaMemcpyKind kind=cudaMemcpyDeviceToDevice,
+                      cudaStream_t stream=0 ) {
+    download_integer(plan, plan.d_img16, img, pitch, kind, stream);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan 8-bit output image to host memory
+ *  @param[in] plan The plan with the output image
+ *  @param[out] h_img The output 2D image(s) in host memory
+ */
+inline void download( const alg_plan& plan,
+                      unsigned char *h_img ) {
+    download(plan, h_img, plan.out_width*plan.channels*sizeof(unsigned char),
+             cudaMemcpyDeviceToHost);
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Download the plan 16-bit output image to host memory
+ *  @param[in] plan The plan with the output image
+ *  @param[out] h_img The output 2D image(s) in host memory
+ */
+inline void download( const alg_plan& plan,
+                      unsigned short *h_img ) {
+    download(plan, h_img, plan.out_width*plan.channels*sizeof(unsigned short),
+             cudaMemcpyDeviceToHost);
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GPUPLAN_H
+//==============================================================================
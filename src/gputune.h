@@ -0,0 +1,220 @@
+/**
+ *  @file gputune.h
+ *  @brief Tuned launch configurations per architecture, order and size
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef GPUTUNE_H
+#define GPUTUNE_H
+
+//== INCLUDES ==================================================================
+
+#include <map>
+#include <string>
+#include <fstream>
+#include <cstdlib>
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== CLASS DEFINITION ==========================================================
+
+/**
+ *  @struct tune_config gputune.h
+ *  @ingroup api_gpu
+ *  @brief Launch configuration of the block-based algorithms 5 and 6
+ *
+ *  The number of warps collecting carries (step 1) and writing
+ *  results (last step) are chosen among the compiled ones, see
+ *  is_tuned_warps(), and the cache preference of the carry adjusting
+ *  steps 2 and 4 (alg3v4v5v6_step2v4()) is any of the CUDA ones.  The
+ *  default configuration is the one of the launch constants in
+ *  gpudefs.h (tuned on Pascal).
+ */
+struct tune_config {
+
+    int nwc; ///< # of warps collect carries
+    int nww; ///< # of warps write results
+    cudaFuncCache cache2; ///< Cache preference of carry adjusting steps
+
+    /// Default constructor
+    tune_config() : nwc(NWC), nww(NWW), cache2(cudaFuncCachePreferNone) { }
+
+};
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Check if a number of warps has compiled kernels to launch
+ *  @param[in] nw Number of warps per block
+ *  @return True if kernels are compiled with this number of warps
+ */
+inline bool is_tuned_warps( int nw ) {
+    return nw == 4 || nw == NWC || nw == NWW || nw == 8;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Default launch configuration of a filter order
+ *  @param[in] order Filter order
+ *  @return The default configuration (of the gpudefs.h constants)
+ */
+inline tune_config default_tuning( int order ) {
+    tune_config c;
+    c.cache2 = order == 1 ? cudaFuncCachePreferL1
+        : order == 2 ? cudaFuncCachePreferEqual : cudaFuncCachePreferShared;
+    return c;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute capability of the current device (e.g. 86 for sm_86)
+ *  @return The major times ten plus the minor compute capability
+ */
+inline int tune_arch() {
+    int dev = 0;
+    cudaDeviceProp prop;
+    cudaGetDevice(&dev);
+    if (cudaGetDeviceProperties(&prop, dev) != cudaSuccess)
+        return 0;
+    return prop.major*10 + prop.minor;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Number of multiprocessors of the current device
+ *  @return The multiprocessor count (one if unknown)
+ */
+inline int tune_sms() {
+    int dev = 0;
+    cudaDeviceProp prop;
+    cudaGetDevice(&dev);
+    if (cudaGetDeviceProperties(&prop, dev) != cudaSuccess)
+        return 1;
+    return prop.multiProcessorCount;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Size class of an image by its number of blocks
+ *
+ *  Each class holds images of up to four times more blocks than the
+ *  previous class, e.g. class 5 is from 1024x1024 up to 2048x2048
+ *  pixels.
+ *
+ *  @param[in] blocks Number of blocks (32x32) of the image
+ *  @return The size class
+ */
+inline int size_class( long blocks ) {
+    int c = 0;
+    while (blocks >= 4) { blocks /= 4; ++c; }
+    return c;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Name of the tuning cache file
+ *
+ *  The file is given by the GPUFILTER_TUNE environment variable,
+ *  otherwise it is gpufilter.tune in the working directory.
+ *
+ *  @return The tuning cache file name
+ */
+inline std::string tune_file() {
+    const char *f = getenv("GPUFILTER_TUNE");
+    return f ? f : "gpufilter.tune";
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Key of one tuning (architecture, order and size class)
+ *  @param[in] arch Compute capability (see tune_arch())
+ *  @param[in] order Filter order
+ *  @param[in] sclass Size class (see size_class())
+ *  @return The tuning key
+ */
+inline long tune_key( int arch, int order, int sclass ) {
+    return ((long)arch*16 + order)*64 + sclass;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Table of all tunings, loaded once from the tuning cache file
+ *
+ *  Each line of the file is one tuning: architecture, order, size
+ *  class, warps collecting carries, warps writing results and cache
+ *  preference (as the cudaFuncCache number).  Lines of warps not
+ *  compiled are ignored.
+ *
+ *  @return Reference to the tuning table
+ */
+inline std::map<long, tune_config>& tune_table() {
+    static std::map<long, tune_config> table;
+    static bool loaded = false;
+    if (!loaded) {
+        loaded = true;
+        std::ifstream in(tune_file().c_str());
+        int arch, order, sclass, cache;
+        tune_config c;
+        while (in >> arch >> order >> sclass >> c.nwc >> c.nww >> cache) {
+            if (!is_tuned_warps(c.nwc) || !is_tuned_warps(c.nww))
+                continue;
+            c.cache2 = (cudaFuncCache)cache;
+            table[tune_key(arch, order, sclass)] = c;
+        }
+    }
+    return table;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Find the tuned launch configuration for the current device
+ *  @param[in] order Filter order
+ *  @param[in] blocks Number of blocks (32x32) of the image
+ *  @return The tuned configuration (or the default one if not tuned)
+ */
+inline tune_config find_tuning( int order, long blocks ) {
+    static int arch = tune_arch();
+    std::map<long, tune_config>& table = tune_table();
+    std::map<long, tune_config>::const_iterator it =
+        table.find(tune_key(arch, order, size_class(blocks)));
+    return it == table.end() ? default_tuning(order) : it->second;
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Save a tuned launch configuration to the tuning cache file
+ *
+ *  The tuning replaces any previous one of the same key and the
+ *  whole table is written back to the file.
+ *
+ *  @param[in] order Filter order
+ *  @param[in] blocks Number of blocks (32x32) of the image
+ *  @param[in] c The tuned configuration
+ *  @return True if the file was written
+ */
+inline bool save_tuning( int order, long blocks,
+                         const tune_config& c ) {
+    static int arch = tune_arch();
+    std::map<long, tune_config>& table = tune_table();
+    table[tune_key(arch, order, size_class(blocks))] = c;
+    std::ofstream out(tune_file().c_str());
+    for (std::map<long, tune_config>::const_iterator it = table.begin();
+         it != table.end(); ++it) {
+        long k = it->first;
+        out << k/(64*16) << " " << (k/64)%16 << " " << k%64 << " "
+            << it->second.nwc << " " << it->second.nww << " "
+            << (int)it->second.cache2 << "\n";
+    }
+    return !out.fail();
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // GPUTUNE_H
+//==============================================================================
@@ -9,9 +9,12 @@
 #ifndef SAT_GPU_CUH
 #define SAT_GPU_CUH
 
-#define MST == // measure step time: no: == ; yes: >=
 #define LDG // uncomment to use __ldg
 
+//== INCLUDES ==================================================================
+
+#include "gpuplan.h"
+
 //== NAMESPACES ================================================================
 
 namespace gpufilter {
@@ -33,6 +36,7 @@ namespace gpufilter {
  *  idiosyncrasies and should not be used lightly.
  *
  *  @see [NehabEtAl:2011] cited in alg5()
+ *  @param[in] tex The input texture object
  *  @param[out] g_pybar All \f$P_{m,n}(Y)\f$
  *  @param[out] g_ptvhat All \f$P^T_{m,n}(V)\f$
  *  @param[in] inv_width Image width inversed (1/w)
@@ -44,7 +48,8 @@ namespace gpufilter {
  */
 template <bool BORDER, int R>
 __global__ __launch_bounds__(WS*NWC, NBCW)
-void sat_step1( Matrix<float,R,WS> *g_pybar,
+void sat_step1( cudaTextureObject_t tex,
+                Matrix<float,R,WS> *g_pybar,
                 Matrix<float,R,WS> *g_ptvhat,
                 float inv_width, float inv_height,
                 int m_size, int n_size ) {
@@ -53,9 +58,9 @@ void sat_step1( Matrix<float,R,WS> *g_pybar,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWW>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
+        read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     if (ty==0) {
@@ -64,7 +69,7 @@ void sat_step1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate pybar, scan left -> right
         for (int j=0; j<WS; ++j)
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
+            block[tx][j] = fwdI(p, block[tx][j], consts<R>().weights);
 
         g_pybar[m*(n_size+1)+n+1].set_col(tx, p);
 
@@ -72,7 +77,7 @@ void sat_step1( Matrix<float,R,WS> *g_pybar,
 
 #pragma unroll // calculate ptvhat, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            block[j][tx] = fwdI(p, block[j][tx], c_weights);
+            block[j][tx] = fwdI(p, block[j][tx], consts<R>().weights);
 
         g_ptvhat[n*(m_size+1)+m+1].set_col(tx, p);
 
@@ -132,16 +137,16 @@ void sat_step2( Matrix<float,R,WS> *g_pybar,
 
                 pybar = spybar[w].col(tx);
 
-                py = pybar + py * c_AbF_T;
+                py = pybar + py * consts<R>().AbF_T;
 
 #pragma unroll // computing corner rows south east
                 for (int i = 0; i < R; ++i) {
 #pragma unroll // computing corner cols south east
                     for (int j = 0; j < R; ++j) {
-                        float v = c_TAFB[i][tx] * py[j];
+                        float v = consts<R>().TAFB[i][tx] * py[j];
 #pragma unroll // recursive doubling by shuffle
                         for (int k = 1; k < WS; k *= 2) {
-                            float p = __shfl_up(v, k);
+                            float p = shfl_up(v, k);
                             if (tx >= k) {
                                 v += p;
                             }
@@ -240,9 +245,9 @@ void sat_step3( Matrix<float,R,WS> *g_ptvhat,
 
                 ptvhat = sptvhat[w].col(tx);
 
-                ptv = ptvhat + ptv * c_AbF_T;
+                ptv = ptvhat + ptv * consts<R>().AbF_T;
 
-                ptv += c_AFP_T.col(tx) * spysum[w];
+                ptv += consts<R>().AFP_T.col(tx) * spysum[w];
 
                 sptvhat[w].set_col(tx, ptv);
 
@@ -277,6 +282,7 @@ void sat_step3( Matrix<float,R,WS> *g_ptvhat,
  *  idiosyncrasies and should not be used lightly.
  *
  *  @see [NehabEtAl:2011] cited in alg5()
+ *  @param[in] tex The input texture object
  *  @param[out] g_out The output 2D image
  *  @param[in] g_py All \f$P_{m,n}(Y)\f$
  *  @param[in] g_ptv All \f$P^T_{m,n}(V)\f$
@@ -290,7 +296,8 @@ void sat_step3( Matrix<float,R,WS> *g_ptvhat,
  */
 template <bool BORDER, int R>
 __global__ __launch_bounds__(WS*NWW, NBCW)
-void sat_step4( float *g_out,
+void sat_step4( cudaTextureObject_t tex,
+                float *g_out,
                 const Matrix<float,R,WS> *g_py,
                 const Matrix<float,R,WS> *g_ptv,
                 float inv_width, float inv_height,
@@ -301,9 +308,9 @@ void sat_step4( float *g_out,
 
     __shared__ Matrix<float,WS,WS+1> block;
     if (BORDER) // read considering borders
-        read_block<NWW>(block, m-c_border, n-c_border, inv_width, inv_height);
+        read_block<NWW>(block, tex, m-c_border, n-c_border, inv_width, inv_height);
     else
-        read_block<NWW>(block, m, n, inv_width, inv_height);
+        read_block<NWW>(block, tex, m, n, inv_width, inv_height);
     __syncthreads();
 
     if (ty==0) {
@@ -320,7 +327,7 @@ void sat_step4( float *g_out,
 
 #pragma unroll // calculate block, scan left -> right
         for (int j=0; j<WS; ++j)
-            block[tx][j] = fwdI(p, block[tx][j], c_weights);
+            block[tx][j] = fwdI(p, block[tx][j], consts<R>().weights);
 
 #ifdef LDG
 #pragma unroll
@@ -332,7 +339,7 @@ void sat_step4( float *g_out,
 
 #pragma unroll // calculate block, scan top -> bottom
         for (int j=0; j<WS; ++j)
-            block[j][tx] = fwdI(p, block[j][tx], c_weights);
+            block[j][tx] = fwdI(p, block[j][tx], consts<R>().weights);
 
         if (BORDER) {
             if ((m >= c_border) && (m < m_size-c_border) && (n >= c_border) && (n < n_size-c_border)) {
@@ -355,16 +362,32 @@ void sat_step4( float *g_out,
 }
 
 /**
+ *  @struct sat_plan sat_gpu.cuh
  *  @ingroup api_gpu
- *  @brief Compute algorithm SAT in the GPU
+ *  @brief Filter plan of algorithm SAT
  *
- *  A SAT (Summed-Area Table) is also known as an Integral Image.
+ *  @note In this plan the big M is the number of column blocks
+ *  (height) and the big N is the number of row blocks (width), as
+ *  the SAT kernels expect.
  *
- *  @see [NehabEtAl:2011] cited in alg5()
- *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+struct sat_plan : public alg_plan {
+    Vector<float,R+1> w; ///< Filter weights
+    alg_matrices<R> mat; ///< Pre-computed basic matrices
+    dvector< Matrix<float,R,WS> > d_pybar, d_ptvhat; ///< Row and column carries
+    dvector< Matrix<float,R,R> > d_pysum; ///< Carries summed along rows
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare algorithm SAT plan in the GPU
+ *
+ *  @param[out] plan The plan to prepare
  *  @param[in] width Image width
  *  @param[in] height Image height
- *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
  *  @param[in] w Filter weights (feedforward and feedback coefficients)
  *  @param[in] border Number of border blocks (32x32) outside image
  *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
@@ -373,91 +396,30 @@ void sat_step4( float *g_out,
  */
 template <bool BORDER, int R>
 __host__
-void sat_gpu( float *h_img,
-              int width, int height, int runtimes,
-              const Vector<float, R+1> &w,
-              int border=0,
-              BorderType border_type=CLAMP_TO_ZERO ) {
-
-    const int B = WS;
+void prepare_sat( sat_plan<BORDER,R>& plan,
+                  int width, int height,
+                  const Vector<float, R+1> &w,
+                  int border=0,
+                  BorderType btype=CLAMP_TO_ZERO ) {
 
-    // pre-compute basic alg3 matrices
-    Matrix<float,R,R> Ir = identity<float,R,R>();
-    Matrix<float,B,R> Zbr = zeros<float,B,R>();
-    Matrix<float,R,B> Zrb = zeros<float,R,B>();
-    Matrix<float,B,B> Ib = identity<float,B,B>();
+    if (!BORDER) { border = 0; btype = CLAMP_TO_ZERO; }
 
-    Matrix<float,R,B> AFP_T = fwd(Ir, Zrb, w);
-    Matrix<float,B,B> AFB_T = fwd(Zbr, Ib, w);
+    prepare_plan(plan, width, height, border, btype, BORDER);
+    std::swap(plan.m_size, plan.n_size);
 
-    Matrix<float,R,R> AbF_T = tail<R>(AFP_T);
+    plan.w = w;
+    calc_matrices(plan.mat, w);
 
-    Matrix<float,R,B> TAFB = transp(tail<R>(AFB_T));
-
-    int m_size = (height+WS-1)/WS, n_size = (width+WS-1)/WS;
-
-    if (BORDER) {
-        int border_left, border_top, border_right, border_bottom;
-        calc_borders(&border_left, &border_top, &border_right, &border_bottom, 
-                     width, height, border);
-        int ewidth = width+border_left+border_right,
-            eheight = height+border_top+border_bottom;
-
-        m_size = (eheight+WS-1)/WS;
-        n_size = (ewidth+WS-1)/WS;
-
-        copy_to_symbol(c_border, border);
-    }
-
-    // upload to the GPU
-    copy_to_symbol(c_weights, w);
-
-    copy_to_symbol(c_AbF_T, AbF_T);
-    copy_to_symbol(c_AFP_T, AFP_T);
-    copy_to_symbol(c_TAFB, TAFB);
-
-    float inv_width = 1.f/width, inv_height = 1.f/height;
-
-    cudaArray *a_in;
-    cudaChannelFormatDesc ccd = cudaCreateChannelDesc<float>();
-    cudaMallocArray(&a_in, &ccd, width, height);
-    cudaMemcpyToArray(a_in, 0, 0, h_img, width*height*sizeof(float),
-                      cudaMemcpyHostToDevice);
-
-    t_in.normalized = true;
-    t_in.filterMode = cudaFilterModePoint;
-    t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-
-    if (BORDER) {
-        switch(border_type) {
-        case CLAMP_TO_ZERO:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeBorder;
-            break;
-        case CLAMP_TO_EDGE:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeClamp;
-            break;
-        case REPEAT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeWrap;
-            break;
-        case REFLECT:
-            t_in.addressMode[0] = t_in.addressMode[1] = cudaAddressModeMirror;
-            break;
-        }
-    }
-
-    int stride_img = width+WS;
-    if (BORDER) stride_img = width+WS*border+WS;
-
-    dvector<float> d_img(height*stride_img);
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
     // +1 padding is important even in zero-border to avoid if's in kernels
-    dvector< Matrix<float,R,B> >
-        d_pybar(m_size*(n_size+1)), d_ptvhat(n_size*(m_size+1));
-    d_pybar.fillzero();
-    d_ptvhat.fillzero();
+    plan.d_pybar.resize(m_size*(n_size+1));
+    plan.d_ptvhat.resize(n_size*(m_size+1));
+    plan.d_pybar.fillzero();
+    plan.d_ptvhat.fillzero();
 
-    dvector< Matrix<float,R,R> > d_pysum(m_size*(n_size+1));
-    d_pysum.fillzero();
+    plan.d_pysum.resize(m_size*(n_size+1));
+    plan.d_pysum.fillzero();
 
     cudaFuncSetCacheConfig(sat_step1<BORDER,R>, cudaFuncCachePreferShared);
     cudaFuncSetCacheConfig(sat_step4<BORDER,R>, cudaFuncCachePreferShared);
@@ -470,66 +432,122 @@ void sat_gpu( float *h_img,
     else if (R >= 3)
         cudaFuncSetCacheConfig(sat_step2<R>, cudaFuncCachePreferShared);
 
-    double te[4] = {0, 0, 0, 0}; // time elapsed for the four steps
-    base_timer *timer[4];
-    for (int i = 0; i < 4; ++i)
-        timer[i] = new gpu_timer(0, "", false);
+}
 
-    base_timer &timer_total = timers.gpu_add("sat_gpu", width*height, "iP");
+/**
+ *  @ingroup api_gpu
+ *  @brief Run algorithm SAT plan in the GPU
+ *
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional four timers to measure each step
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+__host__
+void sat_gpu( sat_plan<BORDER,R>& plan,
+              base_timer **timer=0 ) {
 
-    for(int r = 0; r < runtimes; ++r) {
+    if (make_current(plan)) {
+        copy_to_symbol(c_border, plan.border);
+        copy_to_constants(&filter_constants<R>::weights, plan.w);
 
-        if (runtimes MST 1) { timer[0]->start(); }
+        copy_to_constants(&filter_constants<R>::AbF_T, plan.mat.AbF_T);
+        copy_to_constants(&filter_constants<R>::AFP_T, plan.mat.AFP_T);
+        copy_to_constants(&filter_constants<R>::TAFB, plan.mat.TAFB);
+    }
 
-        cudaBindTextureToArray(t_in, a_in);
+    const int m_size = plan.m_size, n_size = plan.n_size;
 
-        sat_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC) >>>
-            ( &d_pybar, &d_ptvhat, inv_width, inv_height, m_size, n_size );
+    if (timer) timer[0]->start();
 
-        if (runtimes MST 1) { timer[0]->stop(); te[0] += timer[0]->elapsed(); timer[1]->start(); }
+    sat_step1<BORDER><<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_pybar, &plan.d_ptvhat, plan.inv_width, plan.inv_height, m_size, n_size );
 
-        sat_step2<<< dim3(m_size, 1), dim3(WS, NWA) >>>
-            ( &d_pybar, &d_pysum, n_size );
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
 
-        if (runtimes MST 1) { timer[1]->stop(); te[1] += timer[1]->elapsed(); timer[2]->start(); }
+    sat_step2<<< dim3(m_size, 1), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_pybar, &plan.d_pysum, n_size );
 
-        sat_step3<<< dim3(1, n_size), dim3(WS, NWA) >>>
-            ( &d_ptvhat, &d_pysum, m_size, n_size );
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
+
+    sat_step3<<< dim3(1, n_size), dim3(WS, NWA), 0, plan.stream >>>
+        ( &plan.d_ptvhat, &plan.d_pysum, m_size, n_size );
         
-        if (runtimes MST 1) { timer[2]->stop(); te[2] += timer[2]->elapsed(); timer[3]->start(); }
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
 
-        sat_step4<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW) >>>
-            ( d_img, &d_pybar, &d_ptvhat, inv_width, inv_height,
-              m_size, n_size, stride_img );
+    sat_step4<BORDER><<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, plan.d_img, &plan.d_pybar, &plan.d_ptvhat, plan.inv_width, plan.inv_height,
+          m_size, n_size, plan.stride_img );
 
-        cudaUnbindTexture(t_in);
+    if (timer) timer[3]->stop();
 
-        if (runtimes MST 1) { timer[3]->stop(); te[3] += timer[3]->elapsed(); }
+}
 
-    }
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute algorithm SAT in the GPU
+ *
+ *  A SAT (Summed-Area Table) is also known as an Integral Image.
+ *
+ *  @see [NehabEtAl:2011] cited in alg5()
+ *  @param[in,out] h_img The in(out)put 2D image to filter in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @param[in] w Filter weights (feedforward and feedback coefficients)
+ *  @param[in] border Number of border blocks (32x32) outside image
+ *  @param[in] btype Border type (either zero, clamp, repeat or reflect)
+ *  @tparam BORDER Flag to consider border input padding
+ *  @tparam R Filter order
+ */
+template <bool BORDER, int R>
+__host__
+void sat_gpu( float *h_img,
+              int width, int height, int runtimes,
+              const Vector<float, R+1> &w,
+              int border=0,
+              BorderType border_type=CLAMP_TO_ZERO ) {
+
+    sat_plan<BORDER,R> plan;
+    prepare_sat(plan, width, height, w, border, border_type);
+
+    upload(plan, h_img);
+
+    const char *steps[4] = { "step 1", "step 2", "step 3", "step 4" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[4];
+    for (int i = 0; i < 4; ++i)
+        timer[i] = new step_timer(std::string("sat_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("sat_gpu", width*height, "iP");
+
+    for(int r = 0; r < runtimes; ++r)
+        sat_gpu(plan, timed ? timer : 0);
 
     timer_total.stop();
 
+    for (int i = 0; i < 4; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
     if (runtimes > 1) {
 
-        if (runtimes MST 1) {
+        if (timed) {
             for (int i = 0; i < 4; ++i)
-                std::cout << std::fixed << " " << te[i]/(double)runtimes << std::flush;
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
         } else {
             std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
         }
 
     } else {
 
-        timers.gpu_add("step 1", timer[0]);
-        timers.gpu_add("step 2", timer[1]);
-        timers.gpu_add("step 3", timer[2]);
-        timers.gpu_add("step 4", timer[3]);
         timers.flush();
 
     }
 
-    cudaMemcpy2D(h_img, width*sizeof(float), d_img, stride_img*sizeof(float), width*sizeof(float), height, cudaMemcpyDeviceToHost);
+    download(plan, h_img);
 
 }
 
@@ -0,0 +1,149 @@
+/**
+ *  @file sat_moments.cu
+ *  @brief Summed-area tables of sums and sums of squares in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#define APPNAME "[sat_moments]"
+
+//== INCLUDES ==================================================================
+
+#include <cmath>
+#include <cfloat>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+
+#include <util/error.h>
+#include <util/symbol.h>
+#include <util/dvector.h>
+#include <util/timer.h>
+
+#include "sat_moments_gpu.cuh"
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup api_cpu
+ *  @brief Compute the summed-area tables of sums and sums of squares in the CPU (reference)
+ *  @param[out] h_sat The output tables (2*channels tables of width x height)
+ *  @param[in] h_img The input 2D image (interleaved channels)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels
+ */
+void sat_moments_cpu( unsigned long long *h_sat,
+                      const unsigned char *h_img,
+                      int width, int height, int channels ) {
+
+    for (int k = 0; k < 2; ++k) {
+        for (int c = 0; c < channels; ++c) {
+            unsigned long long *sat = h_sat + (size_t)(k*channels+c)*width*height;
+            for (int y = 0; y < height; ++y) {
+                unsigned long long row = 0;
+                for (int x = 0; x < width; ++x) {
+                    unsigned long long v = h_img[(y*width+x)*channels+c];
+                    row += k ? v*v : v;
+                    sat[y*width+x] = row + (y > 0 ? sat[(y-1)*width+x] : 0);
+                }
+            }
+        }
+    }
+
+}
+
+/**
+ *  @brief Compute the tables in the GPU and check them against the CPU
+ *  @param[in] ref The reference tables
+ *  @param[in] img The input 2D image (interleaved channels)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels
+ *  @param[in] runtimes Number of run times
+ *  @param[out] me Maximum error
+ *  @param[out] mre Maximum relative error
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+void run( const std::vector< unsigned long long >& ref,
+          const std::vector< unsigned char >& img,
+          int width, int height, int channels, int runtimes,
+          double& me, double& mre ) {
+
+    std::vector< T > sat(ref.size());
+
+    gpufilter::sat_moments_gpu<T, 2>(&sat[0], &img[0], width, height,
+                                     channels, runtimes);
+
+    me = mre = 0.;
+    for (size_t i = 0; i < ref.size(); ++i) {
+        double r = (double)ref[i], e = std::abs((double)sat[i] - r);
+        if (e > me) me = e;
+        if (r > 0. && e/r > mre) mre = e/r;
+    }
+
+}
+
+// Main ------------------------------------------------------------------------
+
+int main( int argc, char** argv ) {
+
+    int width = 1024, height = 1024, channels = 1, runtimes = 1, type = 0;
+    double me = 0., mre = 0.;
+
+    if ((argc > 1 && argc < 3) ||
+        (argc >= 3 && (sscanf(argv[1], "%d", &width) != 1 ||
+                       sscanf(argv[2], "%d", &height) != 1)) ||
+        (argc >= 4 && (sscanf(argv[3], "%d", &channels) != 1 ||
+                       channels < 1 || channels > 4)) ||
+        (argc >= 5 && sscanf(argv[4], "%d", &runtimes) != 1) ||
+        (argc >= 6 && (sscanf(argv[5], "%d", &type) != 1 ||
+                       type < 0 || type > 2))) {
+        std::cerr << APPNAME << " Bad arguments!\n";
+        std::cout << APPNAME << " Usage: " << argv[0]
+                  << " [width height [channels [runtimes [type]]]]\n";
+        std::cout << APPNAME << " Types: 0 uint64, 1 double, 2 float\n";
+        return 1;
+    }
+
+    const char *type_names[3] = { "uint64", "double", "float" };
+
+    std::vector< unsigned char > img(width*height*channels);
+    std::vector< unsigned long long > ref(2*channels*width*height);
+
+    srand( 1234 );
+    for (size_t i = 0; i < img.size(); ++i)
+        img[i] = rand() % 256;
+
+    if (runtimes == 1) { // running for debugging
+        std::cout << APPNAME << " Size: " << width << " x " << height
+                  << "  Channels: " << channels << "  Run-times: 1\n";
+        std::cout << APPNAME << " Input: uint8  Tables: sum and sum of squares  Type: "
+                  << type_names[type] << "\n";
+        std::cout << APPNAME << " (1) Runs the reference in the CPU (ref)\n";
+        std::cout << APPNAME << " (2) Runs the tables in the GPU (res)\n";
+        std::cout << APPNAME << " (3) Checks computations (ref x res)\n";
+    }
+
+    sat_moments_cpu(&ref[0], &img[0], width, height, channels);
+
+    if (type == 0)
+        run<unsigned long long>(ref, img, width, height, channels, runtimes, me, mre);
+    else if (type == 1)
+        run<double>(ref, img, width, height, channels, runtimes, me, mre);
+    else
+        run<float>(ref, img, width, height, channels, runtimes, me, mre);
+
+    if (runtimes == 1) // running for debugging
+        std::cout << APPNAME << " [max-error] [max-relative-error]:";
+
+    std::cout << " " << std::scientific << me << " "
+              << std::scientific << mre << "\n";
+
+    return 0;
+
+}
@@ -0,0 +1,481 @@
+/**
+ *  @file sat_moments_gpu.cuh
+ *  @brief Multi-output summed-area tables (sums and sums of squares) in the GPU
+ *  @author Andre Maximo
+ *  @date Oct, 2026
+ *  @copyright The MIT License
+ */
+
+#ifndef SAT_MOMENTS_GPU_CUH
+#define SAT_MOMENTS_GPU_CUH
+
+//== INCLUDES ==================================================================
+
+#include <vector>
+
+#include "gpuplan.h"
+
+//== NAMESPACES ================================================================
+
+namespace gpufilter {
+
+//== IMPLEMENTATION ============================================================
+
+/**
+ *  @ingroup gpu
+ *  @brief Convert an input texel to the table accumulator type
+ *
+ *  Integer accumulators round the texel to the nearest integer, the
+ *  input array is single precision thus integer inputs up to
+ *  \f$2^{24}\f$ (e.g. uint8 and uint16 images) are exact.
+ *
+ *  @param[in] x The input texel
+ *  @return The texel in the accumulator type
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__device__ inline
+T moment_value( const float& x ) { return (T)x; }
+
+template <>
+__device__ inline
+unsigned int moment_value<unsigned int>( const float& x ) {
+    return __float2uint_rn(x);
+}
+
+template <>
+__device__ inline
+unsigned long long moment_value<unsigned long long>( const float& x ) {
+    return __float2ull_rn(x);
+}
+
+template <int W, int C, class T>
+__device__ // fill block with the moment k (1 or 2) of one channel c of the texels read
+void fill_moment_block( T (*block)[WS+1],
+                        const float *texels,
+                        const int& c, const int& k ) {
+    int tx = threadIdx.x, ty = threadIdx.y;
+#pragma unroll
+    for (int i=0; i<TPT(W); ++i) {
+        if (i*W+ty < WS) {
+            T v = moment_value<T>(texels[i*C+c]);
+            block[i*W+ty][tx] = k ? v*v : v;
+        }
+    }
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Summed-area tables of moments step 1
+ *
+ *  In parallel for all \f$m\f$ and \f$n\f$, load block
+ *  \f$B_{m,n}(X)\f$ once for all channels and, for each table (a
+ *  moment of a channel), compute and store the sum of each row and
+ *  of each column of the block.  Table \f$t = kC+c\f$ is the moment
+ *  \f$k+1\f$ (sum or sum of squares) of channel \f$c\f$.
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[out] g_rows Row sums of all blocks of all tables
+ *  @param[out] g_cols Column sums of all blocks of all tables
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ *  @tparam C Number of channels (1 to 4)
+ */
+template <class T, int K, int C>
+__global__ __launch_bounds__(WS*NWC)
+void sat_moments_step1( cudaTextureObject_t tex,
+                        T *g_rows, T *g_cols,
+                        float inv_width, float inv_height,
+                        int m_size, int n_size ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+
+    float texels[C*TPT(NWC)];
+    read_texels<NWC,C>(texels, tex, m, n, 0, inv_width, inv_height);
+
+    __shared__ T block[WS][WS+1];
+
+#pragma unroll
+    for (int k=0; k<K; ++k) {
+#pragma unroll
+        for (int c=0; c<C; ++c) {
+
+            fill_moment_block<NWC,C>(block, texels, c, k);
+            __syncthreads();
+
+            if (ty==0) {
+                T sr = (T)0, sc = (T)0;
+#pragma unroll
+                for (int j=0; j<WS; ++j) {
+                    sr += block[tx][j];
+                    sc += block[j][tx];
+                }
+                int b = ((k*C+c)*n_size+n)*m_size+m;
+                g_rows[b*WS+tx] = sr;
+                g_cols[b*WS+tx] = sc;
+            }
+            __syncthreads();
+
+        }
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Summed-area tables of moments step 2
+ *
+ *  In parallel for all \f$n\f$ and tables, sequentially for each
+ *  \f$m\f$, replace the row sums by their exclusive prefix along the
+ *  block row (the sums of all pixels left of the block) and store
+ *  the total of these prefixes per block (the sum of all pixels left
+ *  of the block in the block row).
+ *
+ *  @param[in,out] g_rows Row sums of all blocks of all tables
+ *  @param[out] g_ptot Row prefixes totals of all blocks of all tables
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__global__ __launch_bounds__(WS)
+void sat_moments_step2( T *g_rows, T *g_ptot,
+                        int m_size, int n_size ) {
+
+    int tx = threadIdx.x, n = blockIdx.x, t = blockIdx.y;
+
+    __shared__ T s_p[WS];
+
+    T acc = (T)0;
+    for (int m=0, b=(t*n_size+n)*m_size; m<m_size; ++m, ++b) {
+        T s = g_rows[b*WS+tx];
+        g_rows[b*WS+tx] = acc;
+        s_p[tx] = acc;
+        acc += s;
+        __syncthreads();
+        if (tx==0) {
+            T p = (T)0;
+#pragma unroll
+            for (int j=0; j<WS; ++j)
+                p += s_p[j];
+            g_ptot[b] = p;
+        }
+        __syncthreads();
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Summed-area tables of moments step 3
+ *
+ *  In parallel for all \f$m\f$ and tables, sequentially for each
+ *  \f$n\f$, replace the column sums by their exclusive prefix along
+ *  the block column (the sums of all pixels above the block) and
+ *  store the block corner (the sum of all pixels above and left of
+ *  the block) as the exclusive prefix of the row prefixes totals.
+ *
+ *  @param[in,out] g_cols Column sums of all blocks of all tables
+ *  @param[in] g_ptot Row prefixes totals of all blocks of all tables
+ *  @param[out] g_corner Corners of all blocks of all tables
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ */
+template <class T>
+__global__ __launch_bounds__(WS)
+void sat_moments_step3( T *g_cols, const T *g_ptot, T *g_corner,
+                        int m_size, int n_size ) {
+
+    int tx = threadIdx.x, m = blockIdx.x, t = blockIdx.y;
+
+    T acc = (T)0, corner = (T)0;
+    for (int n=0, b=t*n_size*m_size+m; n<n_size; ++n, b+=m_size) {
+        T s = g_cols[b*WS+tx];
+        g_cols[b*WS+tx] = acc;
+        acc += s;
+        if (tx==0) g_corner[b] = corner;
+        corner += g_ptot[b];
+    }
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Summed-area tables of moments step 4
+ *
+ *  In parallel for all \f$m\f$ and \f$n\f$, load block
+ *  \f$B_{m,n}(X)\f$ once for all channels and, for each table, add
+ *  the column prefixes (and the corner) to its first row, scan its
+ *  rows starting from the row prefixes and scan its columns writing
+ *  the table block.  Only the pixels inside the image are written,
+ *  each table is stored with a tight pitch (stride equal to width).
+ *
+ *  @param[in] tex The input texture object (layered)
+ *  @param[out] g_out The output tables (planar, one after the other)
+ *  @param[in] g_rows Row prefixes of all blocks of all tables
+ *  @param[in] g_cols Column prefixes of all blocks of all tables
+ *  @param[in] g_corner Corners of all blocks of all tables
+ *  @param[in] inv_width Image width inversed (1/w)
+ *  @param[in] inv_height Image height inversed (1/h)
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] m_size The big M (number of row blocks)
+ *  @param[in] n_size The big N (number of column blocks)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ *  @tparam C Number of channels (1 to 4)
+ */
+template <class T, int K, int C>
+__global__ __launch_bounds__(WS*NWW)
+void sat_moments_step4( cudaTextureObject_t tex,
+                        T *g_out,
+                        const T *g_rows, const T *g_cols, const T *g_corner,
+                        float inv_width, float inv_height,
+                        int width, int height,
+                        int m_size, int n_size ) {
+
+    int tx = threadIdx.x, ty = threadIdx.y, m = blockIdx.x, n = blockIdx.y;
+
+    float texels[C*TPT(NWW)];
+    read_texels<NWW,C>(texels, tex, m, n, 0, inv_width, inv_height);
+
+    __shared__ T block[WS][WS+1];
+
+    const int x = m*WS+tx, rows = min(WS, height-n*WS);
+
+#pragma unroll
+    for (int k=0; k<K; ++k) {
+#pragma unroll
+        for (int c=0; c<C; ++c) {
+
+            int t = k*C+c, b = (t*n_size+n)*m_size+m;
+
+            fill_moment_block<NWW,C>(block, texels, c, k);
+
+            if (ty==0) // the first row was filled by this same warp
+                block[0][tx] += g_cols[b*WS+tx] + (tx==0 ? g_corner[b] : (T)0);
+            __syncthreads();
+
+            if (ty==0) {
+                T acc = g_rows[b*WS+tx];
+#pragma unroll // scan left -> right
+                for (int j=0; j<WS; ++j) {
+                    acc += block[tx][j];
+                    block[tx][j] = acc;
+                }
+            }
+            __syncthreads();
+
+            if (ty==0 && x < width) {
+                T *out = g_out + (size_t)t*width*height + (size_t)n*WS*width + x;
+                T acc = (T)0;
+                for (int i=0; i<rows; ++i, out+=width) { // scan top -> bottom
+                    acc += block[i][tx];
+                    *out = acc;
+                }
+            }
+            __syncthreads();
+
+        }
+    }
+
+}
+
+/**
+ *  @struct sat_moments_plan sat_moments_gpu.cuh
+ *  @ingroup api_gpu
+ *  @brief Plan of the summed-area tables of moments
+ *
+ *  One run computes the summed-area tables of the K first moments
+ *  (the sum and the sum of squares) of all channels of the input
+ *  image, reading each texel twice (as algorithm SAT) for all
+ *  tables.  Integer accumulators are exact for integer inputs (up to
+ *  overflow: unsigned long long fits the sums of squares of 8k
+ *  uint16 images), double accumulators avoid the single-precision
+ *  error growing with the image size.  The tables stay in the plan
+ *  (in device memory), table \f$t = kC+c\f$ is the moment \f$k+1\f$ of
+ *  channel \f$c\f$.
+ *
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ */
+template <class T, int K>
+struct sat_moments_plan : public alg_plan {
+    dvector<T> d_sat; ///< Output tables (planar, tight width x height each)
+    dvector<T> d_rows, d_cols; ///< Row and column sums (then prefixes) per block
+    dvector<T> d_ptot, d_corner; ///< Row prefixes totals and corners per block
+};
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Prepare a summed-area tables of moments plan in the GPU
+ *
+ *  @param[out] plan The plan to prepare
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ */
+template <class T, int K>
+__host__
+void prepare_sat_moments( sat_moments_plan<T,K>& plan,
+                          int width, int height,
+                          int channels=1 ) {
+
+    prepare_plan(plan, width, height, 0, CLAMP_TO_ZERO, false, 1, channels,
+                 false, true);
+    plan.d_img.resize(0); // the tables are the output
+
+    const int tables = K*channels, blocks = tables*plan.m_size*plan.n_size;
+
+    plan.d_sat.resize((size_t)tables*width*height);
+    plan.d_rows.resize(blocks*WS);
+    plan.d_cols.resize(blocks*WS);
+    plan.d_ptot.resize(blocks);
+    plan.d_corner.resize(blocks);
+
+}
+
+/**
+ *  @ingroup gpu
+ *  @brief Launch the summed-area tables of moments kernels of C channels
+ *  @param[in,out] plan The plan to run
+ *  @param[in] timer Optional four timers to measure each step
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ *  @tparam C Number of channels (1 to 4)
+ */
+template <class T, int K, int C>
+__host__
+void sat_moments_launch( sat_moments_plan<T,K>& plan,
+                         base_timer **timer ) {
+
+    const int m_size = plan.m_size, n_size = plan.n_size, tables = K*C;
+
+    if (timer) timer[0]->start();
+
+    sat_moments_step1<T,K,C><<< dim3(m_size, n_size), dim3(WS, NWC), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_rows, &plan.d_cols, plan.inv_width, plan.inv_height,
+          m_size, n_size );
+
+    if (timer) { timer[0]->stop(); timer[1]->start(); }
+
+    sat_moments_step2<T><<< dim3(n_size, tables), dim3(WS), 0, plan.stream >>>
+        ( &plan.d_rows, &plan.d_ptot, m_size, n_size );
+
+    if (timer) { timer[1]->stop(); timer[2]->start(); }
+
+    sat_moments_step3<T><<< dim3(m_size, tables), dim3(WS), 0, plan.stream >>>
+        ( &plan.d_cols, &plan.d_ptot, &plan.d_corner, m_size, n_size );
+
+    if (timer) { timer[2]->stop(); timer[3]->start(); }
+
+    sat_moments_step4<T,K,C><<< dim3(m_size, n_size), dim3(WS, NWW), 0, plan.stream >>>
+        ( plan.tex_in, &plan.d_sat, &plan.d_rows, &plan.d_cols, &plan.d_corner,
+          plan.inv_width, plan.inv_height, plan.width, plan.height,
+          m_size, n_size );
+
+    if (timer) timer[3]->stop();
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Run a summed-area tables of moments plan in the GPU
+ *  @param[in,out] plan The plan to run (with the output tables)
+ *  @param[in] timer Optional four timers to measure each step
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ */
+template <class T, int K>
+__host__
+void sat_moments_gpu( sat_moments_plan<T,K>& plan,
+                      base_timer **timer=0 ) {
+
+    switch (plan.channels) {
+    case 1: sat_moments_launch<T,K,1>(plan, timer); break;
+    case 2: sat_moments_launch<T,K,2>(plan, timer); break;
+    case 3: sat_moments_launch<T,K,3>(plan, timer); break;
+    case 4: sat_moments_launch<T,K,4>(plan, timer); break;
+    }
+
+}
+
+/**
+ *  @ingroup api_gpu
+ *  @brief Compute the summed-area tables of moments in the GPU
+ *
+ *  The input may be of any type converting to float (e.g. unsigned
+ *  char or unsigned short for exact integer tables).
+ *
+ *  @param[out] h_sat The output tables in host memory (K*channels tables of width x height)
+ *  @param[in] h_img The input 2D image (interleaved channels) in host memory
+ *  @param[in] width Image width
+ *  @param[in] height Image height
+ *  @param[in] channels Number of interleaved channels (1 to 4)
+ *  @param[in] runtimes Number of run times (1 for debug and 1000 for performance measurements)
+ *  @tparam T Accumulator type (float, double, unsigned int or unsigned long long)
+ *  @tparam K Number of moments (1 for sums, 2 for sums and sums of squares)
+ *  @tparam TI Input type
+ */
+template <class T, int K, class TI>
+__host__
+void sat_moments_gpu( T *h_sat,
+                      const TI *h_img,
+                      int width, int height, int channels, int runtimes ) {
+
+    sat_moments_plan<T,K> plan;
+    prepare_sat_moments(plan, width, height, channels);
+
+    std::vector<float> img(h_img, h_img+width*height*channels);
+    upload(plan, &img[0]);
+
+    const char *steps[4] = { "step 1", "step 2", "step 3", "step 4" };
+    bool timed = runtimes == 1 || step_timing(); // see step_timing()
+    base_timer *timer[4];
+    for (int i = 0; i < 4; ++i)
+        timer[i] = new step_timer(std::string("sat_moments_gpu ") + steps[i]);
+
+    base_timer &timer_total = timers.gpu_add("sat_moments_gpu", width*height, "iP");
+
+    for (int r = 0; r < runtimes; ++r)
+        sat_moments_gpu(plan, timed ? timer : 0);
+
+    timer_total.stop();
+
+    for (int i = 0; i < 4; ++i) { // the pool aggregates the step times
+        if (timed) timers.gpu_add(steps[i], timer[i]);
+        else delete timer[i];
+    }
+
+    if (runtimes > 1) {
+
+        if (timed) {
+            for (int i = 0; i < 4; ++i)
+                std::cout << std::fixed << " " << timer[i]->elapsed()/(double)runtimes << std::flush;
+        } else {
+            std::cout << std::fixed << (timer_total.data_size()*runtimes)/(double)(timer_total.elapsed()*1024*1024) << std::flush;
+        }
+
+    } else {
+
+        timers.flush();
+
+    }
+
+    cudaMemcpy(h_sat, &plan.d_sat, plan.d_sat.size()*sizeof(T),
+               cudaMemcpyDeviceToHost);
+
+}
+
+//==============================================================================
+} // namespace gpufilter
+//==============================================================================
+#endif // SAT_MOMENTS_GPU_CUH
+//==============================================================================
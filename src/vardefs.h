@@ -11,7 +11,10 @@
 
 //== INCLUDES ==================================================================
 
+#include <vector>
+
 #include <util/solve.h>
+#include <util/recfilter.h>
 
 //== NAMESPACES ================================================================
 
@@ -83,14 +86,86 @@ void nehab_hoppe_tr2011_recfilter( T *inout,
 
 /**
  *  @ingroup cpu
- *  @overload T fwd( Vector<T,R>& p, const T& x, const T& b0, const T *a )
- *  @brief Compute the \a forward operator on a value given varying coefficients
+ *  @brief Build varying weights per position using [NehabHoppe:2011] method
+ *
+ *  The varying coefficients of build_coefficients() are turned into
+ *  forward and reverse weights per position, the reverse feedforward
+ *  weight absorbing the feedback coefficient of the next position.
+ *  The weights are padded with zeros up to the given size, making the
+ *  filter stop exactly at the last element.
+ *
+ *  @see [NehabHoppe:2011] cited in nehab_hoppe_tr2011_sec6()
+ *  @param[out] wf The forward weights per position
+ *  @param[out] wr The reverse weights per position
+ *  @param[in] n The number of elements to filter
+ *  @param[in] size The number of positions (padded)
+ *  @return True if the weights were built
+ *  @tparam T Weights value type
+ */
+template <class T>
+bool build_weights( std::vector< Vector<T,2> >& wf,
+                    std::vector< Vector<T,2> >& wr,
+                    const int& n, const int& size ) {
+    T *a=0;
+    if (!build_coefficients(a, n)) return false;
+    wf.assign(size, zeros<T,2>());
+    wr.assign(size, zeros<T,2>());
+    for (int i=0; i<n; ++i) {
+        wf[i][0] = b0f; wf[i][1] = a[i];
+        wr[i][0] = a[i+1]*b0r; wr[i][1] = a[i+1];
+    }
+    delete [] a;
+    return true;
+}
+
+/**
+ *  @ingroup cpu
+ *  @brief Compute a recursive filter with varying weights per position
+ *
+ *  Each column (in the row pass) and each row (in the column pass)
+ *  has its own forward and reverse weights, assuming zero outside the
+ *  image.  This is the reference of alg5varc_gpu() for any order.
+ *
+ *  @param[in,out] inout The in(out)put 2D image to filter
+ *  @param[in] w Image width
+ *  @param[in] h Image height
+ *  @param[in] fw Forward weights per column (at least w)
+ *  @param[in] rw Reverse weights per column (at least w)
+ *  @param[in] fh Forward weights per row (at least h)
+ *  @param[in] rh Reverse weights per row (at least h)
+ *  @tparam T Image value type
+ *  @tparam R Filter order
+ */
+template <class T, int R>
+void varc_recfilter( T *inout,
+                     const int& w, const int& h,
+                     const Vector<T,R+1> *fw, const Vector<T,R+1> *rw,
+                     const Vector<T,R+1> *fh, const Vector<T,R+1> *rh ) {
+    for (int y=0; y<h; ++y) {
+        Vector<T,R> p = zeros<T,R>(), e = zeros<T,R>();
+        for (int x=0; x<w; ++x)
+            inout[y*w+x] = fwd(p, inout[y*w+x], fw+x);
+        for (int x=w-1; x>=0; --x)
+            inout[y*w+x] = rev(inout[y*w+x], e, rw+x);
+    }
+    for (int x=0; x<w; ++x) {
+        Vector<T,R> p = zeros<T,R>(), e = zeros<T,R>();
+        for (int y=0; y<h; ++y)
+            inout[y*w+x] = fwd(p, inout[y*w+x], fh+y);
+        for (int y=h-1; y>=0; --y)
+            inout[y*w+x] = rev(inout[y*w+x], e, rh+y);
+    }
+}
+
+/**
+ *  @ingroup cpu
+ *  @overload T fwd( Vector<T,R>& p, const T& x, const Vector<T,R+1> *w )
+ *  @brief Compute the \a forward operator on a value given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rec_op()
  *  @param[in,out] p Prologue vector with \f$R\f$ size
  *  @param[in] x Input value (at the current filtering position)
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Filtered value at the current filtering position
  *  @tparam T Value type
  *  @tparam R Filter order
@@ -99,30 +174,21 @@ template <class T, int R>
 HOSTDEV
 T fwd( Vector<T,R>& p,
        const T& x,
-       const T& b0,
-       const T *a ) {
-    // fwd = fwdI / a only has feedback coefficients
-    // assuming a pointer at the correct position
-    T acc = rec_op(b0*x, a[0]*p[R-1]);
-#pragma unroll
-    for (int k=R-1; k>=1; --k) {
-        acc = rec_op(acc, a[k]*p[R-1-k]);
-        p[R-1-k] = p[R-1-k+1];
-    }
-    return p[R-1] = acc;
+       const Vector<T,R+1> *w ) {
+    // assuming a pointer at the weights of the current position
+    return fwd(p, (*w)[0]*x, *w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Vector
- *  @overload void fwd_inplace( const Vector<T,R>& _p, Vector<T,N>& b, const T& b0, const T *a )
- *  @brief Compute the \a forward operator on vectors (in-place) given varying coefficients
+ *  @overload void fwd_inplace( const Vector<T,R>& _p, Vector<T,N>& b, const Vector<T,R+1> *w )
+ *  @brief Compute the \a forward operator on vectors (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwd()
  *  @param[in,out] _p Prologue vector with \f$R\f$ size
  *  @param[in,out] b In(out)put \f$N\f$ vector
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam N Number of elements in the in(out)put vector
  *  @tparam T Value type
  *  @tparam R Filter order
@@ -130,25 +196,23 @@ T fwd( Vector<T,R>& p,
 template <class T, int N, int R>
 void fwd_inplace( const Vector<T,R>& _p,
                   Vector<T,N>& b,
-                  const T& b0,
-                  const T *a ) {
+                  const Vector<T,R+1> *w ) {
     Vector<T,R> p = _p;
 #pragma unroll
     for(int j=0; j<N; ++j)
-        b[j] = fwd(p, b[j], b0, a+j);
+        b[j] = fwd(p, b[j], w+j);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void fwdD_inplace( const Matrix<T,M,R>& p, Matrix<T,M,N>& b, const T& b0, const T *a)
- *  @brief Computes the \a forward operator on matrices (in-place) given varying coefficients
+ *  @overload void fwdD_inplace( const Matrix<T,M,R>& p, Matrix<T,M,N>& b, const Vector<T,R+1> *w)
+ *  @brief Computes the \a forward operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwd()
  *  @param[in] p Prologue \f$M \times R\f$ matrix
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -157,25 +221,23 @@ void fwd_inplace( const Vector<T,R>& _p,
 template <class T, int M, int N, int R>
 void fwdD_inplace( const Matrix<T,M,R>& p,
                    Matrix<T,M,N>& b,
-                   const T& b0,
-                   const T *a) {
-    // the coefficients b0 and a are the same for each row
+                   const Vector<T,R+1> *w) {
+    // the weights per position are the same for each row
 #pragma unroll
     for(int i=0; i<M; ++i)
-        fwd_inplace(p[i], b[i], b0, a);
+        fwd_inplace(p[i], b[i], w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void fwd_inplace(const Matrix<T,M,R> &p, Matrix<T,M,N> &b, const T& b0, const T *a)
- *  @brief Computes the \a forward operator on matrices (in-place) given varying coefficients
+ *  @overload void fwd_inplace(const Matrix<T,M,R> &p, Matrix<T,M,N> &b, const Vector<T,R+1> *w)
+ *  @brief Computes the \a forward operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwd()
  *  @param[in] p Prologue \f$M \times R\f$ matrix
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -184,22 +246,20 @@ void fwdD_inplace( const Matrix<T,M,R>& p,
 template <class T, int M, int N, int R>
 void fwd_inplace( const Matrix<T,M,R>& p,
                   Matrix<T,M,N>& b,
-                  const T& b0,
-                  const T *a) {
-    fwdD_inplace(p, b, b0, a);
+                  const Vector<T,R+1> *w) {
+    fwdD_inplace(p, b, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload Matrix<T,M,N> fwdD( const Matrix<T,M,R>& p, const Matrix<T,M,N>& b, const T& b0, const T *a )
- *  @brief Computes the \a forward operator on matrices given varying coefficients
+ *  @overload Matrix<T,M,N> fwdD( const Matrix<T,M,R>& p, const Matrix<T,M,N>& b, const Vector<T,R+1> *w )
+ *  @brief Computes the \a forward operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwd()
  *  @param[in] p Prologue \f$M \times R\f$ matrix
  *  @param[in] b Input \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -209,23 +269,21 @@ void fwd_inplace( const Matrix<T,M,R>& p,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> fwdD( const Matrix<T,M,R>& p,
                     const Matrix<T,M,N>& b, 
-                    const T& b0,
-                    const T *a ) {
+                    const Vector<T,R+1> *w ) {
     Matrix<T,M,N> fb = b;
-    fwdD_inplace(p, fb, b0, a);
+    fwdD_inplace(p, fb, w);
     return fb;
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload Matrix<T,M,N> fwd(const Matrix<T,M,R> &p, const Matrix<T,M,N> &b, const T& b0, const T *a )
- *  @brief Computes the \a forward operator on matrices given varying coefficients
+ *  @overload Matrix<T,M,N> fwd(const Matrix<T,M,R> &p, const Matrix<T,M,N> &b, const Vector<T,R+1> *w )
+ *  @brief Computes the \a forward operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @param[in] p Prologue \f$M \times R\f$ matrix
  *  @param[in] b Input \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -235,22 +293,20 @@ Matrix<T,M,N> fwdD( const Matrix<T,M,R>& p,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> fwd( const Matrix<T,M,R>& p,
                    const Matrix<T,M,N>& b,
-                   const T& b0,
-                   const T *a ) {
-    return fwdD(p, b, b0, a);
+                   const Vector<T,R+1> *w ) {
+    return fwdD(p, b, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload Matrix<T,M,N> fwdT( const Matrix<T,R,N>& pT, const Matrix<T,M,N>& b, const T& b0, const T *a )
- *  @brief Computes the \a forward-transposed operator on matrices given varying coefficients
+ *  @overload Matrix<T,M,N> fwdT( const Matrix<T,R,N>& pT, const Matrix<T,M,N>& b, const Vector<T,R+1> *w )
+ *  @brief Computes the \a forward-transposed operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwd()
  *  @param[in] pT Prologue transposed \f$R \times N\f$ matrix
  *  @param[in] b Input \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -260,22 +316,20 @@ Matrix<T,M,N> fwd( const Matrix<T,M,R>& p,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> fwdT( const Matrix<T,R,N>& pT,
                     const Matrix<T,M,N>& b,
-                    const T& b0,
-                    const T *a ) {
-    return transp(fwd(transp(pT), transp(b), b0, a));
+                    const Vector<T,R+1> *w ) {
+    return transp(fwd(transp(pT), transp(b), w));
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload Matrix<T,M,N> fwd(const Matrix<T,R,N> &pT, const Matrix<T,M,N> &b, const T& b0, const T *a )
- *  @brief Computes the \a forward-transposed operator on matrices given varying coefficients
+ *  @overload Matrix<T,M,N> fwd(const Matrix<T,R,N> &pT, const Matrix<T,M,N> &b, const Vector<T,R+1> *w )
+ *  @brief Computes the \a forward-transposed operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwdT()
  *  @param[in] pT Prologue \f$R \times N\f$ matrix
  *  @param[in] b Input \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -285,22 +339,20 @@ Matrix<T,M,N> fwdT( const Matrix<T,R,N>& pT,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> fwd( const Matrix<T,R,N>& pT,
                    const Matrix<T,M,N>& b,
-                   const T& b0,
-                   const T *a ) {
-    return fwdT(pT, b, b0, a);
+                   const Vector<T,R+1> *w ) {
+    return fwdT(pT, b, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void fwdT_inplace( const Matrix<T,R,N>& p, Matrix<T,M,N>& b, const T& b0, const T *a )
- *  @brief Computes the \a forward-transposed operator on matrices (in-place) given varying coefficients
+ *  @overload void fwdT_inplace( const Matrix<T,R,N>& p, Matrix<T,M,N>& b, const Vector<T,R+1> *w )
+ *  @brief Computes the \a forward-transposed operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwdT()
  *  @param[in] pT Prologue \f$R \times N\f$ matrix
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -309,22 +361,20 @@ Matrix<T,M,N> fwd( const Matrix<T,R,N>& pT,
 template <class T, int M, int N, int R>
 void fwdT_inplace( const Matrix<T,R,N>& p,
                    Matrix<T,M,N>& b, 
-                   const T& b0,
-                   const T *a ) {
-    b = fwdT(p, b, b0, a);
+                   const Vector<T,R+1> *w ) {
+    b = fwdT(p, b, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void fwd_inplace(const Matrix<T,R,N> &p, Matrix<T,M,N> &b, const T& b0, const T *a )
- *  @brief Computes the \a forward-transposed operator on matrices (in-place) given varying coefficients
+ *  @overload void fwd_inplace(const Matrix<T,R,N> &p, Matrix<T,M,N> &b, const Vector<T,R+1> *w )
+ *  @brief Computes the \a forward-transposed operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see fwdT()
  *  @param[in] pT Prologue \f$R \times N\f$ matrix
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -333,21 +383,19 @@ void fwdT_inplace( const Matrix<T,R,N>& p,
 template <class T, int M, int N, int R>
 void fwd_inplace( const Matrix<T,R,N>& p,
                   Matrix<T,M,N>& b,
-                  const T& b0,
-                  const T *a ) {
-    fwdT_inplace(p, b, b0, a);
+                  const Vector<T,R+1> *w ) {
+    fwdT_inplace(p, b, w);
 }
 
 /**
  *  @ingroup cpu
- *  @overload T rev( const T& x, Vector<T,R>& e, const T& b0, const T *a )
- *  @brief Computes the \a reverse operator on a value given varying coefficients
+ *  @overload T rev( const T& x, Vector<T,R>& e, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse operator on a value given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rec_op()
  *  @param[in] x Input value (at the current filtering position)
  *  @param[in,out] e Epilogue vector with \f$R\f$ size
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Filtered value at the current filtering position
  *  @tparam T Value type
  *  @tparam R Filter order
@@ -356,30 +404,21 @@ template <class T, int R>
 HOSTDEV
 T rev( const T& x,
        Vector<T,R>& e,
-       const T& b0,
-       const T *a ) {
-    // rev = revI / a only has feedback coefficients
-    // assuming a pointer at the correct position
-    T acc = rec_op(a[0]*b0*x, a[0]*e[0]);
-#pragma unroll
-    for (int k=R-1; k>=1; --k) {
-        acc = rec_op(acc, a[k]*e[k]);
-        e[k] = e[k-1];
-    }
-    return e[0] = acc;
+       const Vector<T,R+1> *w ) {
+    // assuming a pointer at the weights of the current position
+    return rev((*w)[0]*x, e, *w);
 }
 
 /**
  *  @ingroup cpu
- *  @overload void rev_inplace( Vector<T,N>& b, const Vector<T,R>& _e, const T& b0, const T *a )
+ *  @overload void rev_inplace( Vector<T,N>& b, const Vector<T,R>& _e, const Vector<T,R+1> *w )
  *  @relates Vector
- *  @brief Computes the \a reverse operator on vectors (in-place) given varying coefficients
+ *  @brief Computes the \a reverse operator on vectors (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rev()
  *  @param[in,out] b In(out)put \f$N\f$ vector
  *  @param[in] e Epilogue \f$R\f$ vector
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam N Number of elements in the in(out)put vector
  *  @tparam R Filter order
  *  @tparam T Value type
@@ -387,25 +426,23 @@ T rev( const T& x,
 template <class T, int N, int R>
 void rev_inplace( Vector<T,N>& b,
                   const Vector<T,R>& _e,
-                  const T& b0,
-                  const T *a ) {
+                  const Vector<T,R+1> *w ) {
     Vector<T,R> e = _e;
 #pragma unroll
     for(int j=N-1; j>=0; --j)
-        b[j] = rev(b[j], e, b0, a+j);
+        b[j] = rev(b[j], e, w+j);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void revD_inplace( Matrix<T,M,N>& b, const Matrix<T,M,R>& e, const T& b0, const T *a )
- *  @brief Computes the \a reverse operator on matrices (in-place) given varying coefficients
+ *  @overload void revD_inplace( Matrix<T,M,N>& b, const Matrix<T,M,R>& e, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rev()
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
  *  @param[in] e Epilogue \f$M \times R\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -414,25 +451,23 @@ void rev_inplace( Vector<T,N>& b,
 template <class T, int M, int N, int R>
 void revD_inplace( Matrix<T,M,N>& b,
                    const Matrix<T,M,R>& e,
-                   const T& b0,
-                   const T *a ) {
-    // the coefficients b0 and a are the same for each row
+                   const Vector<T,R+1> *w ) {
+    // the weights per position are the same for each row
 #pragma unroll
     for(int i=0; i<M; ++i)
-        rev_inplace(b[i], e[i], b0, a);
+        rev_inplace(b[i], e[i], w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void rev_inplace( Matrix<T,M,N>& b, const Matrix<T,M,R>& e, const T& b0, const T *a )
- *  @brief Computes the \a reverse operator on matrices (in-place) given varying coefficients
+ *  @overload void rev_inplace( Matrix<T,M,N>& b, const Matrix<T,M,R>& e, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rev()
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
  *  @param[in] e Epilogue \f$M \times R\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -441,22 +476,20 @@ void revD_inplace( Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 void rev_inplace( Matrix<T,M,N>& b,
                   const Matrix<T,M,R>& e, 
-                  const T& b0,
-                  const T *a ) {
-    revD_inplace(b, e, b0, a);
+                  const Vector<T,R+1> *w ) {
+    revD_inplace(b, e, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload  Matrix<T,M,N> revD( const Matrix<T,M,N>& b, const Matrix<T,M,R>& e, const T& b0, const T *a )
- *  @brief Computes the \a reverse operator on matrices given varying coefficients
+ *  @overload  Matrix<T,M,N> revD( const Matrix<T,M,N>& b, const Matrix<T,M,R>& e, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rev()
  *  @param[in] b Input \f$M \times N\f$ matrix
  *  @param[in] e Epilogue \f$M \times R\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -466,24 +499,22 @@ void rev_inplace( Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> revD( const Matrix<T,M,N>& b,
                     const Matrix<T,M,R>& e,
-                    const T& b0,
-                    const T *a ) {
+                    const Vector<T,R+1> *w ) {
     Matrix<T,M,N> rb = b;
-    revD_inplace(rb, e, b0, a);
+    revD_inplace(rb, e, w);
     return rb;
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload Matrix<T,M,N> rev(const Matrix<T,M,N> &b, const Matrix<T,M,R> &e, const T& b0, const T *a )
- *  @brief Computes the \a reverse operator on matrices given varying coefficients
+ *  @overload Matrix<T,M,N> rev(const Matrix<T,M,N> &b, const Matrix<T,M,R> &e, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see rev()
  *  @param[in] b Input \f$M \times N\f$ matrix
  *  @param[in] e Epilogue \f$M \times R\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -493,22 +524,20 @@ Matrix<T,M,N> revD( const Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> rev( const Matrix<T,M,N>& b,
                    const Matrix<T,M,R>& e,
-                   const T& b0,
-                   const T *a ) {
-    return revD(b, e, b0, a);
+                   const Vector<T,R+1> *w ) {
+    return revD(b, e, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload Matrix<T,M,N> revT( const Matrix<T,M,N>& b, const Matrix<T,R,N>& eT, const T& b0, const T *a )
- *  @brief Computes the \a reverse-transposed operator on matrices given varying coefficients
+ *  @overload Matrix<T,M,N> revT( const Matrix<T,M,N>& b, const Matrix<T,R,N>& eT, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse-transposed operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see revT()
  *  @param[in] b Input \f$M \times N\f$ matrix
  *  @param[in] eT Epilogue \f$R \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -518,22 +547,20 @@ Matrix<T,M,N> rev( const Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> revT( const Matrix<T,M,N>& b,
                     const Matrix<T,R,N>& eT,
-                    const T& b0,
-                    const T *a ) {
-    return transp(rev(transp(b), transp(eT), b0, a));
+                    const Vector<T,R+1> *w ) {
+    return transp(rev(transp(b), transp(eT), w));
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
  *  @overload Matrix<T,M,N> rev(const Matrix<T,M,N> &b, const Matrix<T,R,N> &eT
- *  @brief Computes the \a reverse-transposed operator on matrices given varying coefficients
+ *  @brief Computes the \a reverse-transposed operator on matrices given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see revT()
  *  @param[in] b Input \f$M \times N\f$ matrix
  *  @param[in] eT Epilogue \f$R \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @return Output \f$M \times N\f$ matrix
  *  @tparam M Number of rows
  *  @tparam N Number of columns
@@ -543,22 +570,20 @@ Matrix<T,M,N> revT( const Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 Matrix<T,M,N> rev( const Matrix<T,M,N>& b,
                    const Matrix<T,R,N>& eT,
-                   const T& b0,
-                   const T *a ) {
-    return revT(b, eT, b0, a);
+                   const Vector<T,R+1> *w ) {
+    return revT(b, eT, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void revT_inplace( Matrix<T,M,N>& b, const Matrix<T,R,N>& eT, const T& b0, const T *a )
- *  @brief Computes the \a reverse-transposed operator on matrices (in-place) given varying coefficients
+ *  @overload void revT_inplace( Matrix<T,M,N>& b, const Matrix<T,R,N>& eT, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse-transposed operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see revT()
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
  *  @param[in] eT Epilogue \f$R \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -567,22 +592,20 @@ Matrix<T,M,N> rev( const Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 void revT_inplace( Matrix<T,M,N>& b,
                    const Matrix<T,R,N>& eT,
-                   const T& b0,
-                   const T *a ) {
-    b = revT(b, eT, b0, a);
+                   const Vector<T,R+1> *w ) {
+    b = revT(b, eT, w);
 }
 
 /**
  *  @ingroup cpu
  *  @relates Matrix
- *  @overload void rev_inplace(Matrix<T,M,N> &b, const Matrix<T,R,N> &p, const T& b0, const T *a )
- *  @brief Computes the \a reverse-transposed operator on matrices (in-place) given varying coefficients
+ *  @overload void rev_inplace(Matrix<T,M,N> &b, const Matrix<T,R,N> &p, const Vector<T,R+1> *w )
+ *  @brief Computes the \a reverse-transposed operator on matrices (in-place) given varying weights
  *  @see [NehabMaximo:2016] cited in alg6()
  *  @see revT()
  *  @param[in,out] b In(out)put \f$M \times N\f$ matrix
  *  @param[in] eT Epilogue \f$R \times N\f$ matrix
- *  @param[in] b0 Filter feedforward coefficient
- *  @param[in] a Filter feedback coefficients
+ *  @param[in] w Filter weights per position (from the current one)
  *  @tparam M Number of rows
  *  @tparam N Number of columns
  *  @tparam R Filter order
@@ -591,9 +614,8 @@ void revT_inplace( Matrix<T,M,N>& b,
 template <class T, int M, int N, int R>
 void rev_inplace( Matrix<T,M,N>& b,
                   const Matrix<T,R,N>& eT,
-                  const T& b0,
-                  const T *a ) {
-    revT_inplace(b, eT, b0, a);
+                  const Vector<T,R+1> *w ) {
+    revT_inplace(b, eT, w);
 }
 
 //==============================================================================